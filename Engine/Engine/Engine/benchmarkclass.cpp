@@ -0,0 +1,418 @@
+#include "benchmarkclass.h"
+
+// Frames of the same segment together, fastest first
+static bool CompareSegmentFrames(const BenchmarkSegmentFrameType& a, const BenchmarkSegmentFrameType& b)
+{
+    if (a.segment != b.segment)
+        return (a.segment < b.segment);
+
+    return (a.nanoseconds < b.nanoseconds);
+}
+
+BenchmarkClass::BenchmarkClass()
+{
+    memset(&m_settings, 0, sizeof(m_settings));
+    m_Graphics = 0;
+    m_FrameStats = 0;
+    m_CameraPath = 0;
+    m_segmentFrames = 0;
+    m_segmentFrameCount = 0;
+    m_segmentFrameCapacity = 0;
+    m_frame = 0;
+    m_startNanoseconds = 0;
+    m_lastNanoseconds = 0;
+    m_visibleTotal = 0;
+    m_culledTotal = 0;
+    m_drawCallTotal = 0;
+    m_indexTotal = 0;
+    m_bytesUploadedTotal = 0;
+    m_stateChangeTotal = 0;
+}
+
+BenchmarkClass::BenchmarkClass(const BenchmarkClass& other)
+{
+
+}
+
+BenchmarkClass::~BenchmarkClass()
+{
+
+}
+
+// Returns false when -benchmark isn't on the command line. The other switches
+// are -frames <count>, -seconds <seconds>, -timestep <seconds>, -script <file>,
+// -results <file> and -device d3d|null|software. A script without -frames or
+// -seconds is played to its end, the frame count comes from the path in Initialize.
+bool BenchmarkClass::ParseCommandLine(const char* commandLine, BenchmarkSettingsType& settings)
+{
+    char value[BENCHMARK_MAX_PATH];
+
+    if (!strstr(commandLine, "-benchmark"))
+        return false;
+
+    settings.deviceType = GRAPHICS_DEVICE_D3D;
+    settings.frameCount = 0;
+    settings.seconds = 0.0f;
+    settings.timestep = BENCHMARK_TIMESTEP;
+    settings.scriptFile[0] = 0;
+    strcpy(settings.resultsFile, "benchmark.json");
+
+    if (ReadArgument(commandLine, "-seconds", value, BENCHMARK_MAX_PATH))
+    {
+        settings.seconds = (float)atof(value);
+        settings.frameCount = 0;
+    }
+
+    if (ReadArgument(commandLine, "-frames", value, BENCHMARK_MAX_PATH))
+        settings.frameCount = atoi(value);
+
+    if (ReadArgument(commandLine, "-timestep", value, BENCHMARK_MAX_PATH))
+        settings.timestep = (float)atof(value);
+    if (settings.timestep <= 0.0f)
+        settings.timestep = BENCHMARK_TIMESTEP;
+
+    ReadArgument(commandLine, "-script", settings.scriptFile, BENCHMARK_MAX_PATH);
+    ReadArgument(commandLine, "-results", settings.resultsFile, BENCHMARK_MAX_PATH);
+
+    if (ReadArgument(commandLine, "-device", value, BENCHMARK_MAX_PATH))
+    {
+        if (strcmp(value, "null") == 0)
+            settings.deviceType = GRAPHICS_DEVICE_NULL;
+        else if (strcmp(value, "software") == 0)
+            settings.deviceType = GRAPHICS_DEVICE_SOFTWARE;
+    }
+
+    // Something has to end the run
+    if ((settings.frameCount <= 0) && (settings.seconds <= 0.0f) && !settings.scriptFile[0])
+        settings.frameCount = BENCHMARK_DEFAULT_FRAMES;
+
+    return true;
+}
+
+// The window is only needed by the D3D device, the others pass a null handle
+bool BenchmarkClass::Initialize(const BenchmarkSettingsType& settings, HWND hwnd)
+{
+    bool result;
+
+    m_settings = settings;
+
+    m_CameraPath = new CameraPathClass;
+    if (!m_CameraPath)
+        return false;
+
+    result = m_CameraPath->Initialize();
+    if (!result)
+        return false;
+
+    if (m_settings.scriptFile[0])
+    {
+        result = m_CameraPath->LoadScript(m_settings.scriptFile);
+        if (!result)
+            return false;
+
+        // Every segment plays once, the path would wrap back to its start on the next frame
+        if ((m_settings.frameCount <= 0) && (m_settings.seconds <= 0.0f))
+        {
+            m_settings.frameCount = (int)(m_CameraPath->GetDuration() / m_settings.timestep + 0.5f);
+            if (m_settings.frameCount < 1)
+                m_settings.frameCount = 1;
+        }
+    }
+    else
+    {
+        // Without a script turn once around the spot the interactive camera starts at
+        m_CameraPath->AddKey(0.0f, Vector3Type(0.0f, 0.0f, -10.0f), Vector3Type(0.0f, 0.0f, 0.0f));
+        m_CameraPath->AddKey(10.0f, Vector3Type(0.0f, 0.0f, -10.0f), Vector3Type(0.0f, 360.0f, 0.0f));
+    }
+
+    m_segmentFrameCapacity = BENCHMARK_FRAME_CAPACITY;
+    m_segmentFrames = new BenchmarkSegmentFrameType[m_segmentFrameCapacity];
+    if (!m_segmentFrames)
+        return false;
+    m_segmentFrameCount = 0;
+
+    m_FrameStats = new FrameStatsClass;
+    if (!m_FrameStats)
+        return false;
+
+    result = m_FrameStats->Initialize();
+    if (!result)
+        return false;
+
+    // Vsync off and a fixed seed so the runs are comparable
+    m_Graphics = new GraphicsClass;
+    if (!m_Graphics)
+        return false;
+
+    result = m_Graphics->Initialize(BENCHMARK_SCREEN_WIDTH, BENCHMARK_SCREEN_HEIGHT, hwnd, m_settings.deviceType, false, BENCHMARK_MODEL_SEED);
+    if (!result)
+        return false;
+
+    m_Graphics->SetFrameStats(m_FrameStats);
+
+    m_frame = 0;
+    m_startNanoseconds = FrameStatsClass::GetNanoseconds();
+    m_lastNanoseconds = m_startNanoseconds;
+
+    return true;
+}
+
+void BenchmarkClass::Shutdown()
+{
+    if (m_Graphics)
+    {
+        m_Graphics->Shutdown();
+        delete m_Graphics;
+        m_Graphics = 0;
+    }
+
+    if (m_FrameStats)
+    {
+        m_FrameStats->Shutdown();
+        delete m_FrameStats;
+        m_FrameStats = 0;
+    }
+
+    if (m_segmentFrames)
+    {
+        delete[] m_segmentFrames;
+        m_segmentFrames = 0;
+    }
+
+    if (m_CameraPath)
+    {
+        m_CameraPath->Shutdown();
+        delete m_CameraPath;
+        m_CameraPath = 0;
+    }
+
+    return;
+}
+
+bool BenchmarkClass::Frame(bool& done)
+{
+    Vector3Type position, rotation;
+    RenderStatsType stats;
+    long long phaseStart, now;
+    int segment;
+    bool result;
+
+    // Path time moves a fixed step per frame, not with the clock
+    phaseStart = FrameStatsClass::GetNanoseconds();
+    segment = m_CameraPath->Sample((float)((double)m_frame * m_settings.timestep), position, rotation);
+
+    result = m_Graphics->Frame(position, rotation);
+    m_FrameStats->AddPhaseTime(FRAME_TIME_UPDATE, FrameStatsClass::GetNanoseconds() - phaseStart);
+    if (!result)
+        return false;
+
+    result = m_Graphics->Render();
+    if (!result)
+        return false;
+
+    stats = m_Graphics->GetRenderStats();
+    m_visibleTotal += m_Graphics->GetVisibleCount();
+    m_culledTotal += m_Graphics->GetModelCount() - m_Graphics->GetVisibleCount();
+    m_drawCallTotal += stats.drawCalls;
+    m_indexTotal += stats.indexCount;
+    m_bytesUploadedTotal += stats.bytesUploaded;
+    m_stateChangeTotal += stats.stateChanges;
+
+    now = FrameStatsClass::GetNanoseconds();
+    m_FrameStats->EndFrame(now - m_lastNanoseconds);
+    result = AddSegmentFrame(segment, now - m_lastNanoseconds, m_Graphics->GetVisibleCount(), stats.drawCalls);
+    m_lastNanoseconds = now;
+    if (!result)
+        return false;
+
+    m_frame++;
+
+    if (m_settings.frameCount > 0)
+        done = (m_frame >= m_settings.frameCount);
+    else
+        done = ((double)(now - m_startNanoseconds) >= (double)m_settings.seconds * 1000000000.0);
+
+    return true;
+}
+
+bool BenchmarkClass::WriteResults()
+{
+    ofstream fout;
+    FrameStatsType stats;
+    double seconds, frames;
+    int segments;
+    static const char* deviceNames[] = { "d3d", "null", "software" };
+    static const char* phaseNames[FRAME_TIME_COUNT] = { "frame", "input", "update", "culling", "draw", "present" };
+    int i;
+
+    if (m_frame == 0)
+        return false;
+
+    fout.open(m_settings.resultsFile);
+    if (fout.fail())
+        return false;
+
+    seconds = (double)(m_lastNanoseconds - m_startNanoseconds) / 1000000000.0;
+    frames = (double)m_frame;
+
+    fout.setf(ios::fixed);
+    fout.precision(3);
+
+    fout << "{" << endl;
+    fout << "  \"device\": \"" << deviceNames[m_settings.deviceType] << "\"," << endl;
+    fout << "  \"isa\": \"" << CpuFeatureClass::GetIsaName(CpuFeatureClass::GetIsa()) << "\"," << endl;
+    fout << "  \"script\": ";
+    WriteString(fout, m_settings.scriptFile[0] ? m_settings.scriptFile : "default");
+    fout << "," << endl;
+    fout << "  \"frames\": " << m_frame << "," << endl;
+    fout << "  \"seconds\": " << seconds << "," << endl;
+    fout << "  \"fps\": " << ((seconds > 0.0) ? frames / seconds : 0.0) << "," << endl;
+    fout << "  \"hitches\": " << m_FrameStats->GetHitchCount() << "," << endl;
+
+    // Milliseconds over the frames the stats ring still holds
+    for (i = 0; i < FRAME_TIME_COUNT; i++)
+    {
+        m_FrameStats->GetStats(i, stats);
+        fout << "  \"" << phaseNames[i] << "_ms\": { \"min\": " << (double)stats.minimum / 1000000.0 << ", \"mean\": " << (double)stats.mean / 1000000.0 <<
+            ", \"p50\": " << (double)stats.p50 / 1000000.0 << ", \"p95\": " << (double)stats.p95 / 1000000.0 <<
+            ", \"p99\": " << (double)stats.p99 / 1000000.0 << ", \"max\": " << (double)stats.maximum / 1000000.0 << " }," << endl;
+    }
+
+    // Counts are averages per frame
+    fout << "  \"models\": " << m_Graphics->GetModelCount() << "," << endl;
+    fout << "  \"visible\": " << (double)m_visibleTotal / frames << "," << endl;
+    fout << "  \"culled\": " << (double)m_culledTotal / frames << "," << endl;
+    fout << "  \"draw_calls\": " << (double)m_drawCallTotal / frames << "," << endl;
+    fout << "  \"indices\": " << (double)m_indexTotal / frames << "," << endl;
+    fout << "  \"bytes_uploaded\": " << (double)m_bytesUploadedTotal / frames << "," << endl;
+    fout << "  \"state_changes\": " << (double)m_stateChangeTotal / frames << "," << endl;
+
+    segments = WriteSegments(fout);
+    fout << "}" << endl;
+
+    fout.close();
+
+    printf("%d frames over %d of %d path segments, results in %s\n", m_frame, segments, m_CameraPath->GetSegmentCount(), m_settings.resultsFile);
+
+    return true;
+}
+
+// Writes a JSON string, paths can have backslashes in them
+void BenchmarkClass::WriteString(ofstream& fout, const char* text)
+{
+    fout << "\"";
+    while (*text)
+    {
+        if ((*text == '"') || (*text == '\\'))
+            fout << "\\";
+        fout << *text;
+        text++;
+    }
+    fout << "\"";
+
+    return;
+}
+
+// Copies the word after a switch, stopping at the first space
+bool BenchmarkClass::ReadArgument(const char* commandLine, const char* name, char* value, int valueSize)
+{
+    const char* argument;
+    int length;
+
+    // Only match switches at the start of a word, not inside a path
+    argument = strstr(commandLine, name);
+    while (argument && (argument != commandLine) && (argument[-1] != ' '))
+        argument = strstr(argument + 1, name);
+
+    if (!argument)
+        return false;
+
+    argument += strlen(name);
+    while (*argument == ' ')
+        argument++;
+
+    length = 0;
+    while (argument[length] && (argument[length] != ' ') && (length < valueSize - 1))
+    {
+        value[length] = argument[length];
+        length++;
+    }
+    value[length] = 0;
+
+    return (length > 0);
+}
+
+// Every frame is kept, unlike the frame stats ring, so each segment's times cover the whole run
+bool BenchmarkClass::AddSegmentFrame(int segment, long long nanoseconds, int visible, int drawCalls)
+{
+    BenchmarkSegmentFrameType* frames;
+
+    if (m_segmentFrameCount == m_segmentFrameCapacity)
+    {
+        frames = new BenchmarkSegmentFrameType[m_segmentFrameCapacity * 2];
+        if (!frames)
+            return false;
+
+        memcpy(frames, m_segmentFrames, sizeof(BenchmarkSegmentFrameType) * m_segmentFrameCount);
+        delete[] m_segmentFrames;
+        m_segmentFrames = frames;
+        m_segmentFrameCapacity *= 2;
+    }
+
+    m_segmentFrames[m_segmentFrameCount].segment = segment;
+    m_segmentFrames[m_segmentFrameCount].nanoseconds = nanoseconds;
+    m_segmentFrames[m_segmentFrameCount].visible = visible;
+    m_segmentFrames[m_segmentFrameCount].drawCalls = drawCalls;
+    m_segmentFrameCount++;
+
+    return true;
+}
+
+// One entry per segment of the path the run reached, times in milliseconds and
+// counts as averages per frame. A run that loops adds every pass to the same entries.
+// Returns how many segments had frames.
+int BenchmarkClass::WriteSegments(ofstream& fout)
+{
+    BenchmarkSegmentFrameType* frames;
+    long long total;
+    double visible, drawCalls;
+    int first, count, i, segments;
+    bool separator;
+
+    // Sorted in place, the frames aren't needed in order after the run
+    frames = m_segmentFrames;
+    sort(frames, frames + m_segmentFrameCount, CompareSegmentFrames);
+
+    fout << "  \"segments\": [" << endl;
+    separator = false;
+    segments = 0;
+    for (first = 0; first < m_segmentFrameCount; first += count)
+    {
+        count = 0;
+        total = 0;
+        visible = 0.0;
+        drawCalls = 0.0;
+        while ((first + count < m_segmentFrameCount) && (frames[first + count].segment == frames[first].segment))
+        {
+            total += frames[first + count].nanoseconds;
+            visible += frames[first + count].visible;
+            drawCalls += frames[first + count].drawCalls;
+            count++;
+        }
+
+        i = frames[first].segment;
+        if (separator)
+            fout << "," << endl;
+        fout << "    { \"start\": " << m_CameraPath->GetSegmentStart(i) << ", \"end\": " << m_CameraPath->GetSegmentEnd(i) << ", \"frames\": " << count <<
+            ", \"min_ms\": " << (double)frames[first].nanoseconds / 1000000.0 << ", \"mean_ms\": " << (double)(total / count) / 1000000.0 <<
+            ", \"p50_ms\": " << (double)frames[first + (count * 50 + 99) / 100 - 1].nanoseconds / 1000000.0 <<
+            ", \"p95_ms\": " << (double)frames[first + (count * 95 + 99) / 100 - 1].nanoseconds / 1000000.0 <<
+            ", \"max_ms\": " << (double)frames[first + count - 1].nanoseconds / 1000000.0 <<
+            ", \"visible\": " << visible / count << ", \"draw_calls\": " << drawCalls / count << " }";
+        separator = true;
+        segments++;
+    }
+    fout << endl << "  ]" << endl;
+
+    return segments;
+}
\ No newline at end of file
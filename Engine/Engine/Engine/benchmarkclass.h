@@ -0,0 +1,81 @@
+#pragma once
+
+#include <fstream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "graphicsclass.h"
+#include "framestatsclass.h"
+#include "camerapathclass.h"
+#include "cpufeatureclass.h"
+using namespace std;
+
+const int BENCHMARK_MAX_PATH = 260;
+const int BENCHMARK_DEFAULT_FRAMES = 1000;
+const int BENCHMARK_SCREEN_WIDTH = 1280;
+const int BENCHMARK_SCREEN_HEIGHT = 720;
+const unsigned int BENCHMARK_MODEL_SEED = 1;
+const float BENCHMARK_TIMESTEP = 1.0f / 60.0f;
+const int BENCHMARK_FRAME_CAPACITY = 1024;
+
+// Read from the command line. A frame count of zero with seconds set runs for
+// that long instead, and with neither set a script plays once to its last key.
+// The timestep is how far along the camera path each frame moves.
+struct BenchmarkSettingsType
+{
+    GraphicsDeviceType deviceType;
+    int frameCount;
+    float seconds;
+    float timestep;
+    char scriptFile[BENCHMARK_MAX_PATH];
+    char resultsFile[BENCHMARK_MAX_PATH];
+};
+
+// Time and counts of one benchmark frame and the segment of the path it drew
+struct BenchmarkSegmentFrameType
+{
+    int segment;
+    long long nanoseconds;
+    int visible, drawCalls;
+};
+
+// Renders a fixed run without input. The camera follows a path of timed keys
+// and moves by a fixed step each frame, so every run on every machine draws the
+// same frames whatever the frame rate. Vsync is off and the results are written
+// as JSON at the end, with the frame times of each stretch of the path between
+// two keys given separately so a slow view can be found.
+class BenchmarkClass
+{
+public:
+    BenchmarkClass();
+    BenchmarkClass(const BenchmarkClass&);
+    ~BenchmarkClass();
+
+    static bool ParseCommandLine(const char*, BenchmarkSettingsType&);
+    static bool ReadArgument(const char*, const char*, char*, int);
+
+    bool Initialize(const BenchmarkSettingsType&, HWND);
+    void Shutdown();
+    bool Frame(bool&);
+    bool WriteResults();
+
+private:
+    static void WriteString(ofstream&, const char*);
+    bool AddSegmentFrame(int, long long, int, int);
+    int WriteSegments(ofstream&);
+
+private:
+    BenchmarkSettingsType m_settings;
+    GraphicsClass* m_Graphics;
+    FrameStatsClass* m_FrameStats;
+
+    CameraPathClass* m_CameraPath;
+    BenchmarkSegmentFrameType* m_segmentFrames;
+    int m_segmentFrameCount, m_segmentFrameCapacity;
+
+    int m_frame;
+    long long m_startNanoseconds, m_lastNanoseconds;
+    long long m_visibleTotal, m_culledTotal, m_drawCallTotal, m_indexTotal, m_bytesUploadedTotal, m_stateChangeTotal;
+};
\ No newline at end of file
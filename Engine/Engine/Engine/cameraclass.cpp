@@ -9,6 +9,9 @@ CameraClass::CameraClass()
     m_rotationX = 0.0f;
     m_rotationY = 0.0f;
     m_rotationZ = 0.0f;
+
+    m_latencyTag.eventId = 0;
+    m_latencyTag.inputTime = 0;
 }
 
 CameraClass::CameraClass(const CameraClass& other)
@@ -37,11 +40,33 @@ void CameraClass::SetRotation(float x, float y, float z)
     return;
 }
 
+Vector3Type CameraClass::GetPosition()
+{
+    return Vector3Type(m_positionX, m_positionY, m_positionZ);
+}
+
+Vector3Type CameraClass::GetRotation()
+{
+    return Vector3Type(m_rotationX, m_rotationY, m_rotationZ);
+}
+
+// Set with the position and rotation, the input they were moved for
+void CameraClass::SetLatencyTag(const InputLatencyTagType& tag)
+{
+    m_latencyTag = tag;
+    return;
+}
+
+InputLatencyTagType CameraClass::GetLatencyTag()
+{
+    return m_latencyTag;
+}
+
 void CameraClass::Render()
 {
-    D3DXVECTOR3 up;
-    D3DXVECTOR3 position;
-    D3DXVECTOR3 lookAt;
+    Vector3Type up;
+    Vector3Type position;
+    Vector3Type lookAt;
     float radians;
 
     up.x = 0.0f;
@@ -60,12 +85,12 @@ void CameraClass::Render()
     lookAt.y = m_positionY;
     lookAt.z = cosf(radians) + m_positionZ;
 
-    D3DXMatrixLookAtLH(&m_viewMatrix, &position, &lookAt, &up);
+    MatrixLookAtLH(&m_viewMatrix, &position, &lookAt, &up);
 
     return;
 }
 
-void CameraClass::GetViewMatrix(D3DXMATRIX& viewMatrix)
+void CameraClass::GetViewMatrix(MatrixType& viewMatrix)
 {
     viewMatrix = m_viewMatrix;
     return;
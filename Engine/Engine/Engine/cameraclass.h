@@ -1,6 +1,7 @@
 #pragma once
 
-#include <d3dx10math.h>
+#include "mathclass.h"
+#include "inputqueueclass.h"
 
 class CameraClass
 {
@@ -12,11 +13,18 @@ public:
     void SetPosition(float, float, float);
     void SetRotation(float, float, float);
 
+    Vector3Type GetPosition();
+    Vector3Type GetRotation();
+
+    void SetLatencyTag(const InputLatencyTagType&);
+    InputLatencyTagType GetLatencyTag();
+
     void Render();
-    void GetViewMatrix(D3DXMATRIX&);
+    void GetViewMatrix(MatrixType&);
 
 private:
-    D3DXMATRIX m_viewMatrix;
+    MatrixType m_viewMatrix;
     float m_positionX, m_positionY, m_positionZ;
     float m_rotationX, m_rotationY, m_rotationZ;
+    InputLatencyTagType m_latencyTag;
 };
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "camerapathclass.h"
+
+CameraPathClass::CameraPathClass()
+{
+    m_keys = 0;
+    m_keyCount = 0;
+    m_keyCapacity = 0;
+    m_spline = CAMERA_PATH_CATMULL_ROM;
+}
+
+CameraPathClass::CameraPathClass(const CameraPathClass& other)
+{
+
+}
+
+CameraPathClass::~CameraPathClass()
+{
+
+}
+
+bool CameraPathClass::Initialize()
+{
+    m_keyCapacity = CAMERA_PATH_KEY_CAPACITY;
+    m_keys = new CameraKeyType[m_keyCapacity];
+    if (!m_keys)
+        return false;
+
+    m_keyCount = 0;
+    m_spline = CAMERA_PATH_CATMULL_ROM;
+
+    return true;
+}
+
+void CameraPathClass::Shutdown()
+{
+    if (m_keys)
+    {
+        delete[] m_keys;
+        m_keys = 0;
+    }
+
+    m_keyCount = 0;
+    m_keyCapacity = 0;
+
+    return;
+}
+
+// One key per line: time in seconds, position x y z, rotation x y z in degrees.
+// "spline linear" goes in straight lines between keys instead. Lines starting
+// with # are comments and keys have to be in time order.
+bool CameraPathClass::LoadScript(char* filename)
+{
+    ifstream fin;
+    char line[256], spline[32];
+    float time;
+    Vector3Type position, rotation;
+    int count;
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    m_keyCount = 0;
+    while (fin.getline(line, sizeof(line)))
+    {
+        if ((line[0] == '#') || (line[0] == 0) || (line[0] == '\r'))
+            continue;
+
+        if (sscanf(line, "spline %31s", spline) == 1)
+        {
+            if (strcmp(spline, "linear") == 0)
+                m_spline = CAMERA_PATH_LINEAR;
+            else if (strcmp(spline, "catmullrom") == 0)
+                m_spline = CAMERA_PATH_CATMULL_ROM;
+            else
+                return false;
+            continue;
+        }
+
+        count = sscanf(line, "%f %f %f %f %f %f %f", &time, &position.x, &position.y, &position.z, &rotation.x, &rotation.y, &rotation.z);
+        if (count != 7)
+            return false;
+
+        if ((m_keyCount > 0) && (time <= m_keys[m_keyCount - 1].time))
+            return false;
+
+        if (!AddKey(time, position, rotation))
+            return false;
+    }
+
+    fin.close();
+
+    return (m_keyCount > 0);
+}
+
+bool CameraPathClass::AddKey(float time, Vector3Type position, Vector3Type rotation)
+{
+    CameraKeyType* keys;
+
+    if (m_keyCount == m_keyCapacity)
+    {
+        keys = new CameraKeyType[m_keyCapacity * 2];
+        if (!keys)
+            return false;
+
+        memcpy(keys, m_keys, sizeof(CameraKeyType) * m_keyCount);
+        delete[] m_keys;
+        m_keys = keys;
+        m_keyCapacity *= 2;
+    }
+
+    m_keys[m_keyCount].time = time;
+    m_keys[m_keyCount].position = position;
+    m_keys[m_keyCount].rotation = rotation;
+    m_keyCount++;
+
+    return true;
+}
+
+void CameraPathClass::SetSpline(CameraPathSplineType spline)
+{
+    m_spline = spline;
+
+    return;
+}
+
+// Returns the segment the time falls in, segment i runs from key i to key i + 1.
+// The same time always gives the same camera, whatever the frame rate.
+int CameraPathClass::Sample(float time, Vector3Type& position, Vector3Type& rotation)
+{
+    Vector3Type positionTangent0, positionTangent1, rotationTangent0, rotationTangent1;
+    float duration, length, t, t2, t3, h00, h10, h01, h11;
+    int i;
+
+    duration = GetDuration();
+    if ((m_keyCount == 1) || (duration <= 0.0f))
+    {
+        position = m_keys[0].position;
+        rotation = m_keys[0].rotation;
+        return 0;
+    }
+
+    time = fmodf(time, duration);
+
+    i = 0;
+    while ((i < m_keyCount - 2) && (time >= m_keys[i + 1].time))
+        i++;
+
+    if (time <= m_keys[i].time)
+    {
+        position = m_keys[i].position;
+        rotation = m_keys[i].rotation;
+        return i;
+    }
+
+    length = m_keys[i + 1].time - m_keys[i].time;
+    t = (time - m_keys[i].time) / length;
+
+    if (m_spline == CAMERA_PATH_LINEAR)
+    {
+        position = m_keys[i].position + (m_keys[i + 1].position - m_keys[i].position) * t;
+        rotation = m_keys[i].rotation + (m_keys[i + 1].rotation - m_keys[i].rotation) * t;
+        return i;
+    }
+
+    // Cubic Hermite between the two keys, tangents are per second so they scale by the segment length
+    t2 = t * t;
+    t3 = t2 * t;
+    h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+    h10 = t3 - 2.0f * t2 + t;
+    h01 = -2.0f * t3 + 3.0f * t2;
+    h11 = t3 - t2;
+
+    positionTangent0 = GetTangent(i, false);
+    positionTangent1 = GetTangent(i + 1, false);
+    rotationTangent0 = GetTangent(i, true);
+    rotationTangent1 = GetTangent(i + 1, true);
+
+    position = m_keys[i].position * h00 + positionTangent0 * (h10 * length) + m_keys[i + 1].position * h01 + positionTangent1 * (h11 * length);
+    rotation = m_keys[i].rotation * h00 + rotationTangent0 * (h10 * length) + m_keys[i + 1].rotation * h01 + rotationTangent1 * (h11 * length);
+
+    return i;
+}
+
+int CameraPathClass::GetSegmentCount()
+{
+    return (m_keyCount > 1) ? m_keyCount - 1 : 1;
+}
+
+float CameraPathClass::GetSegmentStart(int segment)
+{
+    return m_keys[segment].time;
+}
+
+float CameraPathClass::GetSegmentEnd(int segment)
+{
+    return (m_keyCount > 1) ? m_keys[segment + 1].time : m_keys[0].time;
+}
+
+float CameraPathClass::GetDuration()
+{
+    return m_keys[m_keyCount - 1].time;
+}
+
+// Change per second through a key, from the keys either side. The first and
+// last keys only have one neighbour so the path starts and ends along the
+// line to it.
+Vector3Type CameraPathClass::GetTangent(int key, bool rotation)
+{
+    int previous, next;
+
+    previous = (key > 0) ? key - 1 : key;
+    next = (key < m_keyCount - 1) ? key + 1 : key;
+
+    if (rotation)
+        return (m_keys[next].rotation - m_keys[previous].rotation) / (m_keys[next].time - m_keys[previous].time);
+
+    return (m_keys[next].position - m_keys[previous].position) / (m_keys[next].time - m_keys[previous].time);
+}
\ No newline at end of file
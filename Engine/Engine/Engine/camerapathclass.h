@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fstream>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "mathclass.h"
+using namespace std;
+
+const int CAMERA_PATH_KEY_CAPACITY = 16;
+
+enum CameraPathSplineType
+{
+    CAMERA_PATH_LINEAR,
+    CAMERA_PATH_CATMULL_ROM
+};
+
+// A camera path through timed keys of position and rotation, sampled by time.
+// Between keys it follows a Catmull-Rom spline, with the tangent at each key
+// taken from its neighbours over the time between them, so keys need not be
+// evenly spaced and the speed stays smooth across them. Rotations are Euler
+// angles in degrees like CameraClass takes and are not wrapped, a key at 360
+// after one at 0 turns all the way round. Past the last key the path loops.
+class CameraPathClass
+{
+private:
+    struct CameraKeyType
+    {
+        float time;
+        Vector3Type position, rotation;
+    };
+
+public:
+    CameraPathClass();
+    CameraPathClass(const CameraPathClass&);
+    ~CameraPathClass();
+
+    bool Initialize();
+    void Shutdown();
+
+    bool LoadScript(char*);
+    bool AddKey(float, Vector3Type, Vector3Type);
+    void SetSpline(CameraPathSplineType);
+
+    int Sample(float, Vector3Type&, Vector3Type&);
+
+    int GetSegmentCount();
+    float GetSegmentStart(int);
+    float GetSegmentEnd(int);
+    float GetDuration();
+
+private:
+    Vector3Type GetTangent(int, bool);
+
+private:
+    CameraKeyType* m_keys;
+    int m_keyCount, m_keyCapacity;
+    CameraPathSplineType m_spline;
+};
\ No newline at end of file
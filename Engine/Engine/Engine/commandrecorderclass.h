@@ -0,0 +1,14 @@
+#pragma once
+
+// Records a contiguous range of the frame's draw list on one worker and plays
+// the finished lists back in worker order on the submitting thread.
+// Record is called concurrently for different workers, Execute is not.
+class CommandRecorderClass
+{
+public:
+    virtual ~CommandRecorderClass() {}
+
+    virtual int GetWorkerCount() = 0;
+    virtual bool Record(int, int, int) = 0;
+    virtual bool Execute(int) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "constantringbufferclass.h"
+
+ConstantRingBufferClass::ConstantRingBufferClass()
+{
+    m_buffer = 0;
+
+    m_supportsOffsets = false;
+    m_size = 0;
+    m_blockSize = 0;
+    m_head = 0;
+    m_mappedSize = 0;
+    m_bytesMapped = 0;
+}
+
+ConstantRingBufferClass::ConstantRingBufferClass(const ConstantRingBufferClass& other)
+{
+
+}
+
+ConstantRingBufferClass::~ConstantRingBufferClass()
+{
+
+}
+
+bool ConstantRingBufferClass::Initialize(RenderDeviceClass* device, unsigned int size, unsigned int blockSize)
+{
+    // Offsets are counted in 16 byte constants and have to be a multiple of 16 constants
+    if ((blockSize == 0) || (blockSize % 256) != 0)
+        return false;
+
+    m_blockSize = blockSize;
+
+    // Offset binding needs the 11.1 context and driver support for partial constant buffer binds
+    m_supportsOffsets = device->SupportsConstantOffsets();
+
+    // Without offsetting only one block can be bound at a time
+    if (m_supportsOffsets)
+        m_size = ((size + m_blockSize - 1) / m_blockSize) * m_blockSize;
+    else
+        m_size = m_blockSize;
+
+    // Create the dynamic constant buffer
+    m_buffer = device->CreateBuffer(RENDER_BUFFER_CONSTANT, m_size, true, 0);
+    if (!m_buffer)
+        return false;
+
+    // Start full so the first map discards
+    m_head = m_size;
+    m_bytesMapped = 0;
+
+    return true;
+}
+
+void ConstantRingBufferClass::Shutdown()
+{
+    if (m_buffer)
+    {
+        m_buffer->Release();
+        m_buffer = 0;
+    }
+
+    return;
+}
+
+void ConstantRingBufferClass::BeginFrame()
+{
+    m_bytesMapped = 0;
+    return;
+}
+
+bool ConstantRingBufferClass::Map(RenderContextClass* deviceContext, unsigned int size, void** data, unsigned int& firstConstant)
+{
+    RenderMapType mapType;
+    unsigned int alignedSize;
+    void* dataPtr;
+    bool result;
+
+    // Round up to whole blocks so every offset stays bindable
+    alignedSize = ((size + m_blockSize - 1) / m_blockSize) * m_blockSize;
+    if (alignedSize > m_size)
+        return false;
+
+    // Append behind the data the GPU may still read, or wrap around and rename the buffer
+    if (m_head + alignedSize > m_size)
+    {
+        mapType = RENDER_MAP_DISCARD;
+        m_head = 0;
+    }
+    else
+    {
+        mapType = RENDER_MAP_NO_OVERWRITE;
+    }
+
+    result = deviceContext->Map(m_buffer, mapType, &dataPtr);
+    if (!result)
+        return false;
+
+    *data = (unsigned char*)dataPtr + m_head;
+    firstConstant = m_head / 16;
+
+    m_head += alignedSize;
+    m_mappedSize = alignedSize;
+    m_bytesMapped += alignedSize;
+
+    return true;
+}
+
+void ConstantRingBufferClass::Unmap(RenderContextClass* deviceContext)
+{
+    deviceContext->Unmap(m_buffer, m_mappedSize);
+    return;
+}
+
+void ConstantRingBufferClass::SetConstantBuffers(RenderContextClass* deviceContext, unsigned int slot, unsigned int firstConstant)
+{
+    // Bind the block to the vertex and pixel shader
+    if (m_supportsOffsets)
+        deviceContext->SetConstantBuffer(RENDER_STAGE_VERTEX | RENDER_STAGE_PIXEL, slot, m_buffer, firstConstant, m_blockSize / 16);
+    else
+        deviceContext->SetConstantBuffer(RENDER_STAGE_VERTEX | RENDER_STAGE_PIXEL, slot, m_buffer, 0, 0);
+
+    return;
+}
+
+bool ConstantRingBufferClass::SupportsOffsets()
+{
+    return m_supportsOffsets;
+}
+
+unsigned int ConstantRingBufferClass::GetCapacity()
+{
+    return m_size;
+}
+
+unsigned int ConstantRingBufferClass::GetBlockSize()
+{
+    return m_blockSize;
+}
+
+unsigned int ConstantRingBufferClass::GetBytesMapped()
+{
+    return m_bytesMapped;
+}
\ No newline at end of file
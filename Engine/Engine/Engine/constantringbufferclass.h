@@ -0,0 +1,40 @@
+#pragma once
+
+#include "renderdeviceclass.h"
+
+// One large dynamic constant buffer that per-object blocks are streamed into.
+// Blocks are addressed by their first constant (16 bytes each) and bound with
+// the D3D11.1 offset binding calls. On drivers without constant buffer offsetting
+// the buffer is only one block big and every write discards it.
+// Mapping has to happen on the immediate context, binding works on any context.
+class ConstantRingBufferClass
+{
+public:
+    ConstantRingBufferClass();
+    ConstantRingBufferClass(const ConstantRingBufferClass&);
+    ~ConstantRingBufferClass();
+
+    bool Initialize(RenderDeviceClass*, unsigned int, unsigned int);
+    void Shutdown();
+
+    void BeginFrame();
+
+    bool Map(RenderContextClass*, unsigned int, void**, unsigned int&);
+    void Unmap(RenderContextClass*);
+
+    void SetConstantBuffers(RenderContextClass*, unsigned int, unsigned int);
+
+    bool SupportsOffsets();
+    unsigned int GetCapacity();
+    unsigned int GetBlockSize();
+    unsigned int GetBytesMapped();
+
+private:
+    RenderBuffer* m_buffer;
+
+    bool m_supportsOffsets;
+    unsigned int m_size, m_blockSize;
+    unsigned int m_head;
+    unsigned int m_mappedSize;
+    unsigned int m_bytesMapped;
+};
\ No newline at end of file
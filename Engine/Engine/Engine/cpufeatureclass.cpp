@@ -0,0 +1,261 @@
+#include "cpufeatureclass.h"
+#include "frustumclass.h"
+#include "fontclass.h"
+
+#if CPU_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+bool CpuFeatureClass::m_detected = false;
+unsigned int CpuFeatureClass::m_supported = 0;
+CpuIsaType CpuFeatureClass::m_isa = CPU_ISA_SCALAR;
+
+static const char* g_isaNames[CPU_ISA_COUNT] = { "scalar", "sse4.2", "avx2", "avx512", "neon" };
+
+#if CPU_X86
+static void ReadCpuId(unsigned int leaf, unsigned int subleaf, unsigned int registers[4])
+{
+#ifdef _MSC_VER
+    int values[4];
+
+    __cpuidex(values, (int)leaf, (int)subleaf);
+    registers[0] = (unsigned int)values[0];
+    registers[1] = (unsigned int)values[1];
+    registers[2] = (unsigned int)values[2];
+    registers[3] = (unsigned int)values[3];
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+
+    return;
+}
+
+// Which register sets the OS saves on a thread switch, only valid when CPUID reports OSXSAVE
+static unsigned long long ReadEnabledState()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int low, high;
+
+    __asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return ((unsigned long long)high << 32) | low;
+#endif
+}
+#endif
+
+// Reads the command line's -isa if there is one, after finding out what the machine supports
+void CpuFeatureClass::Initialize(const char* commandLine)
+{
+    CpuIsaType isa;
+    const char* argument;
+    char value[16];
+    int length;
+
+    Detect();
+    m_isa = GetBestIsa();
+
+    if (!commandLine)
+        return;
+
+    // Only match the switch as a whole word, -isaavx2 is not -isa avx2
+    argument = strstr(commandLine, "-isa");
+    while (argument && (((argument != commandLine) && (argument[-1] != ' ')) || (argument[4] != ' ')))
+        argument = strstr(argument + 1, "-isa");
+    if (!argument)
+        return;
+
+    argument += 4;
+    while (*argument == ' ')
+        argument++;
+
+    length = 0;
+    while (argument[length] && (argument[length] != ' ') && (length < (int)sizeof(value) - 1))
+    {
+        value[length] = argument[length];
+        length++;
+    }
+    value[length] = 0;
+
+    if (!ParseIsa(value, isa))
+    {
+        printf("Unknown instruction set '%s', using %s\n", value, GetIsaName(m_isa));
+        return;
+    }
+
+    // Forcing a set the machine can't run would only crash
+    if (!SetIsa(isa))
+        printf("This machine can't run %s, using %s\n", GetIsaName(isa), GetIsaName(m_isa));
+
+    return;
+}
+
+bool CpuFeatureClass::IsSupported(CpuIsaType isa)
+{
+    Detect();
+
+    return ((m_supported & (1u << isa)) != 0);
+}
+
+// Only affects kernels bound after the call
+bool CpuFeatureClass::SetIsa(CpuIsaType isa)
+{
+    if ((isa < 0) || (isa >= CPU_ISA_COUNT) || !IsSupported(isa))
+        return false;
+
+    m_isa = isa;
+
+    return true;
+}
+
+CpuIsaType CpuFeatureClass::GetIsa()
+{
+    if (!m_detected)
+    {
+        Detect();
+        m_isa = GetBestIsa();
+    }
+
+    return m_isa;
+}
+
+CpuIsaType CpuFeatureClass::GetBestIsa()
+{
+    int isa;
+
+    Detect();
+
+    for (isa = CPU_ISA_COUNT - 1; isa > CPU_ISA_SCALAR; isa--)
+    {
+        if (m_supported & (1u << isa))
+            return (CpuIsaType)isa;
+    }
+
+    return CPU_ISA_SCALAR;
+}
+
+const char* CpuFeatureClass::GetIsaName(CpuIsaType isa)
+{
+    if ((isa < 0) || (isa >= CPU_ISA_COUNT))
+        return "unknown";
+
+    return g_isaNames[isa];
+}
+
+bool CpuFeatureClass::ParseIsa(const char* name, CpuIsaType& isa)
+{
+    int i;
+
+    for (i = 0; i < CPU_ISA_COUNT; i++)
+    {
+        if (strcmp(name, g_isaNames[i]) == 0)
+        {
+            isa = (CpuIsaType)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Each set needs the processor to have it and, for the wider registers, the OS to save them
+void CpuFeatureClass::Detect()
+{
+    if (m_detected)
+        return;
+
+    m_supported = 1u << CPU_ISA_SCALAR;
+
+#if CPU_X86
+    unsigned int registers[4], maxLeaf;
+    unsigned long long enabledState;
+    bool sse42, avx, osSavesYmm, osSavesZmm;
+
+    ReadCpuId(0, 0, registers);
+    maxLeaf = registers[0];
+
+    ReadCpuId(1, 0, registers);
+    sse42 = (registers[2] & (1u << 20)) != 0;
+    avx = ((registers[2] & (1u << 27)) != 0) && ((registers[2] & (1u << 28)) != 0);
+
+    osSavesYmm = false;
+    osSavesZmm = false;
+    if (avx)
+    {
+        enabledState = ReadEnabledState();
+        osSavesYmm = (enabledState & 0x06) == 0x06;
+        osSavesZmm = (enabledState & 0xe6) == 0xe6;
+    }
+
+    if (sse42)
+        m_supported |= 1u << CPU_ISA_SSE42;
+
+    if (maxLeaf >= 7)
+    {
+        ReadCpuId(7, 0, registers);
+
+        if (sse42 && avx && osSavesYmm && (registers[1] & (1u << 5)))
+        {
+            m_supported |= 1u << CPU_ISA_AVX2;
+
+            if (osSavesZmm && (registers[1] & (1u << 16)))
+                m_supported |= 1u << CPU_ISA_AVX512;
+        }
+    }
+#endif
+
+#if CPU_NEON
+    // Every 64 bit ARM has it, and a 32 bit build only defines __ARM_NEON when told it's there
+    m_supported |= 1u << CPU_ISA_NEON;
+#endif
+
+    m_detected = true;
+
+    return;
+}
+
+// The set to try when a kernel has no version for this one
+CpuIsaType CpuFeatureClass::GetFallback(CpuIsaType isa)
+{
+    switch (isa)
+    {
+    case CPU_ISA_AVX512:
+        return CPU_ISA_AVX2;
+    case CPU_ISA_AVX2:
+        return CPU_ISA_SSE42;
+    default:
+        return CPU_ISA_SCALAR;
+    }
+}
+
+// Lists what was found, then runs every kernel's versions that this machine
+// supports against its scalar one and times them
+bool CpuFeatureClass::RunTests(char* filename)
+{
+    ofstream fout;
+    bool result;
+    int i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    for (i = 0; i < CPU_ISA_COUNT; i++)
+        fout << g_isaNames[i] << ": " << (IsSupported((CpuIsaType)i) ? "yes" : "no") << endl;
+    fout << "selected: " << GetIsaName(GetIsa()) << endl << endl;
+
+    result = FrustumClass::TestKernels(fout);
+    fout << endl;
+    result = FontClass::TestKernels(fout) && result;
+
+    fout << endl << (result ? "all kernels match" : "KERNEL MISMATCH") << endl;
+    fout.close();
+
+    printf("%s, running %s, results in %s\n", result ? "All kernels match" : "Kernel mismatch", GetIsaName(GetIsa()), filename);
+
+    return result;
+}
\ No newline at end of file
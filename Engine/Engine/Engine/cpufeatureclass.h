@@ -0,0 +1,81 @@
+#pragma once
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+using namespace std;
+
+// Which instruction sets this build can carry code for. Kernels for a newer
+// set than the build targets are compiled for it one function at a time with
+// CPU_TARGET, MSVC lets any function use the intrinsics without it.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#include <immintrin.h>
+#else
+#define CPU_X86 0
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define CPU_NEON 1
+#include <arm_neon.h>
+#else
+#define CPU_NEON 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CPU_TARGET(isa)
+#endif
+
+// Ordered so each x86 level includes the ones before it
+enum CpuIsaType
+{
+    CPU_ISA_SCALAR,
+    CPU_ISA_SSE42,
+    CPU_ISA_AVX2,
+    CPU_ISA_AVX512,
+    CPU_ISA_NEON,
+    CPU_ISA_COUNT
+};
+
+// Finds what the processor and OS support once at startup and picks the
+// instruction set hot kernels run with, the best one unless -isa forces
+// another. A kernel keeps a table of its versions indexed by CpuIsaType,
+// null where it has none, and Bind hands back the one for the picked set or
+// the next one down that exists. Every table needs a scalar entry.
+class CpuFeatureClass
+{
+public:
+    static void Initialize(const char*);
+    static bool IsSupported(CpuIsaType);
+    static bool SetIsa(CpuIsaType);
+    static CpuIsaType GetIsa();
+    static CpuIsaType GetBestIsa();
+    static const char* GetIsaName(CpuIsaType);
+    static bool ParseIsa(const char*, CpuIsaType&);
+    static bool RunTests(char*);
+
+    template <class FunctionType>
+    static FunctionType Bind(const FunctionType* table)
+    {
+        CpuIsaType isa;
+
+        for (isa = GetIsa(); isa != CPU_ISA_SCALAR; isa = GetFallback(isa))
+        {
+            if (table[isa])
+                return table[isa];
+        }
+
+        return table[CPU_ISA_SCALAR];
+    }
+
+private:
+    static void Detect();
+    static CpuIsaType GetFallback(CpuIsaType);
+
+private:
+    static bool m_detected;
+    static unsigned int m_supported;
+    static CpuIsaType m_isa;
+};
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "cpurecorderclass.h"
+
+CpuRecorderClass::CpuRecorderClass()
+{
+    m_workerCount = 0;
+    m_maxItems = 0;
+    m_workerItems = 0;
+    m_workerItemCounts = 0;
+    m_executed = 0;
+    m_executedWorkers = 0;
+    m_executedCount = 0;
+}
+
+CpuRecorderClass::CpuRecorderClass(const CpuRecorderClass& other)
+{
+
+}
+
+CpuRecorderClass::~CpuRecorderClass()
+{
+
+}
+
+bool CpuRecorderClass::Initialize(int workerCount, int maxItems)
+{
+    int i;
+
+    m_workerCount = workerCount;
+    m_maxItems = maxItems;
+
+    // Create one item list per worker
+    m_workerItems = new int*[m_workerCount];
+    if (!m_workerItems)
+        return false;
+
+    for (i = 0; i < m_workerCount; i++)
+        m_workerItems[i] = 0;
+
+    for (i = 0; i < m_workerCount; i++)
+    {
+        m_workerItems[i] = new int[m_maxItems];
+        if (!m_workerItems[i])
+            return false;
+    }
+
+    m_workerItemCounts = new int[m_workerCount];
+    if (!m_workerItemCounts)
+        return false;
+
+    // Create the submission list and note which worker recorded each item
+    m_executed = new int[m_maxItems];
+    if (!m_executed)
+        return false;
+
+    m_executedWorkers = new int[m_maxItems];
+    if (!m_executedWorkers)
+        return false;
+
+    Reset();
+
+    return true;
+}
+
+void CpuRecorderClass::Shutdown()
+{
+    int i;
+
+    if (m_executedWorkers)
+    {
+        delete[] m_executedWorkers;
+        m_executedWorkers = 0;
+    }
+
+    if (m_executed)
+    {
+        delete[] m_executed;
+        m_executed = 0;
+    }
+
+    if (m_workerItemCounts)
+    {
+        delete[] m_workerItemCounts;
+        m_workerItemCounts = 0;
+    }
+
+    if (m_workerItems)
+    {
+        for (i = 0; i < m_workerCount; i++)
+        {
+            if (m_workerItems[i])
+                delete[] m_workerItems[i];
+        }
+
+        delete[] m_workerItems;
+        m_workerItems = 0;
+    }
+
+    return;
+}
+
+void CpuRecorderClass::Reset()
+{
+    int i;
+
+    for (i = 0; i < m_workerCount; i++)
+        m_workerItemCounts[i] = 0;
+
+    m_executedCount = 0;
+
+    return;
+}
+
+int CpuRecorderClass::GetWorkerCount()
+{
+    return m_workerCount;
+}
+
+bool CpuRecorderClass::Record(int worker, int first, int last)
+{
+    int i;
+
+    if ((last - first) > m_maxItems)
+        return false;
+
+    // Only this worker touches its own list
+    m_workerItemCounts[worker] = 0;
+    for (i = first; i < last; i++)
+    {
+        m_workerItems[worker][m_workerItemCounts[worker]] = i;
+        m_workerItemCounts[worker]++;
+    }
+
+    return true;
+}
+
+bool CpuRecorderClass::Execute(int worker)
+{
+    int i;
+
+    if ((m_executedCount + m_workerItemCounts[worker]) > m_maxItems)
+        return false;
+
+    for (i = 0; i < m_workerItemCounts[worker]; i++)
+    {
+        m_executed[m_executedCount] = m_workerItems[worker][i];
+        m_executedWorkers[m_executedCount] = worker;
+        m_executedCount++;
+    }
+
+    m_workerItemCounts[worker] = 0;
+
+    return true;
+}
+
+int CpuRecorderClass::GetExecutedCount()
+{
+    return m_executedCount;
+}
+
+int CpuRecorderClass::GetExecutedItem(int index)
+{
+    return m_executed[index];
+}
+
+int CpuRecorderClass::GetExecutedWorker(int index)
+{
+    return m_executedWorkers[index];
+}
+
+int CpuRecorderClass::GetRecordedCount(int worker)
+{
+    return m_workerItemCounts[worker];
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "commandrecorderclass.h"
+
+// Recorder without a device. Each worker writes the draw items of its range into
+// its own list and Execute appends the lists to one submission list, so the
+// partitioning and ordering can be checked on any platform.
+class CpuRecorderClass : public CommandRecorderClass
+{
+public:
+    CpuRecorderClass();
+    CpuRecorderClass(const CpuRecorderClass&);
+    ~CpuRecorderClass();
+
+    bool Initialize(int, int);
+    void Shutdown();
+    void Reset();
+
+    int GetWorkerCount();
+    bool Record(int, int, int);
+    bool Execute(int);
+
+    int GetExecutedCount();
+    int GetExecutedItem(int);
+    int GetExecutedWorker(int);
+    int GetRecordedCount(int);
+
+private:
+    int m_workerCount, m_maxItems;
+    int** m_workerItems;
+    int* m_workerItemCounts;
+    int* m_executed;
+    int* m_executedWorkers;
+    int m_executedCount;
+};
\ No newline at end of file
@@ -14,6 +14,11 @@ D3DClass::D3DClass()
     m_depthDisabledStencilState = 0;
     m_alphaEnableBlendingState = 0;
     m_alphaDisableBlendingState = 0;
+    m_context = 0;
+    m_shaderCache = 0;
+    m_stateCache = 0;
+    m_pipelineCache = 0;
+    m_supportsOffsets = false;
 }
 
 D3DClass::D3DClass(const D3DClass& other)
@@ -48,8 +53,10 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	float fieldOfView, screenAspect;
     D3D11_DEPTH_STENCIL_DESC depthDisabledStencilDesc;
     D3D11_BLEND_DESC blendStateDescription;
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options;
 
 	m_vsync_enabled = vsync;
+    m_hwnd = hwnd;
 
 	// Create DX graphics interface factory
 	result = CreateDXGIFactory(__uuidof(IDXGIFactory), (void**)&factory);
@@ -151,6 +158,21 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	backBufferPtr->Release();
 	backBufferPtr = 0;
 
+    // Every state object below comes from the cache and is shared by description
+    m_stateCache = new D3DStateCacheClass;
+    if (!m_stateCache)
+        return false;
+
+    if (!m_stateCache->Initialize(m_device))
+        return false;
+
+    m_pipelineCache = new PipelineStateCacheClass;
+    if (!m_pipelineCache)
+        return false;
+
+    if (!m_pipelineCache->Initialize(CreatePipelineState, this))
+        return false;
+
     // Setup depth buffer description
 	ZeroMemory(&depthBufferDesc, sizeof(depthBufferDesc));
 	depthBufferDesc.Width = screenWidth;
@@ -188,8 +210,8 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	depthStencilDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 
 	// Depth stencil state
-	result = m_device->CreateDepthStencilState(&depthStencilDesc, &m_depthStencilState);
-	if (FAILED(result))
+	m_depthStencilState = m_stateCache->GetDepthStencilState(depthStencilDesc);
+	if (!m_depthStencilState)
 		return false;
 
     // Set depth stencil state
@@ -221,8 +243,8 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	rasterDesc.ScissorEnable = false;
 	rasterDesc.SlopeScaledDepthBias = 0.0f;
 	// Create rasterizer state
-	result = m_device->CreateRasterizerState(&rasterDesc, &m_rasterState);
-	if (FAILED(result))
+	m_rasterState = m_stateCache->GetRasterizerState(rasterDesc);
+	if (!m_rasterState)
 		return false;
 	m_deviceContext->RSSetState(m_rasterState);    // Set state
 
@@ -234,12 +256,13 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	viewport.TopLeftX = 0.0f;
 	viewport.TopLeftY = 0.0f;
 	m_deviceContext->RSSetViewports(1, &viewport);    // Create viewport
+	m_viewport = viewport;
 
-	fieldOfView = (float)D3DX_PI / 4.0f;
+	fieldOfView = (float)MATH_PI / 4.0f;
 	screenAspect = (float)screenWidth / (float)screenHeight;
-	D3DXMatrixPerspectiveFovLH(&m_projectionMatrix, fieldOfView, screenAspect, screenNear, screenDepth);
-	D3DXMatrixIdentity(&m_worldMatrix);    // Convert vertice of objects to vertice in 3D space
-	D3DXMatrixOrthoLH(&m_orthoMatrix, (float)screenWidth, (float)screenHeight, screenNear, screenDepth);
+	MatrixPerspectiveFovLH(&m_projectionMatrix, fieldOfView, screenAspect, screenNear, screenDepth);
+	MatrixIdentity(&m_worldMatrix);    // Convert vertice of objects to vertice in 3D space
+	MatrixOrthoLH(&m_orthoMatrix, (float)screenWidth, (float)screenHeight, screenNear, screenDepth);
 
     // Clear the second depth stencil state
     ZeroMemory(&depthDisabledStencilDesc, sizeof(depthDisabledStencilDesc));
@@ -261,8 +284,8 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
     depthDisabledStencilDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 
     // Create state
-    result = m_device->CreateDepthStencilState(&depthDisabledStencilDesc, &m_depthDisabledStencilState);
-    if (FAILED(result))
+    m_depthDisabledStencilState = m_stateCache->GetDepthStencilState(depthDisabledStencilDesc);
+    if (!m_depthDisabledStencilState)
         return false;
 
     // Clear blend state desciption
@@ -279,16 +302,39 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
     blendStateDescription.RenderTarget[0].RenderTargetWriteMask = 0x0f;
 
     // Create blend state
-    result = m_device->CreateBlendState(&blendStateDescription, &m_alphaEnableBlendingState);
-    if (FAILED(result))
+    m_alphaEnableBlendingState = m_stateCache->GetBlendState(blendStateDescription);
+    if (!m_alphaEnableBlendingState)
         return false;
 
     // Modify scription to create an alpha disabled blend state description
     blendStateDescription.RenderTarget[0].BlendEnable = FALSE;
 
     // Create blend state
-    result = m_device->CreateBlendState(&blendStateDescription, &m_alphaDisableBlendingState);
-    if (FAILED(result))
+    m_alphaDisableBlendingState = m_stateCache->GetBlendState(blendStateDescription);
+    if (!m_alphaDisableBlendingState)
+        return false;
+
+    // Offset binding of constant buffers needs driver support for partial binds
+    m_supportsOffsets = false;
+    ZeroMemory(&options, sizeof(options));
+    result = m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+    if (SUCCEEDED(result) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer)
+        m_supportsOffsets = true;
+
+    // Wrap the immediate context for the render path
+    m_context = new D3DRenderContextClass(this, m_deviceContext, false);
+    if (!m_context)
+        return false;
+
+    if (m_supportsOffsets && !m_context->SupportsOffsets())
+        m_supportsOffsets = false;
+
+    // Shaders compiled on an earlier run are loaded instead of compiled again
+    m_shaderCache = new ShaderCacheClass;
+    if (!m_shaderCache)
+        return false;
+
+    if (!m_shaderCache->Initialize("shaders.cache", "shader-cache.txt", CompileShaderFile, this))
         return false;
 
 	return true;
@@ -301,39 +347,45 @@ void D3DClass::Shutdown()
 	if (m_swapChain)
 		m_swapChain->SetFullscreenState(false, NULL);
 
-    if (m_alphaEnableBlendingState)
+    if (m_shaderCache)
     {
-        m_alphaEnableBlendingState->Release();
-        m_alphaEnableBlendingState = 0;
+        m_shaderCache->Shutdown();
+        delete m_shaderCache;
+        m_shaderCache = 0;
     }
 
-    if (m_alphaDisableBlendingState)
+    if (m_context)
     {
-        m_alphaDisableBlendingState->Release();
-        m_alphaDisableBlendingState = 0;
+        m_context->Release();
+        m_context = 0;
     }
 
-    if (m_depthDisabledStencilState)
+    if (m_pipelineCache)
     {
-        m_depthDisabledStencilState->Release();
-        m_depthDisabledStencilState = 0;
+        m_pipelineCache->Shutdown();
+        delete m_pipelineCache;
+        m_pipelineCache = 0;
     }
 
-	if (m_rasterState)
-	{
-		m_rasterState->Release();
-		m_rasterState = 0;
-	}
+    // Releases every shared state object
+    if (m_stateCache)
+    {
+        m_stateCache->Shutdown();
+        delete m_stateCache;
+        m_stateCache = 0;
+    }
+
+    m_alphaEnableBlendingState = 0;
+    m_alphaDisableBlendingState = 0;
+    m_depthDisabledStencilState = 0;
+    m_depthStencilState = 0;
+    m_rasterState = 0;
+
 	if (m_depthStencilView)
 	{
 		m_depthStencilView->Release();
 		m_depthStencilView = 0;
 	}
-	if (m_depthStencilState)
-	{
-		m_depthStencilState->Release();
-		m_depthStencilState = 0;
-	}
 	if (m_depthStencilBuffer)
 	{
 		m_depthStencilBuffer->Release();
@@ -365,13 +417,7 @@ void D3DClass::Shutdown()
 void D3DClass::BeginScene(float red, float green, float blue, float alpha)
 {
 	// Initialize buffers
-	float color[4];
-	color[0] = red;
-	color[1] = green;
-	color[2] = blue;
-	color[3] = alpha;
-	m_deviceContext->ClearRenderTargetView(m_renderTargetView, color);
-	m_deviceContext->ClearDepthStencilView(m_depthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+	m_context->Clear(red, green, blue, alpha);
 	return;
 }
 
@@ -396,38 +442,543 @@ ID3D11DeviceContext* D3DClass::GetDeviceContext()
 	return m_deviceContext;
 }
 
+RenderContextClass* D3DClass::GetContext()
+{
+    return m_context;
+}
+
+RenderContextClass* D3DClass::CreateDeferredContext()
+{
+    HRESULT result;
+    ID3D11DeviceContext* deferredContext;
+    D3DRenderContextClass* context;
+
+    result = m_device->CreateDeferredContext(0, &deferredContext);
+    if (FAILED(result))
+        return 0;
+
+    context = new D3DRenderContextClass(this, deferredContext, true);
+    if (!context)
+    {
+        deferredContext->Release();
+        return 0;
+    }
+
+    return context;
+}
+
+bool D3DClass::SupportsConstantOffsets()
+{
+    return m_supportsOffsets;
+}
+
+RenderBuffer* D3DClass::CreateBuffer(RenderBufferType type, unsigned int size, bool dynamic, const void* initialData)
+{
+    D3D11_BUFFER_DESC bufferDesc;
+    D3D11_SUBRESOURCE_DATA bufferData;
+    ID3D11Buffer* buffer;
+    RenderBuffer* renderBuffer;
+    HRESULT result;
+
+    // Dynamic buffers are rewritten by the CPU with map discard
+    if (dynamic)
+    {
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    }
+    else
+    {
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.CPUAccessFlags = 0;
+    }
+
+    bufferDesc.ByteWidth = size;
+    bufferDesc.MiscFlags = 0;
+    bufferDesc.StructureByteStride = 0;
+
+    if (type == RENDER_BUFFER_VERTEX)
+        bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    else if (type == RENDER_BUFFER_INDEX)
+        bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    else
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+    bufferData.pSysMem = initialData;
+    bufferData.SysMemPitch = 0;
+    bufferData.SysMemSlicePitch = 0;
+
+    if (initialData)
+        result = m_device->CreateBuffer(&bufferDesc, &bufferData, &buffer);
+    else
+        result = m_device->CreateBuffer(&bufferDesc, NULL, &buffer);
+    if (FAILED(result))
+        return 0;
+
+    renderBuffer = new D3DRenderBuffer(buffer);
+    if (!renderBuffer)
+    {
+        buffer->Release();
+        return 0;
+    }
+
+    return renderBuffer;
+}
+
+// The file is mapped and each level handed to D3D where it lies, so the only copy is the driver's
+RenderTexture* D3DClass::LoadTexture(wchar_t* filename)
+{
+    DdsFileClass file;
+    RenderTextureDescType desc;
+    RenderSubresourceType* subresources;
+    const DdsSubresourceType* levels;
+    RenderTexture* texture;
+    char path[260];
+    int i;
+
+    if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+        return 0;
+
+    if (!file.Initialize(path))
+    {
+        file.Shutdown();
+        return 0;
+    }
+
+    subresources = new RenderSubresourceType[file.GetSubresourceCount()];
+    if (!subresources)
+    {
+        file.Shutdown();
+        return 0;
+    }
+
+    levels = file.GetSubresources();
+    for (i = 0; i < file.GetSubresourceCount(); i++)
+    {
+        subresources[i].data = levels[i].data;
+        subresources[i].rowPitch = levels[i].rowPitch;
+        subresources[i].slicePitch = levels[i].slicePitch;
+    }
+
+    desc.format = file.GetFormat();
+    desc.width = file.GetWidth();
+    desc.height = file.GetHeight();
+    desc.mipCount = file.GetMipCount();
+    desc.arraySize = file.GetArraySize();
+    desc.cubemap = file.IsCubemap();
+    desc.hasAlpha = file.HasAlpha();
+    desc.subresources = subresources;
+
+    texture = CreateTexture(desc);
+
+    delete[] subresources;
+    subresources = 0;
+    file.Shutdown();
+
+    return texture;
+}
+
+// The data only has to stay valid for the call, an immutable texture keeps its own copy
+RenderTexture* D3DClass::CreateTexture(const RenderTextureDescType& desc)
+{
+    D3D11_TEXTURE2D_DESC textureDesc;
+    D3D11_SUBRESOURCE_DATA* initialData;
+    D3DRenderTexture* texture;
+    HRESULT result;
+    int i;
+
+    initialData = new D3D11_SUBRESOURCE_DATA[desc.mipCount * desc.arraySize];
+    if (!initialData)
+        return 0;
+
+    for (i = 0; i < desc.mipCount * desc.arraySize; i++)
+    {
+        initialData[i].pSysMem = desc.subresources[i].data;
+        initialData[i].SysMemPitch = desc.subresources[i].rowPitch;
+        initialData[i].SysMemSlicePitch = desc.subresources[i].slicePitch;
+    }
+
+    ZeroMemory(&textureDesc, sizeof(textureDesc));
+    textureDesc.Width = desc.width;
+    textureDesc.Height = desc.height;
+    textureDesc.MipLevels = desc.mipCount;
+    textureDesc.ArraySize = desc.arraySize;
+    textureDesc.Format = (DXGI_FORMAT)desc.format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    textureDesc.CPUAccessFlags = 0;
+    textureDesc.MiscFlags = desc.cubemap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+    texture = new D3DRenderTexture;
+    if (!texture)
+    {
+        delete[] initialData;
+        return 0;
+    }
+
+    result = m_device->CreateTexture2D(&textureDesc, initialData, &texture->m_texture);
+
+    delete[] initialData;
+    initialData = 0;
+
+    if (FAILED(result))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    // The default view covers every level and slice, and is a cube view for cubemaps
+    result = m_device->CreateShaderResourceView(texture->m_texture, NULL, &texture->m_shaderResourceView);
+    if (FAILED(result))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    return texture;
+}
+
+RenderTexture* D3DClass::CreateRenderTexture(int width, int height, unsigned int format, bool depth)
+{
+    D3D11_TEXTURE2D_DESC textureDesc;
+    D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+    D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+    D3DRenderTexture* texture;
+    HRESULT result;
+
+    texture = new D3DRenderTexture;
+    if (!texture)
+        return 0;
+
+    ZeroMemory(&textureDesc, sizeof(textureDesc));
+    textureDesc.Width = width;
+    textureDesc.Height = height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.CPUAccessFlags = 0;
+    textureDesc.MiscFlags = 0;
+
+    // Depth targets are typeless so they can also be sampled
+    if (depth)
+    {
+        textureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+    }
+    else
+    {
+        textureDesc.Format = (DXGI_FORMAT)format;
+        textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    }
+
+    result = m_device->CreateTexture2D(&textureDesc, NULL, &texture->m_texture);
+    if (FAILED(result))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    ZeroMemory(&shaderResourceViewDesc, sizeof(shaderResourceViewDesc));
+    shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+    shaderResourceViewDesc.Texture2D.MipLevels = 1;
+
+    if (depth)
+    {
+        ZeroMemory(&depthStencilViewDesc, sizeof(depthStencilViewDesc));
+        depthStencilViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+        depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+        depthStencilViewDesc.Texture2D.MipSlice = 0;
+
+        result = m_device->CreateDepthStencilView(texture->m_texture, &depthStencilViewDesc, &texture->m_depthStencilView);
+        shaderResourceViewDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    }
+    else
+    {
+        result = m_device->CreateRenderTargetView(texture->m_texture, NULL, &texture->m_renderTargetView);
+        shaderResourceViewDesc.Format = textureDesc.Format;
+    }
+    if (FAILED(result))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    result = m_device->CreateShaderResourceView(texture->m_texture, &shaderResourceViewDesc, &texture->m_shaderResourceView);
+    if (FAILED(result))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    return texture;
+}
+
+RenderProgram* D3DClass::CreateProgram(const RenderProgramDescType& desc)
+{
+    HRESULT result;
+    ShaderBytecodeType vertexShaderBuffer;
+    ShaderBytecodeType pixelShaderBuffer;
+    D3D11_INPUT_ELEMENT_DESC polygonLayout[8];
+    D3D11_SAMPLER_DESC samplerDesc;
+    D3DRenderProgram* program;
+    int i;
+
+    if (desc.elementCount > 8)
+        return 0;
+
+    // Compile vertex shader
+    if (!CompileShader(desc.vsFilename, desc.vsEntry, "vs_5_0", vertexShaderBuffer))
+        return 0;
+
+    // Compile pixel shader
+    if (!CompileShader(desc.psFilename, desc.psEntry, "ps_5_0", pixelShaderBuffer))
+        return 0;
+
+    program = new D3DRenderProgram;
+    if (!program)
+        return 0;
+
+    // Create vertex shader from the buffer
+    result = m_device->CreateVertexShader(vertexShaderBuffer.data, vertexShaderBuffer.size, NULL, &program->m_vertexShader);
+
+    // Create pixel shader from the buffer
+    if (SUCCEEDED(result))
+        result = m_device->CreatePixelShader(pixelShaderBuffer.data, pixelShaderBuffer.size, NULL, &program->m_pixelShader);
+
+    // Vertex input layout description, float vectors packed one after the other
+    for (i = 0; i < desc.elementCount; i++)
+    {
+        polygonLayout[i].SemanticName = desc.elements[i].semanticName;
+        polygonLayout[i].SemanticIndex = desc.elements[i].semanticIndex;
+        if (desc.elements[i].floatCount == 4)
+            polygonLayout[i].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+        else if (desc.elements[i].floatCount == 3)
+            polygonLayout[i].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+        else if (desc.elements[i].floatCount == 2)
+            polygonLayout[i].Format = DXGI_FORMAT_R32G32_FLOAT;
+        else
+            polygonLayout[i].Format = DXGI_FORMAT_R32_FLOAT;
+        polygonLayout[i].InputSlot = 0;
+        polygonLayout[i].AlignedByteOffset = (i == 0) ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+        polygonLayout[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+        polygonLayout[i].InstanceDataStepRate = 0;
+    }
+
+    // Create vertex input layout
+    if (SUCCEEDED(result))
+        result = m_device->CreateInputLayout(polygonLayout, desc.elementCount, vertexShaderBuffer.data, vertexShaderBuffer.size, &program->m_layout);
+
+    if (FAILED(result))
+    {
+        program->Release();
+        return 0;
+    }
+
+    // Create texture sampler state description
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.MipLODBias = 0.0f;
+    samplerDesc.MaxAnisotropy = 1;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+    samplerDesc.BorderColor[0] = 0;
+    samplerDesc.BorderColor[1] = 0;
+    samplerDesc.BorderColor[2] = 0;
+    samplerDesc.BorderColor[3] = 0;
+    samplerDesc.MinLOD = 0;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+    // Programs sampling the same way share one sampler state
+    program->m_sampleState = m_stateCache->GetSamplerState(samplerDesc);
+    if (!program->m_sampleState)
+    {
+        program->Release();
+        return 0;
+    }
+
+    return program;
+}
+
+// Equal descriptions share one pipeline state, created on first use
+RenderPipelineState* D3DClass::GetPipelineState(const RenderPipelineDescType& desc)
+{
+    return m_pipelineCache->GetPipelineState(desc);
+}
+
+D3DStateCacheClass* D3DClass::GetStateCache()
+{
+    return m_stateCache;
+}
+
+// Resolves the fixed function part of a pipeline description to shared state objects
+RenderPipelineState* D3DClass::CreatePipelineState(const RenderPipelineDescType& desc, void* userData)
+{
+    D3DClass* d3d;
+    D3DRenderPipelineState* pipelineState;
+    D3D11_RASTERIZER_DESC rasterDesc;
+
+    d3d = (D3DClass*)userData;
+
+    pipelineState = new D3DRenderPipelineState;
+    if (!pipelineState)
+        return 0;
+
+    pipelineState->m_depthStencilState = desc.depthEnabled ? d3d->m_depthStencilState : d3d->m_depthDisabledStencilState;
+    pipelineState->m_blendState = desc.blendEnabled ? d3d->m_alphaEnableBlendingState : d3d->m_alphaDisableBlendingState;
+
+    // Same as the default rasterizer state apart from cull and fill
+    rasterDesc.AntialiasedLineEnable = false;
+    rasterDesc.CullMode = (desc.cullMode == RENDER_CULL_NONE) ? D3D11_CULL_NONE : D3D11_CULL_BACK;
+    rasterDesc.DepthBias = 0;
+    rasterDesc.DepthBiasClamp = 0.0f;
+    rasterDesc.DepthClipEnable = true;
+    rasterDesc.FillMode = desc.wireframe ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+    rasterDesc.FrontCounterClockwise = false;
+    rasterDesc.MultisampleEnable = false;
+    rasterDesc.ScissorEnable = false;
+    rasterDesc.SlopeScaledDepthBias = 0.0f;
+
+    pipelineState->m_rasterState = d3d->m_stateCache->GetRasterizerState(rasterDesc);
+    if (!pipelineState->m_rasterState)
+    {
+        delete pipelineState;
+        return 0;
+    }
+
+    return pipelineState;
+}
+
+// Bytecode comes out of the cache, which only calls the compiler on a miss
+bool D3DClass::CompileShader(wchar_t* filename, char* entry, char* profile, ShaderBytecodeType& bytecode)
+{
+    return m_shaderCache->GetShader(filename, entry, profile, SHADER_COMPILE_FLAGS, bytecode);
+}
+
+// Compiler handed to the cache. The blob is copied so the cache owns plain memory
+bool D3DClass::CompileShaderFile(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+    HRESULT result;
+    ID3D10Blob* errorMessage;
+    ID3D10Blob* shaderBuffer;
+    HWND hwnd;
+
+    // The offline precompile has no window to report to
+    hwnd = userData ? ((D3DClass*)userData)->m_hwnd : 0;
+
+    errorMessage = 0;
+    shaderBuffer = 0;
+
+    result = D3DX11CompileFromFile(filename, (D3D10_SHADER_MACRO*)defines, NULL, entry, profile, flags, 0, NULL, &shaderBuffer, &errorMessage, NULL);
+    if (FAILED(result))
+    {
+        if (errorMessage)
+        {
+            OutputShaderErrorMessage(errorMessage, filename, hwnd);
+        }
+        else if (hwnd)
+        {
+            MessageBox(hwnd, filename, L"Missing Shader File", MB_OK);
+        }
+        return false;
+    }
+
+    bytecode.size = (unsigned int)shaderBuffer->GetBufferSize();
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+    {
+        shaderBuffer->Release();
+        return false;
+    }
+
+    memcpy(bytecode.data, shaderBuffer->GetBufferPointer(), bytecode.size);
+
+    shaderBuffer->Release();
+    shaderBuffer = 0;
+
+    return true;
+}
+
+void D3DClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, wchar_t* shaderFilename, HWND hwnd)
+{
+    char* compileErrors;
+    unsigned long bufferSize, i;
+    ofstream fout;
+
+    // Pointer to the error message text buffer
+    compileErrors = (char*)(errorMessage->GetBufferPointer());
+
+    bufferSize = errorMessage->GetBufferSize();
+
+    fout.open("shader-error.txt");
+
+    for (i = 0; i < bufferSize; i++)
+        fout << compileErrors[i];
+
+    fout.close();
+
+    errorMessage->Release();
+    errorMessage = 0;
+
+    if (hwnd)
+        MessageBox(hwnd, L"Error compiling shader. Check shader-error.txt for message.", shaderFilename, MB_OK);
+
+    return;
+}
+
+// Compiles every shader named in the manifest into the cache file without
+// creating a device, so a build step can ship a warm cache
+bool D3DClass::PrecompileShaders(char* manifestFilename)
+{
+    ShaderCacheClass shaderCache;
+    bool result;
+
+    result = shaderCache.Initialize("shaders.cache", "shader-cache.txt", CompileShaderFile, 0);
+    if (!result)
+        return false;
+
+    result = shaderCache.Precompile(manifestFilename, SHADER_COMPILE_FLAGS);
+
+    shaderCache.Shutdown();
+
+    return result;
+}
+
 // Give copies of matrices
-void D3DClass::GetProjectionMatrix(D3DXMATRIX& projectionMatrix)
+void D3DClass::GetProjectionMatrix(MatrixType& projectionMatrix)
 {
 	projectionMatrix = m_projectionMatrix;
 	return;
 }
 
-void D3DClass::GetWorldMatrix(D3DXMATRIX& worldMatrix)
+void D3DClass::GetWorldMatrix(MatrixType& worldMatrix)
 {
 	worldMatrix = m_worldMatrix;
 	return;
 }
 
-void D3DClass::GetOrthoMatrix(D3DXMATRIX& orthoMatrix)
+void D3DClass::GetOrthoMatrix(MatrixType& orthoMatrix)
 {
 	orthoMatrix = m_orthoMatrix;
 	return;
 }
 
-void D3DClass::TurnZBufferOn()
+void D3DClass::SetDepthState(ID3D11DeviceContext* deviceContext, bool enabled)
 {
-    m_deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
-    return;
-}
+    // 2D rendering turns the Z buffer off
+    if (enabled)
+        deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
+    else
+        deviceContext->OMSetDepthStencilState(m_depthDisabledStencilState, 1);
 
-void D3DClass::TurnZBufferOff()
-{
-    m_deviceContext->OMSetDepthStencilState(m_depthDisabledStencilState, 1);
     return;
 }
 
-void D3DClass::TurnOnAlphaBlending()
+void D3DClass::SetBlendState(ID3D11DeviceContext* deviceContext, bool enabled)
 {
     float blendFactor[4];
 
@@ -437,24 +988,35 @@ void D3DClass::TurnOnAlphaBlending()
     blendFactor[2] = 0.0f;
     blendFactor[3] = 0.0f;
 
-    // Turn on alpha blending
-    m_deviceContext->OMSetBlendState(m_alphaEnableBlendingState, blendFactor, 0xffffffff); // 8 F
+    // Turn alpha blending on or off
+    if (enabled)
+        deviceContext->OMSetBlendState(m_alphaEnableBlendingState, blendFactor, 0xffffffff); // 8 F
+    else
+        deviceContext->OMSetBlendState(m_alphaDisableBlendingState, blendFactor, 0xffffffff); // 8 F
 
     return;
 }
 
-void D3DClass::TurnOffAlphaBlending()
+void D3DClass::ClearBackBuffer(ID3D11DeviceContext* deviceContext, float red, float green, float blue, float alpha)
 {
-    float blendFactor[4];
+	float color[4];
 
-    // Setup blend factor
-    blendFactor[0] = 0.0f;
-    blendFactor[1] = 0.0f;
-    blendFactor[2] = 0.0f;
-    blendFactor[3] = 0.0f;
+	color[0] = red;
+	color[1] = green;
+	color[2] = blue;
+	color[3] = alpha;
+	deviceContext->ClearRenderTargetView(m_renderTargetView, color);
+	deviceContext->ClearDepthStencilView(m_depthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+	return;
+}
 
-    // Turn on alpha blending
-    m_deviceContext->OMSetBlendState(m_alphaDisableBlendingState, blendFactor, 0xffffffff); // 8 F
+void D3DClass::SetBackBufferRenderTarget(ID3D11DeviceContext* deviceContext)
+{
+    // Deferred contexts start with empty state, give them what the 3D pass expects
+    deviceContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilView);
+    deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
+    deviceContext->RSSetState(m_rasterState);
+    deviceContext->RSSetViewports(1, &m_viewport);
 
     return;
 }
\ No newline at end of file
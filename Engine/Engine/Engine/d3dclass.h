@@ -2,14 +2,24 @@
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3dx11.lib")
-#pragma comment(lib, "d3dx10.lib")    // Functions didn't need to be changed from D10 for D11
 
 #include <dxgi.h>
 #include <d3dcommon.h>
 #include <d3d11.h>
-#include <d3dx10math.h>
+#include "mathclass.h"
+#include <d3dx11async.h>
+#include <fstream>
+#include "renderdeviceclass.h"
+#include "ddsfileclass.h"
+#include "d3drendercontextclass.h"
+#include "shadercacheclass.h"
+#include "d3dstatecacheclass.h"
+#include "pipelinestatecacheclass.h"
+using namespace std;
 
-class D3DClass
+const unsigned int SHADER_COMPILE_FLAGS = D3D10_SHADER_ENABLE_STRICTNESS;
+
+class D3DClass : public RenderDeviceClass
 {
 public:
 	D3DClass();
@@ -25,31 +35,59 @@ public:
     ID3D11Device* GetDevice();
 	ID3D11DeviceContext* GetDeviceContext();
 
-	void GetProjectionMatrix(D3DXMATRIX&);
-	void GetWorldMatrix(D3DXMATRIX&);
-	void GetOrthoMatrix(D3DXMATRIX&);
+    RenderContextClass* GetContext();
+    RenderContextClass* CreateDeferredContext();
+    bool SupportsConstantOffsets();
+
+    RenderBuffer* CreateBuffer(RenderBufferType, unsigned int, bool, const void*);
+    RenderTexture* LoadTexture(wchar_t*);
+    RenderTexture* CreateTexture(const RenderTextureDescType&);
+    RenderTexture* CreateRenderTexture(int, int, unsigned int, bool);
+    RenderProgram* CreateProgram(const RenderProgramDescType&);
+    RenderPipelineState* GetPipelineState(const RenderPipelineDescType&);
+    D3DStateCacheClass* GetStateCache();
+
+	void GetProjectionMatrix(MatrixType&);
+	void GetWorldMatrix(MatrixType&);
+	void GetOrthoMatrix(MatrixType&);
 
-    void TurnZBufferOn();
-    void TurnZBufferOff();
+    // Offline build of the shader cache, run with -precompile before shipping
+    static bool PrecompileShaders(char*);
 
-    void TurnOnAlphaBlending();
-    void TurnOffAlphaBlending();
+    // Shared state objects, applied to any context by D3DRenderContextClass
+    void SetDepthState(ID3D11DeviceContext*, bool);
+    void SetBlendState(ID3D11DeviceContext*, bool);
+    void ClearBackBuffer(ID3D11DeviceContext*, float, float, float, float);
+    void SetBackBufferRenderTarget(ID3D11DeviceContext*);
+
+private:
+    bool CompileShader(wchar_t*, char*, char*, ShaderBytecodeType&);
+    static RenderPipelineState* CreatePipelineState(const RenderPipelineDescType&, void*);
+    static bool CompileShaderFile(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+    static void OutputShaderErrorMessage(ID3D10Blob*, wchar_t*, HWND);
 
 private:
 	bool m_vsync_enabled;
+    HWND m_hwnd;
+    bool m_supportsOffsets;
+    D3DRenderContextClass* m_context;
+    ShaderCacheClass* m_shaderCache;
+    D3DStateCacheClass* m_stateCache;
+    PipelineStateCacheClass* m_pipelineCache;
 
 	IDXGISwapChain* m_swapChain;
 	ID3D11Device* m_device;
 	ID3D11DeviceContext* m_deviceContext;
 	ID3D11RenderTargetView* m_renderTargetView;
 	ID3D11Texture2D* m_depthStencilBuffer;
-	ID3D11DepthStencilState* m_depthStencilState;
+	ID3D11DepthStencilState* m_depthStencilState;    // State objects belong to m_stateCache
 	ID3D11DepthStencilView* m_depthStencilView;
 	ID3D11RasterizerState* m_rasterState;
+	D3D11_VIEWPORT m_viewport;
 	
-    D3DXMATRIX m_projectionMatrix;
-	D3DXMATRIX m_worldMatrix;
-	D3DXMATRIX m_orthoMatrix;
+    MatrixType m_projectionMatrix;
+	MatrixType m_worldMatrix;
+	MatrixType m_orthoMatrix;
     
     ID3D11DepthStencilState* m_depthDisabledStencilState;
     ID3D11BlendState* m_alphaEnableBlendingState;
@@ -0,0 +1,363 @@
+#include "d3drendercontextclass.h"
+#include "d3dclass.h"
+
+D3DRenderTexture::D3DRenderTexture()
+{
+    m_texture = 0;
+    m_renderTargetView = 0;
+    m_depthStencilView = 0;
+    m_shaderResourceView = 0;
+}
+
+void D3DRenderTexture::Release()
+{
+    if (m_shaderResourceView)
+        m_shaderResourceView->Release();
+
+    if (m_depthStencilView)
+        m_depthStencilView->Release();
+
+    if (m_renderTargetView)
+        m_renderTargetView->Release();
+
+    if (m_texture)
+        m_texture->Release();
+
+    delete this;
+}
+
+D3DRenderProgram::D3DRenderProgram()
+{
+    m_vertexShader = 0;
+    m_pixelShader = 0;
+    m_layout = 0;
+    m_sampleState = 0;
+}
+
+// The sampler state is shared through D3DClass's state cache
+void D3DRenderProgram::Release()
+{
+    if (m_layout)
+        m_layout->Release();
+
+    if (m_pixelShader)
+        m_pixelShader->Release();
+
+    if (m_vertexShader)
+        m_vertexShader->Release();
+
+    delete this;
+}
+
+D3DRenderContextClass::D3DRenderContextClass(D3DClass* d3d, ID3D11DeviceContext* deviceContext, bool deferred)
+{
+    HRESULT result;
+
+    m_D3D = d3d;
+    m_deviceContext = deviceContext;
+    m_deferred = deferred;
+    m_pipelineState = 0;
+
+    // The 11.1 interface is only needed for constant buffer offsets
+    result = m_deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_deviceContext1);
+    if (FAILED(result))
+        m_deviceContext1 = 0;
+}
+
+void D3DRenderContextClass::Release()
+{
+    if (m_deviceContext1)
+    {
+        m_deviceContext1->Release();
+        m_deviceContext1 = 0;
+    }
+
+    // The immediate context itself is released by D3DClass
+    if (m_deferred)
+        m_deviceContext->Release();
+
+    delete this;
+}
+
+bool D3DRenderContextClass::Map(RenderBuffer* buffer, RenderMapType mapType, void** data)
+{
+    HRESULT result;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+    if (mapType == RENDER_MAP_NO_OVERWRITE)
+        result = m_deviceContext->Map(((D3DRenderBuffer*)buffer)->m_buffer, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
+    else
+        result = m_deviceContext->Map(((D3DRenderBuffer*)buffer)->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(result))
+        return false;
+
+    *data = mappedResource.pData;
+
+    return true;
+}
+
+void D3DRenderContextClass::Unmap(RenderBuffer* buffer, unsigned int bytesWritten)
+{
+    m_deviceContext->Unmap(((D3DRenderBuffer*)buffer)->m_buffer, 0);
+
+    m_stats.bufferUploads++;
+    m_stats.bytesUploaded += bytesWritten;
+
+    return;
+}
+
+void D3DRenderContextClass::SetVertexBuffer(RenderBuffer* buffer, unsigned int stride)
+{
+    unsigned int offset;
+
+    offset = 0;
+
+    // Everything the engine draws is a triangle list
+    m_deviceContext->IASetVertexBuffers(0, 1, &((D3DRenderBuffer*)buffer)->m_buffer, &stride, &offset);
+    m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetIndexBuffer(RenderBuffer* buffer)
+{
+    m_deviceContext->IASetIndexBuffer(((D3DRenderBuffer*)buffer)->m_buffer, DXGI_FORMAT_R32_UINT, 0);
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetConstantBuffer(unsigned int stages, unsigned int slot, RenderBuffer* buffer, unsigned int firstConstant, unsigned int numConstants)
+{
+    ID3D11Buffer* d3dBuffer;
+
+    d3dBuffer = ((D3DRenderBuffer*)buffer)->m_buffer;
+
+    // A constant count of zero binds the whole buffer
+    if ((numConstants > 0) && m_deviceContext1)
+    {
+        if (stages & RENDER_STAGE_VERTEX)
+            m_deviceContext1->VSSetConstantBuffers1(slot, 1, &d3dBuffer, &firstConstant, &numConstants);
+
+        if (stages & RENDER_STAGE_PIXEL)
+            m_deviceContext1->PSSetConstantBuffers1(slot, 1, &d3dBuffer, &firstConstant, &numConstants);
+    }
+    else
+    {
+        if (stages & RENDER_STAGE_VERTEX)
+            m_deviceContext->VSSetConstantBuffers(slot, 1, &d3dBuffer);
+
+        if (stages & RENDER_STAGE_PIXEL)
+            m_deviceContext->PSSetConstantBuffers(slot, 1, &d3dBuffer);
+    }
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetTexture(unsigned int slot, RenderTexture* texture)
+{
+    ID3D11ShaderResourceView* shaderResourceView;
+
+    shaderResourceView = 0;
+    if (texture)
+        shaderResourceView = ((D3DRenderTexture*)texture)->m_shaderResourceView;
+
+    m_deviceContext->PSSetShaderResources(slot, 1, &shaderResourceView);
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::UnbindTextures()
+{
+    ID3D11ShaderResourceView* nullViews[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+    int i;
+
+    for (i = 0; i < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; i++)
+        nullViews[i] = 0;
+
+    m_deviceContext->PSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, nullViews);
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetProgram(RenderProgram* program)
+{
+    D3DRenderProgram* d3dProgram;
+
+    d3dProgram = (D3DRenderProgram*)program;
+
+    // Set vertex input layout
+    m_deviceContext->IASetInputLayout(d3dProgram->m_layout);
+
+    // Set vertex and pixel shaders
+    m_deviceContext->VSSetShader(d3dProgram->m_vertexShader, NULL, 0);
+    m_deviceContext->PSSetShader(d3dProgram->m_pixelShader, NULL, 0);
+
+    // Set sampler state in the pixel shader
+    m_deviceContext->PSSetSamplers(0, 1, &d3dProgram->m_sampleState);
+
+    m_pipelineState = 0;
+    m_stats.stateChanges++;
+
+    return;
+}
+
+// Binds shaders, layout and fixed function state together, and nothing at all
+// when the same pipeline state is already bound
+void D3DRenderContextClass::SetPipelineState(RenderPipelineState* pipelineState)
+{
+    D3DRenderPipelineState* d3dState;
+    D3DRenderProgram* d3dProgram;
+    float blendFactor[4];
+
+    if (pipelineState == m_pipelineState)
+        return;
+
+    d3dState = (D3DRenderPipelineState*)pipelineState;
+    d3dProgram = (D3DRenderProgram*)pipelineState->desc.program;
+
+    blendFactor[0] = 0.0f;
+    blendFactor[1] = 0.0f;
+    blendFactor[2] = 0.0f;
+    blendFactor[3] = 0.0f;
+
+    m_deviceContext->IASetInputLayout(d3dProgram->m_layout);
+    m_deviceContext->VSSetShader(d3dProgram->m_vertexShader, NULL, 0);
+    m_deviceContext->PSSetShader(d3dProgram->m_pixelShader, NULL, 0);
+    m_deviceContext->PSSetSamplers(0, 1, &d3dProgram->m_sampleState);
+
+    m_deviceContext->OMSetDepthStencilState(d3dState->m_depthStencilState, 1);
+    m_deviceContext->OMSetBlendState(d3dState->m_blendState, blendFactor, 0xffffffff);
+    m_deviceContext->RSSetState(d3dState->m_rasterState);
+
+    m_pipelineState = pipelineState;
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetBackBuffer()
+{
+    m_D3D->SetBackBufferRenderTarget(m_deviceContext);
+
+    m_pipelineState = 0;
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetRenderTargets(RenderTexture* colorTarget, RenderTexture* depthTarget)
+{
+    ID3D11RenderTargetView* renderTargetView;
+    ID3D11DepthStencilView* depthStencilView;
+
+    renderTargetView = 0;
+    if (colorTarget)
+        renderTargetView = ((D3DRenderTexture*)colorTarget)->m_renderTargetView;
+
+    depthStencilView = 0;
+    if (depthTarget)
+        depthStencilView = ((D3DRenderTexture*)depthTarget)->m_depthStencilView;
+
+    if (renderTargetView)
+        m_deviceContext->OMSetRenderTargets(1, &renderTargetView, depthStencilView);
+    else
+        m_deviceContext->OMSetRenderTargets(0, 0, depthStencilView);
+
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetDepthEnabled(bool enabled)
+{
+    m_D3D->SetDepthState(m_deviceContext, enabled);
+
+    m_pipelineState = 0;
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::SetAlphaBlending(bool enabled)
+{
+    m_D3D->SetBlendState(m_deviceContext, enabled);
+
+    m_pipelineState = 0;
+    m_stats.stateChanges++;
+
+    return;
+}
+
+void D3DRenderContextClass::Clear(float red, float green, float blue, float alpha)
+{
+    m_D3D->ClearBackBuffer(m_deviceContext, red, green, blue, alpha);
+    return;
+}
+
+void D3DRenderContextClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+    m_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+
+    m_stats.drawCalls++;
+    m_stats.indexCount += indexCount;
+
+    return;
+}
+
+bool D3DRenderContextClass::FinishCommandList(RenderCommandList** commandList)
+{
+    HRESULT result;
+    ID3D11CommandList* d3dCommandList;
+
+    *commandList = 0;
+
+    result = m_deviceContext->FinishCommandList(FALSE, &d3dCommandList);
+    if (FAILED(result))
+        return false;
+
+    *commandList = new D3DRenderCommandList(d3dCommandList);
+    if (!*commandList)
+    {
+        d3dCommandList->Release();
+        return false;
+    }
+
+    // Finishing clears the deferred context's state
+    m_pipelineState = 0;
+
+    // The list carries what was recorded into it
+    (*commandList)->stats = m_stats;
+    ResetStats();
+
+    return true;
+}
+
+void D3DRenderContextClass::ExecuteCommandList(RenderCommandList* commandList)
+{
+    // Keep the immediate context state for the passes that follow
+    m_deviceContext->ExecuteCommandList(((D3DRenderCommandList*)commandList)->m_commandList, TRUE);
+
+    AddStats(commandList->stats);
+
+    return;
+}
+
+ID3D11DeviceContext* D3DRenderContextClass::GetDeviceContext()
+{
+    return m_deviceContext;
+}
+
+bool D3DRenderContextClass::SupportsOffsets()
+{
+    return (m_deviceContext1 != 0);
+}
\ No newline at end of file
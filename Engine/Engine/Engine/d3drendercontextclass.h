@@ -0,0 +1,101 @@
+#pragma once
+
+#include <d3d11.h>
+#include <d3d11_1.h>
+#include "rendercontextclass.h"
+
+class D3DClass;
+
+class D3DRenderBuffer : public RenderBuffer
+{
+public:
+    D3DRenderBuffer(ID3D11Buffer* buffer) { m_buffer = buffer; }
+    void Release() { m_buffer->Release(); delete this; }
+
+    ID3D11Buffer* m_buffer;
+};
+
+class D3DRenderTexture : public RenderTexture
+{
+public:
+    D3DRenderTexture();
+    void Release();
+
+    ID3D11Texture2D* m_texture;
+    ID3D11RenderTargetView* m_renderTargetView;
+    ID3D11DepthStencilView* m_depthStencilView;
+    ID3D11ShaderResourceView* m_shaderResourceView;
+};
+
+class D3DRenderProgram : public RenderProgram
+{
+public:
+    D3DRenderProgram();
+    void Release();
+
+    ID3D11VertexShader* m_vertexShader;
+    ID3D11PixelShader* m_pixelShader;
+    ID3D11InputLayout* m_layout;
+    ID3D11SamplerState* m_sampleState;
+};
+
+// State objects are borrowed from D3DClass's state cache
+class D3DRenderPipelineState : public RenderPipelineState
+{
+public:
+    D3DRenderPipelineState() { m_depthStencilState = 0; m_blendState = 0; m_rasterState = 0; }
+
+    ID3D11DepthStencilState* m_depthStencilState;
+    ID3D11BlendState* m_blendState;
+    ID3D11RasterizerState* m_rasterState;
+};
+
+class D3DRenderCommandList : public RenderCommandList
+{
+public:
+    D3DRenderCommandList(ID3D11CommandList* commandList) { m_commandList = commandList; }
+    void Release() { m_commandList->Release(); delete this; }
+
+    ID3D11CommandList* m_commandList;
+};
+
+// Wraps the immediate context or one deferred context. Render target and state
+// objects are shared and owned by D3DClass.
+class D3DRenderContextClass : public RenderContextClass
+{
+public:
+    D3DRenderContextClass(D3DClass*, ID3D11DeviceContext*, bool);
+    void Release();
+
+    bool Map(RenderBuffer*, RenderMapType, void**);
+    void Unmap(RenderBuffer*, unsigned int);
+
+    void SetVertexBuffer(RenderBuffer*, unsigned int);
+    void SetIndexBuffer(RenderBuffer*);
+    void SetConstantBuffer(unsigned int, unsigned int, RenderBuffer*, unsigned int, unsigned int);
+    void SetTexture(unsigned int, RenderTexture*);
+    void UnbindTextures();
+    void SetProgram(RenderProgram*);
+    void SetPipelineState(RenderPipelineState*);
+
+    void SetBackBuffer();
+    void SetRenderTargets(RenderTexture*, RenderTexture*);
+    void SetDepthEnabled(bool);
+    void SetAlphaBlending(bool);
+
+    void Clear(float, float, float, float);
+    void DrawIndexed(unsigned int, unsigned int, int);
+
+    bool FinishCommandList(RenderCommandList**);
+    void ExecuteCommandList(RenderCommandList*);
+
+    ID3D11DeviceContext* GetDeviceContext();
+    bool SupportsOffsets();
+
+private:
+    D3DClass* m_D3D;
+    ID3D11DeviceContext* m_deviceContext;
+    ID3D11DeviceContext1* m_deviceContext1;
+    bool m_deferred;
+    RenderPipelineState* m_pipelineState;
+};
\ No newline at end of file
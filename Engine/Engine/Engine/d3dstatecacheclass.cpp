@@ -0,0 +1,247 @@
+#include "d3dstatecacheclass.h"
+
+// 32 bit FNV-1a
+const unsigned int D3D_STATE_HASH_OFFSET = 2166136261u;
+const unsigned int D3D_STATE_HASH_PRIME = 16777619u;
+
+D3DStateCacheClass::D3DStateCacheClass()
+{
+    m_device = 0;
+    m_entries = 0;
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+    m_hitCount = 0;
+}
+
+D3DStateCacheClass::D3DStateCacheClass(const D3DStateCacheClass& other)
+{
+
+}
+
+D3DStateCacheClass::~D3DStateCacheClass()
+{
+
+}
+
+bool D3DStateCacheClass::Initialize(ID3D11Device* device)
+{
+    m_device = device;
+
+    m_entries = new EntryType[D3D_STATE_CAPACITY];
+    if (!m_entries)
+        return false;
+
+    m_entryCapacity = D3D_STATE_CAPACITY;
+
+    return true;
+}
+
+void D3DStateCacheClass::Shutdown()
+{
+    int i;
+
+    if (m_entries)
+    {
+        for (i = 0; i < m_entryCount; i++)
+            m_entries[i].state->Release();
+
+        delete[] m_entries;
+        m_entries = 0;
+    }
+
+    m_entryCount = 0;
+
+    return;
+}
+
+// Depth stencil and blend descriptions have padding after their byte sized
+// members, so they are copied field by field into zeroed memory before hashing
+ID3D11DepthStencilState* D3DStateCacheClass::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    HRESULT result;
+    StateDescType key;
+    ID3D11DepthStencilState* state;
+    unsigned int hash;
+
+    memset(&key, 0, sizeof(key));
+    key.depthStencil.DepthEnable = desc.DepthEnable;
+    key.depthStencil.DepthWriteMask = desc.DepthWriteMask;
+    key.depthStencil.DepthFunc = desc.DepthFunc;
+    key.depthStencil.StencilEnable = desc.StencilEnable;
+    key.depthStencil.StencilReadMask = desc.StencilReadMask;
+    key.depthStencil.StencilWriteMask = desc.StencilWriteMask;
+    key.depthStencil.FrontFace = desc.FrontFace;
+    key.depthStencil.BackFace = desc.BackFace;
+
+    state = (ID3D11DepthStencilState*)FindState(D3D_STATE_DEPTH_STENCIL, key, hash);
+    if (state)
+        return state;
+
+    result = m_device->CreateDepthStencilState(&key.depthStencil, &state);
+    if (FAILED(result))
+        return 0;
+
+    if (!AddState(D3D_STATE_DEPTH_STENCIL, key, hash, state))
+    {
+        state->Release();
+        return 0;
+    }
+
+    return state;
+}
+
+ID3D11BlendState* D3DStateCacheClass::GetBlendState(const D3D11_BLEND_DESC& desc)
+{
+    HRESULT result;
+    StateDescType key;
+    ID3D11BlendState* state;
+    unsigned int hash;
+    int i;
+
+    memset(&key, 0, sizeof(key));
+    key.blend.AlphaToCoverageEnable = desc.AlphaToCoverageEnable;
+    key.blend.IndependentBlendEnable = desc.IndependentBlendEnable;
+    for (i = 0; i < 8; i++)
+    {
+        key.blend.RenderTarget[i].BlendEnable = desc.RenderTarget[i].BlendEnable;
+        key.blend.RenderTarget[i].SrcBlend = desc.RenderTarget[i].SrcBlend;
+        key.blend.RenderTarget[i].DestBlend = desc.RenderTarget[i].DestBlend;
+        key.blend.RenderTarget[i].BlendOp = desc.RenderTarget[i].BlendOp;
+        key.blend.RenderTarget[i].SrcBlendAlpha = desc.RenderTarget[i].SrcBlendAlpha;
+        key.blend.RenderTarget[i].DestBlendAlpha = desc.RenderTarget[i].DestBlendAlpha;
+        key.blend.RenderTarget[i].BlendOpAlpha = desc.RenderTarget[i].BlendOpAlpha;
+        key.blend.RenderTarget[i].RenderTargetWriteMask = desc.RenderTarget[i].RenderTargetWriteMask;
+    }
+
+    state = (ID3D11BlendState*)FindState(D3D_STATE_BLEND, key, hash);
+    if (state)
+        return state;
+
+    result = m_device->CreateBlendState(&key.blend, &state);
+    if (FAILED(result))
+        return 0;
+
+    if (!AddState(D3D_STATE_BLEND, key, hash, state))
+    {
+        state->Release();
+        return 0;
+    }
+
+    return state;
+}
+
+ID3D11RasterizerState* D3DStateCacheClass::GetRasterizerState(const D3D11_RASTERIZER_DESC& desc)
+{
+    HRESULT result;
+    StateDescType key;
+    ID3D11RasterizerState* state;
+    unsigned int hash;
+
+    memset(&key, 0, sizeof(key));
+    key.rasterizer = desc;
+
+    state = (ID3D11RasterizerState*)FindState(D3D_STATE_RASTERIZER, key, hash);
+    if (state)
+        return state;
+
+    result = m_device->CreateRasterizerState(&key.rasterizer, &state);
+    if (FAILED(result))
+        return 0;
+
+    if (!AddState(D3D_STATE_RASTERIZER, key, hash, state))
+    {
+        state->Release();
+        return 0;
+    }
+
+    return state;
+}
+
+ID3D11SamplerState* D3DStateCacheClass::GetSamplerState(const D3D11_SAMPLER_DESC& desc)
+{
+    HRESULT result;
+    StateDescType key;
+    ID3D11SamplerState* state;
+    unsigned int hash;
+
+    memset(&key, 0, sizeof(key));
+    key.sampler = desc;
+
+    state = (ID3D11SamplerState*)FindState(D3D_STATE_SAMPLER, key, hash);
+    if (state)
+        return state;
+
+    result = m_device->CreateSamplerState(&key.sampler, &state);
+    if (FAILED(result))
+        return 0;
+
+    if (!AddState(D3D_STATE_SAMPLER, key, hash, state))
+    {
+        state->Release();
+        return 0;
+    }
+
+    return state;
+}
+
+int D3DStateCacheClass::GetStateCount()
+{
+    return m_entryCount;
+}
+
+int D3DStateCacheClass::GetHitCount()
+{
+    return m_hitCount;
+}
+
+// Hashes the whole zero padded description and looks for an equal one of the same kind
+ID3D11DeviceChild* D3DStateCacheClass::FindState(D3DStateKindType kind, const StateDescType& desc, unsigned int& hash)
+{
+    const unsigned char* bytes;
+    unsigned int i;
+    int j;
+
+    bytes = (const unsigned char*)&desc;
+    hash = D3D_STATE_HASH_OFFSET ^ (unsigned int)kind;
+    for (i = 0; i < sizeof(desc); i++)
+    {
+        hash ^= bytes[i];
+        hash *= D3D_STATE_HASH_PRIME;
+    }
+
+    for (j = 0; j < m_entryCount; j++)
+    {
+        if ((m_entries[j].hash == hash) && (m_entries[j].kind == kind) && (memcmp(&m_entries[j].desc, &desc, sizeof(desc)) == 0))
+        {
+            m_hitCount++;
+            return m_entries[j].state;
+        }
+    }
+
+    return 0;
+}
+
+bool D3DStateCacheClass::AddState(D3DStateKindType kind, const StateDescType& desc, unsigned int hash, ID3D11DeviceChild* state)
+{
+    EntryType* entries;
+
+    if (m_entryCount == m_entryCapacity)
+    {
+        entries = new EntryType[m_entryCapacity * 2];
+        if (!entries)
+            return false;
+
+        memcpy(entries, m_entries, sizeof(EntryType) * m_entryCount);
+        delete[] m_entries;
+        m_entries = entries;
+        m_entryCapacity *= 2;
+    }
+
+    m_entries[m_entryCount].kind = kind;
+    m_entries[m_entryCount].hash = hash;
+    memcpy(&m_entries[m_entryCount].desc, &desc, sizeof(desc));
+    m_entries[m_entryCount].state = state;
+    m_entryCount++;
+
+    return true;
+}
\ No newline at end of file
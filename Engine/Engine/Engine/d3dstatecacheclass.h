@@ -0,0 +1,63 @@
+#pragma once
+
+#include <d3d11.h>
+#include <string.h>
+
+const int D3D_STATE_CAPACITY = 16;
+
+enum D3DStateKindType
+{
+    D3D_STATE_DEPTH_STENCIL,
+    D3D_STATE_BLEND,
+    D3D_STATE_RASTERIZER,
+    D3D_STATE_SAMPLER
+};
+
+// Hands out one immutable state object per distinct description, so features
+// that want a state just describe it instead of creating their own. The cache
+// holds the only reference, returned objects are not released by callers.
+class D3DStateCacheClass
+{
+private:
+    union StateDescType
+    {
+        D3D11_DEPTH_STENCIL_DESC depthStencil;
+        D3D11_BLEND_DESC blend;
+        D3D11_RASTERIZER_DESC rasterizer;
+        D3D11_SAMPLER_DESC sampler;
+    };
+
+    struct EntryType
+    {
+        D3DStateKindType kind;
+        unsigned int hash;
+        StateDescType desc;
+        ID3D11DeviceChild* state;
+    };
+
+public:
+    D3DStateCacheClass();
+    D3DStateCacheClass(const D3DStateCacheClass&);
+    ~D3DStateCacheClass();
+
+    bool Initialize(ID3D11Device*);
+    void Shutdown();
+
+    ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC&);
+    ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC&);
+    ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC&);
+    ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC&);
+
+    int GetStateCount();
+    int GetHitCount();
+
+private:
+    ID3D11DeviceChild* FindState(D3DStateKindType, const StateDescType&, unsigned int&);
+    bool AddState(D3DStateKindType, const StateDescType&, unsigned int, ID3D11DeviceChild*);
+
+private:
+    ID3D11Device* m_device;
+    EntryType* m_entries;
+    int m_entryCount, m_entryCapacity;
+    int m_hitCount;
+};
\ No newline at end of file
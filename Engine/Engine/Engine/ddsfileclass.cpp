@@ -0,0 +1,858 @@
+#include "ddsfileclass.h"
+#include <fstream>
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Offsets into the DDS header, after the four byte magic number
+const int DDS_HEADER_SIZE = 124;
+const int DDS_DX10_HEADER_SIZE = 20;
+const int DDS_HEIGHT_OFFSET = 8;
+const int DDS_WIDTH_OFFSET = 12;
+const int DDS_MIP_COUNT_OFFSET = 24;
+const int DDS_PIXEL_FLAGS_OFFSET = 76;
+const int DDS_FOURCC_OFFSET = 80;
+const int DDS_BIT_COUNT_OFFSET = 84;
+const int DDS_MASK_OFFSET = 88;
+const int DDS_CAPS2_OFFSET = 108;
+
+const unsigned int DDS_PIXEL_ALPHA = 0x1;
+const unsigned int DDS_PIXEL_ALPHA_ONLY = 0x2;
+const unsigned int DDS_PIXEL_FOURCC = 0x4;
+const unsigned int DDS_PIXEL_RGB = 0x40;
+const unsigned int DDS_PIXEL_LUMINANCE = 0x20000;
+const unsigned int DDS_CAPS2_CUBEMAP = 0x200;
+const unsigned int DDS_CAPS2_ALL_FACES = 0xfc00;
+const unsigned int DDS_CAPS2_VOLUME = 0x200000;
+
+const unsigned int DDS_DIMENSION_TEXTURE2D = 3;
+const unsigned int DDS_MISC_TEXTURECUBE = 0x4;
+
+#define DDS_FOURCC(a, b, c, d) ((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+// A file RunTests loads and what the loader has to make of it. Sizes are
+// the first slice's mips, the other slices repeat them.
+struct DdsTestType
+{
+    const char* filename;
+    unsigned int format;
+    int width, height, mipCount, arraySize;
+    bool cubemap;
+    unsigned int dataOffset;
+    unsigned int mipSizes[4][4];
+};
+
+// Writes a header and payload the way a DDS writer would, the payload byte at
+// each offset is the offset's low byte so the test can tell where a mip starts
+static bool WriteTestFile(const char* filename, unsigned int width, unsigned int height, unsigned int mipCount, unsigned int fourCC,
+    unsigned int dxgiFormat, unsigned int arraySize, bool cube, unsigned int payloadSize)
+{
+    std::ofstream fout;
+    unsigned char header[4 + DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE];
+    unsigned int value, headerSize, i;
+    unsigned char byte;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, "DDS ", 4);
+
+    value = DDS_HEADER_SIZE;
+    memcpy(&header[4], &value, 4);
+    memcpy(&header[4 + DDS_HEIGHT_OFFSET], &height, 4);
+    memcpy(&header[4 + DDS_WIDTH_OFFSET], &width, 4);
+    memcpy(&header[4 + DDS_MIP_COUNT_OFFSET], &mipCount, 4);
+    value = DDS_PIXEL_FOURCC;
+    memcpy(&header[4 + DDS_PIXEL_FLAGS_OFFSET], &value, 4);
+    memcpy(&header[4 + DDS_FOURCC_OFFSET], &fourCC, 4);
+
+    headerSize = 4 + DDS_HEADER_SIZE;
+    if (fourCC == DDS_FOURCC('D', 'X', '1', '0'))
+    {
+        memcpy(&header[headerSize], &dxgiFormat, 4);
+        value = DDS_DIMENSION_TEXTURE2D;
+        memcpy(&header[headerSize + 4], &value, 4);
+        value = cube ? DDS_MISC_TEXTURECUBE : 0;
+        memcpy(&header[headerSize + 8], &value, 4);
+        memcpy(&header[headerSize + 12], &arraySize, 4);
+        headerSize += DDS_DX10_HEADER_SIZE;
+    }
+
+    fout.open(filename, std::ios::out | std::ios::binary);
+    if (fout.fail())
+        return false;
+
+    fout.write((const char*)header, headerSize);
+    for (i = 0; i < payloadSize; i++)
+    {
+        byte = (unsigned char)(headerSize + i);
+        fout.write((const char*)&byte, 1);
+    }
+    fout.close();
+
+    return !fout.fail();
+}
+
+static bool CheckTestFile(std::ofstream& fout, const DdsTestType& test, bool checkPayload)
+{
+    DdsFileClass file;
+    const DdsSubresourceType* subresources;
+    const unsigned char* expectedData;
+    unsigned int offset;
+    int slice, mip, index;
+    bool passed;
+
+    if (!file.Initialize((char*)test.filename))
+    {
+        file.Shutdown();
+        fout << "FAIL " << test.filename << " did not load" << std::endl;
+        return false;
+    }
+
+    passed = (file.GetFormat() == test.format) && (file.GetWidth() == test.width) && (file.GetHeight() == test.height) &&
+        (file.GetMipCount() == test.mipCount) && (file.GetArraySize() == test.arraySize) && (file.IsCubemap() == test.cubemap) &&
+        (file.GetSubresourceCount() == test.mipCount * test.arraySize);
+
+    // Every subresource the size it should be, right after the one before it
+    subresources = file.GetSubresources();
+    offset = test.dataOffset;
+    expectedData = (const unsigned char*)subresources[0].data;
+    for (slice = 0; passed && (slice < test.arraySize); slice++)
+    {
+        for (mip = 0; passed && (mip < test.mipCount); mip++)
+        {
+            index = slice * test.mipCount + mip;
+            passed = (subresources[index].width == test.mipSizes[mip][0]) && (subresources[index].height == test.mipSizes[mip][1]) &&
+                (subresources[index].rowPitch == test.mipSizes[mip][2]) && (subresources[index].slicePitch == test.mipSizes[mip][3]) &&
+                (subresources[index].data == expectedData);
+
+            if (checkPayload)
+                passed = passed && (*(const unsigned char*)subresources[index].data == (unsigned char)offset);
+
+            offset += subresources[index].slicePitch;
+            expectedData += subresources[index].slicePitch;
+        }
+    }
+
+    fout << (passed ? "pass " : "FAIL ") << test.filename << ": " << DdsFileClass::GetFormatName(file.GetFormat()) << " " << file.GetWidth() << "x"
+        << file.GetHeight() << ", " << file.GetMipCount() << " mips, " << file.GetArraySize() << " slices" << (file.IsCubemap() ? ", cubemap" : "")
+        << std::endl;
+
+    file.Shutdown();
+
+    return passed;
+}
+
+DdsFileClass::DdsFileClass()
+{
+    m_data = 0;
+    m_size = 0;
+    m_dataOffset = 0;
+    m_format = DDS_FORMAT_UNKNOWN;
+    m_width = 0;
+    m_height = 0;
+    m_mipCount = 0;
+    m_arraySize = 0;
+    m_cubemap = false;
+    m_alpha = true;
+    m_subresources = 0;
+    m_subresourceCount = 0;
+}
+
+DdsFileClass::DdsFileClass(const DdsFileClass& other)
+{
+
+}
+
+DdsFileClass::~DdsFileClass()
+{
+
+}
+
+bool DdsFileClass::Initialize(char* filename)
+{
+    bool result;
+
+    result = MapFile(filename);
+    if (!result)
+        return false;
+
+    result = ReadHeader();
+    if (!result)
+        return false;
+
+    // Also checks that the file is long enough for every level it claims
+    result = FindSubresources();
+    if (!result)
+        return false;
+
+    return true;
+}
+
+void DdsFileClass::Shutdown()
+{
+    if (m_subresources)
+    {
+        delete[] m_subresources;
+        m_subresources = 0;
+    }
+
+    m_subresourceCount = 0;
+
+    UnmapFile();
+
+    return;
+}
+
+unsigned int DdsFileClass::GetFormat()
+{
+    return m_format;
+}
+
+int DdsFileClass::GetWidth()
+{
+    return m_width;
+}
+
+int DdsFileClass::GetHeight()
+{
+    return m_height;
+}
+
+int DdsFileClass::GetMipCount()
+{
+    return m_mipCount;
+}
+
+// Counts a cubemap's faces, so a cubemap has six
+int DdsFileClass::GetArraySize()
+{
+    return m_arraySize;
+}
+
+bool DdsFileClass::IsCubemap()
+{
+    return m_cubemap;
+}
+
+// False when the format has an alpha channel the file doesn't use, such as 32 bit RGB files with the alpha byte left over
+bool DdsFileClass::HasAlpha()
+{
+    return m_alpha;
+}
+
+int DdsFileClass::GetSubresourceCount()
+{
+    return m_subresourceCount;
+}
+
+const DdsSubresourceType* DdsFileClass::GetSubresources()
+{
+    return m_subresources;
+}
+
+bool DdsFileClass::IsBlockCompressed(unsigned int format)
+{
+    return ((format >= DDS_FORMAT_BC1_TYPELESS) && (format <= DDS_FORMAT_BC5_SNORM)) ||
+        ((format >= DDS_FORMAT_BC6H_TYPELESS) && (format <= DDS_FORMAT_BC7_UNORM_SRGB));
+}
+
+// Per pixel, so a 4x4 block of BC1 is 4 bits a pixel. Zero for formats that aren't handled
+unsigned int DdsFileClass::GetBitsPerPixel(unsigned int format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R32G32B32A32_FLOAT:
+        return 128;
+
+    case DDS_FORMAT_R16G16B16A16_FLOAT:
+    case DDS_FORMAT_R16G16B16A16_UNORM:
+    case DDS_FORMAT_R32G32_FLOAT:
+        return 64;
+
+    case DDS_FORMAT_R10G10B10A2_UNORM:
+    case DDS_FORMAT_R8G8B8A8_UNORM:
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DDS_FORMAT_R16G16_FLOAT:
+    case DDS_FORMAT_R16G16_UNORM:
+    case DDS_FORMAT_R32_FLOAT:
+    case DDS_FORMAT_B8G8R8A8_UNORM:
+    case DDS_FORMAT_B8G8R8X8_UNORM:
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+        return 32;
+
+    case DDS_FORMAT_R8G8_UNORM:
+    case DDS_FORMAT_R16_FLOAT:
+    case DDS_FORMAT_R16_UNORM:
+    case DDS_FORMAT_B5G6R5_UNORM:
+    case DDS_FORMAT_B5G5R5A1_UNORM:
+    case DDS_FORMAT_B4G4R4A4_UNORM:
+        return 16;
+
+    case DDS_FORMAT_R8_UNORM:
+    case DDS_FORMAT_A8_UNORM:
+    case DDS_FORMAT_BC2_TYPELESS:
+    case DDS_FORMAT_BC2_UNORM:
+    case DDS_FORMAT_BC2_UNORM_SRGB:
+    case DDS_FORMAT_BC3_TYPELESS:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC3_UNORM_SRGB:
+    case DDS_FORMAT_BC5_TYPELESS:
+    case DDS_FORMAT_BC5_UNORM:
+    case DDS_FORMAT_BC5_SNORM:
+    case DDS_FORMAT_BC6H_TYPELESS:
+    case DDS_FORMAT_BC6H_UF16:
+    case DDS_FORMAT_BC6H_SF16:
+    case DDS_FORMAT_BC7_TYPELESS:
+    case DDS_FORMAT_BC7_UNORM:
+    case DDS_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    case DDS_FORMAT_BC1_TYPELESS:
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC1_UNORM_SRGB:
+    case DDS_FORMAT_BC4_TYPELESS:
+    case DDS_FORMAT_BC4_UNORM:
+    case DDS_FORMAT_BC4_SNORM:
+        return 4;
+    }
+
+    return 0;
+}
+
+const char* DdsFileClass::GetFormatName(unsigned int format)
+{
+    switch (format)
+    {
+    case DDS_FORMAT_R32G32B32A32_FLOAT: return "R32G32B32A32_FLOAT";
+    case DDS_FORMAT_R16G16B16A16_FLOAT: return "R16G16B16A16_FLOAT";
+    case DDS_FORMAT_R16G16B16A16_UNORM: return "R16G16B16A16_UNORM";
+    case DDS_FORMAT_R32G32_FLOAT: return "R32G32_FLOAT";
+    case DDS_FORMAT_R10G10B10A2_UNORM: return "R10G10B10A2_UNORM";
+    case DDS_FORMAT_R8G8B8A8_UNORM: return "R8G8B8A8_UNORM";
+    case DDS_FORMAT_R8G8B8A8_UNORM_SRGB: return "R8G8B8A8_UNORM_SRGB";
+    case DDS_FORMAT_R16G16_FLOAT: return "R16G16_FLOAT";
+    case DDS_FORMAT_R16G16_UNORM: return "R16G16_UNORM";
+    case DDS_FORMAT_R32_FLOAT: return "R32_FLOAT";
+    case DDS_FORMAT_R8G8_UNORM: return "R8G8_UNORM";
+    case DDS_FORMAT_R16_FLOAT: return "R16_FLOAT";
+    case DDS_FORMAT_R16_UNORM: return "R16_UNORM";
+    case DDS_FORMAT_R8_UNORM: return "R8_UNORM";
+    case DDS_FORMAT_A8_UNORM: return "A8_UNORM";
+    case DDS_FORMAT_BC1_TYPELESS: return "BC1_TYPELESS";
+    case DDS_FORMAT_BC1_UNORM: return "BC1_UNORM";
+    case DDS_FORMAT_BC1_UNORM_SRGB: return "BC1_UNORM_SRGB";
+    case DDS_FORMAT_BC2_TYPELESS: return "BC2_TYPELESS";
+    case DDS_FORMAT_BC2_UNORM: return "BC2_UNORM";
+    case DDS_FORMAT_BC2_UNORM_SRGB: return "BC2_UNORM_SRGB";
+    case DDS_FORMAT_BC3_TYPELESS: return "BC3_TYPELESS";
+    case DDS_FORMAT_BC3_UNORM: return "BC3_UNORM";
+    case DDS_FORMAT_BC3_UNORM_SRGB: return "BC3_UNORM_SRGB";
+    case DDS_FORMAT_BC4_TYPELESS: return "BC4_TYPELESS";
+    case DDS_FORMAT_BC4_UNORM: return "BC4_UNORM";
+    case DDS_FORMAT_BC4_SNORM: return "BC4_SNORM";
+    case DDS_FORMAT_BC5_TYPELESS: return "BC5_TYPELESS";
+    case DDS_FORMAT_BC5_UNORM: return "BC5_UNORM";
+    case DDS_FORMAT_BC5_SNORM: return "BC5_SNORM";
+    case DDS_FORMAT_B5G6R5_UNORM: return "B5G6R5_UNORM";
+    case DDS_FORMAT_B5G5R5A1_UNORM: return "B5G5R5A1_UNORM";
+    case DDS_FORMAT_B8G8R8A8_UNORM: return "B8G8R8A8_UNORM";
+    case DDS_FORMAT_B8G8R8X8_UNORM: return "B8G8R8X8_UNORM";
+    case DDS_FORMAT_B8G8R8A8_UNORM_SRGB: return "B8G8R8A8_UNORM_SRGB";
+    case DDS_FORMAT_B8G8R8X8_UNORM_SRGB: return "B8G8R8X8_UNORM_SRGB";
+    case DDS_FORMAT_BC6H_TYPELESS: return "BC6H_TYPELESS";
+    case DDS_FORMAT_BC6H_UF16: return "BC6H_UF16";
+    case DDS_FORMAT_BC6H_SF16: return "BC6H_SF16";
+    case DDS_FORMAT_BC7_TYPELESS: return "BC7_TYPELESS";
+    case DDS_FORMAT_BC7_UNORM: return "BC7_UNORM";
+    case DDS_FORMAT_BC7_UNORM_SRGB: return "BC7_UNORM_SRGB";
+    case DDS_FORMAT_B4G4R4A4_UNORM: return "B4G4R4A4_UNORM";
+    }
+
+    return "UNKNOWN";
+}
+
+// The whole file is mapped read only, the handles can go as soon as the view exists
+bool DdsFileClass::MapFile(char* filename)
+{
+#ifdef _WIN32
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    m_data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!m_data)
+        return false;
+
+    m_size = (size_t)size.QuadPart;
+#else
+    struct stat status;
+    void* view;
+    int file;
+
+    file = open(filename, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    if ((fstat(file, &status) != 0) || (status.st_size == 0))
+    {
+        close(file);
+        return false;
+    }
+
+    view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    m_data = (const unsigned char*)view;
+    m_size = (size_t)status.st_size;
+#endif
+
+    return true;
+}
+
+void DdsFileClass::UnmapFile()
+{
+    if (m_data)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap((void*)m_data, m_size);
+#endif
+        m_data = 0;
+    }
+
+    m_size = 0;
+
+    return;
+}
+
+bool DdsFileClass::ReadHeader()
+{
+    const unsigned char* header;
+    const unsigned char* extension;
+    unsigned int height, width, mipCount, pixelFlags, fourCC, bitCount, masks[4], caps2;
+    unsigned int dimension, miscFlags, arraySize;
+
+    if ((m_size < 4 + DDS_HEADER_SIZE) || (memcmp(m_data, "DDS ", 4) != 0))
+        return false;
+
+    header = m_data + 4;
+
+    memcpy(&height, &header[DDS_HEIGHT_OFFSET], 4);
+    memcpy(&width, &header[DDS_WIDTH_OFFSET], 4);
+    memcpy(&mipCount, &header[DDS_MIP_COUNT_OFFSET], 4);
+    memcpy(&pixelFlags, &header[DDS_PIXEL_FLAGS_OFFSET], 4);
+    memcpy(&fourCC, &header[DDS_FOURCC_OFFSET], 4);
+    memcpy(&bitCount, &header[DDS_BIT_COUNT_OFFSET], 4);
+    memcpy(masks, &header[DDS_MASK_OFFSET], 16);
+    memcpy(&caps2, &header[DDS_CAPS2_OFFSET], 4);
+
+    m_dataOffset = 4 + DDS_HEADER_SIZE;
+    arraySize = 1;
+    m_cubemap = false;
+    m_alpha = true;
+
+    if ((pixelFlags & DDS_PIXEL_FOURCC) && (fourCC == DDS_FOURCC('D', 'X', '1', '0')))
+    {
+        if (m_size < 4 + DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+            return false;
+
+        extension = header + DDS_HEADER_SIZE;
+        memcpy(&m_format, &extension[0], 4);
+        memcpy(&dimension, &extension[4], 4);
+        memcpy(&miscFlags, &extension[8], 4);
+        memcpy(&arraySize, &extension[12], 4);
+
+        m_dataOffset += DDS_DX10_HEADER_SIZE;
+
+        // One and three dimensional textures aren't used by the engine
+        if ((dimension != DDS_DIMENSION_TEXTURE2D) || (arraySize == 0))
+            return false;
+
+        if (miscFlags & DDS_MISC_TEXTURECUBE)
+        {
+            m_cubemap = true;
+            arraySize *= 6;
+        }
+    }
+    else
+    {
+        if (caps2 & DDS_CAPS2_VOLUME)
+            return false;
+
+        // Legacy cubemaps may leave faces out, which D3D11 can't make a cube from
+        if (caps2 & DDS_CAPS2_CUBEMAP)
+        {
+            if ((caps2 & DDS_CAPS2_ALL_FACES) != DDS_CAPS2_ALL_FACES)
+                return false;
+
+            m_cubemap = true;
+            arraySize = 6;
+        }
+
+        m_format = GetLegacyFormat(pixelFlags, fourCC, bitCount, masks);
+
+        if ((pixelFlags & (DDS_PIXEL_RGB | DDS_PIXEL_LUMINANCE)) && (!(pixelFlags & DDS_PIXEL_ALPHA) || (masks[3] == 0)))
+            m_alpha = false;
+    }
+
+    if (GetBitsPerPixel(m_format) == 0)
+        return false;
+
+    if ((m_format == DDS_FORMAT_B8G8R8X8_UNORM) || (m_format == DDS_FORMAT_B8G8R8X8_UNORM_SRGB))
+        m_alpha = false;
+
+    if ((width == 0) || (height == 0) || (width > 16384) || (height > 16384) || (arraySize > 2048 * 6))
+        return false;
+
+    if (m_cubemap && (width != height))
+        return false;
+
+    if (mipCount == 0)
+        mipCount = 1;
+
+    if (mipCount > (unsigned int)DDS_MAX_MIPS)
+        return false;
+
+    m_width = (int)width;
+    m_height = (int)height;
+    m_mipCount = (int)mipCount;
+    m_arraySize = (int)arraySize;
+
+    return true;
+}
+
+// Legacy files say what they hold with a four character code or with channel masks
+unsigned int DdsFileClass::GetLegacyFormat(unsigned int pixelFlags, unsigned int fourCC, unsigned int bitCount, const unsigned int* masks)
+{
+    if (pixelFlags & DDS_PIXEL_FOURCC)
+    {
+        switch (fourCC)
+        {
+        case DDS_FOURCC('D', 'X', 'T', '1'): return DDS_FORMAT_BC1_UNORM;
+        case DDS_FOURCC('D', 'X', 'T', '2'): return DDS_FORMAT_BC2_UNORM;
+        case DDS_FOURCC('D', 'X', 'T', '3'): return DDS_FORMAT_BC2_UNORM;
+        case DDS_FOURCC('D', 'X', 'T', '4'): return DDS_FORMAT_BC3_UNORM;
+        case DDS_FOURCC('D', 'X', 'T', '5'): return DDS_FORMAT_BC3_UNORM;
+        case DDS_FOURCC('A', 'T', 'I', '1'): return DDS_FORMAT_BC4_UNORM;
+        case DDS_FOURCC('B', 'C', '4', 'U'): return DDS_FORMAT_BC4_UNORM;
+        case DDS_FOURCC('B', 'C', '4', 'S'): return DDS_FORMAT_BC4_SNORM;
+        case DDS_FOURCC('A', 'T', 'I', '2'): return DDS_FORMAT_BC5_UNORM;
+        case DDS_FOURCC('B', 'C', '5', 'U'): return DDS_FORMAT_BC5_UNORM;
+        case DDS_FOURCC('B', 'C', '5', 'S'): return DDS_FORMAT_BC5_SNORM;
+
+        // D3DFORMAT numbers stored in place of a code
+        case 36: return DDS_FORMAT_R16G16B16A16_UNORM;
+        case 111: return DDS_FORMAT_R16_FLOAT;
+        case 112: return DDS_FORMAT_R16G16_FLOAT;
+        case 113: return DDS_FORMAT_R16G16B16A16_FLOAT;
+        case 114: return DDS_FORMAT_R32_FLOAT;
+        case 115: return DDS_FORMAT_R32G32_FLOAT;
+        case 116: return DDS_FORMAT_R32G32B32A32_FLOAT;
+        }
+
+        return DDS_FORMAT_UNKNOWN;
+    }
+
+    if (pixelFlags & DDS_PIXEL_RGB)
+    {
+        if (bitCount == 32)
+        {
+            // Red and blue masks alone tell the byte orders apart, alpha is read whether it is flagged or not
+            if ((masks[0] == 0xff) && (masks[1] == 0xff00) && (masks[2] == 0xff0000))
+                return DDS_FORMAT_R8G8B8A8_UNORM;
+
+            if ((masks[0] == 0xff0000) && (masks[1] == 0xff00) && (masks[2] == 0xff))
+                return masks[3] ? DDS_FORMAT_B8G8R8A8_UNORM : DDS_FORMAT_B8G8R8X8_UNORM;
+
+            // D3DX writes 10:10:10:2 with the masks swapped
+            if ((masks[0] == 0x3ff00000) && (masks[1] == 0xffc00) && (masks[2] == 0x3ff))
+                return DDS_FORMAT_R10G10B10A2_UNORM;
+            if ((masks[0] == 0x3ff) && (masks[1] == 0xffc00) && (masks[2] == 0x3ff00000))
+                return DDS_FORMAT_R10G10B10A2_UNORM;
+
+            if ((masks[0] == 0xffff) && (masks[1] == 0xffff0000))
+                return DDS_FORMAT_R16G16_UNORM;
+
+            if (masks[0] == 0xffffffff)
+                return DDS_FORMAT_R32_FLOAT;
+        }
+        else if (bitCount == 16)
+        {
+            if ((masks[0] == 0xf800) && (masks[1] == 0x7e0) && (masks[2] == 0x1f))
+                return DDS_FORMAT_B5G6R5_UNORM;
+
+            if ((masks[0] == 0x7c00) && (masks[1] == 0x3e0) && (masks[2] == 0x1f))
+                return DDS_FORMAT_B5G5R5A1_UNORM;
+
+            if ((masks[0] == 0xf00) && (masks[1] == 0xf0) && (masks[2] == 0xf))
+                return DDS_FORMAT_B4G4R4A4_UNORM;
+        }
+
+        // 24 bit files have no DXGI format and would need converting
+        return DDS_FORMAT_UNKNOWN;
+    }
+
+    if (pixelFlags & DDS_PIXEL_LUMINANCE)
+    {
+        if ((bitCount == 8) && (masks[0] == 0xff))
+            return DDS_FORMAT_R8_UNORM;
+
+        if ((bitCount == 16) && (masks[0] == 0xffff))
+            return DDS_FORMAT_R16_UNORM;
+
+        if ((bitCount == 16) && (masks[0] == 0xff) && (masks[3] == 0xff00))
+            return DDS_FORMAT_R8G8_UNORM;
+
+        return DDS_FORMAT_UNKNOWN;
+    }
+
+    if ((pixelFlags & DDS_PIXEL_ALPHA_ONLY) && (bitCount == 8))
+        return DDS_FORMAT_A8_UNORM;
+
+    return DDS_FORMAT_UNKNOWN;
+}
+
+// Levels are stored tightly packed, block compressed ones by rows of 4x4 blocks
+bool DdsFileClass::FindSubresources()
+{
+    DdsSubresourceType* subresource;
+    unsigned int bitsPerPixel, width, height, rows;
+    size_t offset;
+    bool compressed;
+    int slice, mip;
+
+    bitsPerPixel = GetBitsPerPixel(m_format);
+    compressed = IsBlockCompressed(m_format);
+
+    m_subresourceCount = m_arraySize * m_mipCount;
+    m_subresources = new DdsSubresourceType[m_subresourceCount];
+    if (!m_subresources)
+        return false;
+
+    offset = m_dataOffset;
+    subresource = m_subresources;
+
+    for (slice = 0; slice < m_arraySize; slice++)
+    {
+        width = (unsigned int)m_width;
+        height = (unsigned int)m_height;
+
+        for (mip = 0; mip < m_mipCount; mip++)
+        {
+            if (compressed)
+            {
+                // A block is 16 pixels, so 8 or 16 bytes
+                subresource->rowPitch = ((width + 3) / 4) * bitsPerPixel * 2;
+                rows = (height + 3) / 4;
+            }
+            else
+            {
+                subresource->rowPitch = (width * bitsPerPixel + 7) / 8;
+                rows = height;
+            }
+
+            subresource->slicePitch = subresource->rowPitch * rows;
+            subresource->width = width;
+            subresource->height = height;
+
+            if (offset + subresource->slicePitch > m_size)
+                return false;
+
+            subresource->data = m_data + offset;
+            offset += subresource->slicePitch;
+            subresource++;
+
+            if (width > 1)
+                width /= 2;
+            if (height > 1)
+                height /= 2;
+        }
+    }
+
+    return true;
+}
+
+// Converts one level to RGBA8 with red in the low byte, for formats that aren't compressed or floating point
+bool DdsFileClass::ReadPixels(int subresource, unsigned int* pixels, int pitch)
+{
+    const DdsSubresourceType* level;
+
+    if ((subresource < 0) || (subresource >= m_subresourceCount))
+        return false;
+
+    level = &m_subresources[subresource];
+
+    return ConvertPixels(m_format, m_alpha, level->data, level->rowPitch, level->width, level->height, pixels, pitch);
+}
+
+// Same as ReadPixels for a level that isn't in a mapped file
+bool DdsFileClass::ConvertPixels(unsigned int format, bool alpha, const void* data, unsigned int rowPitch, unsigned int width, unsigned int height,
+    unsigned int* pixels, int pitch)
+{
+    const unsigned char* row;
+    unsigned int masks[4], bytesPerPixel, pixel, x, y, i;
+
+    if (!GetFormatMasks(format, masks))
+        return false;
+
+    // Files that don't use their alpha channel are opaque
+    if (!alpha)
+        masks[3] = 0;
+
+    bytesPerPixel = GetBitsPerPixel(format) / 8;
+
+    for (y = 0; y < height; y++)
+    {
+        row = (const unsigned char*)data + y * rowPitch;
+
+        for (x = 0; x < width; x++)
+        {
+            pixel = 0;
+            for (i = 0; i < bytesPerPixel; i++)
+                pixel |= (unsigned int)row[x * bytesPerPixel + i] << (i * 8);
+
+            pixels[y * pitch + x] = ConvertChannel(pixel, masks[0]) | (ConvertChannel(pixel, masks[1]) << 8) |
+                (ConvertChannel(pixel, masks[2]) << 16) | ((masks[3] ? ConvertChannel(pixel, masks[3]) : 0xff) << 24);
+        }
+    }
+
+    return true;
+}
+
+// Where red, green, blue and alpha sit in a pixel of the format. One channel formats repeat it in red, green and blue
+bool DdsFileClass::GetFormatMasks(unsigned int format, unsigned int* masks)
+{
+    static const unsigned int formatMasks[][5] =
+    {
+        { DDS_FORMAT_R8G8B8A8_UNORM, 0xff, 0xff00, 0xff0000, 0xff000000 },
+        { DDS_FORMAT_R8G8B8A8_UNORM_SRGB, 0xff, 0xff00, 0xff0000, 0xff000000 },
+        { DDS_FORMAT_B8G8R8A8_UNORM, 0xff0000, 0xff00, 0xff, 0xff000000 },
+        { DDS_FORMAT_B8G8R8A8_UNORM_SRGB, 0xff0000, 0xff00, 0xff, 0xff000000 },
+        { DDS_FORMAT_B8G8R8X8_UNORM, 0xff0000, 0xff00, 0xff, 0 },
+        { DDS_FORMAT_B8G8R8X8_UNORM_SRGB, 0xff0000, 0xff00, 0xff, 0 },
+        { DDS_FORMAT_R10G10B10A2_UNORM, 0x3ff, 0xffc00, 0x3ff00000, 0xc0000000 },
+        { DDS_FORMAT_B5G6R5_UNORM, 0xf800, 0x7e0, 0x1f, 0 },
+        { DDS_FORMAT_B5G5R5A1_UNORM, 0x7c00, 0x3e0, 0x1f, 0x8000 },
+        { DDS_FORMAT_B4G4R4A4_UNORM, 0xf00, 0xf0, 0xf, 0xf000 },
+        { DDS_FORMAT_R8_UNORM, 0xff, 0xff, 0xff, 0 },
+        { DDS_FORMAT_A8_UNORM, 0, 0, 0, 0xff }
+    };
+    int i;
+
+    for (i = 0; i < (int)(sizeof(formatMasks) / sizeof(formatMasks[0])); i++)
+    {
+        if (formatMasks[i][0] == format)
+        {
+            memcpy(masks, &formatMasks[i][1], 4 * sizeof(unsigned int));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Moves the masked bits down and stretches them to eight bits
+unsigned int DdsFileClass::ConvertChannel(unsigned int pixel, unsigned int mask)
+{
+    unsigned int value, maximum;
+
+    if (mask == 0)
+        return 0;
+
+    value = pixel & mask;
+    maximum = mask;
+    while (!(maximum & 1))
+    {
+        value >>= 1;
+        maximum >>= 1;
+    }
+
+    return (value * 255 + maximum / 2) / maximum;
+}
+
+// Checks the engine's own DDS files and files written here for the cases
+// they don't cover, mip chains, block compression, arrays and cubemaps
+bool DdsFileClass::RunTests(char* filename)
+{
+    const DdsTestType tests[] =
+    {
+        { "../Engine/data/seafloor.dds", DDS_FORMAT_B8G8R8A8_UNORM, 256, 256, 1, 1, false, 128, { { 256, 256, 1024, 262144 } } },
+        { "../Engine/data/font.dds", DDS_FORMAT_R8G8B8A8_UNORM, 1024, 16, 1, 1, false, 128, { { 1024, 16, 4096, 65536 } } },
+        { "dds-test-dxt1.dds", DDS_FORMAT_BC1_UNORM, 16, 16, 4, 1, false, 128,
+            { { 16, 16, 32, 128 }, { 8, 8, 16, 32 }, { 4, 4, 8, 8 }, { 2, 2, 8, 8 } } },
+        { "dds-test-odd.dds", DDS_FORMAT_BC1_UNORM, 20, 12, 3, 1, false, 128, { { 20, 12, 40, 120 }, { 10, 6, 24, 48 }, { 5, 3, 16, 16 } } },
+        { "dds-test-array.dds", DDS_FORMAT_BC7_UNORM_SRGB, 8, 4, 3, 2, false, 148, { { 8, 4, 32, 32 }, { 4, 2, 16, 16 }, { 2, 1, 16, 16 } } },
+        { "dds-test-cube.dds", DDS_FORMAT_R8G8B8A8_UNORM, 4, 4, 2, 6, true, 148, { { 4, 4, 16, 64 }, { 2, 2, 8, 16 } } }
+    };
+    const int testCount = sizeof(tests) / sizeof(tests[0]);
+    const int writtenFirst = 2;
+    std::ofstream fout;
+    DdsFileClass file;
+    int failures, i;
+    bool written, passed;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    written = WriteTestFile(tests[2].filename, 16, 16, 4, DDS_FOURCC('D', 'X', 'T', '1'), 0, 1, false, 128 + 32 + 8 + 8);
+    written = written && WriteTestFile(tests[3].filename, 20, 12, 3, DDS_FOURCC('D', 'X', 'T', '1'), 0, 1, false, 120 + 48 + 16);
+    written = written && WriteTestFile(tests[4].filename, 8, 4, 3, DDS_FOURCC('D', 'X', '1', '0'), DDS_FORMAT_BC7_UNORM_SRGB, 2, false, 2 * (32 + 16 + 16));
+    written = written && WriteTestFile(tests[5].filename, 4, 4, 2, DDS_FOURCC('D', 'X', '1', '0'), DDS_FORMAT_R8G8B8A8_UNORM, 1, true, 6 * (64 + 16));
+    written = written && WriteTestFile("dds-test-short.dds", 16, 16, 4, DDS_FOURCC('D', 'X', 'T', '1'), 0, 1, false, 128 + 32 + 8 + 8 - 1);
+
+    failures = 0;
+    if (!written)
+    {
+        fout << "FAIL could not write the test files" << std::endl;
+        failures++;
+    }
+
+    for (i = 0; i < testCount; i++)
+    {
+        if (!CheckTestFile(fout, tests[i], i >= writtenFirst))
+            failures++;
+    }
+
+    // One byte short of the last mip has to be refused, not read past
+    passed = !file.Initialize("dds-test-short.dds");
+    file.Shutdown();
+    fout << (passed ? "pass " : "FAIL ") << "dds-test-short.dds refused" << std::endl;
+    if (!passed)
+        failures++;
+
+    for (i = writtenFirst; i < testCount; i++)
+        remove(tests[i].filename);
+    remove("dds-test-short.dds");
+
+    fout << std::endl << failures << " failures" << std::endl;
+    fout.close();
+
+    printf("%d DDS test failures, results in %s\n", failures, filename);
+
+    return (failures == 0);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+// Formats a DDS file can hold, numbered as DXGI_FORMAT so they can be handed
+// straight to D3D11 without including it here
+const unsigned int DDS_FORMAT_UNKNOWN = 0;
+const unsigned int DDS_FORMAT_R32G32B32A32_FLOAT = 2;
+const unsigned int DDS_FORMAT_R16G16B16A16_FLOAT = 10;
+const unsigned int DDS_FORMAT_R16G16B16A16_UNORM = 11;
+const unsigned int DDS_FORMAT_R32G32_FLOAT = 16;
+const unsigned int DDS_FORMAT_R10G10B10A2_UNORM = 24;
+const unsigned int DDS_FORMAT_R8G8B8A8_UNORM = 28;
+const unsigned int DDS_FORMAT_R8G8B8A8_UNORM_SRGB = 29;
+const unsigned int DDS_FORMAT_R16G16_FLOAT = 34;
+const unsigned int DDS_FORMAT_R16G16_UNORM = 35;
+const unsigned int DDS_FORMAT_R32_FLOAT = 41;
+const unsigned int DDS_FORMAT_R8G8_UNORM = 49;
+const unsigned int DDS_FORMAT_R16_FLOAT = 54;
+const unsigned int DDS_FORMAT_R16_UNORM = 56;
+const unsigned int DDS_FORMAT_R8_UNORM = 61;
+const unsigned int DDS_FORMAT_A8_UNORM = 65;
+const unsigned int DDS_FORMAT_BC1_TYPELESS = 70;
+const unsigned int DDS_FORMAT_BC1_UNORM = 71;
+const unsigned int DDS_FORMAT_BC1_UNORM_SRGB = 72;
+const unsigned int DDS_FORMAT_BC2_TYPELESS = 73;
+const unsigned int DDS_FORMAT_BC2_UNORM = 74;
+const unsigned int DDS_FORMAT_BC2_UNORM_SRGB = 75;
+const unsigned int DDS_FORMAT_BC3_TYPELESS = 76;
+const unsigned int DDS_FORMAT_BC3_UNORM = 77;
+const unsigned int DDS_FORMAT_BC3_UNORM_SRGB = 78;
+const unsigned int DDS_FORMAT_BC4_TYPELESS = 79;
+const unsigned int DDS_FORMAT_BC4_UNORM = 80;
+const unsigned int DDS_FORMAT_BC4_SNORM = 81;
+const unsigned int DDS_FORMAT_BC5_TYPELESS = 82;
+const unsigned int DDS_FORMAT_BC5_UNORM = 83;
+const unsigned int DDS_FORMAT_BC5_SNORM = 84;
+const unsigned int DDS_FORMAT_B5G6R5_UNORM = 85;
+const unsigned int DDS_FORMAT_B5G5R5A1_UNORM = 86;
+const unsigned int DDS_FORMAT_B8G8R8A8_UNORM = 87;
+const unsigned int DDS_FORMAT_B8G8R8X8_UNORM = 88;
+const unsigned int DDS_FORMAT_B8G8R8A8_UNORM_SRGB = 91;
+const unsigned int DDS_FORMAT_B8G8R8X8_UNORM_SRGB = 93;
+const unsigned int DDS_FORMAT_BC6H_TYPELESS = 94;
+const unsigned int DDS_FORMAT_BC6H_UF16 = 95;
+const unsigned int DDS_FORMAT_BC6H_SF16 = 96;
+const unsigned int DDS_FORMAT_BC7_TYPELESS = 97;
+const unsigned int DDS_FORMAT_BC7_UNORM = 98;
+const unsigned int DDS_FORMAT_BC7_UNORM_SRGB = 99;
+const unsigned int DDS_FORMAT_B4G4R4A4_UNORM = 115;
+
+const int DDS_MAX_MIPS = 16;
+
+// One mip of one array slice, pointing into the mapped file
+struct DdsSubresourceType
+{
+    const void* data;
+    unsigned int rowPitch, slicePitch;
+    unsigned int width, height;
+};
+
+// Maps a DDS file into memory and finds each mip level in it, without copying
+// or converting anything, so the subresources can be used as the initial data
+// of a texture as they are. Reads the legacy header and the DX10 one, any
+// format with a DXGI equivalent including BC1 to BC7, mip chains, texture
+// arrays and cubemaps. Subresources are in D3D11 order, every mip of the first
+// slice, then every mip of the next, with a cubemap's faces as six slices. The
+// pointers stay valid until Shutdown.
+class DdsFileClass
+{
+public:
+    DdsFileClass();
+    DdsFileClass(const DdsFileClass&);
+    ~DdsFileClass();
+
+    bool Initialize(char*);
+    void Shutdown();
+
+    unsigned int GetFormat();
+    int GetWidth();
+    int GetHeight();
+    int GetMipCount();
+    int GetArraySize();
+    bool IsCubemap();
+    bool HasAlpha();
+
+    int GetSubresourceCount();
+    const DdsSubresourceType* GetSubresources();
+    bool ReadPixels(int, unsigned int*, int);
+
+    static bool IsBlockCompressed(unsigned int);
+    static unsigned int GetBitsPerPixel(unsigned int);
+    static const char* GetFormatName(unsigned int);
+    static bool ConvertPixels(unsigned int, bool, const void*, unsigned int, unsigned int, unsigned int, unsigned int*, int);
+    static bool RunTests(char*);
+
+private:
+    bool MapFile(char*);
+    void UnmapFile();
+    bool ReadHeader();
+    bool FindSubresources();
+
+    static unsigned int GetLegacyFormat(unsigned int, unsigned int, unsigned int, const unsigned int*);
+    static bool GetFormatMasks(unsigned int, unsigned int*);
+    static unsigned int ConvertChannel(unsigned int, unsigned int);
+
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+    size_t m_dataOffset;
+
+    unsigned int m_format;
+    int m_width, m_height;
+    int m_mipCount, m_arraySize;
+    bool m_cubemap;
+    bool m_alpha;
+
+    DdsSubresourceType* m_subresources;
+    int m_subresourceCount;
+};
\ No newline at end of file
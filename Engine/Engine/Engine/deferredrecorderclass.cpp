@@ -0,0 +1,125 @@
+#include "deferredrecorderclass.h"
+
+DeferredRecorderClass::DeferredRecorderClass()
+{
+    m_immediateContext = 0;
+    m_deferredContexts = 0;
+    m_commandLists = 0;
+    m_workerCount = 0;
+
+    m_recordFunction = 0;
+    m_userData = 0;
+}
+
+DeferredRecorderClass::DeferredRecorderClass(const DeferredRecorderClass& other)
+{
+
+}
+
+DeferredRecorderClass::~DeferredRecorderClass()
+{
+
+}
+
+bool DeferredRecorderClass::Initialize(RenderDeviceClass* device, int workerCount, RecordRangeFunction recordFunction, void* userData)
+{
+    int i;
+
+    m_immediateContext = device->GetContext();
+    m_workerCount = workerCount;
+    m_recordFunction = recordFunction;
+    m_userData = userData;
+
+    // Create the per worker contexts and their command list slots
+    m_deferredContexts = new RenderContextClass*[m_workerCount];
+    if (!m_deferredContexts)
+        return false;
+
+    m_commandLists = new RenderCommandList*[m_workerCount];
+    if (!m_commandLists)
+        return false;
+
+    for (i = 0; i < m_workerCount; i++)
+    {
+        m_deferredContexts[i] = 0;
+        m_commandLists[i] = 0;
+    }
+
+    for (i = 0; i < m_workerCount; i++)
+    {
+        m_deferredContexts[i] = device->CreateDeferredContext();
+        if (!m_deferredContexts[i])
+            return false;
+    }
+
+    return true;
+}
+
+void DeferredRecorderClass::Shutdown()
+{
+    int i;
+
+    if (m_commandLists)
+    {
+        for (i = 0; i < m_workerCount; i++)
+        {
+            if (m_commandLists[i])
+                m_commandLists[i]->Release();
+        }
+
+        delete[] m_commandLists;
+        m_commandLists = 0;
+    }
+
+    if (m_deferredContexts)
+    {
+        for (i = 0; i < m_workerCount; i++)
+        {
+            if (m_deferredContexts[i])
+                m_deferredContexts[i]->Release();
+        }
+
+        delete[] m_deferredContexts;
+        m_deferredContexts = 0;
+    }
+
+    m_immediateContext = 0;
+
+    return;
+}
+
+int DeferredRecorderClass::GetWorkerCount()
+{
+    return m_workerCount;
+}
+
+bool DeferredRecorderClass::Record(int worker, int first, int last)
+{
+    bool result, recorded;
+
+    // Nothing to do for an empty range
+    if (first >= last)
+        return true;
+
+    recorded = m_recordFunction(m_deferredContexts[worker], first, last, m_userData);
+
+    // Always close the list so the context is ready for the next frame
+    result = m_deferredContexts[worker]->FinishCommandList(&m_commandLists[worker]);
+    if (!result)
+        return false;
+
+    return recorded;
+}
+
+bool DeferredRecorderClass::Execute(int worker)
+{
+    if (!m_commandLists[worker])
+        return true;
+
+    m_immediateContext->ExecuteCommandList(m_commandLists[worker]);
+
+    m_commandLists[worker]->Release();
+    m_commandLists[worker] = 0;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "renderdeviceclass.h"
+#include "commandrecorderclass.h"
+
+// Records each worker's range into its own deferred context. The callback has to
+// set all pipeline state it needs, deferred contexts start from the defaults.
+typedef bool (*RecordRangeFunction)(RenderContextClass*, int, int, void*);
+
+class DeferredRecorderClass : public CommandRecorderClass
+{
+public:
+    DeferredRecorderClass();
+    DeferredRecorderClass(const DeferredRecorderClass&);
+    ~DeferredRecorderClass();
+
+    bool Initialize(RenderDeviceClass*, int, RecordRangeFunction, void*);
+    void Shutdown();
+
+    int GetWorkerCount();
+    bool Record(int, int, int);
+    bool Execute(int);
+
+private:
+    RenderContextClass* m_immediateContext;
+    RenderContextClass** m_deferredContexts;
+    RenderCommandList** m_commandLists;
+    int m_workerCount;
+
+    RecordRangeFunction m_recordFunction;
+    void* m_userData;
+};
\ No newline at end of file
@@ -11,12 +11,14 @@ struct VertexInputType
 {
     float4 position : POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 struct PixelInputType
 {
     float4 position : SV_POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 // Vertex Shader
@@ -31,6 +33,7 @@ PixelInputType FontVertexShader(VertexInputType input)
     output.position = mul(output.position, projectionMatrix);
 
     output.tex = input.tex;
+    output.color = input.color;
 
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,733 @@
+#include "fontbakerclass.h"
+#ifdef _WIN32
+#include "gdiglyphsourceclass.h"
+#endif
+
+// Offsets into the DDS header, after the four byte magic number
+const int DDS_HEADER_SIZE = 124;
+const unsigned int DDS_HEADER_FLAGS = 0x100f;
+const unsigned int DDS_PIXEL_LUMINANCE = 0x20000;
+const unsigned int DDS_CAPS_TEXTURE = 0x1000;
+
+FontBakerClass::FontBakerClass()
+{
+    m_face[0] = 0;
+    m_output[0] = 0;
+    m_size = FONT_BAKE_DEFAULT_SIZE;
+    m_spread = FONT_BAKE_DEFAULT_SPREAD;
+    m_width = FONT_BAKE_DEFAULT_WIDTH;
+    m_height = 0;
+    m_lineHeight = 0.0f;
+    m_rangeCount = 0;
+    m_glyphs = 0;
+    m_glyphCount = 0;
+    m_glyphCapacity = 0;
+    m_missingCount = 0;
+    m_kerning = 0;
+    m_kerningCount = 0;
+    m_outside = 0;
+    m_inside = 0;
+    m_line = 0;
+    m_boundaries = 0;
+    m_vertices = 0;
+    m_gridCapacity = 0;
+    m_lineCapacity = 0;
+}
+
+FontBakerClass::FontBakerClass(const FontBakerClass& other)
+{
+
+}
+
+FontBakerClass::~FontBakerClass()
+{
+
+}
+
+bool FontBakerClass::Initialize(char* manifestFilename)
+{
+    bool result;
+
+    result = ReadManifest(manifestFilename);
+    if (!result)
+        return false;
+
+    m_glyphs = new GlyphType[FONT_BAKE_GLYPH_CAPACITY];
+    if (!m_glyphs)
+        return false;
+
+    m_glyphCount = 0;
+    m_glyphCapacity = FONT_BAKE_GLYPH_CAPACITY;
+
+    return true;
+}
+
+void FontBakerClass::Shutdown()
+{
+    int i;
+
+    if (m_vertices)
+    {
+        delete[] m_vertices;
+        m_vertices = 0;
+    }
+
+    if (m_boundaries)
+    {
+        delete[] m_boundaries;
+        m_boundaries = 0;
+    }
+
+    if (m_line)
+    {
+        delete[] m_line;
+        m_line = 0;
+    }
+    m_lineCapacity = 0;
+
+    if (m_inside)
+    {
+        delete[] m_inside;
+        m_inside = 0;
+    }
+
+    if (m_outside)
+    {
+        delete[] m_outside;
+        m_outside = 0;
+    }
+    m_gridCapacity = 0;
+
+    if (m_kerning)
+    {
+        delete[] m_kerning;
+        m_kerning = 0;
+    }
+    m_kerningCount = 0;
+
+    if (m_glyphs)
+    {
+        for (i = 0; i < m_glyphCount; i++)
+        {
+            if (m_glyphs[i].distance)
+                delete[] m_glyphs[i].distance;
+        }
+
+        delete[] m_glyphs;
+        m_glyphs = 0;
+    }
+    m_glyphCount = 0;
+    m_glyphCapacity = 0;
+
+    return;
+}
+
+// Draws every glyph in the ranges, packs them and writes the atlas and the
+// font file next to each other
+bool FontBakerClass::Bake(GlyphSourceClass* source)
+{
+    GlyphBitmapType bitmap;
+    char filename[FONT_BAKE_MAX_PATH + 8];
+    long long start;
+    unsigned int codepoint;
+    int i;
+    bool result;
+
+    start = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Glyphs are drawn larger than the atlas size so the distances are measured on finer pixels
+    result = source->Open(m_face, m_size * FONT_BAKE_UPSAMPLE);
+    if (!result)
+        return false;
+
+    m_lineHeight = source->GetLineHeight() / (float)FONT_BAKE_UPSAMPLE;
+    m_missingCount = 0;
+
+    // Going through the ranges in order keeps the glyphs sorted by code point
+    sort(m_ranges, m_ranges + m_rangeCount, [](const RangeType& a, const RangeType& b) { return a.first < b.first; });
+
+    for (i = 0; i < m_rangeCount; i++)
+    {
+        for (codepoint = m_ranges[i].first; codepoint <= m_ranges[i].last; codepoint++)
+        {
+            // Ranges that overlap only bake each glyph once
+            if (HasGlyph(codepoint))
+                continue;
+
+            // Plenty of fonts only cover part of a range
+            if (!source->GetGlyph(codepoint, bitmap))
+            {
+                m_missingCount++;
+                continue;
+            }
+
+            result = AddGlyph(codepoint, bitmap);
+            if (!result)
+            {
+                source->Close();
+                return false;
+            }
+        }
+    }
+
+    result = AddKerning(source);
+    source->Close();
+    if (!result)
+        return false;
+
+    if (m_glyphCount == 0)
+        return false;
+
+    result = PackGlyphs();
+    if (!result)
+        return false;
+
+    sprintf(filename, "%s.dds", m_output);
+    result = WriteAtlas(filename);
+    if (!result)
+        return false;
+
+    sprintf(filename, "%s.font", m_output);
+    result = WriteFontFile(filename);
+    if (!result)
+        return false;
+
+    result = WriteLog("font-bake.txt", (double)(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count() - start) / 1000000000.0);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+int FontBakerClass::GetGlyphCount()
+{
+    return m_glyphCount;
+}
+
+int FontBakerClass::GetKerningCount()
+{
+    return m_kerningCount;
+}
+
+// The command line entry point, which bakes with the system's fonts
+bool FontBakerClass::BakeFont(char* manifestFilename)
+{
+#ifdef _WIN32
+    FontBakerClass baker;
+    GdiGlyphSourceClass source;
+    bool result;
+
+    result = baker.Initialize(manifestFilename);
+    if (result)
+        result = baker.Bake(&source);
+
+    baker.Shutdown();
+
+    return result;
+#else
+    return false;
+#endif
+}
+
+bool FontBakerClass::ReadManifest(char* filename)
+{
+    ifstream fin;
+    char line[FONT_BAKE_MAX_PATH + 16], first[32], last[32];
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    m_rangeCount = 0;
+    while (fin.getline(line, sizeof(line)))
+    {
+        if ((line[0] == '#') || (line[0] == 0) || (line[0] == '\r'))
+            continue;
+
+        if (sscanf(line, "face %259[^\r\n]", m_face) == 1)
+            continue;
+
+        if (sscanf(line, "output %259[^\r\n]", m_output) == 1)
+            continue;
+
+        if ((sscanf(line, "size %d", &m_size) == 1) || (sscanf(line, "spread %d", &m_spread) == 1) || (sscanf(line, "width %d", &m_width) == 1))
+            continue;
+
+        // Ranges are inclusive and can be written in hex
+        if (sscanf(line, "range %31s %31s", first, last) == 2)
+        {
+            if (m_rangeCount == FONT_BAKE_MAX_RANGES)
+                return false;
+
+            m_ranges[m_rangeCount].first = (unsigned int)strtoul(first, 0, 0);
+            m_ranges[m_rangeCount].last = (unsigned int)strtoul(last, 0, 0);
+            if ((m_ranges[m_rangeCount].first > m_ranges[m_rangeCount].last) || (m_ranges[m_rangeCount].last > 0x10ffff))
+                return false;
+
+            m_rangeCount++;
+            continue;
+        }
+
+        return false;
+    }
+
+    fin.close();
+
+    // The atlas width has to be a power of two
+    if ((m_face[0] == 0) || (m_output[0] == 0) || (m_rangeCount == 0) || (m_size <= 0) || (m_spread <= 0) ||
+        (m_width < 64) || (m_width & (m_width - 1)))
+        return false;
+
+    return true;
+}
+
+bool FontBakerClass::AddGlyph(unsigned int codepoint, const GlyphBitmapType& bitmap)
+{
+    GlyphType* glyphs;
+    GlyphType* glyph;
+    bool result;
+
+    if (m_glyphCount == m_glyphCapacity)
+    {
+        glyphs = new GlyphType[m_glyphCapacity * 2];
+        if (!glyphs)
+            return false;
+
+        memcpy(glyphs, m_glyphs, sizeof(GlyphType) * m_glyphCount);
+        delete[] m_glyphs;
+        m_glyphs = glyphs;
+        m_glyphCapacity *= 2;
+    }
+
+    glyph = &m_glyphs[m_glyphCount];
+    glyph->codepoint = codepoint;
+    glyph->distance = 0;
+    glyph->x = 0;
+    glyph->y = 0;
+
+    result = BuildDistanceField(bitmap, *glyph);
+    if (!result)
+        return false;
+
+    m_glyphCount++;
+
+    return true;
+}
+
+// Measures the distance from every fine pixel to the other side of the edge,
+// then averages blocks of fine pixels into atlas pixels. The glyph gets a
+// border as wide as the spread so the distance can fade out around it.
+bool FontBakerClass::BuildDistanceField(const GlyphBitmapType& bitmap, GlyphType& glyph)
+{
+    int gridWidth, gridHeight, border, x, y, i, j, index;
+    float outside, inside, total, scale;
+    bool ink;
+
+    glyph.advance = bitmap.advance / (float)FONT_BAKE_UPSAMPLE;
+
+    // Blanks only have an advance
+    if ((bitmap.width == 0) || (bitmap.height == 0))
+    {
+        glyph.width = 0;
+        glyph.height = 0;
+        glyph.offsetX = 0.0f;
+        glyph.offsetY = 0.0f;
+        return true;
+    }
+
+    glyph.width = (bitmap.width + FONT_BAKE_UPSAMPLE - 1) / FONT_BAKE_UPSAMPLE + 2 * m_spread;
+    glyph.height = (bitmap.height + FONT_BAKE_UPSAMPLE - 1) / FONT_BAKE_UPSAMPLE + 2 * m_spread;
+    glyph.offsetX = bitmap.offsetX / (float)FONT_BAKE_UPSAMPLE - (float)m_spread;
+    glyph.offsetY = bitmap.offsetY / (float)FONT_BAKE_UPSAMPLE - (float)m_spread;
+
+    if (glyph.width + FONT_BAKE_GUTTER > m_width)
+        return false;
+
+    gridWidth = glyph.width * FONT_BAKE_UPSAMPLE;
+    gridHeight = glyph.height * FONT_BAKE_UPSAMPLE;
+    border = m_spread * FONT_BAKE_UPSAMPLE;
+
+    if (gridWidth * gridHeight > m_gridCapacity)
+    {
+        if (m_outside)
+            delete[] m_outside;
+        if (m_inside)
+            delete[] m_inside;
+
+        m_gridCapacity = gridWidth * gridHeight;
+        m_outside = new float[m_gridCapacity];
+        m_inside = new float[m_gridCapacity];
+        if (!m_outside || !m_inside)
+        {
+            m_gridCapacity = 0;
+            return false;
+        }
+    }
+
+    if (max(gridWidth, gridHeight) + 1 > m_lineCapacity)
+    {
+        if (m_line)
+            delete[] m_line;
+        if (m_boundaries)
+            delete[] m_boundaries;
+        if (m_vertices)
+            delete[] m_vertices;
+
+        m_lineCapacity = max(gridWidth, gridHeight) + 1;
+        m_line = new float[m_lineCapacity];
+        m_boundaries = new float[m_lineCapacity + 1];
+        m_vertices = new int[m_lineCapacity];
+        if (!m_line || !m_boundaries || !m_vertices)
+        {
+            m_lineCapacity = 0;
+            return false;
+        }
+    }
+
+    // One grid is zero on the ink and the other zero off it
+    for (y = 0; y < gridHeight; y++)
+    {
+        for (x = 0; x < gridWidth; x++)
+        {
+            i = x - border;
+            j = y - border;
+            ink = (i >= 0) && (j >= 0) && (i < bitmap.width) && (j < bitmap.height) && (bitmap.coverage[j * bitmap.pitch + i] >= 128);
+
+            index = y * gridWidth + x;
+            m_outside[index] = ink ? 0.0f : FONT_BAKE_FAR;
+            m_inside[index] = ink ? FONT_BAKE_FAR : 0.0f;
+        }
+    }
+
+    DistanceTransform(m_outside, gridWidth, gridHeight, m_line, m_vertices, m_boundaries);
+    DistanceTransform(m_inside, gridWidth, gridHeight, m_line, m_vertices, m_boundaries);
+
+    glyph.distance = new unsigned char[glyph.width * glyph.height];
+    if (!glyph.distance)
+        return false;
+
+    // The edge sits half a fine pixel from the centres on either side of it.
+    // The spread either way maps to the full 0 to 1 range with the edge at 0.5.
+    scale = 0.5f / (float)border;
+    for (y = 0; y < glyph.height; y++)
+    {
+        for (x = 0; x < glyph.width; x++)
+        {
+            total = 0.0f;
+            for (j = 0; j < FONT_BAKE_UPSAMPLE; j++)
+            {
+                for (i = 0; i < FONT_BAKE_UPSAMPLE; i++)
+                {
+                    index = (y * FONT_BAKE_UPSAMPLE + j) * gridWidth + x * FONT_BAKE_UPSAMPLE + i;
+                    outside = (m_outside[index] > 0.0f) ? sqrtf(m_outside[index]) - 0.5f : 0.0f;
+                    inside = (m_inside[index] > 0.0f) ? sqrtf(m_inside[index]) - 0.5f : 0.0f;
+                    total += inside - outside;
+                }
+            }
+
+            total = 0.5f + total * scale / (float)(FONT_BAKE_UPSAMPLE * FONT_BAKE_UPSAMPLE);
+            total = min(max(total, 0.0f), 1.0f);
+            glyph.distance[y * glyph.width + x] = (unsigned char)(total * 255.0f + 0.5f);
+        }
+    }
+
+    return true;
+}
+
+// Keeps the pairs between glyphs that made it into the atlas, sorted the way FontClass searches them
+bool FontBakerClass::AddKerning(GlyphSourceClass* source)
+{
+    GlyphKerningType* pairs;
+    int count, i;
+
+    count = source->GetKerningPairs(0, 0);
+    if (count <= 0)
+        return true;
+
+    pairs = new GlyphKerningType[count];
+    if (!pairs)
+        return false;
+
+    // Keep to the pairs there was room for if the font changed in between
+    i = source->GetKerningPairs(pairs, count);
+    if (i < count)
+        count = i;
+
+    m_kerning = new GlyphKerningType[count];
+    if (!m_kerning)
+    {
+        delete[] pairs;
+        return false;
+    }
+
+    m_kerningCount = 0;
+    for (i = 0; i < count; i++)
+    {
+        if ((pairs[i].amount == 0.0f) || !HasGlyph(pairs[i].first) || !HasGlyph(pairs[i].second))
+            continue;
+
+        m_kerning[m_kerningCount] = pairs[i];
+        m_kerning[m_kerningCount].amount /= (float)FONT_BAKE_UPSAMPLE;
+        m_kerningCount++;
+    }
+
+    delete[] pairs;
+
+    sort(m_kerning, m_kerning + m_kerningCount, [](const GlyphKerningType& a, const GlyphKerningType& b)
+    {
+        return (a.first < b.first) || ((a.first == b.first) && (a.second < b.second));
+    });
+
+    return true;
+}
+
+// Shelves of glyphs sorted tallest first. The width is fixed and the height
+// grows to the next power of two that fits.
+bool FontBakerClass::PackGlyphs()
+{
+    int* order;
+    GlyphType* glyph;
+    int i, x, y, shelfHeight;
+
+    order = new int[m_glyphCount];
+    if (!order)
+        return false;
+
+    for (i = 0; i < m_glyphCount; i++)
+        order[i] = i;
+
+    sort(order, order + m_glyphCount, [this](int a, int b)
+    {
+        return (m_glyphs[a].height > m_glyphs[b].height) || ((m_glyphs[a].height == m_glyphs[b].height) && (a < b));
+    });
+
+    x = 0;
+    y = 0;
+    shelfHeight = 0;
+    for (i = 0; i < m_glyphCount; i++)
+    {
+        glyph = &m_glyphs[order[i]];
+        if (glyph->width == 0)
+            continue;
+
+        if (x + glyph->width + FONT_BAKE_GUTTER > m_width)
+        {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        glyph->x = x;
+        glyph->y = y;
+
+        x += glyph->width + FONT_BAKE_GUTTER;
+        shelfHeight = max(shelfHeight, glyph->height + FONT_BAKE_GUTTER);
+    }
+
+    delete[] order;
+
+    m_height = 64;
+    while (m_height < y + shelfHeight)
+        m_height *= 2;
+
+    if (m_height > FONT_BAKE_MAX_HEIGHT)
+        return false;
+
+    return true;
+}
+
+// An uncompressed one channel DDS, which loads as R8
+bool FontBakerClass::WriteAtlas(char* filename)
+{
+    ofstream fout;
+    unsigned int header[DDS_HEADER_SIZE / 4];
+    unsigned char* atlas;
+    GlyphType* glyph;
+    int i, y;
+
+    atlas = new unsigned char[m_width * m_height];
+    if (!atlas)
+        return false;
+
+    // Zero is as far outside as the spread goes
+    memset(atlas, 0, m_width * m_height);
+
+    for (i = 0; i < m_glyphCount; i++)
+    {
+        glyph = &m_glyphs[i];
+        for (y = 0; y < glyph->height; y++)
+            memcpy(&atlas[(glyph->y + y) * m_width + glyph->x], &glyph->distance[y * glyph->width], glyph->width);
+    }
+
+    memset(header, 0, sizeof(header));
+    header[0] = DDS_HEADER_SIZE;
+    header[1] = DDS_HEADER_FLAGS;
+    header[2] = m_height;
+    header[3] = m_width;
+    header[4] = m_width;
+    header[18] = 32;
+    header[19] = DDS_PIXEL_LUMINANCE;
+    header[21] = 8;
+    header[22] = 0xff;
+    header[26] = DDS_CAPS_TEXTURE;
+
+    fout.open(filename, ios::out | ios::binary);
+    if (fout.fail())
+    {
+        delete[] atlas;
+        return false;
+    }
+
+    fout.write("DDS ", 4);
+    fout.write((const char*)header, sizeof(header));
+    fout.write((const char*)atlas, m_width * m_height);
+
+    delete[] atlas;
+
+    if (fout.fail())
+        return false;
+
+    fout.close();
+
+    return true;
+}
+
+// The format FontClass::LoadBakedFont reads
+bool FontBakerClass::WriteFontFile(char* filename)
+{
+    ofstream fout;
+    GlyphType* glyph;
+    int i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout.precision(8);
+
+    fout << "sdf " << m_size << " " << m_spread << " " << m_lineHeight << " " << m_width << " " << m_height << endl;
+
+    fout << "glyphs " << m_glyphCount << endl;
+    for (i = 0; i < m_glyphCount; i++)
+    {
+        glyph = &m_glyphs[i];
+        fout << glyph->codepoint << " " << (float)glyph->x / m_width << " " << (float)glyph->y / m_height << " " <<
+            (float)(glyph->x + glyph->width) / m_width << " " << (float)(glyph->y + glyph->height) / m_height << " " <<
+            glyph->width << " " << glyph->height << " " << glyph->offsetX << " " << glyph->offsetY << " " << glyph->advance << endl;
+    }
+
+    fout << "kerning " << m_kerningCount << endl;
+    for (i = 0; i < m_kerningCount; i++)
+        fout << m_kerning[i].first << " " << m_kerning[i].second << " " << m_kerning[i].amount << endl;
+
+    if (fout.fail())
+        return false;
+
+    fout.close();
+
+    return true;
+}
+
+bool FontBakerClass::WriteLog(char* filename, double seconds)
+{
+    ofstream fout;
+    long long used;
+    int i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    used = 0;
+    for (i = 0; i < m_glyphCount; i++)
+        used += m_glyphs[i].width * m_glyphs[i].height;
+
+    fout << "Face: " << m_face << endl;
+    fout << "Size: " << m_size << " px, spread " << m_spread << " px" << endl;
+    fout << "Glyphs: " << m_glyphCount << " baked, " << m_missingCount << " not in the font" << endl;
+    fout << "Kerning pairs: " << m_kerningCount << endl;
+    fout << "Atlas: " << m_width << " x " << m_height << ", " << (int)(100 * used / ((long long)m_width * m_height)) << "% used" << endl;
+    fout << "Seconds: " << seconds << endl;
+
+    fout.close();
+
+    return true;
+}
+
+// The glyphs are added in code point order so a binary search finds them
+bool FontBakerClass::HasGlyph(unsigned int codepoint)
+{
+    int low, high, middle;
+
+    low = 0;
+    high = m_glyphCount - 1;
+    while (low <= high)
+    {
+        middle = (low + high) / 2;
+        if (m_glyphs[middle].codepoint == codepoint)
+            return true;
+
+        if (m_glyphs[middle].codepoint < codepoint)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    return false;
+}
+
+// Squared distance to the nearest zero, in place. Runs the 1D lower envelope
+// of parabolas from Felzenszwalb and Huttenlocher down every column and then
+// along every row, which gives exact Euclidean distances in linear time.
+void FontBakerClass::DistanceTransform(float* grid, int width, int height, float* line, int* vertices, float* boundaries)
+{
+    int pass, count, lines, step, base, l, q, k;
+    float s;
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        count = (pass == 0) ? height : width;
+        lines = (pass == 0) ? width : height;
+        step = (pass == 0) ? width : 1;
+
+        for (l = 0; l < lines; l++)
+        {
+            base = (pass == 0) ? l : l * width;
+            for (q = 0; q < count; q++)
+                line[q] = grid[base + q * step];
+
+            k = 0;
+            vertices[0] = 0;
+            boundaries[0] = -FONT_BAKE_FAR;
+            boundaries[1] = FONT_BAKE_FAR;
+
+            for (q = 1; q < count; q++)
+            {
+                // Where the parabola from q crosses the lowest one so far, dropping those it hides
+                do
+                {
+                    s = ((line[q] + (float)(q * q)) - (line[vertices[k]] + (float)(vertices[k] * vertices[k]))) / (float)(2 * (q - vertices[k]));
+                    if (s > boundaries[k])
+                        break;
+                    k--;
+                } while (k >= 0);
+
+                k++;
+                vertices[k] = q;
+                boundaries[k] = s;
+                boundaries[k + 1] = FONT_BAKE_FAR;
+            }
+
+            k = 0;
+            for (q = 0; q < count; q++)
+            {
+                while (boundaries[k + 1] < (float)q)
+                    k++;
+
+                grid[base + q * step] = (float)((q - vertices[k]) * (q - vertices[k])) + line[vertices[k]];
+            }
+        }
+    }
+
+    return;
+}
\ No newline at end of file
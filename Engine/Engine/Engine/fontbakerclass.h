@@ -0,0 +1,132 @@
+#pragma once
+
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+using namespace std;
+
+const int FONT_BAKE_MAX_PATH = 260;
+const int FONT_BAKE_MAX_RANGES = 64;
+const int FONT_BAKE_DEFAULT_SIZE = 32;
+const int FONT_BAKE_DEFAULT_SPREAD = 4;
+const int FONT_BAKE_DEFAULT_WIDTH = 512;
+const int FONT_BAKE_MAX_HEIGHT = 4096;
+const int FONT_BAKE_UPSAMPLE = 4;
+const int FONT_BAKE_GUTTER = 1;
+const int FONT_BAKE_GLYPH_CAPACITY = 256;
+const float FONT_BAKE_FAR = 1e20f;
+
+// One glyph drawn by a glyph source, with 0 to 255 coverage. The offset runs
+// from the pen position on the top of the line to the bitmap's top left.
+struct GlyphBitmapType
+{
+    const unsigned char* coverage;
+    int width, height, pitch;
+    float offsetX, offsetY;
+    float advance;
+};
+
+struct GlyphKerningType
+{
+    unsigned int first, second;
+    float amount;
+};
+
+// Where the baker gets its glyphs. The Windows build draws them with GDI, the
+// baker itself only needs coverage and metrics so any rasterizer will do.
+class GlyphSourceClass
+{
+public:
+    virtual ~GlyphSourceClass() {}
+
+    virtual bool Open(const char*, int) = 0;
+    virtual void Close() = 0;
+
+    virtual float GetLineHeight() = 0;
+    virtual bool GetGlyph(unsigned int, GlyphBitmapType&) = 0;
+
+    // Fills in up to the given count and returns how many pairs the font has
+    virtual int GetKerningPairs(GlyphKerningType*, int) = 0;
+};
+
+// Bakes a signed distance field glyph atlas for FontClass. A manifest names the
+// face, the size, the distance spread in atlas pixels and any number of code
+// point ranges:
+//   face Arial
+//   size 32
+//   spread 4
+//   width 512
+//   range 0x20 0x7e
+//   output ../Engine/data/overlay
+// Glyphs are drawn several times larger than the atlas size, turned into exact
+// Euclidean distances and box filtered down, then shelf packed into a one
+// channel DDS next to a .font file of metrics and kerning pairs.
+class FontBakerClass
+{
+private:
+    struct RangeType
+    {
+        unsigned int first, last;
+    };
+
+    struct GlyphType
+    {
+        unsigned int codepoint;
+        unsigned char* distance;
+        int width, height;
+        int x, y;
+        float offsetX, offsetY;
+        float advance;
+    };
+
+public:
+    FontBakerClass();
+    FontBakerClass(const FontBakerClass&);
+    ~FontBakerClass();
+
+    bool Initialize(char*);
+    void Shutdown();
+    bool Bake(GlyphSourceClass*);
+
+    int GetGlyphCount();
+    int GetKerningCount();
+
+    static bool BakeFont(char*);
+
+private:
+    bool ReadManifest(char*);
+    bool AddGlyph(unsigned int, const GlyphBitmapType&);
+    bool BuildDistanceField(const GlyphBitmapType&, GlyphType&);
+    bool AddKerning(GlyphSourceClass*);
+    bool PackGlyphs();
+    bool WriteAtlas(char*);
+    bool WriteFontFile(char*);
+    bool WriteLog(char*, double);
+    bool HasGlyph(unsigned int);
+
+    static void DistanceTransform(float*, int, int, float*, int*, float*);
+
+private:
+    char m_face[FONT_BAKE_MAX_PATH];
+    char m_output[FONT_BAKE_MAX_PATH];
+    int m_size, m_spread, m_width, m_height;
+    float m_lineHeight;
+
+    RangeType m_ranges[FONT_BAKE_MAX_RANGES];
+    int m_rangeCount;
+
+    GlyphType* m_glyphs;
+    int m_glyphCount, m_glyphCapacity;
+    int m_missingCount;
+
+    GlyphKerningType* m_kerning;
+    int m_kerningCount;
+
+    float *m_outside, *m_inside, *m_line, *m_boundaries;
+    int* m_vertices;
+    int m_gridCapacity, m_lineCapacity;
+};
\ No newline at end of file
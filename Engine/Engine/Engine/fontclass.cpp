@@ -1,9 +1,205 @@
 #include "fontclass.h"
+#include "cpufeatureclass.h"
+#include <chrono>
+
+const int FONT_TEST_QUADS = 4096;
+const int FONT_TEST_REPEATS = 50;
+
+static bool CompareKerning(const FontKerningType& a, const FontKerningType& b)
+{
+    return a.pair < b.pair;
+}
+
+static unsigned int HashCodepoint(unsigned int codepoint)
+{
+    codepoint *= 0x9e3779b1;
+    return codepoint ^ (codepoint >> 16);
+}
+
+// A vertex is 9 floats: position, texture coordinates, color
+static inline float* WriteVertex(float* out, float x, float y, float u, float v, const Vector4Type& color)
+{
+    out[0] = x;
+    out[1] = y;
+    out[2] = 0.0f;
+    out[3] = u;
+    out[4] = v;
+    out[5] = color.x;
+    out[6] = color.y;
+    out[7] = color.z;
+    out[8] = color.w;
+
+    return out + 9;
+}
+
+static void WriteQuadsScalar(void* vertices, const FontQuadType* quads, int count, const Vector4Type& color)
+{
+    float* out;
+    int i;
+
+    out = (float*)vertices;
+    for (i = 0; i < count; i++)
+    {
+        // First triangle in quad: top left, bottom right, bottom left
+        out = WriteVertex(out, quads[i].left, quads[i].top, quads[i].textureLeft, quads[i].textureTop, color);
+        out = WriteVertex(out, quads[i].right, quads[i].bottom, quads[i].textureRight, quads[i].textureBottom, color);
+        out = WriteVertex(out, quads[i].left, quads[i].bottom, quads[i].textureLeft, quads[i].textureBottom, color);
+
+        // Second triangle in quad: top left, top right, bottom right
+        out = WriteVertex(out, quads[i].left, quads[i].top, quads[i].textureLeft, quads[i].textureTop, color);
+        out = WriteVertex(out, quads[i].right, quads[i].top, quads[i].textureRight, quads[i].textureTop, color);
+        out = WriteVertex(out, quads[i].right, quads[i].bottom, quads[i].textureRight, quads[i].textureBottom, color);
+    }
+
+    return;
+}
+
+#if CPU_X86
+// Each vertex is x, y, 0, u then v, r, g, b then a, two stores and the alpha.
+// The four corners and the two texture rows are shuffled together once a quad.
+CPU_TARGET("sse4.2")
+static void WriteQuadsSse42(void* vertices, const FontQuadType* quads, int count, const Vector4Type& color)
+{
+    __m128 colorShifted, corners, texture, left, right, leftTop, rightBottom, leftBottom, rightTop, rowTop, rowBottom;
+    float* out;
+    int i;
+
+    out = (float*)vertices;
+
+    // a, r, g, b so the first lane can take each vertex's v
+    colorShifted = _mm_loadu_ps(&color.x);
+    colorShifted = _mm_shuffle_ps(colorShifted, colorShifted, _MM_SHUFFLE(2, 1, 0, 3));
+
+    for (i = 0; i < count; i++)
+    {
+        corners = _mm_loadu_ps(&quads[i].left);
+        texture = _mm_loadu_ps(&quads[i].textureLeft);
+
+        // 0, u of the left and the right edge
+        left = _mm_unpacklo_ps(_mm_setzero_ps(), texture);
+        right = _mm_unpackhi_ps(_mm_setzero_ps(), texture);
+
+        leftTop = _mm_shuffle_ps(corners, left, _MM_SHUFFLE(1, 0, 1, 0));
+        rightBottom = _mm_shuffle_ps(corners, right, _MM_SHUFFLE(1, 0, 3, 2));
+        leftBottom = _mm_shuffle_ps(corners, left, _MM_SHUFFLE(1, 0, 3, 0));
+        rightTop = _mm_shuffle_ps(corners, right, _MM_SHUFFLE(1, 0, 1, 2));
+
+        rowTop = _mm_move_ss(colorShifted, _mm_shuffle_ps(texture, texture, _MM_SHUFFLE(1, 1, 1, 1)));
+        rowBottom = _mm_move_ss(colorShifted, _mm_shuffle_ps(texture, texture, _MM_SHUFFLE(3, 3, 3, 3)));
+
+        _mm_storeu_ps(out, leftTop);
+        _mm_storeu_ps(out + 4, rowTop);
+        out[8] = color.w;
+        _mm_storeu_ps(out + 9, rightBottom);
+        _mm_storeu_ps(out + 13, rowBottom);
+        out[17] = color.w;
+        _mm_storeu_ps(out + 18, leftBottom);
+        _mm_storeu_ps(out + 22, rowBottom);
+        out[26] = color.w;
+        _mm_storeu_ps(out + 27, leftTop);
+        _mm_storeu_ps(out + 31, rowTop);
+        out[35] = color.w;
+        _mm_storeu_ps(out + 36, rightTop);
+        _mm_storeu_ps(out + 40, rowTop);
+        out[44] = color.w;
+        _mm_storeu_ps(out + 45, rightBottom);
+        _mm_storeu_ps(out + 49, rowBottom);
+        out[53] = color.w;
+
+        out += 54;
+    }
+
+    return;
+}
+#endif
+
+#if CPU_NEON
+static void WriteQuadsNeon(void* vertices, const FontQuadType* quads, int count, const Vector4Type& color)
+{
+    float32x4_t colorShifted, corners, leftTop, rightBottom, leftBottom, rightTop, rowTop, rowBottom;
+    float32x2_t left, right;
+    float* out;
+    int i;
+
+    out = (float*)vertices;
+
+    // a, r, g, b so the first lane can take each vertex's v
+    colorShifted = vld1q_f32(&color.x);
+    colorShifted = vextq_f32(colorShifted, colorShifted, 3);
+
+    for (i = 0; i < count; i++)
+    {
+        corners = vld1q_f32(&quads[i].left);
+
+        // 0, u of the left and the right edge
+        left = vset_lane_f32(quads[i].textureLeft, vdup_n_f32(0.0f), 1);
+        right = vset_lane_f32(quads[i].textureRight, vdup_n_f32(0.0f), 1);
+
+        leftTop = vcombine_f32(vget_low_f32(corners), left);
+        rightBottom = vcombine_f32(vget_high_f32(corners), right);
+        leftBottom = vcombine_f32(vset_lane_f32(quads[i].bottom, vget_low_f32(corners), 1), left);
+        rightTop = vcombine_f32(vset_lane_f32(quads[i].top, vget_high_f32(corners), 1), right);
+
+        rowTop = vsetq_lane_f32(quads[i].textureTop, colorShifted, 0);
+        rowBottom = vsetq_lane_f32(quads[i].textureBottom, colorShifted, 0);
+
+        vst1q_f32(out, leftTop);
+        vst1q_f32(out + 4, rowTop);
+        out[8] = color.w;
+        vst1q_f32(out + 9, rightBottom);
+        vst1q_f32(out + 13, rowBottom);
+        out[17] = color.w;
+        vst1q_f32(out + 18, leftBottom);
+        vst1q_f32(out + 22, rowBottom);
+        out[26] = color.w;
+        vst1q_f32(out + 27, leftTop);
+        vst1q_f32(out + 31, rowTop);
+        out[35] = color.w;
+        vst1q_f32(out + 36, rightTop);
+        vst1q_f32(out + 40, rowTop);
+        out[44] = color.w;
+        vst1q_f32(out + 45, rightBottom);
+        vst1q_f32(out + 49, rowBottom);
+        out[53] = color.w;
+
+        out += 54;
+    }
+
+    return;
+}
+#endif
+
+// Indexed by CpuIsaType, the wider x86 sets gain nothing over SSE on 36 byte vertices and fall back to it
+static const WriteQuadsFunction g_writeQuadsKernels[CPU_ISA_COUNT] =
+{
+    WriteQuadsScalar,
+#if CPU_X86
+    WriteQuadsSse42,
+#else
+    0,
+#endif
+    0,
+    0,
+#if CPU_NEON
+    WriteQuadsNeon
+#else
+    0
+#endif
+};
 
 FontClass::FontClass()
 {
-    m_Font = 0;
+    m_glyphs = 0;
+    m_glyphCount = 0;
+    m_glyphTable = 0;
+    m_glyphTableMask = 0;
+    m_missingGlyph = 0;
+    m_kerning = 0;
+    m_kerningCount = 0;
+    m_lineHeight = 0.0f;
+    m_distanceField = false;
     m_Texture = 0;
+    m_writeQuads = CpuFeatureClass::Bind(g_writeQuadsKernels);
 }
 
 FontClass::FontClass(const FontClass& other)
@@ -16,12 +212,22 @@ FontClass::~FontClass()
 
 }
 
-bool FontClass::Initialize(ID3D11Device* device, char* fontFilename, WCHAR* textureFilename)
+// Files ending in .font are baked distance field fonts, anything else is read
+// as the old ASCII font data
+bool FontClass::Initialize(RenderDeviceClass* device, char* fontFilename, wchar_t* textureFilename)
 {
     bool result;
+    int length;
+
+    length = (int)strlen(fontFilename);
+    if ((length > 5) && (strcmp(&fontFilename[length - 5], ".font") == 0))
+        result = LoadBakedFont(fontFilename);
+    else
+        result = LoadFontData(fontFilename);
+    if (!result)
+        return false;
 
-    // Load text file containing font data
-    result = LoadFontData(fontFilename);
+    result = BuildGlyphTable();
     if (!result)
         return false;
 
@@ -44,12 +250,14 @@ void FontClass::Shutdown()
 bool FontClass::LoadFontData(char* filename)
 {
     ifstream fin;
-    int i;
+    FontGlyphType* glyph;
+    float left, right;
+    int i, size;
     char temp;
 
     // Create font spacing buffer
-    m_Font = new FontType[95];
-    if (!m_Font)
+    m_glyphs = new FontGlyphType[FONT_LEGACY_GLYPH_COUNT];
+    if (!m_glyphs)
         return false;
 
     // Read font size and spacing between chars
@@ -58,7 +266,7 @@ bool FontClass::LoadFontData(char* filename)
         return false;
 
     // Read in 95 used ascii characters for text
-    for (i = 0; i < 95; i++)
+    for (i = 0; i < FONT_LEGACY_GLYPH_COUNT; i++)
     {
         fin.get(temp);
         while (temp != ' ')
@@ -72,28 +280,215 @@ bool FontClass::LoadFontData(char* filename)
             fin.get(temp);
         }
 
-        fin >> m_Font[i].left;
-        fin >> m_Font[i].right;
-        fin >> m_Font[i].size;
+        fin >> left;
+        fin >> right;
+        fin >> size;
+
+        // Every letter is a full height strip of the texture, one pixel apart
+        glyph = &m_glyphs[i];
+        glyph->codepoint = 32 + i;
+        glyph->left = left;
+        glyph->top = 0.0f;
+        glyph->right = right;
+        glyph->bottom = 1.0f;
+        glyph->width = (float)size;
+        glyph->height = FONT_LEGACY_HEIGHT;
+        glyph->offsetX = 0.0f;
+        glyph->offsetY = 0.0f;
+        glyph->advance = (float)size + 1.0f;
+    }
+
+    fin.close();
+
+    // A space is just three pixels of nothing
+    m_glyphs[0].width = 0.0f;
+    m_glyphs[0].advance = 3.0f;
+
+    m_glyphCount = FONT_LEGACY_GLYPH_COUNT;
+    m_lineHeight = FONT_LEGACY_HEIGHT;
+    m_distanceField = false;
+
+    return true;
+}
+
+// The header is followed by one line per glyph and one per kerning pair:
+//   sdf <size> <spread> <line height> <atlas width> <atlas height>
+//   glyphs <count>
+//   <code point> <left> <top> <right> <bottom> <width> <height> <offset x> <offset y> <advance>
+//   kerning <count>
+//   <first> <second> <amount>
+bool FontClass::LoadBakedFont(char* filename)
+{
+    ifstream fin;
+    FontGlyphType* glyph;
+    char token[32];
+    float size, spread;
+    unsigned int first, second;
+    int atlasWidth, atlasHeight, i;
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    fin >> token >> size >> spread >> m_lineHeight >> atlasWidth >> atlasHeight;
+    if (fin.fail() || (strcmp(token, "sdf") != 0))
+        return false;
+
+    fin >> token >> m_glyphCount;
+    if (fin.fail() || (strcmp(token, "glyphs") != 0) || (m_glyphCount <= 0))
+        return false;
+
+    m_glyphs = new FontGlyphType[m_glyphCount];
+    if (!m_glyphs)
+        return false;
+
+    for (i = 0; i < m_glyphCount; i++)
+    {
+        glyph = &m_glyphs[i];
+        fin >> glyph->codepoint >> glyph->left >> glyph->top >> glyph->right >> glyph->bottom >> glyph->width >> glyph->height >>
+            glyph->offsetX >> glyph->offsetY >> glyph->advance;
+    }
+
+    fin >> token >> m_kerningCount;
+    if (fin.fail() || (strcmp(token, "kerning") != 0) || (m_kerningCount < 0))
+        return false;
+
+    if (m_kerningCount > 0)
+    {
+        m_kerning = new FontKerningType[m_kerningCount];
+        if (!m_kerning)
+            return false;
+
+        for (i = 0; i < m_kerningCount; i++)
+        {
+            fin >> first >> second >> m_kerning[i].amount;
+            m_kerning[i].pair = ((unsigned long long)first << 32) | second;
+        }
+
+        // The baker writes them sorted, but the search can't rely on a hand edited file
+        sort(m_kerning, m_kerning + m_kerningCount, CompareKerning);
     }
 
+    if (fin.fail())
+        return false;
+
     fin.close();
 
+    m_distanceField = true;
+
     return true;
 }
 
+// Open addressing with linear probing, at most half full
+bool FontClass::BuildGlyphTable()
+{
+    unsigned int size, slot;
+    int i;
+
+    size = FONT_TABLE_MIN_SIZE;
+    while (size < (unsigned int)m_glyphCount * 2)
+        size *= 2;
+
+    m_glyphTable = new int[size];
+    if (!m_glyphTable)
+        return false;
+
+    for (slot = 0; slot < size; slot++)
+        m_glyphTable[slot] = -1;
+
+    m_glyphTableMask = size - 1;
+
+    for (i = 0; i < m_glyphCount; i++)
+    {
+        slot = HashCodepoint(m_glyphs[i].codepoint) & m_glyphTableMask;
+        while (m_glyphTable[slot] >= 0)
+        {
+            // Keep the first of any duplicates
+            if (m_glyphs[m_glyphTable[slot]].codepoint == m_glyphs[i].codepoint)
+                break;
+            slot = (slot + 1) & m_glyphTableMask;
+        }
+
+        if (m_glyphTable[slot] < 0)
+            m_glyphTable[slot] = i;
+    }
+
+    // Characters the font doesn't have are drawn as the replacement character, or a question mark
+    m_missingGlyph = 0;
+    m_missingGlyph = FindGlyph(FONT_REPLACEMENT_CHARACTER);
+    if (!m_missingGlyph)
+        m_missingGlyph = FindGlyph('?');
+
+    return true;
+}
+
+const FontGlyphType* FontClass::FindGlyph(unsigned int codepoint)
+{
+    unsigned int slot;
+
+    slot = HashCodepoint(codepoint) & m_glyphTableMask;
+    while (m_glyphTable[slot] >= 0)
+    {
+        if (m_glyphs[m_glyphTable[slot]].codepoint == codepoint)
+            return &m_glyphs[m_glyphTable[slot]];
+        slot = (slot + 1) & m_glyphTableMask;
+    }
+
+    return m_missingGlyph;
+}
+
+float FontClass::FindKerning(unsigned int first, unsigned int second)
+{
+    unsigned long long pair;
+    int low, high, middle;
+
+    pair = ((unsigned long long)first << 32) | second;
+
+    low = 0;
+    high = m_kerningCount - 1;
+    while (low <= high)
+    {
+        middle = (low + high) / 2;
+        if (m_kerning[middle].pair == pair)
+            return m_kerning[middle].amount;
+
+        if (m_kerning[middle].pair < pair)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    return 0.0f;
+}
+
 void FontClass::ReleaseFontData()
 {
-    if (m_Font)
+    if (m_kerning)
+    {
+        delete[] m_kerning;
+        m_kerning = 0;
+    }
+    m_kerningCount = 0;
+
+    if (m_glyphTable)
+    {
+        delete[] m_glyphTable;
+        m_glyphTable = 0;
+    }
+    m_glyphTableMask = 0;
+    m_missingGlyph = 0;
+
+    if (m_glyphs)
     {
-        delete[] m_Font;
-        m_Font = 0;
+        delete[] m_glyphs;
+        m_glyphs = 0;
     }
+    m_glyphCount = 0;
 
     return;
 }
 
-bool FontClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
+bool FontClass::LoadTexture(RenderDeviceClass* device, wchar_t* filename)
 {
     bool result;
 
@@ -122,65 +517,243 @@ void FontClass::ReleaseTexture()
     return;
 }
 
-ID3D11ShaderResourceView* FontClass::GetTexture()
+RenderTexture* FontClass::GetTexture()
 {
     return m_Texture->GetTexture();
 }
 
-// Called by the TextClass to build vertex buffers out of text sentences
-void FontClass::BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY)
+bool FontClass::IsDistanceField()
+{
+    return m_distanceField;
+}
+
+float FontClass::GetLineHeight()
+{
+    return m_lineHeight;
+}
+
+int FontClass::GetGlyphCount()
+{
+    return m_glyphCount;
+}
+
+// Reads one code point and moves past it. A malformed sequence comes back as
+// the replacement character and only its first byte is skipped, so a broken
+// string can never be read past its terminator.
+unsigned int FontClass::DecodeUTF8(const char*& text)
+{
+    const unsigned char* bytes;
+    unsigned int codepoint, minimum;
+    int length, i;
+
+    bytes = (const unsigned char*)text;
+
+    if (bytes[0] < 0x80)
+    {
+        text++;
+        return bytes[0];
+    }
+
+    if ((bytes[0] & 0xe0) == 0xc0)
+    {
+        length = 2;
+        codepoint = bytes[0] & 0x1f;
+        minimum = 0x80;
+    }
+    else if ((bytes[0] & 0xf0) == 0xe0)
+    {
+        length = 3;
+        codepoint = bytes[0] & 0x0f;
+        minimum = 0x800;
+    }
+    else if ((bytes[0] & 0xf8) == 0xf0)
+    {
+        length = 4;
+        codepoint = bytes[0] & 0x07;
+        minimum = 0x10000;
+    }
+    else
+    {
+        text++;
+        return FONT_REPLACEMENT_CHARACTER;
+    }
+
+    // The terminator isn't a continuation byte either, so this also stops there
+    for (i = 1; i < length; i++)
+    {
+        if ((bytes[i] & 0xc0) != 0x80)
+        {
+            text++;
+            return FONT_REPLACEMENT_CHARACTER;
+        }
+
+        codepoint = (codepoint << 6) | (bytes[i] & 0x3f);
+    }
+
+    text += length;
+
+    // Overlong forms, surrogates and anything past the last plane
+    if ((codepoint < minimum) || ((codepoint >= 0xd800) && (codepoint <= 0xdfff)) || (codepoint > 0x10ffff))
+        return FONT_REPLACEMENT_CHARACTER;
+
+    return codepoint;
+}
+
+// Called by the TextClass to build vertex buffers out of UTF-8 sentences, at
+// the given scale of the font's own size. Returns the number of vertices
+// written, never more than six per byte of text since blanks don't get a quad.
+int FontClass::BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY, Vector4Type color, float scale)
 {
     VertexType* vertexPtr;
-    int numLetters, index, i, letter;
+    const FontGlyphType* glyph;
+    const char* text;
+    FontQuadType quads[FONT_QUAD_BATCH];
+    FontQuadType* quad;
+    unsigned int codepoint, previous;
+    float startX;
+    int index, quadCount;
 
     // Coerce input vertices into a VertexType structure
     vertexPtr = (VertexType*)vertices;
 
-    // Get number of letters in the sentence
-    numLetters = (int)strlen(sentence);
-
+    text = sentence;
+    startX = drawX;
+    previous = 0;
     index = 0;
+    quadCount = 0;
 
-    // Draw each letter onto a quad
-    for (i = 0; i < numLetters; i++)
+    while (*text)
     {
-        letter = ((int)sentence[i] - 32);
+        codepoint = DecodeUTF8(text);
 
-        // If space then just move over X amount of pixels
-        if (letter == 0)
-            drawX = drawX + 3.0f;
-        else
+        // New lines start again a line further down
+        if (codepoint == '\n')
+        {
+            drawX = startX;
+            drawY = drawY - m_lineHeight * scale;
+            previous = 0;
+            continue;
+        }
+
+        glyph = FindGlyph(codepoint);
+        if (!glyph)
         {
-            // First triangle in quad
-            vertexPtr[index].position = D3DXVECTOR3(drawX, drawY, 0.0f);    // Top left
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 0.0f);
-            index++;
-
-            vertexPtr[index].position = D3DXVECTOR3((drawX + m_Font[letter].size), (drawY - 16), 0.0f); // Bottom right
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 1.0f);
-            index++;
-
-            vertexPtr[index].position = D3DXVECTOR3(drawX, (drawY - 16), 0.0f); // Bottom left
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 1.0f);
-            index++;
-
-            // Second triangle in quad
-            vertexPtr[index].position = D3DXVECTOR3(drawX, drawY, 0.0f);    // Top left
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 0.0f);
-            index++;
-
-            vertexPtr[index].position = D3DXVECTOR3(drawX + m_Font[letter].size, drawY, 0.0f);  // Top right
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 0.0f);
-            index++;
-
-            vertexPtr[index].position = D3DXVECTOR3((drawX + m_Font[letter].size), (drawY - 16), 0.0f); // Bottom right
-            vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 1.0f);
-            index++;
-
-            // Update x location for drawing by the size of the letter + 1 px
-            drawX = drawX + m_Font[letter].size + 1.0f;
+            previous = 0;
+            continue;
         }
+
+        if (previous && (m_kerningCount > 0))
+            drawX = drawX + FindKerning(previous, glyph->codepoint) * scale;
+        previous = glyph->codepoint;
+
+        // Blanks only move the pen
+        if ((glyph->width > 0.0f) && (glyph->height > 0.0f))
+        {
+            quad = &quads[quadCount];
+            quad->left = drawX + glyph->offsetX * scale;
+            quad->top = drawY - glyph->offsetY * scale;
+            quad->right = quad->left + glyph->width * scale;
+            quad->bottom = quad->top - glyph->height * scale;
+            quad->textureLeft = glyph->left;
+            quad->textureTop = glyph->top;
+            quad->textureRight = glyph->right;
+            quad->textureBottom = glyph->bottom;
+            quadCount++;
+
+            // Turn a batch of quads into vertices at once
+            if (quadCount == FONT_QUAD_BATCH)
+            {
+                m_writeQuads(&vertexPtr[index], quads, quadCount, color);
+                index += 6 * quadCount;
+                quadCount = 0;
+            }
+        }
+
+        // Move over by the glyph's advance
+        drawX = drawX + glyph->advance * scale;
     }
-    
-    return;
+
+    m_writeQuads(&vertexPtr[index], quads, quadCount, color);
+    index += 6 * quadCount;
+
+    return index;
+}
+
+static long long GetNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every vertex writer the machine can run has to give the scalar one's bytes
+bool FontClass::TestKernels(ofstream& fout)
+{
+    FontQuadType* quads;
+    float* expected;
+    float* vertices;
+    Vector4Type color;
+    long long start, elapsed, best;
+    unsigned int seed;
+    int isa, i, j, repeat;
+    float* values;
+    bool passed, result;
+
+    quads = new FontQuadType[FONT_TEST_QUADS];
+    if (!quads)
+        return false;
+
+    expected = new float[54 * FONT_TEST_QUADS];
+    if (!expected)
+        return false;
+
+    vertices = new float[54 * FONT_TEST_QUADS];
+    if (!vertices)
+        return false;
+
+    seed = 1;
+    for (i = 0; i < FONT_TEST_QUADS; i++)
+    {
+        values = &quads[i].left;
+        for (j = 0; j < 8; j++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            values[j] = (float)(seed >> 8) / 16777216.0f * 1000.0f;
+        }
+    }
+    color = Vector4Type(0.25f, 0.5f, 0.75f, 1.0f);
+
+    WriteQuadsScalar(expected, quads, FONT_TEST_QUADS, color);
+
+    fout << "WriteQuads, " << FONT_TEST_QUADS << " quads" << endl;
+    fout.setf(ios::fixed);
+    fout.precision(2);
+
+    result = true;
+    for (isa = 0; isa < CPU_ISA_COUNT; isa++)
+    {
+        if (!g_writeQuadsKernels[isa] || !CpuFeatureClass::IsSupported((CpuIsaType)isa))
+            continue;
+
+        memset(vertices, 0, 54 * FONT_TEST_QUADS * sizeof(float));
+        g_writeQuadsKernels[isa](vertices, quads, FONT_TEST_QUADS, color);
+        passed = (memcmp(vertices, expected, 54 * FONT_TEST_QUADS * sizeof(float)) == 0);
+        result = result && passed;
+
+        best = 0x7fffffffffffffffLL;
+        for (repeat = 0; repeat < FONT_TEST_REPEATS; repeat++)
+        {
+            start = GetNanoseconds();
+            g_writeQuadsKernels[isa](vertices, quads, FONT_TEST_QUADS, color);
+            elapsed = GetNanoseconds() - start;
+            if (elapsed < best)
+                best = elapsed;
+        }
+
+        fout << "  " << CpuFeatureClass::GetIsaName((CpuIsaType)isa) << ": " << (passed ? "match" : "MISMATCH") << ", " << (double)best / FONT_TEST_QUADS << " ns a quad" << endl;
+    }
+
+    delete[] vertices;
+    delete[] expected;
+    delete[] quads;
+
+    return result;
 }
\ No newline at end of file
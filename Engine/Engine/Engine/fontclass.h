@@ -1,25 +1,60 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dx10math.h>
+#include "mathclass.h"
 #include <fstream>
+#include <algorithm>
+#include <string.h>
 #include "textureclass.h"
 using namespace std;
 
+const int FONT_LEGACY_GLYPH_COUNT = 95;
+const float FONT_LEGACY_HEIGHT = 16.0f;
+const int FONT_TABLE_MIN_SIZE = 64;
+const unsigned int FONT_REPLACEMENT_CHARACTER = 0xfffd;
+const int FONT_QUAD_BATCH = 64;
+
+// Glyph metrics are in pixels at the size the atlas was made for, so drawing at
+// any other size is just a scale. The offset runs from the pen position on the
+// top of the line to the top left of the glyph's quad.
+struct FontGlyphType
+{
+    unsigned int codepoint;
+    float left, top, right, bottom;
+    float width, height;
+    float offsetX, offsetY;
+    float advance;
+};
+
+// The pair holds the first code point in its high half so the table sorts by it
+struct FontKerningType
+{
+    unsigned long long pair;
+    float amount;
+};
+
+// A glyph's quad on its way to the vertex writer, screen corners then atlas corners
+struct FontQuadType
+{
+    float left, top, right, bottom;
+    float textureLeft, textureTop, textureRight, textureBottom;
+};
+
+// Writes the six vertices of each quad, all in the one color
+typedef void (*WriteQuadsFunction)(void*, const FontQuadType*, int, const Vector4Type&);
+
+// Draws UTF-8 text out of one glyph atlas. Fonts baked by FontBakerClass hold
+// a signed distance field, so one atlas stays sharp at any size, and can cover
+// any Unicode ranges along with their kerning pairs. The old fontdata.txt format
+// still loads as a bitmap font covering printable ASCII. Glyphs are found
+// through an open addressed hash table, kerning pairs by a binary search.
 class FontClass
 {
 private:
-    struct FontType
-    {
-        float left;
-        float right;
-        int size;
-    };
-
     struct VertexType
     {
-        D3DXVECTOR3 position;
-        D3DXVECTOR2 texture;
+        Vector3Type position;
+        Vector2Type texture;
+        Vector4Type color;
     };
 
 public:
@@ -27,20 +62,41 @@ public:
     FontClass(const FontClass&);
     ~FontClass();
 
-    bool Initialize(ID3D11Device*, char*, WCHAR*);
+    bool Initialize(RenderDeviceClass*, char*, wchar_t*);
     void Shutdown();
 
-    ID3D11ShaderResourceView* GetTexture();
+    RenderTexture* GetTexture();
+    bool IsDistanceField();
+    float GetLineHeight();
+    int GetGlyphCount();
 
-    void BuildVertexArray(void*, char*, float, float);
+    int BuildVertexArray(void*, char*, float, float, Vector4Type, float);
+
+    static unsigned int DecodeUTF8(const char*&);
+    static bool TestKernels(ofstream&);
 
 private:
     bool LoadFontData(char*);
+    bool LoadBakedFont(char*);
+    bool BuildGlyphTable();
+    const FontGlyphType* FindGlyph(unsigned int);
+    float FindKerning(unsigned int, unsigned int);
     void ReleaseFontData();
-    bool LoadTexture(ID3D11Device*, WCHAR*);
+    bool LoadTexture(RenderDeviceClass*, wchar_t*);
     void ReleaseTexture();
 
 private:
-    FontType* m_Font;
+    FontGlyphType* m_glyphs;
+    int m_glyphCount;
+    int* m_glyphTable;
+    unsigned int m_glyphTableMask;
+    const FontGlyphType* m_missingGlyph;
+
+    FontKerningType* m_kerning;
+    int m_kerningCount;
+
+    float m_lineHeight;
+    bool m_distanceField;
     TextureClass* m_Texture;
+    WriteQuadsFunction m_writeQuads;
 };
\ No newline at end of file
@@ -1,24 +1,16 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dx10math.h>
-#include <d3dx11async.h>
-#include <fstream>
-using namespace std;
+#include "mathclass.h"
+#include "renderdeviceclass.h"
 
 class FontShaderClass
 {
 private:
     struct ConstantBufferType
     {
-        D3DXMATRIX world;
-        D3DXMATRIX view;
-        D3DXMATRIX projection;
-    };
-
-    struct PixelBufferType
-    {
-        D3DXVECTOR4 pixelColor;
+        MatrixType world;
+        MatrixType view;
+        MatrixType projection;
     };
 
 public:
@@ -26,24 +18,19 @@ public:
     FontShaderClass(const FontShaderClass&);
     ~FontShaderClass();
 
-    bool Initialize(ID3D11Device*, HWND);
+    bool Initialize(RenderDeviceClass*, bool);
     void Shutdown();
-    bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR4);
+    bool Render(RenderContextClass*, int, MatrixType, MatrixType, MatrixType, RenderTexture*);
 
 private:
-    bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
+    bool InitializeShader(RenderDeviceClass*, wchar_t*, wchar_t*, char*);
     void ShutdownShader();
-    void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
 
-    bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR4);
-    void RenderShader(ID3D11DeviceContext*, int);
+    bool SetShaderParameters(RenderContextClass*, MatrixType, MatrixType, MatrixType, RenderTexture*);
+    void RenderShader(RenderContextClass*, int);
 
 private:
-    ID3D11VertexShader* m_vertexShader;
-    ID3D11PixelShader* m_pixelShader;
-    ID3D11InputLayout* m_layout;
-    ID3D11Buffer* m_constantBuffer;
-    ID3D11SamplerState* m_sampleState;
-
-    ID3D11Buffer* m_pixelBuffer;
+    RenderProgram* m_program;
+    RenderPipelineState* m_pipelineState;
+    RenderBuffer* m_constantBuffer;
 };
\ No newline at end of file
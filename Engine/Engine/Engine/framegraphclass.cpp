@@ -0,0 +1,623 @@
+#include "framegraphclass.h"
+
+FrameGraphClass::FrameGraphClass()
+{
+    Reset();
+}
+
+FrameGraphClass::FrameGraphClass(const FrameGraphClass& other)
+{
+
+}
+
+FrameGraphClass::~FrameGraphClass()
+{
+
+}
+
+void FrameGraphClass::Reset()
+{
+    m_resourceCount = 0;
+    m_passCount = 0;
+    m_physicalCount = 0;
+    m_executedCount = 0;
+    m_compiled = false;
+
+    return;
+}
+
+int FrameGraphClass::ImportTexture(const char* name, bool depth)
+{
+    ResourceType* resource;
+
+    if (m_resourceCount >= FRAME_GRAPH_MAX_RESOURCES)
+        return -1;
+
+    // Imported textures are owned outside the graph and are never aliased
+    resource = &m_resources[m_resourceCount];
+    memset(resource, 0, sizeof(ResourceType));
+    strncpy(resource->name, name, FRAME_GRAPH_MAX_NAME - 1);
+    resource->desc.depth = depth;
+    resource->imported = true;
+    resource->physical = -1;
+
+    m_compiled = false;
+
+    return m_resourceCount++;
+}
+
+int FrameGraphClass::CreateTexture(const char* name, TextureDesc desc)
+{
+    ResourceType* resource;
+
+    if (m_resourceCount >= FRAME_GRAPH_MAX_RESOURCES)
+        return -1;
+
+    // Transient textures only live for the passes that use them
+    resource = &m_resources[m_resourceCount];
+    memset(resource, 0, sizeof(ResourceType));
+    strncpy(resource->name, name, FRAME_GRAPH_MAX_NAME - 1);
+    resource->desc = desc;
+    resource->imported = false;
+    resource->physical = -1;
+
+    m_compiled = false;
+
+    return m_resourceCount++;
+}
+
+int FrameGraphClass::AddPass(const char* name, PassFunction function, void* userData)
+{
+    PassType* pass;
+
+    if (m_passCount >= FRAME_GRAPH_MAX_PASSES)
+        return -1;
+
+    pass = &m_passes[m_passCount];
+    memset(pass, 0, sizeof(PassType));
+    strncpy(pass->name, name, FRAME_GRAPH_MAX_NAME - 1);
+    pass->function = function;
+    pass->userData = userData;
+
+    m_compiled = false;
+
+    return m_passCount++;
+}
+
+bool FrameGraphClass::Read(int pass, int resource)
+{
+    if ((pass < 0) || (pass >= m_passCount) || (resource < 0) || (resource >= m_resourceCount))
+        return false;
+
+    if (m_passes[pass].readCount >= FRAME_GRAPH_MAX_ACCESSES)
+        return false;
+
+    m_passes[pass].reads[m_passes[pass].readCount] = resource;
+    m_passes[pass].readCount++;
+
+    m_compiled = false;
+
+    return true;
+}
+
+bool FrameGraphClass::Write(int pass, int resource)
+{
+    if ((pass < 0) || (pass >= m_passCount) || (resource < 0) || (resource >= m_resourceCount))
+        return false;
+
+    if (m_passes[pass].writeCount >= FRAME_GRAPH_MAX_ACCESSES)
+        return false;
+
+    m_passes[pass].writes[m_passes[pass].writeCount] = resource;
+    m_passes[pass].writeCount++;
+
+    m_compiled = false;
+
+    return true;
+}
+
+void FrameGraphClass::MarkOutput(int resource)
+{
+    if ((resource < 0) || (resource >= m_resourceCount))
+        return;
+
+    m_resources[resource].output = true;
+    m_compiled = false;
+
+    return;
+}
+
+bool FrameGraphClass::Compile()
+{
+    bool result;
+
+    // Order by the dependencies between versions, which only ever point at earlier passes
+    BuildDependencies();
+
+    result = SortPasses();
+    if (!result)
+        return false;
+
+    CullPasses();
+    BuildTransitions();
+    AliasResources();
+
+    m_compiled = true;
+
+    return true;
+}
+
+bool FrameGraphClass::Execute(TransitionFunction transitionFunction, void* userData)
+{
+    PassType* pass;
+    bool result;
+    int i;
+
+    if (!m_compiled)
+        return false;
+
+    m_executedCount = 0;
+
+    for (i = 0; i < m_passCount; i++)
+    {
+        pass = &m_passes[m_order[i]];
+        if (pass->culled)
+            continue;
+
+        // Put the resources into the state this pass expects
+        if ((pass->transitionCount > 0) && transitionFunction)
+            transitionFunction(this, m_order[i], pass->transitions, pass->transitionCount, userData);
+
+        if (pass->function)
+        {
+            result = pass->function(this, m_order[i], pass->userData);
+            if (!result)
+                return false;
+        }
+
+        m_executedCount++;
+    }
+
+    return true;
+}
+
+bool FrameGraphClass::Dump(char* filename)
+{
+    ofstream fout;
+    PassType* pass;
+    ResourceType* resource;
+    int i, j;
+
+    if (!m_compiled)
+        return false;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout << "Passes (execution order)" << endl;
+    for (i = 0; i < m_passCount; i++)
+    {
+        pass = &m_passes[m_order[i]];
+        fout << "  " << i << ": " << pass->name << (pass->culled ? " [culled]" : "") << endl;
+
+        for (j = 0; j < pass->transitionCount; j++)
+        {
+            fout << "      transition " << m_resources[pass->transitions[j].resource].name << " "
+                << GetStateName(pass->transitions[j].before) << " -> " << GetStateName(pass->transitions[j].after) << endl;
+        }
+        for (j = 0; j < pass->readCount; j++)
+        {
+            fout << "      read  " << m_resources[pass->reads[j]].name;
+            if (pass->readVersions[j] >= 0)
+                fout << " from " << m_passes[pass->readVersions[j]].name;
+            fout << endl;
+        }
+        for (j = 0; j < pass->writeCount; j++)
+            fout << "      write " << m_resources[pass->writes[j]].name << endl;
+    }
+
+    fout << "Resources" << endl;
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        resource = &m_resources[i];
+        fout << "  " << resource->name << (resource->imported ? " imported" : " transient") << (resource->output ? " output" : "");
+        if (!resource->imported)
+        {
+            fout << " " << resource->desc.width << "x" << resource->desc.height << " " << GetTextureBytes(resource->desc) << " bytes";
+            if (resource->physical >= 0)
+                fout << " passes " << resource->firstUse << "-" << resource->lastUse << " physical " << resource->physical;
+            else
+                fout << " unused";
+        }
+        fout << endl;
+    }
+
+    fout << "Transient memory: " << GetTransientBytes() << " bytes requested, " << GetAliasedBytes() << " bytes allocated in "
+        << m_physicalCount << " textures, " << (GetTransientBytes() - GetAliasedBytes()) << " bytes saved" << endl;
+
+    fout.close();
+
+    return true;
+}
+
+int FrameGraphClass::GetPassCount()
+{
+    return m_passCount;
+}
+
+int FrameGraphClass::GetExecutedPassCount()
+{
+    return m_executedCount;
+}
+
+int FrameGraphClass::GetResourceCount()
+{
+    return m_resourceCount;
+}
+
+int FrameGraphClass::GetPhysicalCount()
+{
+    return m_physicalCount;
+}
+
+int FrameGraphClass::GetPhysicalIndex(int resource)
+{
+    return m_resources[resource].physical;
+}
+
+FrameGraphClass::TextureDesc FrameGraphClass::GetPhysicalDesc(int physical)
+{
+    return m_physical[physical].desc;
+}
+
+const char* FrameGraphClass::GetPassName(int pass)
+{
+    return m_passes[pass].name;
+}
+
+const char* FrameGraphClass::GetResourceName(int resource)
+{
+    return m_resources[resource].name;
+}
+
+unsigned int FrameGraphClass::GetTransientBytes()
+{
+    unsigned int bytes;
+    int i;
+
+    bytes = 0;
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        if (!m_resources[i].imported && (m_resources[i].physical >= 0))
+            bytes += GetTextureBytes(m_resources[i].desc);
+    }
+
+    return bytes;
+}
+
+unsigned int FrameGraphClass::GetAliasedBytes()
+{
+    unsigned int bytes;
+    int i;
+
+    bytes = 0;
+    for (i = 0; i < m_physicalCount; i++)
+        bytes += GetTextureBytes(m_physical[i].desc);
+
+    return bytes;
+}
+
+void FrameGraphClass::BuildDependencies()
+{
+    int lastWriter[FRAME_GRAPH_MAX_RESOURCES];
+    PassType* pass;
+    int i, j, k, resource;
+
+    for (i = 0; i < m_resourceCount; i++)
+        lastWriter[i] = -1;
+
+    for (i = 0; i < m_passCount; i++)
+    {
+        for (j = 0; j < m_passCount; j++)
+            m_dependsOn[i][j] = false;
+    }
+
+    // Declaration order is program order, each pass sees the versions the passes before it left
+    for (i = 0; i < m_passCount; i++)
+    {
+        pass = &m_passes[i];
+
+        // Read after write, and a read-write pass reads the version before its own
+        for (j = 0; j < pass->readCount; j++)
+        {
+            resource = pass->reads[j];
+            pass->readVersions[j] = lastWriter[resource];
+            if (lastWriter[resource] >= 0)
+                m_dependsOn[i][lastWriter[resource]] = true;
+        }
+
+        for (j = 0; j < pass->writeCount; j++)
+        {
+            resource = pass->writes[j];
+
+            // Write after write
+            if (lastWriter[resource] >= 0)
+                m_dependsOn[i][lastWriter[resource]] = true;
+
+            // Write after read, the new version can't replace one that is still to be read
+            for (k = 0; k < i; k++)
+            {
+                if (ReadsVersion(k, resource, lastWriter[resource]))
+                    m_dependsOn[i][k] = true;
+            }
+        }
+
+        for (j = 0; j < pass->writeCount; j++)
+            lastWriter[pass->writes[j]] = i;
+    }
+
+    for (i = 0; i < m_resourceCount; i++)
+        m_resources[i].lastWriter = lastWriter[i];
+
+    return;
+}
+
+bool FrameGraphClass::SortPasses()
+{
+    bool placed[FRAME_GRAPH_MAX_PASSES];
+    bool ready;
+    int i, j, count;
+
+    for (i = 0; i < m_passCount; i++)
+        placed[i] = false;
+
+    // Repeatedly take the first declared pass whose dependencies have all been placed
+    for (count = 0; count < m_passCount; count++)
+    {
+        for (i = 0; i < m_passCount; i++)
+        {
+            if (placed[i])
+                continue;
+
+            ready = true;
+            for (j = 0; (j < m_passCount) && ready; j++)
+            {
+                if ((j != i) && !placed[j] && m_dependsOn[i][j])
+                    ready = false;
+            }
+
+            if (ready)
+                break;
+        }
+
+        if (i == m_passCount)
+            return false;
+
+        placed[i] = true;
+        m_order[count] = i;
+    }
+
+    return true;
+}
+
+void FrameGraphClass::CullPasses()
+{
+    bool needed[FRAME_GRAPH_MAX_PASSES];
+    PassType* pass;
+    int i, j;
+
+    // The last version of an output is what leaves the frame
+    for (i = 0; i < m_passCount; i++)
+        needed[i] = false;
+
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        if (m_resources[i].output && (m_resources[i].lastWriter >= 0))
+            needed[m_resources[i].lastWriter] = true;
+    }
+
+    // Walk backwards from the outputs, a pass survives if a later pass reads a version it wrote
+    for (i = m_passCount - 1; i >= 0; i--)
+    {
+        pass = &m_passes[m_order[i]];
+        pass->culled = !needed[m_order[i]];
+        if (pass->culled)
+            continue;
+
+        for (j = 0; j < pass->readCount; j++)
+        {
+            if (pass->readVersions[j] >= 0)
+                needed[pass->readVersions[j]] = true;
+        }
+    }
+
+    return;
+}
+
+void FrameGraphClass::BuildTransitions()
+{
+    ResourceState state[FRAME_GRAPH_MAX_RESOURCES];
+    ResourceState target;
+    PassType* pass;
+    int i, j, resource;
+
+    // Imported targets arrive ready to render into, transients start undefined
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        if (m_resources[i].imported)
+            state[i] = m_resources[i].desc.depth ? STATE_DEPTH_WRITE : STATE_RENDER_TARGET;
+        else
+            state[i] = STATE_UNDEFINED;
+    }
+
+    for (i = 0; i < m_passCount; i++)
+    {
+        pass = &m_passes[m_order[i]];
+        pass->transitionCount = 0;
+        if (pass->culled)
+            continue;
+
+        for (j = 0; j < pass->writeCount; j++)
+        {
+            resource = pass->writes[j];
+            target = m_resources[resource].desc.depth ? STATE_DEPTH_WRITE : STATE_RENDER_TARGET;
+            if (state[resource] != target)
+            {
+                pass->transitions[pass->transitionCount].resource = resource;
+                pass->transitions[pass->transitionCount].before = state[resource];
+                pass->transitions[pass->transitionCount].after = target;
+                pass->transitionCount++;
+                state[resource] = target;
+            }
+        }
+
+        // Read-write access keeps the write state
+        for (j = 0; j < pass->readCount; j++)
+        {
+            resource = pass->reads[j];
+            if (IsWrittenBy(resource, m_order[i]))
+                continue;
+
+            if (state[resource] != STATE_SHADER_READ)
+            {
+                pass->transitions[pass->transitionCount].resource = resource;
+                pass->transitions[pass->transitionCount].before = state[resource];
+                pass->transitions[pass->transitionCount].after = STATE_SHADER_READ;
+                pass->transitionCount++;
+                state[resource] = STATE_SHADER_READ;
+            }
+        }
+    }
+
+    return;
+}
+
+void FrameGraphClass::AliasResources()
+{
+    bool assigned[FRAME_GRAPH_MAX_RESOURCES];
+    ResourceType* resource;
+    PassType* pass;
+    int i, j, next, physical;
+
+    // Lifetime of every transient as positions in the execution order
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        m_resources[i].firstUse = -1;
+        m_resources[i].lastUse = -1;
+        m_resources[i].physical = -1;
+        assigned[i] = m_resources[i].imported;
+    }
+
+    for (i = 0; i < m_passCount; i++)
+    {
+        pass = &m_passes[m_order[i]];
+        if (pass->culled)
+            continue;
+
+        for (j = 0; j < pass->readCount + pass->writeCount; j++)
+        {
+            resource = &m_resources[(j < pass->readCount) ? pass->reads[j] : pass->writes[j - pass->readCount]];
+            if (resource->firstUse < 0)
+                resource->firstUse = i;
+            resource->lastUse = i;
+        }
+    }
+
+    // Outputs have to survive past the last pass
+    for (i = 0; i < m_resourceCount; i++)
+    {
+        if (m_resources[i].output && (m_resources[i].firstUse >= 0))
+            m_resources[i].lastUse = m_passCount;
+        if (m_resources[i].firstUse < 0)
+            assigned[i] = true;
+    }
+
+    // Place transients in order of first use into the first free compatible texture
+    m_physicalCount = 0;
+    while (true)
+    {
+        next = -1;
+        for (i = 0; i < m_resourceCount; i++)
+        {
+            if (!assigned[i] && ((next < 0) || (m_resources[i].firstUse < m_resources[next].firstUse)))
+                next = i;
+        }
+
+        if (next < 0)
+            break;
+
+        resource = &m_resources[next];
+        physical = -1;
+        for (i = 0; (i < m_physicalCount) && (physical < 0); i++)
+        {
+            if ((m_physical[i].lastUse < resource->firstUse) &&
+                (m_physical[i].desc.width == resource->desc.width) &&
+                (m_physical[i].desc.height == resource->desc.height) &&
+                (m_physical[i].desc.format == resource->desc.format) &&
+                (m_physical[i].desc.depth == resource->desc.depth))
+            {
+                physical = i;
+            }
+        }
+
+        if (physical < 0)
+        {
+            physical = m_physicalCount;
+            m_physical[physical].desc = resource->desc;
+            m_physicalCount++;
+        }
+
+        m_physical[physical].lastUse = resource->lastUse;
+        resource->physical = physical;
+        assigned[next] = true;
+    }
+
+    return;
+}
+
+bool FrameGraphClass::ReadsVersion(int pass, int resource, int writer)
+{
+    int i;
+
+    for (i = 0; i < m_passes[pass].readCount; i++)
+    {
+        if ((m_passes[pass].reads[i] == resource) && (m_passes[pass].readVersions[i] == writer))
+            return true;
+    }
+
+    return false;
+}
+
+bool FrameGraphClass::IsWrittenBy(int resource, int pass)
+{
+    int i;
+
+    for (i = 0; i < m_passes[pass].writeCount; i++)
+    {
+        if (m_passes[pass].writes[i] == resource)
+            return true;
+    }
+
+    return false;
+}
+
+unsigned int FrameGraphClass::GetTextureBytes(const TextureDesc& desc)
+{
+    return (unsigned int)desc.width * (unsigned int)desc.height * (unsigned int)desc.bytesPerPixel;
+}
+
+const char* FrameGraphClass::GetStateName(ResourceState state)
+{
+    switch (state)
+    {
+    case STATE_RENDER_TARGET:
+        return "RenderTarget";
+    case STATE_DEPTH_WRITE:
+        return "DepthWrite";
+    case STATE_SHADER_READ:
+        return "ShaderRead";
+    default:
+        return "Undefined";
+    }
+}
\ No newline at end of file
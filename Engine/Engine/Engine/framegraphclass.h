@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fstream>
+#include <string.h>
+using namespace std;
+
+const int FRAME_GRAPH_MAX_PASSES = 32;
+const int FRAME_GRAPH_MAX_RESOURCES = 32;
+const int FRAME_GRAPH_MAX_ACCESSES = 8;
+const int FRAME_GRAPH_MAX_NAME = 32;
+
+// Passes declare the textures they read and write. Every write makes a new
+// version of the texture and a read sees the version written by the last pass
+// declared before it. Compile orders the passes by those dependencies, culls
+// passes whose versions nothing uses, works out
+// the state each resource has to be in before each pass and lets transient
+// textures with non-overlapping lifetimes share one physical texture.
+class FrameGraphClass
+{
+public:
+    enum ResourceState
+    {
+        STATE_UNDEFINED,
+        STATE_RENDER_TARGET,
+        STATE_DEPTH_WRITE,
+        STATE_SHADER_READ
+    };
+
+    struct TextureDesc
+    {
+        int width, height;
+        unsigned int format;
+        int bytesPerPixel;
+        bool depth;
+    };
+
+    struct TransitionType
+    {
+        int resource;
+        ResourceState before, after;
+    };
+
+    typedef bool (*PassFunction)(FrameGraphClass*, int, void*);
+    typedef void (*TransitionFunction)(FrameGraphClass*, int, TransitionType*, int, void*);
+
+private:
+    struct ResourceType
+    {
+        char name[FRAME_GRAPH_MAX_NAME];
+        TextureDesc desc;
+        bool imported, output;
+        int lastWriter;
+        int firstUse, lastUse;
+        int physical;
+    };
+
+    struct PassType
+    {
+        char name[FRAME_GRAPH_MAX_NAME];
+        PassFunction function;
+        void* userData;
+        int reads[FRAME_GRAPH_MAX_ACCESSES];
+        int readVersions[FRAME_GRAPH_MAX_ACCESSES];
+        int writes[FRAME_GRAPH_MAX_ACCESSES];
+        int readCount, writeCount;
+        bool culled;
+        TransitionType transitions[FRAME_GRAPH_MAX_ACCESSES * 2];
+        int transitionCount;
+    };
+
+    struct PhysicalType
+    {
+        TextureDesc desc;
+        int lastUse;
+    };
+
+public:
+    FrameGraphClass();
+    FrameGraphClass(const FrameGraphClass&);
+    ~FrameGraphClass();
+
+    void Reset();
+
+    int ImportTexture(const char*, bool);
+    int CreateTexture(const char*, TextureDesc);
+    int AddPass(const char*, PassFunction, void*);
+    bool Read(int, int);
+    bool Write(int, int);
+    void MarkOutput(int);
+
+    bool Compile();
+    bool Execute(TransitionFunction, void*);
+    bool Dump(char*);
+
+    int GetPassCount();
+    int GetExecutedPassCount();
+    int GetResourceCount();
+    int GetPhysicalCount();
+    int GetPhysicalIndex(int);
+    TextureDesc GetPhysicalDesc(int);
+    const char* GetPassName(int);
+    const char* GetResourceName(int);
+    unsigned int GetTransientBytes();
+    unsigned int GetAliasedBytes();
+
+private:
+    void BuildDependencies();
+    bool SortPasses();
+    void CullPasses();
+    void BuildTransitions();
+    void AliasResources();
+    bool ReadsVersion(int, int, int);
+    bool IsWrittenBy(int, int);
+    static unsigned int GetTextureBytes(const TextureDesc&);
+    static const char* GetStateName(ResourceState);
+
+private:
+    ResourceType m_resources[FRAME_GRAPH_MAX_RESOURCES];
+    PassType m_passes[FRAME_GRAPH_MAX_PASSES];
+    PhysicalType m_physical[FRAME_GRAPH_MAX_RESOURCES];
+    bool m_dependsOn[FRAME_GRAPH_MAX_PASSES][FRAME_GRAPH_MAX_PASSES];
+    int m_order[FRAME_GRAPH_MAX_PASSES];
+    int m_resourceCount, m_passCount, m_physicalCount, m_executedCount;
+    bool m_compiled;
+};
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "framestatsclass.h"
+
+static const char* g_frameTimeNames[FRAME_TIME_COUNT] = { "Frame", "Input", "Update", "Culling", "Draw", "Present" };
+
+FrameStatsClass::FrameStatsClass()
+{
+    m_frames = 0;
+    m_sorted = 0;
+    memset(m_current, 0, sizeof(m_current));
+    m_windowTotal = 0;
+    m_frameCount = 0;
+    m_hitchCount = 0;
+    m_currentLatency = 0;
+    memset(m_latencyBuckets, 0, sizeof(m_latencyBuckets));
+    m_latencyCount = 0;
+    m_latencyTotal = 0;
+    m_latencyMinimum = 0;
+    m_latencyMaximum = 0;
+}
+
+FrameStatsClass::FrameStatsClass(const FrameStatsClass& other)
+{
+
+}
+
+FrameStatsClass::~FrameStatsClass()
+{
+
+}
+
+bool FrameStatsClass::Initialize()
+{
+    m_frames = new FrameType[FRAME_STATS_CAPACITY];
+    if (!m_frames)
+        return false;
+
+    // Scratch space for sorting one column when percentiles are asked for
+    m_sorted = new long long[FRAME_STATS_CAPACITY];
+    if (!m_sorted)
+        return false;
+
+    memset(m_current, 0, sizeof(m_current));
+    m_windowTotal = 0;
+    m_frameCount = 0;
+    m_hitchCount = 0;
+
+    m_currentLatency = 0;
+    memset(m_latencyBuckets, 0, sizeof(m_latencyBuckets));
+    m_latencyCount = 0;
+    m_latencyTotal = 0;
+    m_latencyMinimum = 0;
+    m_latencyMaximum = 0;
+
+    return true;
+}
+
+void FrameStatsClass::Shutdown()
+{
+    if (m_sorted)
+    {
+        delete[] m_sorted;
+        m_sorted = 0;
+    }
+
+    if (m_frames)
+    {
+        delete[] m_frames;
+        m_frames = 0;
+    }
+
+    return;
+}
+
+// Phases can be timed more than once a frame, the times add up
+void FrameStatsClass::AddPhaseTime(int phase, long long nanoseconds)
+{
+    if ((phase <= FRAME_TIME_TOTAL) || (phase >= FRAME_TIME_COUNT))
+        return;
+
+    m_current[phase] += nanoseconds;
+
+    return;
+}
+
+void FrameStatsClass::EndFrame(long long frameNanoseconds)
+{
+    FrameType* frame;
+    int windowCount;
+
+    frame = &m_frames[m_frameCount % FRAME_STATS_CAPACITY];
+
+    // The oldest frame leaves the window once the ring has wrapped
+    if (m_frameCount >= (unsigned int)FRAME_STATS_CAPACITY)
+        m_windowTotal -= frame->times[FRAME_TIME_TOTAL];
+
+    // Compare against the frames before this one
+    windowCount = (m_frameCount < (unsigned int)FRAME_STATS_CAPACITY) ? (int)m_frameCount : FRAME_STATS_CAPACITY - 1;
+    frame->hitch = false;
+    if ((windowCount >= FRAME_STATS_HITCH_MIN_FRAMES) &&
+        ((double)frameNanoseconds > FRAME_STATS_HITCH_SCALE * (double)m_windowTotal / (double)windowCount))
+    {
+        frame->hitch = true;
+        m_hitchCount++;
+    }
+
+    m_current[FRAME_TIME_TOTAL] = frameNanoseconds;
+    memcpy(frame->times, m_current, sizeof(m_current));
+    memset(m_current, 0, sizeof(m_current));
+
+    frame->inputLatency = m_currentLatency;
+    m_currentLatency = 0;
+
+    m_windowTotal += frameNanoseconds;
+    m_frameCount++;
+
+    return;
+}
+
+// Percentiles use the nearest rank over the frames still in the ring
+bool FrameStatsClass::GetStats(int column, FrameStatsType& stats)
+{
+    int count, i;
+    long long total;
+
+    memset(&stats, 0, sizeof(stats));
+
+    if ((column < 0) || (column >= FRAME_TIME_COUNT))
+        return false;
+
+    count = (m_frameCount < (unsigned int)FRAME_STATS_CAPACITY) ? (int)m_frameCount : FRAME_STATS_CAPACITY;
+    if (count == 0)
+        return false;
+
+    total = 0;
+    for (i = 0; i < count; i++)
+    {
+        m_sorted[i] = m_frames[i].times[column];
+        total += m_sorted[i];
+    }
+
+    sort(m_sorted, m_sorted + count);
+
+    stats.frameCount = count;
+    stats.minimum = m_sorted[0];
+    stats.mean = total / count;
+    stats.p50 = m_sorted[(count * 50 + 99) / 100 - 1];
+    stats.p95 = m_sorted[(count * 95 + 99) / 100 - 1];
+    stats.p99 = m_sorted[(count * 99 + 99) / 100 - 1];
+    stats.maximum = m_sorted[count - 1];
+
+    return true;
+}
+
+// Called once the frame showing new input has been presented, with the time since that input was read
+void FrameStatsClass::AddInputLatency(long long nanoseconds)
+{
+    int bucket;
+
+    if (nanoseconds < 0)
+        nanoseconds = 0;
+
+    m_currentLatency = nanoseconds;
+
+    bucket = (int)(nanoseconds / FRAME_LATENCY_BUCKET_NANOSECONDS);
+    if (bucket >= FRAME_LATENCY_BUCKETS)
+        bucket = FRAME_LATENCY_BUCKETS - 1;
+    m_latencyBuckets[bucket]++;
+
+    if ((m_latencyCount == 0) || (nanoseconds < m_latencyMinimum))
+        m_latencyMinimum = nanoseconds;
+    if (nanoseconds > m_latencyMaximum)
+        m_latencyMaximum = nanoseconds;
+    m_latencyTotal += nanoseconds;
+    m_latencyCount++;
+
+    return;
+}
+
+// Over the whole run. Percentiles are the top of the bucket the nearest rank falls in, capped by the slowest.
+bool FrameStatsClass::GetLatencyStats(FrameStatsType& stats)
+{
+    long long* percentiles[3];
+    int ranks[3];
+    int seen, i, j;
+
+    memset(&stats, 0, sizeof(stats));
+    if (m_latencyCount == 0)
+        return false;
+
+    stats.frameCount = m_latencyCount;
+    stats.minimum = m_latencyMinimum;
+    stats.mean = m_latencyTotal / m_latencyCount;
+    stats.maximum = m_latencyMaximum;
+
+    percentiles[0] = &stats.p50;
+    percentiles[1] = &stats.p95;
+    percentiles[2] = &stats.p99;
+    ranks[0] = (m_latencyCount * 50 + 99) / 100;
+    ranks[1] = (m_latencyCount * 95 + 99) / 100;
+    ranks[2] = (m_latencyCount * 99 + 99) / 100;
+
+    seen = 0;
+    j = 0;
+    for (i = 0; (i < FRAME_LATENCY_BUCKETS) && (j < 3); i++)
+    {
+        seen += m_latencyBuckets[i];
+        while ((j < 3) && (seen >= ranks[j]))
+        {
+            *percentiles[j] = (long long)(i + 1) * FRAME_LATENCY_BUCKET_NANOSECONDS;
+            if (*percentiles[j] > m_latencyMaximum)
+                *percentiles[j] = m_latencyMaximum;
+            j++;
+        }
+    }
+
+    return true;
+}
+
+int FrameStatsClass::GetHitchCount()
+{
+    return m_hitchCount;
+}
+
+unsigned int FrameStatsClass::GetFrameCount()
+{
+    return m_frameCount;
+}
+
+// Writes one row per frame in the ring and one summary row per column
+bool FrameStatsClass::WriteCSV(char* framesFilename, char* summaryFilename)
+{
+    ofstream fout;
+    FrameStatsType stats;
+    FrameType* frame;
+    unsigned int first, i;
+    int j;
+
+    fout.open(framesFilename);
+    if (fout.fail())
+        return false;
+
+    fout << "frame";
+    for (j = 0; j < FRAME_TIME_COUNT; j++)
+        fout << "," << g_frameTimeNames[j] << "_ns";
+    fout << ",InputLatency_ns,hitch" << endl;
+
+    first = (m_frameCount > (unsigned int)FRAME_STATS_CAPACITY) ? m_frameCount - FRAME_STATS_CAPACITY : 0;
+    for (i = first; i < m_frameCount; i++)
+    {
+        frame = &m_frames[i % FRAME_STATS_CAPACITY];
+
+        fout << i;
+        for (j = 0; j < FRAME_TIME_COUNT; j++)
+            fout << "," << frame->times[j];
+        fout << "," << frame->inputLatency << "," << (frame->hitch ? 1 : 0) << endl;
+    }
+
+    fout.close();
+
+    fout.open(summaryFilename);
+    if (fout.fail())
+        return false;
+
+    fout.setf(ios::fixed);
+    fout.precision(3);
+
+    fout << "phase,frames,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches" << endl;
+    for (j = 0; j < FRAME_TIME_COUNT; j++)
+    {
+        if (!GetStats(j, stats))
+            continue;
+
+        fout << g_frameTimeNames[j] << "," << stats.frameCount << "," << (double)stats.minimum / 1000000.0 << "," <<
+            (double)stats.mean / 1000000.0 << "," << (double)stats.p50 / 1000000.0 << "," << (double)stats.p95 / 1000000.0 << "," <<
+            (double)stats.p99 / 1000000.0 << "," << (double)stats.maximum / 1000000.0 << ",";
+
+        // Hitches are counted over the whole run and only make sense for the whole frame
+        if (j == FRAME_TIME_TOTAL)
+            fout << m_hitchCount;
+        fout << endl;
+    }
+
+    // Only frames that presented new input, so its frame count is smaller
+    if (GetLatencyStats(stats))
+    {
+        fout << "InputLatency," << stats.frameCount << "," << (double)stats.minimum / 1000000.0 << "," <<
+            (double)stats.mean / 1000000.0 << "," << (double)stats.p50 / 1000000.0 << "," << (double)stats.p95 / 1000000.0 << "," <<
+            (double)stats.p99 / 1000000.0 << "," << (double)stats.maximum / 1000000.0 << "," << endl;
+    }
+
+    fout.close();
+
+    return true;
+}
+
+// One row per bucket up to the slowest one used, the bucket's lower edge in milliseconds
+bool FrameStatsClass::WriteLatencyHistogram(char* filename)
+{
+    ofstream fout;
+    int last, i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout.setf(ios::fixed);
+    fout.precision(1);
+
+    fout << "latency_ms,frames" << endl;
+
+    last = -1;
+    for (i = 0; i < FRAME_LATENCY_BUCKETS; i++)
+    {
+        if (m_latencyBuckets[i])
+            last = i;
+    }
+
+    for (i = 0; i <= last; i++)
+        fout << (double)((long long)i * FRAME_LATENCY_BUCKET_NANOSECONDS) / 1000000.0 << "," << m_latencyBuckets[i] << endl;
+
+    fout.close();
+
+    return true;
+}
\ No newline at end of file
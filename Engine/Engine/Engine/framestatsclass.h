@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <string.h>
+using namespace std;
+
+// Columns kept for every frame. The total is the time since the last frame
+// began, the others are parts of it that don't overlap.
+const int FRAME_TIME_TOTAL = 0;
+const int FRAME_TIME_INPUT = 1;
+const int FRAME_TIME_UPDATE = 2;
+const int FRAME_TIME_CULLING = 3;
+const int FRAME_TIME_DRAW = 4;
+const int FRAME_TIME_PRESENT = 5;
+const int FRAME_TIME_COUNT = 6;
+
+const int FRAME_STATS_CAPACITY = 4096;
+const int FRAME_STATS_HITCH_MIN_FRAMES = 30;
+const double FRAME_STATS_HITCH_SCALE = 2.0;
+const long long FRAME_LATENCY_BUCKET_NANOSECONDS = 500000;
+const int FRAME_LATENCY_BUCKETS = 400;
+
+// Summary of one column over the frames in the ring, in nanoseconds
+struct FrameStatsType
+{
+    int frameCount;
+    long long minimum, mean, p50, p95, p99, maximum;
+};
+
+// Keeps nanosecond frame and phase times for the most recent frames so frame
+// pacing can be reported, not just an average. A frame that takes more than
+// twice the rolling mean counts as a hitch. Frames that present new input also
+// keep the time from the input being read to the present, and those latencies
+// go in a histogram of half millisecond buckets over the whole run, the last
+// bucket holding everything slower.
+class FrameStatsClass
+{
+private:
+    struct FrameType
+    {
+        long long times[FRAME_TIME_COUNT];
+        long long inputLatency;
+        bool hitch;
+    };
+
+public:
+    FrameStatsClass();
+    FrameStatsClass(const FrameStatsClass&);
+    ~FrameStatsClass();
+
+    bool Initialize();
+    void Shutdown();
+
+    void AddPhaseTime(int, long long);
+    void EndFrame(long long);
+    void AddInputLatency(long long);
+
+    bool GetStats(int, FrameStatsType&);
+    bool GetLatencyStats(FrameStatsType&);
+    int GetHitchCount();
+    unsigned int GetFrameCount();
+    bool WriteCSV(char*, char*);
+    bool WriteLatencyHistogram(char*);
+
+    static inline long long GetNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    FrameType* m_frames;
+    long long* m_sorted;
+    long long m_current[FRAME_TIME_COUNT];
+    long long m_windowTotal;
+    unsigned int m_frameCount;
+    int m_hitchCount;
+
+    long long m_currentLatency;
+    unsigned int m_latencyBuckets[FRAME_LATENCY_BUCKETS];
+    int m_latencyCount;
+    long long m_latencyTotal, m_latencyMinimum, m_latencyMaximum;
+};
\ No newline at end of file
@@ -1,8 +1,221 @@
 #include "frustumclass.h"
+#include "cpufeatureclass.h"
+#include <chrono>
 
-FrustumClass::FrustumClass()
+const int FRUSTUM_TEST_COUNT = 4099;
+const int FRUSTUM_TEST_REPEATS = 50;
+
+// The spheres from first on, each one the same sum in the same order as PlaneDotCoord
+static int CheckSpheresRange(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int first, int count, int* visible)
+{
+    int visibleCount, i, j;
+
+    visibleCount = 0;
+    for (i = first; i < count; i++)
+    {
+        for (j = 0; j < 6; j++)
+        {
+            if (PlaneDotCoord(&planes[j], Vector3Type(x[i], y[i], z[i])) < -radius)
+                break;
+        }
+
+        if (j == 6)
+            visible[visibleCount++] = i;
+    }
+
+    return visibleCount;
+}
+
+static int CheckSpheresScalar(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int count, int* visible)
+{
+    return CheckSpheresRange(planes, x, y, z, radius, 0, count, visible);
+}
+
+#if CPU_X86
+// Four spheres at a time, a lane is culled once any plane has it too far outside
+CPU_TARGET("sse4.2")
+static int CheckSpheresSse42(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int count, int* visible)
+{
+    __m128 a[6], b[6], c[6], d[6], centerX, centerY, centerZ, distance, culled, negativeRadius;
+    int visibleCount, mask, i, j;
+
+    for (j = 0; j < 6; j++)
+    {
+        a[j] = _mm_set1_ps(planes[j].a);
+        b[j] = _mm_set1_ps(planes[j].b);
+        c[j] = _mm_set1_ps(planes[j].c);
+        d[j] = _mm_set1_ps(planes[j].d);
+    }
+    negativeRadius = _mm_set1_ps(-radius);
+
+    visibleCount = 0;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        centerX = _mm_loadu_ps(&x[i]);
+        centerY = _mm_loadu_ps(&y[i]);
+        centerZ = _mm_loadu_ps(&z[i]);
+
+        culled = _mm_setzero_ps();
+        for (j = 0; j < 6; j++)
+        {
+            distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[j], centerX), _mm_mul_ps(b[j], centerY)), _mm_mul_ps(c[j], centerZ)), d[j]);
+            culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, negativeRadius));
+        }
+
+        mask = _mm_movemask_ps(culled);
+        for (j = 0; j < 4; j++)
+        {
+            if (!(mask & (1 << j)))
+                visible[visibleCount++] = i + j;
+        }
+    }
+
+    return visibleCount + CheckSpheresRange(planes, x, y, z, radius, i, count, &visible[visibleCount]);
+}
+
+CPU_TARGET("avx2")
+static int CheckSpheresAvx2(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int count, int* visible)
 {
+    __m256 a[6], b[6], c[6], d[6], centerX, centerY, centerZ, distance, culled, negativeRadius;
+    int visibleCount, mask, i, j;
+
+    for (j = 0; j < 6; j++)
+    {
+        a[j] = _mm256_set1_ps(planes[j].a);
+        b[j] = _mm256_set1_ps(planes[j].b);
+        c[j] = _mm256_set1_ps(planes[j].c);
+        d[j] = _mm256_set1_ps(planes[j].d);
+    }
+    negativeRadius = _mm256_set1_ps(-radius);
+
+    visibleCount = 0;
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        centerX = _mm256_loadu_ps(&x[i]);
+        centerY = _mm256_loadu_ps(&y[i]);
+        centerZ = _mm256_loadu_ps(&z[i]);
+
+        culled = _mm256_setzero_ps();
+        for (j = 0; j < 6; j++)
+        {
+            distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[j], centerX), _mm256_mul_ps(b[j], centerY)), _mm256_mul_ps(c[j], centerZ)), d[j]);
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+        }
+
+        mask = _mm256_movemask_ps(culled);
+        for (j = 0; j < 8; j++)
+        {
+            if (!(mask & (1 << j)))
+                visible[visibleCount++] = i + j;
+        }
+    }
 
+    return visibleCount + CheckSpheresRange(planes, x, y, z, radius, i, count, &visible[visibleCount]);
+}
+
+// Sixteen at a time, the visible lanes' indices are packed straight into the output
+CPU_TARGET("avx512f")
+static int CheckSpheresAvx512(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int count, int* visible)
+{
+    __m512 a[6], b[6], c[6], d[6], centerX, centerY, centerZ, distance, negativeRadius;
+    __m512i lanes;
+    __mmask16 culled, inside;
+    int visibleCount, i, j;
+
+    for (j = 0; j < 6; j++)
+    {
+        a[j] = _mm512_set1_ps(planes[j].a);
+        b[j] = _mm512_set1_ps(planes[j].b);
+        c[j] = _mm512_set1_ps(planes[j].c);
+        d[j] = _mm512_set1_ps(planes[j].d);
+    }
+    negativeRadius = _mm512_set1_ps(-radius);
+    lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    visibleCount = 0;
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        centerX = _mm512_loadu_ps(&x[i]);
+        centerY = _mm512_loadu_ps(&y[i]);
+        centerZ = _mm512_loadu_ps(&z[i]);
+
+        culled = 0;
+        for (j = 0; j < 6; j++)
+        {
+            distance = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(a[j], centerX), _mm512_mul_ps(b[j], centerY)), _mm512_mul_ps(c[j], centerZ)), d[j]);
+            culled = (__mmask16)(culled | _mm512_cmp_ps_mask(distance, negativeRadius, _CMP_LT_OQ));
+        }
+
+        inside = (__mmask16)~culled;
+        _mm512_mask_compressstoreu_epi32(&visible[visibleCount], inside, _mm512_add_epi32(lanes, _mm512_set1_epi32(i)));
+        for (; inside; inside &= inside - 1)
+            visibleCount++;
+    }
+
+    return visibleCount + CheckSpheresRange(planes, x, y, z, radius, i, count, &visible[visibleCount]);
+}
+#endif
+
+#if CPU_NEON
+static int CheckSpheresNeon(const PlaneType* planes, const float* x, const float* y, const float* z, float radius, int count, int* visible)
+{
+    float32x4_t centerX, centerY, centerZ, distance, negativeRadius;
+    uint32x4_t culled;
+    unsigned int lanes[4];
+    int visibleCount, i, j;
+
+    negativeRadius = vdupq_n_f32(-radius);
+
+    visibleCount = 0;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        centerX = vld1q_f32(&x[i]);
+        centerY = vld1q_f32(&y[i]);
+        centerZ = vld1q_f32(&z[i]);
+
+        culled = vdupq_n_u32(0);
+        for (j = 0; j < 6; j++)
+        {
+            distance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(centerX, planes[j].a), vmulq_n_f32(centerY, planes[j].b)), vmulq_n_f32(centerZ, planes[j].c)),
+                vdupq_n_f32(planes[j].d));
+            culled = vorrq_u32(culled, vcltq_f32(distance, negativeRadius));
+        }
+
+        vst1q_u32(lanes, culled);
+        for (j = 0; j < 4; j++)
+        {
+            if (!lanes[j])
+                visible[visibleCount++] = i + j;
+        }
+    }
+
+    return visibleCount + CheckSpheresRange(planes, x, y, z, radius, i, count, &visible[visibleCount]);
+}
+#endif
+
+// Indexed by CpuIsaType
+static const CheckSpheresFunction g_checkSpheresKernels[CPU_ISA_COUNT] =
+{
+    CheckSpheresScalar,
+#if CPU_X86
+    CheckSpheresSse42,
+    CheckSpheresAvx2,
+    CheckSpheresAvx512,
+#else
+    0,
+    0,
+    0,
+#endif
+#if CPU_NEON
+    CheckSpheresNeon
+#else
+    0
+#endif
+};
+
+FrustumClass::FrustumClass()
+{
+    m_checkSpheres = CpuFeatureClass::Bind(g_checkSpheresKernels);
 }
 
 FrustumClass::FrustumClass(const FrustumClass& other)
@@ -15,10 +228,10 @@ FrustumClass::~FrustumClass()
 
 }
 
-void FrustumClass::ConstructFrustum(float screenDepth, D3DXMATRIX projectionMatrix, D3DXMATRIX viewMatrix)
+void FrustumClass::ConstructFrustum(float screenDepth, MatrixType projectionMatrix, MatrixType viewMatrix)
 {
     float zMinimum, r;
-    D3DXMATRIX matrix;
+    MatrixType matrix;
 
     zMinimum = -projectionMatrix._43 / projectionMatrix._33;
     r = screenDepth / (screenDepth - zMinimum);
@@ -26,49 +239,49 @@ void FrustumClass::ConstructFrustum(float screenDepth, D3DXMATRIX projectionMatr
     projectionMatrix._43 = -r * zMinimum;
 
     // Create frustum matrix
-    D3DXMatrixMultiply(&matrix, &viewMatrix, &projectionMatrix);
+    MatrixMultiply(&matrix, &viewMatrix, &projectionMatrix);
 
     // Near plane
     m_planes[0].a = matrix._14 + matrix._13;
     m_planes[0].b = matrix._24 + matrix._23;
     m_planes[0].c = matrix._34 + matrix._33;
     m_planes[0].d = matrix._44 + matrix._43;
-    D3DXPlaneNormalize(&m_planes[0], &m_planes[0]);
+    PlaneNormalize(&m_planes[0], &m_planes[0]);
 
     // Far plane
     m_planes[1].a = matrix._14 - matrix._13;
     m_planes[1].b = matrix._24 - matrix._23;
     m_planes[1].c = matrix._34 - matrix._33;
     m_planes[1].d = matrix._44 - matrix._43;
-    D3DXPlaneNormalize(&m_planes[1], &m_planes[1]);
+    PlaneNormalize(&m_planes[1], &m_planes[1]);
 
     // Left plane
     m_planes[2].a = matrix._14 + matrix._11;
     m_planes[2].b = matrix._24 + matrix._21;
     m_planes[2].c = matrix._34 + matrix._31;
     m_planes[2].d = matrix._44 + matrix._41;
-    D3DXPlaneNormalize(&m_planes[2], &m_planes[2]);
+    PlaneNormalize(&m_planes[2], &m_planes[2]);
 
     // Right plane
     m_planes[3].a = matrix._14 - matrix._11;
     m_planes[3].b = matrix._24 - matrix._21;
     m_planes[3].c = matrix._34 - matrix._31;
     m_planes[3].d = matrix._44 - matrix._41;
-    D3DXPlaneNormalize(&m_planes[3], &m_planes[3]);
+    PlaneNormalize(&m_planes[3], &m_planes[3]);
 
     // Top plane
     m_planes[4].a = matrix._14 - matrix._12;
     m_planes[4].b = matrix._24 - matrix._22;
     m_planes[4].c = matrix._34 - matrix._32;
     m_planes[4].d = matrix._44 - matrix._42;
-    D3DXPlaneNormalize(&m_planes[4], &m_planes[4]);
+    PlaneNormalize(&m_planes[4], &m_planes[4]);
 
     // Bottom plane
     m_planes[5].a = matrix._14 + matrix._12;
     m_planes[5].b = matrix._24 + matrix._22;
     m_planes[5].c = matrix._34 + matrix._32;
     m_planes[5].d = matrix._44 + matrix._42;
-    D3DXPlaneNormalize(&m_planes[5], &m_planes[5]);
+    PlaneNormalize(&m_planes[5], &m_planes[5]);
 
     return;
 }
@@ -78,7 +291,7 @@ bool FrustumClass::CheckPoint(float x, float y, float z)
     // Check if the point is inside all six planes of view frustum
     for (int i = 0; i < 6; i++)
     {
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3(x, y, z)) < 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type(x, y, z)) < 0.0f)
         {
             return false;
         }
@@ -91,35 +304,35 @@ bool FrustumClass::CheckCube(float xCenter, float yCenter, float zCenter, float
     // Check if any one point of cube is in view frustum
     for (int i = 0; i < 6; i++)
     {
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - radius), (yCenter - radius), (zCenter - radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - radius), (yCenter - radius), (zCenter - radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + radius), (yCenter - radius), (zCenter - radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + radius), (yCenter - radius), (zCenter - radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - radius), (yCenter + radius), (zCenter - radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - radius), (yCenter + radius), (zCenter - radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + radius), (yCenter + radius), (zCenter - radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + radius), (yCenter + radius), (zCenter - radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - radius), (yCenter - radius), (zCenter + radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - radius), (yCenter - radius), (zCenter + radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + radius), (yCenter - radius), (zCenter + radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + radius), (yCenter - radius), (zCenter + radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - radius), (yCenter + radius), (zCenter + radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - radius), (yCenter + radius), (zCenter + radius))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + radius), (yCenter + radius), (zCenter + radius))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + radius), (yCenter + radius), (zCenter + radius))) >= 0.0f)
         {
             continue;
         }
@@ -134,7 +347,7 @@ bool FrustumClass::CheckSphere(float xCenter, float yCenter, float zCenter, floa
     // Check if radius of sphere is inside view frustum
     for (int i = 0; i < 6; i++)
     {
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3(xCenter, yCenter, zCenter)) < -radius)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type(xCenter, yCenter, zCenter)) < -radius)
         {
             return false;
         }
@@ -148,35 +361,35 @@ bool FrustumClass::CheckRectangle(float xCenter, float yCenter, float zCenter, f
     // Check if any planes of the rectangle are inside view frustum
     for (int i = 0; i < 6; i++)
     {
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - xSize), (yCenter - ySize), (zCenter - zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - xSize), (yCenter - ySize), (zCenter - zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + xSize), (yCenter - ySize), (zCenter - zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + xSize), (yCenter - ySize), (zCenter - zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - xSize), (yCenter + ySize), (zCenter - zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - xSize), (yCenter + ySize), (zCenter - zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - xSize), (yCenter - ySize), (zCenter + zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - xSize), (yCenter - ySize), (zCenter + zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + xSize), (yCenter + ySize), (zCenter - zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + xSize), (yCenter + ySize), (zCenter - zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + xSize), (yCenter - ySize), (zCenter + zSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + xSize), (yCenter - ySize), (zCenter + zSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter - xSize), (yCenter + xSize), (zCenter + xSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter - xSize), (yCenter + xSize), (zCenter + xSize))) >= 0.0f)
         {
             continue;
         }
-        if (D3DXPlaneDotCoord(&m_planes[i], &D3DXVECTOR3((xCenter + xSize), (yCenter + xSize), (zCenter + xSize))) >= 0.0f)
+        if (PlaneDotCoord(&m_planes[i], Vector3Type((xCenter + xSize), (yCenter + xSize), (zCenter + xSize))) >= 0.0f)
         {
             continue;
         }
@@ -184,4 +397,98 @@ bool FrustumClass::CheckRectangle(float xCenter, float yCenter, float zCenter, f
     }
 
     return true;
+}
+
+int FrustumClass::CheckSpheres(const float* x, const float* y, const float* z, float radius, int count, int* visible)
+{
+    return m_checkSpheres(m_planes, x, y, z, radius, count, visible);
+}
+
+static long long GetNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Spheres scattered round a camera, some on the planes, through every version
+// the machine can run. Each has to cull exactly what CheckSphere does.
+bool FrustumClass::TestKernels(ofstream& fout)
+{
+    FrustumClass frustum;
+    MatrixType view, projection;
+    Vector3Type eye, at, up;
+    float* centers;
+    int* expected;
+    int* visible;
+    long long start, elapsed, best;
+    unsigned int seed;
+    int expectedCount, visibleCount, isa, i, repeat;
+    bool passed, result;
+
+    centers = new float[3 * FRUSTUM_TEST_COUNT];
+    if (!centers)
+        return false;
+
+    expected = new int[FRUSTUM_TEST_COUNT];
+    if (!expected)
+        return false;
+
+    visible = new int[FRUSTUM_TEST_COUNT];
+    if (!visible)
+        return false;
+
+    eye = Vector3Type(0.0f, 0.0f, -10.0f);
+    at = Vector3Type(0.0f, 0.0f, 0.0f);
+    up = Vector3Type(0.0f, 1.0f, 0.0f);
+    MatrixLookAtLH(&view, &eye, &at, &up);
+    MatrixPerspectiveFovLH(&projection, MATH_PI / 4.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    frustum.ConstructFrustum(100.0f, projection, view);
+
+    seed = 1;
+    for (i = 0; i < 3 * FRUSTUM_TEST_COUNT; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        centers[i] = ((float)(seed >> 8) / 16777216.0f - 0.5f) * 120.0f;
+    }
+
+    expectedCount = 0;
+    for (i = 0; i < FRUSTUM_TEST_COUNT; i++)
+    {
+        if (frustum.CheckSphere(centers[i], centers[FRUSTUM_TEST_COUNT + i], centers[2 * FRUSTUM_TEST_COUNT + i], 1.0f))
+            expected[expectedCount++] = i;
+    }
+
+    fout << "CheckSpheres, " << FRUSTUM_TEST_COUNT << " spheres, " << expectedCount << " visible" << endl;
+    fout.setf(ios::fixed);
+    fout.precision(2);
+
+    result = true;
+    for (isa = 0; isa < CPU_ISA_COUNT; isa++)
+    {
+        if (!g_checkSpheresKernels[isa] || !CpuFeatureClass::IsSupported((CpuIsaType)isa))
+            continue;
+
+        visibleCount = g_checkSpheresKernels[isa](frustum.m_planes, centers, &centers[FRUSTUM_TEST_COUNT], &centers[2 * FRUSTUM_TEST_COUNT], 1.0f,
+            FRUSTUM_TEST_COUNT, visible);
+        passed = (visibleCount == expectedCount) && (memcmp(visible, expected, expectedCount * sizeof(int)) == 0);
+        result = result && passed;
+
+        best = 0x7fffffffffffffffLL;
+        for (repeat = 0; repeat < FRUSTUM_TEST_REPEATS; repeat++)
+        {
+            start = GetNanoseconds();
+            g_checkSpheresKernels[isa](frustum.m_planes, centers, &centers[FRUSTUM_TEST_COUNT], &centers[2 * FRUSTUM_TEST_COUNT], 1.0f,
+                FRUSTUM_TEST_COUNT, visible);
+            elapsed = GetNanoseconds() - start;
+            if (elapsed < best)
+                best = elapsed;
+        }
+
+        fout << "  " << CpuFeatureClass::GetIsaName((CpuIsaType)isa) << ": " << (passed ? "match" : "MISMATCH") << ", " << (double)best / FRUSTUM_TEST_COUNT << " ns a sphere" << endl;
+    }
+
+    delete[] visible;
+    delete[] expected;
+    delete[] centers;
+
+    return result;
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
-#include <d3dx10math.h>
+#include "mathclass.h"
+#include <fstream>
+using namespace std;
+
+// Writes the indices of the spheres inside all six planes, in order, and returns how many
+typedef int (*CheckSpheresFunction)(const PlaneType*, const float*, const float*, const float*, float, int, int*);
 
 class FrustumClass
 {
@@ -9,13 +14,19 @@ public:
     FrustumClass(const FrustumClass& other);
     ~FrustumClass();
 
-    void ConstructFrustum(float, D3DXMATRIX, D3DXMATRIX);
+    void ConstructFrustum(float, MatrixType, MatrixType);
     
     bool CheckPoint(float, float, float);
     bool CheckCube(float, float, float, float);
     bool CheckSphere(float, float, float, float);
     bool CheckRectangle(float, float, float, float, float, float);
 
+    // Same test as CheckSphere for a whole array of centers of the same radius
+    int CheckSpheres(const float*, const float*, const float*, float, int, int*);
+
+    static bool TestKernels(ofstream&);
+
 private:
-    D3DXPLANE m_planes[6];
+    PlaneType m_planes[6];
+    CheckSpheresFunction m_checkSpheres;
 };
\ No newline at end of file
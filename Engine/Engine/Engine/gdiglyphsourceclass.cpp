@@ -0,0 +1,207 @@
+#include "gdiglyphsourceclass.h"
+
+// GGO_GRAY8_BITMAP has 65 levels of coverage
+const unsigned int GDI_GRAY_LEVELS = 64;
+
+GdiGlyphSourceClass::GdiGlyphSourceClass()
+{
+    m_deviceContext = 0;
+    m_font = 0;
+    m_oldFont = 0;
+    memset(&m_metrics, 0, sizeof(m_metrics));
+    m_outline = 0;
+    m_outlineSize = 0;
+    m_coverage = 0;
+    m_coverageSize = 0;
+}
+
+GdiGlyphSourceClass::GdiGlyphSourceClass(const GdiGlyphSourceClass& other)
+{
+
+}
+
+GdiGlyphSourceClass::~GdiGlyphSourceClass()
+{
+
+}
+
+// The size is the font's cell height in pixels
+bool GdiGlyphSourceClass::Open(const char* face, int pixelSize)
+{
+    wchar_t faceName[LF_FACESIZE];
+
+    if (MultiByteToWideChar(CP_UTF8, 0, face, -1, faceName, LF_FACESIZE) == 0)
+        return false;
+
+    m_deviceContext = CreateCompatibleDC(0);
+    if (!m_deviceContext)
+        return false;
+
+    m_font = CreateFontW(-pixelSize, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+        ANTIALIASED_QUALITY, DEFAULT_PITCH, faceName);
+    if (!m_font)
+        return false;
+
+    m_oldFont = (HFONT)SelectObject(m_deviceContext, m_font);
+
+    if (!GetTextMetricsW(m_deviceContext, &m_metrics))
+        return false;
+
+    return true;
+}
+
+void GdiGlyphSourceClass::Close()
+{
+    if (m_coverage)
+    {
+        delete[] m_coverage;
+        m_coverage = 0;
+    }
+    m_coverageSize = 0;
+
+    if (m_outline)
+    {
+        delete[] m_outline;
+        m_outline = 0;
+    }
+    m_outlineSize = 0;
+
+    if (m_deviceContext && m_oldFont)
+        SelectObject(m_deviceContext, m_oldFont);
+    m_oldFont = 0;
+
+    if (m_font)
+    {
+        DeleteObject(m_font);
+        m_font = 0;
+    }
+
+    if (m_deviceContext)
+    {
+        DeleteDC(m_deviceContext);
+        m_deviceContext = 0;
+    }
+
+    return;
+}
+
+float GdiGlyphSourceClass::GetLineHeight()
+{
+    return (float)(m_metrics.tmHeight + m_metrics.tmExternalLeading);
+}
+
+bool GdiGlyphSourceClass::GetGlyph(unsigned int codepoint, GlyphBitmapType& bitmap)
+{
+    GLYPHMETRICS metrics;
+    MAT2 transform;
+    WCHAR character;
+    WORD index;
+    DWORD size;
+    unsigned int pitch, x, y;
+
+    if (codepoint > 0xffff)
+        return false;
+
+    // Fonts without the glyph would draw their default box instead
+    character = (WCHAR)codepoint;
+    if ((GetGlyphIndicesW(m_deviceContext, &character, 1, &index, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR) || (index == 0xffff))
+        return false;
+
+    memset(&transform, 0, sizeof(transform));
+    transform.eM11.value = 1;
+    transform.eM22.value = 1;
+
+    size = GetGlyphOutlineW(m_deviceContext, codepoint, GGO_GRAY8_BITMAP, &metrics, 0, 0, &transform);
+    if (size == GDI_ERROR)
+        return false;
+
+    bitmap.advance = (float)metrics.gmCellIncX;
+    bitmap.offsetX = (float)metrics.gmptGlyphOrigin.x;
+    bitmap.offsetY = (float)(m_metrics.tmAscent - metrics.gmptGlyphOrigin.y);
+
+    // Blanks have no outline at all
+    if (size == 0)
+    {
+        bitmap.coverage = 0;
+        bitmap.width = 0;
+        bitmap.height = 0;
+        bitmap.pitch = 0;
+        return true;
+    }
+
+    if (size > m_outlineSize)
+    {
+        if (m_outline)
+            delete[] m_outline;
+
+        m_outline = new unsigned char[size];
+        if (!m_outline)
+        {
+            m_outlineSize = 0;
+            return false;
+        }
+
+        m_outlineSize = size;
+    }
+
+    if (GetGlyphOutlineW(m_deviceContext, codepoint, GGO_GRAY8_BITMAP, &metrics, size, m_outline, &transform) == GDI_ERROR)
+        return false;
+
+    if (metrics.gmBlackBoxX * metrics.gmBlackBoxY > m_coverageSize)
+    {
+        if (m_coverage)
+            delete[] m_coverage;
+
+        m_coverage = new unsigned char[metrics.gmBlackBoxX * metrics.gmBlackBoxY];
+        if (!m_coverage)
+        {
+            m_coverageSize = 0;
+            return false;
+        }
+
+        m_coverageSize = metrics.gmBlackBoxX * metrics.gmBlackBoxY;
+    }
+
+    // Rows come DWORD aligned with coverage from 0 to 64
+    pitch = (metrics.gmBlackBoxX + 3) & ~3;
+    for (y = 0; y < metrics.gmBlackBoxY; y++)
+    {
+        for (x = 0; x < metrics.gmBlackBoxX; x++)
+            m_coverage[y * metrics.gmBlackBoxX + x] = (unsigned char)(min((unsigned int)m_outline[y * pitch + x], GDI_GRAY_LEVELS) * 255 / GDI_GRAY_LEVELS);
+    }
+
+    bitmap.coverage = m_coverage;
+    bitmap.width = (int)metrics.gmBlackBoxX;
+    bitmap.height = (int)metrics.gmBlackBoxY;
+    bitmap.pitch = (int)metrics.gmBlackBoxX;
+
+    return true;
+}
+
+int GdiGlyphSourceClass::GetKerningPairs(GlyphKerningType* pairs, int capacity)
+{
+    KERNINGPAIR* kerning;
+    DWORD count;
+    int i;
+
+    count = GetKerningPairsW(m_deviceContext, 0, 0);
+    if ((count == 0) || !pairs || (capacity <= 0))
+        return (int)count;
+
+    kerning = new KERNINGPAIR[count];
+    if (!kerning)
+        return 0;
+
+    count = GetKerningPairsW(m_deviceContext, count, kerning);
+
+    for (i = 0; (i < (int)count) && (i < capacity); i++)
+    {
+        pairs[i].first = kerning[i].wFirst;
+        pairs[i].second = kerning[i].wSecond;
+        pairs[i].amount = (float)kerning[i].iKernAmount;
+    }
+
+    delete[] kerning;
+
+    return (int)count;
+}
\ No newline at end of file
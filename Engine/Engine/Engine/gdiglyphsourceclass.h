@@ -0,0 +1,33 @@
+#pragma once
+#pragma comment(lib, "gdi32.lib")
+
+#include <Windows.h>
+#include "fontbakerclass.h"
+
+// Draws glyphs with GDI's anti-aliased glyph outlines from any installed
+// TrueType or OpenType face. GDI takes UTF-16 characters, so this covers the
+// Basic Multilingual Plane.
+class GdiGlyphSourceClass : public GlyphSourceClass
+{
+public:
+    GdiGlyphSourceClass();
+    GdiGlyphSourceClass(const GdiGlyphSourceClass&);
+    ~GdiGlyphSourceClass();
+
+    bool Open(const char*, int);
+    void Close();
+
+    float GetLineHeight();
+    bool GetGlyph(unsigned int, GlyphBitmapType&);
+    int GetKerningPairs(GlyphKerningType*, int);
+
+private:
+    HDC m_deviceContext;
+    HFONT m_font, m_oldFont;
+    TEXTMETRICW m_metrics;
+
+    unsigned char* m_outline;
+    unsigned int m_outlineSize;
+    unsigned char* m_coverage;
+    unsigned int m_coverageSize;
+};
\ No newline at end of file
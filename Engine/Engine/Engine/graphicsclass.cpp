@@ -2,14 +2,27 @@
 
 GraphicsClass::GraphicsClass()
 {
-    m_D3D = 0;
+    m_Device = 0;
+    m_SoftwareDevice = 0;
     m_Camera = 0;
+    m_TextureStreamer = 0;
     m_Text = 0;
     m_Model = 0;
     m_LightShader = 0;
     m_Light = 0;
     m_ModelList = 0;
     m_Frustum = 0;
+    m_visibleIndices = 0;
+    m_visibleColors = 0;
+    m_ParallelRecord = 0;
+    m_DeferredRecorder = 0;
+    m_FrameGraph = 0;
+    m_RenderTargets = 0;
+    m_FrameStats = 0;
+    m_presentedEventId = 0;
+    m_screenHeight = 0;
+    m_renderCount = 0;
+    memset(&m_renderStats, 0, sizeof(m_renderStats));
 }
 
 
@@ -25,22 +38,83 @@ GraphicsClass::~GraphicsClass()
 }
 
 
-bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
+// Picks the device from the build settings
+bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd, unsigned int modelSeed)
+{
+    GraphicsDeviceType deviceType;
+
+    deviceType = GRAPHICS_DEVICE_D3D;
+    if (NULL_RENDER_DEVICE)
+        deviceType = GRAPHICS_DEVICE_NULL;
+    else if (SOFTWARE_RENDER_DEVICE)
+        deviceType = GRAPHICS_DEVICE_SOFTWARE;
+
+    return Initialize(screenWidth, screenHeight, hwnd, deviceType, VSYNC_ENABLED, modelSeed);
+}
+
+// The seed places the models, so runs with the same seed draw the same scene
+bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd, GraphicsDeviceType deviceType, bool vsync, unsigned int modelSeed)
 {
     bool result;
-    D3DXMATRIX baseViewMatrix;
+    MatrixType baseViewMatrix;
+#ifdef _WIN32
+    D3DClass* d3d;
+#endif
+    NullRenderDeviceClass* nullDevice;
+    SoftwareRenderDeviceClass* softwareDevice;
+
+    if (deviceType == GRAPHICS_DEVICE_NULL)
+    {
+        // Create the recording device, nothing is drawn or presented
+        nullDevice = new NullRenderDeviceClass;
+        if (!nullDevice)
+            return false;
 
-    // Create Direct3D object
-    m_D3D = new D3DClass;
-    if (!m_D3D)
-        return false;
+        m_Device = nullDevice;
 
-    // Init Direct3D object
-    result = m_D3D->Initialize(screenWidth, screenHeight, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
-    if (!result)
+        result = nullDevice->Initialize(screenWidth, screenHeight, SCREEN_DEPTH, SCREEN_NEAR);
+        if (!result)
+            return false;
+    }
+    else if (deviceType == GRAPHICS_DEVICE_SOFTWARE)
+    {
+        // Create the CPU rasterizer, the frame ends up in system memory
+        softwareDevice = new SoftwareRenderDeviceClass;
+        if (!softwareDevice)
+            return false;
+
+        m_Device = softwareDevice;
+        m_SoftwareDevice = softwareDevice;
+
+        result = softwareDevice->Initialize(screenWidth, screenHeight, SCREEN_DEPTH, SCREEN_NEAR, SOFTWARE_RENDER_THREADS);
+        if (!result)
+        {
+            MessageBox(hwnd, L"Could not initialize the software rasterizer", L"Error", MB_OK);
+            return false;
+        }
+    }
+    else
     {
-        MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
+#ifdef _WIN32
+        // Create Direct3D object
+        d3d = new D3DClass;
+        if (!d3d)
+            return false;
+
+        m_Device = d3d;
+
+        // Init Direct3D object
+        result = d3d->Initialize(screenWidth, screenHeight, vsync, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
+        if (!result)
+        {
+            MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
+            return false;
+        }
+#else
+        // Only the null and software devices exist off Windows
+        MessageBox(hwnd, L"Direct3D is only available on Windows", L"Error", MB_OK);
         return false;
+#endif
     }
 
     // Create camera object
@@ -59,20 +133,39 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
         return false;
 
     // Initialize text object
-    result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix);
+    result = m_Text->Initialize(m_Device, hwnd, screenWidth, screenHeight, baseViewMatrix);
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
         return false;
     }
 
+    m_screenHeight = screenHeight;
+
+    // Create the texture streamer, textures start with their smallest mips
+    m_TextureStreamer = new TextureStreamerClass;
+    if (!m_TextureStreamer)
+        return false;
+
+    result = m_TextureStreamer->Initialize(m_Device, TEXTURE_STREAM_BUDGET);
+    if (!result)
+    {
+        MessageBox(hwnd, L"Could not initialize the texture streamer object.", L"Error", MB_OK);
+        return false;
+    }
+
     // Create the model object
     m_Model = new ModelClass;
     if (!m_Model)
         return false;
 
-    // Initialize the model object
-    result = m_Model->Initialize(m_D3D->GetDevice(), L"../Engine/data/seafloor.dds", "../Engine/data/sphere.txt");
+    // Stream the baked texture with its full mip chain when there is one, the software device can't read block compressed files
+    result = m_Model->Initialize(m_Device, m_TextureStreamer, L"../Engine/data/seafloor-bc7.dds", "../Engine/data/sphere.txt");
+    if (!result)
+    {
+        m_Model->Shutdown();
+        result = m_Model->Initialize(m_Device, m_TextureStreamer, L"../Engine/data/seafloor.dds", "../Engine/data/sphere.txt");
+    }
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
@@ -85,7 +178,7 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
         return false;
 
     // Initialize light shader object
-    result = m_LightShader->Initialize(m_D3D->GetDevice(), hwnd);
+    result = m_LightShader->Initialize(m_Device);
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the light shader object.", L"Error", MB_OK);
@@ -106,7 +199,7 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
         return false;
 
     // Init model list object
-    result = m_ModelList->Initialize(25);
+    result = m_ModelList->Initialize(25, modelSeed);
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the model list object.", L"Error", MB_OK);
@@ -118,12 +211,112 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
     if (!m_Frustum)
         return false;
 
+    // Create the per-frame lists of visible objects
+    m_visibleIndices = new int[m_ModelList->GetModelCount()];
+    if (!m_visibleIndices)
+        return false;
+
+    m_visibleColors = new Vector4Type[m_ModelList->GetModelCount()];
+    if (!m_visibleColors)
+        return false;
+
+    // Create the worker threads that record the 3D pass
+    m_ParallelRecord = new ParallelRecordClass;
+    if (!m_ParallelRecord)
+        return false;
+
+    result = m_ParallelRecord->Initialize(RECORD_WORKER_COUNT);
+    if (!result)
+    {
+        MessageBox(hwnd, L"Could not initialize the parallel record object.", L"Error", MB_OK);
+        return false;
+    }
+
+    // Create one deferred context per worker, rendering stays single threaded without them
+    m_DeferredRecorder = new DeferredRecorderClass;
+    if (!m_DeferredRecorder)
+        return false;
+
+    result = m_DeferredRecorder->Initialize(m_Device, RECORD_WORKER_COUNT, RecordObjectRange, this);
+    if (!result)
+    {
+        m_DeferredRecorder->Shutdown();
+        delete m_DeferredRecorder;
+        m_DeferredRecorder = 0;
+    }
+
+    // Create the frame graph that orders the passes of a frame
+    m_FrameGraph = new FrameGraphClass;
+    if (!m_FrameGraph)
+        return false;
+
+    result = BuildFrameGraph();
+    if (!result)
+    {
+        MessageBox(hwnd, L"Could not compile the frame graph.", L"Error", MB_OK);
+        return false;
+    }
+
+    // Write the compiled graph out so the pass order can be checked
+    m_FrameGraph->Dump("framegraph.txt");
+
+    // Create the textures backing the graph's transient resources
+    m_RenderTargets = new RenderTargetPoolClass;
+    if (!m_RenderTargets)
+        return false;
+
+    result = m_RenderTargets->Initialize(m_Device, m_FrameGraph);
+    if (!result)
+    {
+        MessageBox(hwnd, L"Could not initialize the render target pool object.", L"Error", MB_OK);
+        return false;
+    }
+
     return true;
 }
 
 
 void GraphicsClass::Shutdown()
 {
+    if (m_RenderTargets)
+    {
+        m_RenderTargets->Shutdown();
+        delete m_RenderTargets;
+        m_RenderTargets = 0;
+    }
+
+    if (m_FrameGraph)
+    {
+        delete m_FrameGraph;
+        m_FrameGraph = 0;
+    }
+
+    if (m_DeferredRecorder)
+    {
+        m_DeferredRecorder->Shutdown();
+        delete m_DeferredRecorder;
+        m_DeferredRecorder = 0;
+    }
+
+    if (m_ParallelRecord)
+    {
+        m_ParallelRecord->Shutdown();
+        delete m_ParallelRecord;
+        m_ParallelRecord = 0;
+    }
+
+    if (m_visibleColors)
+    {
+        delete[] m_visibleColors;
+        m_visibleColors = 0;
+    }
+
+    if (m_visibleIndices)
+    {
+        delete[] m_visibleIndices;
+        m_visibleIndices = 0;
+    }
+
     if (m_Frustum)
     {
         delete m_Frustum;
@@ -157,6 +350,13 @@ void GraphicsClass::Shutdown()
         m_Model = 0;
     }
 
+    if (m_TextureStreamer)
+    {
+        m_TextureStreamer->Shutdown();
+        delete m_TextureStreamer;
+        m_TextureStreamer = 0;
+    }
+
     if (m_Text)
     {
         m_Text->Shutdown();
@@ -170,11 +370,19 @@ void GraphicsClass::Shutdown()
         m_Camera = 0;
     }
 
-    if (m_D3D)
+    // Keep the last software frame and the rasterizer throughput
+    if (m_SoftwareDevice)
     {
-        m_D3D->Shutdown();
-        delete m_D3D;
-        m_D3D = 0;
+        m_SoftwareDevice->SaveFrame("software-frame.ppm");
+        m_SoftwareDevice->WriteStats("software-raster.txt");
+        m_SoftwareDevice = 0;
+    }
+
+    if (m_Device)
+    {
+        m_Device->Shutdown();
+        delete m_Device;
+        m_Device = 0;
     }
 
     return;
@@ -182,10 +390,15 @@ void GraphicsClass::Shutdown()
 
 
 bool GraphicsClass::Frame(float rotationY)
+{
+    return Frame(Vector3Type(0.0f, 0.0f, -10.0f), Vector3Type(0.0f, rotationY, 0.0f));
+}
+
+bool GraphicsClass::Frame(Vector3Type position, Vector3Type rotation)
 {
     // Set camera position and rotation
-    m_Camera->SetPosition(0.0f, 0.0f, -10.0f);
-    m_Camera->SetRotation(0.0f, rotationY, 0.0f);
+    m_Camera->SetPosition(position.x, position.y, position.z);
+    m_Camera->SetRotation(rotation.x, rotation.y, rotation.z);
 
     return true;
 }
@@ -193,84 +406,308 @@ bool GraphicsClass::Frame(float rotationY)
 
 bool GraphicsClass::Render()
 {
-    D3DXMATRIX worldMatrix, viewMatrix, projectionMatrix, orthoMatrix;
-    int modelCount, renderCount, index;
-    float positionX, positionY, positionZ, radius;
-    D3DXVECTOR4 color;
-    bool renderModel, result;
-
-    // Clear the buffers to begin the scene
-    m_D3D->BeginScene(0.0f, 0.5f, 0.5f, 1.0f);
+    InputLatencyTagType tag;
+    long long phaseStart;
+    bool result;
 
     // Generate the view matrix based on the camera's position
     m_Camera->Render();
 
-    m_Camera->GetViewMatrix(viewMatrix);
-    m_D3D->GetWorldMatrix(worldMatrix);
-    m_D3D->GetProjectionMatrix(projectionMatrix);
-    m_D3D->GetOrthoMatrix(orthoMatrix);
+    m_Camera->GetViewMatrix(m_viewMatrix);
+    m_Device->GetWorldMatrix(m_worldMatrix);
+    m_Device->GetProjectionMatrix(m_projectionMatrix);
+    m_Device->GetOrthoMatrix(m_orthoMatrix);
+
+    // Work out which models are visible this frame
+    phaseStart = FrameStatsClass::GetNanoseconds();
+    CullModels();
+    AddPhaseTime(FRAME_TIME_CULLING, phaseStart);
+
+    // Run the passes in the order the graph worked out
+    phaseStart = FrameStatsClass::GetNanoseconds();
+    result = m_FrameGraph->Execute(RenderTargetPoolClass::ApplyTransitions, m_RenderTargets);
+    AddPhaseTime(FRAME_TIME_DRAW, phaseStart);
+    if (!result)
+        return false;
+
+    // Keep what this frame submitted
+    m_renderStats = m_Device->GetContext()->GetStats();
+    m_Device->GetContext()->ResetStats();
+
+    PROFILE_COUNTER("Visible models", m_renderCount);
+    PROFILE_COUNTER("Draw calls", m_renderStats.drawCalls);
+    PROFILE_COUNTER("Texture KB resident", m_TextureStreamer->GetStats().residentBytes / 1024);
+    PROFILE_COUNTER("Texture KB requested", m_TextureStreamer->GetStats().requestedBytes / 1024);
+    PROFILE_COUNTER("Bytes uploaded", m_renderStats.bytesUploaded);
+
+    phaseStart = FrameStatsClass::GetNanoseconds();
+    {
+        PROFILE_ZONE("Present");
+        m_Device->EndScene();
+    }
+    AddPhaseTime(FRAME_TIME_PRESENT, phaseStart);
+
+    // Input the camera moved for has now been handed to the display. Only
+    // the first present that shows it counts, and the time the swap chain
+    // queues the frame after Present returns isn't visible from here.
+    tag = m_Camera->GetLatencyTag();
+    if (m_FrameStats && (tag.eventId != 0) && (tag.eventId != m_presentedEventId))
+    {
+        m_FrameStats->AddInputLatency(FrameStatsClass::GetNanoseconds() - tag.inputTime);
+        m_presentedEventId = tag.eventId;
+    }
+
+    return true;
+}
+
+void GraphicsClass::SetFrameStats(FrameStatsClass* frameStats)
+{
+    m_FrameStats = frameStats;
+    return;
+}
+
+// The input behind the camera set by the last Frame, measured when Render presents it
+void GraphicsClass::SetLatencyTag(const InputLatencyTagType& tag)
+{
+    m_Camera->SetLatencyTag(tag);
+    return;
+}
+
+// Adds the time since phaseStart to a phase of the current frame
+void GraphicsClass::AddPhaseTime(int phase, long long phaseStart)
+{
+    if (m_FrameStats)
+        m_FrameStats->AddPhaseTime(phase, FrameStatsClass::GetNanoseconds() - phaseStart);
+
+    return;
+}
+
+void GraphicsClass::CullModels()
+{
+    InstanceTransformsType transforms;
+    int modelCount, index, i;
+    float positionX, positionY, positionZ, radius, depth, pixels;
+    Vector4Type color;
+
+    PROFILE_ZONE("Culling");
 
     // Construct the frustum
-    m_Frustum->ConstructFrustum(SCREEN_DEPTH, projectionMatrix, viewMatrix);
+    m_Frustum->ConstructFrustum(SCREEN_DEPTH, m_projectionMatrix, m_viewMatrix);
 
     // Get the number of models that will be rendered
     modelCount = m_ModelList->GetModelCount();
 
-    renderCount = 0;
+    radius = 1.0f;
+
+    // Only render objs within view, the shader builds their matrices from the transforms in one batch
+    transforms = m_ModelList->GetTransforms();
+    m_renderCount = m_Frustum->CheckSpheres(transforms.positionX, transforms.positionY, transforms.positionZ, radius, modelCount, m_visibleIndices);
 
-    // Only render objs within view
-    for (index = 0; index<modelCount; index++)
+    for (i = 0; i < m_renderCount; i++)
     {
-        // Get the position and color of the sphere model at this index
+        // Get the position and color of the visible sphere model
+        index = m_visibleIndices[i];
         m_ModelList->GetData(index, positionX, positionY, positionZ, color);
+        m_visibleColors[i] = color;
+
+        // The sphere's height on screen, its texture wraps round it so about twice that is drawn across
+        depth = positionX * m_viewMatrix._13 + positionY * m_viewMatrix._23 + positionZ * m_viewMatrix._33 + m_viewMatrix._43;
+        pixels = 4.0f * m_screenHeight;
+        if (depth > radius)
+            pixels = 2.0f * radius * m_projectionMatrix._22 * m_screenHeight / depth;
 
-        radius = 1.0f;
+        m_Model->RequestTextureSize(pixels);
+    }
 
-        // Check if the sphere model is in the view frustum
-        renderModel = m_Frustum->CheckSphere(positionX, positionY, positionZ, radius);
+    // Swap in the mips that finished loading and queue the ones the visible models now need
+    m_TextureStreamer->Update();
 
-        // If it can be seen then render it
-        if (renderModel)
-        {
-            // Move the model to the location it should be rendered at
-            D3DXMatrixTranslation(&worldMatrix, positionX, positionY, positionZ);
+    return;
+}
 
-            // Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing
-            m_Model->Render(m_D3D->GetDeviceContext());
+bool GraphicsClass::BuildFrameGraph()
+{
+    int backBuffer, depthBuffer, pass;
+    bool result;
 
-            // Render the model using the light shader
-            m_LightShader->Render(m_D3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-                m_Model->GetTexture(), m_Light->GetDirection(), color);
+    // The swap chain and depth buffer are owned by D3DClass
+    backBuffer = m_FrameGraph->ImportTexture("BackBuffer", false);
+    depthBuffer = m_FrameGraph->ImportTexture("DepthBuffer", true);
+    if ((backBuffer < 0) || (depthBuffer < 0))
+        return false;
 
-            // Reset to the original world matrix
-            m_D3D->GetWorldMatrix(worldMatrix);
+    pass = m_FrameGraph->AddPass("Clear", ClearPass, this);
+    if (pass < 0)
+        return false;
 
-            renderCount++;
-        }
-    }
+    m_FrameGraph->Write(pass, backBuffer);
+    m_FrameGraph->Write(pass, depthBuffer);
+
+    // The scene and text draw over what is already there, so they read what they write
+    pass = m_FrameGraph->AddPass("Scene", ScenePass, this);
+    if (pass < 0)
+        return false;
+
+    m_FrameGraph->Read(pass, backBuffer);
+    m_FrameGraph->Read(pass, depthBuffer);
+    m_FrameGraph->Write(pass, backBuffer);
+    m_FrameGraph->Write(pass, depthBuffer);
+
+    pass = m_FrameGraph->AddPass("Text", TextPass, this);
+    if (pass < 0)
+        return false;
+
+    m_FrameGraph->Read(pass, backBuffer);
+    m_FrameGraph->Write(pass, backBuffer);
 
-    // Set the number of models that was actually rendered this frame
-    result = m_Text->SetRenderCount(renderCount, m_D3D->GetDeviceContext());
+    m_FrameGraph->MarkOutput(backBuffer);
+
+    result = m_FrameGraph->Compile();
     if (!result)
         return false;
 
-    // 2D rendering begins
-    m_D3D->TurnZBufferOff();
+    return true;
+}
 
-    // Before rending text
-    m_D3D->TurnOnAlphaBlending();
+bool GraphicsClass::ClearPass(FrameGraphClass* frameGraph, int pass, void* userData)
+{
+    GraphicsClass* graphics;
 
-    result = m_Text->Render(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);
+    graphics = (GraphicsClass*)userData;
+
+    PROFILE_ZONE("Clear pass");
+
+    // Clear the buffers to begin the scene
+    graphics->m_Device->BeginScene(0.0f, 0.5f, 0.5f, 1.0f);
+
+    return true;
+}
+
+bool GraphicsClass::ScenePass(FrameGraphClass* frameGraph, int pass, void* userData)
+{
+    GraphicsClass* graphics;
+    RenderContextClass* deviceContext;
+    bool result;
+
+    graphics = (GraphicsClass*)userData;
+    deviceContext = graphics->m_Device->GetContext();
+
+    PROFILE_ZONE("Scene pass");
+
+    // Upload the view projection, camera and light once for the whole frame
+    {
+        PROFILE_ZONE("Frame constants");
+        result = graphics->m_LightShader->SetFrameParameters(deviceContext, graphics->m_viewMatrix, graphics->m_projectionMatrix,
+            graphics->m_Camera->GetPosition(), graphics->m_Light->GetDirection());
+    }
     if (!result)
         return false;
 
-    // After rending text
-    m_D3D->TurnOffAlphaBlending();
+    // Upload every visible model's constants up front so the workers only have to draw
+    result = false;
+    if (graphics->m_DeferredRecorder)
+    {
+        PROFILE_ZONE("Object constants");
+        result = graphics->m_LightShader->UploadObjects(deviceContext, graphics->m_renderCount, graphics->m_ModelList->GetTransforms(), graphics->m_visibleIndices,
+            graphics->m_visibleColors);
+    }
+
+    if (result)
+    {
+        // Record the visible models on the workers and execute them in draw order
+        result = graphics->m_ParallelRecord->Record(graphics->m_DeferredRecorder, graphics->m_renderCount);
+        if (!result)
+            return false;
+    }
+    else
+    {
+        // Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing
+        graphics->m_Model->Render(deviceContext);
+
+        // Render every visible model using the light shader
+        result = graphics->m_LightShader->Render(deviceContext, graphics->m_Model->GetIndexCount(), graphics->m_renderCount,
+            graphics->m_ModelList->GetTransforms(), graphics->m_visibleIndices, graphics->m_visibleColors, graphics->m_Model->GetTexture());
+        if (!result)
+            return false;
+    }
+
+    return true;
+}
+
+bool GraphicsClass::TextPass(FrameGraphClass* frameGraph, int pass, void* userData)
+{
+    GraphicsClass* graphics;
+    RenderContextClass* deviceContext;
+    TextureStreamStatsType streamStats;
+    bool result;
+
+    graphics = (GraphicsClass*)userData;
+    deviceContext = graphics->m_Device->GetContext();
+
+    PROFILE_ZONE("Text pass");
+
+    // Set the number of models that was actually rendered this frame, unchanged text isn't rebuilt
+    {
+        PROFILE_ZONE("Text rebuild");
+        result = graphics->m_Text->SetRenderCount(graphics->m_renderCount);
+        if (result)
+        {
+            // Set the constant buffer bytes mapped this frame
+            result = graphics->m_Text->SetBytesMapped(graphics->m_LightShader->GetBytesMapped());
+        }
+        if (result)
+        {
+            // Set the streamed texture bytes held against what the visible models asked for
+            streamStats = graphics->m_TextureStreamer->GetStats();
+            result = graphics->m_Text->SetTextureBytes(streamStats.residentBytes, streamStats.requestedBytes);
+        }
+    }
+    if (!result)
+        return false;
+
+    // Every sentence in one draw, the font shader's pipeline state turns depth off and blending on
+    result = graphics->m_Text->Render(deviceContext, graphics->m_worldMatrix, graphics->m_orthoMatrix);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+RenderStatsType GraphicsClass::GetRenderStats()
+{
+    return m_renderStats;
+}
+
+int GraphicsClass::GetModelCount()
+{
+    return m_ModelList->GetModelCount();
+}
+
+int GraphicsClass::GetVisibleCount()
+{
+    return m_renderCount;
+}
+
+TextureStreamStatsType GraphicsClass::GetTextureStreamStats()
+{
+    return m_TextureStreamer->GetStats();
+}
+
+// Called on a worker thread with its own deferred context
+bool GraphicsClass::RecordObjectRange(RenderContextClass* deviceContext, int first, int last, void* userData)
+{
+    GraphicsClass* graphics;
+
+    graphics = (GraphicsClass*)userData;
+
+    // Deferred contexts start empty so bind the render target and states first
+    deviceContext->SetBackBuffer();
 
-    // After 2D rendering is completed
-    m_D3D->TurnZBufferOn();
+    // Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing
+    graphics->m_Model->Render(deviceContext);
 
-    m_D3D->EndScene();
+    // Draw this worker's share of the uploaded models
+    graphics->m_LightShader->RenderObjects(deviceContext, graphics->m_Model->GetIndexCount(), first, last, graphics->m_Model->GetTexture());
 
     return true;
 }
\ No newline at end of file
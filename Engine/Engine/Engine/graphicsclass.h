@@ -1,17 +1,41 @@
 #pragma once
+#include "platform.h"
+#ifdef _WIN32
 #include "d3dclass.h"
+#endif
+#include "nullrenderdeviceclass.h"
+#include "softwarerenderdeviceclass.h"
 #include "cameraclass.h"
 #include "modelclass.h"
+#include "texturestreamerclass.h"
 #include "lightshaderclass.h"
 #include "lightclass.h"
 #include "textclass.h"
 #include "modellistclass.h"
 #include "frustumclass.h"
+#include "parallelrecordclass.h"
+#include "deferredrecorderclass.h"
+#include "framegraphclass.h"
+#include "rendertargetpoolclass.h"
+#include "profilerclass.h"
+#include "framestatsclass.h"
 
 const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.1f;
+const int RECORD_WORKER_COUNT = 4;
+const bool NULL_RENDER_DEVICE = false;
+const bool SOFTWARE_RENDER_DEVICE = false;
+const int SOFTWARE_RENDER_THREADS = 0;
+const unsigned int TEXTURE_STREAM_BUDGET = TEXTURE_STREAM_DEFAULT_BUDGET;
+
+enum GraphicsDeviceType
+{
+    GRAPHICS_DEVICE_D3D,
+    GRAPHICS_DEVICE_NULL,
+    GRAPHICS_DEVICE_SOFTWARE
+};
 
 class GraphicsClass
 {
@@ -20,18 +44,54 @@ public:
 	GraphicsClass(const GraphicsClass&);
 	~GraphicsClass();
 
-	bool Initialize(int, int, HWND);
+	bool Initialize(int, int, HWND, unsigned int);
+    bool Initialize(int, int, HWND, GraphicsDeviceType, bool, unsigned int);
 	void Shutdown();
     bool Frame(float);
+    bool Frame(Vector3Type, Vector3Type);
     bool Render();
 
+    RenderStatsType GetRenderStats();
+    int GetModelCount();
+    int GetVisibleCount();
+    TextureStreamStatsType GetTextureStreamStats();
+    void SetFrameStats(FrameStatsClass*);
+    void SetLatencyTag(const InputLatencyTagType&);
+
+private:
+    void CullModels();
+    void AddPhaseTime(int, long long);
+    bool BuildFrameGraph();
+    static bool RecordObjectRange(RenderContextClass*, int, int, void*);
+    static bool ClearPass(FrameGraphClass*, int, void*);
+    static bool ScenePass(FrameGraphClass*, int, void*);
+    static bool TextPass(FrameGraphClass*, int, void*);
+
 private:
-	D3DClass* m_D3D;
+	RenderDeviceClass* m_Device;
+    SoftwareRenderDeviceClass* m_SoftwareDevice;
     CameraClass* m_Camera;
+    TextureStreamerClass* m_TextureStreamer;
     ModelClass* m_Model;
 	LightShaderClass* m_LightShader;
 	LightClass* m_Light;
     TextClass* m_Text;
     ModelListClass* m_ModelList;
     FrustumClass* m_Frustum;
+
+    int* m_visibleIndices;
+    Vector4Type* m_visibleColors;
+
+    ParallelRecordClass* m_ParallelRecord;
+    DeferredRecorderClass* m_DeferredRecorder;
+
+    FrameGraphClass* m_FrameGraph;
+    RenderTargetPoolClass* m_RenderTargets;
+    FrameStatsClass* m_FrameStats;
+    unsigned int m_presentedEventId;
+
+    MatrixType m_worldMatrix, m_viewMatrix, m_projectionMatrix, m_orthoMatrix;
+    int m_screenHeight;
+    int m_renderCount;
+    RenderStatsType m_renderStats;
 };
\ No newline at end of file
@@ -5,6 +5,10 @@ InputClass::InputClass()
     m_directInput = 0;
     m_keyboard = 0;
     m_mouse = 0;
+    m_quitEvent = 0;
+    m_keyboardEvent = 0;
+    m_mouseEvent = 0;
+    m_seed = 0;
 }
 
 InputClass::InputClass(const InputClass& other)
@@ -12,12 +16,15 @@ InputClass::InputClass(const InputClass& other)
 
 }
 
+// A still running input thread would take the process down with it
 InputClass::~InputClass()
 {
-
+    Shutdown();
 }
 
-bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeight)
+// Either file can be null or empty. With a replay file the devices only watch for escape.
+// The seed places the scene, it is saved with a recording and a replay swaps in the recorded one.
+bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeight, char* recordFile, char* replayFile, unsigned int seed)
 {
     HRESULT result;
 
@@ -26,30 +33,53 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
 
     m_mouseX = 0;
     m_mouseY = 0;
+    m_frameTime = 0.0f;
+    m_replayFinished = false;
+
+    memset(m_keyboardState, 0, sizeof(m_keyboardState));
+    memset(m_keyTags, 0, sizeof(m_keyTags));
+    memset(&m_mouseState, 0, sizeof(m_mouseState));
+    memset(m_deviceKeys, 0, sizeof(m_deviceKeys));
+    memset(m_deviceButtons, 0, sizeof(m_deviceButtons));
+    m_nextEventId = 1;
+    m_replayEventId = 1;
+    m_seed = seed;
+
+    if (!m_queue.Initialize(INPUT_QUEUE_DEFAULT_CAPACITY))
+        return false;
+
+    if (replayFile && replayFile[0])
+    {
+        if (!m_replay.BeginReplay(replayFile))
+            return false;
+
+        m_seed = m_replay.GetSeed();
+    }
+
+    if (recordFile && recordFile[0])
+    {
+        if (!m_record.BeginRecording(recordFile, m_seed))
+            return false;
+    }
 
     // Init main direct input interface
     result = DirectInput8Create(hinstance, DIRECTINPUT_VERSION, IID_IDirectInput8, (void**)&m_directInput, NULL);
     if (FAILED(result))
         return false;
 
-    // Init direct input interface for keyboard
-    result = m_directInput->CreateDevice(GUID_SysKeyboard, &m_keyboard, NULL);
-    if (FAILED(result))
+    // Auto reset events the devices signal when they have data, and one to stop the thread
+    m_quitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    m_keyboardEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    m_mouseEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!m_quitEvent || !m_keyboardEvent || !m_mouseEvent)
         return false;
 
-    // Set data format
-    result = m_keyboard->SetDataFormat(&c_dfDIKeyboard);
-    if (FAILED(result))
-        return false;
-
-    // Set cooperative level of keyboard to share with other programs
-    result = m_keyboard->SetCooperativeLevel(hwnd, DISCL_FOREGROUND | DISCL_NONEXCLUSIVE);
+    // Init direct input interface for keyboard
+    result = m_directInput->CreateDevice(GUID_SysKeyboard, &m_keyboard, NULL);
     if (FAILED(result))
         return false;
 
-    // Acquire keyboard
-    result = m_keyboard->Acquire();
-    if (FAILED(result))
+    if (!InitializeDevice(m_keyboard, &c_dfDIKeyboard, hwnd, m_keyboardEvent))
         return false;
 
     // Init direct input interface for mouse
@@ -57,29 +87,30 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
     if (FAILED(result))
         return false;
 
-    // Set data format for mouse
-    result = m_mouse->SetDataFormat(&c_dfDIMouse);
-    if (FAILED(result))
+    if (!InitializeDevice(m_mouse, &c_dfDIMouse, hwnd, m_mouseEvent))
         return false;
 
-    // Set coop level of mouse to sahre with other programs
-    result = m_mouse->SetCooperativeLevel(hwnd, DISCL_FOREGROUND | DISCL_NONEXCLUSIVE);
-    if (FAILED(result))
-        return false;
+    // Recorded and replayed times count from here
+    m_startTime = FrameStatsClass::GetNanoseconds();
 
-    // Acquire mouse
-    result = m_mouse->Acquire();
-    if (FAILED(result))
-        return false;
+    m_thread = std::thread(&InputClass::InputThread, this);
 
     return true;
 }
 
 void InputClass::Shutdown()
 {
+    // The thread uses the devices so it goes first
+    if (m_thread.joinable())
+    {
+        SetEvent(m_quitEvent);
+        m_thread.join();
+    }
+
     if (m_mouse)
     {
         m_mouse->Unacquire();
+        m_mouse->SetEventNotification(NULL);
         m_mouse->Release();
         m_mouse = 0;
     }
@@ -87,6 +118,7 @@ void InputClass::Shutdown()
     if (m_keyboard)
     {
         m_keyboard->Unacquire();
+        m_keyboard->SetEventNotification(NULL);
         m_keyboard->Release();
         m_keyboard = 0;
     }
@@ -97,70 +129,318 @@ void InputClass::Shutdown()
         m_directInput = 0;
     }
 
+    if (m_mouseEvent)
+    {
+        CloseHandle(m_mouseEvent);
+        m_mouseEvent = 0;
+    }
+
+    if (m_keyboardEvent)
+    {
+        CloseHandle(m_keyboardEvent);
+        m_keyboardEvent = 0;
+    }
+
+    if (m_quitEvent)
+    {
+        CloseHandle(m_quitEvent);
+        m_quitEvent = 0;
+    }
+
+    m_record.Shutdown();
+    m_replay.Shutdown();
+    m_queue.Shutdown();
+
     return;
 }
 
-bool InputClass::Frame()
+// The frame time is the timer's, a replay swaps in the one it was recorded with
+bool InputClass::Frame(float frameTime)
+{
+    const InputEventType* events;
+    InputEventType event;
+    int count, i;
+
+    // Motion is only what arrived since the last frame, buttons and keys hold their state
+    m_mouseState.lX = 0;
+    m_mouseState.lY = 0;
+    m_mouseState.lZ = 0;
+
+    if (m_replay.IsReplaying())
+    {
+        // Live input can only stop the replay
+        while (m_queue.Pop(event))
+        {
+            if ((event.kind == INPUT_EVENT_KEY) && (event.code == DIK_ESCAPE) && event.value)
+                m_replayFinished = true;
+        }
+
+        if (!m_replay.ReadFrame(events, count, m_frameTime))
+        {
+            m_replayFinished = true;
+            count = 0;
+        }
+
+        // Replayed events are new input to this run, their latency counts from now
+        for (i = 0; i < count; i++)
+        {
+            event = events[i];
+            event.time = FrameStatsClass::GetNanoseconds();
+            event.id = m_replayEventId++;
+            ApplyEvent(event);
+        }
+    }
+    else
+    {
+        while (m_queue.Pop(event))
+            ApplyEvent(event);
+
+        m_frameTime = frameTime;
+    }
+
+    // Close the frame so a replay reads back the same events in the same frame
+    if (m_record.IsRecording())
+    {
+        event.time = FrameStatsClass::GetNanoseconds() - m_startTime;
+        event.kind = INPUT_EVENT_FRAME;
+        event.code = 0;
+        event.id = 0;
+        memcpy(&event.value, &m_frameTime, sizeof(event.value));
+        if (!m_record.WriteEvent(event))
+            return false;
+    }
+
+    ProcessInput();
+
+    return true;
+}
+
+// Buffered data has to be asked for before the device is acquired
+bool InputClass::InitializeDevice(IDirectInputDevice8* device, LPCDIDATAFORMAT format, HWND hwnd, HANDLE notifyEvent)
 {
-    bool result;
+    DIPROPDWORD property;
+    HRESULT result;
 
-    result = ReadKeyboard();
-    if (!result)
+    // Set data format
+    result = device->SetDataFormat(format);
+    if (FAILED(result))
         return false;
 
-    result = ReadMouse();
-    if (!result)
+    // Set cooperative level to share the device with other programs
+    result = device->SetCooperativeLevel(hwnd, DISCL_FOREGROUND | DISCL_NONEXCLUSIVE);
+    if (FAILED(result))
         return false;
 
-    ProcessInput();
+    property.diph.dwSize = sizeof(DIPROPDWORD);
+    property.diph.dwHeaderSize = sizeof(DIPROPHEADER);
+    property.diph.dwObj = 0;
+    property.diph.dwHow = DIPH_DEVICE;
+    property.dwData = INPUT_DEVICE_BUFFER_SIZE;
+    result = device->SetProperty(DIPROP_BUFFERSIZE, &property.diph);
+    if (FAILED(result))
+        return false;
+
+    result = device->SetEventNotification(notifyEvent);
+    if (FAILED(result))
+        return false;
+
+    // Not having focus yet isn't an error, the thread acquires it later
+    device->Acquire();
 
     return true;
 }
 
+// Wakes when a device has data. The timeout keeps retrying a device that lost focus.
+void InputClass::InputThread()
+{
+    HANDLE events[3];
+    DWORD result;
+
+    events[0] = m_quitEvent;
+    events[1] = m_keyboardEvent;
+    events[2] = m_mouseEvent;
+
+    while (true)
+    {
+        result = WaitForMultipleObjects(3, events, FALSE, INPUT_WAIT_MILLISECONDS);
+        if ((result == WAIT_OBJECT_0) || (result == WAIT_FAILED))
+            break;
+
+        ReadKeyboard();
+        ReadMouse();
+    }
+
+    return;
+}
+
 bool InputClass::ReadKeyboard()
 {
+    DIDEVICEOBJECTDATA data[INPUT_READ_BATCH];
+    DWORD count, i;
     HRESULT result;
 
-    // Read keyboard device
-    result = m_keyboard->GetDeviceState(sizeof(m_keyboardState), (LPVOID)&m_keyboardState);
-    if (FAILED(result))
+    do
     {
-        // If keyboard lost focus or was not acquired
-        if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+        count = INPUT_READ_BATCH;
+        result = m_keyboard->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data, &count, 0);
+        if (FAILED(result))
         {
-            m_keyboard->Acquire();
+            // If keyboard lost focus or was not acquired
+            if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+            {
+                Reacquire(m_keyboard, true);
+                return true;
+            }
+
+            return false;
         }
-        else
+
+        for (i = 0; i < count; i++)
         {
-            return false;
+            m_deviceKeys[data[i].dwOfs & 0xff] = (unsigned char)(data[i].dwData & 0x80);
+            PushEvent(INPUT_EVENT_KEY, (unsigned short)(data[i].dwOfs & 0xff), (data[i].dwData & 0x80) ? 1 : 0);
         }
-    }
+    } while (count == INPUT_READ_BATCH);
 
     return true;
 }
 
 bool InputClass::ReadMouse()
 {
+    DIDEVICEOBJECTDATA data[INPUT_READ_BATCH];
+    DWORD count, i, offset;
     HRESULT result;
 
-    // Read mouse device
-    result = m_mouse->GetDeviceState(sizeof(DIMOUSESTATE), (LPVOID)&m_mouseState);
-    if (FAILED(result))
+    do
     {
-        // If mouse lost focuse or was not acquired
-        if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+        count = INPUT_READ_BATCH;
+        result = m_mouse->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data, &count, 0);
+        if (FAILED(result))
         {
-            m_mouse->Acquire();
+            // If mouse lost focus or was not acquired
+            if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+            {
+                Reacquire(m_mouse, false);
+                return true;
+            }
+
+            return false;
         }
-        else
+
+        for (i = 0; i < count; i++)
         {
-            return false;
+            offset = data[i].dwOfs;
+            if ((offset == DIMOFS_X) || (offset == DIMOFS_Y) || (offset == DIMOFS_Z))
+            {
+                PushEvent(INPUT_EVENT_MOUSE_AXIS, (unsigned short)((offset - DIMOFS_X) / sizeof(LONG)), (int)data[i].dwData);
+            }
+            else if ((offset >= DIMOFS_BUTTON0) && (offset < DIMOFS_BUTTON0 + INPUT_MOUSE_BUTTONS))
+            {
+                m_deviceButtons[offset - DIMOFS_BUTTON0] = (unsigned char)(data[i].dwData & 0x80);
+                PushEvent(INPUT_EVENT_MOUSE_BUTTON, (unsigned short)(offset - DIMOFS_BUTTON0), (data[i].dwData & 0x80) ? 1 : 0);
+            }
         }
-    }
+    } while (count == INPUT_READ_BATCH);
 
     return true;
 }
 
+// Changes made while the device was lost never arrive as data, so once it is
+// back its state is compared with what the frame was last told and the
+// difference is sent as events. Otherwise a key let go elsewhere stays down.
+void InputClass::Reacquire(IDirectInputDevice8* device, bool keyboard)
+{
+    unsigned char keys[256];
+    DIMOUSESTATE mouse;
+    int i;
+
+    if (FAILED(device->Acquire()))
+        return;
+
+    if (keyboard)
+    {
+        if (FAILED(device->GetDeviceState(sizeof(keys), keys)))
+            return;
+
+        for (i = 0; i < 256; i++)
+        {
+            if ((keys[i] & 0x80) != m_deviceKeys[i])
+            {
+                m_deviceKeys[i] = keys[i] & 0x80;
+                PushEvent(INPUT_EVENT_KEY, (unsigned short)i, m_deviceKeys[i] ? 1 : 0);
+            }
+        }
+    }
+    else
+    {
+        if (FAILED(device->GetDeviceState(sizeof(mouse), &mouse)))
+            return;
+
+        for (i = 0; i < INPUT_MOUSE_BUTTONS; i++)
+        {
+            if ((mouse.rgbButtons[i] & 0x80) != m_deviceButtons[i])
+            {
+                m_deviceButtons[i] = mouse.rgbButtons[i] & 0x80;
+                PushEvent(INPUT_EVENT_MOUSE_BUTTON, (unsigned short)i, m_deviceButtons[i] ? 1 : 0);
+            }
+        }
+    }
+
+    return;
+}
+
+// Stamped when it is read, which is as close to when it happened as the thread gets
+void InputClass::PushEvent(unsigned short kind, unsigned short code, int value)
+{
+    InputEventType event;
+
+    event.time = FrameStatsClass::GetNanoseconds();
+    event.kind = kind;
+    event.code = code;
+    event.value = value;
+    event.id = m_nextEventId++;
+    m_queue.Push(event);
+
+    return;
+}
+
+void InputClass::ApplyEvent(const InputEventType& event)
+{
+    InputEventType recorded;
+
+    switch (event.kind)
+    {
+    case INPUT_EVENT_KEY:
+        m_keyboardState[event.code & 0xff] = event.value ? 0x80 : 0;
+        m_keyTags[event.code & 0xff].eventId = event.id;
+        m_keyTags[event.code & 0xff].inputTime = event.time;
+        break;
+
+    case INPUT_EVENT_MOUSE_AXIS:
+        if (event.code == 0)
+            m_mouseState.lX += event.value;
+        else if (event.code == 1)
+            m_mouseState.lY += event.value;
+        else
+            m_mouseState.lZ += event.value;
+        break;
+
+    case INPUT_EVENT_MOUSE_BUTTON:
+        if (event.code < INPUT_MOUSE_BUTTONS)
+            m_mouseState.rgbButtons[event.code] = event.value ? 0x80 : 0;
+        break;
+    }
+
+    if (m_record.IsRecording())
+    {
+        recorded = event;
+        recorded.time -= m_startTime;
+        m_record.WriteEvent(recorded);
+    }
+
+    return;
+}
+
 void InputClass::ProcessInput()
 {
     // Update location of mouse cursor based on change of mouse location during frame
@@ -212,10 +492,38 @@ bool InputClass::IsRightArrowPressed()
     return false;
 }
 
+// True once a replay has run out of recorded frames or was stopped with escape
+unsigned int InputClass::GetSeed()
+{
+    return m_seed;
+}
+
+bool InputClass::IsReplayFinished()
+{
+    return m_replayFinished;
+}
+
+// The event that last pressed or released a key, to pass along with what the key changes
+InputLatencyTagType InputClass::GetKeyTag(int key)
+{
+    return m_keyTags[key & 0xff];
+}
+
 void InputClass::GetMouseLocation(int& mouseX, int& mouseY)
 {
     mouseX = m_mouseX;
     mouseY = m_mouseY;
 
     return;
+}
+
+float InputClass::GetFrameTime()
+{
+    return m_frameTime;
+}
+
+// Events lost because the frame fell too far behind the devices
+unsigned int InputClass::GetDroppedEvents()
+{
+    return m_queue.GetDroppedCount();
 }
\ No newline at end of file
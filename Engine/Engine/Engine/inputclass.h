@@ -6,7 +6,24 @@
 #pragma comment(lib, "dxguid.lib")
 
 #include <dinput.h>
+#include <thread>
+#include <string.h>
+#include "inputqueueclass.h"
+#include "inputrecordingclass.h"
+#include "framestatsclass.h"
 
+const int INPUT_MAX_PATH = 260;
+const int INPUT_DEVICE_BUFFER_SIZE = 256;
+const int INPUT_READ_BATCH = 64;
+const int INPUT_MOUSE_BUTTONS = 4;
+const DWORD INPUT_WAIT_MILLISECONDS = 100;
+
+// Input is read as buffered device data on its own thread, so every key and
+// button change between frames is kept in order with the time it was read
+// instead of only the state at the moment the frame polls. Each frame takes
+// what has arrived off the queue. A session can be recorded to a file, and a
+// recorded session replayed in place of the devices with the frame times it
+// was recorded with, so a run can be reproduced exactly.
 class InputClass
 {
 public:
@@ -14,19 +31,30 @@ public:
 	InputClass(const InputClass&);
 	~InputClass();
 
-    bool Initialize(HINSTANCE, HWND, int, int);
+    bool Initialize(HINSTANCE, HWND, int, int, char*, char*, unsigned int);
     void Shutdown();
-    bool Frame();
+    bool Frame(float);
 
     bool IsEscapePressed();
     bool IsLeftArrowPressed();
     bool IsRightArrowPressed();
+    bool IsReplayFinished();
+
+    InputLatencyTagType GetKeyTag(int);
 
     void GetMouseLocation(int&, int&);
+    float GetFrameTime();
+    unsigned int GetDroppedEvents();
+    unsigned int GetSeed();
 
 private:
+    bool InitializeDevice(IDirectInputDevice8*, LPCDIDATAFORMAT, HWND, HANDLE);
+    void InputThread();
     bool ReadKeyboard();
     bool ReadMouse();
+    void Reacquire(IDirectInputDevice8*, bool);
+    void PushEvent(unsigned short, unsigned short, int);
+    void ApplyEvent(const InputEventType&);
     void ProcessInput();
 
 private:
@@ -35,8 +63,24 @@ private:
     IDirectInputDevice8* m_mouse;
 
     unsigned char m_keyboardState[256];
+    InputLatencyTagType m_keyTags[256];
     DIMOUSESTATE m_mouseState;
 
     int m_screenWidth, m_screenHeight;
     int m_mouseX, m_mouseY;
+    float m_frameTime;
+
+    // Owned by the input thread, what it has told the frame the devices hold
+    std::thread m_thread;
+    HANDLE m_quitEvent, m_keyboardEvent, m_mouseEvent;
+    unsigned char m_deviceKeys[256];
+    unsigned char m_deviceButtons[INPUT_MOUSE_BUTTONS];
+    unsigned int m_nextEventId;
+
+    InputQueueClass m_queue;
+    InputRecordingClass m_record, m_replay;
+    long long m_startTime;
+    unsigned int m_replayEventId;
+    bool m_replayFinished;
+    unsigned int m_seed;
 };
\ No newline at end of file
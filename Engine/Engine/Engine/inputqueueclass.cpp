@@ -0,0 +1,91 @@
+#include "inputqueueclass.h"
+
+InputQueueClass::InputQueueClass()
+{
+    m_events = 0;
+    m_mask = 0;
+    m_head = 0;
+    m_tail = 0;
+    m_dropped = 0;
+}
+
+InputQueueClass::InputQueueClass(const InputQueueClass& other)
+{
+
+}
+
+InputQueueClass::~InputQueueClass()
+{
+
+}
+
+// The capacity has to be a power of two so the indices can wrap with a mask
+bool InputQueueClass::Initialize(int capacity)
+{
+    if ((capacity <= 0) || (capacity & (capacity - 1)))
+        return false;
+
+    m_events = new InputEventType[capacity];
+    if (!m_events)
+        return false;
+
+    m_mask = capacity - 1;
+    m_head = 0;
+    m_tail = 0;
+    m_dropped = 0;
+
+    return true;
+}
+
+void InputQueueClass::Shutdown()
+{
+    if (m_events)
+    {
+        delete[] m_events;
+        m_events = 0;
+    }
+
+    return;
+}
+
+// Writer side only
+bool InputQueueClass::Push(const InputEventType& event)
+{
+    unsigned int head, tail;
+
+    head = m_head.load(std::memory_order_relaxed);
+    tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail > m_mask)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // The event is written before the reader can see the new head
+    m_events[head & m_mask] = event;
+    m_head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+// Reader side only
+bool InputQueueClass::Pop(InputEventType& event)
+{
+    unsigned int head, tail;
+
+    tail = m_tail.load(std::memory_order_relaxed);
+    head = m_head.load(std::memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    // The slot is read before the writer is allowed to reuse it
+    event = m_events[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+unsigned int InputQueueClass::GetDroppedCount()
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+
+const int INPUT_QUEUE_DEFAULT_CAPACITY = 1024;
+
+enum InputEventKind
+{
+    INPUT_EVENT_KEY,
+    INPUT_EVENT_MOUSE_AXIS,
+    INPUT_EVENT_MOUSE_BUTTON,
+    INPUT_EVENT_FRAME
+};
+
+// One change of one key, axis or button. Keys use the DirectInput scan code and
+// a value of 1 down, 0 up. Axes are 0 x, 1 y, 2 wheel with the relative motion
+// as the value. A frame event closes the events one frame read, its value holds
+// the bits of the frame time so a replay moves exactly as the recording did.
+// Times are in nanoseconds. The id is given when the event is read from the
+// device, counting up from 1, so its latency can be followed to the screen.
+struct InputEventType
+{
+    long long time;
+    unsigned short kind;
+    unsigned short code;
+    int value;
+    unsigned int id;
+};
+
+// The input a piece of state last changed for, passed along with the state
+// from InputClass through PositionClass and CameraClass to the present. An
+// id of 0 means no input.
+struct InputLatencyTagType
+{
+    unsigned int eventId;
+    long long inputTime;
+};
+
+// Hands events from the thread that reads the devices to the frame without a
+// lock. There is only one writer and one reader, each owns one end of the ring.
+// A full ring drops the newest event and counts it rather than block the reader.
+class InputQueueClass
+{
+public:
+    InputQueueClass();
+    InputQueueClass(const InputQueueClass&);
+    ~InputQueueClass();
+
+    bool Initialize(int);
+    void Shutdown();
+
+    bool Push(const InputEventType&);
+    bool Pop(InputEventType&);
+
+    unsigned int GetDroppedCount();
+
+private:
+    InputEventType* m_events;
+    unsigned int m_mask;
+    std::atomic<unsigned int> m_head;
+    std::atomic<unsigned int> m_tail;
+    std::atomic<unsigned int> m_dropped;
+};
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "inputrecordingclass.h"
+
+const char INPUT_RECORDING_MAGIC[4] = { 'I', 'N', 'R', '2' };
+const int INPUT_RECORDING_INITIAL_EVENTS = 1024;
+
+// Small negative numbers have to stay short too, times can step back between frames
+static unsigned long long ZigZag(long long value)
+{
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+static long long UnZigZag(unsigned long long value)
+{
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+InputRecordingClass::InputRecordingClass()
+{
+    m_recording = false;
+    m_replaying = false;
+    m_lastTime = 0;
+    m_seed = 0;
+    m_events = 0;
+    m_eventCount = 0;
+    m_eventCapacity = 0;
+    m_readIndex = 0;
+    m_frameCount = 0;
+}
+
+InputRecordingClass::InputRecordingClass(const InputRecordingClass& other)
+{
+
+}
+
+InputRecordingClass::~InputRecordingClass()
+{
+
+}
+
+// The seed goes in the header so a replay can place the same scene
+bool InputRecordingClass::BeginRecording(char* filename, unsigned int seed)
+{
+    m_file.open(filename, ios::out | ios::binary);
+    if (m_file.fail())
+        return false;
+
+    m_file.write(INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+    m_file.write((const char*)&seed, sizeof(seed));
+    if (m_file.fail())
+        return false;
+
+    m_seed = seed;
+    m_recording = true;
+    m_lastTime = 0;
+    m_frameCount = 0;
+    m_eventCount = 0;
+
+    return true;
+}
+
+// Reads and decodes the whole session up front so a replayed frame never waits on the disk
+bool InputRecordingClass::BeginReplay(char* filename)
+{
+    ifstream fin;
+    unsigned char* data;
+    const unsigned char* read;
+    const unsigned char* end;
+    unsigned long long code, time, value;
+    InputEventType event;
+    long long size, lastTime;
+    bool result;
+
+    fin.open(filename, ios::in | ios::binary);
+    if (fin.fail())
+        return false;
+
+    fin.seekg(0, ios::end);
+    size = (long long)fin.tellg();
+    fin.seekg(0, ios::beg);
+    if (size < (long long)(sizeof(INPUT_RECORDING_MAGIC) + sizeof(m_seed)))
+        return false;
+
+    data = new unsigned char[(size_t)size];
+    if (!data)
+        return false;
+
+    fin.read((char*)data, size);
+    if (fin.fail() || (memcmp(data, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC)) != 0))
+    {
+        delete[] data;
+        return false;
+    }
+
+    m_eventCount = 0;
+    m_frameCount = 0;
+    m_readIndex = 0;
+    lastTime = 0;
+    result = true;
+
+    memcpy(&m_seed, data + sizeof(INPUT_RECORDING_MAGIC), sizeof(m_seed));
+
+    read = data + sizeof(INPUT_RECORDING_MAGIC) + sizeof(m_seed);
+    end = data + size;
+    while (result && (read < end))
+    {
+        event.kind = *read++;
+        result = (event.kind <= INPUT_EVENT_FRAME) && ReadNumber(read, end, code) && ReadNumber(read, end, time) && ReadNumber(read, end, value);
+        if (!result)
+            break;
+
+        lastTime += UnZigZag(time);
+        event.time = lastTime;
+        event.code = (unsigned short)code;
+        event.value = (int)UnZigZag(value);
+        event.id = 0;
+
+        result = AddEvent(event);
+        if (event.kind == INPUT_EVENT_FRAME)
+            m_frameCount++;
+    }
+
+    delete[] data;
+    data = 0;
+
+    m_replaying = result;
+
+    return result;
+}
+
+void InputRecordingClass::Shutdown()
+{
+    if (m_recording)
+    {
+        m_file.close();
+        m_recording = false;
+    }
+
+    if (m_events)
+    {
+        delete[] m_events;
+        m_events = 0;
+    }
+
+    m_eventCount = 0;
+    m_eventCapacity = 0;
+    m_replaying = false;
+
+    return;
+}
+
+bool InputRecordingClass::IsRecording()
+{
+    return m_recording;
+}
+
+bool InputRecordingClass::IsReplaying()
+{
+    return m_replaying;
+}
+
+// Written as the frame reads them, the stream buffers so this doesn't touch the disk every event
+bool InputRecordingClass::WriteEvent(const InputEventType& event)
+{
+    if (!m_recording)
+        return false;
+
+    m_file.put((char)event.kind);
+    WriteNumber(event.code);
+    WriteNumber(ZigZag(event.time - m_lastTime));
+    WriteNumber(ZigZag(event.value));
+    m_lastTime = event.time;
+
+    m_eventCount++;
+    if (event.kind == INPUT_EVENT_FRAME)
+        m_frameCount++;
+
+    return !m_file.fail();
+}
+
+// Returns the events of the next recorded frame and the frame time it ran with,
+// false once the session is over. The events stay valid until Shutdown.
+bool InputRecordingClass::ReadFrame(const InputEventType*& events, int& count, float& frameTime)
+{
+    int first;
+
+    first = m_readIndex;
+    while ((m_readIndex < m_eventCount) && (m_events[m_readIndex].kind != INPUT_EVENT_FRAME))
+        m_readIndex++;
+
+    // Events after the last frame event were never read by a frame
+    if (!m_replaying || (m_readIndex >= m_eventCount))
+        return false;
+
+    events = m_events + first;
+    count = m_readIndex - first;
+    memcpy(&frameTime, &m_events[m_readIndex].value, sizeof(frameTime));
+    m_readIndex++;
+
+    return true;
+}
+
+int InputRecordingClass::GetFrameCount()
+{
+    return m_frameCount;
+}
+
+int InputRecordingClass::GetEventCount()
+{
+    return m_eventCount;
+}
+
+// Seven bits a byte, low first, the top bit set on every byte but the last
+void InputRecordingClass::WriteNumber(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        m_file.put((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    m_file.put((char)value);
+
+    return;
+}
+
+bool InputRecordingClass::ReadNumber(const unsigned char*& read, const unsigned char* end, unsigned long long& value)
+{
+    int shift;
+
+    value = 0;
+    for (shift = 0; shift < 64; shift += 7)
+    {
+        if (read >= end)
+            return false;
+
+        value |= (unsigned long long)(*read & 0x7f) << shift;
+        if (!(*read++ & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+bool InputRecordingClass::AddEvent(const InputEventType& event)
+{
+    InputEventType* events;
+
+    if (m_eventCount == m_eventCapacity)
+    {
+        events = new InputEventType[m_eventCapacity ? m_eventCapacity * 2 : INPUT_RECORDING_INITIAL_EVENTS];
+        if (!events)
+            return false;
+
+        if (m_events)
+        {
+            memcpy(events, m_events, m_eventCount * sizeof(InputEventType));
+            delete[] m_events;
+        }
+
+        m_events = events;
+        m_eventCapacity = m_eventCapacity ? m_eventCapacity * 2 : INPUT_RECORDING_INITIAL_EVENTS;
+    }
+
+    m_events[m_eventCount++] = event;
+
+    return true;
+}
+
+unsigned int InputRecordingClass::GetSeed()
+{
+    return m_seed;
+}
\ No newline at end of file
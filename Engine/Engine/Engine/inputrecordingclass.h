@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string.h>
+#include <fstream>
+#include "inputqueueclass.h"
+using namespace std;
+
+// A session of input events saved to disk, or read back to replay. The file is
+// a magic and the seed the scene was placed with, then one record per event:
+// the kind as a byte, then the code, the time since the previous event and the
+// value as variable length integers, so most events take four or five bytes. Each frame ends with a frame event, and
+// a replay hands back exactly the events each recorded frame read.
+class InputRecordingClass
+{
+public:
+    InputRecordingClass();
+    InputRecordingClass(const InputRecordingClass&);
+    ~InputRecordingClass();
+
+    bool BeginRecording(char*, unsigned int);
+    bool BeginReplay(char*);
+    void Shutdown();
+
+    bool IsRecording();
+    bool IsReplaying();
+
+    bool WriteEvent(const InputEventType&);
+    bool ReadFrame(const InputEventType*&, int&, float&);
+
+    int GetFrameCount();
+    int GetEventCount();
+    unsigned int GetSeed();
+
+private:
+    void WriteNumber(unsigned long long);
+    bool ReadNumber(const unsigned char*&, const unsigned char*, unsigned long long&);
+    bool AddEvent(const InputEventType&);
+
+private:
+    ofstream m_file;
+    bool m_recording, m_replaying;
+    long long m_lastTime;
+    unsigned int m_seed;
+
+    InputEventType* m_events;
+    int m_eventCount, m_eventCapacity;
+    int m_readIndex;
+    int m_frameCount;
+};
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "instancetransformclass.h"
+#include <chrono>
+
+const int INSTANCE_BENCH_CAPACITY = 32768;
+const int INSTANCE_BENCH_STRIDE = 256;
+const int INSTANCE_BENCH_REPEATS = 20;
+const float INSTANCE_BENCH_TOLERANCE = 0.0001f;
+
+// One instance the way the batch does each lane, the same operations in the same order
+static void WriteInstance(const InstanceTransformsType& instances, int index, const MatrixType& viewProjection, float* out)
+{
+    float x, y, z, w, s, world[4][3], result;
+    int i, j;
+
+    x = instances.rotationX[index];
+    y = instances.rotationY[index];
+    z = instances.rotationZ[index];
+    w = instances.rotationW[index];
+    s = instances.scale[index];
+
+    world[0][0] = s * (1.0f - 2.0f * (y * y + z * z));
+    world[0][1] = s * (2.0f * (x * y + z * w));
+    world[0][2] = s * (2.0f * (x * z - y * w));
+    world[1][0] = s * (2.0f * (x * y - z * w));
+    world[1][1] = s * (1.0f - 2.0f * (x * x + z * z));
+    world[1][2] = s * (2.0f * (y * z + x * w));
+    world[2][0] = s * (2.0f * (x * z + y * w));
+    world[2][1] = s * (2.0f * (y * z - x * w));
+    world[2][2] = s * (1.0f - 2.0f * (x * x + y * y));
+    world[3][0] = instances.positionX[index];
+    world[3][1] = instances.positionY[index];
+    world[3][2] = instances.positionZ[index];
+
+    // Transposed world, row j holds column j
+    for (j = 0; j < 3; j++)
+    {
+        for (i = 0; i < 4; i++)
+            out[j * 4 + i] = world[i][j];
+    }
+    out[12] = 0.0f;
+    out[13] = 0.0f;
+    out[14] = 0.0f;
+    out[15] = 1.0f;
+
+    // The world's fourth column is 0, 0, 0, 1 so only the last row picks up the view projection's.
+    // Summed in pairs like the per-object multiply the shader used to do, so the same matrices come out
+    for (j = 0; j < 4; j++)
+    {
+        for (i = 0; i < 4; i++)
+        {
+            if (i == 3)
+                result = (world[i][0] * viewProjection.m[0][j] + world[i][1] * viewProjection.m[1][j]) + (world[i][2] * viewProjection.m[2][j] + viewProjection.m[3][j]);
+            else
+                result = (world[i][0] * viewProjection.m[0][j] + world[i][1] * viewProjection.m[1][j]) + world[i][2] * viewProjection.m[2][j];
+            out[16 + j * 4 + i] = result;
+        }
+    }
+
+    return;
+}
+
+#if MATH_SSE
+static inline __m128 Gather(const float* values, const int* lanes)
+{
+    return _mm_set_ps(values[lanes[3]], values[lanes[2]], values[lanes[1]], values[lanes[0]]);
+}
+
+// a, b, c and d hold one element for each of four instances, each instance gets its four in a row
+static inline void StoreRows(unsigned char* out, int stride, int offset, __m128 a, __m128 b, __m128 c, __m128 d, int laneCount)
+{
+    __m128 rows[4];
+    int k;
+
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    rows[0] = a;
+    rows[1] = b;
+    rows[2] = c;
+    rows[3] = d;
+
+    for (k = 0; k < laneCount; k++)
+        _mm_storeu_ps((float*)(out + k * stride + offset), rows[k]);
+
+    return;
+}
+#endif
+
+void InstanceTransformClass::WriteMatrices(const InstanceTransformsType& instances, const int* indices, int count, const MatrixType& viewProjection,
+    unsigned char* out, int stride)
+{
+#if MATH_SSE
+    __m128 viewProjectionWide[4][4], world[4][3], result[4];
+    __m128 x, y, z, w, s, one, two, zero;
+    int lanes[4], first, laneCount, i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < 4; j++)
+            viewProjectionWide[i][j] = _mm_set1_ps(viewProjection.m[i][j]);
+    }
+
+    one = _mm_set1_ps(1.0f);
+    two = _mm_set1_ps(2.0f);
+    zero = _mm_setzero_ps();
+
+    for (first = 0; first < count; first += 4)
+    {
+        // Past the end the last instance fills the lanes and isn't stored
+        laneCount = count - first;
+        if (laneCount > 4)
+            laneCount = 4;
+        for (i = 0; i < 4; i++)
+            lanes[i] = indices[first + ((i < laneCount) ? i : laneCount - 1)];
+
+        x = Gather(instances.rotationX, lanes);
+        y = Gather(instances.rotationY, lanes);
+        z = Gather(instances.rotationZ, lanes);
+        w = Gather(instances.rotationW, lanes);
+        s = Gather(instances.scale, lanes);
+
+        // The rotation's rows times the scale
+        world[0][0] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z)))));
+        world[0][1] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, y), _mm_mul_ps(z, w))));
+        world[0][2] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(x, z), _mm_mul_ps(y, w))));
+        world[1][0] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(x, y), _mm_mul_ps(z, w))));
+        world[1][1] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(z, z)))));
+        world[1][2] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(y, z), _mm_mul_ps(x, w))));
+        world[2][0] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, z), _mm_mul_ps(y, w))));
+        world[2][1] = _mm_mul_ps(s, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(y, z), _mm_mul_ps(x, w))));
+        world[2][2] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)))));
+        world[3][0] = Gather(instances.positionX, lanes);
+        world[3][1] = Gather(instances.positionY, lanes);
+        world[3][2] = Gather(instances.positionZ, lanes);
+
+        // Transposed world, row j holds column j
+        for (j = 0; j < 3; j++)
+            StoreRows(out + first * stride, stride, j * 16, world[0][j], world[1][j], world[2][j], world[3][j], laneCount);
+        StoreRows(out + first * stride, stride, 48, zero, zero, zero, one, laneCount);
+
+        // Transposed world view projection, a column of the product at a time
+        for (j = 0; j < 4; j++)
+        {
+            for (i = 0; i < 3; i++)
+            {
+                result[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(world[i][0], viewProjectionWide[0][j]), _mm_mul_ps(world[i][1], viewProjectionWide[1][j])),
+                    _mm_mul_ps(world[i][2], viewProjectionWide[2][j]));
+            }
+            result[3] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(world[3][0], viewProjectionWide[0][j]), _mm_mul_ps(world[3][1], viewProjectionWide[1][j])),
+                _mm_add_ps(_mm_mul_ps(world[3][2], viewProjectionWide[2][j]), viewProjectionWide[3][j]));
+
+            StoreRows(out + first * stride, stride, 64 + j * 16, result[0], result[1], result[2], result[3], laneCount);
+        }
+    }
+#else
+    int i;
+
+    for (i = 0; i < count; i++)
+        WriteInstance(instances, indices[i], viewProjection, (float*)(out + i * stride));
+#endif
+
+    return;
+}
+
+void InstanceTransformClass::WriteMatricesPerObject(const InstanceTransformsType& instances, const int* indices, int count, const MatrixType& viewProjection,
+    unsigned char* out, int stride)
+{
+    MatrixType scaling, rotation, translation, world, worldViewProjection;
+    QuaternionType quaternion;
+    int i, index;
+
+    for (i = 0; i < count; i++)
+    {
+        index = indices[i];
+
+        quaternion = QuaternionType(instances.rotationX[index], instances.rotationY[index], instances.rotationZ[index], instances.rotationW[index]);
+        MatrixScaling(&scaling, instances.scale[index], instances.scale[index], instances.scale[index]);
+        MatrixRotationQuaternion(&rotation, &quaternion);
+        MatrixTranslation(&translation, instances.positionX[index], instances.positionY[index], instances.positionZ[index]);
+
+        MatrixMultiply(&world, &scaling, &rotation);
+        MatrixMultiply(&world, &world, &translation);
+        MatrixMultiply(&worldViewProjection, &world, &viewProjection);
+
+        MatrixTranspose((MatrixType*)(out + i * stride), &world);
+        MatrixTranspose((MatrixType*)(out + i * stride + sizeof(MatrixType)), &worldViewProjection);
+    }
+
+    return;
+}
+
+static long long GetNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Repeatable values in [0, 1)
+static float RandomUnit(unsigned int& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (float)(seed >> 8) / 16777216.0f;
+}
+
+// Compares the matrices of every instance, exactly or relative to the larger value
+static bool CompareOutputs(const unsigned char* a, const unsigned char* b, int count, bool exact)
+{
+    const float* first;
+    const float* second;
+    float scale;
+    int i, j;
+
+    for (i = 0; i < count; i++)
+    {
+        first = (const float*)(a + i * INSTANCE_BENCH_STRIDE);
+        second = (const float*)(b + i * INSTANCE_BENCH_STRIDE);
+
+        if (exact)
+        {
+            if (memcmp(first, second, INSTANCE_MATRIX_BYTES) != 0)
+                return false;
+            continue;
+        }
+
+        for (j = 0; j < INSTANCE_MATRIX_BYTES / (int)sizeof(float); j++)
+        {
+            scale = fabsf(first[j]) > 1.0f ? fabsf(first[j]) : 1.0f;
+            if (fabsf(first[j] - second[j]) > INSTANCE_BENCH_TOLERANCE * scale)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Random instances, culled to about half, through both paths at a few visible
+// counts. The batch has to give the same bits as WriteInstance and agree with
+// the per-object path to rounding.
+bool InstanceTransformClass::RunBenchmark(char* filename)
+{
+    const int visibleCounts[3] = { 25, 1024, 16384 };
+    ofstream fout;
+    float* components;
+    int* indices;
+    unsigned char* perObject;
+    unsigned char* batch;
+    InstanceTransformsType instances;
+    QuaternionType rotation;
+    MatrixType view, projection, viewProjection;
+    Vector3Type eye, at, up;
+    long long start, elapsed, perObjectTime, batchTime;
+    unsigned int seed;
+    int visible, failures, i, j, repeat;
+    bool exact, close;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    components = new float[8 * INSTANCE_BENCH_CAPACITY];
+    if (!components)
+        return false;
+
+    indices = new int[INSTANCE_BENCH_CAPACITY];
+    if (!indices)
+        return false;
+
+    perObject = new unsigned char[INSTANCE_BENCH_CAPACITY * INSTANCE_BENCH_STRIDE];
+    if (!perObject)
+        return false;
+
+    batch = new unsigned char[INSTANCE_BENCH_CAPACITY * INSTANCE_BENCH_STRIDE];
+    if (!batch)
+        return false;
+
+    instances.positionX = components;
+    instances.positionY = components + INSTANCE_BENCH_CAPACITY;
+    instances.positionZ = components + 2 * INSTANCE_BENCH_CAPACITY;
+    instances.rotationX = components + 3 * INSTANCE_BENCH_CAPACITY;
+    instances.rotationY = components + 4 * INSTANCE_BENCH_CAPACITY;
+    instances.rotationZ = components + 5 * INSTANCE_BENCH_CAPACITY;
+    instances.rotationW = components + 6 * INSTANCE_BENCH_CAPACITY;
+    instances.scale = components + 7 * INSTANCE_BENCH_CAPACITY;
+
+    seed = 1;
+    for (i = 0; i < INSTANCE_BENCH_CAPACITY; i++)
+    {
+        components[i] = (RandomUnit(seed) - 0.5f) * 200.0f;
+        components[INSTANCE_BENCH_CAPACITY + i] = (RandomUnit(seed) - 0.5f) * 200.0f;
+        components[2 * INSTANCE_BENCH_CAPACITY + i] = RandomUnit(seed) * 200.0f;
+
+        rotation = QuaternionType(RandomUnit(seed) - 0.5f, RandomUnit(seed) - 0.5f, RandomUnit(seed) - 0.5f, RandomUnit(seed) - 0.5f);
+        QuaternionNormalize(&rotation, &rotation);
+        components[3 * INSTANCE_BENCH_CAPACITY + i] = rotation.x;
+        components[4 * INSTANCE_BENCH_CAPACITY + i] = rotation.y;
+        components[5 * INSTANCE_BENCH_CAPACITY + i] = rotation.z;
+        components[6 * INSTANCE_BENCH_CAPACITY + i] = rotation.w;
+
+        components[7 * INSTANCE_BENCH_CAPACITY + i] = 0.5f + RandomUnit(seed) * 1.5f;
+    }
+
+    eye = Vector3Type(0.0f, 10.0f, -50.0f);
+    at = Vector3Type(0.0f, 0.0f, 100.0f);
+    up = Vector3Type(0.0f, 1.0f, 0.0f);
+    MatrixLookAtLH(&view, &eye, &at, &up);
+    MatrixPerspectiveFovLH(&projection, MATH_PI / 4.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    MatrixMultiply(&viewProjection, &view, &projection);
+
+    fout << "SIMD: " << (MATH_SSE ? "SSE2" : "none") << endl;
+    fout << "visible    per object ns    batch ns    speedup    exact    matches per object" << endl;
+    fout.setf(ios::fixed);
+    fout.precision(2);
+
+    failures = 0;
+    for (i = 0; i < 3; i++)
+    {
+        // Keep about every other instance in order, the way culling leaves them
+        visible = 0;
+        for (j = 0; (j < INSTANCE_BENCH_CAPACITY) && (visible < visibleCounts[i]); j++)
+        {
+            if (RandomUnit(seed) < 0.5f)
+                indices[visible++] = j;
+        }
+
+        // Bit for bit against one instance at a time
+        WriteMatrices(instances, indices, visible, viewProjection, batch, INSTANCE_BENCH_STRIDE);
+        for (j = 0; j < visible; j++)
+            WriteInstance(instances, indices[j], viewProjection, (float*)(perObject + j * INSTANCE_BENCH_STRIDE));
+        exact = CompareOutputs(batch, perObject, visible, true);
+
+        WriteMatricesPerObject(instances, indices, visible, viewProjection, perObject, INSTANCE_BENCH_STRIDE);
+        close = CompareOutputs(batch, perObject, visible, false);
+
+        if (!exact || !close)
+            failures++;
+
+        perObjectTime = batchTime = 0x7fffffffffffffffLL;
+        for (repeat = 0; repeat < INSTANCE_BENCH_REPEATS; repeat++)
+        {
+            start = GetNanoseconds();
+            WriteMatricesPerObject(instances, indices, visible, viewProjection, perObject, INSTANCE_BENCH_STRIDE);
+            elapsed = GetNanoseconds() - start;
+            if (elapsed < perObjectTime)
+                perObjectTime = elapsed;
+
+            start = GetNanoseconds();
+            WriteMatrices(instances, indices, visible, viewProjection, batch, INSTANCE_BENCH_STRIDE);
+            elapsed = GetNanoseconds() - start;
+            if (elapsed < batchTime)
+                batchTime = elapsed;
+        }
+
+        fout << visible << "    " << (double)perObjectTime / visible << "    " << (double)batchTime / visible << "    "
+            << (double)perObjectTime / (batchTime > 0 ? batchTime : 1) << "    " << (exact ? "yes" : "NO") << "    " << (close ? "yes" : "NO") << endl;
+    }
+
+    fout << endl << failures << " failures" << endl;
+    fout.close();
+
+    printf("%d instance transform failures, results in %s\n", failures, filename);
+
+    delete[] batch;
+    delete[] perObject;
+    delete[] indices;
+    delete[] components;
+
+    return (failures == 0);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "mathclass.h"
+#include <fstream>
+#include <stdio.h>
+using namespace std;
+
+// Bytes written for each instance, the transposed world then the transposed world view projection
+const int INSTANCE_MATRIX_BYTES = 2 * sizeof(MatrixType);
+
+// Where each instance is, one array per component so four instances' worth
+// of a component can be loaded together. Rotations are unit quaternions.
+struct InstanceTransformsType
+{
+    const float* positionX;
+    const float* positionY;
+    const float* positionZ;
+    const float* rotationX;
+    const float* rotationY;
+    const float* rotationZ;
+    const float* rotationW;
+    const float* scale;
+};
+
+// Builds world = scale * rotation * translation and world * view projection
+// for the listed instances, both transposed into the column layout the
+// shaders read, straight into an upload buffer with the given stride between
+// instances. The batch does four instances at a time with the view
+// projection kept in registers, and never forms the world matrix in memory.
+// WriteMatricesPerObject is the old way, one matrix call after another for
+// each instance, kept to check and time the batch against.
+class InstanceTransformClass
+{
+public:
+    static void WriteMatrices(const InstanceTransformsType&, const int*, int, const MatrixType&, unsigned char*, int);
+    static void WriteMatricesPerObject(const InstanceTransformsType&, const int*, int, const MatrixType&, unsigned char*, int);
+    static bool RunBenchmark(char*);
+};
\ No newline at end of file
@@ -1,9 +1,16 @@
 // GLOBALS
-cbuffer MatrixBuffer
+cbuffer FrameBuffer : register(b0)
+{
+	matrix viewProjectionMatrix;
+	float3 cameraPosition;
+	float framePadding;
+};
+
+cbuffer ObjectBuffer : register(b1)
 {
 	matrix worldMatrix;
-	matrix viewMatrix;
-	matrix projectionMatrix;
+	matrix worldViewProjectionMatrix;
+	float4 diffuseColor;
 };
 
 // TYPEDEFS
@@ -29,10 +36,8 @@ PixelInputType LightVertexShader(VertexInputType input)
     // Change vector to be 4 units for proper matrix calculations
 	input.position.w = 1.0f;
 
-    // Calculate position of vertex
-    output.position = mul(input.position, worldMatrix);
-    output.position = mul(output.position, viewMatrix);
-    output.position = mul(output.position, projectionMatrix);
+    // Calculate position of vertex, world view projection is multiplied on the CPU
+    output.position = mul(input.position, worldViewProjectionMatrix);
 
     // Store texture coord for pixel shader
 	output.tex = input.tex;
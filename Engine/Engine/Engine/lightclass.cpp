@@ -17,25 +17,25 @@ LightClass::~LightClass()
 
 void LightClass::SetAmbientColor(float red, float green, float blue, float alpha)
 {
-    m_ambientColor = D3DXVECTOR4(red, green, blue, alpha);
+    m_ambientColor = Vector4Type(red, green, blue, alpha);
     return;
 }
 
 void LightClass::SetDiffuseColor(float red, float green, float blue, float alpha)
 {
-	m_diffuseColor = D3DXVECTOR4(red, green, blue, alpha);
+	m_diffuseColor = Vector4Type(red, green, blue, alpha);
 	return;
 }
 
 void LightClass::SetDirection(float x, float y, float z)
 {
-	m_direction = D3DXVECTOR3(x, y, z);
+	m_direction = Vector3Type(x, y, z);
 	return;
 }
 
 void LightClass::SetSpecularColor(float red, float green, float blue, float alpha)
 {
-    m_specularColor = D3DXVECTOR4(red, green, blue, alpha);
+    m_specularColor = Vector4Type(red, green, blue, alpha);
     return;
 }
 
@@ -45,22 +45,22 @@ void LightClass::SetSpecularPower(float power)
     return;
 }
 
-D3DXVECTOR4 LightClass::GetAmbientColor()
+Vector4Type LightClass::GetAmbientColor()
 {
     return m_ambientColor;
 }
 
-D3DXVECTOR4 LightClass::GetDiffuseColor()
+Vector4Type LightClass::GetDiffuseColor()
 {
 	return m_diffuseColor;
 }
 
-D3DXVECTOR3 LightClass::GetDirection()
+Vector3Type LightClass::GetDirection()
 {
 	return m_direction;
 }
 
-D3DXVECTOR4 LightClass::GetSpecularColor()
+Vector4Type LightClass::GetSpecularColor()
 {
     return m_specularColor;
 }
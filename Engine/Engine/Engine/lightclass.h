@@ -1,6 +1,6 @@
 #pragma once
 
-#include <d3dx10math.h>
+#include "mathclass.h"
 
 class LightClass
 {
@@ -15,16 +15,16 @@ public:
     void SetSpecularColor(float, float, float, float);
     void SetSpecularPower(float);
 
-    D3DXVECTOR4 GetAmbientColor();
-	D3DXVECTOR4 GetDiffuseColor();
-	D3DXVECTOR3 GetDirection();
-    D3DXVECTOR4 GetSpecularColor();
+    Vector4Type GetAmbientColor();
+	Vector4Type GetDiffuseColor();
+	Vector3Type GetDirection();
+    Vector4Type GetSpecularColor();
     float GetSpecularPower();
 
 private:
-    D3DXVECTOR4 m_ambientColor;
-	D3DXVECTOR4 m_diffuseColor;
-	D3DXVECTOR3 m_direction;
-    D3DXVECTOR4 m_specularColor;
+    Vector4Type m_ambientColor;
+	Vector4Type m_diffuseColor;
+	Vector3Type m_direction;
+    Vector4Type m_specularColor;
     float m_specularPower;
 };
\ No newline at end of file
@@ -2,12 +2,14 @@
 
 LightShaderClass::LightShaderClass()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_sampleState = 0;
-	m_matrixBuffer = 0;
+	m_program = 0;
+	m_pipelineState = 0;
+	m_frameBuffer = 0;
     m_lightBuffer = 0;
+    m_objectBuffer = 0;
+    m_frameBytesMapped = 0;
+    m_uploadedFirstConstant = 0;
+    m_uploadedCount = 0;
 }
 
 LightShaderClass::LightShaderClass(const LightShaderClass& other)
@@ -20,15 +22,24 @@ LightShaderClass::~LightShaderClass()
 
 }
 
-bool LightShaderClass::Initialize(ID3D11Device* device, HWND hwnd)
+bool LightShaderClass::Initialize(RenderDeviceClass* device)
 {
 	bool result;
 
     // Initialize the vertex and pixel shaders
-	result = InitializeShader(device, hwnd, L"../Engine/light.vs", L"../Engine/light.ps");
+	result = InitializeShader(device, L"../Engine/light.vs", L"../Engine/light.ps");
 	if (!result)
 		return false;
 
+    // Create the per-object ring buffer
+    m_objectBuffer = new ConstantRingBufferClass;
+    if (!m_objectBuffer)
+        return false;
+
+    result = m_objectBuffer->Initialize(device, OBJECT_RING_BUFFER_SIZE, OBJECT_BLOCK_SIZE);
+    if (!result)
+        return false;
+
 	return true;
 }
 
@@ -38,160 +49,75 @@ void LightShaderClass::Shutdown()
     return;
 }
 
-bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 diffuseColor)
+bool LightShaderClass::Render(RenderContextClass* deviceContext, int indexCount, int objectCount, const InstanceTransformsType& instances, const int* instanceIndices, Vector4Type* diffuseColors, RenderTexture* texture)
 {
     bool result;
 
-    // Set shader params that will use for rendering
-    result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, diffuseColor);
+    // Upload every object with one map when they fit, otherwise stream them in batches
+    result = UploadObjects(deviceContext, objectCount, instances, instanceIndices, diffuseColors);
+    if (result)
+    {
+        RenderObjects(deviceContext, indexCount, 0, objectCount, texture);
+        return true;
+    }
+
+    result = RenderShader(deviceContext, indexCount, objectCount, instances, instanceIndices, diffuseColors, texture);
     if (!result)
         return false;
 
-    // Render prepared buffers with shader
-    RenderShader(deviceContext, indexCount);
-
     return true;
 }
 
-bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename)
+bool LightShaderClass::InitializeShader(RenderDeviceClass* device, wchar_t* vsFilename, wchar_t* psFilename)
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	ID3D10Blob* vertexShaderBuffer;
-	ID3D10Blob* pixelShaderBuffer;
-
-	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
-	unsigned int numElements;
-	D3D11_SAMPLER_DESC samplerDesc;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	D3D11_BUFFER_DESC lightBufferDesc;
-
-	errorMessage = 0;
-	vertexShaderBuffer = 0;
-	pixelShaderBuffer = 0;
-
-    // Compile vertex shader
-	result = D3DX11CompileFromFile(vsFilename, NULL, NULL, "LightVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &vertexShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result))
-	{
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
-		}
-		else
-		{
-			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
-
-    // Compile pixel shader
-	result = D3DX11CompileFromFile(psFilename, NULL, NULL, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &pixelShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result))
-	{
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
-		}
-		else
-		{
-			MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
-
-    // Create vertex shader from the buffer
-	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_vertexShader);
-	if (FAILED(result))
-		return false;
-
-    // Create pixel shader from the buffer
-	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
-	if (FAILED(result))
-		return false;
+	RenderVertexElementType polygonLayout[3];
+	RenderProgramDescType programDesc;
+	RenderPipelineDescType pipelineDesc;
 
     // Vertex input layout description
-	polygonLayout[0].SemanticName = "POSITION";
-	polygonLayout[0].SemanticIndex = 0;
-	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[0].InputSlot = 0;
-	polygonLayout[0].AlignedByteOffset = 0;
-	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[0].InstanceDataStepRate = 0;
-
-	polygonLayout[1].SemanticName = "TEXCOORD";
-	polygonLayout[1].SemanticIndex = 0;
-	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	polygonLayout[1].InputSlot = 0;
-	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[1].InstanceDataStepRate = 0;
-
-	polygonLayout[2].SemanticName = "NORMAL";
-	polygonLayout[2].SemanticIndex = 0;
-	polygonLayout[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[2].InputSlot = 0;
-	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[2].InstanceDataStepRate = 0;
-
-	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
-
-    // Create vertex input layout
-	result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_layout);
-	if (FAILED(result))
+	polygonLayout[0].semanticName = "POSITION";
+	polygonLayout[0].semanticIndex = 0;
+	polygonLayout[0].floatCount = 3;
+
+	polygonLayout[1].semanticName = "TEXCOORD";
+	polygonLayout[1].semanticIndex = 0;
+	polygonLayout[1].floatCount = 2;
+
+	polygonLayout[2].semanticName = "NORMAL";
+	polygonLayout[2].semanticIndex = 0;
+	polygonLayout[2].floatCount = 3;
+
+	programDesc.vsFilename = vsFilename;
+	programDesc.vsEntry = "LightVertexShader";
+	programDesc.psFilename = psFilename;
+	programDesc.psEntry = "LightPixelShader";
+	programDesc.elements = polygonLayout;
+	programDesc.elementCount = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+
+    // Compile and create the vertex and pixel shaders
+	m_program = device->CreateProgram(programDesc);
+	if (!m_program)
 		return false;
 
-	vertexShaderBuffer->Release();
-	vertexShaderBuffer = 0;
-
-	pixelShaderBuffer->Release();
-	pixelShaderBuffer = 0;
-
-    // Create texture sampler state description
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MipLODBias = 0.0f;
-	samplerDesc.MaxAnisotropy = 1;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-	samplerDesc.BorderColor[0] = 0;
-	samplerDesc.BorderColor[1] = 0;
-	samplerDesc.BorderColor[2] = 0;
-	samplerDesc.BorderColor[3] = 0;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-
-    // Create texture sampler state
-	result = device->CreateSamplerState(&samplerDesc, &m_sampleState);
-	if (FAILED(result))
+	// Lit geometry is depth tested and opaque
+	pipelineDesc.program = m_program;
+	pipelineDesc.depthEnabled = true;
+	pipelineDesc.blendEnabled = false;
+	pipelineDesc.cullMode = RENDER_CULL_BACK;
+	pipelineDesc.wireframe = false;
+
+	m_pipelineState = device->GetPipelineState(pipelineDesc);
+	if (!m_pipelineState)
 		return false;
 
-    // Setup description of the dynamic matrix constant buffer that is in the vertex shader
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-    // Create constant buffer pointer
-	result = device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if (FAILED(result))
+    // Create the per-frame constant buffer that is in the vertex shader
+	m_frameBuffer = device->CreateBuffer(RENDER_BUFFER_CONSTANT, sizeof(FrameBufferType), true, 0);
+	if (!m_frameBuffer)
 		return false;
 
-    // Setup the descriptrion of the light dynamic constant buffer that is in the pixel shader
-    lightBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    lightBufferDesc.ByteWidth = sizeof(LightBufferType);
-    lightBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    lightBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    lightBufferDesc.MiscFlags = 0;
-    lightBufferDesc.StructureByteStride = 0;
-
-    // Create constant buffer pointer
-    result = device->CreateBuffer(&lightBufferDesc, NULL, &m_lightBuffer);
-    if (FAILED(result))
+    // Create the light dynamic constant buffer that is in the pixel shader
+    m_lightBuffer = device->CreateBuffer(RENDER_BUFFER_CONSTANT, sizeof(LightBufferType), true, 0);
+    if (!m_lightBuffer)
         return false;
 
     return true;
@@ -199,140 +125,199 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 
 void LightShaderClass::ShutdownShader()
 {
+    if (m_objectBuffer)
+    {
+        m_objectBuffer->Shutdown();
+        delete m_objectBuffer;
+        m_objectBuffer = 0;
+    }
+
 	if (m_lightBuffer)
 	{
 		m_lightBuffer->Release();
 		m_lightBuffer = 0;
 	}
 
-	if (m_matrixBuffer)
+	if (m_frameBuffer)
 	{
-		m_matrixBuffer->Release();
-		m_matrixBuffer = 0;
+		m_frameBuffer->Release();
+		m_frameBuffer = 0;
 	}
 
-	if (m_sampleState)
-	{
-		m_sampleState->Release();
-		m_sampleState = 0;
-	}
-
-	if (m_layout)
-	{
-		m_layout->Release();
-		m_layout = 0;
-	}
+	// The pipeline state belongs to the device
+	m_pipelineState = 0;
 
-	if (m_pixelShader)
+	if (m_program)
 	{
-		m_pixelShader->Release();
-		m_pixelShader = 0;
-	}
-	
-	if (m_vertexShader)
-	{
-		m_vertexShader->Release();
-		m_vertexShader = 0;
+		m_program->Release();
+		m_program = 0;
 	}
 
 	return;
 }
 
-void LightShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
+bool LightShaderClass::SetFrameParameters(RenderContextClass* deviceContext, MatrixType viewMatrix, MatrixType projectionMatrix, Vector3Type cameraPosition, Vector3Type lightDirection)
 {
-	char* compileErrors;
-	unsigned long bufferSize, i;
-	ofstream fout;
+    bool result;
+    FrameBufferType* dataPtr;
+    LightBufferType* dataPtr2;
 
-    // Pointer to the error message text buffer
-	compileErrors = (char*)(errorMessage->GetBufferPointer());
+    // Start counting the bytes mapped this frame
+    m_objectBuffer->BeginFrame();
+    m_frameBytesMapped = 0;
 
-	bufferSize = errorMessage->GetBufferSize();
+    // Keep the combined view projection for the per-object world view projection
+    MatrixMultiply(&m_viewProjectionMatrix, &viewMatrix, &projectionMatrix);
 
-	fout.open("shader-error.txt");
+    // Lock frame constant buffer so it can be written to
+    result = deviceContext->Map(m_frameBuffer, RENDER_MAP_DISCARD, (void**)&dataPtr);
+    if (!result)
+        return false;
 
-	for (i = 0; i < bufferSize; i++)
-		fout << compileErrors[i];
+    MatrixTranspose(&dataPtr->viewProjection, &m_viewProjectionMatrix);
+    dataPtr->cameraPosition = cameraPosition;
+    dataPtr->padding = 0.0f;
 
-	fout.close();
+    // Unlock frame constant buffer
+    deviceContext->Unmap(m_frameBuffer, sizeof(FrameBufferType));
+    m_frameBytesMapped += sizeof(FrameBufferType);
 
-	errorMessage->Release();
-	errorMessage = 0;
+    // Lock light constant buffer
+    result = deviceContext->Map(m_lightBuffer, RENDER_MAP_DISCARD, (void**)&dataPtr2);
+    if (!result)
+        return false;
 
-	MessageBox(hwnd, L"Error compiling shader. Check shader-error.txt for message.", shaderFilename, MB_OK);
+    dataPtr2->lightDirection = lightDirection;
+    dataPtr2->padding = 0.0f;
 
-	return;
+    // Unlock constant buffer
+    deviceContext->Unmap(m_lightBuffer, sizeof(LightBufferType));
+    m_frameBytesMapped += sizeof(LightBufferType);
+
+    return true;
 }
 
-bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 diffuseColor)
+bool LightShaderClass::UploadObjects(RenderContextClass* deviceContext, int objectCount, const InstanceTransformsType& instances, const int* instanceIndices, Vector4Type* diffuseColors)
 {
-    HRESULT result;
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    MatrixBufferType* dataPtr;
-    LightBufferType* dataPtr2;
-    unsigned int bufferNumber;
+    unsigned char* blockPtr;
+    bool result;
 
-    // Set shader texture resource in pixel shader
-    deviceContext->PSSetShaderResources(0, 1, &texture);
+    m_uploadedCount = 0;
 
-    // Lock matrix constant buffer so it can be written to
-    result = deviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(result))
+    // All objects have to be addressable by offset at the same time
+    if (!m_objectBuffer->SupportsOffsets())
         return false;
 
-    dataPtr = (MatrixBufferType*)mappedResource.pData;
+    if ((unsigned int)objectCount * OBJECT_BLOCK_SIZE > m_objectBuffer->GetCapacity())
+        return false;
 
-    D3DXMatrixTranspose(&worldMatrix, &worldMatrix);
-    D3DXMatrixTranspose(&viewMatrix, &viewMatrix);
-    D3DXMatrixTranspose(&projectionMatrix, &projectionMatrix);
+    if (objectCount == 0)
+        return true;
 
-    dataPtr->world = worldMatrix;
-    dataPtr->view = viewMatrix;
-    dataPtr->projection = projectionMatrix;
+    // One map for every object of the frame
+    result = m_objectBuffer->Map(deviceContext, objectCount * OBJECT_BLOCK_SIZE, (void**)&blockPtr, m_uploadedFirstConstant);
+    if (!result)
+        return false;
 
-    // Unlock matrix constant buffer
-    deviceContext->Unmap(m_matrixBuffer, 0);
+    WriteObjects(blockPtr, objectCount, instances, instanceIndices, diffuseColors);
 
-    bufferNumber = 0;
+    m_objectBuffer->Unmap(deviceContext);
 
-    // Set matrix constant buffer in vertex shader with updated values
-    deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+    m_uploadedCount = objectCount;
 
-    // Lock light constant buffer
-    result = deviceContext->Map(m_lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(result))
-        return false;
+    return true;
+}
 
-    dataPtr2 = (LightBufferType*)mappedResource.pData;
+void LightShaderClass::RenderObjects(RenderContextClass* deviceContext, int indexCount, int first, int last, RenderTexture* texture)
+{
+    unsigned int blockConstants;
+    int i;
 
-    dataPtr2->diffuseColor = diffuseColor;
-    dataPtr2->lightDirection = lightDirection;
+    SetShaderState(deviceContext, texture);
 
-    // Unlock constant buffer
-    deviceContext->Unmap(m_lightBuffer, 0);
+    // Point both stages at each uploaded object's block and draw it
+    blockConstants = OBJECT_BLOCK_SIZE / 16;
+    for (i = first; (i < last) && (i < m_uploadedCount); i++)
+    {
+        m_objectBuffer->SetConstantBuffers(deviceContext, 1, m_uploadedFirstConstant + i * blockConstants);
+        deviceContext->DrawIndexed(indexCount, 0, 0);
+    }
 
-    bufferNumber = 0;
+    return;
+}
 
-    // Set light constant buffer in pixel shader with updated values
-    deviceContext->PSSetConstantBuffers(bufferNumber, 1, &m_lightBuffer);
+void LightShaderClass::SetShaderState(RenderContextClass* deviceContext, RenderTexture* texture)
+{
+    // Set shader texture resource in pixel shader
+    deviceContext->SetTexture(0, texture);
 
-    return true;
+    // Set the per-frame constant buffers
+    deviceContext->SetConstantBuffer(RENDER_STAGE_VERTEX, 0, m_frameBuffer, 0, 0);
+    deviceContext->SetConstantBuffer(RENDER_STAGE_PIXEL, 0, m_lightBuffer, 0, 0);
+
+    // Set shaders, layout, sampler and the fixed function state in one go
+	deviceContext->SetPipelineState(m_pipelineState);
+
+    return;
 }
 
-void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void LightShaderClass::WriteObjects(unsigned char* blockPtr, int objectCount, const InstanceTransformsType& instances, const int* instanceIndices, Vector4Type* diffuseColors)
 {
-    // Set vertex input layout
-	deviceContext->IASetInputLayout(m_layout);
+    ObjectBufferType* dataPtr;
+    int i;
 
-    // Set vertex and pixel shaders
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
+    // Both matrices of every object in one pass, straight into the blocks
+    InstanceTransformClass::WriteMatrices(instances, instanceIndices, objectCount, m_viewProjectionMatrix, blockPtr, OBJECT_BLOCK_SIZE);
 
-    // Set sampler state in the pixel sahder
-	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
+    for (i = 0; i < objectCount; i++)
+    {
+        dataPtr = (ObjectBufferType*)(blockPtr + i * OBJECT_BLOCK_SIZE);
+        dataPtr->diffuseColor = diffuseColors[i];
+    }
 
-    // Render the triangle
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+    return;
+}
 
-	return;
+bool LightShaderClass::RenderShader(RenderContextClass* deviceContext, int indexCount, int objectCount, const InstanceTransformsType& instances, const int* instanceIndices, Vector4Type* diffuseColors, RenderTexture* texture)
+{
+    unsigned char* blockPtr;
+    unsigned int firstConstant, blockConstants;
+    int batchSize, first, count, i;
+    bool result;
+
+    SetShaderState(deviceContext, texture);
+
+    // Number of objects that fit in the ring, 1 when offsets are unsupported
+    batchSize = (int)(m_objectBuffer->GetCapacity() / OBJECT_BLOCK_SIZE);
+    blockConstants = OBJECT_BLOCK_SIZE / 16;
+
+    for (first = 0; first < objectCount; first += batchSize)
+    {
+        count = objectCount - first;
+        if (count > batchSize)
+            count = batchSize;
+
+        // Map all blocks of this batch at once
+        result = m_objectBuffer->Map(deviceContext, count * OBJECT_BLOCK_SIZE, (void**)&blockPtr, firstConstant);
+        if (!result)
+            return false;
+
+        WriteObjects(blockPtr, count, instances, &instanceIndices[first], &diffuseColors[first]);
+
+        m_objectBuffer->Unmap(deviceContext);
+
+        // Point both stages at each object's block and draw it
+        for (i = 0; i < count; i++)
+        {
+            m_objectBuffer->SetConstantBuffers(deviceContext, 1, firstConstant + i * blockConstants);
+            deviceContext->DrawIndexed(indexCount, 0, 0);
+        }
+    }
+
+	return true;
+}
+
+unsigned int LightShaderClass::GetBytesMapped()
+{
+    return m_frameBytesMapped + m_objectBuffer->GetBytesMapped();
 }
\ No newline at end of file
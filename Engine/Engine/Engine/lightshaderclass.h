@@ -1,47 +1,74 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dx10math.h>
-#include <d3dx11async.h>
-#include <fstream>
-using namespace std;
+#include "mathclass.h"
+#include "renderdeviceclass.h"
+#include "constantringbufferclass.h"
+#include "instancetransformclass.h"
+
+// Per-object constants are streamed into 256 byte blocks of one ring buffer
+const unsigned int OBJECT_BLOCK_SIZE = 256;
+const unsigned int OBJECT_RING_BUFFER_SIZE = 256 * 1024;
 
 class LightShaderClass
 {
 private:
-	struct MatrixBufferType
-	{
-		D3DXMATRIX world;
-		D3DXMATRIX view;
-		D3DXMATRIX projection;
-	};
+    // Updated once per frame, vertex shader slot 0
+    struct FrameBufferType
+    {
+        MatrixType viewProjection;
+        Vector3Type cameraPosition;
+        float padding;
+    };
+
+    // Updated once per frame, pixel shader slot 0
     struct LightBufferType
     {
-        D3DXVECTOR4 diffuseColor;
-        D3DXVECTOR3 lightDirection;
+        Vector3Type lightDirection;
         float padding;
     };
+
+    // One ring buffer block per object, bound to slot 1 of both stages. The
+    // two matrices come first, written by InstanceTransformClass
+    struct ObjectBufferType
+    {
+        MatrixType world;
+        MatrixType worldViewProjection;
+        Vector4Type diffuseColor;
+    };
+
 public:
 	LightShaderClass();
 	LightShaderClass(const LightShaderClass&);
 	~LightShaderClass();
 
-	bool Initialize(ID3D11Device*, HWND);
+	bool Initialize(RenderDeviceClass*);
 	void Shutdown();
-    bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4);
+    bool SetFrameParameters(RenderContextClass*, MatrixType, MatrixType, Vector3Type, Vector3Type);
+    bool Render(RenderContextClass*, int, int, const InstanceTransformsType&, const int*, Vector4Type*, RenderTexture*);
+
+    // Split path for recording on several contexts: upload on the immediate
+    // context once, then draw any range of the uploaded objects on any context
+    bool UploadObjects(RenderContextClass*, int, const InstanceTransformsType&, const int*, Vector4Type*);
+    void RenderObjects(RenderContextClass*, int, int, int, RenderTexture*);
+
+    unsigned int GetBytesMapped();
 
 private:
-	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
+	bool InitializeShader(RenderDeviceClass*, wchar_t*, wchar_t*);
 	void ShutdownShader();
-	void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
-    bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4);
-    void RenderShader(ID3D11DeviceContext*, int);
+    bool RenderShader(RenderContextClass*, int, int, const InstanceTransformsType&, const int*, Vector4Type*, RenderTexture*);
+    void SetShaderState(RenderContextClass*, RenderTexture*);
+    void WriteObjects(unsigned char*, int, const InstanceTransformsType&, const int*, Vector4Type*);
 
 private:
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11SamplerState* m_sampleState;
-	ID3D11Buffer* m_matrixBuffer;
-    ID3D11Buffer* m_lightBuffer;
+	RenderProgram* m_program;
+	RenderPipelineState* m_pipelineState;
+	RenderBuffer* m_frameBuffer;
+    RenderBuffer* m_lightBuffer;
+    ConstantRingBufferClass* m_objectBuffer;
+
+    MatrixType m_viewProjectionMatrix;
+    unsigned int m_frameBytesMapped;
+    unsigned int m_uploadedFirstConstant;
+    int m_uploadedCount;
 };
\ No newline at end of file
@@ -1,16 +1,99 @@
+#ifdef _WIN32
 #include "systemclass.h"
+#include "fontbakerclass.h"
+#include "texturebakerclass.h"
+#include "virtualtextureclass.h"
+#include "mathclass.h"
+#include "instancetransformclass.h"
+#include "cpufeatureclass.h"
+#include "parallelrecordclass.h"
+#include "rendertargetpoolclass.h"
+#include "ddsfileclass.h"
+#include "softwarerasterizerclass.h"
+#include "shadercacheclass.h"
+#include "texturestreamerclass.h"
 
 int WINAPI WinMain
 	(HINSTANCE hInstance, HINSTANCE hPrevInstance,
 		PSTR pScmdline, int iCmdshow)
 {
 	SystemClass* System;
+	BenchmarkSettingsType benchmark;
 	bool result;
 
+	// Pick the instruction set kernels run with before anything binds them, -isa forces one
+	CpuFeatureClass::Initialize(pScmdline);
+
+	// Build the shader cache from the manifest and exit, for use as a build step
+	if (strstr(pScmdline, "-precompile"))
+		return D3DClass::PrecompileShaders("shaders.txt") ? 0 : 1;
+
+	// Bake the overlay's distance field font from its manifest and exit
+	if (strstr(pScmdline, "-bakefont"))
+		return FontBakerClass::BakeFont("overlay-font.txt") ? 0 : 1;
+
+	// Compress the textures in the manifest with their mips and exit
+	if (strstr(pScmdline, "-baketextures"))
+		return TextureBakerClass::BakeTextures("textures.txt") ? 0 : 1;
+
+	// Run the virtual texture cache against synthetic feedback and exit
+	if (strstr(pScmdline, "-virtualtexture"))
+		return VirtualTextureClass::RunSimulation("virtual-texture.txt") ? 0 : 1;
+
+	// Check the math library against its plain code and time it, then exit
+	if (strstr(pScmdline, "-mathtest"))
+		return MathClass::RunTests("math-test.txt") ? 0 : 1;
+
+	// Time the batched object matrices against building them one object at a time, then exit
+	if (strstr(pScmdline, "-instancebench"))
+		return InstanceTransformClass::RunBenchmark("instance-bench.txt") ? 0 : 1;
+
+	// Check every kernel version this machine can run against the scalar one, then exit
+	if (strstr(pScmdline, "-cputest"))
+		return CpuFeatureClass::RunTests("cpu-test.txt") ? 0 : 1;
+
+	// Record frames through the worker threads without a device and check the ranges and submission order, then exit
+	if (strstr(pScmdline, "-recordtest"))
+		return ParallelRecordClass::RunTests("record-test.txt") ? 0 : 1;
+
+	// Compile and execute small frame graphs on the null device and check their order, culling and aliasing, then exit
+	if (strstr(pScmdline, "-framegraphtest"))
+		return RenderTargetPoolClass::RunTests("framegraph-test.txt") ? 0 : 1;
+
+	// Load the engine's DDS files and generated ones and check the format, size and mips the loader finds, then exit
+	if (strstr(pScmdline, "-ddstest"))
+		return DdsFileClass::RunTests("dds-test.txt") ? 0 : 1;
+
+	// Run the shader cache with a stand in compiler through hits, misses, edits and damaged files, then exit
+	if (strstr(pScmdline, "-shadercachetest"))
+		return ShaderCacheClass::RunTests("shader-cache-test.txt") ? 0 : 1;
+
+	// Stream the baked texture on the null device under shrinking budgets and check what stays resident, then exit
+	if (strstr(pScmdline, "-streamtest"))
+		return TextureStreamerClass::RunTests("stream-test.txt") ? 0 : 1;
+
+	// Draw small scenes with known results on the software rasterizer and check every pixel, then exit
+	if (strstr(pScmdline, "-rastertest"))
+		return SoftwareRasterizerClass::RunTests("raster-test.txt") ? 0 : 1;
+
 	System = new SystemClass;
 	if (!System)
 		return 0;
-	result = System->Initialize();
+
+	// A scripted run with no input that exits when it is done
+	if (BenchmarkClass::ParseCommandLine(pScmdline, benchmark))
+	{
+		result = System->InitializeBenchmark(benchmark);
+		if (result)
+			result = System->RunBenchmark();
+		System->Shutdown();
+		delete System;
+		System = 0;
+
+		return result ? 0 : 1;
+	}
+
+	result = System->Initialize(pScmdline);
 	if (result)
 		System->Run();
 	System->Shutdown();
@@ -18,4 +101,138 @@ int WINAPI WinMain
 	System = 0;
 
 	return 0;
-}
\ No newline at end of file
+}
+#else
+#include "benchmarkclass.h"
+#include "ddsfileclass.h"
+#include "texturebakerclass.h"
+#include "virtualtextureclass.h"
+#include "mathclass.h"
+#include "instancetransformclass.h"
+#include "cpufeatureclass.h"
+#include "parallelrecordclass.h"
+#include "rendertargetpoolclass.h"
+#include "softwarerasterizerclass.h"
+#include "shadercacheclass.h"
+#include "texturestreamerclass.h"
+
+// Prints how the DDS loader lays out each file, to check files without a GPU
+static int PrintDdsInfo(int fileCount, char* filenames[])
+{
+	DdsFileClass file;
+	const DdsSubresourceType* subresources;
+	bool result;
+	int i, j;
+
+	result = true;
+	for (i = 0; i < fileCount; i++)
+	{
+		if (!file.Initialize(filenames[i]))
+		{
+			printf("%s: not a DDS file the loader can use\n", filenames[i]);
+			file.Shutdown();
+			result = false;
+			continue;
+		}
+
+		printf("%s: %s %dx%d, %d mips, %d slices%s\n", filenames[i], DdsFileClass::GetFormatName(file.GetFormat()), file.GetWidth(), file.GetHeight(),
+			file.GetMipCount(), file.GetArraySize(), file.IsCubemap() ? ", cubemap" : "");
+
+		subresources = file.GetSubresources();
+		for (j = 0; j < file.GetMipCount(); j++)
+			printf("  mip %d: %ux%u, %u bytes a row, %u bytes\n", j, subresources[j].width, subresources[j].height, subresources[j].rowPitch, subresources[j].slicePitch);
+
+		file.Shutdown();
+	}
+
+	return result ? 0 : 1;
+}
+
+// Elsewhere only the benchmark runs, on the null device unless another one is asked for
+int main(int argc, char* argv[])
+{
+	BenchmarkClass* benchmark;
+	BenchmarkSettingsType settings;
+	char commandLine[1024];
+	bool done, result;
+	int i;
+
+	if ((argc > 1) && (strcmp(argv[1], "-ddsinfo") == 0))
+		return PrintDdsInfo(argc - 2, &argv[2]);
+
+	strcpy(commandLine, "-benchmark");
+	for (i = 1; i < argc; i++)
+	{
+		if (strlen(commandLine) + strlen(argv[i]) + 2 > sizeof(commandLine))
+			return 1;
+		strcat(commandLine, " ");
+		strcat(commandLine, argv[i]);
+	}
+
+	CpuFeatureClass::Initialize(commandLine);
+
+	if ((argc > 1) && (strcmp(argv[1], "-baketextures") == 0))
+		return TextureBakerClass::BakeTextures("textures.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-virtualtexture") == 0))
+		return VirtualTextureClass::RunSimulation("virtual-texture.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-mathtest") == 0))
+		return MathClass::RunTests("math-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-instancebench") == 0))
+		return InstanceTransformClass::RunBenchmark("instance-bench.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-cputest") == 0))
+		return CpuFeatureClass::RunTests("cpu-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-recordtest") == 0))
+		return ParallelRecordClass::RunTests("record-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-framegraphtest") == 0))
+		return RenderTargetPoolClass::RunTests("framegraph-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-ddstest") == 0))
+		return DdsFileClass::RunTests("dds-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-shadercachetest") == 0))
+		return ShaderCacheClass::RunTests("shader-cache-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-streamtest") == 0))
+		return TextureStreamerClass::RunTests("stream-test.txt") ? 0 : 1;
+
+	if ((argc > 1) && (strcmp(argv[1], "-rastertest") == 0))
+		return SoftwareRasterizerClass::RunTests("raster-test.txt") ? 0 : 1;
+
+	BenchmarkClass::ParseCommandLine(commandLine, settings);
+	if (!strstr(commandLine, "-device"))
+		settings.deviceType = GRAPHICS_DEVICE_NULL;
+
+	if (PROFILER_ENABLED)
+		ProfilerClass::Initialize();
+
+	benchmark = new BenchmarkClass;
+	if (!benchmark)
+		return 1;
+
+	result = benchmark->Initialize(settings, 0);
+	done = false;
+	while (result && !done)
+		result = benchmark->Frame(done);
+
+	if (result)
+		result = benchmark->WriteResults();
+
+	benchmark->Shutdown();
+	delete benchmark;
+	benchmark = 0;
+
+	if (PROFILER_ENABLED)
+	{
+		ProfilerClass::WriteTrace("trace.json");
+		ProfilerClass::Shutdown();
+	}
+
+	return result ? 0 : 1;
+}
+#endif
\ No newline at end of file
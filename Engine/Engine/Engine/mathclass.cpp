@@ -0,0 +1,1033 @@
+#include "mathclass.h"
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+using namespace std;
+
+const int MATH_TEST_COUNT = 4096;
+const int MATH_BENCH_COUNT = 65536;
+const int MATH_BENCH_REPEATS = 20;
+const float MATH_TEST_TOLERANCE = 0.00002f;
+
+// The plain versions of everything that has a SIMD one. They are the fallback
+// without SSE and what the tests hold the SIMD versions to.
+static MatrixType* ScalarMatrixMultiply(MatrixType* out, const MatrixType* a, const MatrixType* b)
+{
+    MatrixType result;
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < 4; j++)
+            result.m[i][j] = a->m[i][0] * b->m[0][j] + a->m[i][1] * b->m[1][j] + a->m[i][2] * b->m[2][j] + a->m[i][3] * b->m[3][j];
+    }
+
+    *out = result;
+
+    return out;
+}
+
+static MatrixType* ScalarMatrixTranspose(MatrixType* out, const MatrixType* a)
+{
+    MatrixType result;
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < 4; j++)
+            result.m[i][j] = a->m[j][i];
+    }
+
+    *out = result;
+
+    return out;
+}
+
+static Vector3Type* ScalarVec3TransformCoord(Vector3Type* out, const Vector3Type* v, const MatrixType* m)
+{
+    Vector3Type result;
+    float w;
+
+    w = m->m[0][3] * v->x + m->m[1][3] * v->y + m->m[2][3] * v->z + m->m[3][3];
+    result.x = (m->m[0][0] * v->x + m->m[1][0] * v->y + m->m[2][0] * v->z + m->m[3][0]) / w;
+    result.y = (m->m[0][1] * v->x + m->m[1][1] * v->y + m->m[2][1] * v->z + m->m[3][1]) / w;
+    result.z = (m->m[0][2] * v->x + m->m[1][2] * v->y + m->m[2][2] * v->z + m->m[3][2]) / w;
+    *out = result;
+
+    return out;
+}
+
+static Vector4Type* ScalarVec4Transform(Vector4Type* out, const Vector4Type* v, const MatrixType* m)
+{
+    Vector4Type result;
+
+    result.x = m->m[0][0] * v->x + m->m[1][0] * v->y + m->m[2][0] * v->z + m->m[3][0] * v->w;
+    result.y = m->m[0][1] * v->x + m->m[1][1] * v->y + m->m[2][1] * v->z + m->m[3][1] * v->w;
+    result.z = m->m[0][2] * v->x + m->m[1][2] * v->y + m->m[2][2] * v->z + m->m[3][2] * v->w;
+    result.w = m->m[0][3] * v->x + m->m[1][3] * v->y + m->m[2][3] * v->z + m->m[3][3] * v->w;
+    *out = result;
+
+    return out;
+}
+
+#if MATH_SSE
+// One row of a times b, the rows of b weighted by the row's elements and summed left to right
+static inline __m128 MultiplyRow(const float* row, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+{
+    __m128 result;
+
+    result = _mm_mul_ps(_mm_set1_ps(row[0]), b0);
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[1]), b1));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[2]), b2));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[3]), b3));
+
+    return result;
+}
+#endif
+
+#if MATH_AVX
+// Two rows at once, each half of the register is one row and the rows of b are in both halves
+static inline __m256 MultiplyRows(__m256 rows, __m256 b0, __m256 b1, __m256 b2, __m256 b3)
+{
+    __m256 result;
+
+    result = _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+
+    return result;
+}
+#endif
+
+float Vec3Dot(const Vector3Type* a, const Vector3Type* b)
+{
+    return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+Vector3Type* Vec3Cross(Vector3Type* out, const Vector3Type* a, const Vector3Type* b)
+{
+    Vector3Type result;
+
+    result.x = a->y * b->z - a->z * b->y;
+    result.y = a->z * b->x - a->x * b->z;
+    result.z = a->x * b->y - a->y * b->x;
+    *out = result;
+
+    return out;
+}
+
+float Vec3Length(const Vector3Type* v)
+{
+    return sqrtf(v->x * v->x + v->y * v->y + v->z * v->z);
+}
+
+// A zero vector stays zero
+Vector3Type* Vec3Normalize(Vector3Type* out, const Vector3Type* v)
+{
+    float length;
+
+    length = Vec3Length(v);
+    if (length == 0.0f)
+    {
+        *out = Vector3Type(0.0f, 0.0f, 0.0f);
+        return out;
+    }
+
+    out->x = v->x / length;
+    out->y = v->y / length;
+    out->z = v->z / length;
+
+    return out;
+}
+
+// Treats the vector as a point, w = 1, and divides by the w it ends up with
+Vector3Type* Vec3TransformCoord(Vector3Type* out, const Vector3Type* v, const MatrixType* m)
+{
+#if MATH_SSE
+    __m128 result;
+    float values[4];
+
+    result = _mm_mul_ps(_mm_set1_ps(v->x), _mm_loadu_ps(m->m[0]));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(v->y), _mm_loadu_ps(m->m[1])));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(v->z), _mm_loadu_ps(m->m[2])));
+    result = _mm_add_ps(result, _mm_loadu_ps(m->m[3]));
+    result = _mm_div_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 3, 3, 3)));
+    _mm_storeu_ps(values, result);
+
+    out->x = values[0];
+    out->y = values[1];
+    out->z = values[2];
+
+    return out;
+#else
+    return ScalarVec3TransformCoord(out, v, m);
+#endif
+}
+
+// A direction, w = 0, so translation doesn't apply
+Vector3Type* Vec3TransformNormal(Vector3Type* out, const Vector3Type* v, const MatrixType* m)
+{
+    Vector3Type result;
+
+    result.x = m->m[0][0] * v->x + m->m[1][0] * v->y + m->m[2][0] * v->z;
+    result.y = m->m[0][1] * v->x + m->m[1][1] * v->y + m->m[2][1] * v->z;
+    result.z = m->m[0][2] * v->x + m->m[1][2] * v->y + m->m[2][2] * v->z;
+    *out = result;
+
+    return out;
+}
+
+Vector4Type* Vec4Transform(Vector4Type* out, const Vector4Type* v, const MatrixType* m)
+{
+#if MATH_SSE
+    _mm_storeu_ps(&out->x, MultiplyRow(&v->x, _mm_loadu_ps(m->m[0]), _mm_loadu_ps(m->m[1]), _mm_loadu_ps(m->m[2]), _mm_loadu_ps(m->m[3])));
+
+    return out;
+#else
+    return ScalarVec4Transform(out, v, m);
+#endif
+}
+
+MatrixType* MatrixIdentity(MatrixType* out)
+{
+    *out = MatrixType(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    return out;
+}
+
+// a then b, out can be either of them
+MatrixType* MatrixMultiply(MatrixType* out, const MatrixType* a, const MatrixType* b)
+{
+#if MATH_SSE
+    __m128 b0, b1, b2, b3, row0, row1, row2, row3;
+
+    b0 = _mm_loadu_ps(b->m[0]);
+    b1 = _mm_loadu_ps(b->m[1]);
+    b2 = _mm_loadu_ps(b->m[2]);
+    b3 = _mm_loadu_ps(b->m[3]);
+
+    row0 = MultiplyRow(a->m[0], b0, b1, b2, b3);
+    row1 = MultiplyRow(a->m[1], b0, b1, b2, b3);
+    row2 = MultiplyRow(a->m[2], b0, b1, b2, b3);
+    row3 = MultiplyRow(a->m[3], b0, b1, b2, b3);
+
+    _mm_storeu_ps(out->m[0], row0);
+    _mm_storeu_ps(out->m[1], row1);
+    _mm_storeu_ps(out->m[2], row2);
+    _mm_storeu_ps(out->m[3], row3);
+
+    return out;
+#else
+    return ScalarMatrixMultiply(out, a, b);
+#endif
+}
+
+MatrixType* MatrixTranspose(MatrixType* out, const MatrixType* a)
+{
+#if MATH_SSE
+    __m128 row0, row1, row2, row3;
+
+    row0 = _mm_loadu_ps(a->m[0]);
+    row1 = _mm_loadu_ps(a->m[1]);
+    row2 = _mm_loadu_ps(a->m[2]);
+    row3 = _mm_loadu_ps(a->m[3]);
+
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+    _mm_storeu_ps(out->m[0], row0);
+    _mm_storeu_ps(out->m[1], row1);
+    _mm_storeu_ps(out->m[2], row2);
+    _mm_storeu_ps(out->m[3], row3);
+
+    return out;
+#else
+    return ScalarMatrixTranspose(out, a);
+#endif
+}
+
+MatrixType* MatrixTranslation(MatrixType* out, float x, float y, float z)
+{
+    MatrixIdentity(out);
+    out->_41 = x;
+    out->_42 = y;
+    out->_43 = z;
+
+    return out;
+}
+
+MatrixType* MatrixScaling(MatrixType* out, float x, float y, float z)
+{
+    MatrixIdentity(out);
+    out->_11 = x;
+    out->_22 = y;
+    out->_33 = z;
+
+    return out;
+}
+
+// Angles in radians, clockwise looking down the axis towards the origin as D3DX has them
+MatrixType* MatrixRotationX(MatrixType* out, float angle)
+{
+    MatrixIdentity(out);
+    out->_22 = cosf(angle);
+    out->_23 = sinf(angle);
+    out->_32 = -sinf(angle);
+    out->_33 = cosf(angle);
+
+    return out;
+}
+
+MatrixType* MatrixRotationY(MatrixType* out, float angle)
+{
+    MatrixIdentity(out);
+    out->_11 = cosf(angle);
+    out->_13 = -sinf(angle);
+    out->_31 = sinf(angle);
+    out->_33 = cosf(angle);
+
+    return out;
+}
+
+MatrixType* MatrixRotationZ(MatrixType* out, float angle)
+{
+    MatrixIdentity(out);
+    out->_11 = cosf(angle);
+    out->_12 = sinf(angle);
+    out->_21 = -sinf(angle);
+    out->_22 = cosf(angle);
+
+    return out;
+}
+
+// Roll about z, then pitch about x, then yaw about y
+MatrixType* MatrixRotationYawPitchRoll(MatrixType* out, float yaw, float pitch, float roll)
+{
+    float sinRoll, cosRoll, sinPitch, cosPitch, sinYaw, cosYaw;
+
+    sinRoll = sinf(roll);
+    cosRoll = cosf(roll);
+    sinPitch = sinf(pitch);
+    cosPitch = cosf(pitch);
+    sinYaw = sinf(yaw);
+    cosYaw = cosf(yaw);
+
+    out->_11 = sinRoll * sinPitch * sinYaw + cosRoll * cosYaw;
+    out->_12 = sinRoll * cosPitch;
+    out->_13 = sinRoll * sinPitch * cosYaw - cosRoll * sinYaw;
+    out->_14 = 0.0f;
+    out->_21 = cosRoll * sinPitch * sinYaw - sinRoll * cosYaw;
+    out->_22 = cosRoll * cosPitch;
+    out->_23 = cosRoll * sinPitch * cosYaw + sinRoll * sinYaw;
+    out->_24 = 0.0f;
+    out->_31 = cosPitch * sinYaw;
+    out->_32 = -sinPitch;
+    out->_33 = cosPitch * cosYaw;
+    out->_34 = 0.0f;
+    out->_41 = 0.0f;
+    out->_42 = 0.0f;
+    out->_43 = 0.0f;
+    out->_44 = 1.0f;
+
+    return out;
+}
+
+// The quaternion has to be unit length
+MatrixType* MatrixRotationQuaternion(MatrixType* out, const QuaternionType* q)
+{
+    MatrixIdentity(out);
+    out->_11 = 1.0f - 2.0f * (q->y * q->y + q->z * q->z);
+    out->_12 = 2.0f * (q->x * q->y + q->z * q->w);
+    out->_13 = 2.0f * (q->x * q->z - q->y * q->w);
+    out->_21 = 2.0f * (q->x * q->y - q->z * q->w);
+    out->_22 = 1.0f - 2.0f * (q->x * q->x + q->z * q->z);
+    out->_23 = 2.0f * (q->y * q->z + q->x * q->w);
+    out->_31 = 2.0f * (q->x * q->z + q->y * q->w);
+    out->_32 = 2.0f * (q->y * q->z - q->x * q->w);
+    out->_33 = 1.0f - 2.0f * (q->x * q->x + q->y * q->y);
+
+    return out;
+}
+
+// Left handed view matrix, the axes are normalized after the crosses as D3DX does
+MatrixType* MatrixLookAtLH(MatrixType* out, const Vector3Type* eye, const Vector3Type* at, const Vector3Type* up)
+{
+    Vector3Type zAxis, xAxis, yAxis;
+
+    zAxis = *at - *eye;
+    Vec3Normalize(&zAxis, &zAxis);
+    Vec3Cross(&xAxis, up, &zAxis);
+    Vec3Cross(&yAxis, &zAxis, &xAxis);
+    Vec3Normalize(&xAxis, &xAxis);
+    Vec3Normalize(&yAxis, &yAxis);
+
+    out->_11 = xAxis.x;
+    out->_21 = xAxis.y;
+    out->_31 = xAxis.z;
+    out->_41 = -Vec3Dot(&xAxis, eye);
+    out->_12 = yAxis.x;
+    out->_22 = yAxis.y;
+    out->_32 = yAxis.z;
+    out->_42 = -Vec3Dot(&yAxis, eye);
+    out->_13 = zAxis.x;
+    out->_23 = zAxis.y;
+    out->_33 = zAxis.z;
+    out->_43 = -Vec3Dot(&zAxis, eye);
+    out->_14 = 0.0f;
+    out->_24 = 0.0f;
+    out->_34 = 0.0f;
+    out->_44 = 1.0f;
+
+    return out;
+}
+
+// Left handed, depth goes from 0 at the near plane to 1 at the far one
+MatrixType* MatrixPerspectiveFovLH(MatrixType* out, float fieldOfView, float aspect, float nearZ, float farZ)
+{
+    MatrixIdentity(out);
+    out->_11 = 1.0f / (aspect * tanf(fieldOfView / 2.0f));
+    out->_22 = 1.0f / tanf(fieldOfView / 2.0f);
+    out->_33 = farZ / (farZ - nearZ);
+    out->_34 = 1.0f;
+    out->_43 = (farZ * nearZ) / (nearZ - farZ);
+    out->_44 = 0.0f;
+
+    return out;
+}
+
+MatrixType* MatrixOrthoLH(MatrixType* out, float width, float height, float nearZ, float farZ)
+{
+    MatrixIdentity(out);
+    out->_11 = 2.0f / width;
+    out->_22 = 2.0f / height;
+    out->_33 = 1.0f / (farZ - nearZ);
+    out->_43 = nearZ / (nearZ - farZ);
+
+    return out;
+}
+
+// Scales the whole plane so the normal is unit length, Dot then gives distances. A plane with no normal becomes zero.
+PlaneType* PlaneNormalize(PlaneType* out, const PlaneType* p)
+{
+    float length;
+
+    length = sqrtf(p->a * p->a + p->b * p->b + p->c * p->c);
+    if (length == 0.0f)
+    {
+        *out = PlaneType(0.0f, 0.0f, 0.0f, 0.0f);
+        return out;
+    }
+
+    out->a = p->a / length;
+    out->b = p->b / length;
+    out->c = p->c / length;
+    out->d = p->d / length;
+
+    return out;
+}
+
+float PlaneDotCoord(const PlaneType* p, const Vector3Type* v)
+{
+    return p->a * v->x + p->b * v->y + p->c * v->z + p->d;
+}
+
+float PlaneDotCoord(const PlaneType* p, const Vector3Type& v)
+{
+    return p->a * v.x + p->b * v.y + p->c * v.z + p->d;
+}
+
+QuaternionType* QuaternionIdentity(QuaternionType* out)
+{
+    *out = QuaternionType(0.0f, 0.0f, 0.0f, 1.0f);
+
+    return out;
+}
+
+float QuaternionDot(const QuaternionType* a, const QuaternionType* b)
+{
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+QuaternionType* QuaternionNormalize(QuaternionType* out, const QuaternionType* q)
+{
+    float length;
+
+    length = sqrtf(QuaternionDot(q, q));
+    if (length == 0.0f)
+    {
+        *out = QuaternionType(0.0f, 0.0f, 0.0f, 0.0f);
+        return out;
+    }
+
+    out->x = q->x / length;
+    out->y = q->y / length;
+    out->z = q->z / length;
+    out->w = q->w / length;
+
+    return out;
+}
+
+// The rotation a then b, the same order MatrixMultiply uses
+QuaternionType* QuaternionMultiply(QuaternionType* out, const QuaternionType* a, const QuaternionType* b)
+{
+    QuaternionType result;
+
+    result.x = b->w * a->x + b->x * a->w + b->y * a->z - b->z * a->y;
+    result.y = b->w * a->y - b->x * a->z + b->y * a->w + b->z * a->x;
+    result.z = b->w * a->z + b->x * a->y - b->y * a->x + b->z * a->w;
+    result.w = b->w * a->w - b->x * a->x - b->y * a->y - b->z * a->z;
+    *out = result;
+
+    return out;
+}
+
+QuaternionType* QuaternionRotationYawPitchRoll(QuaternionType* out, float yaw, float pitch, float roll)
+{
+    float sinYaw, cosYaw, sinPitch, cosPitch, sinRoll, cosRoll;
+
+    sinYaw = sinf(yaw / 2.0f);
+    cosYaw = cosf(yaw / 2.0f);
+    sinPitch = sinf(pitch / 2.0f);
+    cosPitch = cosf(pitch / 2.0f);
+    sinRoll = sinf(roll / 2.0f);
+    cosRoll = cosf(roll / 2.0f);
+
+    out->x = sinYaw * cosPitch * sinRoll + cosYaw * sinPitch * cosRoll;
+    out->y = sinYaw * cosPitch * cosRoll - cosYaw * sinPitch * sinRoll;
+    out->z = cosYaw * cosPitch * sinRoll - sinYaw * sinPitch * cosRoll;
+    out->w = cosYaw * cosPitch * cosRoll + sinYaw * sinPitch * sinRoll;
+
+    return out;
+}
+
+// Takes the short way round, and goes in a straight line when the two are too close for the angle to be reliable
+QuaternionType* QuaternionSlerp(QuaternionType* out, const QuaternionType* a, const QuaternionType* b, float t)
+{
+    float dot, sign, weightA, weightB, angle;
+
+    sign = 1.0f;
+    dot = QuaternionDot(a, b);
+    if (dot < 0.0f)
+    {
+        sign = -1.0f;
+        dot = -dot;
+    }
+
+    weightA = 1.0f - t;
+    weightB = t;
+    if (1.0f - dot > 0.001f)
+    {
+        angle = acosf(dot);
+        weightA = sinf(angle * weightA) / sinf(angle);
+        weightB = sinf(angle * weightB) / sinf(angle);
+    }
+
+    out->x = weightA * a->x + sign * weightB * b->x;
+    out->y = weightA * a->y + sign * weightB * b->y;
+    out->z = weightA * a->z + sign * weightB * b->z;
+    out->w = weightA * a->w + sign * weightB * b->w;
+
+    return out;
+}
+
+void Vec3TransformCoordArray(Vector3Type* out, const Vector3Type* in, int count, const MatrixType* m)
+{
+#if MATH_SSE
+    __m128 row0, row1, row2, row3, result;
+    float values[4];
+    int i;
+
+    row0 = _mm_loadu_ps(m->m[0]);
+    row1 = _mm_loadu_ps(m->m[1]);
+    row2 = _mm_loadu_ps(m->m[2]);
+    row3 = _mm_loadu_ps(m->m[3]);
+
+    // The rows stay in registers across the whole array
+    for (i = 0; i < count; i++)
+    {
+        result = _mm_mul_ps(_mm_set1_ps(in[i].x), row0);
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(in[i].y), row1));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(in[i].z), row2));
+        result = _mm_add_ps(result, row3);
+        result = _mm_div_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 3, 3, 3)));
+        _mm_storeu_ps(values, result);
+
+        out[i].x = values[0];
+        out[i].y = values[1];
+        out[i].z = values[2];
+    }
+#else
+    int i;
+
+    for (i = 0; i < count; i++)
+        ScalarVec3TransformCoord(&out[i], &in[i], m);
+#endif
+
+    return;
+}
+
+void Vec4TransformArray(Vector4Type* out, const Vector4Type* in, int count, const MatrixType* m)
+{
+    int i;
+
+    i = 0;
+
+#if MATH_AVX
+    __m256 wide0, wide1, wide2, wide3;
+
+    wide0 = _mm256_broadcast_ps((const __m128*)m->m[0]);
+    wide1 = _mm256_broadcast_ps((const __m128*)m->m[1]);
+    wide2 = _mm256_broadcast_ps((const __m128*)m->m[2]);
+    wide3 = _mm256_broadcast_ps((const __m128*)m->m[3]);
+
+    for (; i + 2 <= count; i += 2)
+        _mm256_storeu_ps(&out[i].x, MultiplyRows(_mm256_loadu_ps(&in[i].x), wide0, wide1, wide2, wide3));
+#endif
+
+#if MATH_SSE
+    __m128 row0, row1, row2, row3;
+
+    row0 = _mm_loadu_ps(m->m[0]);
+    row1 = _mm_loadu_ps(m->m[1]);
+    row2 = _mm_loadu_ps(m->m[2]);
+    row3 = _mm_loadu_ps(m->m[3]);
+
+    for (; i < count; i++)
+        _mm_storeu_ps(&out[i].x, MultiplyRow(&in[i].x, row0, row1, row2, row3));
+#else
+    for (; i < count; i++)
+        ScalarVec4Transform(&out[i], &in[i], m);
+#endif
+
+    return;
+}
+
+// out[i] = a[i] * b, the same b for every matrix, like world matrices times one view projection
+void MatrixMultiplyArray(MatrixType* out, const MatrixType* a, int count, const MatrixType* b)
+{
+#if MATH_AVX
+    __m256 wide0, wide1, wide2, wide3;
+    int i;
+
+    wide0 = _mm256_broadcast_ps((const __m128*)b->m[0]);
+    wide1 = _mm256_broadcast_ps((const __m128*)b->m[1]);
+    wide2 = _mm256_broadcast_ps((const __m128*)b->m[2]);
+    wide3 = _mm256_broadcast_ps((const __m128*)b->m[3]);
+
+    // Rows 1 and 2 of a matrix, then rows 3 and 4
+    for (i = 0; i < count; i++)
+    {
+        _mm256_storeu_ps(out[i].m[0], MultiplyRows(_mm256_loadu_ps(a[i].m[0]), wide0, wide1, wide2, wide3));
+        _mm256_storeu_ps(out[i].m[2], MultiplyRows(_mm256_loadu_ps(a[i].m[2]), wide0, wide1, wide2, wide3));
+    }
+#elif MATH_SSE
+    __m128 b0, b1, b2, b3;
+    int i;
+
+    b0 = _mm_loadu_ps(b->m[0]);
+    b1 = _mm_loadu_ps(b->m[1]);
+    b2 = _mm_loadu_ps(b->m[2]);
+    b3 = _mm_loadu_ps(b->m[3]);
+
+    for (i = 0; i < count; i++)
+    {
+        _mm_storeu_ps(out[i].m[0], MultiplyRow(a[i].m[0], b0, b1, b2, b3));
+        _mm_storeu_ps(out[i].m[1], MultiplyRow(a[i].m[1], b0, b1, b2, b3));
+        _mm_storeu_ps(out[i].m[2], MultiplyRow(a[i].m[2], b0, b1, b2, b3));
+        _mm_storeu_ps(out[i].m[3], MultiplyRow(a[i].m[3], b0, b1, b2, b3));
+    }
+#else
+    int i;
+
+    for (i = 0; i < count; i++)
+        ScalarMatrixMultiply(&out[i], &a[i], b);
+#endif
+
+    return;
+}
+
+// Four points a step, each lane does the same sum PlaneDotCoord does
+void PlaneDotCoordArray(float* out, const PlaneType* p, const Vector3Type* points, int count)
+{
+    int i;
+
+    i = 0;
+
+#if MATH_SSE
+    __m128 a, b, c, d, x, y, z, result;
+
+    a = _mm_set1_ps(p->a);
+    b = _mm_set1_ps(p->b);
+    c = _mm_set1_ps(p->c);
+    d = _mm_set1_ps(p->d);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        x = _mm_set_ps(points[i + 3].x, points[i + 2].x, points[i + 1].x, points[i].x);
+        y = _mm_set_ps(points[i + 3].y, points[i + 2].y, points[i + 1].y, points[i].y);
+        z = _mm_set_ps(points[i + 3].z, points[i + 2].z, points[i + 1].z, points[i].z);
+
+        result = _mm_mul_ps(a, x);
+        result = _mm_add_ps(result, _mm_mul_ps(b, y));
+        result = _mm_add_ps(result, _mm_mul_ps(c, z));
+        result = _mm_add_ps(result, d);
+        _mm_storeu_ps(&out[i], result);
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = PlaneDotCoord(p, &points[i]);
+
+    return;
+}
+
+static long long GetNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Repeatable values in [-range, range]
+static float RandomFloat(unsigned int& seed, float range)
+{
+    seed = seed * 1664525 + 1013904223;
+    return ((float)(seed >> 8) / 16777216.0f * 2.0f - 1.0f) * range;
+}
+
+static void RandomMatrix(unsigned int& seed, MatrixType& matrix)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        ((float*)matrix)[i] = RandomFloat(seed, 4.0f);
+
+    // Keep w well away from zero so transformed points divide cleanly
+    matrix._44 = 8.0f + RandomFloat(seed, 1.0f);
+
+    return;
+}
+
+static bool SameBits(const void* a, const void* b, int size)
+{
+    return (memcmp(a, b, size) == 0);
+}
+
+static bool Near(const float* a, const float* b, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (fabsf(a[i] - b[i]) > MATH_TEST_TOLERANCE)
+            return false;
+    }
+
+    return true;
+}
+
+static void Check(ofstream& fout, const char* name, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << name << endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+bool MathClass::RunTests(char* filename)
+{
+    ofstream fout;
+    MatrixType* matrices;
+    MatrixType* products;
+    Vector3Type* points;
+    Vector3Type* transformed;
+    Vector4Type* vectors;
+    Vector4Type* results;
+    float* distances;
+    MatrixType a, b, c, expected, fromQuaternion;
+    Vector3Type eye, at, up, point, single;
+    Vector4Type vector4;
+    PlaneType plane, normalized;
+    QuaternionType q1, q2, q3;
+    unsigned int seed;
+    long long start, singleTime, batchTime, scalarTime;
+    float yaw, pitch, roll, sink;
+    int failures, i, repeat;
+    bool passed;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    matrices = new MatrixType[MATH_BENCH_COUNT];
+    products = new MatrixType[MATH_BENCH_COUNT];
+    points = new Vector3Type[MATH_BENCH_COUNT];
+    transformed = new Vector3Type[MATH_BENCH_COUNT];
+    vectors = new Vector4Type[MATH_BENCH_COUNT];
+    results = new Vector4Type[MATH_BENCH_COUNT];
+    distances = new float[MATH_BENCH_COUNT];
+    if (!matrices || !products || !points || !transformed || !vectors || !results || !distances)
+        return false;
+
+    fout << "SIMD: " << (MATH_AVX ? "AVX" : (MATH_SSE ? "SSE2" : "none")) << endl;
+
+    failures = 0;
+    seed = 1;
+    for (i = 0; i < MATH_BENCH_COUNT; i++)
+    {
+        RandomMatrix(seed, matrices[i]);
+        points[i] = Vector3Type(RandomFloat(seed, 100.0f), RandomFloat(seed, 100.0f), RandomFloat(seed, 100.0f));
+        vectors[i] = Vector4Type(RandomFloat(seed, 10.0f), RandomFloat(seed, 10.0f), RandomFloat(seed, 10.0f), RandomFloat(seed, 10.0f));
+    }
+    RandomMatrix(seed, b);
+
+    // Every SIMD path against the plain code, bit for bit
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT; i++)
+    {
+        MatrixMultiply(&a, &matrices[i], &b);
+        ScalarMatrixMultiply(&expected, &matrices[i], &b);
+        passed = passed && SameBits(&a, &expected, sizeof(MatrixType));
+
+        // In place has to work too
+        a = matrices[i];
+        MatrixMultiply(&a, &a, &b);
+        passed = passed && SameBits(&a, &expected, sizeof(MatrixType));
+    }
+    Check(fout, "MatrixMultiply matches plain code", passed, failures);
+
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT; i++)
+    {
+        MatrixTranspose(&a, &matrices[i]);
+        ScalarMatrixTranspose(&expected, &matrices[i]);
+        passed = passed && SameBits(&a, &expected, sizeof(MatrixType));
+    }
+    Check(fout, "MatrixTranspose matches plain code", passed, failures);
+
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT; i++)
+    {
+        Vec3TransformCoord(&point, &points[i], &matrices[i]);
+        ScalarVec3TransformCoord(&single, &points[i], &matrices[i]);
+        passed = passed && SameBits(&point, &single, sizeof(Vector3Type));
+
+        Vec4Transform(&vector4, &vectors[i], &matrices[i]);
+        ScalarVec4Transform(&results[i], &vectors[i], &matrices[i]);
+        passed = passed && SameBits(&vector4, &results[i], sizeof(Vector4Type));
+    }
+    Check(fout, "Vec3TransformCoord and Vec4Transform match plain code", passed, failures);
+
+    // Batches against the single calls, odd counts to cover the leftovers
+    MatrixMultiplyArray(products, matrices, MATH_TEST_COUNT - 1, &b);
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT - 1; i++)
+    {
+        ScalarMatrixMultiply(&expected, &matrices[i], &b);
+        passed = passed && SameBits(&products[i], &expected, sizeof(MatrixType));
+    }
+    Check(fout, "MatrixMultiplyArray matches single calls", passed, failures);
+
+    Vec3TransformCoordArray(transformed, points, MATH_TEST_COUNT - 1, &b);
+    Vec4TransformArray(results, vectors, MATH_TEST_COUNT - 1, &b);
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT - 1; i++)
+    {
+        ScalarVec3TransformCoord(&single, &points[i], &b);
+        passed = passed && SameBits(&transformed[i], &single, sizeof(Vector3Type));
+        ScalarVec4Transform(&vector4, &vectors[i], &b);
+        passed = passed && SameBits(&results[i], &vector4, sizeof(Vector4Type));
+    }
+    Check(fout, "Vec3TransformCoordArray and Vec4TransformArray match single calls", passed, failures);
+
+    plane = PlaneType(0.3f, -0.5f, 0.8f, 2.5f);
+    PlaneDotCoordArray(distances, &plane, points, MATH_TEST_COUNT - 1);
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT - 1; i++)
+    {
+        sink = PlaneDotCoord(&plane, &points[i]);
+        passed = passed && SameBits(&distances[i], &sink, sizeof(float));
+    }
+    Check(fout, "PlaneDotCoordArray matches single calls", passed, failures);
+
+    // D3DX's results for the matrices the engine builds
+    eye = Vector3Type(0.0f, 0.0f, -10.0f);
+    at = Vector3Type(0.0f, 0.0f, 1.0f);
+    up = Vector3Type(0.0f, 1.0f, 0.0f);
+    MatrixLookAtLH(&a, &eye, &at, &up);
+    MatrixTranslation(&expected, 0.0f, 0.0f, 10.0f);
+    Check(fout, "MatrixLookAtLH down +z is a translation", Near(a, expected, 16), failures);
+
+    eye = Vector3Type(3.0f, 2.0f, -5.0f);
+    at = Vector3Type(-1.0f, 0.5f, 4.0f);
+    MatrixLookAtLH(&a, &eye, &at, &up);
+    Vec3TransformCoord(&point, &eye, &a);
+    Vec3TransformCoord(&single, &at, &a);
+    passed = (fabsf(point.x) < MATH_TEST_TOLERANCE) && (fabsf(point.y) < MATH_TEST_TOLERANCE) && (fabsf(point.z) < MATH_TEST_TOLERANCE);
+    passed = passed && (fabsf(single.x) < MATH_TEST_TOLERANCE) && (fabsf(single.y) < MATH_TEST_TOLERANCE) && (single.z > 0.0f);
+    Check(fout, "MatrixLookAtLH puts the eye at the origin looking down +z", passed, failures);
+
+    MatrixPerspectiveFovLH(&a, MATH_PI / 4.0f, 1280.0f / 720.0f, 0.1f, 1000.0f);
+    expected = MatrixType(1.0f / ((1280.0f / 720.0f) * tanf(MATH_PI / 8.0f)), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f / tanf(MATH_PI / 8.0f), 0.0f, 0.0f,
+        0.0f, 0.0f, 1000.0f / (1000.0f - 0.1f), 1.0f, 0.0f, 0.0f, (1000.0f * 0.1f) / (0.1f - 1000.0f), 0.0f);
+    Check(fout, "MatrixPerspectiveFovLH", SameBits(&a, &expected, sizeof(MatrixType)), failures);
+
+    point = Vector3Type(0.0f, 0.0f, 0.1f);
+    Vec3TransformCoord(&point, &point, &a);
+    single = Vector3Type(0.0f, 0.0f, 1000.0f);
+    Vec3TransformCoord(&single, &single, &a);
+    Check(fout, "MatrixPerspectiveFovLH maps near to 0 and far to 1", (fabsf(point.z) < MATH_TEST_TOLERANCE) && (fabsf(single.z - 1.0f) < MATH_TEST_TOLERANCE), failures);
+
+    MatrixOrthoLH(&a, 1280.0f, 720.0f, 0.1f, 1000.0f);
+    expected = MatrixType(2.0f / 1280.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f / 720.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f / (1000.0f - 0.1f), 0.0f, 0.0f, 0.0f, 0.1f / (0.1f - 1000.0f), 1.0f);
+    Check(fout, "MatrixOrthoLH", SameBits(&a, &expected, sizeof(MatrixType)), failures);
+
+    plane = PlaneType(0.0f, 0.0f, 2.0f, 4.0f);
+    PlaneNormalize(&normalized, &plane);
+    passed = (normalized.a == 0.0f) && (normalized.b == 0.0f) && (normalized.c == 1.0f) && (normalized.d == 2.0f);
+    plane = PlaneType(3.0f, 4.0f, 0.0f, 10.0f);
+    PlaneNormalize(&normalized, &plane);
+    passed = passed && (normalized.a == 3.0f / 5.0f) && (normalized.b == 4.0f / 5.0f) && (normalized.c == 0.0f) && (normalized.d == 10.0f / 5.0f);
+    plane = PlaneType(0.0f, 0.0f, 0.0f, 1.0f);
+    PlaneNormalize(&normalized, &plane);
+    passed = passed && (normalized.a == 0.0f) && (normalized.b == 0.0f) && (normalized.c == 0.0f) && (normalized.d == 0.0f);
+    Check(fout, "PlaneNormalize divides by the normal's length", passed, failures);
+
+    // Quaternions have to agree with the matrices they stand for
+    passed = true;
+    for (i = 0; i < MATH_TEST_COUNT; i++)
+    {
+        yaw = RandomFloat(seed, MATH_PI);
+        pitch = RandomFloat(seed, MATH_PI / 2.0f);
+        roll = RandomFloat(seed, MATH_PI);
+        MatrixRotationYawPitchRoll(&expected, yaw, pitch, roll);
+        QuaternionRotationYawPitchRoll(&q1, yaw, pitch, roll);
+        MatrixRotationQuaternion(&fromQuaternion, &q1);
+        passed = passed && Near(fromQuaternion, expected, 16);
+
+        QuaternionRotationYawPitchRoll(&q2, pitch, roll, yaw);
+        QuaternionMultiply(&q3, &q1, &q2);
+        MatrixRotationQuaternion(&a, &q2);
+        MatrixMultiply(&c, &fromQuaternion, &a);
+        MatrixRotationQuaternion(&a, &q3);
+        passed = passed && Near(a, c, 16);
+    }
+    Check(fout, "Quaternions match their rotation matrices and multiply in the same order", passed, failures);
+
+    QuaternionRotationYawPitchRoll(&q1, 0.2f, 0.1f, 0.0f);
+    QuaternionRotationYawPitchRoll(&q2, 1.7f, -0.4f, 0.3f);
+    QuaternionSlerp(&q3, &q1, &q2, 0.0f);
+    passed = Near(&q3.x, &q1.x, 4);
+    QuaternionSlerp(&q3, &q1, &q2, 1.0f);
+    passed = passed && Near(&q3.x, &q2.x, 4);
+    QuaternionSlerp(&q3, &q1, &q2, 0.5f);
+    passed = passed && (fabsf(QuaternionDot(&q3, &q3) - 1.0f) < MATH_TEST_TOLERANCE) && (fabsf(QuaternionDot(&q3, &q1) - QuaternionDot(&q3, &q2)) < MATH_TEST_TOLERANCE);
+    Check(fout, "QuaternionSlerp ends on its inputs and stays unit length half way", passed, failures);
+
+    // Nanoseconds per element, best of the repeats
+    fout << endl << "ns per element    plain    single     batch" << endl;
+    fout.setf(ios::fixed);
+    fout.precision(2);
+    sink = 0.0f;
+
+    scalarTime = singleTime = batchTime = 0x7fffffffffffffffLL;
+    for (repeat = 0; repeat < MATH_BENCH_REPEATS; repeat++)
+    {
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            ScalarMatrixMultiply(&products[i], &matrices[i], &b);
+        scalarTime = min(scalarTime, GetNanoseconds() - start);
+        sink += products[repeat]._11;
+
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            MatrixMultiply(&products[i], &matrices[i], &b);
+        singleTime = min(singleTime, GetNanoseconds() - start);
+        sink += products[repeat]._11;
+
+        start = GetNanoseconds();
+        MatrixMultiplyArray(products, matrices, MATH_BENCH_COUNT, &b);
+        batchTime = min(batchTime, GetNanoseconds() - start);
+        sink += products[repeat]._11;
+    }
+    fout << "MatrixMultiply    " << (double)scalarTime / MATH_BENCH_COUNT << "    " << (double)singleTime / MATH_BENCH_COUNT << "    " << (double)batchTime / MATH_BENCH_COUNT << endl;
+
+    scalarTime = singleTime = batchTime = 0x7fffffffffffffffLL;
+    for (repeat = 0; repeat < MATH_BENCH_REPEATS; repeat++)
+    {
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            ScalarVec3TransformCoord(&transformed[i], &points[i], &b);
+        scalarTime = min(scalarTime, GetNanoseconds() - start);
+        sink += transformed[repeat].x;
+
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            Vec3TransformCoord(&transformed[i], &points[i], &b);
+        singleTime = min(singleTime, GetNanoseconds() - start);
+        sink += transformed[repeat].x;
+
+        start = GetNanoseconds();
+        Vec3TransformCoordArray(transformed, points, MATH_BENCH_COUNT, &b);
+        batchTime = min(batchTime, GetNanoseconds() - start);
+        sink += transformed[repeat].x;
+    }
+    fout << "Vec3TransformCoord    " << (double)scalarTime / MATH_BENCH_COUNT << "    " << (double)singleTime / MATH_BENCH_COUNT << "    " << (double)batchTime / MATH_BENCH_COUNT << endl;
+
+    scalarTime = singleTime = batchTime = 0x7fffffffffffffffLL;
+    for (repeat = 0; repeat < MATH_BENCH_REPEATS; repeat++)
+    {
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            ScalarVec4Transform(&results[i], &vectors[i], &b);
+        scalarTime = min(scalarTime, GetNanoseconds() - start);
+        sink += results[repeat].x;
+
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            Vec4Transform(&results[i], &vectors[i], &b);
+        singleTime = min(singleTime, GetNanoseconds() - start);
+        sink += results[repeat].x;
+
+        start = GetNanoseconds();
+        Vec4TransformArray(results, vectors, MATH_BENCH_COUNT, &b);
+        batchTime = min(batchTime, GetNanoseconds() - start);
+        sink += results[repeat].x;
+    }
+    fout << "Vec4Transform    " << (double)scalarTime / MATH_BENCH_COUNT << "    " << (double)singleTime / MATH_BENCH_COUNT << "    " << (double)batchTime / MATH_BENCH_COUNT << endl;
+
+    // The single call is already the plain code
+    singleTime = batchTime = 0x7fffffffffffffffLL;
+    for (repeat = 0; repeat < MATH_BENCH_REPEATS; repeat++)
+    {
+        start = GetNanoseconds();
+        for (i = 0; i < MATH_BENCH_COUNT; i++)
+            distances[i] = PlaneDotCoord(&plane, &points[i]);
+        singleTime = min(singleTime, GetNanoseconds() - start);
+        sink += distances[repeat];
+
+        start = GetNanoseconds();
+        PlaneDotCoordArray(distances, &plane, points, MATH_BENCH_COUNT);
+        batchTime = min(batchTime, GetNanoseconds() - start);
+        sink += distances[repeat];
+    }
+    fout << "PlaneDotCoord    " << (double)singleTime / MATH_BENCH_COUNT << "    " << (double)singleTime / MATH_BENCH_COUNT << "    " << (double)batchTime / MATH_BENCH_COUNT << endl;
+
+    // Printed so the timed loops can't be thrown away
+    fout << endl << failures << " failures, checksum " << sink << endl;
+    fout.close();
+
+    printf("%d math test failures, results in %s\n", failures, filename);
+
+    delete[] distances;
+    delete[] results;
+    delete[] vectors;
+    delete[] transformed;
+    delete[] points;
+    delete[] products;
+    delete[] matrices;
+
+    return (failures == 0);
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <math.h>
+#include <string.h>
+
+// SSE2 is on for every x64 build and 32 bit builds with /arch:SSE2, AVX only
+// when the compiler is allowed to use it. MATH_NO_SIMD builds the plain C
+// versions everywhere.
+#if !defined(MATH_NO_SIMD) && (defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__))
+#define MATH_SSE 1
+#include <emmintrin.h>
+#else
+#define MATH_SSE 0
+#endif
+
+#if MATH_SSE && defined(__AVX__)
+#define MATH_AVX 1
+#include <immintrin.h>
+#else
+#define MATH_AVX 0
+#endif
+
+const float MATH_PI = 3.141592654f;
+
+struct Vector2Type
+{
+    float x, y;
+
+    Vector2Type() {}
+    Vector2Type(float vx, float vy) : x(vx), y(vy) {}
+};
+
+struct Vector3Type
+{
+    float x, y, z;
+
+    Vector3Type() {}
+    Vector3Type(float vx, float vy, float vz) : x(vx), y(vy), z(vz) {}
+
+    Vector3Type operator+(const Vector3Type& v) const { return Vector3Type(x + v.x, y + v.y, z + v.z); }
+    Vector3Type operator-(const Vector3Type& v) const { return Vector3Type(x - v.x, y - v.y, z - v.z); }
+    Vector3Type operator-() const { return Vector3Type(-x, -y, -z); }
+    Vector3Type operator*(float s) const { return Vector3Type(x * s, y * s, z * s); }
+    Vector3Type operator/(float s) const { return Vector3Type(x / s, y / s, z / s); }
+    Vector3Type& operator+=(const Vector3Type& v) { x += v.x; y += v.y; z += v.z; return *this; }
+    Vector3Type& operator-=(const Vector3Type& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    Vector3Type& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+};
+
+struct Vector4Type
+{
+    float x, y, z, w;
+
+    Vector4Type() {}
+    Vector4Type(float vx, float vy, float vz, float vw) : x(vx), y(vy), z(vz), w(vw) {}
+
+    Vector4Type operator+(const Vector4Type& v) const { return Vector4Type(x + v.x, y + v.y, z + v.z, w + v.w); }
+    Vector4Type operator-(const Vector4Type& v) const { return Vector4Type(x - v.x, y - v.y, z - v.z, w - v.w); }
+    Vector4Type operator*(float s) const { return Vector4Type(x * s, y * s, z * s, w * s); }
+};
+
+// ax + by + cz + d = 0, the normal points to the side Dot is positive on
+struct PlaneType
+{
+    float a, b, c, d;
+
+    PlaneType() {}
+    PlaneType(float pa, float pb, float pc, float pd) : a(pa), b(pb), c(pc), d(pd) {}
+};
+
+struct QuaternionType
+{
+    float x, y, z, w;
+
+    QuaternionType() {}
+    QuaternionType(float qx, float qy, float qz, float qw) : x(qx), y(qy), z(qz), w(qw) {}
+};
+
+// Row major and used with row vectors, v * world * view * projection, laid out
+// like D3DXMATRIX so existing buffers and _11 style access keep working
+struct MatrixType
+{
+    union
+    {
+        struct
+        {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+            float _41, _42, _43, _44;
+        };
+        float m[4][4];
+    };
+
+    MatrixType() {}
+    MatrixType(float m11, float m12, float m13, float m14, float m21, float m22, float m23, float m24,
+        float m31, float m32, float m33, float m34, float m41, float m42, float m43, float m44) :
+        _11(m11), _12(m12), _13(m13), _14(m14), _21(m21), _22(m22), _23(m23), _24(m24),
+        _31(m31), _32(m32), _33(m33), _34(m34), _41(m41), _42(m42), _43(m43), _44(m44) {}
+
+    operator float*() { return &_11; }
+    operator const float*() const { return &_11; }
+};
+
+// The functions take and return pointers like their D3DX namesakes, the
+// output may be one of the inputs. Results match D3DX's formulas operation
+// for operation, and the SIMD versions do the same multiplies and adds in the
+// same order as the plain ones, so every path gives the same bits as long as
+// the compiler isn't allowed to fuse a multiply and an add.
+float Vec3Dot(const Vector3Type*, const Vector3Type*);
+Vector3Type* Vec3Cross(Vector3Type*, const Vector3Type*, const Vector3Type*);
+float Vec3Length(const Vector3Type*);
+Vector3Type* Vec3Normalize(Vector3Type*, const Vector3Type*);
+Vector3Type* Vec3TransformCoord(Vector3Type*, const Vector3Type*, const MatrixType*);
+Vector3Type* Vec3TransformNormal(Vector3Type*, const Vector3Type*, const MatrixType*);
+Vector4Type* Vec4Transform(Vector4Type*, const Vector4Type*, const MatrixType*);
+
+MatrixType* MatrixIdentity(MatrixType*);
+MatrixType* MatrixMultiply(MatrixType*, const MatrixType*, const MatrixType*);
+MatrixType* MatrixTranspose(MatrixType*, const MatrixType*);
+MatrixType* MatrixTranslation(MatrixType*, float, float, float);
+MatrixType* MatrixScaling(MatrixType*, float, float, float);
+MatrixType* MatrixRotationX(MatrixType*, float);
+MatrixType* MatrixRotationY(MatrixType*, float);
+MatrixType* MatrixRotationZ(MatrixType*, float);
+MatrixType* MatrixRotationYawPitchRoll(MatrixType*, float, float, float);
+MatrixType* MatrixRotationQuaternion(MatrixType*, const QuaternionType*);
+MatrixType* MatrixLookAtLH(MatrixType*, const Vector3Type*, const Vector3Type*, const Vector3Type*);
+MatrixType* MatrixPerspectiveFovLH(MatrixType*, float, float, float, float);
+MatrixType* MatrixOrthoLH(MatrixType*, float, float, float, float);
+
+PlaneType* PlaneNormalize(PlaneType*, const PlaneType*);
+float PlaneDotCoord(const PlaneType*, const Vector3Type*);
+float PlaneDotCoord(const PlaneType*, const Vector3Type&);
+
+QuaternionType* QuaternionIdentity(QuaternionType*);
+float QuaternionDot(const QuaternionType*, const QuaternionType*);
+QuaternionType* QuaternionNormalize(QuaternionType*, const QuaternionType*);
+QuaternionType* QuaternionMultiply(QuaternionType*, const QuaternionType*, const QuaternionType*);
+QuaternionType* QuaternionRotationYawPitchRoll(QuaternionType*, float, float, float);
+QuaternionType* QuaternionSlerp(QuaternionType*, const QuaternionType*, const QuaternionType*, float);
+
+// Batches, each element gives the same result as the single function. With
+// AVX the matrix and vector 4 batches do two at a time.
+void Vec3TransformCoordArray(Vector3Type*, const Vector3Type*, int, const MatrixType*);
+void Vec4TransformArray(Vector4Type*, const Vector4Type*, int, const MatrixType*);
+void MatrixMultiplyArray(MatrixType*, const MatrixType*, int, const MatrixType*);
+void PlaneDotCoordArray(float*, const PlaneType*, const Vector3Type*, int);
+
+// Four floats worked on together, for code that does the same thing to four
+// pixels or four channels at once. They live in SSE registers when MATH_SSE
+// and in plain arrays otherwise, and each function gives the same bits either
+// way. Comparisons return all ones or all zeros per lane, like SSE does.
+#if MATH_SSE
+typedef __m128 Float4Type;
+typedef __m128i Int4Type;
+#else
+struct Float4Type
+{
+    float v[4];
+};
+
+struct Int4Type
+{
+    int v[4];
+};
+#endif
+
+#if MATH_SSE
+inline Float4Type Float4Zero() { return _mm_setzero_ps(); }
+inline Float4Type Float4Splat(float value) { return _mm_set1_ps(value); }
+inline Float4Type Float4Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline Float4Type Float4Load(const float* values) { return _mm_loadu_ps(values); }
+inline void Float4Store(float* values, Float4Type a) { _mm_storeu_ps(values, a); }
+inline float Float4GetX(Float4Type a) { return _mm_cvtss_f32(a); }
+
+inline Float4Type Float4Add(Float4Type a, Float4Type b) { return _mm_add_ps(a, b); }
+inline Float4Type Float4Sub(Float4Type a, Float4Type b) { return _mm_sub_ps(a, b); }
+inline Float4Type Float4Mul(Float4Type a, Float4Type b) { return _mm_mul_ps(a, b); }
+inline Float4Type Float4Div(Float4Type a, Float4Type b) { return _mm_div_ps(a, b); }
+inline Float4Type Float4Min(Float4Type a, Float4Type b) { return _mm_min_ps(a, b); }
+inline Float4Type Float4Max(Float4Type a, Float4Type b) { return _mm_max_ps(a, b); }
+
+inline Float4Type Float4Less(Float4Type a, Float4Type b) { return _mm_cmplt_ps(a, b); }
+inline Float4Type Float4Greater(Float4Type a, Float4Type b) { return _mm_cmpgt_ps(a, b); }
+inline Float4Type Float4Equal(Float4Type a, Float4Type b) { return _mm_cmpeq_ps(a, b); }
+inline Float4Type Float4NotEqual(Float4Type a, Float4Type b) { return _mm_cmpneq_ps(a, b); }
+inline Float4Type Float4And(Float4Type a, Float4Type b) { return _mm_and_ps(a, b); }
+inline Float4Type Float4Or(Float4Type a, Float4Type b) { return _mm_or_ps(a, b); }
+inline Float4Type Float4AndNot(Float4Type a, Float4Type b) { return _mm_andnot_ps(a, b); }
+inline int Float4MoveMask(Float4Type a) { return _mm_movemask_ps(a); }
+
+template <int x, int y, int z, int w> inline Float4Type Float4Swizzle(Float4Type a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x)); }
+
+inline Int4Type Float4ToInt(Float4Type a) { return _mm_cvttps_epi32(a); }
+inline Float4Type Int4ToFloat(Int4Type a) { return _mm_cvtepi32_ps(a); }
+inline Int4Type Float4AsInt(Float4Type a) { return _mm_castps_si128(a); }
+inline Float4Type Int4AsFloat(Int4Type a) { return _mm_castsi128_ps(a); }
+
+inline Int4Type Int4Splat(int value) { return _mm_set1_epi32(value); }
+inline Int4Type Int4Set(int x, int y, int z, int w) { return _mm_setr_epi32(x, y, z, w); }
+inline Int4Type Int4Load(const void* values) { return _mm_loadu_si128((const __m128i*)values); }
+inline void Int4Store(void* values, Int4Type a) { _mm_storeu_si128((__m128i*)values, a); }
+inline Int4Type Int4And(Int4Type a, Int4Type b) { return _mm_and_si128(a, b); }
+inline Int4Type Int4Or(Int4Type a, Int4Type b) { return _mm_or_si128(a, b); }
+inline Int4Type Int4ShiftLeft(Int4Type a, int count) { return _mm_sll_epi32(a, _mm_cvtsi32_si128(count)); }
+inline Int4Type Int4ShiftRight(Int4Type a, int count) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(count)); }
+#else
+inline unsigned int Float4Bits(float value) { unsigned int bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+inline float Float4FromBits(unsigned int bits) { float value; memcpy(&value, &bits, sizeof(value)); return value; }
+inline float Float4Mask(bool value) { return Float4FromBits(value ? 0xffffffffu : 0u); }
+
+inline Float4Type Float4Set(float x, float y, float z, float w) { Float4Type r = { { x, y, z, w } }; return r; }
+inline Float4Type Float4Zero() { return Float4Set(0.0f, 0.0f, 0.0f, 0.0f); }
+inline Float4Type Float4Splat(float value) { return Float4Set(value, value, value, value); }
+inline Float4Type Float4Load(const float* values) { return Float4Set(values[0], values[1], values[2], values[3]); }
+inline void Float4Store(float* values, Float4Type a) { memcpy(values, a.v, sizeof(a.v)); }
+inline float Float4GetX(Float4Type a) { return a.v[0]; }
+
+inline Float4Type Float4Add(Float4Type a, Float4Type b) { return Float4Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+inline Float4Type Float4Sub(Float4Type a, Float4Type b) { return Float4Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+inline Float4Type Float4Mul(Float4Type a, Float4Type b) { return Float4Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+inline Float4Type Float4Div(Float4Type a, Float4Type b) { return Float4Set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]); }
+
+// Same operand order as minps and maxps, the second one wins on NaN
+inline Float4Type Float4Min(Float4Type a, Float4Type b)
+{
+    return Float4Set(a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]);
+}
+
+inline Float4Type Float4Max(Float4Type a, Float4Type b)
+{
+    return Float4Set(a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1], a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]);
+}
+
+inline Float4Type Float4Less(Float4Type a, Float4Type b)
+{
+    return Float4Set(Float4Mask(a.v[0] < b.v[0]), Float4Mask(a.v[1] < b.v[1]), Float4Mask(a.v[2] < b.v[2]), Float4Mask(a.v[3] < b.v[3]));
+}
+
+inline Float4Type Float4Greater(Float4Type a, Float4Type b) { return Float4Less(b, a); }
+
+inline Float4Type Float4Equal(Float4Type a, Float4Type b)
+{
+    return Float4Set(Float4Mask(a.v[0] == b.v[0]), Float4Mask(a.v[1] == b.v[1]), Float4Mask(a.v[2] == b.v[2]), Float4Mask(a.v[3] == b.v[3]));
+}
+
+inline Float4Type Float4NotEqual(Float4Type a, Float4Type b)
+{
+    return Float4Set(Float4Mask(a.v[0] != b.v[0]), Float4Mask(a.v[1] != b.v[1]), Float4Mask(a.v[2] != b.v[2]), Float4Mask(a.v[3] != b.v[3]));
+}
+
+inline Float4Type Float4And(Float4Type a, Float4Type b)
+{
+    Float4Type result;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        result.v[i] = Float4FromBits(Float4Bits(a.v[i]) & Float4Bits(b.v[i]));
+
+    return result;
+}
+
+inline Float4Type Float4Or(Float4Type a, Float4Type b)
+{
+    Float4Type result;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        result.v[i] = Float4FromBits(Float4Bits(a.v[i]) | Float4Bits(b.v[i]));
+
+    return result;
+}
+
+// Not a and b, the operand order of andnps
+inline Float4Type Float4AndNot(Float4Type a, Float4Type b)
+{
+    Float4Type result;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        result.v[i] = Float4FromBits(~Float4Bits(a.v[i]) & Float4Bits(b.v[i]));
+
+    return result;
+}
+
+inline int Float4MoveMask(Float4Type a)
+{
+    return (int)((Float4Bits(a.v[0]) >> 31) | ((Float4Bits(a.v[1]) >> 31) << 1) | ((Float4Bits(a.v[2]) >> 31) << 2) | ((Float4Bits(a.v[3]) >> 31) << 3));
+}
+
+template <int x, int y, int z, int w> inline Float4Type Float4Swizzle(Float4Type a) { return Float4Set(a.v[x], a.v[y], a.v[z], a.v[w]); }
+
+// Truncates, anything out of range or NaN gives 0x80000000 like cvttps2dq
+inline int Float4Truncate(float value) { return ((value >= -2147483648.0f) && (value < 2147483648.0f)) ? (int)value : (int)0x80000000u; }
+
+inline Int4Type Int4Set(int x, int y, int z, int w) { Int4Type r = { { x, y, z, w } }; return r; }
+inline Int4Type Float4ToInt(Float4Type a) { return Int4Set(Float4Truncate(a.v[0]), Float4Truncate(a.v[1]), Float4Truncate(a.v[2]), Float4Truncate(a.v[3])); }
+inline Float4Type Int4ToFloat(Int4Type a) { return Float4Set((float)a.v[0], (float)a.v[1], (float)a.v[2], (float)a.v[3]); }
+inline Int4Type Float4AsInt(Float4Type a) { Int4Type r; memcpy(r.v, a.v, sizeof(r.v)); return r; }
+inline Float4Type Int4AsFloat(Int4Type a) { Float4Type r; memcpy(r.v, a.v, sizeof(r.v)); return r; }
+
+inline Int4Type Int4Splat(int value) { return Int4Set(value, value, value, value); }
+inline Int4Type Int4Load(const void* values) { Int4Type r; memcpy(r.v, values, sizeof(r.v)); return r; }
+inline void Int4Store(void* values, Int4Type a) { memcpy(values, a.v, sizeof(a.v)); }
+inline Int4Type Int4And(Int4Type a, Int4Type b) { return Int4Set(a.v[0] & b.v[0], a.v[1] & b.v[1], a.v[2] & b.v[2], a.v[3] & b.v[3]); }
+inline Int4Type Int4Or(Int4Type a, Int4Type b) { return Int4Set(a.v[0] | b.v[0], a.v[1] | b.v[1], a.v[2] | b.v[2], a.v[3] | b.v[3]); }
+
+inline Int4Type Int4ShiftLeft(Int4Type a, int count)
+{
+    return Int4Set((int)((unsigned int)a.v[0] << count), (int)((unsigned int)a.v[1] << count), (int)((unsigned int)a.v[2] << count), (int)((unsigned int)a.v[3] << count));
+}
+
+inline Int4Type Int4ShiftRight(Int4Type a, int count)
+{
+    return Int4Set((int)((unsigned int)a.v[0] >> count), (int)((unsigned int)a.v[1] >> count), (int)((unsigned int)a.v[2] >> count), (int)((unsigned int)a.v[3] >> count));
+}
+#endif
+
+// Checks every SIMD path against the plain one bit for bit, D3DX's results
+// for the camera matrices, and the quaternions against the matrices, then
+// times single calls against the batches. Writes the report to the file.
+class MathClass
+{
+public:
+    static bool RunTests(char*);
+};
\ No newline at end of file
@@ -20,7 +20,7 @@ ModelClass::~ModelClass()
 
 }
 
-bool ModelClass::Initialize(ID3D11Device* device, WCHAR* textureFilename, char* modelFilename)
+bool ModelClass::Initialize(RenderDeviceClass* device, wchar_t* textureFilename, char* modelFilename)
 {
     bool result;
 
@@ -39,6 +39,26 @@ bool ModelClass::Initialize(ID3D11Device* device, WCHAR* textureFilename, char*
     return true;
 }
 
+// Same as above with the texture streamed in as it is needed
+bool ModelClass::Initialize(RenderDeviceClass* device, TextureStreamerClass* streamer, wchar_t* textureFilename, char* modelFilename)
+{
+    bool result;
+
+    result = LoadModel(modelFilename);
+    if (!result)
+        return false;
+
+    result = InitializeBuffers(device);
+    if (!result)
+        return false;
+
+	result = LoadTexture(streamer, textureFilename);
+	if (!result)
+		return false;
+
+    return true;
+}
+
 void ModelClass::Shutdown()
 {
 	ReleaseTexture();
@@ -47,7 +67,7 @@ void ModelClass::Shutdown()
     return;
 }
 
-void ModelClass::Render(ID3D11DeviceContext* deviceContext)
+void ModelClass::Render(RenderContextClass* deviceContext)
 {
     RenderBuffers(deviceContext);
     return;
@@ -58,70 +78,49 @@ int ModelClass::GetIndexCount()
     return m_indexCount;
 }
 
-ID3D11ShaderResourceView* ModelClass::GetTexture()
+RenderTexture* ModelClass::GetTexture()
 {
 	return m_Texture->GetTexture();
 }
 
-bool ModelClass::InitializeBuffers(ID3D11Device* device)
+void ModelClass::RequestTextureSize(float pixels)
+{
+	m_Texture->RequestSize(pixels);
+	return;
+}
+
+bool ModelClass::InitializeBuffers(RenderDeviceClass* device)
 {
     VertexType* vertices;
-    unsigned long* indices;
-    D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-    D3D11_SUBRESOURCE_DATA vertexData, indexData;
-    HRESULT result;
+    unsigned int* indices;
     int i;
 
     // Create both vertex and index arrays
     vertices = new VertexType[m_vertexCount];
     if (!vertices)
         return false;
-    indices = new unsigned long[m_indexCount];
+    indices = new unsigned int[m_indexCount];
     if (!indices)
         return false;
 
     // Load vertex and index array with data
     for (i = 0; i < m_vertexCount; i++)
     {
-        vertices[i].position = D3DXVECTOR3(m_model[i].x, m_model[i].y, m_model[i].z);
-        vertices[i].texture = D3DXVECTOR2(m_model[i].tu, m_model[i].tv);
-        vertices[i].normal = D3DXVECTOR3(m_model[i].nx, m_model[i].ny, m_model[i].nz);
+        vertices[i].position = Vector3Type(m_model[i].x, m_model[i].y, m_model[i].z);
+        vertices[i].texture = Vector2Type(m_model[i].tu, m_model[i].tv);
+        vertices[i].normal = Vector3Type(m_model[i].nx, m_model[i].ny, m_model[i].nz);
 
         indices[i] = i;
     }
 
-    // Setup static vertex buffer description
-    vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = 0;
-    vertexBufferDesc.MiscFlags = 0;
-    vertexBufferDesc.StructureByteStride = 0;
-
-    vertexData.pSysMem = vertices;
-    vertexData.SysMemPitch = 0;
-    vertexData.SysMemSlicePitch = 0;
-
-    // Create vertex buffer
-    result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
-    if (FAILED(result))
+    // Create static vertex buffer
+    m_vertexBuffer = device->CreateBuffer(RENDER_BUFFER_VERTEX, sizeof(VertexType) * m_vertexCount, false, vertices);
+    if (!m_vertexBuffer)
         return false;
 
-    // Setup static index buffer description
-    indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-    indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    indexBufferDesc.CPUAccessFlags = 0;
-    indexBufferDesc.MiscFlags = 0;
-    indexBufferDesc.StructureByteStride = 0;
-
-    indexData.pSysMem = indices;
-    indexData.SysMemPitch = 0;
-    indexData.SysMemSlicePitch = 0;
-
-    // Create index buffer
-    result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-    if (FAILED(result))
+    // Create static index buffer
+    m_indexBuffer = device->CreateBuffer(RENDER_BUFFER_INDEX, sizeof(unsigned int) * m_indexCount, false, indices);
+    if (!m_indexBuffer)
         return false;
 
     delete[] vertices;
@@ -148,27 +147,18 @@ void ModelClass::ShutdownBuffers()
     return;
 }
 
-void ModelClass::RenderBuffers(ID3D11DeviceContext* deviceContext)
+void ModelClass::RenderBuffers(RenderContextClass* deviceContext)
 {
-    unsigned int stride;
-    unsigned int offset;
-
-    stride = sizeof(VertexType);
-    offset = 0;
-
     // Set vertex buffer to active in the input assembler so it can be rendered
-    deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+    deviceContext->SetVertexBuffer(m_vertexBuffer, sizeof(VertexType));
 
     // Set index buffer to active in the input assembler so it can be rendered
-    deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-
-    // Set type of primitive that should be rendered from this vertex buffer
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext->SetIndexBuffer(m_indexBuffer);
 
     return;
 }
 
-bool ModelClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
+bool ModelClass::LoadTexture(RenderDeviceClass* device, wchar_t* filename)
 {
 	bool result;
 
@@ -183,6 +173,21 @@ bool ModelClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
 	return true;
 }
 
+bool ModelClass::LoadTexture(TextureStreamerClass* streamer, wchar_t* filename)
+{
+	bool result;
+
+	m_Texture = new TextureClass;
+	if (!m_Texture)
+		return false;
+
+	result = m_Texture->Initialize(streamer, filename);
+	if (!result)
+		return false;
+
+	return true;
+}
+
 void ModelClass::ReleaseTexture()
 {
 	if (m_Texture)
@@ -1,8 +1,8 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dx10math.h>
+#include "mathclass.h"
 
+#include "renderdeviceclass.h"
 #include "textureclass.h"
 
 #include <fstream>
@@ -13,9 +13,9 @@ class ModelClass
 private:
 	struct VertexType
 	{
-		D3DXVECTOR3 position;
-		D3DXVECTOR2 texture;
-		D3DXVECTOR3 normal;
+		Vector3Type position;
+		Vector2Type texture;
+		Vector3Type normal;
 	};
 
     struct ModelType
@@ -30,27 +30,30 @@ public:
     ModelClass(const ModelClass&);
     ~ModelClass();
 
-    bool Initialize(ID3D11Device*,WCHAR*, char*);
+    bool Initialize(RenderDeviceClass*, wchar_t*, char*);
+    bool Initialize(RenderDeviceClass*, TextureStreamerClass*, wchar_t*, char*);
     void Shutdown();
-    void Render(ID3D11DeviceContext*);
+    void Render(RenderContextClass*);
 
     int GetIndexCount();
 
-	ID3D11ShaderResourceView* GetTexture();
+	RenderTexture* GetTexture();
+	void RequestTextureSize(float);
 
 private:
-    bool InitializeBuffers(ID3D11Device*);
+    bool InitializeBuffers(RenderDeviceClass*);
     void ShutdownBuffers();
-    void RenderBuffers(ID3D11DeviceContext*);
+    void RenderBuffers(RenderContextClass*);
 
-	bool LoadTexture(ID3D11Device*, WCHAR*);
+	bool LoadTexture(RenderDeviceClass*, wchar_t*);
+	bool LoadTexture(TextureStreamerClass*, wchar_t*);
 	void ReleaseTexture();
 
     bool LoadModel(char*);
     void ReleaseModel();
 
 private:
-    ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
+    RenderBuffer *m_vertexBuffer, *m_indexBuffer;
     int m_vertexCount, m_indexCount;
 
 	TextureClass* m_Texture;
@@ -2,7 +2,8 @@
 
 ModelListClass::ModelListClass()
 {
-    m_ModelInfoList = 0;
+    m_colors = 0;
+    m_transforms = 0;
 }
 
 ModelListClass::ModelListClass(const ModelListClass& other)
@@ -16,18 +17,38 @@ ModelListClass::~ModelListClass()
 }
 
 bool ModelListClass::Initialize(int numModels)
+{
+    return Initialize(numModels, (unsigned int)time(NULL));
+}
+
+// The same seed always gives the same models, which benchmarks rely on
+bool ModelListClass::Initialize(int numModels, unsigned int seed)
 {
     int i;
     float red, green, blue;
 
     m_modelCount = numModels;
 
-    // Create list array of model info
-    m_ModelInfoList = new ModelInfoType[m_modelCount];
-    if (!m_ModelInfoList)
+    // Create list array of model colors
+    m_colors = new Vector4Type[m_modelCount];
+    if (!m_colors)
         return false;
 
-    srand((unsigned int)time(NULL));
+    // Create the transform arrays
+    m_transforms = new float[8 * m_modelCount];
+    if (!m_transforms)
+        return false;
+
+    m_transformArrays.positionX = m_transforms;
+    m_transformArrays.positionY = m_transforms + m_modelCount;
+    m_transformArrays.positionZ = m_transforms + 2 * m_modelCount;
+    m_transformArrays.rotationX = m_transforms + 3 * m_modelCount;
+    m_transformArrays.rotationY = m_transforms + 4 * m_modelCount;
+    m_transformArrays.rotationZ = m_transforms + 5 * m_modelCount;
+    m_transformArrays.rotationW = m_transforms + 6 * m_modelCount;
+    m_transformArrays.scale = m_transforms + 7 * m_modelCount;
+
+    srand(seed);
 
     // Randomly generate model color and position
     for (i = 0; i < m_modelCount; i++)
@@ -37,12 +58,19 @@ bool ModelListClass::Initialize(int numModels)
         green = (float)rand() / RAND_MAX;
         blue = (float)rand() / RAND_MAX;
 
-        m_ModelInfoList[i].color = D3DXVECTOR4(red, green, blue, 1.0f);
+        m_colors[i] = Vector4Type(red, green, blue, 1.0f);
 
         // Position
-        m_ModelInfoList[i].positionX = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
-        m_ModelInfoList[i].positionY = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
-        m_ModelInfoList[i].positionZ = ((((float)rand() - (float)rand()) / RAND_MAX) * 10.0f) + 5.0f;
+        m_transforms[i] = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
+        m_transforms[m_modelCount + i] = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
+        m_transforms[2 * m_modelCount + i] = ((((float)rand() - (float)rand()) / RAND_MAX) * 10.0f) + 5.0f;
+
+        // Unrotated and unscaled
+        m_transforms[3 * m_modelCount + i] = 0.0f;
+        m_transforms[4 * m_modelCount + i] = 0.0f;
+        m_transforms[5 * m_modelCount + i] = 0.0f;
+        m_transforms[6 * m_modelCount + i] = 1.0f;
+        m_transforms[7 * m_modelCount + i] = 1.0f;
     }
 
     return true;
@@ -50,10 +78,16 @@ bool ModelListClass::Initialize(int numModels)
 
 void ModelListClass::Shutdown()
 {
-    if (m_ModelInfoList)
+    if (m_transforms)
     {
-        delete[] m_ModelInfoList;
-        m_ModelInfoList = 0;
+        delete[] m_transforms;
+        m_transforms = 0;
+    }
+
+    if (m_colors)
+    {
+        delete[] m_colors;
+        m_colors = 0;
     }
 
     return;
@@ -64,13 +98,18 @@ int ModelListClass::GetModelCount()
     return m_modelCount;
 }
 
-void ModelListClass::GetData(int index, float& positionX, float& positionY, float& positionZ, D3DXVECTOR4& color)
+void ModelListClass::GetData(int index, float& positionX, float& positionY, float& positionZ, Vector4Type& color)
 {
-    positionX = m_ModelInfoList[index].positionX;
-    positionY = m_ModelInfoList[index].positionY;
-    positionZ = m_ModelInfoList[index].positionZ;
+    positionX = m_transformArrays.positionX[index];
+    positionY = m_transformArrays.positionY[index];
+    positionZ = m_transformArrays.positionZ[index];
 
-    color = m_ModelInfoList[index].color;
+    color = m_colors[index];
 
     return;
+}
+
+InstanceTransformsType ModelListClass::GetTransforms()
+{
+    return m_transformArrays;
 }
\ No newline at end of file
@@ -1,30 +1,30 @@
 #pragma once
 
-#include <d3dx10math.h>
+#include "mathclass.h"
+#include "instancetransformclass.h"
 #include <stdlib.h>
 #include <time.h>
 
 class ModelListClass
 {
-private:
-    struct ModelInfoType
-    {
-        D3DXVECTOR4 color;
-        float positionX, positionY, positionZ;
-    };
-
 public:
     ModelListClass();
     ModelListClass(const ModelListClass&);
     ~ModelListClass();
 
     bool Initialize(int);
+    bool Initialize(int, unsigned int);
     void Shutdown();
 
     int GetModelCount();
-    void GetData(int, float&, float&, float&, D3DXVECTOR4&);
+    void GetData(int, float&, float&, float&, Vector4Type&);
+    InstanceTransformsType GetTransforms();
 
 private:
     int m_modelCount;
-    ModelInfoType* m_ModelInfoList;
+    Vector4Type* m_colors;
+
+    // Position, rotation and scale, each component an array of m_modelCount floats
+    float* m_transforms;
+    InstanceTransformsType m_transformArrays;
 };
\ No newline at end of file
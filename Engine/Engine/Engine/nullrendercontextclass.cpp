@@ -0,0 +1,269 @@
+#include "nullrendercontextclass.h"
+
+// Initial log size, grown by doubling when a frame records more
+const int NULL_COMMAND_CAPACITY = 1024;
+
+NullRenderBuffer::NullRenderBuffer(unsigned int id, unsigned int size)
+{
+    m_id = id;
+    m_size = size;
+    m_data = new unsigned char[size];
+}
+
+void NullRenderBuffer::Release()
+{
+    if (m_data)
+        delete[] m_data;
+
+    delete this;
+}
+
+NullRenderContextClass::NullRenderContextClass(bool deferred)
+{
+    m_deferred = deferred;
+    m_commands = 0;
+    m_commandCount = 0;
+    m_commandCapacity = 0;
+}
+
+void NullRenderContextClass::Release()
+{
+    if (m_commands)
+    {
+        delete[] m_commands;
+        m_commands = 0;
+    }
+
+    delete this;
+}
+
+bool NullRenderContextClass::Map(RenderBuffer* buffer, RenderMapType mapType, void** data)
+{
+    *data = ((NullRenderBuffer*)buffer)->m_data;
+    return true;
+}
+
+void NullRenderContextClass::Unmap(RenderBuffer* buffer, unsigned int bytesWritten)
+{
+    AddCommand(COMMAND_UPLOAD, ((NullRenderBuffer*)buffer)->m_id, bytesWritten);
+
+    m_stats.bufferUploads++;
+    m_stats.bytesUploaded += bytesWritten;
+
+    return;
+}
+
+void NullRenderContextClass::SetVertexBuffer(RenderBuffer* buffer, unsigned int stride)
+{
+    AddCommand(COMMAND_SET_VERTEX_BUFFER, ((NullRenderBuffer*)buffer)->m_id, stride);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetIndexBuffer(RenderBuffer* buffer)
+{
+    AddCommand(COMMAND_SET_INDEX_BUFFER, ((NullRenderBuffer*)buffer)->m_id, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetConstantBuffer(unsigned int stages, unsigned int slot, RenderBuffer* buffer, unsigned int firstConstant, unsigned int numConstants)
+{
+    AddCommand(COMMAND_SET_CONSTANT_BUFFER, ((NullRenderBuffer*)buffer)->m_id, firstConstant);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetTexture(unsigned int slot, RenderTexture* texture)
+{
+    if (texture)
+        AddCommand(COMMAND_SET_TEXTURE, slot, ((NullRenderTexture*)texture)->m_id);
+    else
+        AddCommand(COMMAND_SET_TEXTURE, slot, 0);
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::UnbindTextures()
+{
+    AddCommand(COMMAND_SET_TEXTURE, 0xffffffff, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetProgram(RenderProgram* program)
+{
+    AddCommand(COMMAND_SET_SHADER, ((NullRenderProgram*)program)->m_id, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+// Texture id 0 stands for the back buffer and depth buffer
+void NullRenderContextClass::SetBackBuffer()
+{
+    AddCommand(COMMAND_SET_RENDER_TARGETS, 0, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetRenderTargets(RenderTexture* colorTarget, RenderTexture* depthTarget)
+{
+    unsigned int colorId, depthId;
+
+    colorId = 0xffffffff;
+    if (colorTarget)
+        colorId = ((NullRenderTexture*)colorTarget)->m_id;
+
+    depthId = 0xffffffff;
+    if (depthTarget)
+        depthId = ((NullRenderTexture*)depthTarget)->m_id;
+
+    AddCommand(COMMAND_SET_RENDER_TARGETS, colorId, depthId);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetDepthEnabled(bool enabled)
+{
+    AddCommand(COMMAND_SET_DEPTH, enabled ? 1 : 0, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::SetAlphaBlending(bool enabled)
+{
+    AddCommand(COMMAND_SET_BLEND, enabled ? 1 : 0, 0);
+    m_stats.stateChanges++;
+    return;
+}
+
+void NullRenderContextClass::Clear(float red, float green, float blue, float alpha)
+{
+    AddCommand(COMMAND_CLEAR, 0, 0);
+    return;
+}
+
+void NullRenderContextClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+    AddCommand(COMMAND_DRAW_INDEXED, indexCount, startIndex);
+
+    m_stats.drawCalls++;
+    m_stats.indexCount += indexCount;
+
+    return;
+}
+
+bool NullRenderContextClass::FinishCommandList(RenderCommandList** commandList)
+{
+    NullRenderCommandList* list;
+
+    *commandList = 0;
+
+    list = new NullRenderCommandList;
+    if (!list)
+        return false;
+
+    // Hand the recorded log over to the list and start an empty one
+    list->m_commands = m_commands;
+    list->m_commandCount = m_commandCount;
+    list->stats = m_stats;
+
+    m_commands = 0;
+    m_commandCount = 0;
+    m_commandCapacity = 0;
+    ResetStats();
+
+    *commandList = list;
+
+    return true;
+}
+
+void NullRenderContextClass::ExecuteCommandList(RenderCommandList* commandList)
+{
+    NullRenderCommandList* list;
+    bool result;
+
+    list = (NullRenderCommandList*)commandList;
+
+    // Splice the recorded commands into this log in submission order
+    result = Reserve(m_commandCount + list->m_commandCount);
+    if (result && (list->m_commandCount > 0))
+    {
+        memcpy(&m_commands[m_commandCount], list->m_commands, sizeof(CommandType) * list->m_commandCount);
+        m_commandCount += list->m_commandCount;
+    }
+
+    AddStats(commandList->stats);
+
+    return;
+}
+
+void NullRenderContextClass::Present()
+{
+    AddCommand(COMMAND_PRESENT, 0, 0);
+    return;
+}
+
+void NullRenderContextClass::ResetCommands()
+{
+    m_commandCount = 0;
+    return;
+}
+
+int NullRenderContextClass::GetCommandCount()
+{
+    return m_commandCount;
+}
+
+NullRenderContextClass::CommandType NullRenderContextClass::GetCommand(int index)
+{
+    return m_commands[index];
+}
+
+bool NullRenderContextClass::AddCommand(CommandKind kind, unsigned int arg0, unsigned int arg1)
+{
+    bool result;
+
+    result = Reserve(m_commandCount + 1);
+    if (!result)
+        return false;
+
+    m_commands[m_commandCount].kind = kind;
+    m_commands[m_commandCount].arg0 = arg0;
+    m_commands[m_commandCount].arg1 = arg1;
+    m_commandCount++;
+
+    return true;
+}
+
+bool NullRenderContextClass::Reserve(int count)
+{
+    CommandType* commands;
+    int capacity;
+
+    if (count <= m_commandCapacity)
+        return true;
+
+    capacity = m_commandCapacity;
+    if (capacity == 0)
+        capacity = NULL_COMMAND_CAPACITY;
+
+    while (capacity < count)
+        capacity *= 2;
+
+    commands = new CommandType[capacity];
+    if (!commands)
+        return false;
+
+    if (m_commands)
+    {
+        memcpy(commands, m_commands, sizeof(CommandType) * m_commandCount);
+        delete[] m_commands;
+    }
+
+    m_commands = commands;
+    m_commandCapacity = capacity;
+
+    return true;
+}
\ No newline at end of file
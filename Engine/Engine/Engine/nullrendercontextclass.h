@@ -0,0 +1,111 @@
+#pragma once
+
+#include "rendercontextclass.h"
+
+// Buffers keep their contents in system memory so uploads still cost a copy
+class NullRenderBuffer : public RenderBuffer
+{
+public:
+    NullRenderBuffer(unsigned int, unsigned int);
+    void Release();
+
+    unsigned int m_id;
+    unsigned int m_size;
+    unsigned char* m_data;
+};
+
+class NullRenderTexture : public RenderTexture
+{
+public:
+    NullRenderTexture(unsigned int id, int width, int height) { m_id = id; m_width = width; m_height = height; }
+    void Release() { delete this; }
+
+    unsigned int m_id;
+    int m_width, m_height;
+};
+
+class NullRenderProgram : public RenderProgram
+{
+public:
+    NullRenderProgram(unsigned int id) { m_id = id; }
+    void Release() { delete this; }
+
+    unsigned int m_id;
+};
+
+// Records every call instead of submitting it. The log of the immediate context
+// covers one frame, a deferred context hands its log over in the command list.
+class NullRenderContextClass : public RenderContextClass
+{
+public:
+    enum CommandKind
+    {
+        COMMAND_UPLOAD,
+        COMMAND_SET_VERTEX_BUFFER,
+        COMMAND_SET_INDEX_BUFFER,
+        COMMAND_SET_CONSTANT_BUFFER,
+        COMMAND_SET_TEXTURE,
+        COMMAND_SET_SHADER,
+        COMMAND_SET_RENDER_TARGETS,
+        COMMAND_SET_DEPTH,
+        COMMAND_SET_BLEND,
+        COMMAND_CLEAR,
+        COMMAND_DRAW_INDEXED,
+        COMMAND_PRESENT
+    };
+
+    struct CommandType
+    {
+        CommandKind kind;
+        unsigned int arg0, arg1;
+    };
+
+public:
+    NullRenderContextClass(bool);
+    void Release();
+
+    bool Map(RenderBuffer*, RenderMapType, void**);
+    void Unmap(RenderBuffer*, unsigned int);
+
+    void SetVertexBuffer(RenderBuffer*, unsigned int);
+    void SetIndexBuffer(RenderBuffer*);
+    void SetConstantBuffer(unsigned int, unsigned int, RenderBuffer*, unsigned int, unsigned int);
+    void SetTexture(unsigned int, RenderTexture*);
+    void UnbindTextures();
+    void SetProgram(RenderProgram*);
+
+    void SetBackBuffer();
+    void SetRenderTargets(RenderTexture*, RenderTexture*);
+    void SetDepthEnabled(bool);
+    void SetAlphaBlending(bool);
+
+    void Clear(float, float, float, float);
+    void DrawIndexed(unsigned int, unsigned int, int);
+
+    bool FinishCommandList(RenderCommandList**);
+    void ExecuteCommandList(RenderCommandList*);
+
+    void Present();
+    void ResetCommands();
+    int GetCommandCount();
+    CommandType GetCommand(int);
+
+private:
+    bool AddCommand(CommandKind, unsigned int, unsigned int);
+    bool Reserve(int);
+
+private:
+    bool m_deferred;
+    CommandType* m_commands;
+    int m_commandCount, m_commandCapacity;
+};
+
+class NullRenderCommandList : public RenderCommandList
+{
+public:
+    NullRenderCommandList() { m_commands = 0; m_commandCount = 0; }
+    void Release() { if (m_commands) delete[] m_commands; delete this; }
+
+    NullRenderContextClass::CommandType* m_commands;
+    int m_commandCount;
+};
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "nullrenderdeviceclass.h"
+
+NullRenderDeviceClass::NullRenderDeviceClass()
+{
+    m_context = 0;
+    m_pipelineCache = 0;
+    m_shaderCache = 0;
+    m_nextId = 1;
+    m_frameCount = 0;
+    m_bufferBytes = 0;
+}
+
+NullRenderDeviceClass::NullRenderDeviceClass(const NullRenderDeviceClass& other)
+{
+
+}
+
+NullRenderDeviceClass::~NullRenderDeviceClass()
+{
+
+}
+
+bool NullRenderDeviceClass::Initialize(int screenWidth, int screenHeight, float screenDepth, float screenNear)
+{
+    float fieldOfView, screenAspect;
+
+    m_context = new NullRenderContextClass(false);
+    if (!m_context)
+        return false;
+
+    m_pipelineCache = new PipelineStateCacheClass;
+    if (!m_pipelineCache)
+        return false;
+
+    if (!m_pipelineCache->Initialize(0, 0))
+        return false;
+
+    // Programs go through the same cache as on D3D, with a stand in compiler
+    m_shaderCache = new ShaderCacheClass;
+    if (!m_shaderCache)
+        return false;
+
+    if (!m_shaderCache->Initialize("shaders-null.cache", "shader-cache.txt", CompileShaderFile, 0))
+        return false;
+
+    // Same matrices D3DClass builds so the render path sees identical transforms
+    fieldOfView = (float)MATH_PI / 4.0f;
+    screenAspect = (float)screenWidth / (float)screenHeight;
+    MatrixPerspectiveFovLH(&m_projectionMatrix, fieldOfView, screenAspect, screenNear, screenDepth);
+    MatrixIdentity(&m_worldMatrix);
+    MatrixOrthoLH(&m_orthoMatrix, (float)screenWidth, (float)screenHeight, screenNear, screenDepth);
+
+    return true;
+}
+
+void NullRenderDeviceClass::Shutdown()
+{
+    if (m_pipelineCache)
+    {
+        m_pipelineCache->Shutdown();
+        delete m_pipelineCache;
+        m_pipelineCache = 0;
+    }
+
+    if (m_shaderCache)
+    {
+        m_shaderCache->Shutdown();
+        delete m_shaderCache;
+        m_shaderCache = 0;
+    }
+
+    if (m_context)
+    {
+        m_context->Release();
+        m_context = 0;
+    }
+
+    return;
+}
+
+RenderContextClass* NullRenderDeviceClass::GetContext()
+{
+    return m_context;
+}
+
+RenderContextClass* NullRenderDeviceClass::CreateDeferredContext()
+{
+    return new NullRenderContextClass(true);
+}
+
+// Take the offset path so the headless run exercises the same code as a D3D11.1 driver
+bool NullRenderDeviceClass::SupportsConstantOffsets()
+{
+    return true;
+}
+
+RenderBuffer* NullRenderDeviceClass::CreateBuffer(RenderBufferType type, unsigned int size, bool dynamic, const void* initialData)
+{
+    NullRenderBuffer* buffer;
+
+    buffer = new NullRenderBuffer(m_nextId, size);
+    if (!buffer)
+        return 0;
+
+    if (!buffer->m_data)
+    {
+        buffer->Release();
+        return 0;
+    }
+
+    if (initialData)
+        memcpy(buffer->m_data, initialData, size);
+    else
+        memset(buffer->m_data, 0, size);
+
+    m_nextId++;
+    m_bufferBytes += size;
+
+    return buffer;
+}
+
+// Texture files aren't read, nothing samples them
+RenderTexture* NullRenderDeviceClass::LoadTexture(wchar_t* filename)
+{
+    RenderTexture* texture;
+
+    texture = new NullRenderTexture(m_nextId, 0, 0);
+    if (!texture)
+        return 0;
+
+    m_nextId++;
+
+    return texture;
+}
+
+RenderTexture* NullRenderDeviceClass::CreateTexture(const RenderTextureDescType& desc)
+{
+    RenderTexture* texture;
+
+    texture = new NullRenderTexture(m_nextId, desc.width, desc.height);
+    if (!texture)
+        return 0;
+
+    m_nextId++;
+
+    return texture;
+}
+
+RenderTexture* NullRenderDeviceClass::CreateRenderTexture(int width, int height, unsigned int format, bool depth)
+{
+    RenderTexture* texture;
+
+    texture = new NullRenderTexture(m_nextId, width, height);
+    if (!texture)
+        return 0;
+
+    m_nextId++;
+
+    return texture;
+}
+
+RenderProgram* NullRenderDeviceClass::CreateProgram(const RenderProgramDescType& desc)
+{
+    RenderProgram* program;
+    ShaderBytecodeType bytecode;
+
+    if (!m_shaderCache->GetShader(desc.vsFilename, desc.vsEntry, "vs_5_0", 0, bytecode))
+        return 0;
+
+    if (!m_shaderCache->GetShader(desc.psFilename, desc.psEntry, "ps_5_0", 0, bytecode))
+        return 0;
+
+    program = new NullRenderProgram(m_nextId);
+    if (!program)
+        return 0;
+
+    m_nextId++;
+
+    return program;
+}
+
+// Nothing to build beyond the description, which the context applies a part at a time
+RenderPipelineState* NullRenderDeviceClass::GetPipelineState(const RenderPipelineDescType& desc)
+{
+    return m_pipelineCache->GetPipelineState(desc);
+}
+
+void NullRenderDeviceClass::BeginScene(float red, float green, float blue, float alpha)
+{
+    // The log holds one frame
+    m_context->ResetCommands();
+    m_context->Clear(red, green, blue, alpha);
+    return;
+}
+
+void NullRenderDeviceClass::EndScene()
+{
+    m_context->Present();
+    m_frameCount++;
+    return;
+}
+
+void NullRenderDeviceClass::GetProjectionMatrix(MatrixType& projectionMatrix)
+{
+    projectionMatrix = m_projectionMatrix;
+    return;
+}
+
+void NullRenderDeviceClass::GetWorldMatrix(MatrixType& worldMatrix)
+{
+    worldMatrix = m_worldMatrix;
+    return;
+}
+
+void NullRenderDeviceClass::GetOrthoMatrix(MatrixType& orthoMatrix)
+{
+    orthoMatrix = m_orthoMatrix;
+    return;
+}
+
+unsigned int NullRenderDeviceClass::GetFrameCount()
+{
+    return m_frameCount;
+}
+
+unsigned int NullRenderDeviceClass::GetBufferBytes()
+{
+    return m_bufferBytes;
+}
+
+// Stand in for the HLSL compiler, the "bytecode" is the source text
+bool NullRenderDeviceClass::CompileShaderFile(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+    ifstream fin;
+    char path[SHADER_CACHE_MAX_PATH];
+
+    if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+        return false;
+
+    fin.open(path, ios::in | ios::binary);
+    if (fin.fail())
+        return false;
+
+    fin.seekg(0, ios::end);
+    bytecode.size = (unsigned int)fin.tellg();
+    fin.seekg(0, ios::beg);
+
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+        return false;
+
+    fin.read((char*)bytecode.data, bytecode.size);
+    if (fin.fail())
+    {
+        delete[] bytecode.data;
+        return false;
+    }
+
+    fin.close();
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "renderdeviceclass.h"
+#include "pipelinestatecacheclass.h"
+#include "nullrendercontextclass.h"
+#include "shadercacheclass.h"
+
+// Render device without a GPU. Nothing is drawn, every call made through it is
+// recorded and counted so the render path can be run and measured headless.
+class NullRenderDeviceClass : public RenderDeviceClass
+{
+public:
+    NullRenderDeviceClass();
+    NullRenderDeviceClass(const NullRenderDeviceClass&);
+    ~NullRenderDeviceClass();
+
+    bool Initialize(int, int, float, float);
+    void Shutdown();
+
+    RenderContextClass* GetContext();
+    RenderContextClass* CreateDeferredContext();
+    bool SupportsConstantOffsets();
+
+    RenderBuffer* CreateBuffer(RenderBufferType, unsigned int, bool, const void*);
+    RenderTexture* LoadTexture(wchar_t*);
+    RenderTexture* CreateTexture(const RenderTextureDescType&);
+    RenderTexture* CreateRenderTexture(int, int, unsigned int, bool);
+    RenderProgram* CreateProgram(const RenderProgramDescType&);
+    RenderPipelineState* GetPipelineState(const RenderPipelineDescType&);
+
+    void BeginScene(float, float, float, float);
+    void EndScene();
+
+    void GetProjectionMatrix(MatrixType&);
+    void GetWorldMatrix(MatrixType&);
+    void GetOrthoMatrix(MatrixType&);
+
+    unsigned int GetFrameCount();
+    unsigned int GetBufferBytes();
+
+private:
+    static bool CompileShaderFile(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+
+private:
+    NullRenderContextClass* m_context;
+    ShaderCacheClass* m_shaderCache;
+    PipelineStateCacheClass* m_pipelineCache;
+    unsigned int m_nextId;
+    unsigned int m_frameCount;
+    unsigned int m_bufferBytes;
+
+    MatrixType m_projectionMatrix;
+    MatrixType m_worldMatrix;
+    MatrixType m_orthoMatrix;
+};
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "parallelrecordclass.h"
+#include "cpurecorderclass.h"
+#include <fstream>
+#include <stdio.h>
+
+// Fails the last worker's range, so with more than one worker the failure
+// has to come back from another thread
+class FailingRecorderClass : public CpuRecorderClass
+{
+public:
+    bool Record(int worker, int first, int last)
+    {
+        if (worker == GetWorkerCount() - 1)
+            return false;
+
+        return CpuRecorderClass::Record(worker, first, last);
+    }
+};
+
+static void Check(std::ofstream& fout, const char* name, int workerCount, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << workerCount << " workers, " << name << std::endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+ParallelRecordClass::ParallelRecordClass()
+{
+    m_workerCount = 0;
+    m_threads = 0;
+
+    m_recorder = 0;
+    m_itemCount = 0;
+    m_generation = 0;
+    m_pending = 0;
+    m_failed = false;
+    m_quit = false;
+}
+
+ParallelRecordClass::ParallelRecordClass(const ParallelRecordClass& other)
+{
+
+}
+
+ParallelRecordClass::~ParallelRecordClass()
+{
+
+}
+
+bool ParallelRecordClass::Initialize(int workerCount)
+{
+    int i;
+
+    if (workerCount < 1)
+        return false;
+
+    m_workerCount = workerCount;
+    m_quit = false;
+
+    // The calling thread records the first range itself
+    if (m_workerCount > 1)
+    {
+        m_threads = new std::thread[m_workerCount - 1];
+        if (!m_threads)
+            return false;
+
+        for (i = 1; i < m_workerCount; i++)
+            m_threads[i - 1] = std::thread(&ParallelRecordClass::WorkerThread, this, i);
+    }
+
+    return true;
+}
+
+void ParallelRecordClass::Shutdown()
+{
+    int i;
+
+    if (m_threads)
+    {
+        // Wake the workers up and let them leave their loop
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_startCondition.notify_all();
+
+        for (i = 0; i < m_workerCount - 1; i++)
+        {
+            if (m_threads[i].joinable())
+                m_threads[i].join();
+        }
+
+        delete[] m_threads;
+        m_threads = 0;
+    }
+
+    m_workerCount = 0;
+
+    return;
+}
+
+bool ParallelRecordClass::Record(CommandRecorderClass* recorder, int itemCount)
+{
+    bool result;
+    int i;
+
+    // The recorder needs one context per worker
+    if (recorder->GetWorkerCount() != m_workerCount)
+        return false;
+
+    // Hand the job to the worker threads
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_recorder = recorder;
+        m_itemCount = itemCount;
+        m_pending = m_workerCount - 1;
+        m_failed = false;
+        m_generation++;
+    }
+    m_startCondition.notify_all();
+
+    // Record the first range on this thread
+    result = RecordWorker(0);
+
+    // Wait for the other ranges
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_pending == 0; });
+        if (m_failed)
+            result = false;
+        m_recorder = 0;
+    }
+
+    // Submit in worker order, which is the original draw order
+    for (i = 0; i < m_workerCount; i++)
+    {
+        if (!recorder->Execute(i))
+            result = false;
+    }
+
+    return result;
+}
+
+int ParallelRecordClass::GetWorkerCount()
+{
+    return m_workerCount;
+}
+
+void ParallelRecordClass::GetRange(int itemCount, int workerCount, int worker, int& first, int& last)
+{
+    int share, remainder;
+
+    // Contiguous ranges, the first workers take one extra item each when it doesn't divide evenly
+    share = itemCount / workerCount;
+    remainder = itemCount % workerCount;
+
+    if (worker < remainder)
+    {
+        first = worker * (share + 1);
+        last = first + share + 1;
+    }
+    else
+    {
+        first = remainder * (share + 1) + (worker - remainder) * share;
+        last = first + share;
+    }
+
+    return;
+}
+
+void ParallelRecordClass::WorkerThread(int worker)
+{
+    unsigned int generation;
+    bool result;
+
+    generation = 0;
+
+    PROFILE_THREAD("Record worker");
+
+    while (true)
+    {
+        // Sleep until there is a new frame to record or we are shutting down
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, generation] { return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+            generation = m_generation;
+        }
+
+        result = RecordWorker(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!result)
+                m_failed = true;
+            m_pending--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+bool ParallelRecordClass::RecordWorker(int worker)
+{
+    int first, last;
+
+    PROFILE_ZONE("Record range");
+
+    GetRange(m_itemCount, m_workerCount, worker, first, last);
+
+    return m_recorder->Record(worker, first, last);
+}
+
+// Records several frames of different sizes with every worker count through
+// the CPU recorder, and checks the ranges each worker got and the order the
+// items were submitted in
+bool ParallelRecordClass::RunTests(char* filename)
+{
+    const int itemCounts[] = { 0, 1, 2, 7, 100, 1000, 1001 };
+    const int sizeCount = sizeof(itemCounts) / sizeof(itemCounts[0]);
+    const int maxWorkers = 8, maxItems = 1001, frameCount = 3;
+    ParallelRecordClass* pool;
+    CpuRecorderClass recorder, wrongRecorder;
+    FailingRecorderClass failingRecorder;
+    std::ofstream fout;
+    int workerCount, worker, size, frame, item, first, last, nextFirst, failures;
+    bool covered, ordered;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    failures = 0;
+    for (workerCount = 1; workerCount <= maxWorkers; workerCount++)
+    {
+        // The ranges alone have to cover the list in order, largest first, at most one item apart
+        covered = true;
+        for (size = 0; size < sizeCount; size++)
+        {
+            nextFirst = 0;
+            for (worker = 0; worker < workerCount; worker++)
+            {
+                GetRange(itemCounts[size], workerCount, worker, first, last);
+                covered = covered && (first == nextFirst) && (last >= first);
+                covered = covered && ((last - first) == itemCounts[size] / workerCount + (worker < itemCounts[size] % workerCount ? 1 : 0));
+                nextFirst = last;
+            }
+            covered = covered && (nextFirst == itemCounts[size]);
+        }
+        Check(fout, "ranges cover the list", workerCount, covered, failures);
+
+        pool = new ParallelRecordClass;
+        if (!pool)
+            return false;
+
+        if (!pool->Initialize(workerCount) || !recorder.Initialize(workerCount, maxItems) || !wrongRecorder.Initialize(workerCount + 1, maxItems) ||
+            !failingRecorder.Initialize(workerCount, maxItems))
+        {
+            fout << "FAIL " << workerCount << " workers, could not initialize" << std::endl;
+            failures++;
+        }
+        else
+        {
+            // The same threads record every frame, so each size runs a few times
+            ordered = true;
+            for (size = 0; size < sizeCount; size++)
+            {
+                for (frame = 0; frame < frameCount; frame++)
+                {
+                    recorder.Reset();
+                    ordered = ordered && pool->Record(&recorder, itemCounts[size]);
+                    ordered = ordered && (recorder.GetExecutedCount() == itemCounts[size]);
+
+                    // Each item submitted once in draw order, by the worker whose range holds it
+                    for (item = 0; ordered && (item < recorder.GetExecutedCount()); item++)
+                    {
+                        GetRange(itemCounts[size], workerCount, recorder.GetExecutedWorker(item), first, last);
+                        ordered = (recorder.GetExecutedItem(item) == item) && (item >= first) && (item < last);
+                    }
+                }
+            }
+            Check(fout, "items submitted in order by their range's worker", workerCount, ordered, failures);
+
+            Check(fout, "recorder with another worker count refused", workerCount, !pool->Record(&wrongRecorder, maxItems), failures);
+
+            failingRecorder.Reset();
+            Check(fout, "failed range fails the frame", workerCount, !pool->Record(&failingRecorder, maxItems), failures);
+
+            // A failed frame must not break the next one
+            recorder.Reset();
+            Check(fout, "frame after a failure records", workerCount, pool->Record(&recorder, maxItems) && (recorder.GetExecutedCount() == maxItems),
+                failures);
+        }
+
+        failingRecorder.Shutdown();
+        wrongRecorder.Shutdown();
+        recorder.Shutdown();
+
+        pool->Shutdown();
+        delete pool;
+        pool = 0;
+    }
+
+    fout << std::endl << failures << " failures" << std::endl;
+    fout.close();
+
+    printf("%d record test failures, results in %s\n", failures, filename);
+
+    return (failures == 0);
+}
\ No newline at end of file
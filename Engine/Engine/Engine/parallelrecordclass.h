@@ -0,0 +1,46 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "commandrecorderclass.h"
+#include "profilerclass.h"
+
+// Splits the draw list into one contiguous range per worker, records the ranges
+// in parallel and executes the results in worker order so the submission order
+// matches the single threaded path.
+class ParallelRecordClass
+{
+public:
+    ParallelRecordClass();
+    ParallelRecordClass(const ParallelRecordClass&);
+    ~ParallelRecordClass();
+
+    bool Initialize(int);
+    void Shutdown();
+
+    bool Record(CommandRecorderClass*, int);
+
+    int GetWorkerCount();
+    static void GetRange(int, int, int, int&, int&);
+    static bool RunTests(char*);
+
+private:
+    void WorkerThread(int);
+    bool RecordWorker(int);
+
+private:
+    int m_workerCount;
+    std::thread* m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+
+    CommandRecorderClass* m_recorder;
+    int m_itemCount;
+    unsigned int m_generation;
+    int m_pending;
+    bool m_failed;
+    bool m_quit;
+};
\ No newline at end of file
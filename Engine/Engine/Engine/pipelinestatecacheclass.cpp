@@ -0,0 +1,207 @@
+#include "pipelinestatecacheclass.h"
+
+// 32 bit FNV-1a
+const unsigned int PIPELINE_HASH_OFFSET = 2166136261u;
+const unsigned int PIPELINE_HASH_PRIME = 16777619u;
+
+// Fixed function state takes the low byte of a sort key
+const int PIPELINE_STATE_BITS = 8;
+
+PipelineStateCacheClass::PipelineStateCacheClass()
+{
+    m_createFunction = 0;
+    m_userData = 0;
+
+    m_entries = 0;
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+
+    m_programs = 0;
+    m_programCount = 0;
+    m_programCapacity = 0;
+
+    m_hitCount = 0;
+}
+
+PipelineStateCacheClass::PipelineStateCacheClass(const PipelineStateCacheClass& other)
+{
+
+}
+
+PipelineStateCacheClass::~PipelineStateCacheClass()
+{
+
+}
+
+bool PipelineStateCacheClass::Initialize(PipelineStateCreateFunction createFunction, void* userData)
+{
+    m_createFunction = createFunction;
+    m_userData = userData;
+
+    m_entries = new EntryType[PIPELINE_STATE_CAPACITY];
+    if (!m_entries)
+        return false;
+
+    m_entryCapacity = PIPELINE_STATE_CAPACITY;
+
+    m_programs = new RenderProgram*[PIPELINE_STATE_CAPACITY];
+    if (!m_programs)
+        return false;
+
+    m_programCapacity = PIPELINE_STATE_CAPACITY;
+
+    return true;
+}
+
+void PipelineStateCacheClass::Shutdown()
+{
+    int i;
+
+    if (m_entries)
+    {
+        for (i = 0; i < m_entryCount; i++)
+            delete m_entries[i].state;
+
+        delete[] m_entries;
+        m_entries = 0;
+    }
+
+    if (m_programs)
+    {
+        delete[] m_programs;
+        m_programs = 0;
+    }
+
+    m_entryCount = 0;
+    m_programCount = 0;
+
+    return;
+}
+
+RenderPipelineState* PipelineStateCacheClass::GetPipelineState(const RenderPipelineDescType& desc)
+{
+    RenderPipelineDescType normalized;
+    RenderPipelineState* state;
+    EntryType* entries;
+    unsigned int hash, stateBits;
+    int i, programSlot;
+
+    NormalizeDesc(desc, normalized);
+    hash = HashDesc(normalized);
+
+    for (i = 0; i < m_entryCount; i++)
+    {
+        if ((m_entries[i].hash == hash) && (memcmp(&m_entries[i].state->desc, &normalized, sizeof(normalized)) == 0))
+        {
+            m_hitCount++;
+            return m_entries[i].state;
+        }
+    }
+
+    programSlot = GetProgramSlot(normalized.program);
+    if (programSlot < 0)
+        return 0;
+
+    if (m_createFunction)
+        state = m_createFunction(normalized, m_userData);
+    else
+        state = new RenderPipelineState;
+    if (!state)
+        return 0;
+
+    stateBits = (normalized.depthEnabled ? 1 : 0) | (normalized.blendEnabled ? 2 : 0) | ((unsigned int)normalized.cullMode << 2) | (normalized.wireframe ? 8 : 0);
+
+    memcpy(&state->desc, &normalized, sizeof(normalized));
+    state->sortKey = ((unsigned int)programSlot << PIPELINE_STATE_BITS) | stateBits;
+
+    if (m_entryCount == m_entryCapacity)
+    {
+        entries = new EntryType[m_entryCapacity * 2];
+        if (!entries)
+        {
+            delete state;
+            return 0;
+        }
+
+        memcpy(entries, m_entries, sizeof(EntryType) * m_entryCount);
+        delete[] m_entries;
+        m_entries = entries;
+        m_entryCapacity *= 2;
+    }
+
+    m_entries[m_entryCount].hash = hash;
+    m_entries[m_entryCount].state = state;
+    m_entryCount++;
+
+    return state;
+}
+
+int PipelineStateCacheClass::GetStateCount()
+{
+    return m_entryCount;
+}
+
+int PipelineStateCacheClass::GetHitCount()
+{
+    return m_hitCount;
+}
+
+// Bools sit next to padding, copy field by field into zeroed memory so equal
+// descriptions hash and compare equal byte for byte
+void PipelineStateCacheClass::NormalizeDesc(const RenderPipelineDescType& desc, RenderPipelineDescType& normalized)
+{
+    memset(&normalized, 0, sizeof(normalized));
+
+    normalized.program = desc.program;
+    normalized.depthEnabled = desc.depthEnabled;
+    normalized.blendEnabled = desc.blendEnabled;
+    normalized.cullMode = desc.cullMode;
+    normalized.wireframe = desc.wireframe;
+
+    return;
+}
+
+unsigned int PipelineStateCacheClass::HashDesc(const RenderPipelineDescType& desc)
+{
+    const unsigned char* bytes;
+    unsigned int hash, i;
+
+    bytes = (const unsigned char*)&desc;
+    hash = PIPELINE_HASH_OFFSET;
+    for (i = 0; i < sizeof(desc); i++)
+    {
+        hash ^= bytes[i];
+        hash *= PIPELINE_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+int PipelineStateCacheClass::GetProgramSlot(RenderProgram* program)
+{
+    RenderProgram** programs;
+    int i;
+
+    for (i = 0; i < m_programCount; i++)
+    {
+        if (m_programs[i] == program)
+            return i;
+    }
+
+    if (m_programCount == m_programCapacity)
+    {
+        programs = new RenderProgram*[m_programCapacity * 2];
+        if (!programs)
+            return -1;
+
+        memcpy(programs, m_programs, sizeof(RenderProgram*) * m_programCount);
+        delete[] m_programs;
+        m_programs = programs;
+        m_programCapacity *= 2;
+    }
+
+    m_programs[m_programCount] = program;
+    m_programCount++;
+
+    return m_programCount - 1;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string.h>
+#include "rendercontextclass.h"
+
+const int PIPELINE_STATE_CAPACITY = 16;
+
+typedef RenderPipelineState* (*PipelineStateCreateFunction)(const RenderPipelineDescType&, void*);
+
+// Hands out one shared pipeline state per distinct description. Lookups hash
+// the description, misses call the backend's create function, or make a plain
+// RenderPipelineState when there is none. Sort keys are the program's slot in
+// the high bits over the fixed function bits, so sorting by key groups draws
+// that share shaders.
+class PipelineStateCacheClass
+{
+private:
+    struct EntryType
+    {
+        unsigned int hash;
+        RenderPipelineState* state;
+    };
+
+public:
+    PipelineStateCacheClass();
+    PipelineStateCacheClass(const PipelineStateCacheClass&);
+    ~PipelineStateCacheClass();
+
+    bool Initialize(PipelineStateCreateFunction, void*);
+    void Shutdown();
+
+    RenderPipelineState* GetPipelineState(const RenderPipelineDescType&);
+
+    int GetStateCount();
+    int GetHitCount();
+
+private:
+    static void NormalizeDesc(const RenderPipelineDescType&, RenderPipelineDescType&);
+    static unsigned int HashDesc(const RenderPipelineDescType&);
+    int GetProgramSlot(RenderProgram*);
+
+private:
+    PipelineStateCreateFunction m_createFunction;
+    void* m_userData;
+
+    EntryType* m_entries;
+    int m_entryCount, m_entryCapacity;
+
+    RenderProgram** m_programs;
+    int m_programCount, m_programCapacity;
+
+    int m_hitCount;
+};
\ No newline at end of file
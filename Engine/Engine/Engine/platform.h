@@ -0,0 +1,59 @@
+#pragma once
+
+// The window, Direct3D and DirectInput only exist on Windows. Shared code
+// includes this instead of <windows.h>, elsewhere it gets stand ins for the
+// few Win32 names it uses so the null and software devices build on their own.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef void* HWND;
+
+const unsigned int MB_OK = 0;
+
+// There is no window to show errors in
+inline int MessageBox(HWND hwnd, const wchar_t* text, const wchar_t* caption, unsigned int type)
+{
+    fprintf(stderr, "%ls: %ls\n", caption, text);
+
+    return 0;
+}
+
+inline int _itoa_s(int value, char* buffer, size_t size, int radix)
+{
+    if (radix == 16)
+        snprintf(buffer, size, "%x", value);
+    else
+        snprintf(buffer, size, "%d", value);
+
+    return 0;
+}
+
+template <size_t size>
+inline int _itoa_s(int value, char (&buffer)[size], int radix)
+{
+    return _itoa_s(value, buffer, size, radix);
+}
+
+template <size_t size>
+inline int strcpy_s(char (&destination)[size], const char* source)
+{
+    snprintf(destination, size, "%s", source);
+
+    return 0;
+}
+
+template <size_t size>
+inline int strcat_s(char (&destination)[size], const char* source)
+{
+    size_t length;
+
+    length = strlen(destination);
+    snprintf(destination + length, size - length, "%s", source);
+
+    return 0;
+}
+#endif
\ No newline at end of file
@@ -6,6 +6,10 @@ PositionClass::PositionClass()
     m_rotationY = 0.0f;
     m_leftTurnSpeed = 0.0f;
     m_rightTurnSpeed = 0.0f;
+    m_leftKeyDown = false;
+    m_rightKeyDown = false;
+    m_latencyTag.eventId = 0;
+    m_latencyTag.inputTime = 0;
 }
 
 PositionClass::PositionClass(const PositionClass& other)
@@ -33,8 +37,10 @@ void PositionClass::GetRotation(float& y)
     return;
 }
 
-void PositionClass::TurnLeft(bool keydown)
+void PositionClass::TurnLeft(bool keydown, const InputLatencyTagType& tag)
 {
+    KeyChanged(m_leftKeyDown, keydown, tag);
+
     if (keydown)
     {
         m_leftTurnSpeed += m_frameTime * 0.01f;
@@ -63,8 +69,10 @@ void PositionClass::TurnLeft(bool keydown)
     return;
 }
 
-void PositionClass::TurnRight(bool keydown)
+void PositionClass::TurnRight(bool keydown, const InputLatencyTagType& tag)
 {
+    KeyChanged(m_rightKeyDown, keydown, tag);
+
     if (keydown)
     {
         m_rightTurnSpeed += m_frameTime * 0.01f;
@@ -90,5 +98,24 @@ void PositionClass::TurnRight(bool keydown)
         m_rotationY -= 360.0f;
     }
 
+    return;
+}
+
+// The input the rotation last started or stopped turning for
+InputLatencyTagType PositionClass::GetLatencyTag()
+{
+    return m_latencyTag;
+}
+
+// A key only changes the turn the frame it goes down or up, so that's the event the rotation reflects
+void PositionClass::KeyChanged(bool& wasDown, bool keydown, const InputLatencyTagType& tag)
+{
+    if (keydown == wasDown)
+        return;
+
+    wasDown = keydown;
+    if (tag.eventId != 0)
+        m_latencyTag = tag;
+
     return;
 }
\ No newline at end of file
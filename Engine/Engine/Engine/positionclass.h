@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include "inputqueueclass.h"
 
 class PositionClass
 {
@@ -12,11 +13,17 @@ public:
     void SetFrameTime(float);
     void GetRotation(float&);
 
-    void TurnLeft(bool);
-    void TurnRight(bool);
+    void TurnLeft(bool, const InputLatencyTagType&);
+    void TurnRight(bool, const InputLatencyTagType&);
+    InputLatencyTagType GetLatencyTag();
+
+private:
+    void KeyChanged(bool&, bool, const InputLatencyTagType&);
 
 private:
     float m_frameTime;
     float m_rotationY;
     float m_leftTurnSpeed, m_rightTurnSpeed;
+    bool m_leftKeyDown, m_rightKeyDown;
+    InputLatencyTagType m_latencyTag;
 };
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "profilerclass.h"
+
+std::atomic<ProfilerClass::ThreadBufferType*> ProfilerClass::m_threads(0);
+std::atomic<int> ProfilerClass::m_threadCount(0);
+std::atomic<bool> ProfilerClass::m_enabled(false);
+std::atomic<unsigned int> ProfilerClass::m_generation(0);
+long long ProfilerClass::m_startTicks = 0;
+long long ProfilerClass::m_startNanoseconds = 0;
+
+bool ProfilerClass::Initialize()
+{
+    // The ring index is masked so the size has to be a power of two
+    if ((PROFILER_EVENTS_PER_THREAD & (PROFILER_EVENTS_PER_THREAD - 1)) != 0)
+        return false;
+
+    m_startTicks = GetTicks();
+    m_startNanoseconds = GetNanoseconds();
+    m_generation++;
+    m_enabled = true;
+
+    SetThreadName("Main");
+
+    return true;
+}
+
+// Every thread that recorded has to be finished with the profiler by now
+void ProfilerClass::Shutdown()
+{
+    ThreadBufferType* buffer;
+    ThreadBufferType* next;
+
+    m_enabled = false;
+
+    buffer = m_threads.exchange(0);
+    while (buffer)
+    {
+        next = buffer->next;
+        delete[] buffer->events;
+        delete buffer;
+        buffer = next;
+    }
+
+    m_threadCount = 0;
+
+    return;
+}
+
+void ProfilerClass::SetThreadName(const char* name)
+{
+    ThreadBufferType* buffer;
+
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+
+    buffer = GetThreadBuffer();
+    if (!buffer)
+        return;
+
+    strncpy(buffer->name, name, PROFILER_MAX_THREAD_NAME - 1);
+    buffer->name[PROFILER_MAX_THREAD_NAME - 1] = 0;
+
+    return;
+}
+
+void ProfilerClass::AddZone(const char* name, long long start, long long end)
+{
+    ThreadBufferType* buffer;
+    EventType* event;
+    unsigned int index;
+
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+
+    buffer = GetThreadBuffer();
+    if (!buffer)
+        return;
+
+    // Only this thread writes the ring, the release lets WriteTrace read it afterwards
+    index = buffer->count.load(std::memory_order_relaxed);
+    event = &buffer->events[index & (PROFILER_EVENTS_PER_THREAD - 1)];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->kind = EVENT_ZONE;
+    buffer->count.store(index + 1, std::memory_order_release);
+
+    return;
+}
+
+void ProfilerClass::AddCounter(const char* name, double value)
+{
+    ThreadBufferType* buffer;
+    EventType* event;
+    unsigned int index;
+
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+
+    buffer = GetThreadBuffer();
+    if (!buffer)
+        return;
+
+    index = buffer->count.load(std::memory_order_relaxed);
+    event = &buffer->events[index & (PROFILER_EVENTS_PER_THREAD - 1)];
+    event->name = name;
+    event->start = GetTicks();
+    event->value = value;
+    event->kind = EVENT_COUNTER;
+    buffer->count.store(index + 1, std::memory_order_release);
+
+    return;
+}
+
+bool ProfilerClass::WriteTrace(char* filename)
+{
+    ofstream fout;
+    ThreadBufferType* buffer;
+    EventType* event;
+    unsigned int count, first, i;
+    long long elapsedTicks, elapsedNanoseconds;
+    double microsecondsPerTick;
+    bool comma;
+
+    // Work out the tick rate over the whole run
+    elapsedTicks = GetTicks() - m_startTicks;
+    elapsedNanoseconds = GetNanoseconds() - m_startNanoseconds;
+    microsecondsPerTick = (elapsedTicks > 0) ? ((double)elapsedNanoseconds / 1000.0) / (double)elapsedTicks : 0.001;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout.setf(ios::fixed);
+    fout.precision(3);
+
+    fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+
+    comma = false;
+    for (buffer = m_threads.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        if (comma)
+            fout << "," << endl;
+        comma = true;
+
+        fout << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+        WriteName(fout, buffer->name);
+        fout << "}}";
+
+        // A full ring only holds the newest events
+        count = buffer->count.load(std::memory_order_acquire);
+        first = (count > (unsigned int)PROFILER_EVENTS_PER_THREAD) ? count - PROFILER_EVENTS_PER_THREAD : 0;
+
+        for (i = first; i < count; i++)
+        {
+            event = &buffer->events[i & (PROFILER_EVENTS_PER_THREAD - 1)];
+
+            // Trace timestamps are microseconds from the start of the run
+            fout << "," << endl << "{\"name\":";
+            WriteName(fout, event->name);
+            if (event->kind == EVENT_ZONE)
+            {
+                fout << ",\"ph\":\"X\",\"ts\":" << (double)(event->start - m_startTicks) * microsecondsPerTick <<
+                    ",\"dur\":" << (double)(event->end - event->start) * microsecondsPerTick;
+            }
+            else
+            {
+                fout << ",\"ph\":\"C\",\"ts\":" << (double)(event->start - m_startTicks) * microsecondsPerTick <<
+                    ",\"args\":{\"value\":" << event->value << "}";
+            }
+            fout << ",\"pid\":1,\"tid\":" << buffer->threadId << "}";
+        }
+    }
+
+    fout << endl << "]}" << endl;
+    fout.close();
+
+    return true;
+}
+
+// Threads get their ring the first time they record. The generation tells a
+// thread its ring went away in Shutdown.
+ProfilerClass::ThreadBufferType* ProfilerClass::GetThreadBuffer()
+{
+    static thread_local ThreadBufferType* threadBuffer = 0;
+    static thread_local unsigned int threadGeneration = 0;
+    ThreadBufferType* buffer;
+
+    if (threadBuffer && (threadGeneration == m_generation.load(std::memory_order_relaxed)))
+        return threadBuffer;
+
+    threadBuffer = 0;
+
+    buffer = new ThreadBufferType;
+    if (!buffer)
+        return 0;
+
+    buffer->events = new EventType[PROFILER_EVENTS_PER_THREAD];
+    if (!buffer->events)
+    {
+        delete buffer;
+        return 0;
+    }
+
+    buffer->count = 0;
+    buffer->threadId = m_threadCount.fetch_add(1) + 1;
+    snprintf(buffer->name, PROFILER_MAX_THREAD_NAME, "Thread %d", buffer->threadId);
+
+    // Push onto the list without a lock
+    buffer->next = m_threads.load(std::memory_order_relaxed);
+    while (!m_threads.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    threadBuffer = buffer;
+    threadGeneration = m_generation.load(std::memory_order_relaxed);
+
+    return threadBuffer;
+}
+
+// Writes a name as a JSON string
+void ProfilerClass::WriteName(ofstream& fout, const char* name)
+{
+    fout << "\"";
+    while (*name)
+    {
+        if ((*name == '"') || (*name == '\\'))
+            fout << "\\";
+        fout << *name;
+        name++;
+    }
+    fout << "\"";
+
+    return;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PROFILER_USE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILER_USE_TSC 0
+#endif
+using namespace std;
+
+// Set to 0 to compile every zone and counter out of the build
+#define PROFILER_ENABLED 1
+
+const int PROFILER_EVENTS_PER_THREAD = 65536;
+const int PROFILER_MAX_THREAD_NAME = 32;
+
+// Records timed zones and counters from any thread and writes them out in the
+// Chrome trace event format, which chrome://tracing and Perfetto both load.
+// Each thread writes into its own ring of events so recording never locks; the
+// rings keep the most recent events once they fill. Names are stored as
+// pointers, so they have to be string literals. Zones are stamped with the time
+// stamp counter where there is one, which is a lot cheaper to read than the OS
+// clock, and converted to time against the clock when the trace is written.
+class ProfilerClass
+{
+private:
+    enum EventKind
+    {
+        EVENT_ZONE,
+        EVENT_COUNTER
+    };
+
+    struct EventType
+    {
+        const char* name;
+        long long start, end;
+        double value;
+        EventKind kind;
+    };
+
+    struct ThreadBufferType
+    {
+        EventType* events;
+        std::atomic<unsigned int> count;
+        int threadId;
+        char name[PROFILER_MAX_THREAD_NAME];
+        ThreadBufferType* next;
+    };
+
+public:
+    static bool Initialize();
+    static void Shutdown();
+
+    static void SetThreadName(const char*);
+    static void AddZone(const char*, long long, long long);
+    static void AddCounter(const char*, double);
+    static bool WriteTrace(char*);
+
+    static inline long long GetTicks()
+    {
+#if PROFILER_USE_TSC
+        return (long long)__rdtsc();
+#else
+        return GetNanoseconds();
+#endif
+    }
+
+private:
+    static inline long long GetNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static ThreadBufferType* GetThreadBuffer();
+    static void WriteName(ofstream&, const char*);
+
+private:
+    static std::atomic<ThreadBufferType*> m_threads;
+    static std::atomic<int> m_threadCount;
+    static std::atomic<bool> m_enabled;
+    static std::atomic<unsigned int> m_generation;
+    static long long m_startTicks, m_startNanoseconds;
+};
+
+// Times the enclosing scope
+class ProfileScopeClass
+{
+public:
+    inline ProfileScopeClass(const char* name)
+    {
+        m_name = name;
+        m_start = ProfilerClass::GetTicks();
+    }
+
+    inline ~ProfileScopeClass()
+    {
+        ProfilerClass::AddZone(m_name, m_start, ProfilerClass::GetTicks());
+    }
+
+private:
+    const char* m_name;
+    long long m_start;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_JOIN_INNER(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileScopeClass PROFILE_JOIN(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) ProfilerClass::AddCounter(name, (double)(value))
+#define PROFILE_THREAD(name) ProfilerClass::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_THREAD(name)
+#endif
\ No newline at end of file
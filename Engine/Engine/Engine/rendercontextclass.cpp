@@ -0,0 +1,57 @@
+#include "rendercontextclass.h"
+
+RenderContextClass::RenderContextClass()
+{
+    ResetStats();
+}
+
+bool RenderContextClass::UpdateBuffer(RenderBuffer* buffer, const void* data, unsigned int size)
+{
+    void* dataPtr;
+    bool result;
+
+    // Replace the whole contents of a dynamic buffer
+    result = Map(buffer, RENDER_MAP_DISCARD, &dataPtr);
+    if (!result)
+        return false;
+
+    memcpy(dataPtr, data, size);
+
+    Unmap(buffer, size);
+
+    return true;
+}
+
+// Backends without pipeline objects set the parts one at a time
+void RenderContextClass::SetPipelineState(RenderPipelineState* pipelineState)
+{
+    SetProgram(pipelineState->desc.program);
+    SetDepthEnabled(pipelineState->desc.depthEnabled);
+    SetAlphaBlending(pipelineState->desc.blendEnabled);
+
+    return;
+}
+
+RenderStatsType RenderContextClass::GetStats()
+{
+    return m_stats;
+}
+
+void RenderContextClass::ResetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    return;
+}
+
+// Counts an executed command list into this context
+void RenderContextClass::AddStats(const RenderStatsType& stats)
+{
+    m_stats.drawCalls += stats.drawCalls;
+    m_stats.indexCount += stats.indexCount;
+    m_stats.bufferUploads += stats.bufferUploads;
+    m_stats.bytesUploaded += stats.bytesUploaded;
+    m_stats.stateChanges += stats.stateChanges;
+    m_stats.commandLists++;
+
+    return;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <string.h>
+
+// Resources belong to the device that created them and are freed with Release,
+// the same way the D3D11 interfaces are
+class RenderBuffer
+{
+public:
+    virtual ~RenderBuffer() {}
+    virtual void Release() = 0;
+};
+
+class RenderTexture
+{
+public:
+    virtual ~RenderTexture() {}
+    virtual void Release() = 0;
+};
+
+class RenderProgram
+{
+public:
+    virtual ~RenderProgram() {}
+    virtual void Release() = 0;
+};
+
+enum RenderCullType
+{
+    RENDER_CULL_BACK,
+    RENDER_CULL_NONE
+};
+
+// A program and the fixed function state it draws with
+struct RenderPipelineDescType
+{
+    RenderProgram* program;
+    bool depthEnabled;
+    bool blendEnabled;
+    RenderCullType cullMode;
+    bool wireframe;
+};
+
+// Shared and immutable, owned by the device that handed it out. Equal
+// descriptions give the same object, and the sort key groups draws by program
+// first and fixed function state second.
+class RenderPipelineState
+{
+public:
+    virtual ~RenderPipelineState() {}
+
+    RenderPipelineDescType desc;
+    unsigned int sortKey;
+};
+
+enum RenderMapType
+{
+    RENDER_MAP_DISCARD,
+    RENDER_MAP_NO_OVERWRITE
+};
+
+const unsigned int RENDER_STAGE_VERTEX = 1;
+const unsigned int RENDER_STAGE_PIXEL = 2;
+
+// What a context submitted since its stats were last reset
+struct RenderStatsType
+{
+    unsigned int drawCalls;
+    unsigned int indexCount;
+    unsigned int bufferUploads;
+    unsigned int bytesUploaded;
+    unsigned int stateChanges;
+    unsigned int commandLists;
+};
+
+class RenderCommandList
+{
+public:
+    virtual ~RenderCommandList() {}
+    virtual void Release() = 0;
+
+    RenderStatsType stats;
+};
+
+// Everything the render path does per frame goes through a context. The
+// immediate context belongs to the device, deferred contexts record command
+// lists on worker threads and are freed with Release.
+class RenderContextClass
+{
+public:
+    RenderContextClass();
+    virtual ~RenderContextClass() {}
+    virtual void Release() = 0;
+
+    virtual bool Map(RenderBuffer*, RenderMapType, void**) = 0;
+    virtual void Unmap(RenderBuffer*, unsigned int) = 0;
+    bool UpdateBuffer(RenderBuffer*, const void*, unsigned int);
+
+    virtual void SetVertexBuffer(RenderBuffer*, unsigned int) = 0;
+    virtual void SetIndexBuffer(RenderBuffer*) = 0;
+    virtual void SetConstantBuffer(unsigned int, unsigned int, RenderBuffer*, unsigned int, unsigned int) = 0;
+    virtual void SetTexture(unsigned int, RenderTexture*) = 0;
+    virtual void UnbindTextures() = 0;
+    virtual void SetProgram(RenderProgram*) = 0;
+    virtual void SetPipelineState(RenderPipelineState*);
+
+    virtual void SetBackBuffer() = 0;
+    virtual void SetRenderTargets(RenderTexture*, RenderTexture*) = 0;
+    virtual void SetDepthEnabled(bool) = 0;
+    virtual void SetAlphaBlending(bool) = 0;
+
+    virtual void Clear(float, float, float, float) = 0;
+    virtual void DrawIndexed(unsigned int, unsigned int, int) = 0;
+
+    virtual bool FinishCommandList(RenderCommandList**) = 0;
+    virtual void ExecuteCommandList(RenderCommandList*) = 0;
+
+    RenderStatsType GetStats();
+    void ResetStats();
+
+protected:
+    void AddStats(const RenderStatsType&);
+
+protected:
+    RenderStatsType m_stats;
+};
\ No newline at end of file
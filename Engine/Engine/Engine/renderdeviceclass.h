@@ -0,0 +1,76 @@
+#pragma once
+
+#include "mathclass.h"
+#include "rendercontextclass.h"
+
+enum RenderBufferType
+{
+    RENDER_BUFFER_VERTEX,
+    RENDER_BUFFER_INDEX,
+    RENDER_BUFFER_CONSTANT
+};
+
+// Vertex elements are float vectors packed one after the other in slot 0
+struct RenderVertexElementType
+{
+    char* semanticName;
+    unsigned int semanticIndex;
+    unsigned int floatCount;
+};
+
+struct RenderProgramDescType
+{
+    wchar_t* vsFilename;
+    char* vsEntry;
+    wchar_t* psFilename;
+    char* psEntry;
+    RenderVertexElementType* elements;
+    int elementCount;
+};
+
+// One mip of one array slice, in the layout it has in a DDS file
+struct RenderSubresourceType
+{
+    const void* data;
+    unsigned int rowPitch, slicePitch;
+};
+
+// The format is a DXGI_FORMAT number. Subresources are every mip of the first
+// slice, then every mip of the next, with a cubemap's faces as six slices
+struct RenderTextureDescType
+{
+    unsigned int format;
+    int width, height;
+    int mipCount, arraySize;
+    bool cubemap, hasAlpha;
+    const RenderSubresourceType* subresources;
+};
+
+// Thin interface between the render path and the graphics API. D3DClass
+// implements it on D3D11 and NullRenderDeviceClass records what would have been
+// submitted, so the same render path can run without a window or a GPU.
+class RenderDeviceClass
+{
+public:
+    virtual ~RenderDeviceClass() {}
+
+    virtual void Shutdown() = 0;
+
+    virtual RenderContextClass* GetContext() = 0;
+    virtual RenderContextClass* CreateDeferredContext() = 0;
+    virtual bool SupportsConstantOffsets() = 0;
+
+    virtual RenderBuffer* CreateBuffer(RenderBufferType, unsigned int, bool, const void*) = 0;
+    virtual RenderTexture* LoadTexture(wchar_t*) = 0;
+    virtual RenderTexture* CreateTexture(const RenderTextureDescType&) = 0;
+    virtual RenderTexture* CreateRenderTexture(int, int, unsigned int, bool) = 0;
+    virtual RenderProgram* CreateProgram(const RenderProgramDescType&) = 0;
+    virtual RenderPipelineState* GetPipelineState(const RenderPipelineDescType&) = 0;
+
+    virtual void BeginScene(float, float, float, float) = 0;
+    virtual void EndScene() = 0;
+
+    virtual void GetProjectionMatrix(MatrixType&) = 0;
+    virtual void GetWorldMatrix(MatrixType&) = 0;
+    virtual void GetOrthoMatrix(MatrixType&) = 0;
+};
\ No newline at end of file
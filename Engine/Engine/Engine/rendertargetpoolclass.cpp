@@ -0,0 +1,383 @@
+#include "rendertargetpoolclass.h"
+#include "nullrenderdeviceclass.h"
+#include <stdio.h>
+
+// What the test graphs' passes and transitions saw, in execution order
+struct GraphTestLogType
+{
+    RenderTargetPoolClass* pool;
+    int passes[FRAME_GRAPH_MAX_PASSES];
+    int passCount;
+    FrameGraphClass::TransitionType transitions[FRAME_GRAPH_MAX_PASSES * FRAME_GRAPH_MAX_ACCESSES * 2];
+    int transitionPasses[FRAME_GRAPH_MAX_PASSES * FRAME_GRAPH_MAX_ACCESSES * 2];
+    int transitionCount;
+};
+
+static bool LogPass(FrameGraphClass* frameGraph, int pass, void* userData)
+{
+    GraphTestLogType* log;
+
+    log = (GraphTestLogType*)userData;
+    log->passes[log->passCount] = pass;
+    log->passCount++;
+
+    return true;
+}
+
+static void LogTransitions(FrameGraphClass* frameGraph, int pass, FrameGraphClass::TransitionType* transitions, int transitionCount, void* userData)
+{
+    GraphTestLogType* log;
+    int i;
+
+    log = (GraphTestLogType*)userData;
+    for (i = 0; i < transitionCount; i++)
+    {
+        log->transitions[log->transitionCount] = transitions[i];
+        log->transitionPasses[log->transitionCount] = pass;
+        log->transitionCount++;
+    }
+
+    RenderTargetPoolClass::ApplyTransitions(frameGraph, pass, transitions, transitionCount, log->pool);
+
+    return;
+}
+
+// Position of a pass in the executed order, -1 when it was culled
+static int GetExecutedPosition(const GraphTestLogType& log, int pass)
+{
+    int i;
+
+    for (i = 0; i < log.passCount; i++)
+    {
+        if (log.passes[i] == pass)
+            return i;
+    }
+
+    return -1;
+}
+
+static bool HasTransition(const GraphTestLogType& log, int pass, int resource, FrameGraphClass::ResourceState before, FrameGraphClass::ResourceState after)
+{
+    int i;
+
+    for (i = 0; i < log.transitionCount; i++)
+    {
+        if ((log.transitionPasses[i] == pass) && (log.transitions[i].resource == resource) && (log.transitions[i].before == before) &&
+            (log.transitions[i].after == after))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void Check(ofstream& fout, const char* name, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << name << endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+RenderTargetPoolClass::RenderTargetPoolClass()
+{
+    m_deviceContext = 0;
+    m_frameGraph = 0;
+    m_targets = 0;
+    m_targetCount = 0;
+}
+
+RenderTargetPoolClass::RenderTargetPoolClass(const RenderTargetPoolClass& other)
+{
+
+}
+
+RenderTargetPoolClass::~RenderTargetPoolClass()
+{
+
+}
+
+bool RenderTargetPoolClass::Initialize(RenderDeviceClass* device, FrameGraphClass* frameGraph)
+{
+    FrameGraphClass::TextureDesc desc;
+    int i;
+
+    m_deviceContext = device->GetContext();
+    m_frameGraph = frameGraph;
+    m_targetCount = frameGraph->GetPhysicalCount();
+
+    // A graph with only imported resources needs no textures of its own
+    if (m_targetCount == 0)
+        return true;
+
+    m_targets = new RenderTexture*[m_targetCount];
+    if (!m_targets)
+        return false;
+
+    for (i = 0; i < m_targetCount; i++)
+        m_targets[i] = 0;
+
+    for (i = 0; i < m_targetCount; i++)
+    {
+        desc = frameGraph->GetPhysicalDesc(i);
+
+        m_targets[i] = device->CreateRenderTexture(desc.width, desc.height, desc.format, desc.depth);
+        if (!m_targets[i])
+            return false;
+    }
+
+    return true;
+}
+
+void RenderTargetPoolClass::Shutdown()
+{
+    int i;
+
+    if (m_targets)
+    {
+        for (i = 0; i < m_targetCount; i++)
+        {
+            if (m_targets[i])
+                m_targets[i]->Release();
+        }
+
+        delete[] m_targets;
+        m_targets = 0;
+    }
+
+    m_targetCount = 0;
+    m_frameGraph = 0;
+    m_deviceContext = 0;
+
+    return;
+}
+
+// Textures are looked up by graph resource, imported resources return null
+RenderTexture* RenderTargetPoolClass::GetTexture(int resource)
+{
+    int physical;
+
+    physical = m_frameGraph->GetPhysicalIndex(resource);
+    if (physical < 0)
+        return 0;
+
+    return m_targets[physical];
+}
+
+void RenderTargetPoolClass::ApplyTransitions(FrameGraphClass* frameGraph, int pass, FrameGraphClass::TransitionType* transitions, int transitionCount, void* userData)
+{
+    RenderTargetPoolClass* pool;
+    bool unbindInputs, unbindOutputs;
+    int i;
+
+    pool = (RenderTargetPoolClass*)userData;
+
+    // D3D11 tracks the real hazards itself, the runtime only needs a texture to
+    // not be bound as an input and an output at the same time
+    unbindInputs = false;
+    unbindOutputs = false;
+    for (i = 0; i < transitionCount; i++)
+    {
+        if (transitions[i].before == FrameGraphClass::STATE_SHADER_READ)
+            unbindInputs = true;
+
+        if (transitions[i].after == FrameGraphClass::STATE_SHADER_READ)
+            unbindOutputs = true;
+    }
+
+    if (unbindInputs)
+        pool->m_deviceContext->UnbindTextures();
+
+    if (unbindOutputs)
+        pool->m_deviceContext->SetRenderTargets(0, 0);
+
+    return;
+}
+
+// Compiles small graphs, backs their transients with null device textures and
+// executes them, checking the pass order, culling, transitions and which
+// transients share a texture
+bool RenderTargetPoolClass::RunTests(char* filename)
+{
+    NullRenderDeviceClass* device;
+    FrameGraphClass* frameGraph;
+    RenderTargetPoolClass* pool;
+    GraphTestLogType log;
+    FrameGraphClass::TextureDesc desc, smallDesc;
+    ofstream fout;
+    int backBuffer, scratch, blurred, first, second, third, small, overwritten;
+    int draw, blur, redraw, tonemap, compose, unused, dead, replace, clear, scene, text;
+    int failures;
+    bool passed;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    device = new NullRenderDeviceClass;
+    if (!device)
+        return false;
+
+    frameGraph = new FrameGraphClass;
+    if (!frameGraph)
+        return false;
+
+    pool = new RenderTargetPoolClass;
+    if (!pool)
+        return false;
+
+    failures = 0;
+    if (!device->Initialize(256, 256, 1000.0f, 0.1f))
+    {
+        fout << "FAIL could not initialize the null device" << endl;
+        failures++;
+    }
+
+    desc.width = 256;
+    desc.height = 256;
+    desc.format = 28;
+    desc.bytesPerPixel = 4;
+    desc.depth = false;
+
+    smallDesc = desc;
+    smallDesc.width = 128;
+    smallDesc.height = 128;
+
+    // Write, read, overwrite, read: the blur has to see the first draw, not the redraw
+    backBuffer = frameGraph->ImportTexture("BackBuffer", false);
+    scratch = frameGraph->CreateTexture("Scratch", desc);
+    blurred = frameGraph->CreateTexture("Blurred", desc);
+
+    draw = frameGraph->AddPass("Draw", LogPass, &log);
+    frameGraph->Write(draw, scratch);
+
+    blur = frameGraph->AddPass("Blur", LogPass, &log);
+    frameGraph->Read(blur, scratch);
+    frameGraph->Write(blur, blurred);
+
+    redraw = frameGraph->AddPass("Redraw", LogPass, &log);
+    frameGraph->Write(redraw, scratch);
+
+    compose = frameGraph->AddPass("Compose", LogPass, &log);
+    frameGraph->Read(compose, scratch);
+    frameGraph->Read(compose, blurred);
+    frameGraph->Write(compose, backBuffer);
+
+    frameGraph->MarkOutput(backBuffer);
+
+    memset(&log, 0, sizeof(log));
+    log.pool = pool;
+    passed = frameGraph->Compile() && pool->Initialize(device, frameGraph) && frameGraph->Execute(LogTransitions, &log);
+    Check(fout, "overwrite graph compiles and executes", passed, failures);
+
+    Check(fout, "overwrite graph runs in declaration order", (log.passCount == 4) && (GetExecutedPosition(log, draw) == 0) &&
+        (GetExecutedPosition(log, blur) == 1) && (GetExecutedPosition(log, redraw) == 2) && (GetExecutedPosition(log, compose) == 3), failures);
+    Check(fout, "blur reads the draw before the redraw replaces it", HasTransition(log, blur, scratch, FrameGraphClass::STATE_RENDER_TARGET,
+        FrameGraphClass::STATE_SHADER_READ), failures);
+    Check(fout, "redraw takes the read texture back as a target", HasTransition(log, redraw, scratch, FrameGraphClass::STATE_SHADER_READ,
+        FrameGraphClass::STATE_RENDER_TARGET), failures);
+    Check(fout, "overlapping transients get their own textures", pool->GetTexture(scratch) && pool->GetTexture(blurred) &&
+        (pool->GetTexture(scratch) != pool->GetTexture(blurred)) && !pool->GetTexture(backBuffer), failures);
+
+    pool->Shutdown();
+    frameGraph->Reset();
+
+    // A chain of transients, only neighbours are alive at the same time
+    backBuffer = frameGraph->ImportTexture("BackBuffer", false);
+    first = frameGraph->CreateTexture("First", desc);
+    second = frameGraph->CreateTexture("Second", desc);
+    third = frameGraph->CreateTexture("Third", desc);
+    small = frameGraph->CreateTexture("Small", smallDesc);
+    overwritten = frameGraph->CreateTexture("Overwritten", smallDesc);
+
+    draw = frameGraph->AddPass("Draw", LogPass, &log);
+    frameGraph->Write(draw, first);
+
+    // Nothing reads what this writes
+    unused = frameGraph->AddPass("Unused", LogPass, &log);
+    frameGraph->Write(unused, small);
+
+    blur = frameGraph->AddPass("Blur", LogPass, &log);
+    frameGraph->Read(blur, first);
+    frameGraph->Write(blur, second);
+
+    // Replaced before anything reads it
+    dead = frameGraph->AddPass("Dead", LogPass, &log);
+    frameGraph->Write(dead, overwritten);
+
+    replace = frameGraph->AddPass("Replace", LogPass, &log);
+    frameGraph->Write(replace, overwritten);
+
+    tonemap = frameGraph->AddPass("Tonemap", LogPass, &log);
+    frameGraph->Read(tonemap, second);
+    frameGraph->Write(tonemap, third);
+
+    compose = frameGraph->AddPass("Compose", LogPass, &log);
+    frameGraph->Read(compose, third);
+    frameGraph->Read(compose, overwritten);
+    frameGraph->Write(compose, backBuffer);
+
+    frameGraph->MarkOutput(backBuffer);
+
+    memset(&log, 0, sizeof(log));
+    log.pool = pool;
+    passed = frameGraph->Compile() && pool->Initialize(device, frameGraph) && frameGraph->Execute(LogTransitions, &log);
+    Check(fout, "chain graph compiles and executes", passed, failures);
+
+    Check(fout, "pass writing an unread texture is culled", (GetExecutedPosition(log, unused) < 0) && (frameGraph->GetPhysicalIndex(small) < 0),
+        failures);
+    Check(fout, "pass whose version is replaced unread is culled", (GetExecutedPosition(log, dead) < 0) && (GetExecutedPosition(log, replace) >= 0),
+        failures);
+    Check(fout, "chain runs in dependency order", (GetExecutedPosition(log, draw) < GetExecutedPosition(log, blur)) &&
+        (GetExecutedPosition(log, blur) < GetExecutedPosition(log, tonemap)) && (GetExecutedPosition(log, tonemap) < GetExecutedPosition(log, compose)),
+        failures);
+    Check(fout, "first and third share a texture", pool->GetTexture(first) && (pool->GetTexture(first) == pool->GetTexture(third)), failures);
+    Check(fout, "second overlaps both and has its own", pool->GetTexture(second) && (pool->GetTexture(second) != pool->GetTexture(first)), failures);
+    Check(fout, "aliasing saves memory", frameGraph->GetAliasedBytes() < frameGraph->GetTransientBytes(), failures);
+
+    pool->Shutdown();
+    frameGraph->Reset();
+
+    // The engine's own shape, where each pass draws over the last
+    backBuffer = frameGraph->ImportTexture("BackBuffer", false);
+
+    clear = frameGraph->AddPass("Clear", LogPass, &log);
+    frameGraph->Write(clear, backBuffer);
+
+    scene = frameGraph->AddPass("Scene", LogPass, &log);
+    frameGraph->Read(scene, backBuffer);
+    frameGraph->Write(scene, backBuffer);
+
+    text = frameGraph->AddPass("Text", LogPass, &log);
+    frameGraph->Read(text, backBuffer);
+    frameGraph->Write(text, backBuffer);
+
+    frameGraph->MarkOutput(backBuffer);
+
+    memset(&log, 0, sizeof(log));
+    log.pool = pool;
+    passed = frameGraph->Compile() && pool->Initialize(device, frameGraph) && frameGraph->Execute(LogTransitions, &log);
+    Check(fout, "read-write passes all run in order without transitions", passed && (log.passCount == 3) && (log.passes[0] == clear) &&
+        (log.passes[1] == scene) && (log.passes[2] == text) && (log.transitionCount == 0), failures);
+
+    pool->Shutdown();
+
+    fout << endl << failures << " failures" << endl;
+    fout.close();
+
+    printf("%d frame graph test failures, results in %s\n", failures, filename);
+
+    delete pool;
+    pool = 0;
+
+    delete frameGraph;
+    frameGraph = 0;
+
+    device->Shutdown();
+    delete device;
+    device = 0;
+
+    return (failures == 0);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "renderdeviceclass.h"
+#include "framegraphclass.h"
+
+// Creates one texture per physical slot of a compiled frame graph so transient
+// resources that the graph aliased really share memory, and applies the graph's
+// state transitions to the context bindings before each pass.
+class RenderTargetPoolClass
+{
+public:
+    RenderTargetPoolClass();
+    RenderTargetPoolClass(const RenderTargetPoolClass&);
+    ~RenderTargetPoolClass();
+
+    bool Initialize(RenderDeviceClass*, FrameGraphClass*);
+    void Shutdown();
+
+    RenderTexture* GetTexture(int);
+
+    static void ApplyTransitions(FrameGraphClass*, int, FrameGraphClass::TransitionType*, int, void*);
+    static bool RunTests(char*);
+
+private:
+    RenderContextClass* m_deviceContext;
+    FrameGraphClass* m_frameGraph;
+    RenderTexture** m_targets;
+    int m_targetCount;
+};
\ No newline at end of file
@@ -0,0 +1,1565 @@
+#include "softwarerasterizerclass.h"
+#include <math.h>
+#include <fstream>
+using namespace std;
+
+// Initial sizes of the per frame arrays, grown by doubling when a frame needs more
+const int RASTER_TRIANGLE_CAPACITY = 4096;
+const int RASTER_DRAW_CAPACITY = 64;
+const int RASTER_BIN_CAPACITY = 256;
+
+// Byte offsets of the attributes in the engine's vertex layouts
+const int RASTER_TEXCOORD_OFFSET = 12;
+const int RASTER_NORMAL_OFFSET = 20;
+const int RASTER_COLOR_OFFSET = 20;
+
+template <class T> static bool GrowArray(T*& items, int& capacity, int used, int count, int initialCapacity)
+{
+    T* newItems;
+    int newCapacity;
+
+    if (count <= capacity)
+        return true;
+
+    newCapacity = capacity;
+    if (newCapacity == 0)
+        newCapacity = initialCapacity;
+
+    while (newCapacity < count)
+        newCapacity *= 2;
+
+    newItems = new T[newCapacity];
+    if (!newItems)
+        return false;
+
+    if (items)
+    {
+        memcpy(newItems, items, sizeof(T) * used);
+        delete[] items;
+    }
+
+    items = newItems;
+    capacity = newCapacity;
+
+    return true;
+}
+
+static Float4Type Floor(Float4Type value)
+{
+    Float4Type truncated;
+
+    // Truncation rounds negative values up, step those back by one
+    truncated = Int4ToFloat(Float4ToInt(value));
+    return Float4Sub(truncated, Float4And(Float4Greater(truncated, value), Float4Splat(1.0f)));
+}
+
+static Float4Type Saturate(Float4Type value)
+{
+    return Float4Min(Float4Max(value, Float4Zero()), Float4Splat(1.0f));
+}
+
+static Float4Type Select(Float4Type mask, Float4Type a, Float4Type b)
+{
+    return Float4Or(Float4And(mask, a), Float4AndNot(mask, b));
+}
+
+static Float4Type Smoothstep(Float4Type low, Float4Type high, Float4Type value)
+{
+    Float4Type t;
+
+    t = Saturate(Float4Div(Float4Sub(value, low), Float4Sub(high, low)));
+    return Float4Mul(Float4Mul(t, t), Float4Sub(Float4Splat(3.0f), Float4Add(t, t)));
+}
+
+static Float4Type EvaluatePlane(const float* plane, Float4Type x, Float4Type y)
+{
+    return Float4Add(Float4Add(Float4Mul(Float4Splat(plane[0]), x), Float4Mul(Float4Splat(plane[1]), y)), Float4Splat(plane[2]));
+}
+
+// Four RGBA8 pixels to one register per channel in 0..1
+static void UnpackColors(Int4Type pixels, Float4Type* color)
+{
+    Int4Type mask;
+    Float4Type scale;
+
+    mask = Int4Splat(0xff);
+    scale = Float4Splat(1.0f / 255.0f);
+
+    color[0] = Float4Mul(Int4ToFloat(Int4And(pixels, mask)), scale);
+    color[1] = Float4Mul(Int4ToFloat(Int4And(Int4ShiftRight(pixels, 8), mask)), scale);
+    color[2] = Float4Mul(Int4ToFloat(Int4And(Int4ShiftRight(pixels, 16), mask)), scale);
+    color[3] = Float4Mul(Int4ToFloat(Int4ShiftRight(pixels, 24)), scale);
+
+    return;
+}
+
+static Int4Type PackColors(const Float4Type* color)
+{
+    Float4Type scale, half;
+    Int4Type r, g, b, a;
+
+    scale = Float4Splat(255.0f);
+    half = Float4Splat(0.5f);
+
+    r = Float4ToInt(Float4Add(Float4Mul(Saturate(color[0]), scale), half));
+    g = Float4ToInt(Float4Add(Float4Mul(Saturate(color[1]), scale), half));
+    b = Float4ToInt(Float4Add(Float4Mul(Saturate(color[2]), scale), half));
+    a = Float4ToInt(Float4Add(Float4Mul(Saturate(color[3]), scale), half));
+
+    return Int4Or(Int4Or(r, Int4ShiftLeft(g, 8)), Int4Or(Int4ShiftLeft(b, 16), Int4ShiftLeft(a, 24)));
+}
+
+static int WrapCoordinate(int coordinate, int size)
+{
+    coordinate %= size;
+    if (coordinate < 0)
+        coordinate += size;
+
+    return coordinate;
+}
+
+static int CountBits(int mask)
+{
+    return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+SoftwareRasterizerClass::SoftwareRasterizerClass()
+{
+    m_pool = 0;
+    m_backBuffer = 0;
+    m_colorTarget = 0;
+    m_depthTarget = 0;
+    m_targetWidth = 0;
+    m_targetHeight = 0;
+    m_tilesX = 0;
+    m_tilesY = 0;
+
+    m_vertices = 0;
+    m_vertexCapacity = 0;
+    m_triangles = 0;
+    m_triangleCount = 0;
+    m_triangleCapacity = 0;
+    m_draws = 0;
+    m_drawCount = 0;
+    m_drawCapacity = 0;
+    m_bins = 0;
+    m_binCount = 0;
+
+    m_workerPixels = 0;
+    ResetStats();
+}
+
+SoftwareRasterizerClass::SoftwareRasterizerClass(const SoftwareRasterizerClass& other)
+{
+
+}
+
+SoftwareRasterizerClass::~SoftwareRasterizerClass()
+{
+
+}
+
+bool SoftwareRasterizerClass::Initialize(int screenWidth, int screenHeight, WorkStealingPoolClass* pool)
+{
+    int i;
+
+    m_pool = pool;
+
+    // The back buffer and depth buffer share one surface
+    m_backBuffer = CreateSurface(screenWidth, screenHeight, true, true);
+    if (!m_backBuffer)
+        return false;
+
+    m_workerPixels = new unsigned long long[m_pool->GetWorkerCount()];
+    if (!m_workerPixels)
+        return false;
+
+    for (i = 0; i < m_pool->GetWorkerCount(); i++)
+        m_workerPixels[i] = 0;
+
+    SetTargets(m_backBuffer, m_backBuffer);
+    if (!m_bins)
+        return false;
+
+    return true;
+}
+
+void SoftwareRasterizerClass::Shutdown()
+{
+    int i;
+
+    if (m_bins)
+    {
+        for (i = 0; i < m_binCount; i++)
+        {
+            if (m_bins[i].triangles)
+                delete[] m_bins[i].triangles;
+        }
+
+        delete[] m_bins;
+        m_bins = 0;
+    }
+
+    if (m_draws)
+    {
+        delete[] m_draws;
+        m_draws = 0;
+    }
+
+    if (m_triangles)
+    {
+        delete[] m_triangles;
+        m_triangles = 0;
+    }
+
+    if (m_vertices)
+    {
+        delete[] m_vertices;
+        m_vertices = 0;
+    }
+
+    if (m_workerPixels)
+    {
+        delete[] m_workerPixels;
+        m_workerPixels = 0;
+    }
+
+    if (m_backBuffer)
+    {
+        ReleaseSurface(m_backBuffer);
+        m_backBuffer = 0;
+    }
+
+    m_colorTarget = 0;
+    m_depthTarget = 0;
+    m_pool = 0;
+
+    return;
+}
+
+RasterSurfaceType* SoftwareRasterizerClass::CreateSurface(int width, int height, bool color, bool depth)
+{
+    RasterSurfaceType* surface;
+
+    surface = new RasterSurfaceType;
+    if (!surface)
+        return 0;
+
+    surface->width = width;
+    surface->height = height;
+    surface->pitch = (width + 3) & ~3;
+    surface->color = 0;
+    surface->depth = 0;
+
+    if (color)
+    {
+        surface->color = new unsigned int[surface->pitch * height];
+        if (!surface->color)
+        {
+            ReleaseSurface(surface);
+            return 0;
+        }
+
+        memset(surface->color, 0, sizeof(unsigned int) * surface->pitch * height);
+    }
+
+    if (depth)
+    {
+        surface->depth = new float[surface->pitch * height];
+        if (!surface->depth)
+        {
+            ReleaseSurface(surface);
+            return 0;
+        }
+
+        memset(surface->depth, 0, sizeof(float) * surface->pitch * height);
+    }
+
+    return surface;
+}
+
+void SoftwareRasterizerClass::ReleaseSurface(RasterSurfaceType* surface)
+{
+    if (surface->color)
+        delete[] surface->color;
+
+    if (surface->depth)
+        delete[] surface->depth;
+
+    delete surface;
+
+    return;
+}
+
+RasterSurfaceType* SoftwareRasterizerClass::GetBackBuffer()
+{
+    return m_backBuffer;
+}
+
+void SoftwareRasterizerClass::SetTargets(RasterSurfaceType* colorTarget, RasterSurfaceType* depthTarget)
+{
+    if ((colorTarget == m_colorTarget) && (depthTarget == m_depthTarget))
+        return;
+
+    // Whatever was binned belongs to the old targets
+    Flush();
+
+    m_colorTarget = colorTarget;
+    m_depthTarget = depthTarget;
+
+    if (m_colorTarget)
+    {
+        m_targetWidth = m_colorTarget->width;
+        m_targetHeight = m_colorTarget->height;
+    }
+    else if (m_depthTarget)
+    {
+        m_targetWidth = m_depthTarget->width;
+        m_targetHeight = m_depthTarget->height;
+    }
+    else
+    {
+        m_targetWidth = 0;
+        m_targetHeight = 0;
+    }
+
+    m_tilesX = (m_targetWidth + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    m_tilesY = (m_targetHeight + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+
+    if (!ResizeBins(m_tilesX * m_tilesY))
+    {
+        m_tilesX = 0;
+        m_tilesY = 0;
+    }
+
+    return;
+}
+
+void SoftwareRasterizerClass::Clear(float red, float green, float blue, float alpha)
+{
+    Float4Type color[4];
+    unsigned int packed[4];
+    int i, count;
+
+    // Draws made before the clear still have to land first
+    Flush();
+
+    if (m_colorTarget && m_colorTarget->color)
+    {
+        color[0] = Float4Splat(red);
+        color[1] = Float4Splat(green);
+        color[2] = Float4Splat(blue);
+        color[3] = Float4Splat(alpha);
+        Int4Store(packed, PackColors(color));
+
+        count = m_colorTarget->pitch * m_colorTarget->height;
+        for (i = 0; i < count; i++)
+            m_colorTarget->color[i] = packed[0];
+    }
+
+    if (m_depthTarget && m_depthTarget->depth)
+    {
+        count = m_depthTarget->pitch * m_depthTarget->height;
+        for (i = 0; i < count; i++)
+            m_depthTarget->depth[i] = 1.0f;
+    }
+
+    return;
+}
+
+bool SoftwareRasterizerClass::Draw(const RasterDrawType& draw, const float* positionMatrix, const float* normalMatrix, const unsigned char* vertices,
+    unsigned int stride, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, int baseVertex)
+{
+    std::chrono::high_resolution_clock::time_point startTime;
+    unsigned int i, minIndex, maxIndex;
+    int first, last, drawIndex;
+    bool result;
+
+    if ((indexCount < 3) || (m_tilesX == 0))
+        return true;
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    // Only run the vertex stage on the part of the buffer the indices use
+    minIndex = indices[0];
+    maxIndex = indices[0];
+    for (i = 1; i < indexCount; i++)
+    {
+        if (indices[i] < minIndex)
+            minIndex = indices[i];
+        if (indices[i] > maxIndex)
+            maxIndex = indices[i];
+    }
+
+    first = (int)minIndex + baseVertex;
+    last = (int)maxIndex + baseVertex;
+    if ((first < 0) || (last >= (int)vertexCount))
+        return false;
+
+    result = GrowArray(m_draws, m_drawCapacity, m_drawCount, m_drawCount + 1, RASTER_DRAW_CAPACITY);
+    if (!result)
+        return false;
+
+    drawIndex = m_drawCount;
+    m_draws[drawIndex] = draw;
+    m_drawCount++;
+
+    result = TransformVertices(draw, positionMatrix, normalMatrix, vertices, stride, first, last);
+    if (!result)
+        return false;
+
+    // Triangle lists only, the vertex stage output is indexed relative to the first vertex
+    for (i = 0; (i + 2) < indexCount; i += 3)
+    {
+        result = AddTriangle(m_vertices[indices[i] + baseVertex - first], m_vertices[indices[i + 1] + baseVertex - first],
+            m_vertices[indices[i + 2] + baseVertex - first], drawIndex);
+        if (!result)
+            return false;
+    }
+
+    m_stats.drawCalls++;
+    m_stats.trianglesSubmitted += indexCount / 3;
+    m_stats.vertexSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    return true;
+}
+
+void SoftwareRasterizerClass::Flush()
+{
+    std::chrono::high_resolution_clock::time_point startTime;
+    int i;
+
+    if (m_triangleCount == 0)
+    {
+        m_drawCount = 0;
+        return;
+    }
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    for (i = 0; i < m_pool->GetWorkerCount(); i++)
+        m_workerPixels[i] = 0;
+
+    // Every tile only touches its own pixels so they can all be shaded at once
+    m_pool->Run(m_tilesX * m_tilesY, ShadeTileTask, this);
+
+    for (i = 0; i < m_pool->GetWorkerCount(); i++)
+        m_stats.pixelsShaded += m_workerPixels[i];
+
+    for (i = 0; i < m_tilesX * m_tilesY; i++)
+        m_bins[i].count = 0;
+
+    m_triangleCount = 0;
+    m_drawCount = 0;
+
+    m_stats.rasterSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    return;
+}
+
+bool SoftwareRasterizerClass::SavePPM(char* filename)
+{
+    ofstream fout;
+    unsigned char* row;
+    unsigned int pixel;
+    int x, y;
+
+    if (!m_backBuffer->color)
+        return false;
+
+    row = new unsigned char[m_backBuffer->width * 3];
+    if (!row)
+        return false;
+
+    fout.open(filename, ios::out | ios::binary);
+    if (fout.fail())
+    {
+        delete[] row;
+        return false;
+    }
+
+    fout << "P6\n" << m_backBuffer->width << " " << m_backBuffer->height << "\n255\n";
+
+    for (y = 0; y < m_backBuffer->height; y++)
+    {
+        for (x = 0; x < m_backBuffer->width; x++)
+        {
+            pixel = m_backBuffer->color[y * m_backBuffer->pitch + x];
+            row[x * 3 + 0] = (unsigned char)(pixel & 0xff);
+            row[x * 3 + 1] = (unsigned char)((pixel >> 8) & 0xff);
+            row[x * 3 + 2] = (unsigned char)((pixel >> 16) & 0xff);
+        }
+
+        fout.write((char*)row, m_backBuffer->width * 3);
+    }
+
+    fout.close();
+
+    delete[] row;
+
+    return true;
+}
+
+RasterStatsType SoftwareRasterizerClass::GetStats()
+{
+    return m_stats;
+}
+
+void SoftwareRasterizerClass::ResetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    return;
+}
+
+int SoftwareRasterizerClass::GetAttributeCount(RasterProgramType program)
+{
+    // Texture coordinates, plus the normal for the light program or the colour for the font program
+    if (program == RASTER_PROGRAM_LIGHT)
+        return 5;
+
+    if ((program == RASTER_PROGRAM_FONT) || (program == RASTER_PROGRAM_FONT_DISTANCE))
+        return 6;
+
+    return 2;
+}
+
+bool SoftwareRasterizerClass::TransformVertices(const RasterDrawType& draw, const float* positionMatrix, const float* normalMatrix,
+    const unsigned char* vertices, unsigned int stride, unsigned int first, unsigned int last)
+{
+    Float4Type row0, row1, row2, row3, normal0, normal1, normal2, result;
+    const float* input;
+    float* normal;
+    float length;
+    unsigned int i;
+    int count;
+    bool transformNormal;
+
+    count = (int)(last - first) + 1;
+    if (count > m_vertexCapacity)
+    {
+        if (m_vertices)
+            delete[] m_vertices;
+
+        m_vertices = new ClipVertexType[count];
+        if (!m_vertices)
+        {
+            m_vertexCapacity = 0;
+            return false;
+        }
+
+        m_vertexCapacity = count;
+    }
+
+    // Row vectors times row major matrices, the same as mul(v, M) in the shaders
+    row0 = Float4Load(&positionMatrix[0]);
+    row1 = Float4Load(&positionMatrix[4]);
+    row2 = Float4Load(&positionMatrix[8]);
+    row3 = Float4Load(&positionMatrix[12]);
+
+    transformNormal = (draw.program == RASTER_PROGRAM_LIGHT) && normalMatrix;
+    normal0 = Float4Zero();
+    normal1 = Float4Zero();
+    normal2 = Float4Zero();
+    if (transformNormal)
+    {
+        normal0 = Float4Load(&normalMatrix[0]);
+        normal1 = Float4Load(&normalMatrix[4]);
+        normal2 = Float4Load(&normalMatrix[8]);
+    }
+
+    for (i = first; i <= last; i++)
+    {
+        ClipVertexType& output = m_vertices[i - first];
+
+        input = (const float*)(vertices + i * stride);
+
+        // The vertex shaders force w to one
+        result = Float4Add(Float4Add(Float4Mul(Float4Splat(input[0]), row0), Float4Mul(Float4Splat(input[1]), row1)),
+            Float4Add(Float4Mul(Float4Splat(input[2]), row2), row3));
+        Float4Store(output.position, result);
+
+        input = (const float*)(vertices + i * stride + RASTER_TEXCOORD_OFFSET);
+        output.attributes[0] = input[0];
+        output.attributes[1] = input[1];
+
+        if ((draw.program == RASTER_PROGRAM_FONT) || (draw.program == RASTER_PROGRAM_FONT_DISTANCE))
+        {
+            input = (const float*)(vertices + i * stride + RASTER_COLOR_OFFSET);
+            memcpy(&output.attributes[2], input, 4 * sizeof(float));
+        }
+
+        if (transformNormal)
+        {
+            input = (const float*)(vertices + i * stride + RASTER_NORMAL_OFFSET);
+            result = Float4Add(Float4Add(Float4Mul(Float4Splat(input[0]), normal0), Float4Mul(Float4Splat(input[1]), normal1)),
+                Float4Mul(Float4Splat(input[2]), normal2));
+
+            normal = &output.attributes[2];
+            normal[0] = Float4GetX(result);
+            normal[1] = Float4GetX(Float4Swizzle<1, 1, 1, 1>(result));
+            normal[2] = Float4GetX(Float4Swizzle<2, 2, 2, 2>(result));
+
+            length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.0f)
+            {
+                normal[0] /= length;
+                normal[1] /= length;
+                normal[2] /= length;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool SoftwareRasterizerClass::AddTriangle(const ClipVertexType& v0, const ClipVertexType& v1, const ClipVertexType& v2, int draw)
+{
+    const ClipVertexType* input[3];
+    ClipVertexType clipped[4];
+    float distance[3], t;
+    int i, j, next, clippedCount, attributeCount;
+    bool result;
+
+    input[0] = &v0;
+    input[1] = &v1;
+    input[2] = &v2;
+
+    // Throw away triangles completely outside one of the clip planes
+    if ((v0.position[0] < -v0.position[3]) && (v1.position[0] < -v1.position[3]) && (v2.position[0] < -v2.position[3]))
+        return true;
+    if ((v0.position[0] > v0.position[3]) && (v1.position[0] > v1.position[3]) && (v2.position[0] > v2.position[3]))
+        return true;
+    if ((v0.position[1] < -v0.position[3]) && (v1.position[1] < -v1.position[3]) && (v2.position[1] < -v2.position[3]))
+        return true;
+    if ((v0.position[1] > v0.position[3]) && (v1.position[1] > v1.position[3]) && (v2.position[1] > v2.position[3]))
+        return true;
+    if ((v0.position[2] > v0.position[3]) && (v1.position[2] > v1.position[3]) && (v2.position[2] > v2.position[3]))
+        return true;
+
+    for (i = 0; i < 3; i++)
+        distance[i] = input[i]->position[2];
+
+    if ((distance[0] >= 0.0f) && (distance[1] >= 0.0f) && (distance[2] >= 0.0f))
+        return SetupTriangle(v0, v1, v2, draw);
+
+    if ((distance[0] < 0.0f) && (distance[1] < 0.0f) && (distance[2] < 0.0f))
+        return true;
+
+    // Cut the triangle at the near plane, z = 0 in clip space, which leaves one or two triangles
+    attributeCount = GetAttributeCount(m_draws[draw].program);
+    clippedCount = 0;
+    for (i = 0; i < 3; i++)
+    {
+        next = (i + 1) % 3;
+
+        if (distance[i] >= 0.0f)
+        {
+            clipped[clippedCount] = *input[i];
+            clippedCount++;
+        }
+
+        if ((distance[i] >= 0.0f) != (distance[next] >= 0.0f))
+        {
+            t = distance[i] / (distance[i] - distance[next]);
+
+            for (j = 0; j < 4; j++)
+                clipped[clippedCount].position[j] = input[i]->position[j] + (input[next]->position[j] - input[i]->position[j]) * t;
+
+            for (j = 0; j < attributeCount; j++)
+                clipped[clippedCount].attributes[j] = input[i]->attributes[j] + (input[next]->attributes[j] - input[i]->attributes[j]) * t;
+
+            clippedCount++;
+        }
+    }
+
+    for (i = 1; (i + 1) < clippedCount; i++)
+    {
+        result = SetupTriangle(clipped[0], clipped[i], clipped[i + 1], draw);
+        if (!result)
+            return false;
+    }
+
+    return true;
+}
+
+bool SoftwareRasterizerClass::SetupTriangle(const ClipVertexType& v0, const ClipVertexType& v1, const ClipVertexType& v2, int draw)
+{
+    const ClipVertexType* input[3];
+    float x[3], y[3], values[3][RASTER_MAX_PLANES];
+    float inverseW, area, minX, maxX, minY, maxY, tileLeft, tileTop, best;
+    int i, j, next, planeCount, tileMinX, tileMinY, tileMaxX, tileMaxY, tileX, tileY, triangle;
+    bool result, outside;
+
+    input[0] = &v0;
+    input[1] = &v1;
+    input[2] = &v2;
+
+    planeCount = GetAttributeCount(m_draws[draw].program) + 2;
+
+    // Project to pixels, y grows down the screen
+    for (i = 0; i < 3; i++)
+    {
+        inverseW = 1.0f / input[i]->position[3];
+
+        x[i] = (input[i]->position[0] * inverseW * 0.5f + 0.5f) * (float)m_targetWidth;
+        y[i] = (0.5f - input[i]->position[1] * inverseW * 0.5f) * (float)m_targetHeight;
+
+        // Depth and 1/w interpolate linearly on screen, the attributes go in divided by w
+        values[i][0] = input[i]->position[2] * inverseW;
+        values[i][1] = inverseW;
+        for (j = 2; j < planeCount; j++)
+            values[i][j] = input[i]->attributes[j - 2] * inverseW;
+    }
+
+    // Clockwise triangles face the camera, back faces are culled like the D3D rasterizer state
+    area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (!(area > 0.0f))
+        return true;
+
+    minX = x[0]; maxX = x[0];
+    minY = y[0]; maxY = y[0];
+    for (i = 1; i < 3; i++)
+    {
+        if (x[i] < minX) minX = x[i];
+        if (x[i] > maxX) maxX = x[i];
+        if (y[i] < minY) minY = y[i];
+        if (y[i] > maxY) maxY = y[i];
+    }
+
+    if ((maxX < 0.0f) || (maxY < 0.0f) || (minX > (float)m_targetWidth) || (minY > (float)m_targetHeight))
+        return true;
+
+    result = GrowArray(m_triangles, m_triangleCapacity, m_triangleCount, m_triangleCount + 1, RASTER_TRIANGLE_CAPACITY);
+    if (!result)
+        return false;
+
+    // Clamp before converting so far off screen vertices can't overflow
+    if (minX < 0.0f) minX = 0.0f;
+    if (minY < 0.0f) minY = 0.0f;
+    if (maxX > (float)(m_targetWidth - 1)) maxX = (float)(m_targetWidth - 1);
+    if (maxY > (float)(m_targetHeight - 1)) maxY = (float)(m_targetHeight - 1);
+
+    triangle = m_triangleCount;
+    TriangleType& setup = m_triangles[triangle];
+
+    setup.draw = draw;
+    setup.minX = (int)floorf(minX);
+    setup.minY = (int)floorf(minY);
+    setup.maxX = (int)ceilf(maxX);
+    setup.maxY = (int)ceilf(maxY);
+
+    // Edge i runs from vertex i to the next one and is positive inside
+    for (i = 0; i < 3; i++)
+    {
+        next = (i + 1) % 3;
+
+        setup.edges[i][0] = y[i] - y[next];
+        setup.edges[i][1] = x[next] - x[i];
+        setup.edges[i][2] = -(setup.edges[i][0] * x[i] + setup.edges[i][1] * y[i]);
+
+        // Pixels exactly on a shared edge belong to the triangle it is a top or left edge of
+        setup.topLeft[i] = 0;
+        if ((setup.edges[i][0] > 0.0f) || ((setup.edges[i][0] == 0.0f) && (setup.edges[i][1] > 0.0f)))
+            setup.topLeft[i] = -1;
+    }
+
+    // Planes through the three vertex values, from the barycentric weights of each vertex
+    for (j = 0; j < planeCount; j++)
+    {
+        for (i = 0; i < 3; i++)
+            setup.planes[j][i] = (values[0][j] * setup.edges[1][i] + values[1][j] * setup.edges[2][i] + values[2][j] * setup.edges[0][i]) / area;
+    }
+
+    m_triangleCount++;
+    m_stats.trianglesRasterized++;
+
+    // Bin into every tile the bounds touch unless an edge rules the whole tile out
+    tileMinX = setup.minX / RASTER_TILE_SIZE;
+    tileMinY = setup.minY / RASTER_TILE_SIZE;
+    tileMaxX = setup.maxX / RASTER_TILE_SIZE;
+    tileMaxY = setup.maxY / RASTER_TILE_SIZE;
+
+    for (tileY = tileMinY; tileY <= tileMaxY; tileY++)
+    {
+        for (tileX = tileMinX; tileX <= tileMaxX; tileX++)
+        {
+            tileLeft = (float)(tileX * RASTER_TILE_SIZE) + 0.5f;
+            tileTop = (float)(tileY * RASTER_TILE_SIZE) + 0.5f;
+
+            outside = false;
+            for (i = 0; i < 3; i++)
+            {
+                best = setup.edges[i][2];
+                best += setup.edges[i][0] * (setup.edges[i][0] > 0.0f ? tileLeft + RASTER_TILE_SIZE - 1 : tileLeft);
+                best += setup.edges[i][1] * (setup.edges[i][1] > 0.0f ? tileTop + RASTER_TILE_SIZE - 1 : tileTop);
+                if (best < 0.0f)
+                    outside = true;
+            }
+
+            if (outside)
+                continue;
+
+            BinType& bin = m_bins[tileY * m_tilesX + tileX];
+            result = GrowArray(bin.triangles, bin.capacity, bin.count, bin.count + 1, RASTER_BIN_CAPACITY);
+            if (!result)
+                return false;
+
+            bin.triangles[bin.count] = triangle;
+            bin.count++;
+            m_stats.tileBins++;
+        }
+    }
+
+    return true;
+}
+
+bool SoftwareRasterizerClass::ResizeBins(int binCount)
+{
+    BinType* bins;
+    int i;
+
+    if (binCount <= m_binCount)
+        return true;
+
+    bins = new BinType[binCount];
+    if (!bins)
+        return false;
+
+    for (i = 0; i < binCount; i++)
+    {
+        bins[i].triangles = 0;
+        bins[i].count = 0;
+        bins[i].capacity = 0;
+    }
+
+    if (m_bins)
+    {
+        for (i = 0; i < m_binCount; i++)
+            bins[i] = m_bins[i];
+
+        delete[] m_bins;
+    }
+
+    m_bins = bins;
+    m_binCount = binCount;
+
+    return true;
+}
+
+void SoftwareRasterizerClass::ShadeTileTask(int task, int worker, void* userData)
+{
+    ((SoftwareRasterizerClass*)userData)->ShadeTile(task, worker);
+    return;
+}
+
+void SoftwareRasterizerClass::ShadeTile(int tile, int worker)
+{
+    Float4Type laneOffsets, px, py, edge[3], step[3], inside, z, depth, src[4], dst[4], invAlpha;
+    Int4Type old;
+    unsigned int* colorRow;
+    float* depthRow;
+    int tileX0, tileY0, tileX1, tileY1, minX, minY, maxX, maxY, x, y, i, t, mask;
+    unsigned long long pixels;
+
+    BinType& bin = m_bins[tile];
+    if (bin.count == 0)
+        return;
+
+    tileX0 = (tile % m_tilesX) * RASTER_TILE_SIZE;
+    tileY0 = (tile / m_tilesX) * RASTER_TILE_SIZE;
+    tileX1 = tileX0 + RASTER_TILE_SIZE - 1;
+    tileY1 = tileY0 + RASTER_TILE_SIZE - 1;
+    if (tileX1 > m_targetWidth - 1) tileX1 = m_targetWidth - 1;
+    if (tileY1 > m_targetHeight - 1) tileY1 = m_targetHeight - 1;
+
+    laneOffsets = Float4Set(0.5f, 1.5f, 2.5f, 3.5f);
+    pixels = 0;
+
+    for (t = 0; t < bin.count; t++)
+    {
+        const TriangleType& triangle = m_triangles[bin.triangles[t]];
+        const RasterDrawType& draw = m_draws[triangle.draw];
+
+        minX = triangle.minX > tileX0 ? triangle.minX : tileX0;
+        minY = triangle.minY > tileY0 ? triangle.minY : tileY0;
+        maxX = triangle.maxX < tileX1 ? triangle.maxX : tileX1;
+        maxY = triangle.maxY < tileY1 ? triangle.maxY : tileY1;
+
+        // Tiles and pitches are multiples of four so every group of four stays inside the row
+        minX &= ~3;
+
+        for (i = 0; i < 3; i++)
+            step[i] = Float4Splat(triangle.edges[i][0] * 4.0f);
+
+        for (y = minY; y <= maxY; y++)
+        {
+            py = Float4Splat((float)y + 0.5f);
+            px = Float4Add(Float4Splat((float)minX), laneOffsets);
+
+            for (i = 0; i < 3; i++)
+                edge[i] = EvaluatePlane(triangle.edges[i], px, py);
+
+            colorRow = 0;
+            if (m_colorTarget && m_colorTarget->color)
+                colorRow = &m_colorTarget->color[y * m_colorTarget->pitch];
+
+            depthRow = 0;
+            if (draw.depthEnabled && m_depthTarget && m_depthTarget->depth)
+                depthRow = &m_depthTarget->depth[y * m_depthTarget->pitch];
+
+            for (x = minX; x <= maxX; x += 4)
+            {
+                inside = Float4Splat(0.0f);
+                inside = Float4Equal(inside, inside);
+                for (i = 0; i < 3; i++)
+                {
+                    inside = Float4And(inside, Float4Or(Float4Greater(edge[i], Float4Zero()),
+                        Float4And(Float4Equal(edge[i], Float4Zero()), Int4AsFloat(Int4Splat(triangle.topLeft[i])))));
+                    edge[i] = Float4Add(edge[i], step[i]);
+                }
+
+                // Keep the padding at the end of the row untouched
+                if (x + 4 > m_targetWidth)
+                    inside = Float4And(inside, Float4Less(px, Float4Splat((float)m_targetWidth)));
+
+                mask = Float4MoveMask(inside);
+                if (mask == 0)
+                {
+                    px = Float4Add(px, Float4Splat(4.0f));
+                    continue;
+                }
+
+                // Depth test LESS and write, as set up by D3DClass
+                if (depthRow)
+                {
+                    z = EvaluatePlane(triangle.planes[0], px, py);
+                    depth = Float4Load(&depthRow[x]);
+                    inside = Float4And(inside, Float4Less(z, depth));
+
+                    mask = Float4MoveMask(inside);
+                    if (mask == 0)
+                    {
+                        px = Float4Add(px, Float4Splat(4.0f));
+                        continue;
+                    }
+
+                    Float4Store(&depthRow[x], Select(inside, z, depth));
+                }
+
+                pixels += CountBits(mask);
+
+                if (colorRow)
+                {
+                    ShadeQuad(triangle, draw, px, py, src);
+
+                    old = Int4Load(&colorRow[x]);
+
+                    // ONE, INV_SRC_ALPHA on colour and ONE, ZERO on alpha
+                    if (draw.blendEnabled)
+                    {
+                        UnpackColors(old, dst);
+                        invAlpha = Float4Sub(Float4Splat(1.0f), src[3]);
+                        for (i = 0; i < 3; i++)
+                            src[i] = Float4Add(src[i], Float4Mul(dst[i], invAlpha));
+                    }
+
+                    Int4Store(&colorRow[x], Float4AsInt(Select(inside, Int4AsFloat(PackColors(src)), Int4AsFloat(old))));
+                }
+
+                px = Float4Add(px, Float4Splat(4.0f));
+            }
+        }
+    }
+
+    m_workerPixels[worker] += pixels;
+
+    return;
+}
+
+// The pixel shaders from light.ps, font.ps and texture.ps for four pixels
+void SoftwareRasterizerClass::ShadeQuad(const TriangleType& triangle, const RasterDrawType& draw, Float4Type px, Float4Type py, Float4Type* color)
+{
+    Float4Type w, u, v, normal[3], intensity, textureColor[4], vertexColor, hasInk, distance, width, alpha;
+    int i;
+
+    w = Float4Div(Float4Splat(1.0f), EvaluatePlane(triangle.planes[1], px, py));
+    u = Float4Mul(EvaluatePlane(triangle.planes[2], px, py), w);
+    v = Float4Mul(EvaluatePlane(triangle.planes[3], px, py), w);
+
+    Sample(draw.texture, u, v, textureColor);
+
+    switch (draw.program)
+    {
+        case RASTER_PROGRAM_LIGHT:
+        {
+            for (i = 0; i < 3; i++)
+                normal[i] = Float4Mul(EvaluatePlane(triangle.planes[4 + i], px, py), w);
+
+            intensity = Float4Mul(normal[0], Float4Splat(-draw.lightDirection[0]));
+            intensity = Float4Add(intensity, Float4Mul(normal[1], Float4Splat(-draw.lightDirection[1])));
+            intensity = Float4Add(intensity, Float4Mul(normal[2], Float4Splat(-draw.lightDirection[2])));
+            intensity = Saturate(intensity);
+
+            for (i = 0; i < 4; i++)
+                color[i] = Float4Mul(Saturate(Float4Mul(Float4Splat(draw.diffuseColor[i]), intensity)), textureColor[i]);
+
+            break;
+        }
+
+        case RASTER_PROGRAM_FONT:
+        {
+            // Black texels are transparent, the rest take the colour from the vertices
+            hasInk = Float4NotEqual(textureColor[0], Float4Zero());
+
+            for (i = 0; i < 3; i++)
+            {
+                vertexColor = Float4Mul(EvaluatePlane(triangle.planes[4 + i], px, py), w);
+                color[i] = Select(hasInk, Float4Mul(textureColor[i], vertexColor), textureColor[i]);
+            }
+
+            vertexColor = Float4Mul(EvaluatePlane(triangle.planes[7], px, py), w);
+            color[3] = Float4And(hasInk, vertexColor);
+
+            break;
+        }
+
+        case RASTER_PROGRAM_FONT_DISTANCE:
+        {
+            // The shader's ddx pairs up neighbouring pixels, and so does this.
+            // There's no ddy on one row so the edge width only uses ddx, which
+            // is the same for text that isn't rotated.
+            distance = textureColor[0];
+            width = Float4Sub(distance, Float4Swizzle<1, 0, 3, 2>(distance));
+            width = Float4Max(width, Float4Sub(Float4Zero(), width));
+            width = Float4Max(width, Float4Splat(0.001f));
+
+            alpha = Smoothstep(Float4Sub(Float4Splat(0.5f), width), Float4Add(Float4Splat(0.5f), width), distance);
+            alpha = Float4Mul(alpha, Float4Mul(EvaluatePlane(triangle.planes[7], px, py), w));
+
+            // Premultiplied like the shader's output
+            for (i = 0; i < 3; i++)
+                color[i] = Float4Mul(Float4Mul(EvaluatePlane(triangle.planes[4 + i], px, py), w), alpha);
+            color[3] = alpha;
+
+            break;
+        }
+
+        default:
+        {
+            for (i = 0; i < 4; i++)
+                color[i] = textureColor[i];
+
+            break;
+        }
+    }
+
+    return;
+}
+
+// Bilinear filtering with wrap addressing on the top level, like the linear wrap sampler
+void SoftwareRasterizerClass::Sample(const RasterSurfaceType* texture, Float4Type u, Float4Type v, Float4Type* color)
+{
+    Float4Type x, y, x0, y0, fx, fy, c00[4], c10[4], c01[4], c11[4], top, bottom;
+    int ix[4], iy[4], i, column0, column1, row0, row1;
+    unsigned int t00[4], t10[4], t01[4], t11[4];
+
+    if (!texture || !texture->color)
+    {
+        for (i = 0; i < 4; i++)
+            color[i] = Float4Splat(1.0f);
+        return;
+    }
+
+    x = Float4Sub(Float4Mul(u, Float4Splat((float)texture->width)), Float4Splat(0.5f));
+    y = Float4Sub(Float4Mul(v, Float4Splat((float)texture->height)), Float4Splat(0.5f));
+    x0 = Floor(x);
+    y0 = Floor(y);
+    fx = Float4Sub(x, x0);
+    fy = Float4Sub(y, y0);
+
+    Int4Store(ix, Float4ToInt(x0));
+    Int4Store(iy, Float4ToInt(y0));
+
+    // The fetches are scalar, the filtering runs on all four pixels at once
+    for (i = 0; i < 4; i++)
+    {
+        column0 = WrapCoordinate(ix[i], texture->width);
+        column1 = WrapCoordinate(ix[i] + 1, texture->width);
+        row0 = WrapCoordinate(iy[i], texture->height) * texture->pitch;
+        row1 = WrapCoordinate(iy[i] + 1, texture->height) * texture->pitch;
+
+        t00[i] = texture->color[row0 + column0];
+        t10[i] = texture->color[row0 + column1];
+        t01[i] = texture->color[row1 + column0];
+        t11[i] = texture->color[row1 + column1];
+    }
+
+    UnpackColors(Int4Load(t00), c00);
+    UnpackColors(Int4Load(t10), c10);
+    UnpackColors(Int4Load(t01), c01);
+    UnpackColors(Int4Load(t11), c11);
+
+    for (i = 0; i < 4; i++)
+    {
+        top = Float4Add(c00[i], Float4Mul(Float4Sub(c10[i], c00[i]), fx));
+        bottom = Float4Add(c01[i], Float4Mul(Float4Sub(c11[i], c01[i]), fx));
+        color[i] = Float4Add(top, Float4Mul(Float4Sub(bottom, top), fy));
+    }
+
+    return;
+}
+
+// The texture program's vertex, a position and texture coordinates
+struct RasterTestVertexType
+{
+    float x, y, z, u, v;
+};
+
+static void Check(ofstream& fout, const char* name, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << name << endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+// The same rounding PackColors does
+static unsigned int PackTestColor(float red, float green, float blue, float alpha)
+{
+    return (unsigned int)(red * 255.0f + 0.5f) | ((unsigned int)(green * 255.0f + 0.5f) << 8) | ((unsigned int)(blue * 255.0f + 0.5f) << 16) |
+        ((unsigned int)(alpha * 255.0f + 0.5f) << 24);
+}
+
+static unsigned int NextTestRandom(unsigned int& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Corners in pixels, y down, turned into clip space with w one. Depth runs
+// from leftZ on the left edge to rightZ on the right. Two clockwise triangles.
+static void AddTestQuad(RasterTestVertexType* vertices, unsigned int* indices, int quad, float left, float top, float right, float bottom,
+    float leftZ, float rightZ, int width, int height)
+{
+    RasterTestVertexType* corner;
+    unsigned int* index;
+
+    corner = &vertices[quad * 4];
+    index = &indices[quad * 6];
+
+    corner[0].x = left / (float)width * 2.0f - 1.0f;
+    corner[0].y = 1.0f - top / (float)height * 2.0f;
+    corner[0].z = leftZ;
+    corner[1].x = right / (float)width * 2.0f - 1.0f;
+    corner[1].y = corner[0].y;
+    corner[1].z = rightZ;
+    corner[2].x = corner[1].x;
+    corner[2].y = 1.0f - bottom / (float)height * 2.0f;
+    corner[2].z = rightZ;
+    corner[3].x = corner[0].x;
+    corner[3].y = corner[2].y;
+    corner[3].z = leftZ;
+
+    corner[0].u = 0.0f; corner[0].v = 0.0f;
+    corner[1].u = 1.0f; corner[1].v = 0.0f;
+    corner[2].u = 1.0f; corner[2].v = 1.0f;
+    corner[3].u = 0.0f; corner[3].v = 1.0f;
+
+    index[0] = quad * 4;
+    index[1] = quad * 4 + 1;
+    index[2] = quad * 4 + 2;
+    index[3] = quad * 4;
+    index[4] = quad * 4 + 2;
+    index[5] = quad * 4 + 3;
+
+    return;
+}
+
+static bool DrawTest(SoftwareRasterizerClass& rasterizer, const RasterDrawType& draw, const RasterTestVertexType* vertices, unsigned int vertexCount,
+    const unsigned int* indices, unsigned int indexCount)
+{
+    const float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+    return rasterizer.Draw(draw, identity, 0, (const unsigned char*)vertices, sizeof(RasterTestVertexType), vertexCount, indices, indexCount, 0);
+}
+
+// Draws random overlapping triangles with depth and blending, for comparing worker counts
+static bool DrawTestScene(SoftwareRasterizerClass& rasterizer, RasterDrawType& draw, RasterSurfaceType** textures, int textureCount)
+{
+    RasterTestVertexType vertices[3];
+    unsigned int indices[3] = { 0, 1, 2 };
+    RasterTestVertexType swap;
+    unsigned int seed;
+    int i, j;
+
+    seed = 7;
+    rasterizer.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+    for (i = 0; i < 200; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            vertices[j].x = (float)(NextTestRandom(seed) % 2400) / 1000.0f - 1.2f;
+            vertices[j].y = (float)(NextTestRandom(seed) % 2400) / 1000.0f - 1.2f;
+            vertices[j].z = (float)(NextTestRandom(seed) % 1000) / 1000.0f;
+            vertices[j].u = 0.0f;
+            vertices[j].v = 0.0f;
+        }
+
+        // Clockwise on screen, which is anticlockwise with y up
+        if ((vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) - (vertices[1].y - vertices[0].y) * (vertices[2].x - vertices[0].x) > 0.0f)
+        {
+            swap = vertices[1];
+            vertices[1] = vertices[2];
+            vertices[2] = swap;
+        }
+
+        draw.depthEnabled = (i % 3) != 0;
+        draw.blendEnabled = (i % 4) == 0;
+        draw.texture = textures[i % textureCount];
+        if (!DrawTest(rasterizer, draw, vertices, 3, indices, 3))
+            return false;
+    }
+
+    rasterizer.Flush();
+
+    return true;
+}
+
+// Draws small scenes whose result is known exactly on a target that isn't a
+// multiple of the tile size or of four pixels, and checks every pixel: the
+// clear, rectangles across tile edges painted in order, shared edges covered
+// once, depth testing against interpolated depth, blending, and the same
+// image whatever the number of workers. Writes the report to the file.
+bool SoftwareRasterizerClass::RunTests(char* filename)
+{
+    const int width = 333, height = 211, rectangleCount = 40, fanCount = 9, paletteCount = 8, gridColumns = 6, gridRows = 4, gridSize = 24;
+    const int workerCounts[2] = { 1, 4 };
+    const unsigned int half = 0x80404040u, red = 0xff0000ffu, green = 0xff00ff00u, blue = 0xffff0000u;
+    ofstream fout;
+    WorkStealingPoolClass pools[2];
+    SoftwareRasterizerClass rasterizers[2];
+    RasterSurfaceType* textures[paletteCount + 4];
+    RasterSurfaceType* target;
+    RasterSurfaceType* grid;
+    RasterTestVertexType* vertices;
+    unsigned int* indices;
+    unsigned int* expected;
+    unsigned int* images[2];
+    RasterDrawType draw;
+    RasterStatsType stats;
+    float left, top, right, bottom, angle, z, channel, alpha;
+    unsigned int seed, color, once, background;
+    unsigned long long covered;
+    int failures, pass, i, x, y, x0, x1, y0, y1, count, mismatches, doubled, difference;
+    bool passed, result, inGrid;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    vertices = new RasterTestVertexType[rectangleCount * 4];
+    indices = new unsigned int[rectangleCount * 6];
+    expected = new unsigned int[width * height];
+    images[0] = new unsigned int[width * height];
+    images[1] = new unsigned int[width * height];
+    grid = CreateSurface(256, 128, true, true);
+    if (!vertices || !indices || !expected || !images[0] || !images[1] || !grid)
+        return false;
+
+    // One texel textures, so the texture program draws their colour exactly.
+    // A random palette, then the blended, red, green and blue colours.
+    seed = 1;
+    result = true;
+    for (i = 0; i < paletteCount + 4; i++)
+    {
+        textures[i] = CreateSurface(1, 1, true, false);
+        if (!textures[i])
+            return false;
+
+        textures[i]->color[0] = NextTestRandom(seed) | 0xff000000u;
+    }
+    textures[paletteCount]->color[0] = half;
+    textures[paletteCount + 1]->color[0] = red;
+    textures[paletteCount + 2]->color[0] = green;
+    textures[paletteCount + 3]->color[0] = blue;
+
+    for (i = 0; i < 2; i++)
+    {
+        result = result && pools[i].Initialize(workerCounts[i]);
+        result = result && rasterizers[i].Initialize(width, height, &pools[i]);
+    }
+
+    failures = 0;
+    if (!result)
+    {
+        fout << "FAIL could not create the rasterizers" << endl;
+        failures++;
+    }
+
+    memset(&draw, 0, sizeof(draw));
+    draw.program = RASTER_PROGRAM_TEXTURE;
+
+    for (pass = 0; result && (pass < 2); pass++)
+    {
+        SoftwareRasterizerClass& rasterizer = rasterizers[pass];
+        target = rasterizer.GetBackBuffer();
+        fout << workerCounts[pass] << (workerCounts[pass] == 1 ? " worker" : " workers") << endl;
+
+        // The clear reaches every pixel, padding included, and resets depth to the far plane
+        rasterizer.Clear(0.25f, 0.5f, 0.75f, 1.0f);
+        color = PackTestColor(0.25f, 0.5f, 0.75f, 1.0f);
+        passed = true;
+        for (i = 0; i < target->pitch * target->height; i++)
+            passed = passed && (target->color[i] == color) && (target->depth[i] == 1.0f);
+        Check(fout, "clear fills colour and depth", passed, failures);
+
+        // Rectangles with edges between pixel centres cover exactly the centres inside them, later ones on top
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 0.0f);
+        rasterizer.ResetStats();
+        for (i = 0; i < width * height; i++)
+            expected[i] = 0;
+
+        seed = 2;
+        covered = 0;
+        draw.depthEnabled = false;
+        draw.blendEnabled = false;
+        for (i = 0; i < rectangleCount; i++)
+        {
+            left = (float)((int)(NextTestRandom(seed) % (width + 40)) - 20) + 0.25f;
+            top = (float)((int)(NextTestRandom(seed) % (height + 40)) - 20) + 0.75f;
+            right = left + (float)(NextTestRandom(seed) % 160) + 0.5f;
+            bottom = top + (float)(NextTestRandom(seed) % 120) + 0.5f;
+
+            AddTestQuad(vertices, indices, 0, left, top, right, bottom, 0.5f, 0.5f, width, height);
+            draw.texture = textures[i % paletteCount];
+            if (!DrawTest(rasterizer, draw, vertices, 4, indices, 6))
+                result = false;
+
+            color = textures[i % paletteCount]->color[0];
+
+            x0 = (int)ceilf(left - 0.5f);
+            x1 = (int)floorf(right - 0.5f);
+            y0 = (int)ceilf(top - 0.5f);
+            y1 = (int)floorf(bottom - 0.5f);
+            if (x0 < 0) x0 = 0;
+            if (y0 < 0) y0 = 0;
+            if (x1 > width - 1) x1 = width - 1;
+            if (y1 > height - 1) y1 = height - 1;
+
+            for (y = y0; y <= y1; y++)
+            {
+                for (x = x0; x <= x1; x++)
+                    expected[y * width + x] = color;
+            }
+
+            if ((x1 >= x0) && (y1 >= y0))
+                covered += (unsigned long long)(x1 - x0 + 1) * (y1 - y0 + 1);
+        }
+        rasterizer.Flush();
+
+        mismatches = 0;
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+            {
+                if (target->color[y * target->pitch + x] != expected[y * width + x])
+                    mismatches++;
+            }
+        }
+        fout << "  " << mismatches << " pixels differ" << endl;
+        Check(fout, "rectangles across tiles match painting them in order", result && (mismatches == 0), failures);
+
+        stats = rasterizer.GetStats();
+        Check(fout, "every covered pixel is counted once", stats.pixelsShaded == covered, failures);
+
+        // A fan around an inside point of an uneven convex outline has shared edges at
+        // every angle, blending shows a pixel drawn twice
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 0.0f);
+        draw.blendEnabled = true;
+        draw.texture = textures[paletteCount];
+        for (i = 0; i < fanCount; i++)
+        {
+            angle = -2.0f * MATH_PI * ((float)i + 0.3f * (float)(i % 2)) / (float)fanCount;
+            vertices[i + 1].x = 0.1f + 0.85f * cosf(angle) * (float)height / (float)width;
+            vertices[i + 1].y = -0.05f + 0.85f * sinf(angle);
+            vertices[i + 1].z = 0.5f;
+            vertices[i + 1].u = 0.0f;
+            vertices[i + 1].v = 0.0f;
+
+            indices[i * 3] = 0;
+            indices[i * 3 + 1] = i + 1;
+            indices[i * 3 + 2] = (i + 1) % fanCount + 1;
+        }
+        vertices[0].x = 0.13f;
+        vertices[0].y = -0.02f;
+        vertices[0].z = 0.5f;
+        vertices[0].u = 0.0f;
+        vertices[0].v = 0.0f;
+
+        result = DrawTest(rasterizer, draw, vertices, fanCount + 1, indices, fanCount * 3);
+        rasterizer.Flush();
+
+        once = target->color[(height / 2) * target->pitch + width / 2];
+        doubled = 0;
+        count = 0;
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+            {
+                color = target->color[y * target->pitch + x];
+                if (color == once)
+                    count++;
+                else if (color != 0)
+                    doubled++;
+            }
+        }
+        Check(fout, "fan pixels are blended once", result && (once == half) && (doubled == 0), failures);
+
+        // The same outline as a fan from its first corner has to cover the same pixels, so there are no gaps either
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 0.0f);
+        rasterizer.ResetStats();
+        for (i = 0; i < fanCount - 2; i++)
+        {
+            indices[i * 3] = 1;
+            indices[i * 3 + 1] = i + 2;
+            indices[i * 3 + 2] = i + 3;
+        }
+
+        result = DrawTest(rasterizer, draw, vertices, fanCount + 1, indices, (fanCount - 2) * 3);
+        rasterizer.Flush();
+
+        stats = rasterizer.GetStats();
+        Check(fout, "fans from two points cover the same pixels", result && (stats.pixelsShaded == (unsigned long long)count), failures);
+
+        // Squares whose shared sides and diagonals run through pixel centres, across tile edges.
+        // The top left rule gives each centre on a shared edge to exactly one of them. The
+        // target is a power of two wide and high so the centres survive clip space exactly.
+        rasterizer.SetTargets(grid, grid);
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 0.0f);
+        for (i = 0; i < gridColumns * gridRows; i++)
+        {
+            left = 20.5f + (float)((i % gridColumns) * gridSize);
+            top = 15.5f + (float)((i / gridColumns) * gridSize);
+            AddTestQuad(vertices, indices, i, left, top, left + (float)gridSize, top + (float)gridSize, 0.5f, 0.5f, grid->width, grid->height);
+        }
+
+        result = DrawTest(rasterizer, draw, vertices, gridColumns * gridRows * 4, indices, gridColumns * gridRows * 6);
+        rasterizer.Flush();
+
+        passed = result;
+        for (y = 0; y < grid->height; y++)
+        {
+            for (x = 0; x < grid->width; x++)
+            {
+                inGrid = (x >= 20) && (x < 20 + gridColumns * gridSize) && (y >= 15) && (y < 15 + gridRows * gridSize);
+                passed = passed && (grid->color[y * grid->pitch + x] == (inGrid ? half : 0));
+            }
+        }
+        Check(fout, "edges through pixel centres are drawn once", passed, failures);
+        rasterizer.SetTargets(target, target);
+
+        // Depth rising left to right against a flat quad in the middle of the range, drawn after it
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 0.0f);
+        draw.depthEnabled = true;
+        draw.blendEnabled = false;
+        AddTestQuad(vertices, indices, 0, 0.0f, 0.0f, (float)width, (float)height, 0.2f, 0.8f, width, height);
+        draw.texture = textures[paletteCount + 1];
+        result = DrawTest(rasterizer, draw, vertices, 4, indices, 6);
+        rasterizer.Flush();
+
+        passed = result;
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+            {
+                z = 0.2f + 0.6f * ((float)x + 0.5f) / (float)width;
+                passed = passed && (fabsf(target->depth[y * target->pitch + x] - z) < 0.00001f);
+            }
+        }
+        Check(fout, "depth is interpolated across the quad", passed, failures);
+
+        AddTestQuad(vertices, indices, 0, 0.0f, 0.0f, (float)width, (float)height, 0.5f, 0.5f, width, height);
+        draw.texture = textures[paletteCount + 2];
+        result = DrawTest(rasterizer, draw, vertices, 4, indices, 6);
+
+        // Behind everything, then past the far plane and behind the near one, none of which may show
+        AddTestQuad(vertices, indices, 0, 0.0f, 0.0f, (float)width, (float)height, 0.95f, 0.95f, width, height);
+        AddTestQuad(vertices, indices, 1, 0.0f, 0.0f, (float)width, (float)height, 1.5f, 1.5f, width, height);
+        AddTestQuad(vertices, indices, 2, 0.0f, 0.0f, (float)width, (float)height, -0.5f, -0.5f, width, height);
+        draw.texture = textures[paletteCount + 3];
+        result = result && DrawTest(rasterizer, draw, vertices, 12, indices, 18);
+        rasterizer.Flush();
+
+        // The middle column is a tie, less than keeps either colour there
+        passed = result;
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+            {
+                if (x == width / 2)
+                    continue;
+
+                color = target->color[y * target->pitch + x];
+                passed = passed && (color == ((x < width / 2) ? red : green));
+            }
+        }
+        Check(fout, "nearer pixels win the depth test", passed, failures);
+
+        // ONE, INV_SRC_ALPHA on colour and the source alpha kept
+        background = PackTestColor(200.0f / 255.0f, 100.0f / 255.0f, 0.0f, 1.0f);
+        rasterizer.Clear(200.0f / 255.0f, 100.0f / 255.0f, 0.0f, 1.0f);
+        draw.depthEnabled = false;
+        draw.blendEnabled = true;
+        AddTestQuad(vertices, indices, 0, 0.0f, 0.0f, (float)width, (float)height, 0.5f, 0.5f, width, height);
+        draw.texture = textures[paletteCount];
+        result = DrawTest(rasterizer, draw, vertices, 4, indices, 6);
+        rasterizer.Flush();
+
+        alpha = 128.0f / 255.0f;
+        passed = result;
+        for (i = 0; i < 3; i++)
+        {
+            channel = 64.0f / 255.0f + (float)((background >> (i * 8)) & 0xff) / 255.0f * (1.0f - alpha);
+            difference = (int)((target->color[0] >> (i * 8)) & 0xff) - (int)(channel * 255.0f + 0.5f);
+            passed = passed && (difference >= -1) && (difference <= 1);
+        }
+        passed = passed && ((target->color[0] >> 24) == 128);
+        for (i = 0; i < width * height; i++)
+            passed = passed && (target->color[(i / width) * target->pitch + i % width] == target->color[0]);
+        Check(fout, "blending adds the source to the scaled destination", passed, failures);
+
+        // Kept for comparing the worker counts
+        result = DrawTestScene(rasterizer, draw, textures, paletteCount + 4);
+        for (y = 0; y < height; y++)
+            memcpy(&images[pass][y * width], &target->color[y * target->pitch], width * sizeof(unsigned int));
+        Check(fout, "random scene draws", result, failures);
+
+        fout << endl;
+    }
+
+    if (result)
+        Check(fout, "one and four workers give the same image", memcmp(images[0], images[1], width * height * sizeof(unsigned int)) == 0, failures);
+
+    for (i = 0; i < 2; i++)
+    {
+        rasterizers[i].Shutdown();
+        pools[i].Shutdown();
+    }
+
+    for (i = 0; i < paletteCount + 4; i++)
+        ReleaseSurface(textures[i]);
+    ReleaseSurface(grid);
+    delete[] images[1];
+    delete[] images[0];
+    delete[] expected;
+    delete[] indices;
+    delete[] vertices;
+
+    fout << failures << " failures" << endl;
+    fout.close();
+
+    printf("%d rasterizer test failures, results in %s\n", failures, filename);
+
+    return (failures == 0);
+}
\ No newline at end of file
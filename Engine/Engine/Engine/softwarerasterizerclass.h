@@ -0,0 +1,139 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "mathclass.h"
+#include "workstealingpoolclass.h"
+
+const int RASTER_TILE_SIZE = 64;
+const int RASTER_MAX_ATTRIBUTES = 6;
+const int RASTER_MAX_PLANES = RASTER_MAX_ATTRIBUTES + 2;
+
+// The pixel programs the engine's shaders compile to
+enum RasterProgramType
+{
+    RASTER_PROGRAM_LIGHT,
+    RASTER_PROGRAM_FONT,
+    RASTER_PROGRAM_FONT_DISTANCE,
+    RASTER_PROGRAM_TEXTURE
+};
+
+// RGBA8 colour with red in the low byte, the same memory layout as
+// DXGI_FORMAT_R8G8B8A8_UNORM. Rows are padded to a multiple of four pixels so
+// the rasterizer can always work on four pixels at a time.
+struct RasterSurfaceType
+{
+    int width, height, pitch;
+    unsigned int* color;
+    float* depth;
+};
+
+// Everything the pixel stage of one draw needs, copied when the draw is made
+// so the caller can overwrite its constant buffers straight away
+struct RasterDrawType
+{
+    RasterProgramType program;
+    const RasterSurfaceType* texture;
+    bool depthEnabled, blendEnabled;
+    float lightDirection[4];
+    float diffuseColor[4];
+};
+
+struct RasterStatsType
+{
+    unsigned int drawCalls;
+    unsigned int trianglesSubmitted;
+    unsigned int trianglesRasterized;
+    unsigned int tileBins;
+    unsigned long long pixelsShaded;
+    double vertexSeconds;
+    double rasterSeconds;
+};
+
+// Tile based rasterizer on the CPU. Draws run their vertex stage straight away
+// and bin the surviving triangles into screen tiles, Flush then shades every
+// tile on the pool with Float4Type kernels that cover four pixels per step.
+// Tiles keep their triangles in submission order so blending matches the GPU.
+class SoftwareRasterizerClass
+{
+private:
+    struct ClipVertexType
+    {
+        float position[4];
+        float attributes[RASTER_MAX_ATTRIBUTES];
+    };
+
+    struct TriangleType
+    {
+        float edges[3][3];
+        int topLeft[3];
+        float planes[RASTER_MAX_PLANES][3];
+        int minX, minY, maxX, maxY;
+        int draw;
+    };
+
+    struct BinType
+    {
+        int* triangles;
+        int count, capacity;
+    };
+
+public:
+    SoftwareRasterizerClass();
+    SoftwareRasterizerClass(const SoftwareRasterizerClass&);
+    ~SoftwareRasterizerClass();
+
+    bool Initialize(int, int, WorkStealingPoolClass*);
+    void Shutdown();
+
+    static RasterSurfaceType* CreateSurface(int, int, bool, bool);
+    static void ReleaseSurface(RasterSurfaceType*);
+
+    RasterSurfaceType* GetBackBuffer();
+    void SetTargets(RasterSurfaceType*, RasterSurfaceType*);
+    void Clear(float, float, float, float);
+
+    bool Draw(const RasterDrawType&, const float*, const float*, const unsigned char*, unsigned int, unsigned int, const unsigned int*, unsigned int, int);
+    void Flush();
+
+    bool SavePPM(char*);
+
+    RasterStatsType GetStats();
+    void ResetStats();
+
+    static bool RunTests(char*);
+
+private:
+    int GetAttributeCount(RasterProgramType);
+    bool TransformVertices(const RasterDrawType&, const float*, const float*, const unsigned char*, unsigned int, unsigned int, unsigned int);
+    bool AddTriangle(const ClipVertexType&, const ClipVertexType&, const ClipVertexType&, int);
+    bool SetupTriangle(const ClipVertexType&, const ClipVertexType&, const ClipVertexType&, int);
+    bool ResizeBins(int);
+
+    static void ShadeTileTask(int, int, void*);
+    void ShadeTile(int, int);
+    static void ShadeQuad(const TriangleType&, const RasterDrawType&, Float4Type, Float4Type, Float4Type*);
+
+    static void Sample(const RasterSurfaceType*, Float4Type, Float4Type, Float4Type*);
+
+private:
+    WorkStealingPoolClass* m_pool;
+    RasterSurfaceType* m_backBuffer;
+    RasterSurfaceType* m_colorTarget;
+    RasterSurfaceType* m_depthTarget;
+    int m_targetWidth, m_targetHeight;
+    int m_tilesX, m_tilesY;
+
+    ClipVertexType* m_vertices;
+    int m_vertexCapacity;
+    TriangleType* m_triangles;
+    int m_triangleCount, m_triangleCapacity;
+    RasterDrawType* m_draws;
+    int m_drawCount, m_drawCapacity;
+    BinType* m_bins;
+    int m_binCount;
+
+    unsigned long long* m_workerPixels;
+    RasterStatsType m_stats;
+};
\ No newline at end of file
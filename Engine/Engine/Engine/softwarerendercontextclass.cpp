@@ -0,0 +1,621 @@
+#include "softwarerendercontextclass.h"
+
+// Initial log sizes, grown by doubling when a command list records more
+const int SOFTWARE_COMMAND_CAPACITY = 256;
+const unsigned int SOFTWARE_DATA_CAPACITY = 4096;
+
+// Shader constant layouts, in bytes, as declared in light.vs/light.ps and font.vs/font.ps
+const unsigned int LIGHT_OBJECT_CONSTANT_BYTES = 144;
+const unsigned int LIGHT_DIFFUSE_OFFSET = 128;
+const unsigned int MATRIX_CONSTANT_BYTES = 192;
+const unsigned int VECTOR_CONSTANT_BYTES = 16;
+
+// The shader classes upload transposed matrices, turn them back into row vector form
+static void TransposeMatrix(const float* input, float* output)
+{
+    int row, column;
+
+    for (row = 0; row < 4; row++)
+    {
+        for (column = 0; column < 4; column++)
+            output[row * 4 + column] = input[column * 4 + row];
+    }
+
+    return;
+}
+
+static void MultiplyMatrix(const float* a, const float* b, float* output)
+{
+    int row, column;
+
+    for (row = 0; row < 4; row++)
+    {
+        for (column = 0; column < 4; column++)
+        {
+            output[row * 4 + column] = a[row * 4 + 0] * b[0 * 4 + column] + a[row * 4 + 1] * b[1 * 4 + column] +
+                a[row * 4 + 2] * b[2 * 4 + column] + a[row * 4 + 3] * b[3 * 4 + column];
+        }
+    }
+
+    return;
+}
+
+SoftwareRenderBuffer::SoftwareRenderBuffer(unsigned int size)
+{
+    m_size = size;
+    m_data = new unsigned char[size];
+}
+
+void SoftwareRenderBuffer::Release()
+{
+    if (m_data)
+        delete[] m_data;
+
+    delete this;
+}
+
+SoftwareRenderContextClass::SoftwareRenderContextClass(SoftwareRasterizerClass* rasterizer, bool deferred)
+{
+    m_rasterizer = rasterizer;
+    m_deferred = deferred;
+
+    m_commands = 0;
+    m_commandCount = 0;
+    m_commandCapacity = 0;
+    m_data = 0;
+    m_dataSize = 0;
+    m_dataCapacity = 0;
+    m_mappedOffset = 0;
+
+    ResetState();
+
+    // The immediate context starts out on the back buffer like the D3D one
+    if (!m_deferred)
+    {
+        m_state.colorTarget = m_rasterizer->GetBackBuffer();
+        m_state.depthTarget = m_rasterizer->GetBackBuffer();
+    }
+}
+
+void SoftwareRenderContextClass::Release()
+{
+    if (m_data)
+    {
+        delete[] m_data;
+        m_data = 0;
+    }
+
+    if (m_commands)
+    {
+        delete[] m_commands;
+        m_commands = 0;
+    }
+
+    delete this;
+}
+
+bool SoftwareRenderContextClass::Map(RenderBuffer* buffer, RenderMapType mapType, void** data)
+{
+    SoftwareRenderBuffer* softwareBuffer;
+    bool result;
+
+    softwareBuffer = (SoftwareRenderBuffer*)buffer;
+
+    // Draws read their data when they are made, so the immediate context writes in place
+    if (!m_deferred)
+    {
+        *data = softwareBuffer->m_data;
+        return true;
+    }
+
+    // Recorded writes go to a copy that is uploaded when the list is replayed
+    result = ReserveData(m_dataSize + softwareBuffer->m_size);
+    if (!result)
+        return false;
+
+    memcpy(&m_data[m_dataSize], softwareBuffer->m_data, softwareBuffer->m_size);
+
+    m_mappedOffset = m_dataSize;
+    m_dataSize += softwareBuffer->m_size;
+
+    *data = &m_data[m_mappedOffset];
+
+    return true;
+}
+
+void SoftwareRenderContextClass::Unmap(RenderBuffer* buffer, unsigned int bytesWritten)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_UPLOAD, buffer, 0))
+        {
+            m_commands[m_commandCount - 1].args[0] = m_mappedOffset;
+            m_commands[m_commandCount - 1].args[1] = ((SoftwareRenderBuffer*)buffer)->m_size;
+        }
+    }
+
+    m_stats.bufferUploads++;
+    m_stats.bytesUploaded += bytesWritten;
+
+    return;
+}
+
+void SoftwareRenderContextClass::SetVertexBuffer(RenderBuffer* buffer, unsigned int stride)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_SET_VERTEX_BUFFER, buffer, 0))
+            m_commands[m_commandCount - 1].args[0] = stride;
+    }
+    else
+    {
+        m_state.vertexBuffer = (SoftwareRenderBuffer*)buffer;
+        m_state.stride = stride;
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetIndexBuffer(RenderBuffer* buffer)
+{
+    if (m_deferred)
+        AddCommand(COMMAND_SET_INDEX_BUFFER, buffer, 0);
+    else
+        m_state.indexBuffer = (SoftwareRenderBuffer*)buffer;
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetConstantBuffer(unsigned int stages, unsigned int slot, RenderBuffer* buffer, unsigned int firstConstant, unsigned int numConstants)
+{
+    if (slot >= SOFTWARE_CONSTANT_SLOTS)
+        return;
+
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_SET_CONSTANT_BUFFER, buffer, 0))
+        {
+            m_commands[m_commandCount - 1].args[0] = stages;
+            m_commands[m_commandCount - 1].args[1] = slot;
+            m_commands[m_commandCount - 1].args[2] = firstConstant;
+            m_commands[m_commandCount - 1].args[3] = numConstants;
+        }
+    }
+    else
+    {
+        // Constants are 16 bytes each
+        if (stages & RENDER_STAGE_VERTEX)
+        {
+            m_state.vertexConstants[slot].buffer = (SoftwareRenderBuffer*)buffer;
+            m_state.vertexConstants[slot].offset = firstConstant * 16;
+        }
+
+        if (stages & RENDER_STAGE_PIXEL)
+        {
+            m_state.pixelConstants[slot].buffer = (SoftwareRenderBuffer*)buffer;
+            m_state.pixelConstants[slot].offset = firstConstant * 16;
+        }
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+// The kernels sample a single texture
+void SoftwareRenderContextClass::SetTexture(unsigned int slot, RenderTexture* texture)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_SET_TEXTURE, texture, 0))
+            m_commands[m_commandCount - 1].args[0] = slot;
+    }
+    else if (slot == 0)
+    {
+        m_state.texture = (SoftwareRenderTexture*)texture;
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::UnbindTextures()
+{
+    if (m_deferred)
+        AddCommand(COMMAND_UNBIND_TEXTURES, 0, 0);
+    else
+        m_state.texture = 0;
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetProgram(RenderProgram* program)
+{
+    if (m_deferred)
+        AddCommand(COMMAND_SET_PROGRAM, program, 0);
+    else
+        m_state.program = (SoftwareRenderProgram*)program;
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetBackBuffer()
+{
+    if (m_deferred)
+    {
+        AddCommand(COMMAND_SET_BACK_BUFFER, 0, 0);
+    }
+    else
+    {
+        m_state.colorTarget = m_rasterizer->GetBackBuffer();
+        m_state.depthTarget = m_rasterizer->GetBackBuffer();
+        m_rasterizer->SetTargets(m_state.colorTarget, m_state.depthTarget);
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetRenderTargets(RenderTexture* colorTarget, RenderTexture* depthTarget)
+{
+    if (m_deferred)
+    {
+        AddCommand(COMMAND_SET_RENDER_TARGETS, colorTarget, depthTarget);
+    }
+    else
+    {
+        m_state.colorTarget = 0;
+        if (colorTarget)
+            m_state.colorTarget = ((SoftwareRenderTexture*)colorTarget)->m_surface;
+
+        m_state.depthTarget = 0;
+        if (depthTarget)
+            m_state.depthTarget = ((SoftwareRenderTexture*)depthTarget)->m_surface;
+
+        m_rasterizer->SetTargets(m_state.colorTarget, m_state.depthTarget);
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetDepthEnabled(bool enabled)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_SET_DEPTH, 0, 0))
+            m_commands[m_commandCount - 1].args[0] = enabled ? 1 : 0;
+    }
+    else
+    {
+        m_state.depthEnabled = enabled;
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::SetAlphaBlending(bool enabled)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_SET_BLEND, 0, 0))
+            m_commands[m_commandCount - 1].args[0] = enabled ? 1 : 0;
+    }
+    else
+    {
+        m_state.blendEnabled = enabled;
+    }
+
+    m_stats.stateChanges++;
+    return;
+}
+
+void SoftwareRenderContextClass::Clear(float red, float green, float blue, float alpha)
+{
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_CLEAR, 0, 0))
+        {
+            m_commands[m_commandCount - 1].values[0] = red;
+            m_commands[m_commandCount - 1].values[1] = green;
+            m_commands[m_commandCount - 1].values[2] = blue;
+            m_commands[m_commandCount - 1].values[3] = alpha;
+        }
+    }
+    else
+    {
+        m_rasterizer->Clear(red, green, blue, alpha);
+    }
+
+    return;
+}
+
+void SoftwareRenderContextClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+    RasterDrawType draw;
+    float positionMatrix[16], normalMatrix[16], world[16], view[16], projection[16], worldView[16];
+    const float* constants;
+    const unsigned int* indices;
+    unsigned int vertexCount;
+
+    m_stats.drawCalls++;
+    m_stats.indexCount += indexCount;
+
+    if (m_deferred)
+    {
+        if (AddCommand(COMMAND_DRAW_INDEXED, 0, 0))
+        {
+            m_commands[m_commandCount - 1].args[0] = indexCount;
+            m_commands[m_commandCount - 1].args[1] = startIndex;
+            m_commands[m_commandCount - 1].args[2] = (unsigned int)baseVertex;
+        }
+        return;
+    }
+
+    // Draws with missing state are dropped, like the debug layer would complain about
+    if (!m_state.program || !m_state.vertexBuffer || !m_state.indexBuffer || (m_state.stride == 0))
+        return;
+
+    if ((startIndex + indexCount) * sizeof(unsigned int) > m_state.indexBuffer->m_size)
+        return;
+
+    indices = (const unsigned int*)m_state.indexBuffer->m_data + startIndex;
+    vertexCount = m_state.vertexBuffer->m_size / m_state.stride;
+
+    memset(&draw, 0, sizeof(draw));
+    draw.program = m_state.program->m_program;
+    draw.texture = m_state.texture ? m_state.texture->m_surface : 0;
+    draw.depthEnabled = m_state.depthEnabled;
+    draw.blendEnabled = m_state.blendEnabled;
+
+    if (draw.program == RASTER_PROGRAM_LIGHT)
+    {
+        // ObjectBuffer in slot 1 of both stages, LightBuffer in slot 0 of the pixel stage
+        constants = GetConstants(m_state.vertexConstants[1], LIGHT_OBJECT_CONSTANT_BYTES);
+        if (!constants)
+            return;
+
+        TransposeMatrix(&constants[0], normalMatrix);
+        TransposeMatrix(&constants[16], positionMatrix);
+
+        constants = GetConstants(m_state.pixelConstants[1], LIGHT_OBJECT_CONSTANT_BYTES);
+        if (!constants)
+            return;
+
+        memcpy(draw.diffuseColor, &constants[LIGHT_DIFFUSE_OFFSET / sizeof(float)], sizeof(draw.diffuseColor));
+
+        constants = GetConstants(m_state.pixelConstants[0], VECTOR_CONSTANT_BYTES);
+        if (!constants)
+            return;
+
+        memcpy(draw.lightDirection, constants, sizeof(draw.lightDirection));
+
+        m_rasterizer->Draw(draw, positionMatrix, normalMatrix, m_state.vertexBuffer->m_data, m_state.stride, vertexCount, indices, indexCount, baseVertex);
+    }
+    else
+    {
+        // World, view and projection in slot 0 of the vertex stage
+        constants = GetConstants(m_state.vertexConstants[0], MATRIX_CONSTANT_BYTES);
+        if (!constants)
+            return;
+
+        TransposeMatrix(&constants[0], world);
+        TransposeMatrix(&constants[16], view);
+        TransposeMatrix(&constants[32], projection);
+        MultiplyMatrix(world, view, worldView);
+        MultiplyMatrix(worldView, projection, positionMatrix);
+
+        m_rasterizer->Draw(draw, positionMatrix, 0, m_state.vertexBuffer->m_data, m_state.stride, vertexCount, indices, indexCount, baseVertex);
+    }
+
+    return;
+}
+
+bool SoftwareRenderContextClass::FinishCommandList(RenderCommandList** commandList)
+{
+    SoftwareRenderCommandList* list;
+
+    *commandList = 0;
+
+    list = new SoftwareRenderCommandList;
+    if (!list)
+        return false;
+
+    // Hand the log and its upload data over and start empty, the way a deferred context resets
+    list->m_commands = m_commands;
+    list->m_commandCount = m_commandCount;
+    list->m_data = m_data;
+    list->stats = m_stats;
+
+    m_commands = 0;
+    m_commandCount = 0;
+    m_commandCapacity = 0;
+    m_data = 0;
+    m_dataSize = 0;
+    m_dataCapacity = 0;
+    ResetState();
+    ResetStats();
+
+    *commandList = list;
+
+    return true;
+}
+
+void SoftwareRenderContextClass::ExecuteCommandList(RenderCommandList* commandList)
+{
+    SoftwareRenderCommandList* list;
+    StateType savedState;
+    RenderStatsType savedStats;
+    int i;
+
+    list = (SoftwareRenderCommandList*)commandList;
+
+    // The list brings its own stats, don't count the replayed calls twice
+    savedState = m_state;
+    savedStats = m_stats;
+
+    // Replayed lists start from default state
+    ResetState();
+
+    for (i = 0; i < list->m_commandCount; i++)
+    {
+        CommandType& command = list->m_commands[i];
+
+        switch (command.kind)
+        {
+            case COMMAND_UPLOAD:
+                memcpy(((SoftwareRenderBuffer*)command.object0)->m_data, &list->m_data[command.args[0]], command.args[1]);
+                break;
+            case COMMAND_SET_VERTEX_BUFFER:
+                SetVertexBuffer((RenderBuffer*)command.object0, command.args[0]);
+                break;
+            case COMMAND_SET_INDEX_BUFFER:
+                SetIndexBuffer((RenderBuffer*)command.object0);
+                break;
+            case COMMAND_SET_CONSTANT_BUFFER:
+                SetConstantBuffer(command.args[0], command.args[1], (RenderBuffer*)command.object0, command.args[2], command.args[3]);
+                break;
+            case COMMAND_SET_TEXTURE:
+                SetTexture(command.args[0], (RenderTexture*)command.object0);
+                break;
+            case COMMAND_UNBIND_TEXTURES:
+                UnbindTextures();
+                break;
+            case COMMAND_SET_PROGRAM:
+                SetProgram((RenderProgram*)command.object0);
+                break;
+            case COMMAND_SET_BACK_BUFFER:
+                SetBackBuffer();
+                break;
+            case COMMAND_SET_RENDER_TARGETS:
+                SetRenderTargets((RenderTexture*)command.object0, (RenderTexture*)command.object1);
+                break;
+            case COMMAND_SET_DEPTH:
+                SetDepthEnabled(command.args[0] != 0);
+                break;
+            case COMMAND_SET_BLEND:
+                SetAlphaBlending(command.args[0] != 0);
+                break;
+            case COMMAND_CLEAR:
+                Clear(command.values[0], command.values[1], command.values[2], command.values[3]);
+                break;
+            case COMMAND_DRAW_INDEXED:
+                DrawIndexed(command.args[0], command.args[1], (int)command.args[2]);
+                break;
+        }
+    }
+
+    // Put the immediate context back the way it was
+    m_state = savedState;
+    m_rasterizer->SetTargets(m_state.colorTarget, m_state.depthTarget);
+
+    m_stats = savedStats;
+    AddStats(commandList->stats);
+
+    return;
+}
+
+void SoftwareRenderContextClass::ResetState()
+{
+    memset(&m_state, 0, sizeof(m_state));
+
+    // D3D11 defaults, depth testing on and blending off
+    m_state.depthEnabled = true;
+    m_state.blendEnabled = false;
+
+    return;
+}
+
+bool SoftwareRenderContextClass::AddCommand(CommandKind kind, void* object0, void* object1)
+{
+    bool result;
+
+    result = Reserve(m_commandCount + 1);
+    if (!result)
+        return false;
+
+    memset(&m_commands[m_commandCount], 0, sizeof(CommandType));
+    m_commands[m_commandCount].kind = kind;
+    m_commands[m_commandCount].object0 = object0;
+    m_commands[m_commandCount].object1 = object1;
+    m_commandCount++;
+
+    return true;
+}
+
+bool SoftwareRenderContextClass::Reserve(int count)
+{
+    CommandType* commands;
+    int capacity;
+
+    if (count <= m_commandCapacity)
+        return true;
+
+    capacity = m_commandCapacity;
+    if (capacity == 0)
+        capacity = SOFTWARE_COMMAND_CAPACITY;
+
+    while (capacity < count)
+        capacity *= 2;
+
+    commands = new CommandType[capacity];
+    if (!commands)
+        return false;
+
+    if (m_commands)
+    {
+        memcpy(commands, m_commands, sizeof(CommandType) * m_commandCount);
+        delete[] m_commands;
+    }
+
+    m_commands = commands;
+    m_commandCapacity = capacity;
+
+    return true;
+}
+
+bool SoftwareRenderContextClass::ReserveData(unsigned int size)
+{
+    unsigned char* data;
+    unsigned int capacity;
+
+    if (size <= m_dataCapacity)
+        return true;
+
+    capacity = m_dataCapacity;
+    if (capacity == 0)
+        capacity = SOFTWARE_DATA_CAPACITY;
+
+    while (capacity < size)
+        capacity *= 2;
+
+    data = new unsigned char[capacity];
+    if (!data)
+        return false;
+
+    if (m_data)
+    {
+        memcpy(data, m_data, m_dataSize);
+        delete[] m_data;
+    }
+
+    m_data = data;
+    m_dataCapacity = capacity;
+
+    return true;
+}
+
+const float* SoftwareRenderContextClass::GetConstants(const ConstantBindingType& binding, unsigned int size)
+{
+    if (!binding.buffer)
+        return 0;
+
+    if (binding.offset + size > binding.buffer->m_size)
+        return 0;
+
+    return (const float*)&binding.buffer->m_data[binding.offset];
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "rendercontextclass.h"
+#include "softwarerasterizerclass.h"
+
+const int SOFTWARE_CONSTANT_SLOTS = 4;
+
+class SoftwareRenderBuffer : public RenderBuffer
+{
+public:
+    SoftwareRenderBuffer(unsigned int);
+    void Release();
+
+    unsigned int m_size;
+    unsigned char* m_data;
+};
+
+class SoftwareRenderTexture : public RenderTexture
+{
+public:
+    SoftwareRenderTexture(RasterSurfaceType* surface) { m_surface = surface; }
+    void Release() { SoftwareRasterizerClass::ReleaseSurface(m_surface); delete this; }
+
+    RasterSurfaceType* m_surface;
+};
+
+// The shader pair is replaced by the matching built in kernel
+class SoftwareRenderProgram : public RenderProgram
+{
+public:
+    SoftwareRenderProgram(RasterProgramType program, unsigned int stride) { m_program = program; m_stride = stride; }
+    void Release() { delete this; }
+
+    RasterProgramType m_program;
+    unsigned int m_stride;
+};
+
+// The immediate context feeds the rasterizer directly. A deferred context keeps
+// the calls in a log, uploads included, and the immediate context replays the
+// log when the command list is executed.
+class SoftwareRenderContextClass : public RenderContextClass
+{
+public:
+    enum CommandKind
+    {
+        COMMAND_UPLOAD,
+        COMMAND_SET_VERTEX_BUFFER,
+        COMMAND_SET_INDEX_BUFFER,
+        COMMAND_SET_CONSTANT_BUFFER,
+        COMMAND_SET_TEXTURE,
+        COMMAND_UNBIND_TEXTURES,
+        COMMAND_SET_PROGRAM,
+        COMMAND_SET_BACK_BUFFER,
+        COMMAND_SET_RENDER_TARGETS,
+        COMMAND_SET_DEPTH,
+        COMMAND_SET_BLEND,
+        COMMAND_CLEAR,
+        COMMAND_DRAW_INDEXED
+    };
+
+    struct CommandType
+    {
+        CommandKind kind;
+        void* object0;
+        void* object1;
+        unsigned int args[4];
+        float values[4];
+    };
+
+private:
+    struct ConstantBindingType
+    {
+        SoftwareRenderBuffer* buffer;
+        unsigned int offset;
+    };
+
+    struct StateType
+    {
+        SoftwareRenderBuffer* vertexBuffer;
+        unsigned int stride;
+        SoftwareRenderBuffer* indexBuffer;
+        ConstantBindingType vertexConstants[SOFTWARE_CONSTANT_SLOTS];
+        ConstantBindingType pixelConstants[SOFTWARE_CONSTANT_SLOTS];
+        SoftwareRenderTexture* texture;
+        SoftwareRenderProgram* program;
+        RasterSurfaceType* colorTarget;
+        RasterSurfaceType* depthTarget;
+        bool depthEnabled, blendEnabled;
+    };
+
+public:
+    SoftwareRenderContextClass(SoftwareRasterizerClass*, bool);
+    void Release();
+
+    bool Map(RenderBuffer*, RenderMapType, void**);
+    void Unmap(RenderBuffer*, unsigned int);
+
+    void SetVertexBuffer(RenderBuffer*, unsigned int);
+    void SetIndexBuffer(RenderBuffer*);
+    void SetConstantBuffer(unsigned int, unsigned int, RenderBuffer*, unsigned int, unsigned int);
+    void SetTexture(unsigned int, RenderTexture*);
+    void UnbindTextures();
+    void SetProgram(RenderProgram*);
+
+    void SetBackBuffer();
+    void SetRenderTargets(RenderTexture*, RenderTexture*);
+    void SetDepthEnabled(bool);
+    void SetAlphaBlending(bool);
+
+    void Clear(float, float, float, float);
+    void DrawIndexed(unsigned int, unsigned int, int);
+
+    bool FinishCommandList(RenderCommandList**);
+    void ExecuteCommandList(RenderCommandList*);
+
+private:
+    void ResetState();
+    bool AddCommand(CommandKind, void*, void*);
+    bool Reserve(int);
+    bool ReserveData(unsigned int);
+    const float* GetConstants(const ConstantBindingType&, unsigned int);
+
+private:
+    SoftwareRasterizerClass* m_rasterizer;
+    bool m_deferred;
+    StateType m_state;
+
+    CommandType* m_commands;
+    int m_commandCount, m_commandCapacity;
+    unsigned char* m_data;
+    unsigned int m_dataSize, m_dataCapacity;
+    unsigned int m_mappedOffset;
+};
+
+class SoftwareRenderCommandList : public RenderCommandList
+{
+public:
+    SoftwareRenderCommandList() { m_commands = 0; m_commandCount = 0; m_data = 0; }
+    void Release() { if (m_commands) delete[] m_commands; if (m_data) delete[] m_data; delete this; }
+
+    SoftwareRenderContextClass::CommandType* m_commands;
+    int m_commandCount;
+    unsigned char* m_data;
+};
\ No newline at end of file
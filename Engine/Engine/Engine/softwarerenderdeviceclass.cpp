@@ -0,0 +1,343 @@
+#include "softwarerenderdeviceclass.h"
+
+SoftwareRenderDeviceClass::SoftwareRenderDeviceClass()
+{
+    m_pool = 0;
+    m_rasterizer = 0;
+    m_context = 0;
+    m_pipelineCache = 0;
+    m_frameCount = 0;
+}
+
+SoftwareRenderDeviceClass::SoftwareRenderDeviceClass(const SoftwareRenderDeviceClass& other)
+{
+
+}
+
+SoftwareRenderDeviceClass::~SoftwareRenderDeviceClass()
+{
+
+}
+
+bool SoftwareRenderDeviceClass::Initialize(int screenWidth, int screenHeight, float screenDepth, float screenNear, int threadCount)
+{
+    float fieldOfView, screenAspect;
+    bool result;
+
+    // Zero threads means one per hardware thread
+    if (threadCount <= 0)
+        threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    m_pool = new WorkStealingPoolClass;
+    if (!m_pool)
+        return false;
+
+    result = m_pool->Initialize(threadCount);
+    if (!result)
+        return false;
+
+    m_rasterizer = new SoftwareRasterizerClass;
+    if (!m_rasterizer)
+        return false;
+
+    result = m_rasterizer->Initialize(screenWidth, screenHeight, m_pool);
+    if (!result)
+        return false;
+
+    m_context = new SoftwareRenderContextClass(m_rasterizer, false);
+    if (!m_context)
+        return false;
+
+    m_pipelineCache = new PipelineStateCacheClass;
+    if (!m_pipelineCache)
+        return false;
+
+    if (!m_pipelineCache->Initialize(0, 0))
+        return false;
+
+    // Same matrices D3DClass builds so the render path sees identical transforms
+    fieldOfView = (float)MATH_PI / 4.0f;
+    screenAspect = (float)screenWidth / (float)screenHeight;
+    MatrixPerspectiveFovLH(&m_projectionMatrix, fieldOfView, screenAspect, screenNear, screenDepth);
+    MatrixIdentity(&m_worldMatrix);
+    MatrixOrthoLH(&m_orthoMatrix, (float)screenWidth, (float)screenHeight, screenNear, screenDepth);
+
+    return true;
+}
+
+void SoftwareRenderDeviceClass::Shutdown()
+{
+    if (m_pipelineCache)
+    {
+        m_pipelineCache->Shutdown();
+        delete m_pipelineCache;
+        m_pipelineCache = 0;
+    }
+
+    if (m_context)
+    {
+        m_context->Release();
+        m_context = 0;
+    }
+
+    if (m_rasterizer)
+    {
+        m_rasterizer->Shutdown();
+        delete m_rasterizer;
+        m_rasterizer = 0;
+    }
+
+    if (m_pool)
+    {
+        m_pool->Shutdown();
+        delete m_pool;
+        m_pool = 0;
+    }
+
+    return;
+}
+
+RenderContextClass* SoftwareRenderDeviceClass::GetContext()
+{
+    return m_context;
+}
+
+RenderContextClass* SoftwareRenderDeviceClass::CreateDeferredContext()
+{
+    return new SoftwareRenderContextClass(m_rasterizer, true);
+}
+
+// Constants are read straight out of system memory at any offset
+bool SoftwareRenderDeviceClass::SupportsConstantOffsets()
+{
+    return true;
+}
+
+RenderBuffer* SoftwareRenderDeviceClass::CreateBuffer(RenderBufferType type, unsigned int size, bool dynamic, const void* initialData)
+{
+    SoftwareRenderBuffer* buffer;
+
+    buffer = new SoftwareRenderBuffer(size);
+    if (!buffer)
+        return 0;
+
+    if (!buffer->m_data)
+    {
+        buffer->Release();
+        return 0;
+    }
+
+    if (initialData)
+        memcpy(buffer->m_data, initialData, size);
+    else
+        memset(buffer->m_data, 0, size);
+
+    return buffer;
+}
+
+// Converts the top level of the first slice of an uncompressed DDS file to RGBA8
+RenderTexture* SoftwareRenderDeviceClass::LoadTexture(wchar_t* filename)
+{
+    DdsFileClass file;
+    RasterSurfaceType* surface;
+    SoftwareRenderTexture* texture;
+    char path[260];
+
+    if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+        return 0;
+
+    if (!file.Initialize(path))
+    {
+        file.Shutdown();
+        return 0;
+    }
+
+    surface = SoftwareRasterizerClass::CreateSurface(file.GetWidth(), file.GetHeight(), true, false);
+    if (!surface)
+    {
+        file.Shutdown();
+        return 0;
+    }
+
+    texture = new SoftwareRenderTexture(surface);
+    if (!texture)
+    {
+        SoftwareRasterizerClass::ReleaseSurface(surface);
+        file.Shutdown();
+        return 0;
+    }
+
+    // Block compressed and float formats aren't handled here
+    if (!file.ReadPixels(0, surface->color, surface->pitch))
+    {
+        texture->Release();
+        file.Shutdown();
+        return 0;
+    }
+
+    file.Shutdown();
+
+    return texture;
+}
+
+// Only the top level of the first slice is kept, the rasterizer doesn't sample mips
+RenderTexture* SoftwareRenderDeviceClass::CreateTexture(const RenderTextureDescType& desc)
+{
+    RasterSurfaceType* surface;
+    SoftwareRenderTexture* texture;
+
+    surface = SoftwareRasterizerClass::CreateSurface(desc.width, desc.height, true, false);
+    if (!surface)
+        return 0;
+
+    texture = new SoftwareRenderTexture(surface);
+    if (!texture)
+    {
+        SoftwareRasterizerClass::ReleaseSurface(surface);
+        return 0;
+    }
+
+    if (!DdsFileClass::ConvertPixels(desc.format, desc.hasAlpha, desc.subresources[0].data, desc.subresources[0].rowPitch, desc.width, desc.height,
+        surface->color, surface->pitch))
+    {
+        texture->Release();
+        return 0;
+    }
+
+    return texture;
+}
+
+RenderTexture* SoftwareRenderDeviceClass::CreateRenderTexture(int width, int height, unsigned int format, bool depth)
+{
+    RasterSurfaceType* surface;
+    SoftwareRenderTexture* texture;
+
+    // Every colour format is stored as RGBA8
+    surface = SoftwareRasterizerClass::CreateSurface(width, height, !depth, depth);
+    if (!surface)
+        return 0;
+
+    texture = new SoftwareRenderTexture(surface);
+    if (!texture)
+    {
+        SoftwareRasterizerClass::ReleaseSurface(surface);
+        return 0;
+    }
+
+    return texture;
+}
+
+RenderProgram* SoftwareRenderDeviceClass::CreateProgram(const RenderProgramDescType& desc)
+{
+    RasterProgramType program;
+    unsigned int stride;
+    int i;
+
+    // Pick the kernel that does what the named shader does
+    if (strcmp(desc.vsEntry, "LightVertexShader") == 0)
+        program = RASTER_PROGRAM_LIGHT;
+    else if (strcmp(desc.vsEntry, "FontVertexShader") == 0)
+        program = (strcmp(desc.psEntry, "FontDistancePixelShader") == 0) ? RASTER_PROGRAM_FONT_DISTANCE : RASTER_PROGRAM_FONT;
+    else if (strcmp(desc.vsEntry, "TextureVertexShader") == 0)
+        program = RASTER_PROGRAM_TEXTURE;
+    else
+        return 0;
+
+    stride = 0;
+    for (i = 0; i < desc.elementCount; i++)
+        stride += desc.elements[i].floatCount * sizeof(float);
+
+    return new SoftwareRenderProgram(program, stride);
+}
+
+// Nothing to build beyond the description, which the context applies a part at a time
+RenderPipelineState* SoftwareRenderDeviceClass::GetPipelineState(const RenderPipelineDescType& desc)
+{
+    return m_pipelineCache->GetPipelineState(desc);
+}
+
+void SoftwareRenderDeviceClass::BeginScene(float red, float green, float blue, float alpha)
+{
+    m_context->SetBackBuffer();
+    m_context->Clear(red, green, blue, alpha);
+    return;
+}
+
+// Finishing the binned tiles is the software version of Present
+void SoftwareRenderDeviceClass::EndScene()
+{
+    m_rasterizer->Flush();
+    m_frameCount++;
+    return;
+}
+
+void SoftwareRenderDeviceClass::GetProjectionMatrix(MatrixType& projectionMatrix)
+{
+    projectionMatrix = m_projectionMatrix;
+    return;
+}
+
+void SoftwareRenderDeviceClass::GetWorldMatrix(MatrixType& worldMatrix)
+{
+    worldMatrix = m_worldMatrix;
+    return;
+}
+
+void SoftwareRenderDeviceClass::GetOrthoMatrix(MatrixType& orthoMatrix)
+{
+    orthoMatrix = m_orthoMatrix;
+    return;
+}
+
+bool SoftwareRenderDeviceClass::SaveFrame(char* filename)
+{
+    m_rasterizer->Flush();
+    return m_rasterizer->SavePPM(filename);
+}
+
+bool SoftwareRenderDeviceClass::WriteStats(char* filename)
+{
+    ofstream fout;
+    RasterStatsType stats;
+    double totalSeconds;
+
+    stats = m_rasterizer->GetStats();
+    totalSeconds = stats.vertexSeconds + stats.rasterSeconds;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout << "Frames: " << m_frameCount << endl;
+    fout << "Threads: " << m_pool->GetWorkerCount() << endl;
+    fout << "Draw calls: " << stats.drawCalls << endl;
+    fout << "Triangles submitted: " << stats.trianglesSubmitted << endl;
+    fout << "Triangles rasterized: " << stats.trianglesRasterized << endl;
+    fout << "Tile bins: " << stats.tileBins << endl;
+    fout << "Tile steals: " << m_pool->GetStealCount() << endl;
+    fout << "Pixels shaded: " << stats.pixelsShaded << endl;
+    fout << "Vertex and setup ms: " << stats.vertexSeconds * 1000.0 << endl;
+    fout << "Tile shading ms: " << stats.rasterSeconds * 1000.0 << endl;
+
+    if (totalSeconds > 0.0)
+        fout << "Triangles/s: " << (double)stats.trianglesSubmitted / totalSeconds << endl;
+
+    if (stats.rasterSeconds > 0.0)
+        fout << "Pixels/s: " << (double)stats.pixelsShaded / stats.rasterSeconds << endl;
+
+    fout.close();
+
+    return true;
+}
+
+RasterStatsType SoftwareRenderDeviceClass::GetRasterStats()
+{
+    return m_rasterizer->GetStats();
+}
+
+unsigned int SoftwareRenderDeviceClass::GetFrameCount()
+{
+    return m_frameCount;
+}
\ No newline at end of file
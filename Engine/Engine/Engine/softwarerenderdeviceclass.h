@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdlib.h>
+#include <fstream>
+#include "renderdeviceclass.h"
+#include "ddsfileclass.h"
+#include "pipelinestatecacheclass.h"
+#include "softwarerendercontextclass.h"
+#include "workstealingpoolclass.h"
+using namespace std;
+
+// Render device that draws on the CPU. The engine's shaders are swapped for the
+// rasterizer's built in kernels by entry point name, so the same render path
+// produces a real image without a GPU, and the rasterizer counts how fast it
+// got through the frame.
+class SoftwareRenderDeviceClass : public RenderDeviceClass
+{
+public:
+    SoftwareRenderDeviceClass();
+    SoftwareRenderDeviceClass(const SoftwareRenderDeviceClass&);
+    ~SoftwareRenderDeviceClass();
+
+    bool Initialize(int, int, float, float, int);
+    void Shutdown();
+
+    RenderContextClass* GetContext();
+    RenderContextClass* CreateDeferredContext();
+    bool SupportsConstantOffsets();
+
+    RenderBuffer* CreateBuffer(RenderBufferType, unsigned int, bool, const void*);
+    RenderTexture* LoadTexture(wchar_t*);
+    RenderTexture* CreateTexture(const RenderTextureDescType&);
+    RenderTexture* CreateRenderTexture(int, int, unsigned int, bool);
+    RenderProgram* CreateProgram(const RenderProgramDescType&);
+    RenderPipelineState* GetPipelineState(const RenderPipelineDescType&);
+
+    void BeginScene(float, float, float, float);
+    void EndScene();
+
+    void GetProjectionMatrix(MatrixType&);
+    void GetWorldMatrix(MatrixType&);
+    void GetOrthoMatrix(MatrixType&);
+
+    bool SaveFrame(char*);
+    bool WriteStats(char*);
+    RasterStatsType GetRasterStats();
+    unsigned int GetFrameCount();
+
+private:
+    WorkStealingPoolClass* m_pool;
+    SoftwareRasterizerClass* m_rasterizer;
+    SoftwareRenderContextClass* m_context;
+    PipelineStateCacheClass* m_pipelineCache;
+    unsigned int m_frameCount;
+
+    MatrixType m_projectionMatrix;
+    MatrixType m_worldMatrix;
+    MatrixType m_orthoMatrix;
+};
\ No newline at end of file
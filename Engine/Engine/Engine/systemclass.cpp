@@ -9,6 +9,9 @@ SystemClass::SystemClass()
 	m_Graphics = 0;
     m_Timer = 0;
     m_Position = 0;
+    m_FrameStats = 0;
+    m_Benchmark = 0;
+    m_hwnd = 0;
 }
 
 SystemClass::SystemClass(const SystemClass& other)
@@ -22,15 +25,21 @@ SystemClass::~SystemClass()
 	// to do object clean up. Instead has it in the Shutdown function
 }
 
-bool SystemClass::Initialize()
+// -record <file> saves the session's input, -replay <file> plays a saved one back
+bool SystemClass::Initialize(char* commandLine)
 {
 	// Basically initializes the window, input, and graphics objects
+	char recordFile[INPUT_MAX_PATH], replayFile[INPUT_MAX_PATH];
 	int screenWidth, screenHeight;
 	bool result;
 
 	screenWidth = 0;
 	screenHeight = 0;
 
+    // Start recording zones before anything else runs
+    if (PROFILER_ENABLED)
+        ProfilerClass::Initialize();
+
     // Init windows api
 	InitializeWindows(screenWidth, screenHeight);
 
@@ -39,22 +48,38 @@ bool SystemClass::Initialize()
 	if (!m_Input)
 		return false;
 
-    // Init input object
-	result = m_Input->Initialize(m_hinstance, m_hwnd, screenWidth, screenHeight);
+    recordFile[0] = 0;
+    replayFile[0] = 0;
+    BenchmarkClass::ReadArgument(commandLine, "-record", recordFile, INPUT_MAX_PATH);
+    BenchmarkClass::ReadArgument(commandLine, "-replay", replayFile, INPUT_MAX_PATH);
+
+    // Init input object, a replay brings the seed its scene was recorded with
+	result = m_Input->Initialize(m_hinstance, m_hwnd, screenWidth, screenHeight, recordFile, replayFile, (unsigned int)time(NULL));
     if (!result)
     {
         MessageBox(m_hwnd, L"Could not initialize the input object.", L"Error", MB_OK);
         return false;
     }
 
+    // Create frame statistics object
+    m_FrameStats = new FrameStatsClass;
+    if (!m_FrameStats)
+        return false;
+
+    result = m_FrameStats->Initialize();
+    if (!result)
+        return false;
+
     // Handles rendering all the graphics
 	m_Graphics = new GraphicsClass;
 	if (!m_Graphics)
 		return false;
-	result = m_Graphics->Initialize(screenWidth, screenHeight, m_hwnd);
+	result = m_Graphics->Initialize(screenWidth, screenHeight, m_hwnd, m_Input->GetSeed());
 	if (!result)
 		return false;
 
+    m_Graphics->SetFrameStats(m_FrameStats);
+
     // Create timer object
     m_Timer = new TimerClass;
     if (!m_Timer)
@@ -97,12 +122,41 @@ void SystemClass::Shutdown()
 		delete m_Graphics;
 		m_Graphics = 0;
 	}
+
+    if (m_Benchmark)
+    {
+        m_Benchmark->Shutdown();
+        delete m_Benchmark;
+        m_Benchmark = 0;
+    }
+
+    // Write out the frame pacing for the whole run
+    if (m_FrameStats)
+    {
+        m_FrameStats->WriteCSV("frame-times.csv", "frame-stats.csv");
+        m_FrameStats->WriteLatencyHistogram("input-latency.csv");
+        m_FrameStats->Shutdown();
+        delete m_FrameStats;
+        m_FrameStats = 0;
+    }
 	if (m_Input)
 	{
+		m_Input->Shutdown();
 		delete m_Input;
 		m_Input = 0;
 	}
-	ShutdownWindows();
+
+    // The worker threads are gone so every ring can be written and freed
+    if (PROFILER_ENABLED)
+    {
+        ProfilerClass::WriteTrace("trace.json");
+        ProfilerClass::Shutdown();
+    }
+
+    // Benchmarks on the null and software devices never open a window
+    if (m_hwnd)
+        ShutdownWindows();
+
 	return;
 }
 
@@ -134,7 +188,7 @@ void SystemClass::Run()
                 done = true;
             }
         }
-        if (m_Input->IsEscapePressed())
+        if (m_Input->IsEscapePressed() || m_Input->IsReplayFinished())
         {
             done = true;
         }
@@ -142,42 +196,120 @@ void SystemClass::Run()
 	return;
 }
 
+// Runs without input, only the D3D device needs a window to present to
+bool SystemClass::InitializeBenchmark(const BenchmarkSettingsType& settings)
+{
+    int screenWidth, screenHeight;
+    bool result;
+
+    if (PROFILER_ENABLED)
+        ProfilerClass::Initialize();
+
+    if (settings.deviceType == GRAPHICS_DEVICE_D3D)
+        InitializeWindows(screenWidth, screenHeight);
+
+    m_Benchmark = new BenchmarkClass;
+    if (!m_Benchmark)
+        return false;
+
+    result = m_Benchmark->Initialize(settings, m_hwnd);
+    if (!result)
+    {
+        if (m_hwnd)
+            MessageBox(m_hwnd, L"Could not initialize the benchmark.", L"Error", MB_OK);
+        return false;
+    }
+
+    return true;
+}
+
+bool SystemClass::RunBenchmark()
+{
+    MSG msg;
+    bool done, result;
+
+    ZeroMemory(&msg, sizeof(MSG));
+    done = false;
+    while (!done)
+    {
+        // Keep the window responsive, there is no input to read
+        if (m_hwnd && PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+            if (msg.message == WM_QUIT)
+                return false;
+        }
+
+        result = m_Benchmark->Frame(done);
+        if (!result)
+            return false;
+    }
+
+    return m_Benchmark->WriteResults();
+}
+
 bool SystemClass::Frame()
 {
 	// Where all he processing of the application is done
 	bool keyDown, result;
     float rotationY;
 
-    // Update system stats
-    m_Timer->Frame();
+    long long phaseStart;
+
+    PROFILE_ZONE("Frame");
 
     // Do input frame processing
-    result = m_Input->Frame();
+    phaseStart = FrameStatsClass::GetNanoseconds();
+    {
+        PROFILE_ZONE("Input");
+        result = m_Input->Frame(m_Timer->GetTime());
+    }
+    m_FrameStats->AddPhaseTime(FRAME_TIME_INPUT, FrameStatsClass::GetNanoseconds() - phaseStart);
     if (!result)
         return false;
 
-    // Set frame time
-    m_Position->SetFrameTime(m_Timer->GetTime());
+    phaseStart = FrameStatsClass::GetNanoseconds();
+
+    // Set frame time, which is how long the last frame took or the recorded one when replaying
+    m_Position->SetFrameTime(m_Input->GetFrameTime());
 
     // Check key pressed
+    // Each key carries the event that last changed it, so the present can time it
     keyDown = m_Input->IsLeftArrowPressed();
-    m_Position->TurnLeft(keyDown);
+    m_Position->TurnLeft(keyDown, m_Input->GetKeyTag(DIK_LEFT));
 
     keyDown = m_Input->IsRightArrowPressed();
-    m_Position->TurnRight(keyDown);
+    m_Position->TurnRight(keyDown, m_Input->GetKeyTag(DIK_RIGHT));
 
     // Get current view point rotation
     m_Position->GetRotation(rotationY);
 
     // Frame processing for graphics object
-    result = m_Graphics->Frame(rotationY);
+    {
+        PROFILE_ZONE("Update");
+        result = m_Graphics->Frame(rotationY);
+        m_Graphics->SetLatencyTag(m_Position->GetLatencyTag());
+    }
+    m_FrameStats->AddPhaseTime(FRAME_TIME_UPDATE, FrameStatsClass::GetNanoseconds() - phaseStart);
     if (!result)
         return false;
 
-    result = m_Graphics->Render();
+    // Culling, drawing and present are timed inside
+    {
+        PROFILE_ZONE("Render");
+        result = m_Graphics->Render();
+    }
     if (!result)
         return false;
 
+    // Update system stats, the timer measures from the end of one frame to the end of the next
+    {
+        PROFILE_ZONE("Timer");
+        m_Timer->Frame();
+    }
+    m_FrameStats->EndFrame(m_Timer->GetFrameNanoseconds());
+
 	return true;
 }
 
@@ -5,6 +5,9 @@
 #include "graphicsclass.h"
 #include "timerclass.h"
 #include "positionclass.h"
+#include "profilerclass.h"
+#include "framestatsclass.h"
+#include "benchmarkclass.h"
 
 class SystemClass
 {
@@ -13,10 +16,13 @@ public:
 	SystemClass(const SystemClass&);
 	~SystemClass();
 
-	bool Initialize();
+	bool Initialize(char*);
 	void Shutdown();
 	void Run();
 
+    bool InitializeBenchmark(const BenchmarkSettingsType&);
+    bool RunBenchmark();
+
 	// Handles windows system messages that will get sent to the
 	// application while it is running
 	LRESULT CALLBACK MessageHandler(HWND, UINT, WPARAM, LPARAM);
@@ -36,6 +42,8 @@ private:
 	GraphicsClass* m_Graphics;
     TimerClass* m_Timer;
     PositionClass* m_Position;
+    FrameStatsClass* m_FrameStats;
+    BenchmarkClass* m_Benchmark;
 };
 
 // To re-direct the windows system messaging into MessageHandler
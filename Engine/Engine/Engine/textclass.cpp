@@ -4,8 +4,23 @@ TextClass::TextClass()
 {
     m_Font = 0;
     m_FontShader = 0;
-
-    m_sentence1 = 0;
+    m_LayoutCache = 0;
+
+    m_sentenceCount = 0;
+    m_renderCountSentence = -1;
+    m_layoutCacheSentence = -1;
+    m_bytesMappedSentence = -1;
+    m_textureBytesSentence = -1;
+
+    m_vertices = 0;
+    m_vertexCapacityUsed = 0;
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_drawVertexCount = 0;
+    m_dirty = false;
+
+    m_rebuildCount = 0;
+    m_uploadCount = 0;
 }
 
 TextClass::TextClass(const TextClass& other)
@@ -18,22 +33,19 @@ TextClass::~TextClass()
 
 }
 
-bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, int screenWidth, int screenHeight, D3DXMATRIX baseViewMatrix)
+bool TextClass::Initialize(RenderDeviceClass* device, HWND hwnd, int screenWidth, int screenHeight, MatrixType baseViewMatrix)
 {
+    unsigned int* indices;
     bool result;
+    int i;
 
     m_screenWidth = screenWidth;
     m_screenHeight = screenHeight;
 
     m_baseViewMatrix = baseViewMatrix;
 
-    // Create font object
-    m_Font = new FontClass;
-    if (!m_Font)
-        return false;
-
     // Init font object
-    result = m_Font->Initialize(device, "../Engine/data/fontdata.txt", L"../Engine/data/font.dds");
+    result = InitializeFont(device);
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the font object.", L"Error", MB_OK);
@@ -46,30 +58,119 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
         return false;
 
     // Init font shader object
-    result = m_FontShader->Initialize(device, hwnd);
+    result = m_FontShader->Initialize(device, m_Font->IsDistanceField());
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the font shader object.", L"Error", MB_OK);
         return false;
     }
 
-    // Init first sentence
-    result = InitializeSentence(&m_sentence1, 32, device);
+    // Create the layout cache, big enough for any sentence
+    m_LayoutCache = new TextLayoutCacheClass;
+    if (!m_LayoutCache)
+        return false;
+
+    result = m_LayoutCache->Initialize(TEXT_LAYOUT_CACHE_ENTRIES, TEXT_MAX_LENGTH);
     if (!result)
         return false;
 
-    // Update sentence vertex buffer with new string info
-    result = UpdateSentence(m_sentence1, "Render Count: ", 20, 20, 1.0f, 1.0f, 1.0f, deviceContext);
+    // Glyph quads for every sentence, each sentence owns a fixed range
+    m_vertices = new VertexType[TEXT_MAX_VERTICES];
+    if (!m_vertices)
+        return false;
+
+    // The vector types have constructors, so the vertices are cleared member by member rather than with memset
+    for (i = 0; i < TEXT_MAX_VERTICES; i++)
+    {
+        m_vertices[i].position = Vector3Type(0.0f, 0.0f, 0.0f);
+        m_vertices[i].texture = Vector2Type(0.0f, 0.0f);
+        m_vertices[i].color = Vector4Type(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    // The quads are drawn as plain triangle lists so the indices never change
+    indices = new unsigned int[TEXT_MAX_VERTICES];
+    if (!indices)
+        return false;
+
+    for (i = 0; i < TEXT_MAX_VERTICES; i++)
+        indices[i] = i;
+
+    // Create the shared dynamic vertex buffer
+    m_vertexBuffer = device->CreateBuffer(RENDER_BUFFER_VERTEX, sizeof(VertexType) * TEXT_MAX_VERTICES, true, m_vertices);
+    if (!m_vertexBuffer)
+    {
+        delete[] indices;
+        return false;
+    }
+
+    // Create static index buffer
+    m_indexBuffer = device->CreateBuffer(RENDER_BUFFER_INDEX, sizeof(unsigned int) * TEXT_MAX_VERTICES, false, indices);
+
+    delete[] indices;
+    indices = 0;
+
+    if (!m_indexBuffer)
+        return false;
+
+    // Init the sentences
+    m_renderCountSentence = AddSentence(32, 20, 20, TEXT_DEFAULT_SIZE, 1.0f, 1.0f, 1.0f);
+    if (m_renderCountSentence < 0)
+        return false;
+
+    result = SetSentenceText(m_renderCountSentence, "Render Count: ");
     if (!result)
         return false;
 
+    // The layout cache's hit rate sits on the same line as the render count
+    m_layoutCacheSentence = AddSentence(32, 180, 20, TEXT_DEFAULT_SIZE, 1.0f, 1.0f, 1.0f);
+    if (m_layoutCacheSentence < 0)
+        return false;
+
+    m_bytesMappedSentence = AddSentence(32, 20, 40, TEXT_DEFAULT_SIZE, 1.0f, 1.0f, 1.0f);
+    if (m_bytesMappedSentence < 0)
+        return false;
+
+    result = SetSentenceText(m_bytesMappedSentence, "Bytes Mapped: ");
+    if (!result)
+        return false;
+
+    // Streamed texture memory goes next to the bytes mapped
+    m_textureBytesSentence = AddSentence(32, 180, 40, TEXT_DEFAULT_SIZE, 1.0f, 1.0f, 1.0f);
+    if (m_textureBytesSentence < 0)
+        return false;
+
     return true;
 }
 
 void TextClass::Shutdown()
 {
-    // Release same amount of sentences used
-    ReleaseSentence(&m_sentence1);
+    if (m_indexBuffer)
+    {
+        m_indexBuffer->Release();
+        m_indexBuffer = 0;
+    }
+
+    if (m_vertexBuffer)
+    {
+        m_vertexBuffer->Release();
+        m_vertexBuffer = 0;
+    }
+
+    if (m_vertices)
+    {
+        delete[] m_vertices;
+        m_vertices = 0;
+    }
+
+    m_sentenceCount = 0;
+    m_vertexCapacityUsed = 0;
+
+    if (m_LayoutCache)
+    {
+        m_LayoutCache->Shutdown();
+        delete m_LayoutCache;
+        m_LayoutCache = 0;
+    }
 
     if (m_FontShader)
     {
@@ -88,227 +189,242 @@ void TextClass::Shutdown()
     return;
 }
 
-bool TextClass::Render(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix)
+// Draws every sentence with one call
+bool TextClass::Render(RenderContextClass* deviceContext, MatrixType worldMatrix, MatrixType orthoMatrix)
 {
     bool result;
 
-    // Draw sentence
-    result = RenderSentence(deviceContext, m_sentence1, worldMatrix, orthoMatrix);
+    // Nothing is uploaded unless a sentence changed since the last frame
+    if (m_dirty)
+    {
+        result = UploadVertices(deviceContext);
+        if (!result)
+            return false;
+    }
+
+    if (m_drawVertexCount == 0)
+        return true;
+
+    // Set vertex buffer to active in input assembler so it can be rendered
+    deviceContext->SetVertexBuffer(m_vertexBuffer, sizeof(VertexType));
+
+    // Set index buffer to active in input assembler so it can be rendered
+    deviceContext->SetIndexBuffer(m_indexBuffer);
+
+    // Render text using the font shader
+    result = m_FontShader->Render(deviceContext, m_drawVertexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture());
     if (!result)
         return false;
 
     return true;
 }
 
-bool TextClass::InitializeSentence(SentenceType** sentence, int maxLength, ID3D11Device* device)
+// The size is the sentence's line height in pixels. Returns the new sentence's
+// index, or -1 when there is no room left.
+int TextClass::AddSentence(int maxLength, int positionX, int positionY, float size, float red, float green, float blue)
 {
-    VertexType* vertices;
-    unsigned long* indices;
-    D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-    D3D11_SUBRESOURCE_DATA vertexData, indexData;
-    HRESULT result;
-    int i;
+    SentenceType* sentence;
 
-    // Create new sentence object
-    *sentence = new SentenceType;
-    if (!*sentence)
-        return false;
+    if ((m_sentenceCount == TEXT_MAX_SENTENCES) || (maxLength >= TEXT_MAX_LENGTH))
+        return -1;
 
-    // Init sentence buffers
-    (*sentence)->vertexBuffer = 0;
-    (*sentence)->indexBuffer = 0;
+    if (m_vertexCapacityUsed + 6 * maxLength > TEXT_MAX_VERTICES)
+        return -1;
 
-    // Set max length of sentence
-    (*sentence)->maxLength = maxLength;
+    sentence = &m_sentences[m_sentenceCount];
+    sentence->text[0] = 0;
+    sentence->maxLength = maxLength;
+    sentence->positionX = positionX;
+    sentence->positionY = positionY;
+    sentence->scale = size / m_Font->GetLineHeight();
+    sentence->color = Vector4Type(red, green, blue, 1.0f);
+    sentence->firstVertex = m_vertexCapacityUsed;
+    sentence->vertexCount = 0;
 
-    // Set num of vertices in the vertex array
-    (*sentence)->vertexCount = 6 * maxLength;
+    m_vertexCapacityUsed += 6 * maxLength;
 
-    // Set num of indices in the index array
-    (*sentence)->indexCount = (*sentence)->vertexCount;
+    return m_sentenceCount++;
+}
 
-    // Create vertex array
-    vertices = new VertexType[(*sentence)->vertexCount];
-    if (!vertices)
-        return false;
+bool TextClass::SetSentenceText(int index, char* text)
+{
+    SentenceType* sentence;
+    bool result;
 
-    // Create index array
-    indices = new unsigned long[(*sentence)->indexCount];
-    if (!indices)
+    if ((index < 0) || (index >= m_sentenceCount))
         return false;
 
-    // Init vertex array
-    memset(vertices, 0, (sizeof(VertexType) * (*sentence)->vertexCount));
+    sentence = &m_sentences[index];
 
-    // Init index array
-    for (i = 0; i < (*sentence)->indexCount; i++)
-        indices[i] = i;
-
-    // Setup dynamic vertex buffer description
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(VertexType) * (*sentence)->vertexCount;
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    vertexBufferDesc.MiscFlags = 0;
-    vertexBufferDesc.StructureByteStride = 0;
-
-    vertexData.pSysMem = vertices;
-    vertexData.SysMemPitch = 0;
-    vertexData.SysMemSlicePitch = 0;
-
-    // Create vertex buffer
-    result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &(*sentence)->vertexBuffer);
-    if (FAILED(result))
+    // Check for possible buffer overflow, the length is in bytes rather than characters
+    if ((int)strlen(text) > sentence->maxLength)
         return false;
 
-    // Setup static index buffer description
-    indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(unsigned long) * (*sentence)->indexCount;
-    indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    indexBufferDesc.CPUAccessFlags = 0;
-    indexBufferDesc.MiscFlags = 0;
-    indexBufferDesc.StructureByteStride = 0;
-
-    indexData.pSysMem = indices;
-    indexData.SysMemPitch = 0;
-    indexData.SysMemSlicePitch = 0;
-
-    // Create index buffer
-    result = device->CreateBuffer(&indexBufferDesc, &indexData, &(*sentence)->indexBuffer);
-    if (FAILED(result))
-        return false;
+    // Same text as last time, the quads are still good
+    if (strcmp(sentence->text, text) == 0)
+        return true;
 
-    delete[] vertices;
-    vertices = 0;
+    strcpy(sentence->text, text);
 
-    delete[] indices;
-    indices = 0;
+    result = UpdateSentence(sentence);
+    if (!result)
+        return false;
 
     return true;
 }
 
-bool TextClass::UpdateSentence(SentenceType* sentence, char* text, int positionX, int positionY, float red, float green, float blue, ID3D11DeviceContext* deviceContext)
+int TextClass::GetRebuildCount()
 {
-    int numLetters;
-    VertexType* vertices;
-    float drawX, drawY;
-    HRESULT result;
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    VertexType* verticesPtr;
+    return m_rebuildCount;
+}
 
-    sentence->red = red;
-    sentence->green = green;
-    sentence->blue = blue;
+int TextClass::GetUploadCount()
+{
+    return m_uploadCount;
+}
 
-    // Get num letters in sentence
-    numLetters = (int)strlen(text);
+// Prefers the baked distance field font and falls back to the ASCII bitmap font
+// while none has been baked with -bakefont
+bool TextClass::InitializeFont(RenderDeviceClass* device)
+{
+    bool result;
 
-    // Check for possible buffer overflow
-    if (numLetters > sentence->maxLength)
+    // Create font object
+    m_Font = new FontClass;
+    if (!m_Font)
         return false;
 
-    // Create vertex array
-    vertices = new VertexType[sentence->vertexCount];
-    if (!vertices)
-        return false;
+    result = m_Font->Initialize(device, "../Engine/data/overlay.font", L"../Engine/data/overlay.dds");
+    if (result)
+        return true;
 
-    // Init vertex array
-    memset(vertices, 0, (sizeof(VertexType) * sentence->vertexCount));
+    m_Font->Shutdown();
 
-    // Calc the X and Y pixel position on screen to start drawing to
-    drawX = (float)(((m_screenWidth / 2) * -1) + positionX);
-    drawY = (float)((m_screenHeight / 2) - positionY);
+    result = m_Font->Initialize(device, "../Engine/data/fontdata.txt", L"../Engine/data/font.dds");
+    if (!result)
+        return false;
 
-    // Use font class to build vertex array from the sentence text and sentence draw location
-    m_Font->BuildVertexArray((void*)vertices, text, drawX, drawY);
+    return true;
+}
 
-    // Lock vertex buffer
-    result = deviceContext->Map(sentence->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(result))
-        return false;
+// Rebuilds one sentence's quads in its own range of the CPU array
+bool TextClass::UpdateSentence(SentenceType* sentence)
+{
+    float drawX, drawY;
 
-    verticesPtr = (VertexType*)mappedResource.pData;
+    PROFILE_ZONE("Update sentence");
 
-    // Copy data into vertex buffer
-    memcpy(verticesPtr, (void*)vertices, (sizeof(VertexType) * sentence->vertexCount));
+    // Calc the X and Y pixel position on screen to start drawing to
+    drawX = (float)(((m_screenWidth / 2) * -1) + sentence->positionX);
+    drawY = (float)((m_screenHeight / 2) - sentence->positionY);
 
-    // Unlock vertex buffer
-    deviceContext->Unmap(sentence->vertexBuffer, 0);
+    // Build vertex array from the sentence text and draw location, or copy it from a recent layout of the same text
+    sentence->vertexCount = m_LayoutCache->BuildVertexArray(m_Font, (void*)&m_vertices[sentence->firstVertex], sentence->text, drawX, drawY,
+        sentence->color, sentence->scale);
 
-    delete[] vertices;
-    vertices = 0;
+    m_dirty = true;
+    m_rebuildCount++;
 
     return true;
 }
 
-void TextClass::ReleaseSentence(SentenceType** sentence)
+// Packs the used quads of every sentence into the front of the shared buffer
+bool TextClass::UploadVertices(RenderContextClass* deviceContext)
 {
-    if (*sentence)
+    VertexType* dataPtr;
+    int i, vertexCount;
+    bool result;
+
+    result = deviceContext->Map(m_vertexBuffer, RENDER_MAP_DISCARD, (void**)&dataPtr);
+    if (!result)
+        return false;
+
+    vertexCount = 0;
+    for (i = 0; i < m_sentenceCount; i++)
     {
-        if ((*sentence)->vertexBuffer)
-        {
-            (*sentence)->vertexBuffer->Release();
-            (*sentence)->vertexBuffer = 0;
-        }
-
-        if ((*sentence)->indexBuffer)
-        {
-            (*sentence)->indexBuffer->Release();
-            (*sentence)->indexBuffer = 0;
-        }
-
-        delete * sentence;
-        *sentence = 0;
+        memcpy(&dataPtr[vertexCount], &m_vertices[m_sentences[i].firstVertex], sizeof(VertexType) * m_sentences[i].vertexCount);
+        vertexCount += m_sentences[i].vertexCount;
     }
 
-    return;
+    deviceContext->Unmap(m_vertexBuffer, sizeof(VertexType) * vertexCount);
+
+    m_drawVertexCount = vertexCount;
+    m_dirty = false;
+    m_uploadCount++;
+
+    return true;
 }
 
-bool TextClass::RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix)
+bool TextClass::SetRenderCount(int count)
 {
-    unsigned int stride, offset;
-    D3DXVECTOR4 pixelColor;
+    char tempString[32];
+    char countString[32];
     bool result;
 
-    stride = sizeof(VertexType);
-    offset = 0;
-
-    // Set vertex buffer to active in input assembler so it can be rendered
-    deviceContext->IASetVertexBuffers(0, 1, &sentence->vertexBuffer, &stride, &offset);
+    // Convert count integer to string format
+    _itoa_s(count, tempString, 10);
 
-    // Set index buffer to active in input assembler so it can be rendered
-    deviceContext->IASetIndexBuffer(sentence->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    // Setup render count string
+    strcpy_s(countString, "Render Count: ");
+    strcat_s(countString, tempString);
 
-    // Set type of primitive that should be rendered from this vertex buffer
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    // Only rebuilds the quads if the count changed
+    result = SetSentenceText(m_renderCountSentence, countString);
+    if (!result)
+        return false;
 
-    // Create pixel color vector with the input sentence color
-    pixelColor = D3DXVECTOR4(sentence->red, sentence->green, sentence->blue, 1.0f);
-
-    // Render text using the font shader
-    result = m_FontShader->Render(deviceContext, sentence->indexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(), pixelColor);
+    // Setup layout cache hit rate string
+    _itoa_s(m_LayoutCache->GetHitRate(), tempString, 10);
+    strcpy_s(countString, "Layout Cache: ");
+    strcat_s(countString, tempString);
+    strcat_s(countString, "% hits");
 
+    result = SetSentenceText(m_layoutCacheSentence, countString);
     if (!result)
         return false;
 
     return true;
 }
 
-bool TextClass::SetRenderCount(int count, ID3D11DeviceContext* deviceContext)
+bool TextClass::SetBytesMapped(unsigned int bytes)
 {
     char tempString[32];
-    char countString[32];
+    char bytesString[32];
     bool result;
 
-    // Convert count integer to string format
-    _itoa_s(count, tempString, 10);
+    // Convert byte count to string format
+    _itoa_s(bytes, tempString, 10);
 
-    // Setup render count string
-    strcpy_s(countString, "Render Count: ");
-    strcpy_s(countString, tempString);
+    // Setup bytes mapped string
+    strcpy_s(bytesString, "Bytes Mapped: ");
+    strcat_s(bytesString, tempString);
+
+    // Only rebuilds the quads if the byte count changed
+    result = SetSentenceText(m_bytesMappedSentence, bytesString);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+// Shown in KB as resident over requested, the two only differ while mips are loading or the budget is full
+bool TextClass::SetTextureBytes(unsigned int residentBytes, unsigned int requestedBytes)
+{
+    char tempString[32];
+    char bytesString[32];
+    bool result;
 
-    // Update sentence vertex buffer with new string info
-    result = UpdateSentence(m_sentence1, countString, 20, 20, 1.0f, 1.0f, 1.0f, deviceContext);
+    // Setup texture memory string
+    strcpy_s(bytesString, "Textures: ");
+    _itoa_s(residentBytes / 1024, tempString, 10);
+    strcat_s(bytesString, tempString);
+    strcat_s(bytesString, "/");
+    _itoa_s(requestedBytes / 1024, tempString, 10);
+    strcat_s(bytesString, tempString);
+    strcat_s(bytesString, " KB");
+
+    // Only rebuilds the quads if either value changed
+    result = SetSentenceText(m_textureBytesSentence, bytesString);
     if (!result)
         return false;
 
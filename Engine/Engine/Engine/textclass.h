@@ -1,22 +1,41 @@
 #pragma once
 
+#include "platform.h"
 #include "fontclass.h"
 #include "fontshaderclass.h"
+#include "textlayoutcacheclass.h"
+#include "profilerclass.h"
 
+const int TEXT_MAX_SENTENCES = 16;
+const int TEXT_MAX_LENGTH = 64;
+const int TEXT_MAX_VERTICES = 6 * 512;
+const float TEXT_DEFAULT_SIZE = 16.0f;
+
+// Every sentence is drawn from one shared dynamic vertex buffer in a single
+// call. Sentences keep their glyph quads in their own part of a CPU array and
+// only rebuild them when their text actually changes. The shared buffer is
+// only uploaded on frames where something changed. Text is UTF-8 and drawn
+// with the baked distance field font when there is one, so sentences can be
+// any size, otherwise with the old ASCII bitmap font. Rebuilt sentences go
+// through a cache of recent layouts first.
 class TextClass
 {
 private:
     struct SentenceType
     {
-        ID3D11Buffer *vertexBuffer, *indexBuffer;
-        int vertexCount, indexCount, maxLength;
-        float red, green, blue;
+        char text[TEXT_MAX_LENGTH];
+        int maxLength;
+        int positionX, positionY;
+        float scale;
+        Vector4Type color;
+        int firstVertex, vertexCount;
     };
 
     struct VertexType
     {
-        D3DXVECTOR3 position;
-        D3DXVECTOR2 texture;
+        Vector3Type position;
+        Vector2Type texture;
+        Vector4Type color;
     };
 
 public:
@@ -24,23 +43,41 @@ public:
     TextClass(const TextClass&);
     ~TextClass();
 
-    bool Initialize(ID3D11Device*, ID3D11DeviceContext*, HWND, int, int, D3DXMATRIX);
+    bool Initialize(RenderDeviceClass*, HWND, int, int, MatrixType);
     void Shutdown();
-    bool Render(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX);
+    bool Render(RenderContextClass*, MatrixType, MatrixType);
+
+    bool SetRenderCount(int);
+    bool SetBytesMapped(unsigned int);
+    bool SetTextureBytes(unsigned int, unsigned int);
+
+    int AddSentence(int, int, int, float, float, float, float);
+    bool SetSentenceText(int, char*);
 
-    bool SetRenderCount(int, ID3D11DeviceContext*);
+    int GetRebuildCount();
+    int GetUploadCount();
 
 private:
-    bool InitializeSentence(SentenceType**, int, ID3D11Device*);
-    bool UpdateSentence(SentenceType*, char*, int, int, float, float, float, ID3D11DeviceContext*);
-    void ReleaseSentence(SentenceType**);
-    bool RenderSentence(ID3D11DeviceContext*, SentenceType*, D3DXMATRIX, D3DXMATRIX);
+    bool InitializeFont(RenderDeviceClass*);
+    bool UpdateSentence(SentenceType*);
+    bool UploadVertices(RenderContextClass*);
 
 private:
     FontClass* m_Font;
     FontShaderClass* m_FontShader;
+    TextLayoutCacheClass* m_LayoutCache;
     int m_screenWidth, m_screenHeight;
-    D3DXMATRIX m_baseViewMatrix;
+    MatrixType m_baseViewMatrix;
+
+    SentenceType m_sentences[TEXT_MAX_SENTENCES];
+    int m_sentenceCount;
+    int m_renderCountSentence, m_layoutCacheSentence, m_bytesMappedSentence, m_textureBytesSentence;
+
+    VertexType* m_vertices;
+    int m_vertexCapacityUsed;
+    RenderBuffer *m_vertexBuffer, *m_indexBuffer;
+    int m_drawVertexCount;
+    bool m_dirty;
 
-    SentenceType* m_sentence1;
+    int m_rebuildCount, m_uploadCount;
 };
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "textlayoutcacheclass.h"
+
+TextLayoutCacheClass::TextLayoutCacheClass()
+{
+    m_entries = 0;
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+    m_maxLength = 0;
+    m_head = -1;
+    m_tail = -1;
+    m_buckets = 0;
+    m_bucketMask = 0;
+    m_text = 0;
+    m_runVertices = 0;
+    m_scratch = 0;
+    m_hitCount = 0;
+    m_missCount = 0;
+}
+
+TextLayoutCacheClass::TextLayoutCacheClass(const TextLayoutCacheClass& other)
+{
+
+}
+
+TextLayoutCacheClass::~TextLayoutCacheClass()
+{
+
+}
+
+// Every entry gets room for a string of the longest length up front, longer
+// strings are laid out without the cache
+bool TextLayoutCacheClass::Initialize(int entryCount, int maxLength)
+{
+    unsigned int bucketCount;
+    int i;
+
+    m_entryCapacity = entryCount;
+    m_maxLength = maxLength;
+
+    m_entries = new EntryType[m_entryCapacity];
+    if (!m_entries)
+        return false;
+
+    m_text = new char[m_entryCapacity * (m_maxLength + 1)];
+    if (!m_text)
+        return false;
+
+    m_runVertices = new RunVertexType[m_entryCapacity * 6 * m_maxLength];
+    if (!m_runVertices)
+        return false;
+
+    m_scratch = new VertexType[6 * m_maxLength];
+    if (!m_scratch)
+        return false;
+
+    for (i = 0; i < m_entryCapacity; i++)
+    {
+        m_entries[i].text = &m_text[i * (m_maxLength + 1)];
+        m_entries[i].vertices = &m_runVertices[i * 6 * m_maxLength];
+    }
+
+    bucketCount = 1;
+    while (bucketCount < (unsigned int)m_entryCapacity * 2)
+        bucketCount *= 2;
+
+    m_buckets = new int[bucketCount];
+    if (!m_buckets)
+        return false;
+
+    for (i = 0; i < (int)bucketCount; i++)
+        m_buckets[i] = -1;
+
+    m_bucketMask = bucketCount - 1;
+    m_entryCount = 0;
+    m_head = -1;
+    m_tail = -1;
+    m_hitCount = 0;
+    m_missCount = 0;
+
+    return true;
+}
+
+void TextLayoutCacheClass::Shutdown()
+{
+    if (m_buckets)
+    {
+        delete[] m_buckets;
+        m_buckets = 0;
+    }
+
+    if (m_scratch)
+    {
+        delete[] m_scratch;
+        m_scratch = 0;
+    }
+
+    if (m_runVertices)
+    {
+        delete[] m_runVertices;
+        m_runVertices = 0;
+    }
+
+    if (m_text)
+    {
+        delete[] m_text;
+        m_text = 0;
+    }
+
+    if (m_entries)
+    {
+        delete[] m_entries;
+        m_entries = 0;
+    }
+
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+
+    return;
+}
+
+// Same as FontClass::BuildVertexArray, but only lays the text out when it isn't cached
+int TextLayoutCacheClass::BuildVertexArray(FontClass* font, void* vertices, char* text, float drawX, float drawY, Vector4Type color, float scale)
+{
+    EntryType* entry;
+    unsigned long long hash;
+    unsigned int bucket;
+    int index, i;
+
+    if ((int)strlen(text) > m_maxLength)
+        return font->BuildVertexArray(vertices, text, drawX, drawY, color, scale);
+
+    hash = HashRun(font, text, scale);
+
+    index = FindEntry(hash, font, text, scale);
+    if (index >= 0)
+    {
+        m_hitCount++;
+
+        // Most recently used goes to the front
+        Unlink(index);
+        PushFront(index);
+
+        return CopyRun(m_entries[index], vertices, drawX, drawY, color);
+    }
+
+    m_missCount++;
+
+    index = AllocateEntry();
+    entry = &m_entries[index];
+
+    // Laid out at the origin so it can go anywhere later
+    entry->vertexCount = font->BuildVertexArray((void*)m_scratch, text, 0.0f, 0.0f, color, scale);
+    for (i = 0; i < entry->vertexCount; i++)
+    {
+        entry->vertices[i].x = m_scratch[i].position.x;
+        entry->vertices[i].y = m_scratch[i].position.y;
+        entry->vertices[i].u = m_scratch[i].texture.x;
+        entry->vertices[i].v = m_scratch[i].texture.y;
+    }
+
+    entry->hash = hash;
+    entry->font = font;
+    entry->scale = scale;
+    strcpy(entry->text, text);
+
+    bucket = (unsigned int)hash & m_bucketMask;
+    entry->chain = m_buckets[bucket];
+    m_buckets[bucket] = index;
+
+    PushFront(index);
+
+    return CopyRun(*entry, vertices, drawX, drawY, color);
+}
+
+unsigned int TextLayoutCacheClass::GetHitCount()
+{
+    return m_hitCount;
+}
+
+unsigned int TextLayoutCacheClass::GetMissCount()
+{
+    return m_missCount;
+}
+
+// As a whole percentage so it only changes now and then
+int TextLayoutCacheClass::GetHitRate()
+{
+    if (m_hitCount + m_missCount == 0)
+        return 0;
+
+    return (int)((unsigned long long)m_hitCount * 100 / (m_hitCount + m_missCount));
+}
+
+// FNV-1a over the text, then the font and the scale folded in
+unsigned long long TextLayoutCacheClass::HashRun(FontClass* font, char* text, float scale)
+{
+    unsigned long long hash, value;
+    unsigned int scaleBits;
+    const unsigned char* bytes;
+
+    hash = 0xcbf29ce484222325ull;
+    for (bytes = (const unsigned char*)text; *bytes; bytes++)
+    {
+        hash ^= *bytes;
+        hash *= 0x100000001b3ull;
+    }
+
+    memcpy(&scaleBits, &scale, sizeof(scaleBits));
+    value = (unsigned long long)(size_t)font ^ ((unsigned long long)scaleBits << 32);
+
+    hash ^= value;
+    hash *= 0x100000001b3ull;
+    hash ^= hash >> 29;
+
+    return hash;
+}
+
+// The text is compared as well so two strings with the same hash can't be mixed up
+int TextLayoutCacheClass::FindEntry(unsigned long long hash, FontClass* font, char* text, float scale)
+{
+    int index;
+
+    index = m_buckets[(unsigned int)hash & m_bucketMask];
+    while (index >= 0)
+    {
+        if ((m_entries[index].hash == hash) && (m_entries[index].font == font) && (m_entries[index].scale == scale) &&
+            (strcmp(m_entries[index].text, text) == 0))
+            return index;
+
+        index = m_entries[index].chain;
+    }
+
+    return -1;
+}
+
+// A fresh entry until they run out, then the least recently used one
+int TextLayoutCacheClass::AllocateEntry()
+{
+    unsigned int bucket;
+    int index, *link;
+
+    if (m_entryCount < m_entryCapacity)
+        return m_entryCount++;
+
+    index = m_tail;
+    Unlink(index);
+
+    // Take it out of its bucket's chain
+    bucket = (unsigned int)m_entries[index].hash & m_bucketMask;
+    link = &m_buckets[bucket];
+    while (*link != index)
+        link = &m_entries[*link].chain;
+    *link = m_entries[index].chain;
+
+    return index;
+}
+
+void TextLayoutCacheClass::Unlink(int index)
+{
+    EntryType* entry;
+
+    entry = &m_entries[index];
+
+    if (entry->previous >= 0)
+        m_entries[entry->previous].next = entry->next;
+    else
+        m_head = entry->next;
+
+    if (entry->next >= 0)
+        m_entries[entry->next].previous = entry->previous;
+    else
+        m_tail = entry->previous;
+
+    return;
+}
+
+void TextLayoutCacheClass::PushFront(int index)
+{
+    m_entries[index].previous = -1;
+    m_entries[index].next = m_head;
+
+    if (m_head >= 0)
+        m_entries[m_head].previous = index;
+    else
+        m_tail = index;
+
+    m_head = index;
+
+    return;
+}
+
+// Moves the run to where it is drawn and gives it its colour
+int TextLayoutCacheClass::CopyRun(const EntryType& entry, void* vertices, float drawX, float drawY, Vector4Type color)
+{
+    VertexType* vertexPtr;
+    int i;
+
+    vertexPtr = (VertexType*)vertices;
+
+    for (i = 0; i < entry.vertexCount; i++)
+    {
+        vertexPtr[i].position = Vector3Type(entry.vertices[i].x + drawX, entry.vertices[i].y + drawY, 0.0f);
+        vertexPtr[i].texture = Vector2Type(entry.vertices[i].u, entry.vertices[i].v);
+        vertexPtr[i].color = color;
+    }
+
+    return entry.vertexCount;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string.h>
+#include "fontclass.h"
+
+const int TEXT_LAYOUT_CACHE_ENTRIES = 64;
+
+// Keeps the glyph quads of recently laid out strings so text that comes back,
+// like a counter going up and down, is copied rather than laid out again. Runs
+// are keyed by a hash of the text, the font and the scale and stored at the
+// origin without colour, so one run serves any position and colour. The least
+// recently used run makes room when the cache is full.
+class TextLayoutCacheClass
+{
+private:
+    struct VertexType
+    {
+        Vector3Type position;
+        Vector2Type texture;
+        Vector4Type color;
+    };
+
+    struct RunVertexType
+    {
+        float x, y, u, v;
+    };
+
+    struct EntryType
+    {
+        unsigned long long hash;
+        FontClass* font;
+        float scale;
+        char* text;
+        RunVertexType* vertices;
+        int vertexCount;
+        int previous, next;
+        int chain;
+    };
+
+public:
+    TextLayoutCacheClass();
+    TextLayoutCacheClass(const TextLayoutCacheClass&);
+    ~TextLayoutCacheClass();
+
+    bool Initialize(int, int);
+    void Shutdown();
+
+    int BuildVertexArray(FontClass*, void*, char*, float, float, Vector4Type, float);
+
+    unsigned int GetHitCount();
+    unsigned int GetMissCount();
+    int GetHitRate();
+
+private:
+    static unsigned long long HashRun(FontClass*, char*, float);
+    int FindEntry(unsigned long long, FontClass*, char*, float);
+    int AllocateEntry();
+    void Unlink(int);
+    void PushFront(int);
+    int CopyRun(const EntryType&, void*, float, float, Vector4Type);
+
+private:
+    EntryType* m_entries;
+    int m_entryCount, m_entryCapacity;
+    int m_maxLength;
+    int m_head, m_tail;
+
+    int* m_buckets;
+    unsigned int m_bucketMask;
+
+    char* m_text;
+    RunVertexType* m_runVertices;
+    VertexType* m_scratch;
+
+    unsigned int m_hitCount, m_missCount;
+};
\ No newline at end of file
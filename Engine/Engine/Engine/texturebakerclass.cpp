@@ -0,0 +1,1352 @@
+#include "texturebakerclass.h"
+
+// Offsets into the DDS header, after the four byte magic number
+const int DDS_HEADER_SIZE = 124;
+const int DDS_DX10_HEADER_SIZE = 20;
+const unsigned int DDS_HEADER_FLAGS = 0xa1007;
+const unsigned int DDS_PIXEL_FOURCC = 0x4;
+const unsigned int DDS_CAPS_TEXTURE = 0x1000;
+const unsigned int DDS_CAPS_MIPMAP = 0x400008;
+const unsigned int DDS_DIMENSION_TEXTURE2D = 3;
+
+// BC7 interpolation weights for 4 bit indices, out of 64
+static const int g_bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static float Dot(Float4Type a, Float4Type b)
+{
+    Float4Type product, sum;
+
+    product = Float4Mul(a, b);
+    sum = Float4Add(product, Float4Swizzle<1, 0, 3, 2>(product));
+    sum = Float4Add(sum, Float4Swizzle<2, 3, 0, 1>(sum));
+
+    return Float4GetX(sum);
+}
+
+static Float4Type Clamp(Float4Type value, float low, float high)
+{
+    return Float4Min(Float4Max(value, Float4Splat(low)), Float4Splat(high));
+}
+
+static Float4Type UnpackPixel(unsigned int pixel)
+{
+    return Float4Set((float)(pixel & 0xff), (float)((pixel >> 8) & 0xff), (float)((pixel >> 16) & 0xff), (float)(pixel >> 24));
+}
+
+static void WriteBits(unsigned char* block, int& position, unsigned int value, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++, position++)
+    {
+        if (value & (1 << i))
+            block[position >> 3] |= (unsigned char)(1 << (position & 7));
+    }
+
+    return;
+}
+
+static unsigned int ReadBits(const unsigned char* block, int& position, int count)
+{
+    unsigned int value;
+    int i;
+
+    value = 0;
+    for (i = 0; i < count; i++, position++)
+    {
+        if (block[position >> 3] & (1 << (position & 7)))
+            value |= 1 << i;
+    }
+
+    return value;
+}
+
+static unsigned short Pack565(Float4Type color)
+{
+    float channels[4];
+
+    Float4Store(channels, Clamp(color, 0.0f, 255.0f));
+
+    return (unsigned short)(((int)(channels[0] * 31.0f / 255.0f + 0.5f) << 11) | ((int)(channels[1] * 63.0f / 255.0f + 0.5f) << 5) |
+        (int)(channels[2] * 31.0f / 255.0f + 0.5f));
+}
+
+static Float4Type Unpack565(unsigned short color)
+{
+    int red, green, blue;
+
+    red = color >> 11;
+    green = (color >> 5) & 63;
+    blue = color & 31;
+
+    return Float4Set((float)((red << 3) | (red >> 2)), (float)((green << 2) | (green >> 4)), (float)((blue << 3) | (blue >> 2)), 0.0f);
+}
+
+// Picks the nearest of the four BC1 colours for each pixel and returns the squared error
+static float FitBC1Indices(const Float4Type* points, unsigned short color0, unsigned short color1, unsigned int& indices)
+{
+    Float4Type palette[4], third;
+    float error, distance, best;
+    int i, j, bestIndex;
+
+    palette[0] = Unpack565(color0);
+    palette[1] = Unpack565(color1);
+    third = Float4Splat(1.0f / 3.0f);
+    palette[2] = Float4Mul(Float4Add(Float4Add(palette[0], palette[0]), palette[1]), third);
+    palette[3] = Float4Mul(Float4Add(Float4Add(palette[1], palette[1]), palette[0]), third);
+
+    indices = 0;
+    error = 0.0f;
+    for (i = 0; i < 16; i++)
+    {
+        best = 1e30f;
+        bestIndex = 0;
+
+        // Equal colours decode in three colour mode, where only the first one is certain
+        for (j = 0; j < ((color0 == color1) ? 1 : 4); j++)
+        {
+            distance = Dot(Float4Sub(points[i], palette[j]), Float4Sub(points[i], palette[j]));
+            if (distance < best)
+            {
+                best = distance;
+                bestIndex = j;
+            }
+        }
+
+        indices |= (unsigned int)bestIndex << (i * 2);
+        error += best;
+    }
+
+    return error;
+}
+
+// Nearest of the sixteen BC7 colours between two endpoints, returns the squared error
+static float FitBC7Indices(const Float4Type* points, const int* endpoint0, const int* endpoint1, int* indices)
+{
+    Float4Type palette[16];
+    float error, distance, best;
+    int i, j;
+
+    for (i = 0; i < 16; i++)
+    {
+        palette[i] = Float4Set((float)(((64 - g_bc7Weights[i]) * endpoint0[0] + g_bc7Weights[i] * endpoint1[0] + 32) >> 6),
+            (float)(((64 - g_bc7Weights[i]) * endpoint0[1] + g_bc7Weights[i] * endpoint1[1] + 32) >> 6),
+            (float)(((64 - g_bc7Weights[i]) * endpoint0[2] + g_bc7Weights[i] * endpoint1[2] + 32) >> 6),
+            (float)(((64 - g_bc7Weights[i]) * endpoint0[3] + g_bc7Weights[i] * endpoint1[3] + 32) >> 6));
+    }
+
+    error = 0.0f;
+    for (i = 0; i < 16; i++)
+    {
+        best = 1e30f;
+        for (j = 0; j < 16; j++)
+        {
+            distance = Dot(Float4Sub(points[i], palette[j]), Float4Sub(points[i], palette[j]));
+            if (distance < best)
+            {
+                best = distance;
+                indices[i] = j;
+            }
+        }
+
+        error += best;
+    }
+
+    return error;
+}
+
+// BC7 mode 6 endpoints are 7 bits a channel and a shared low bit, the bit that rounds better is kept
+static void QuantizeBC7Endpoint(Float4Type color, int* endpoint)
+{
+    float channels[4], error[2];
+    int values[2][4], bit, i;
+
+    Float4Store(channels, Clamp(color, 0.0f, 255.0f));
+
+    for (bit = 0; bit < 2; bit++)
+    {
+        error[bit] = 0.0f;
+        for (i = 0; i < 4; i++)
+        {
+            values[bit][i] = (int)((channels[i] - bit) / 2.0f + 0.5f);
+            if (values[bit][i] < 0)
+                values[bit][i] = 0;
+            if (values[bit][i] > 127)
+                values[bit][i] = 127;
+
+            values[bit][i] = (values[bit][i] << 1) | bit;
+            error[bit] += (values[bit][i] - channels[i]) * (values[bit][i] - channels[i]);
+        }
+    }
+
+    bit = (error[1] < error[0]) ? 1 : 0;
+    for (i = 0; i < 4; i++)
+        endpoint[i] = values[bit][i];
+
+    return;
+}
+
+// Least squares endpoints for fixed interpolation weights, false when the weights can't separate them
+static bool SolveEndpoints(const Float4Type* points, const float* weights, Float4Type& endpoint0, Float4Type& endpoint1)
+{
+    Float4Type sumA, sumB;
+    float aa, ab, bb, a, b, determinant;
+    int i;
+
+    sumA = Float4Zero();
+    sumB = Float4Zero();
+    aa = 0.0f;
+    ab = 0.0f;
+    bb = 0.0f;
+
+    for (i = 0; i < 16; i++)
+    {
+        a = weights[i];
+        b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        sumA = Float4Add(sumA, Float4Mul(points[i], Float4Splat(a)));
+        sumB = Float4Add(sumB, Float4Mul(points[i], Float4Splat(b)));
+    }
+
+    determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f)
+        return false;
+
+    endpoint0 = Float4Mul(Float4Sub(Float4Mul(sumA, Float4Splat(bb)), Float4Mul(sumB, Float4Splat(ab))), Float4Splat(1.0f / determinant));
+    endpoint1 = Float4Mul(Float4Sub(Float4Mul(sumB, Float4Splat(aa)), Float4Mul(sumA, Float4Splat(ab))), Float4Splat(1.0f / determinant));
+
+    return true;
+}
+
+TextureBakerClass::TextureBakerClass()
+{
+    m_filter = TEXTURE_BAKE_FILTER_KAISER;
+    m_srgb = true;
+    m_threadCount = 0;
+    m_textures = 0;
+    m_textureCount = 0;
+    m_textureCapacity = 0;
+    m_levelCount = 0;
+    m_rowCount = 0;
+    m_encodeFormat = TEXTURE_BAKE_BC1;
+    m_pool = 0;
+
+    memset(m_levels, 0, sizeof(m_levels));
+}
+
+TextureBakerClass::TextureBakerClass(const TextureBakerClass& other)
+{
+
+}
+
+TextureBakerClass::~TextureBakerClass()
+{
+
+}
+
+bool TextureBakerClass::Initialize(char* manifestFilename)
+{
+    float offset, sum;
+    bool result;
+    int i;
+
+    m_textureCapacity = TEXTURE_BAKE_CAPACITY;
+    m_textures = new TextureType[m_textureCapacity];
+    if (!m_textures)
+        return false;
+
+    result = ReadManifest(manifestFilename);
+    if (!result)
+        return false;
+
+    // Windowed sinc for halving, the taps sit under the two source pixels of each destination pixel and two either side
+    sum = 0.0f;
+    for (i = 0; i < TEXTURE_BAKE_KAISER_TAPS; i++)
+    {
+        offset = ((float)i - (TEXTURE_BAKE_KAISER_TAPS - 1) * 0.5f) * 0.5f;
+        m_kaiserWeights[i] = KaiserWindow(offset);
+        if (offset != 0.0f)
+            m_kaiserWeights[i] *= sinf(3.14159265f * offset) / (3.14159265f * offset);
+        sum += m_kaiserWeights[i];
+    }
+
+    for (i = 0; i < TEXTURE_BAKE_KAISER_TAPS; i++)
+        m_kaiserWeights[i] /= sum;
+
+    for (i = 0; i < 256; i++)
+        m_srgbToLinear[i] = SrgbToLinear((float)i / 255.0f);
+
+    if (m_threadCount <= 0)
+        m_threadCount = (int)std::thread::hardware_concurrency();
+    if (m_threadCount <= 0)
+        m_threadCount = 1;
+
+    m_pool = new WorkStealingPoolClass;
+    if (!m_pool)
+        return false;
+
+    result = m_pool->Initialize(m_threadCount);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+void TextureBakerClass::Shutdown()
+{
+    ReleaseLevels();
+
+    if (m_pool)
+    {
+        m_pool->Shutdown();
+        delete m_pool;
+        m_pool = 0;
+    }
+
+    if (m_textures)
+    {
+        delete[] m_textures;
+        m_textures = 0;
+    }
+
+    m_textureCount = 0;
+    m_textureCapacity = 0;
+
+    return;
+}
+
+// Bakes every texture in the manifest, carrying on past ones that fail
+bool TextureBakerClass::Bake()
+{
+    ofstream log;
+    bool result;
+    int i;
+
+    log.open("texture-bake.txt");
+    if (log.fail())
+        return false;
+
+    log << "Threads: " << m_pool->GetWorkerCount() << endl;
+    log << "Mip filter: " << ((m_filter == TEXTURE_BAKE_FILTER_KAISER) ? "Kaiser" : "box") << endl;
+
+    result = true;
+    for (i = 0; i < m_textureCount; i++)
+    {
+        if (!BakeTexture(m_textures[i], log))
+        {
+            log << m_textures[i].source << ": failed" << endl;
+            result = false;
+        }
+    }
+
+    log.close();
+
+    return result;
+}
+
+int TextureBakerClass::GetTextureCount()
+{
+    return m_textureCount;
+}
+
+// The command line entry point
+bool TextureBakerClass::BakeTextures(char* manifestFilename)
+{
+    TextureBakerClass baker;
+    bool result;
+
+    result = baker.Initialize(manifestFilename);
+    if (result)
+        result = baker.Bake();
+
+    baker.Shutdown();
+
+    return result;
+}
+
+bool TextureBakerClass::ReadManifest(char* filename)
+{
+    ifstream fin;
+    char line[2 * TEXTURE_BAKE_MAX_PATH + 32], format[16], source[TEXTURE_BAKE_MAX_PATH], output[TEXTURE_BAKE_MAX_PATH];
+    int value;
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    while (fin.getline(line, sizeof(line)))
+    {
+        if ((line[0] == '#') || (line[0] == 0) || (line[0] == '\r'))
+            continue;
+
+        if (sscanf(line, "filter %15s", format) == 1)
+        {
+            if (strcmp(format, "box") == 0)
+                m_filter = TEXTURE_BAKE_FILTER_BOX;
+            else if (strcmp(format, "kaiser") == 0)
+                m_filter = TEXTURE_BAKE_FILTER_KAISER;
+            else
+                return false;
+            continue;
+        }
+
+        if (sscanf(line, "srgb %d", &value) == 1)
+        {
+            m_srgb = (value != 0);
+            continue;
+        }
+
+        if (sscanf(line, "threads %d", &m_threadCount) == 1)
+            continue;
+
+        if (sscanf(line, "texture %15s %259s %259s", format, source, output) == 3)
+        {
+            if (!AddTexture(format, source, output))
+                return false;
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+bool TextureBakerClass::AddTexture(char* format, char* source, char* output)
+{
+    TextureType* textures;
+    TextureType* texture;
+
+    if (m_textureCount == m_textureCapacity)
+    {
+        textures = new TextureType[m_textureCapacity * 2];
+        if (!textures)
+            return false;
+
+        memcpy(textures, m_textures, sizeof(TextureType) * m_textureCount);
+        delete[] m_textures;
+        m_textures = textures;
+        m_textureCapacity *= 2;
+    }
+
+    texture = &m_textures[m_textureCount];
+
+    if (strcmp(format, "bc1") == 0)
+        texture->format = TEXTURE_BAKE_BC1;
+    else if (strcmp(format, "bc3") == 0)
+        texture->format = TEXTURE_BAKE_BC3;
+    else if (strcmp(format, "bc5") == 0)
+        texture->format = TEXTURE_BAKE_BC5;
+    else if (strcmp(format, "bc7") == 0)
+        texture->format = TEXTURE_BAKE_BC7;
+    else
+        return false;
+
+    strcpy(texture->source, source);
+    strcpy(texture->output, output);
+
+    // Two channel textures hold data such as normals rather than colour
+    texture->srgb = m_srgb && (texture->format != TEXTURE_BAKE_BC5);
+
+    m_textureCount++;
+
+    return true;
+}
+
+bool TextureBakerClass::BakeTexture(TextureType& texture, ofstream& log)
+{
+    static const char* formatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+    long long start, mipsDone, encodeDone;
+    double encodeSeconds, megapixels;
+    bool result;
+    int i;
+
+    start = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    result = LoadSource(texture.source, texture.srgb);
+    if (result)
+        result = BuildMips(texture.srgb);
+
+    mipsDone = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (result)
+        result = Encode(texture.format);
+
+    encodeDone = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (result)
+        result = WriteDds(texture.output, texture.format);
+
+    if (!result)
+    {
+        ReleaseLevels();
+        return false;
+    }
+
+    megapixels = 0.0;
+    for (i = 0; i < m_levelCount; i++)
+        megapixels += (double)m_levels[i].width * m_levels[i].height / 1000000.0;
+
+    encodeSeconds = (double)(encodeDone - mipsDone) / 1000000000.0;
+
+    log << texture.source << " -> " << texture.output << endl;
+    log << "  " << formatNames[texture.format] << ", " << m_levels[0].width << " x " << m_levels[0].height << ", " << m_levelCount << " mips, " <<
+        (texture.srgb ? "sRGB" : "linear") << endl;
+    log << "  Mips ms: " << (double)(mipsDone - start) / 1000000.0 << endl;
+    log << "  Encode ms: " << encodeSeconds * 1000.0 << endl;
+    if (encodeSeconds > 0.0)
+        log << "  Encode MP/s: " << megapixels / encodeSeconds << endl;
+    log << "  PSNR dB: " << MeasurePsnr(texture.format, 0, 1) << " top mip, " << MeasurePsnr(texture.format, 0, m_levelCount) << " all mips" << endl;
+
+    ReleaseLevels();
+
+    return true;
+}
+
+// The top level of the source, kept as it is and also converted to floats for filtering
+bool TextureBakerClass::LoadSource(char* filename, bool srgb)
+{
+    DdsFileClass file;
+    LevelType* level;
+    unsigned int pixel;
+    bool result;
+    int i, channel;
+
+    result = file.Initialize(filename);
+    if (!result)
+    {
+        file.Shutdown();
+        return false;
+    }
+
+    level = &m_levels[0];
+    level->width = file.GetWidth();
+    level->height = file.GetHeight();
+    m_levelCount = 1;
+
+    level->pixels = new unsigned int[level->width * level->height];
+    level->color = new float[level->width * level->height * 4];
+    if (!level->pixels || !level->color)
+    {
+        file.Shutdown();
+        return false;
+    }
+
+    result = file.ReadPixels(0, level->pixels, level->width);
+    file.Shutdown();
+    if (!result)
+        return false;
+
+    for (i = 0; i < level->width * level->height; i++)
+    {
+        pixel = level->pixels[i];
+        for (channel = 0; channel < 3; channel++)
+        {
+            if (srgb)
+                level->color[i * 4 + channel] = m_srgbToLinear[(pixel >> (channel * 8)) & 0xff];
+            else
+                level->color[i * 4 + channel] = (float)((pixel >> (channel * 8)) & 0xff) / 255.0f;
+        }
+
+        level->color[i * 4 + 3] = (float)(pixel >> 24) / 255.0f;
+    }
+
+    return true;
+}
+
+// Each level is filtered from the float copy of the one above, not from its rounded pixels
+bool TextureBakerClass::BuildMips(bool srgb)
+{
+    LevelType* previous;
+    LevelType* level;
+    float channels[4];
+    bool result;
+    int i, channel;
+
+    while (m_levelCount < DDS_MAX_MIPS)
+    {
+        previous = &m_levels[m_levelCount - 1];
+        if ((previous->width == 1) && (previous->height == 1))
+            break;
+
+        level = &m_levels[m_levelCount];
+        level->width = (previous->width > 1) ? previous->width / 2 : 1;
+        level->height = (previous->height > 1) ? previous->height / 2 : 1;
+        m_levelCount++;
+
+        level->pixels = new unsigned int[level->width * level->height];
+        level->color = new float[level->width * level->height * 4];
+        if (!level->pixels || !level->color)
+            return false;
+
+        result = Downsample(*previous, *level);
+        if (!result)
+            return false;
+
+        for (i = 0; i < level->width * level->height; i++)
+        {
+            Float4Store(channels, Clamp(Float4Load(&level->color[i * 4]), 0.0f, 1.0f));
+
+            if (srgb)
+            {
+                for (channel = 0; channel < 3; channel++)
+                    channels[channel] = LinearToSrgb(channels[channel]);
+            }
+
+            level->pixels[i] = (unsigned int)(channels[0] * 255.0f + 0.5f) | ((unsigned int)(channels[1] * 255.0f + 0.5f) << 8) |
+                ((unsigned int)(channels[2] * 255.0f + 0.5f) << 16) | ((unsigned int)(channels[3] * 255.0f + 0.5f) << 24);
+        }
+    }
+
+    return true;
+}
+
+void TextureBakerClass::ReleaseLevels()
+{
+    int i;
+
+    for (i = 0; i < DDS_MAX_MIPS; i++)
+    {
+        if (m_levels[i].color)
+            delete[] m_levels[i].color;
+
+        if (m_levels[i].pixels)
+            delete[] m_levels[i].pixels;
+
+        if (m_levels[i].blocks)
+            delete[] m_levels[i].blocks;
+    }
+
+    memset(m_levels, 0, sizeof(m_levels));
+    m_levelCount = 0;
+
+    return;
+}
+
+// Halves a level with a 2x2 box or, separably, with the Kaiser windowed sinc. Edges are clamped
+bool TextureBakerClass::Downsample(const LevelType& source, LevelType& destination)
+{
+    Float4Type sum;
+    float* rows;
+    int x, y, x0, x1, y0, y1, i, sample;
+
+    if (m_filter == TEXTURE_BAKE_FILTER_BOX)
+    {
+        for (y = 0; y < destination.height; y++)
+        {
+            y0 = y * 2;
+            y1 = (y0 + 1 < source.height) ? y0 + 1 : y0;
+
+            for (x = 0; x < destination.width; x++)
+            {
+                x0 = x * 2;
+                x1 = (x0 + 1 < source.width) ? x0 + 1 : x0;
+
+                sum = Float4Add(Float4Load(&source.color[(y0 * source.width + x0) * 4]), Float4Load(&source.color[(y0 * source.width + x1) * 4]));
+                sum = Float4Add(sum, Float4Load(&source.color[(y1 * source.width + x0) * 4]));
+                sum = Float4Add(sum, Float4Load(&source.color[(y1 * source.width + x1) * 4]));
+                Float4Store(&destination.color[(y * destination.width + x) * 4], Float4Mul(sum, Float4Splat(0.25f)));
+            }
+        }
+
+        return true;
+    }
+
+    // Across first, into rows of the destination's width
+    rows = new float[destination.width * source.height * 4];
+    if (!rows)
+        return false;
+
+    for (y = 0; y < source.height; y++)
+    {
+        for (x = 0; x < destination.width; x++)
+        {
+            sum = Float4Zero();
+            for (i = 0; i < TEXTURE_BAKE_KAISER_TAPS; i++)
+            {
+                sample = x * 2 + i - (TEXTURE_BAKE_KAISER_TAPS / 2 - 1);
+                if (sample < 0)
+                    sample = 0;
+                if (sample >= source.width)
+                    sample = source.width - 1;
+
+                sum = Float4Add(sum, Float4Mul(Float4Load(&source.color[(y * source.width + sample) * 4]), Float4Splat(m_kaiserWeights[i])));
+            }
+
+            Float4Store(&rows[(y * destination.width + x) * 4], sum);
+        }
+    }
+
+    for (y = 0; y < destination.height; y++)
+    {
+        for (x = 0; x < destination.width; x++)
+        {
+            sum = Float4Zero();
+            for (i = 0; i < TEXTURE_BAKE_KAISER_TAPS; i++)
+            {
+                sample = y * 2 + i - (TEXTURE_BAKE_KAISER_TAPS / 2 - 1);
+                if (sample < 0)
+                    sample = 0;
+                if (sample >= source.height)
+                    sample = source.height - 1;
+
+                sum = Float4Add(sum, Float4Mul(Float4Load(&rows[(sample * destination.width + x) * 4]), Float4Splat(m_kaiserWeights[i])));
+            }
+
+            Float4Store(&destination.color[(y * destination.width + x) * 4], sum);
+        }
+    }
+
+    delete[] rows;
+    rows = 0;
+
+    return true;
+}
+
+// Every row of blocks of every level is one task, so small mips don't leave threads idle
+bool TextureBakerClass::Encode(TextureBakeFormatType format)
+{
+    LevelType* level;
+    int i;
+
+    m_rowCount = 0;
+    for (i = 0; i < m_levelCount; i++)
+    {
+        level = &m_levels[i];
+        level->blocksX = (level->width + 3) / 4;
+        level->blocksY = (level->height + 3) / 4;
+        level->firstRow = m_rowCount;
+        m_rowCount += level->blocksY;
+
+        level->blocks = new unsigned char[level->blocksX * level->blocksY * GetBlockSize(format)];
+        if (!level->blocks)
+            return false;
+    }
+
+    m_encodeFormat = format;
+
+    return m_pool->Run(m_rowCount, EncodeRowTask, this);
+}
+
+void TextureBakerClass::EncodeRowTask(int task, int worker, void* userData)
+{
+    ((TextureBakerClass*)userData)->EncodeRow(task);
+    return;
+}
+
+void TextureBakerClass::EncodeRow(int row)
+{
+    unsigned int pixels[16];
+    LevelType* level;
+    int index, blockX, blockY, x, y, sampleX, sampleY, blockSize;
+
+    index = 0;
+    while ((index + 1 < m_levelCount) && (m_levels[index + 1].firstRow <= row))
+        index++;
+
+    level = &m_levels[index];
+    blockY = row - level->firstRow;
+    blockSize = GetBlockSize(m_encodeFormat);
+
+    for (blockX = 0; blockX < level->blocksX; blockX++)
+    {
+        // Blocks hanging over the edge of small mips repeat the last row and column
+        for (y = 0; y < 4; y++)
+        {
+            sampleY = blockY * 4 + y;
+            if (sampleY >= level->height)
+                sampleY = level->height - 1;
+
+            for (x = 0; x < 4; x++)
+            {
+                sampleX = blockX * 4 + x;
+                if (sampleX >= level->width)
+                    sampleX = level->width - 1;
+
+                pixels[y * 4 + x] = level->pixels[sampleY * level->width + sampleX];
+            }
+        }
+
+        EncodeBlock(m_encodeFormat, pixels, &level->blocks[(blockY * level->blocksX + blockX) * blockSize]);
+    }
+
+    return;
+}
+
+// Decodes the levels again and compares them with the pixels they were made from, over the channels the format keeps
+double TextureBakerClass::MeasurePsnr(TextureBakeFormatType format, int firstLevel, int lastLevel)
+{
+    unsigned int decoded[16], original, result;
+    LevelType* level;
+    double error, difference;
+    long long samples;
+    int channelCount, blockSize, i, blockX, blockY, x, y, channel;
+
+    channelCount = (format == TEXTURE_BAKE_BC1) ? 3 : ((format == TEXTURE_BAKE_BC5) ? 2 : 4);
+    blockSize = GetBlockSize(format);
+
+    error = 0.0;
+    samples = 0;
+    for (i = firstLevel; i < lastLevel; i++)
+    {
+        level = &m_levels[i];
+        for (blockY = 0; blockY < level->blocksY; blockY++)
+        {
+            for (blockX = 0; blockX < level->blocksX; blockX++)
+            {
+                DecodeBlock(format, &level->blocks[(blockY * level->blocksX + blockX) * blockSize], decoded);
+
+                for (y = 0; (y < 4) && (blockY * 4 + y < level->height); y++)
+                {
+                    for (x = 0; (x < 4) && (blockX * 4 + x < level->width); x++)
+                    {
+                        original = level->pixels[(blockY * 4 + y) * level->width + blockX * 4 + x];
+                        result = decoded[y * 4 + x];
+
+                        for (channel = 0; channel < channelCount; channel++)
+                        {
+                            difference = (double)((original >> (channel * 8)) & 0xff) - (double)((result >> (channel * 8)) & 0xff);
+                            error += difference * difference;
+                            samples++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A perfect match is shown as 99 dB
+    if ((samples == 0) || (error == 0.0))
+        return 99.0;
+
+    return 10.0 * log10(255.0 * 255.0 / (error / (double)samples));
+}
+
+// A DX10 header so every format, BC7 included, is described the same way
+bool TextureBakerClass::WriteDds(char* filename, TextureBakeFormatType format)
+{
+    static const unsigned int dxgiFormats[] = { DDS_FORMAT_BC1_UNORM, DDS_FORMAT_BC3_UNORM, DDS_FORMAT_BC5_UNORM, DDS_FORMAT_BC7_UNORM };
+    ofstream fout;
+    unsigned int header[DDS_HEADER_SIZE / 4], extension[DDS_DX10_HEADER_SIZE / 4];
+    int i;
+
+    memset(header, 0, sizeof(header));
+    header[0] = DDS_HEADER_SIZE;
+    header[1] = DDS_HEADER_FLAGS;
+    header[2] = m_levels[0].height;
+    header[3] = m_levels[0].width;
+    header[4] = m_levels[0].blocksX * m_levels[0].blocksY * GetBlockSize(format);
+    header[6] = m_levelCount;
+    header[18] = 32;
+    header[19] = DDS_PIXEL_FOURCC;
+    memcpy(&header[20], "DX10", 4);
+    header[26] = DDS_CAPS_TEXTURE | DDS_CAPS_MIPMAP;
+
+    memset(extension, 0, sizeof(extension));
+    extension[0] = dxgiFormats[format];
+    extension[1] = DDS_DIMENSION_TEXTURE2D;
+    extension[3] = 1;
+
+    fout.open(filename, ios::out | ios::binary);
+    if (fout.fail())
+        return false;
+
+    fout.write("DDS ", 4);
+    fout.write((const char*)header, sizeof(header));
+    fout.write((const char*)extension, sizeof(extension));
+
+    for (i = 0; i < m_levelCount; i++)
+        fout.write((const char*)m_levels[i].blocks, m_levels[i].blocksX * m_levels[i].blocksY * GetBlockSize(format));
+
+    if (fout.fail())
+        return false;
+
+    fout.close();
+
+    return true;
+}
+
+void TextureBakerClass::EncodeBlock(TextureBakeFormatType format, const unsigned int* pixels, unsigned char* block)
+{
+    unsigned char values[16];
+    int i;
+
+    switch (format)
+    {
+    case TEXTURE_BAKE_BC1:
+        EncodeBC1(pixels, block);
+        break;
+
+    case TEXTURE_BAKE_BC3:
+        for (i = 0; i < 16; i++)
+            values[i] = (unsigned char)(pixels[i] >> 24);
+        EncodeBC4(values, block);
+        EncodeBC1(pixels, block + 8);
+        break;
+
+    case TEXTURE_BAKE_BC5:
+        for (i = 0; i < 16; i++)
+            values[i] = (unsigned char)pixels[i];
+        EncodeBC4(values, block);
+        for (i = 0; i < 16; i++)
+            values[i] = (unsigned char)(pixels[i] >> 8);
+        EncodeBC4(values, block + 8);
+        break;
+
+    case TEXTURE_BAKE_BC7:
+        EncodeBC7(pixels, block);
+        break;
+    }
+
+    return;
+}
+
+// RGBA8 with red in the low byte, like the pixels that went in
+void TextureBakerClass::DecodeBlock(TextureBakeFormatType format, const unsigned char* block, unsigned int* pixels)
+{
+    unsigned char values[16], second[16];
+    int i;
+
+    switch (format)
+    {
+    case TEXTURE_BAKE_BC1:
+        DecodeBC1(block, pixels);
+        break;
+
+    case TEXTURE_BAKE_BC3:
+        DecodeBC1(block + 8, pixels);
+        DecodeBC4(block, values);
+        for (i = 0; i < 16; i++)
+            pixels[i] = (pixels[i] & 0xffffff) | ((unsigned int)values[i] << 24);
+        break;
+
+    case TEXTURE_BAKE_BC5:
+        DecodeBC4(block, values);
+        DecodeBC4(block + 8, second);
+        for (i = 0; i < 16; i++)
+            pixels[i] = values[i] | ((unsigned int)second[i] << 8) | 0xff000000;
+        break;
+
+    case TEXTURE_BAKE_BC7:
+        DecodeBC7(block, pixels);
+        break;
+    }
+
+    return;
+}
+
+// Endpoints at the ends of the colours' spread along their principal axis, then refitted to the indices they give
+void TextureBakerClass::EncodeBC1(const unsigned int* pixels, unsigned char* block)
+{
+    static const float colorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    Float4Type points[16], mean, axis, endpoint0, endpoint1;
+    unsigned short color0, color1, refit0, refit1, swap;
+    unsigned int indices, refitIndices;
+    float weights[16], error, refitError, projection, low, high;
+    int i;
+
+    for (i = 0; i < 16; i++)
+        points[i] = Float4And(UnpackPixel(pixels[i]), Int4AsFloat(Int4Set(-1, -1, -1, 0)));
+
+    FindAxis(points, 16, mean, axis);
+
+    low = 1e30f;
+    high = -1e30f;
+    for (i = 0; i < 16; i++)
+    {
+        projection = Dot(Float4Sub(points[i], mean), axis);
+        if (projection < low)
+            low = projection;
+        if (projection > high)
+            high = projection;
+    }
+
+    color0 = Pack565(Float4Add(mean, Float4Mul(axis, Float4Splat(high))));
+    color1 = Pack565(Float4Add(mean, Float4Mul(axis, Float4Splat(low))));
+
+    // Four colour mode needs the first colour to be the larger
+    if (color0 < color1)
+    {
+        swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+
+    error = FitBC1Indices(points, color0, color1, indices);
+
+    for (i = 0; i < 16; i++)
+        weights[i] = colorWeights[(indices >> (i * 2)) & 3];
+
+    if ((color0 != color1) && SolveEndpoints(points, weights, endpoint0, endpoint1))
+    {
+        refit0 = Pack565(endpoint0);
+        refit1 = Pack565(endpoint1);
+        if (refit0 < refit1)
+        {
+            swap = refit0;
+            refit0 = refit1;
+            refit1 = swap;
+        }
+
+        refitError = FitBC1Indices(points, refit0, refit1, refitIndices);
+        if (refitError < error)
+        {
+            color0 = refit0;
+            color1 = refit1;
+            indices = refitIndices;
+        }
+    }
+
+    memcpy(&block[0], &color0, 2);
+    memcpy(&block[2], &color1, 2);
+    memcpy(&block[4], &indices, 4);
+
+    return;
+}
+
+// Eight interpolated values between the lowest and the highest
+void TextureBakerClass::EncodeBC4(const unsigned char* values, unsigned char* block)
+{
+    int palette[8], low, high, distance, best, bestIndex, i, j, position;
+
+    low = 255;
+    high = 0;
+    for (i = 0; i < 16; i++)
+    {
+        if (values[i] < low)
+            low = values[i];
+        if (values[i] > high)
+            high = values[i];
+    }
+
+    memset(block, 0, 8);
+    block[0] = (unsigned char)high;
+    block[1] = (unsigned char)low;
+
+    // A flat block is all the first value
+    if (high == low)
+        return;
+
+    palette[0] = high;
+    palette[1] = low;
+    for (i = 2; i < 8; i++)
+        palette[i] = ((8 - i) * high + (i - 1) * low + 3) / 7;
+
+    position = 16;
+    for (i = 0; i < 16; i++)
+    {
+        best = 256;
+        bestIndex = 0;
+        for (j = 0; j < 8; j++)
+        {
+            distance = abs(values[i] - palette[j]);
+            if (distance < best)
+            {
+                best = distance;
+                bestIndex = j;
+            }
+        }
+
+        WriteBits(block, position, bestIndex, 3);
+    }
+
+    return;
+}
+
+// Mode 6, one subset of RGBA with 7 bit endpoints, a low bit each and 4 bit indices
+void TextureBakerClass::EncodeBC7(const unsigned int* pixels, unsigned char* block)
+{
+    Float4Type points[16], mean, axis, fitted0, fitted1;
+    float weights[16], error, refitError, projection, low, high;
+    int endpoint0[4], endpoint1[4], refit0[4], refit1[4], indices[16], refitIndices[16], swap, i, position;
+
+    for (i = 0; i < 16; i++)
+        points[i] = UnpackPixel(pixels[i]);
+
+    FindAxis(points, 16, mean, axis);
+
+    low = 1e30f;
+    high = -1e30f;
+    for (i = 0; i < 16; i++)
+    {
+        projection = Dot(Float4Sub(points[i], mean), axis);
+        if (projection < low)
+            low = projection;
+        if (projection > high)
+            high = projection;
+    }
+
+    QuantizeBC7Endpoint(Float4Add(mean, Float4Mul(axis, Float4Splat(low))), endpoint0);
+    QuantizeBC7Endpoint(Float4Add(mean, Float4Mul(axis, Float4Splat(high))), endpoint1);
+
+    error = FitBC7Indices(points, endpoint0, endpoint1, indices);
+
+    for (i = 0; i < 16; i++)
+        weights[i] = 1.0f - g_bc7Weights[indices[i]] / 64.0f;
+
+    if (SolveEndpoints(points, weights, fitted0, fitted1))
+    {
+        QuantizeBC7Endpoint(fitted0, refit0);
+        QuantizeBC7Endpoint(fitted1, refit1);
+
+        refitError = FitBC7Indices(points, refit0, refit1, refitIndices);
+        if (refitError < error)
+        {
+            memcpy(endpoint0, refit0, sizeof(endpoint0));
+            memcpy(endpoint1, refit1, sizeof(endpoint1));
+            memcpy(indices, refitIndices, sizeof(indices));
+        }
+    }
+
+    // The first index is stored without its top bit, so it has to be below 8
+    if (indices[0] >= 8)
+    {
+        for (i = 0; i < 4; i++)
+        {
+            swap = endpoint0[i];
+            endpoint0[i] = endpoint1[i];
+            endpoint1[i] = swap;
+        }
+
+        for (i = 0; i < 16; i++)
+            indices[i] = 15 - indices[i];
+    }
+
+    memset(block, 0, 16);
+    position = 0;
+    WriteBits(block, position, 1 << 6, 7);
+
+    for (i = 0; i < 4; i++)
+    {
+        WriteBits(block, position, endpoint0[i] >> 1, 7);
+        WriteBits(block, position, endpoint1[i] >> 1, 7);
+    }
+
+    WriteBits(block, position, endpoint0[0] & 1, 1);
+    WriteBits(block, position, endpoint1[0] & 1, 1);
+
+    WriteBits(block, position, indices[0], 3);
+    for (i = 1; i < 16; i++)
+        WriteBits(block, position, indices[i], 4);
+
+    return;
+}
+
+void TextureBakerClass::DecodeBC1(const unsigned char* block, unsigned int* pixels)
+{
+    unsigned short color0, color1;
+    unsigned int indices, palette[4];
+    int endpoints[2][3], i, channel, value[2];
+
+    memcpy(&color0, &block[0], 2);
+    memcpy(&color1, &block[2], 2);
+    memcpy(&indices, &block[4], 4);
+
+    for (i = 0; i < 2; i++)
+    {
+        value[i] = (i == 0) ? color0 : color1;
+        endpoints[i][0] = ((value[i] >> 11) << 3) | ((value[i] >> 11) >> 2);
+        endpoints[i][1] = (((value[i] >> 5) & 63) << 2) | (((value[i] >> 5) & 63) >> 4);
+        endpoints[i][2] = ((value[i] & 31) << 3) | ((value[i] & 31) >> 2);
+    }
+
+    palette[0] = endpoints[0][0] | (endpoints[0][1] << 8) | (endpoints[0][2] << 16) | 0xff000000;
+    palette[1] = endpoints[1][0] | (endpoints[1][1] << 8) | (endpoints[1][2] << 16) | 0xff000000;
+    palette[2] = 0xff000000;
+    palette[3] = (color0 > color1) ? 0xff000000 : 0;
+
+    for (channel = 0; channel < 3; channel++)
+    {
+        if (color0 > color1)
+        {
+            palette[2] |= ((2 * endpoints[0][channel] + endpoints[1][channel]) / 3) << (channel * 8);
+            palette[3] |= ((endpoints[0][channel] + 2 * endpoints[1][channel]) / 3) << (channel * 8);
+        }
+        else
+        {
+            palette[2] |= ((endpoints[0][channel] + endpoints[1][channel]) / 2) << (channel * 8);
+        }
+    }
+
+    for (i = 0; i < 16; i++)
+        pixels[i] = palette[(indices >> (i * 2)) & 3];
+
+    return;
+}
+
+void TextureBakerClass::DecodeBC4(const unsigned char* block, unsigned char* values)
+{
+    int palette[8], i, position;
+
+    palette[0] = block[0];
+    palette[1] = block[1];
+
+    if (palette[0] > palette[1])
+    {
+        for (i = 2; i < 8; i++)
+            palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1] + 3) / 7;
+    }
+    else
+    {
+        for (i = 2; i < 6; i++)
+            palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1] + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    position = 16;
+    for (i = 0; i < 16; i++)
+        values[i] = (unsigned char)palette[ReadBits(block, position, 3)];
+
+    return;
+}
+
+// Only mode 6 is read, which is all EncodeBC7 writes
+void TextureBakerClass::DecodeBC7(const unsigned char* block, unsigned int* pixels)
+{
+    int endpoint0[4], endpoint1[4], index, bit0, bit1, i, channel, position;
+    unsigned int pixel;
+
+    position = 0;
+    if (ReadBits(block, position, 7) != (1 << 6))
+    {
+        memset(pixels, 0, 16 * sizeof(unsigned int));
+        return;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        endpoint0[i] = ReadBits(block, position, 7) << 1;
+        endpoint1[i] = ReadBits(block, position, 7) << 1;
+    }
+
+    bit0 = ReadBits(block, position, 1);
+    bit1 = ReadBits(block, position, 1);
+    for (i = 0; i < 4; i++)
+    {
+        endpoint0[i] |= bit0;
+        endpoint1[i] |= bit1;
+    }
+
+    for (i = 0; i < 16; i++)
+    {
+        index = ReadBits(block, position, (i == 0) ? 3 : 4);
+
+        pixel = 0;
+        for (channel = 0; channel < 4; channel++)
+            pixel |= (unsigned int)(((64 - g_bc7Weights[index]) * endpoint0[channel] + g_bc7Weights[index] * endpoint1[channel] + 32) >> 6) << (channel * 8);
+
+        pixels[i] = pixel;
+    }
+
+    return;
+}
+
+// The mean and the direction the points spread furthest in, by power iteration on their covariance
+void TextureBakerClass::FindAxis(const Float4Type* points, int count, Float4Type& mean, Float4Type& axis)
+{
+    Float4Type rows[4], difference, next;
+    float components[4], largest, length;
+    int i, j;
+
+    mean = Float4Zero();
+    for (i = 0; i < count; i++)
+        mean = Float4Add(mean, points[i]);
+    mean = Float4Mul(mean, Float4Splat(1.0f / count));
+
+    for (j = 0; j < 4; j++)
+        rows[j] = Float4Zero();
+
+    for (i = 0; i < count; i++)
+    {
+        difference = Float4Sub(points[i], mean);
+        rows[0] = Float4Add(rows[0], Float4Mul(difference, Float4Swizzle<0, 0, 0, 0>(difference)));
+        rows[1] = Float4Add(rows[1], Float4Mul(difference, Float4Swizzle<1, 1, 1, 1>(difference)));
+        rows[2] = Float4Add(rows[2], Float4Mul(difference, Float4Swizzle<2, 2, 2, 2>(difference)));
+        rows[3] = Float4Add(rows[3], Float4Mul(difference, Float4Swizzle<3, 3, 3, 3>(difference)));
+    }
+
+    axis = Float4Splat(1.0f);
+    for (i = 0; i < 8; i++)
+    {
+        Float4Store(components, axis);
+        next = Float4Zero();
+        for (j = 0; j < 4; j++)
+            next = Float4Add(next, Float4Mul(rows[j], Float4Splat(components[j])));
+
+        // Scaled by the largest component so it neither overflows nor vanishes
+        Float4Store(components, next);
+        largest = 0.0f;
+        for (j = 0; j < 4; j++)
+        {
+            if (fabsf(components[j]) > largest)
+                largest = fabsf(components[j]);
+        }
+
+        if (largest == 0.0f)
+        {
+            axis = Float4Zero();
+            return;
+        }
+
+        axis = Float4Mul(next, Float4Splat(1.0f / largest));
+    }
+
+    length = sqrtf(Dot(axis, axis));
+    axis = Float4Mul(axis, Float4Splat(1.0f / length));
+
+    return;
+}
+
+int TextureBakerClass::GetBlockSize(TextureBakeFormatType format)
+{
+    return (format == TEXTURE_BAKE_BC1) ? 8 : 16;
+}
+
+float TextureBakerClass::KaiserWindow(float offset)
+{
+    float ratio, term, sum, denominator, x;
+    int k;
+
+    ratio = offset / TEXTURE_BAKE_KAISER_RADIUS;
+    if (fabsf(ratio) >= 1.0f)
+        return 0.0f;
+
+    // Modified Bessel function of the first kind, by its series, for the window and its normalization
+    x = TEXTURE_BAKE_KAISER_ALPHA * sqrtf(1.0f - ratio * ratio);
+    sum = 1.0f;
+    term = 1.0f;
+    for (k = 1; k < 20; k++)
+    {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+
+    denominator = 1.0f;
+    term = 1.0f;
+    for (k = 1; k < 20; k++)
+    {
+        term *= (TEXTURE_BAKE_KAISER_ALPHA / (2.0f * k)) * (TEXTURE_BAKE_KAISER_ALPHA / (2.0f * k));
+        denominator += term;
+    }
+
+    return sum / denominator;
+}
+
+float TextureBakerClass::SrgbToLinear(float value)
+{
+    if (value <= 0.04045f)
+        return value / 12.92f;
+
+    return powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float TextureBakerClass::LinearToSrgb(float value)
+{
+    if (value <= 0.0031308f)
+        return value * 12.92f;
+
+    return 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ddsfileclass.h"
+#include "mathclass.h"
+#include "workstealingpoolclass.h"
+using namespace std;
+
+const int TEXTURE_BAKE_MAX_PATH = 260;
+const int TEXTURE_BAKE_CAPACITY = 16;
+const int TEXTURE_BAKE_KAISER_TAPS = 6;
+const float TEXTURE_BAKE_KAISER_ALPHA = 4.0f;
+const float TEXTURE_BAKE_KAISER_RADIUS = 1.5f;
+
+enum TextureBakeFormatType
+{
+    TEXTURE_BAKE_BC1,
+    TEXTURE_BAKE_BC3,
+    TEXTURE_BAKE_BC5,
+    TEXTURE_BAKE_BC7
+};
+
+enum TextureBakeFilterType
+{
+    TEXTURE_BAKE_FILTER_BOX,
+    TEXTURE_BAKE_FILTER_KAISER
+};
+
+// Bakes source images into block compressed DDS files with full mip chains,
+// ready for DdsFileClass. The manifest sets the mip filter, whether colour is
+// filtered in linear light and the thread count, then lists the textures:
+//   filter kaiser
+//   srgb 1
+//   threads 0
+//   texture bc7 ../Engine/data/seafloor.dds ../Engine/data/seafloor-bc7.dds
+// Mips are filtered in floating point from the level above, converting sRGB
+// colour to linear and back so they don't darken. BC1 and BC3 colour is fitted
+// along the principal axis and refined by least squares, BC3 alpha and BC5 use
+// BC4 blocks, and BC7 uses mode 6. Rows of blocks are spread over a thread pool
+// and the fitting works on whole pixels in Float4Type lanes. Encode speed and
+// the PSNR of each result against its uncompressed mips go to texture-bake.txt.
+class TextureBakerClass
+{
+private:
+    struct TextureType
+    {
+        char source[TEXTURE_BAKE_MAX_PATH];
+        char output[TEXTURE_BAKE_MAX_PATH];
+        TextureBakeFormatType format;
+        bool srgb;
+    };
+
+    struct LevelType
+    {
+        int width, height;
+        float* color;
+        unsigned int* pixels;
+        unsigned char* blocks;
+        int blocksX, blocksY;
+        int firstRow;
+    };
+
+public:
+    TextureBakerClass();
+    TextureBakerClass(const TextureBakerClass&);
+    ~TextureBakerClass();
+
+    bool Initialize(char*);
+    void Shutdown();
+    bool Bake();
+
+    int GetTextureCount();
+
+    static bool BakeTextures(char*);
+
+private:
+    bool ReadManifest(char*);
+    bool AddTexture(char*, char*, char*);
+    bool BakeTexture(TextureType&, ofstream&);
+    bool LoadSource(char*, bool);
+    bool BuildMips(bool);
+    void ReleaseLevels();
+    bool Downsample(const LevelType&, LevelType&);
+    bool Encode(TextureBakeFormatType);
+    void EncodeRow(int);
+    double MeasurePsnr(TextureBakeFormatType, int, int);
+    bool WriteDds(char*, TextureBakeFormatType);
+
+    static void EncodeRowTask(int, int, void*);
+    static void EncodeBlock(TextureBakeFormatType, const unsigned int*, unsigned char*);
+    static void DecodeBlock(TextureBakeFormatType, const unsigned char*, unsigned int*);
+    static void EncodeBC1(const unsigned int*, unsigned char*);
+    static void EncodeBC4(const unsigned char*, unsigned char*);
+    static void EncodeBC7(const unsigned int*, unsigned char*);
+    static void DecodeBC1(const unsigned char*, unsigned int*);
+    static void DecodeBC4(const unsigned char*, unsigned char*);
+    static void DecodeBC7(const unsigned char*, unsigned int*);
+    static void FindAxis(const Float4Type*, int, Float4Type&, Float4Type&);
+    static int GetBlockSize(TextureBakeFormatType);
+    static float KaiserWindow(float);
+    static float SrgbToLinear(float);
+    static float LinearToSrgb(float);
+
+private:
+    TextureBakeFilterType m_filter;
+    bool m_srgb;
+    int m_threadCount;
+
+    TextureType* m_textures;
+    int m_textureCount, m_textureCapacity;
+
+    float m_kaiserWeights[TEXTURE_BAKE_KAISER_TAPS];
+    float m_srgbToLinear[256];
+
+    LevelType m_levels[DDS_MAX_MIPS];
+    int m_levelCount;
+    int m_rowCount;
+    TextureBakeFormatType m_encodeFormat;
+
+    WorkStealingPoolClass* m_pool;
+};
\ No newline at end of file
@@ -3,6 +3,8 @@
 TextureClass::TextureClass()
 {
 	m_texture = 0;
+	m_Streamer = 0;
+	m_streamHandle = -1;
 }
 
 TextureClass::TextureClass(const TextureClass& other)
@@ -15,15 +17,30 @@ TextureClass::~TextureClass()
 
 }
 
-bool TextureClass::Initialize(ID3D11Device* device, WCHAR* filename)
+bool TextureClass::Initialize(RenderDeviceClass* device, wchar_t* filename)
 {
-	HRESULT result;
-
     // Load texture in
-	result = D3DX11CreateShaderResourceViewFromFile(device, filename, NULL, NULL, &m_texture, NULL);
-	if (FAILED(result))
+	m_texture = device->LoadTexture(filename);
+	if (!m_texture)
+		return false;
+
+	return true;
+}
+
+// The streamer owns the texture and swaps in finer mips as they are asked for
+bool TextureClass::Initialize(TextureStreamerClass* streamer, wchar_t* filename)
+{
+	char path[260];
+
+	if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+		return false;
+
+	m_streamHandle = streamer->Register(path);
+	if (m_streamHandle < 0)
 		return false;
 
+	m_Streamer = streamer;
+
 	return true;
 }
 
@@ -34,10 +51,25 @@ void TextureClass::Shutdown()
 		m_texture->Release();
 		m_texture = 0;
 	}
+
+	m_Streamer = 0;
+	m_streamHandle = -1;
 	return;
 }
 
-ID3D11ShaderResourceView* TextureClass::GetTexture()
+RenderTexture* TextureClass::GetTexture()
 {
+	if (m_Streamer)
+		return m_Streamer->GetTexture(m_streamHandle);
+
 	return m_texture;
+}
+
+// How many pixels across the texture is drawn this frame, only streamed textures use it
+void TextureClass::RequestSize(float pixels)
+{
+	if (m_Streamer)
+		m_Streamer->RequestSize(m_streamHandle, pixels);
+
+	return;
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <d3d11.h>
-#include <d3dx11tex.h>
+#include <stdlib.h>
+#include "renderdeviceclass.h"
+#include "texturestreamerclass.h"
 
 class TextureClass
 {
@@ -10,11 +11,15 @@ public:
 	TextureClass(const TextureClass&);
 	~TextureClass();
 
-	bool Initialize(ID3D11Device*, WCHAR*);
+	bool Initialize(RenderDeviceClass*, wchar_t*);
+	bool Initialize(TextureStreamerClass*, wchar_t*);
 	void Shutdown();
 
-	ID3D11ShaderResourceView* GetTexture();
+	RenderTexture* GetTexture();
+	void RequestSize(float);
 
 private:
-	ID3D11ShaderResourceView* m_texture;
+	RenderTexture* m_texture;
+	TextureStreamerClass* m_Streamer;
+	int m_streamHandle;
 };
\ No newline at end of file
@@ -0,0 +1,805 @@
+#include "texturestreamerclass.h"
+#include "nullrenderdeviceclass.h"
+#include <stdio.h>
+#include <fstream>
+using namespace std;
+
+// How many frames RunTests gives the worker to finish its loads
+const int TEXTURE_STREAM_TEST_FRAMES = 100000;
+
+static void Check(ofstream& fout, const char* name, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << name << endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+// Asks for the same on screen sizes every frame until nothing is queued or
+// loading, so the checks see where the streamer settles and not where the
+// worker happens to be. The loads and evictions along the way are added up.
+static bool SettleTestFrames(TextureStreamerClass& streamer, const int* handles, const float* sizes, int count, int& loads, int& evictions)
+{
+    TextureStreamStatsType stats;
+    int frame, i;
+
+    loads = 0;
+    evictions = 0;
+
+    for (frame = 0; frame < TEXTURE_STREAM_TEST_FRAMES; frame++)
+    {
+        for (i = 0; i < count; i++)
+            streamer.RequestSize(handles[i], sizes[i]);
+
+        streamer.Update();
+
+        stats = streamer.GetStats();
+        loads += stats.loadsCompleted;
+        evictions += stats.evictions;
+        if (stats.pendingLoads == 0)
+            return true;
+
+        std::this_thread::yield();
+    }
+
+    return false;
+}
+
+TextureStreamerClass::TextureStreamerClass()
+{
+    m_device = 0;
+    m_budget = 0;
+    m_textures = 0;
+    m_textureCount = 0;
+    m_frame = 0;
+    m_residentBytes = 0;
+    m_pendingBytes = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_queueCount = 0;
+    m_quit = false;
+}
+
+TextureStreamerClass::TextureStreamerClass(const TextureStreamerClass& other)
+{
+
+}
+
+TextureStreamerClass::~TextureStreamerClass()
+{
+
+}
+
+bool TextureStreamerClass::Initialize(RenderDeviceClass* device, unsigned int budget)
+{
+    m_device = device;
+    m_budget = budget;
+
+    m_textures = new TextureType[TEXTURE_STREAM_CAPACITY];
+    if (!m_textures)
+        return false;
+
+    m_textureCount = 0;
+    m_frame = 0;
+    m_residentBytes = 0;
+    m_pendingBytes = 0;
+    m_queueCount = 0;
+    m_quit = false;
+
+    m_thread = std::thread(&TextureStreamerClass::WorkerThread, this);
+
+    return true;
+}
+
+void TextureStreamerClass::Shutdown()
+{
+    int i;
+
+    // Let the worker finish the copy it is on and leave its loop
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_queueCondition.notify_all();
+
+        m_thread.join();
+    }
+
+    if (m_textures)
+    {
+        for (i = 0; i < m_textureCount; i++)
+        {
+            ReleaseLoad(m_textures[i]);
+
+            if (m_textures[i].texture)
+            {
+                m_textures[i].texture->Release();
+                m_textures[i].texture = 0;
+            }
+
+            m_textures[i].file->Shutdown();
+            delete m_textures[i].file;
+            m_textures[i].file = 0;
+        }
+
+        delete[] m_textures;
+        m_textures = 0;
+    }
+
+    m_textureCount = 0;
+    m_queueCount = 0;
+    m_residentBytes = 0;
+    m_pendingBytes = 0;
+
+    return;
+}
+
+// The file stays mapped for as long as the streamer runs, only its mip tail is put in a texture
+int TextureStreamerClass::Register(char* filename)
+{
+    TextureType* texture;
+    const DdsSubresourceType* levels;
+    int index, mip, slice;
+
+    if (m_textureCount == TEXTURE_STREAM_CAPACITY)
+        return -1;
+
+    index = m_textureCount;
+    texture = &m_textures[index];
+
+    texture->file = new DdsFileClass;
+    if (!texture->file)
+        return -1;
+
+    if (!texture->file->Initialize(filename))
+    {
+        texture->file->Shutdown();
+        delete texture->file;
+        texture->file = 0;
+        return -1;
+    }
+
+    texture->texture = 0;
+    texture->mipCount = texture->file->GetMipCount();
+    texture->lastUsedFrame = -1;
+    texture->loadState = LOAD_NONE;
+    texture->loadMip = 0;
+    texture->loadPriority = 0;
+    texture->loadData = 0;
+    texture->loadSubresources = 0;
+
+    // The first level no bigger than the tail size, or the last one
+    texture->tailMip = 0;
+    while ((texture->tailMip + 1 < texture->mipCount) &&
+        (((texture->file->GetWidth() >> texture->tailMip) > TEXTURE_STREAM_TAIL_SIZE) || ((texture->file->GetHeight() >> texture->tailMip) > TEXTURE_STREAM_TAIL_SIZE)))
+        texture->tailMip++;
+
+    // Bytes from each level to the end of the chain, over every slice
+    levels = texture->file->GetSubresources();
+    texture->mipBytes[texture->mipCount] = 0;
+    for (mip = texture->mipCount - 1; mip >= 0; mip--)
+    {
+        texture->mipBytes[mip] = texture->mipBytes[mip + 1];
+        for (slice = 0; slice < texture->file->GetArraySize(); slice++)
+            texture->mipBytes[mip] += levels[slice * texture->mipCount + mip].slicePitch;
+    }
+
+    texture->residentMip = texture->mipCount;
+    texture->requestedMip = texture->tailMip;
+
+    if (!SetResidentMip(index, texture->tailMip))
+    {
+        texture->file->Shutdown();
+        delete texture->file;
+        texture->file = 0;
+        return -1;
+    }
+
+    m_textureCount++;
+
+    return index;
+}
+
+// Several objects can share a texture, the finest level any of them wants is kept
+void TextureStreamerClass::RequestMip(int handle, int mip)
+{
+    TextureType* texture;
+
+    if ((handle < 0) || (handle >= m_textureCount))
+        return;
+
+    texture = &m_textures[handle];
+
+    if (mip < 0)
+        mip = 0;
+    if (mip > texture->tailMip)
+        mip = texture->tailMip;
+
+    if ((texture->lastUsedFrame != m_frame) || (mip < texture->requestedMip))
+        texture->requestedMip = mip;
+
+    texture->lastUsedFrame = m_frame;
+
+    return;
+}
+
+// The level whose texels are about a pixel each when the texture spans this many pixels on screen
+void TextureStreamerClass::RequestSize(int handle, float pixels)
+{
+    TextureType* texture;
+    float texels;
+    int mip;
+
+    if ((handle < 0) || (handle >= m_textureCount))
+        return;
+
+    texture = &m_textures[handle];
+
+    texels = (float)texture->file->GetWidth();
+    if (texture->file->GetHeight() > texture->file->GetWidth())
+        texels = (float)texture->file->GetHeight();
+
+    mip = 0;
+    if (pixels < texels)
+        mip = (pixels > 0.0f) ? (int)floorf(log2f(texels / pixels)) : texture->tailMip;
+
+    RequestMip(handle, mip);
+
+    return;
+}
+
+// Called once a frame after the requests, finished loads are swapped in and new ones queued
+void TextureStreamerClass::Update()
+{
+    TextureType* texture;
+    int i;
+
+    PROFILE_ZONE("Texture streaming");
+
+    m_stats.loadsCompleted = 0;
+    m_stats.evictions = 0;
+
+    FinishLoads();
+
+    // What this frame would hold if the budget were no limit
+    m_stats.requestedBytes = 0;
+    for (i = 0; i < m_textureCount; i++)
+    {
+        texture = &m_textures[i];
+        m_stats.requestedBytes += texture->mipBytes[GetWantedMip(*texture)];
+    }
+
+    // The budget may have been lowered, so give memory back before asking for more
+    MakeRoom(0, true);
+
+    QueueLoads();
+
+    m_stats.residentBytes = m_residentBytes;
+    m_stats.budgetBytes = m_budget;
+    m_stats.pendingLoads = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (i = 0; i < m_textureCount; i++)
+        {
+            if (m_textures[i].loadState != LOAD_NONE)
+                m_stats.pendingLoads++;
+        }
+    }
+
+    m_frame++;
+
+    return;
+}
+
+RenderTexture* TextureStreamerClass::GetTexture(int handle)
+{
+    if ((handle < 0) || (handle >= m_textureCount))
+        return 0;
+
+    return m_textures[handle].texture;
+}
+
+int TextureStreamerClass::GetResidentMip(int handle)
+{
+    if ((handle < 0) || (handle >= m_textureCount))
+        return -1;
+
+    return m_textures[handle].residentMip;
+}
+
+// Takes effect on the next Update
+void TextureStreamerClass::SetBudget(unsigned int budget)
+{
+    m_budget = budget;
+    return;
+}
+
+TextureStreamStatsType TextureStreamerClass::GetStats()
+{
+    return m_stats;
+}
+
+// Streams three copies of the baked seafloor texture on the null device and
+// checks which mips are resident as the requests and the budget change
+bool TextureStreamerClass::RunTests(char* filename)
+{
+    char textureName[] = "../Engine/data/seafloor-bc7.dds";
+    NullRenderDeviceClass* device;
+    TextureStreamerClass* streamer;
+    DdsFileClass file;
+    const DdsSubresourceType* levels;
+    TextureStreamStatsType stats;
+    ofstream fout;
+    unsigned int chainBytes[DDS_MAX_MIPS + 1];
+    unsigned int budget;
+    int handles[3];
+    float sizes[3];
+    int width, mipCount, tailMip, loads, evictions, failures, mip, i;
+    bool result, settled, passed;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    failures = 0;
+
+    // Bytes from each level to the end of the chain, and the tail a texture starts with
+    result = file.Initialize(textureName);
+    width = 0;
+    mipCount = 0;
+    tailMip = 0;
+    if (result)
+    {
+        width = file.GetWidth();
+        mipCount = file.GetMipCount();
+        levels = file.GetSubresources();
+
+        chainBytes[mipCount] = 0;
+        for (mip = mipCount - 1; mip >= 0; mip--)
+            chainBytes[mip] = chainBytes[mip + 1] + levels[mip].slicePitch;
+
+        while ((tailMip + 1 < mipCount) && (((file.GetWidth() >> tailMip) > TEXTURE_STREAM_TAIL_SIZE) || ((file.GetHeight() >> tailMip) > TEXTURE_STREAM_TAIL_SIZE)))
+            tailMip++;
+    }
+    file.Shutdown();
+
+    // The checks below need at least two levels above the tail
+    Check(fout, "test texture has mips above its tail", result && (tailMip >= 2), failures);
+    if (failures > 0)
+    {
+        fout.close();
+        printf("%d texture streaming test failures, results in %s\n", failures, filename);
+        return false;
+    }
+
+    device = new NullRenderDeviceClass;
+    if (!device)
+        return false;
+
+    streamer = new TextureStreamerClass;
+    if (!streamer)
+        return false;
+
+    result = device->Initialize(256, 256, 1000.0f, 0.1f);
+    result = result && streamer->Initialize(device, TEXTURE_STREAM_DEFAULT_BUDGET);
+    Check(fout, "streamer initialized on the null device", result, failures);
+
+    passed = result;
+    for (i = 0; i < 3; i++)
+    {
+        handles[i] = result ? streamer->Register(textureName) : -1;
+        passed = passed && (handles[i] >= 0);
+    }
+    Check(fout, "textures registered", passed, failures);
+
+    if (passed)
+    {
+        // Nothing asked for yet, so only the tails are resident
+        streamer->Update();
+        stats = streamer->GetStats();
+        passed = (stats.residentBytes == 3 * chainBytes[tailMip]);
+        for (i = 0; i < 3; i++)
+            passed = passed && (streamer->GetResidentMip(handles[i]) == tailMip) && streamer->GetTexture(handles[i]);
+        Check(fout, "textures start with their tail", passed, failures);
+
+        // Under the default budget a full size request loads the whole chain on the worker
+        sizes[0] = (float)width;
+        settled = SettleTestFrames(*streamer, &handles[0], sizes, 1, loads, evictions);
+        stats = streamer->GetStats();
+        Check(fout, "full size request loads the top mip", settled && (loads == 1) && (streamer->GetResidentMip(handles[0]) == 0) &&
+            (stats.residentBytes == chainBytes[0] + 2 * chainBytes[tailMip]), failures);
+
+        // Room for one texture down to mip 1 next to the tails. The unused texture is
+        // evicted to its tail and the request that doesn't fit settles for mip 1.
+        budget = chainBytes[1] + 2 * chainBytes[tailMip];
+        streamer->SetBudget(budget);
+        settled = SettleTestFrames(*streamer, &handles[1], sizes, 1, loads, evictions);
+        stats = streamer->GetStats();
+        Check(fout, "unused texture evicted for one in use", settled && (evictions > 0) && (streamer->GetResidentMip(handles[0]) == tailMip), failures);
+        Check(fout, "load that doesn't fit settles for a coarser mip", settled && (streamer->GetResidentMip(handles[1]) == 1) &&
+            (stats.residentBytes <= budget), failures);
+
+        // Both in use, the one holding the budget keeps it and the other gets nothing
+        sizes[1] = sizes[0];
+        settled = SettleTestFrames(*streamer, &handles[0], sizes, 2, loads, evictions);
+        stats = streamer->GetStats();
+        Check(fout, "texture in use not evicted for another", settled && (loads == 0) && (evictions == 0) && (streamer->GetResidentMip(handles[0]) == tailMip) &&
+            (streamer->GetResidentMip(handles[1]) == 1) && (stats.residentBytes <= budget), failures);
+
+        // A budget lowered under what is resident takes levels off textures in use
+        budget = 3 * chainBytes[tailMip];
+        streamer->SetBudget(budget);
+        settled = SettleTestFrames(*streamer, &handles[1], sizes, 1, loads, evictions);
+        stats = streamer->GetStats();
+        Check(fout, "lowered budget drops levels in use", settled && (evictions == tailMip - 1) && (streamer->GetResidentMip(handles[1]) == tailMip) &&
+            (stats.residentBytes <= budget), failures);
+
+        // Screen sizes pick the level with about a texel a pixel, never finer than the top or coarser than the tail
+        streamer->SetBudget(TEXTURE_STREAM_DEFAULT_BUDGET);
+        sizes[0] = (float)(width >> 2);
+        sizes[1] = (float)(width * 4);
+        sizes[2] = 1.0f;
+        settled = SettleTestFrames(*streamer, handles, sizes, 3, loads, evictions);
+        stats = streamer->GetStats();
+        Check(fout, "screen size picks the mip", settled && (streamer->GetResidentMip(handles[0]) == 2) && (streamer->GetResidentMip(handles[1]) == 0) &&
+            (streamer->GetResidentMip(handles[2]) == tailMip) && (stats.residentBytes == chainBytes[2] + chainBytes[0] + chainBytes[tailMip]), failures);
+    }
+
+    streamer->Shutdown();
+    delete streamer;
+    streamer = 0;
+
+    device->Shutdown();
+    delete device;
+    device = 0;
+
+    fout << endl << failures << " failures" << endl;
+    fout.close();
+
+    printf("%d texture streaming test failures, results in %s\n", failures, filename);
+
+    return (failures == 0);
+}
+
+// A texture holding every level from the given one down, the top of it as its first level
+RenderTexture* TextureStreamerClass::CreateTexture(TextureType& texture, int mip, const RenderSubresourceType* subresources)
+{
+    RenderTextureDescType desc;
+
+    desc.format = texture.file->GetFormat();
+    desc.width = texture.file->GetWidth() >> mip;
+    desc.height = texture.file->GetHeight() >> mip;
+    desc.mipCount = texture.mipCount - mip;
+    desc.arraySize = texture.file->GetArraySize();
+    desc.cubemap = texture.file->IsCubemap();
+    desc.hasAlpha = texture.file->HasAlpha();
+    desc.subresources = subresources;
+
+    if (desc.width < 1)
+        desc.width = 1;
+    if (desc.height < 1)
+        desc.height = 1;
+
+    return m_device->CreateTexture(desc);
+}
+
+// Recreates the texture straight from the mapped file, used for the tail and when dropping levels
+bool TextureStreamerClass::SetResidentMip(int handle, int mip)
+{
+    TextureType* texture;
+    RenderSubresourceType* subresources;
+    const DdsSubresourceType* levels;
+    RenderTexture* created;
+    int count, slice, level;
+
+    texture = &m_textures[handle];
+    levels = texture->file->GetSubresources();
+
+    count = (texture->mipCount - mip) * texture->file->GetArraySize();
+    subresources = new RenderSubresourceType[count];
+    if (!subresources)
+        return false;
+
+    for (slice = 0; slice < texture->file->GetArraySize(); slice++)
+    {
+        for (level = mip; level < texture->mipCount; level++)
+        {
+            subresources[slice * (texture->mipCount - mip) + level - mip].data = levels[slice * texture->mipCount + level].data;
+            subresources[slice * (texture->mipCount - mip) + level - mip].rowPitch = levels[slice * texture->mipCount + level].rowPitch;
+            subresources[slice * (texture->mipCount - mip) + level - mip].slicePitch = levels[slice * texture->mipCount + level].slicePitch;
+        }
+    }
+
+    created = CreateTexture(*texture, mip, subresources);
+
+    delete[] subresources;
+    subresources = 0;
+
+    if (!created)
+        return false;
+
+    if (texture->texture)
+        texture->texture->Release();
+    texture->texture = created;
+
+    m_residentBytes = m_residentBytes - texture->mipBytes[texture->residentMip] + texture->mipBytes[mip];
+    texture->residentMip = mip;
+
+    return true;
+}
+
+// Textures not asked for this frame only need their tail
+int TextureStreamerClass::GetWantedMip(TextureType& texture)
+{
+    if (texture.lastUsedFrame != m_frame)
+        return texture.tailMip;
+
+    return texture.requestedMip;
+}
+
+// Drops the least recently used textures that hold more than they want until the bytes fit. Forced,
+// it goes on to take single levels off textures that are in use, for when the budget is already exceeded
+bool TextureStreamerClass::MakeRoom(unsigned int bytes, bool force)
+{
+    TextureType* texture;
+    unsigned int spareBytes;
+    int i, victim, mip;
+
+    if (m_residentBytes + m_pendingBytes + bytes <= m_budget)
+        return true;
+
+    // Nothing is dropped for a load that wouldn't fit even then
+    if (!force)
+    {
+        spareBytes = 0;
+        for (i = 0; i < m_textureCount; i++)
+        {
+            texture = &m_textures[i];
+            if ((texture->loadState == LOAD_NONE) && (texture->residentMip < GetWantedMip(*texture)))
+                spareBytes += texture->mipBytes[texture->residentMip] - texture->mipBytes[GetWantedMip(*texture)];
+        }
+
+        if (m_residentBytes + m_pendingBytes + bytes > m_budget + spareBytes)
+            return false;
+    }
+
+    while (m_residentBytes + m_pendingBytes + bytes > m_budget)
+    {
+        victim = -1;
+        for (i = 0; i < m_textureCount; i++)
+        {
+            texture = &m_textures[i];
+            if ((texture->loadState != LOAD_NONE) || (texture->residentMip >= GetWantedMip(*texture)))
+                continue;
+
+            if ((victim < 0) || (texture->lastUsedFrame < m_textures[victim].lastUsedFrame))
+                victim = i;
+        }
+
+        if (victim >= 0)
+        {
+            mip = GetWantedMip(m_textures[victim]);
+        }
+        else
+        {
+            if (!force)
+                return false;
+
+            for (i = 0; i < m_textureCount; i++)
+            {
+                texture = &m_textures[i];
+                if ((texture->loadState != LOAD_NONE) || (texture->residentMip >= texture->tailMip))
+                    continue;
+
+                if ((victim < 0) || (texture->lastUsedFrame < m_textures[victim].lastUsedFrame))
+                    victim = i;
+            }
+
+            if (victim < 0)
+                return false;
+
+            mip = m_textures[victim].residentMip + 1;
+        }
+
+        if (!SetResidentMip(victim, mip))
+            return false;
+
+        m_stats.evictions++;
+    }
+
+    return true;
+}
+
+// Creates the textures the worker has copied levels for, the old ones go once the new ones exist
+void TextureStreamerClass::FinishLoads()
+{
+    TextureType* texture;
+    RenderTexture* created;
+    bool ready;
+    int i;
+
+    for (i = 0; i < m_textureCount; i++)
+    {
+        texture = &m_textures[i];
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ready = (texture->loadState == LOAD_READY);
+        }
+        if (!ready)
+            continue;
+
+        m_pendingBytes -= texture->mipBytes[texture->loadMip] - texture->mipBytes[texture->residentMip];
+
+        // A failed copy leaves no data and the texture keeps what it had
+        created = 0;
+        if (texture->loadData)
+            created = CreateTexture(*texture, texture->loadMip, texture->loadSubresources);
+
+        if (created)
+        {
+            texture->texture->Release();
+            texture->texture = created;
+
+            m_residentBytes = m_residentBytes - texture->mipBytes[texture->residentMip] + texture->mipBytes[texture->loadMip];
+            texture->residentMip = texture->loadMip;
+
+            m_stats.loadsCompleted++;
+        }
+
+        ReleaseLoad(*texture);
+        texture->loadState = LOAD_NONE;
+    }
+
+    return;
+}
+
+// The textures furthest from what they were asked for go to the front of the queue
+void TextureStreamerClass::QueueLoads()
+{
+    TextureType* texture;
+    unsigned int bytes;
+    int i, j, mip;
+    bool queued;
+
+    queued = false;
+
+    for (i = 0; i < m_textureCount; i++)
+    {
+        texture = &m_textures[i];
+        if ((texture->loadState != LOAD_NONE) || (texture->lastUsedFrame != m_frame) || (texture->requestedMip >= texture->residentMip))
+            continue;
+
+        // Settle for a coarser level when the finest one won't fit
+        for (mip = texture->requestedMip; mip < texture->residentMip; mip++)
+        {
+            bytes = texture->mipBytes[mip] - texture->mipBytes[texture->residentMip];
+            if (MakeRoom(bytes, false))
+                break;
+        }
+
+        if (mip == texture->residentMip)
+            continue;
+
+        m_pendingBytes += texture->mipBytes[mip] - texture->mipBytes[texture->residentMip];
+
+        texture->loadMip = mip;
+        texture->loadPriority = texture->residentMip - texture->requestedMip;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            texture->loadState = LOAD_QUEUED;
+
+            j = m_queueCount;
+            while ((j > 0) && (m_textures[m_queue[j - 1]].loadPriority < texture->loadPriority))
+            {
+                m_queue[j] = m_queue[j - 1];
+                j--;
+            }
+            m_queue[j] = i;
+            m_queueCount++;
+        }
+
+        queued = true;
+    }
+
+    if (queued)
+        m_queueCondition.notify_one();
+
+    return;
+}
+
+void TextureStreamerClass::WorkerThread()
+{
+    TextureType* texture;
+    int i;
+
+    PROFILE_THREAD("Texture streamer");
+
+    while (true)
+    {
+        // Sleep until a load is queued or we are shutting down
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueCondition.wait(lock, [this] { return m_quit || (m_queueCount > 0); });
+            if (m_quit)
+                return;
+
+            texture = &m_textures[m_queue[0]];
+
+            m_queueCount--;
+            for (i = 0; i < m_queueCount; i++)
+                m_queue[i] = m_queue[i + 1];
+        }
+
+        {
+            PROFILE_ZONE("Copy mip levels");
+            if (!CopyLevels(*texture))
+                ReleaseLoad(*texture);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            texture->loadState = LOAD_READY;
+        }
+    }
+}
+
+// Reading the mapped levels is where the file is actually paged in, so it happens here rather than in Update
+bool TextureStreamerClass::CopyLevels(TextureType& texture)
+{
+    const DdsSubresourceType* levels;
+    RenderSubresourceType* subresource;
+    unsigned char* data;
+    int count, slice, level;
+
+    levels = texture.file->GetSubresources();
+    count = (texture.mipCount - texture.loadMip) * texture.file->GetArraySize();
+
+    texture.loadData = new unsigned char[texture.mipBytes[texture.loadMip]];
+    if (!texture.loadData)
+        return false;
+
+    texture.loadSubresources = new RenderSubresourceType[count];
+    if (!texture.loadSubresources)
+        return false;
+
+    data = texture.loadData;
+    for (slice = 0; slice < texture.file->GetArraySize(); slice++)
+    {
+        for (level = texture.loadMip; level < texture.mipCount; level++)
+        {
+            subresource = &texture.loadSubresources[slice * (texture.mipCount - texture.loadMip) + level - texture.loadMip];
+
+            memcpy(data, levels[slice * texture.mipCount + level].data, levels[slice * texture.mipCount + level].slicePitch);
+
+            subresource->data = data;
+            subresource->rowPitch = levels[slice * texture.mipCount + level].rowPitch;
+            subresource->slicePitch = levels[slice * texture.mipCount + level].slicePitch;
+
+            data += levels[slice * texture.mipCount + level].slicePitch;
+        }
+    }
+
+    return true;
+}
+
+void TextureStreamerClass::ReleaseLoad(TextureType& texture)
+{
+    if (texture.loadSubresources)
+    {
+        delete[] texture.loadSubresources;
+        texture.loadSubresources = 0;
+    }
+
+    if (texture.loadData)
+    {
+        delete[] texture.loadData;
+        texture.loadData = 0;
+    }
+
+    return;
+}
\ No newline at end of file
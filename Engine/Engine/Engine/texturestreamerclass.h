@@ -0,0 +1,110 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <math.h>
+#include <string.h>
+#include "renderdeviceclass.h"
+#include "ddsfileclass.h"
+#include "profilerclass.h"
+
+const int TEXTURE_STREAM_CAPACITY = 16;
+const int TEXTURE_STREAM_TAIL_SIZE = 32;
+const unsigned int TEXTURE_STREAM_DEFAULT_BUDGET = 8 * 1024 * 1024;
+
+// What the streamer holds and what the last frame asked for
+struct TextureStreamStatsType
+{
+    unsigned int residentBytes;
+    unsigned int requestedBytes;
+    unsigned int budgetBytes;
+    int pendingLoads;
+    int loadsCompleted;
+    int evictions;
+};
+
+// Keeps only the mips of each texture that the frame needs. A texture starts
+// with its mip tail, the levels TEXTURE_STREAM_TAIL_SIZE pixels and smaller,
+// and the render path asks for a finer level each frame from how big the
+// objects using it are on screen. Finer levels are copied out of the mapped
+// DDS file on a worker thread, biggest shortfall first, and the texture is
+// recreated with them on the next Update. When the resident bytes would go
+// over the budget the least recently used textures that hold more than they
+// were last asked for drop back, and a load that still doesn't fit settles for
+// a coarser level. Textures are kept in a fixed array so the worker never sees
+// it move.
+class TextureStreamerClass
+{
+private:
+    enum LoadStateType
+    {
+        LOAD_NONE,
+        LOAD_QUEUED,
+        LOAD_READY
+    };
+
+    struct TextureType
+    {
+        DdsFileClass* file;
+        RenderTexture* texture;
+        int mipCount, tailMip;
+        int residentMip, requestedMip;
+        long long lastUsedFrame;
+        unsigned int mipBytes[DDS_MAX_MIPS + 1];
+
+        LoadStateType loadState;
+        int loadMip, loadPriority;
+        unsigned char* loadData;
+        RenderSubresourceType* loadSubresources;
+    };
+
+public:
+    TextureStreamerClass();
+    TextureStreamerClass(const TextureStreamerClass&);
+    ~TextureStreamerClass();
+
+    bool Initialize(RenderDeviceClass*, unsigned int);
+    void Shutdown();
+
+    int Register(char*);
+    void RequestMip(int, int);
+    void RequestSize(int, float);
+    void Update();
+
+    RenderTexture* GetTexture(int);
+    int GetResidentMip(int);
+    void SetBudget(unsigned int);
+    TextureStreamStatsType GetStats();
+
+    static bool RunTests(char*);
+
+private:
+    RenderTexture* CreateTexture(TextureType&, int, const RenderSubresourceType*);
+    bool SetResidentMip(int, int);
+    int GetWantedMip(TextureType&);
+    bool MakeRoom(unsigned int, bool);
+    void FinishLoads();
+    void QueueLoads();
+    void WorkerThread();
+    bool CopyLevels(TextureType&);
+    void ReleaseLoad(TextureType&);
+
+private:
+    RenderDeviceClass* m_device;
+    unsigned int m_budget;
+
+    TextureType* m_textures;
+    int m_textureCount;
+    long long m_frame;
+
+    unsigned int m_residentBytes, m_pendingBytes;
+    TextureStreamStatsType m_stats;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_queueCondition;
+    int m_queue[TEXTURE_STREAM_CAPACITY];
+    int m_queueCount;
+    bool m_quit;
+};
\ No newline at end of file
@@ -22,24 +22,25 @@ bool TimerClass::Initialize()
     if (m_frequency == 0)
         return false;
 
-    // Find out how many times the frequency counter ticks every millisecond
-    m_ticksPerMs = (float)(m_frequency / 1000);
-
     QueryPerformanceCounter((LARGE_INTEGER*)&m_startTime);
 
+    m_frameNanoseconds = 0;
+    m_frameTime = 0.0f;
+
     return true;
 }
 
 void TimerClass::Frame()
 {
-    INT64 currentTime;
-    float timeDifference;
+    INT64 currentTime, elapsed;
 
     QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
 
-    timeDifference = (float)(currentTime - m_startTime);
+    // Whole seconds and the remainder separately so the multiply can't overflow
+    elapsed = currentTime - m_startTime;
+    m_frameNanoseconds = (elapsed / m_frequency) * 1000000000 + ((elapsed % m_frequency) * 1000000000) / m_frequency;
 
-    m_frameTime = timeDifference / m_ticksPerMs;
+    m_frameTime = (float)((double)m_frameNanoseconds / 1000000.0);
 
     m_startTime = currentTime;
 
@@ -49,4 +50,9 @@ void TimerClass::Frame()
 float TimerClass::GetTime()
 {
     return m_frameTime;
+}
+
+INT64 TimerClass::GetFrameNanoseconds()
+{
+    return m_frameNanoseconds;
 }
\ No newline at end of file
@@ -13,10 +13,11 @@ public:
     void Frame();
 
     float GetTime();
+    INT64 GetFrameNanoseconds();
 
 private:
     INT64 m_frequency;
-    float m_ticksPerMs;
     INT64 m_startTime;
+    INT64 m_frameNanoseconds;
     float m_frameTime;
 };
\ No newline at end of file
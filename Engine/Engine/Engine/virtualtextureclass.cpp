@@ -0,0 +1,1111 @@
+#include "virtualtextureclass.h"
+
+static long long GetNanoseconds()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static unsigned int GetKeyMip(unsigned int key)
+{
+    return key >> 24;
+}
+
+static unsigned int GetKeyX(unsigned int key)
+{
+    return key & 0xfff;
+}
+
+static unsigned int GetKeyY(unsigned int key)
+{
+    return (key >> 12) & 0xfff;
+}
+
+VirtualTextureClass::VirtualTextureClass()
+{
+    int i;
+
+    m_widthInPages = 0;
+    m_heightInPages = 0;
+    m_mipCount = 0;
+    for (i = 0; i < VT_MAX_MIPS; i++)
+        m_pageTables[i] = 0;
+
+    m_cacheWidth = 0;
+    m_cacheHeight = 0;
+    m_slots = 0;
+    m_slotCount = 0;
+    m_slotsUsed = 0;
+    m_head = -1;
+    m_tail = -1;
+    m_buckets = 0;
+    m_bucketMask = 0;
+    m_uploadCount = 0;
+
+    memset(&m_feedbackPages, 0, sizeof(m_feedbackPages));
+    memset(&m_missingPages, 0, sizeof(m_missingPages));
+    m_candidates = 0;
+    m_candidateCount = 0;
+
+    m_loadsPerFrame = 0;
+    m_loadPage = 0;
+    m_userData = 0;
+    m_frame = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    for (i = 0; i < VT_MAX_LOADS; i++)
+    {
+        m_loads[i].key = VT_FEEDBACK_NONE;
+        m_loads[i].state = LOAD_FREE;
+        m_loads[i].texels = 0;
+    }
+    m_queueCount = 0;
+    m_quit = false;
+}
+
+VirtualTextureClass::VirtualTextureClass(const VirtualTextureClass& other)
+{
+
+}
+
+VirtualTextureClass::~VirtualTextureClass()
+{
+
+}
+
+// Sizes are in pages and have to be powers of two. The feedback count is the most entries one Update is given
+bool VirtualTextureClass::Initialize(int widthInPages, int heightInPages, int cacheWidth, int cacheHeight, int loadsPerFrame, int feedbackCount,
+    VirtualPageLoadFunction loadPage, void* userData)
+{
+    unsigned int bucketCount;
+    int i, size, level;
+
+    if ((widthInPages < 1) || (widthInPages > 4096) || (widthInPages & (widthInPages - 1)) ||
+        (heightInPages < 1) || (heightInPages > 4096) || (heightInPages & (heightInPages - 1)))
+        return false;
+
+    if ((cacheWidth < 1) || (cacheWidth > 256) || (cacheHeight < 1) || (cacheHeight > 256) || !loadPage)
+        return false;
+
+    if ((loadsPerFrame < 1) || (loadsPerFrame > VT_MAX_LOADS))
+        return false;
+
+    m_widthInPages = widthInPages;
+    m_heightInPages = heightInPages;
+    m_loadsPerFrame = loadsPerFrame;
+    m_loadPage = loadPage;
+    m_userData = userData;
+
+    // Down to the level that is a single page
+    size = (m_widthInPages > m_heightInPages) ? m_widthInPages : m_heightInPages;
+    m_mipCount = 1;
+    while ((1 << (m_mipCount - 1)) < size)
+        m_mipCount++;
+
+    for (level = 0; level < m_mipCount; level++)
+    {
+        size = GetWidthInPages(level) * GetHeightInPages(level);
+        m_pageTables[level] = new unsigned int[size];
+        if (!m_pageTables[level])
+            return false;
+
+        // Unmapped until the pinned level is in
+        for (i = 0; i < size; i++)
+            m_pageTables[level][i] = VT_FEEDBACK_NONE;
+    }
+
+    m_cacheWidth = cacheWidth;
+    m_cacheHeight = cacheHeight;
+    m_slotCount = m_cacheWidth * m_cacheHeight;
+    m_slotsUsed = 0;
+    m_head = -1;
+    m_tail = -1;
+
+    m_slots = new SlotType[m_slotCount];
+    if (!m_slots)
+        return false;
+
+    bucketCount = 1;
+    while (bucketCount < (unsigned int)m_slotCount * 2)
+        bucketCount *= 2;
+
+    m_buckets = new int[bucketCount];
+    if (!m_buckets)
+        return false;
+
+    for (i = 0; i < (int)bucketCount; i++)
+        m_buckets[i] = -1;
+
+    m_bucketMask = bucketCount - 1;
+
+    if (!InitializeSet(m_feedbackPages, feedbackCount))
+        return false;
+
+    if (!InitializeSet(m_missingPages, feedbackCount))
+        return false;
+
+    m_candidates = new CandidateType[1 << (m_missingPages.bits - 1)];
+    if (!m_candidates)
+        return false;
+
+    for (i = 0; i < VT_MAX_LOADS; i++)
+    {
+        m_loads[i].texels = new unsigned char[VT_PAGE_TEXELS * VT_PAGE_TEXELS * 4];
+        if (!m_loads[i].texels)
+            return false;
+    }
+
+    m_frame = 0;
+
+    if (!LoadPinnedPages())
+        return false;
+
+    m_queueCount = 0;
+    m_quit = false;
+    m_thread = thread(&VirtualTextureClass::WorkerThread, this);
+
+    return true;
+}
+
+void VirtualTextureClass::Shutdown()
+{
+    int i;
+
+    // Let the loader finish the page it is on and leave its loop
+    if (m_thread.joinable())
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_queueCondition.notify_all();
+
+        m_thread.join();
+    }
+
+    for (i = 0; i < VT_MAX_LOADS; i++)
+    {
+        if (m_loads[i].texels)
+        {
+            delete[] m_loads[i].texels;
+            m_loads[i].texels = 0;
+        }
+        m_loads[i].state = LOAD_FREE;
+    }
+
+    if (m_candidates)
+    {
+        delete[] m_candidates;
+        m_candidates = 0;
+    }
+
+    ReleaseSet(m_missingPages);
+    ReleaseSet(m_feedbackPages);
+
+    if (m_buckets)
+    {
+        delete[] m_buckets;
+        m_buckets = 0;
+    }
+
+    if (m_slots)
+    {
+        delete[] m_slots;
+        m_slots = 0;
+    }
+
+    for (i = 0; i < VT_MAX_MIPS; i++)
+    {
+        if (m_pageTables[i])
+        {
+            delete[] m_pageTables[i];
+            m_pageTables[i] = 0;
+        }
+    }
+
+    m_slotCount = 0;
+    m_slotsUsed = 0;
+    m_queueCount = 0;
+
+    return;
+}
+
+// Once a frame with the feedback the last frame wrote
+bool VirtualTextureClass::Update(const unsigned int* feedback, int feedbackCount)
+{
+    long long start;
+
+    m_frame++;
+
+    m_stats.loadsCompleted = 0;
+    m_stats.loadsDropped = 0;
+    m_stats.evictions = 0;
+
+    // Touching what is used comes first so those pages are safe from this frame's evictions
+    start = GetNanoseconds();
+    ReduceFeedback(feedback, feedbackCount);
+    FindMissingPages();
+    m_stats.reduceNanoseconds = GetNanoseconds() - start;
+
+    start = GetNanoseconds();
+    FinishLoads();
+    m_stats.updateNanoseconds = GetNanoseconds() - start;
+
+    QueueLoads();
+
+    m_stats.residentPages = m_slotsUsed;
+
+    return true;
+}
+
+// Blocks until the loader is idle, with nothing queued or no buffer free to load into. The next
+// Update then finds the same pages ready however fast the loader ran, which headless runs rely on
+void VirtualTextureClass::WaitForLoads()
+{
+    unique_lock<mutex> lock(m_mutex);
+
+    m_loadCondition.wait(lock, [this]
+    {
+        bool busy, free;
+        int i;
+
+        busy = false;
+        free = false;
+        for (i = 0; i < VT_MAX_LOADS; i++)
+        {
+            if (m_loads[i].state == LOAD_BUSY)
+                busy = true;
+            if (m_loads[i].state == LOAD_FREE)
+                free = true;
+        }
+
+        return m_quit || (!busy && ((m_queueCount == 0) || !free));
+    });
+
+    return;
+}
+
+int VirtualTextureClass::GetMipCount()
+{
+    return m_mipCount;
+}
+
+int VirtualTextureClass::GetWidthInPages(int mip)
+{
+    return ((m_widthInPages >> mip) > 0) ? (m_widthInPages >> mip) : 1;
+}
+
+int VirtualTextureClass::GetHeightInPages(int mip)
+{
+    return ((m_heightInPages >> mip) > 0) ? (m_heightInPages >> mip) : 1;
+}
+
+const unsigned int* VirtualTextureClass::GetPageTable(int mip)
+{
+    return m_pageTables[mip];
+}
+
+int VirtualTextureClass::GetCacheWidth()
+{
+    return m_cacheWidth;
+}
+
+int VirtualTextureClass::GetCacheHeight()
+{
+    return m_cacheHeight;
+}
+
+// The pages put in the cache by the last Update, or by Initialize before the first one, for the renderer
+// to copy into the physical texture
+const VirtualPageUploadType* VirtualTextureClass::GetUploads(int& count)
+{
+    count = m_uploadCount;
+    return m_uploads;
+}
+
+VirtualTextureStatsType VirtualTextureClass::GetStats()
+{
+    return m_stats;
+}
+
+// Counts the page table entries that don't point at the finest resident page covering them
+int VirtualTextureClass::CheckPageTable()
+{
+    unsigned int entry, key;
+    int errors, level, x, y, mip, slot, finer;
+
+    errors = 0;
+    for (level = 0; level < m_mipCount; level++)
+    {
+        for (y = 0; y < GetHeightInPages(level); y++)
+        {
+            for (x = 0; x < GetWidthInPages(level); x++)
+            {
+                entry = m_pageTables[level][y * GetWidthInPages(level) + x];
+                mip = (entry >> 16) & 0xff;
+                slot = ((entry >> 8) & 0xff) * m_cacheWidth + (entry & 0xff);
+
+                if ((entry == VT_FEEDBACK_NONE) || (mip < level) || (mip >= m_mipCount) || (slot >= m_slotsUsed))
+                {
+                    errors++;
+                    continue;
+                }
+
+                key = PackFeedback(mip, x >> (mip - level), y >> (mip - level));
+                if (m_slots[slot].key != key)
+                {
+                    errors++;
+                    continue;
+                }
+
+                for (finer = level; finer < mip; finer++)
+                {
+                    if (FindSlot(PackFeedback(finer, x >> (finer - level), y >> (finer - level))) >= 0)
+                    {
+                        errors++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+unsigned int VirtualTextureClass::PackFeedback(int mip, int x, int y)
+{
+    return ((unsigned int)mip << 24) | ((unsigned int)y << 12) | (unsigned int)x;
+}
+
+// The single page of the coarsest level is loaded here, on the calling thread, and stays for good
+bool VirtualTextureClass::LoadPinnedPages()
+{
+    int slot;
+
+    m_uploadCount = 0;
+
+    if (!m_loadPage(m_mipCount - 1, 0, 0, m_loads[0].texels, VT_PAGE_TEXELS * 4, m_userData))
+        return false;
+
+    slot = AllocateSlot();
+    if (slot < 0)
+        return false;
+
+    // Its upload is there to take straight after Initialize
+    m_loads[0].key = PackFeedback(m_mipCount - 1, 0, 0);
+    m_loads[0].state = LOAD_UPLOADING;
+    PlacePage(slot, m_loads[0].key, m_loads[0].texels);
+
+    m_slots[slot].pinned = true;
+    Unlink(slot);
+
+    return true;
+}
+
+// Only loadsPerFrame pages go in each frame, the rest wait in their buffers for the next one. The buffers
+// of the pages put in the cache are kept for the renderer to upload from until the next frame
+void VirtualTextureClass::FinishLoads()
+{
+    int ready[VT_MAX_LOADS];
+    int readyCount, i, slot;
+
+    readyCount = 0;
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // QueueLoads replaces the queue with this frame's wants, so the loader
+        // waits for those rather than spending the freed buffers on stale ones
+        m_queueCount = 0;
+
+        for (i = 0; i < VT_MAX_LOADS; i++)
+        {
+            // Last frame's uploads are done with
+            if (m_loads[i].state == LOAD_UPLOADING)
+                m_loads[i].state = LOAD_FREE;
+
+            if ((m_loads[i].state == LOAD_READY) && (readyCount < m_loadsPerFrame))
+                ready[readyCount++] = i;
+        }
+    }
+
+    m_uploadCount = 0;
+    for (i = 0; i < readyCount; i++)
+    {
+        // Every slot was used this frame, the page will be asked for again
+        slot = -1;
+        if (FindSlot(m_loads[ready[i]].key) < 0)
+        {
+            slot = AllocateSlot();
+            if (slot < 0)
+                m_stats.loadsDropped++;
+        }
+
+        if (slot >= 0)
+        {
+            PlacePage(slot, m_loads[ready[i]].key, m_loads[ready[i]].texels);
+            m_stats.loadsCompleted++;
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_loads[ready[i]].state = (slot >= 0) ? LOAD_UPLOADING : LOAD_FREE;
+        }
+    }
+
+    return;
+}
+
+// Many feedback pixels land on the same page, each unique page keeps how many did
+void VirtualTextureClass::ReduceFeedback(const unsigned int* feedback, int feedbackCount)
+{
+    int i;
+
+    ClearSet(m_feedbackPages);
+
+    for (i = 0; i < feedbackCount; i++)
+    {
+        if (feedback[i] != VT_FEEDBACK_NONE)
+            AddToSet(m_feedbackPages, feedback[i], 1);
+    }
+
+    m_stats.feedbackCount = feedbackCount;
+    m_stats.uniquePages = m_feedbackPages.usedCount;
+
+    return;
+}
+
+// Each wanted page shows its finest resident ancestor, that one is touched and the level below it asked for
+void VirtualTextureClass::FindMissingPages()
+{
+    unsigned int key, count;
+    int i, mip, x, y, wantedMip, finerX, finerY, slot;
+    long long fallback;
+
+    ClearSet(m_missingPages);
+
+    fallback = 0;
+    for (i = 0; i < m_feedbackPages.usedCount; i++)
+    {
+        key = m_feedbackPages.keys[m_feedbackPages.used[i]];
+        count = m_feedbackPages.values[m_feedbackPages.used[i]];
+
+        wantedMip = GetKeyMip(key);
+        x = GetKeyX(key);
+        y = GetKeyY(key);
+
+        // Mips past the last are clamped, pages outside the texture are ignored
+        if (wantedMip >= m_mipCount)
+            wantedMip = m_mipCount - 1;
+        if ((x >= GetWidthInPages(wantedMip)) || (y >= GetHeightInPages(wantedMip)))
+            continue;
+
+        mip = wantedMip;
+        finerX = x;
+        finerY = y;
+        slot = FindSlot(PackFeedback(mip, x, y));
+        while (slot < 0)
+        {
+            finerX = x;
+            finerY = y;
+            mip++;
+            x >>= 1;
+            y >>= 1;
+            slot = FindSlot(PackFeedback(mip, x, y));
+        }
+
+        Touch(slot);
+
+        if (mip > wantedMip)
+        {
+            // Pages far from what they should show and covering many pixels go first
+            AddToSet(m_missingPages, PackFeedback(mip - 1, finerX, finerY), count * (mip - wantedMip));
+            fallback += mip - wantedMip;
+        }
+    }
+
+    m_stats.missingPages = m_missingPages.usedCount;
+    m_stats.fallbackMips = (m_feedbackPages.usedCount > 0) ? (float)fallback / (float)m_feedbackPages.usedCount : 0.0f;
+
+    return;
+}
+
+// The queue is rebuilt from this frame's wants, pages nobody looks at any more never get loaded
+void VirtualTextureClass::QueueLoads()
+{
+    int i, j;
+    bool loading;
+
+    m_candidateCount = 0;
+    for (i = 0; i < m_missingPages.usedCount; i++)
+    {
+        m_candidates[m_candidateCount].key = m_missingPages.keys[m_missingPages.used[i]];
+        m_candidates[m_candidateCount].priority = m_missingPages.values[m_missingPages.used[i]];
+        m_candidateCount++;
+    }
+
+    sort(m_candidates, m_candidates + m_candidateCount, [](const CandidateType& a, const CandidateType& b) { return a.priority > b.priority; });
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        m_queueCount = 0;
+        for (i = 0; (i < m_candidateCount) && (m_queueCount < VT_QUEUE_CAPACITY); i++)
+        {
+            // Loaded this frame, or still with the loader
+            if (FindSlot(m_candidates[i].key) >= 0)
+                continue;
+
+            loading = false;
+            for (j = 0; j < VT_MAX_LOADS; j++)
+            {
+                if ((m_loads[j].state != LOAD_FREE) && (m_loads[j].key == m_candidates[i].key))
+                    loading = true;
+            }
+
+            if (!loading)
+                m_queue[m_queueCount++] = m_candidates[i].key;
+        }
+
+        m_stats.queuedPages = m_queueCount;
+    }
+
+    if (m_stats.queuedPages > 0)
+        m_queueCondition.notify_one();
+
+    return;
+}
+
+int VirtualTextureClass::FindSlot(unsigned int key)
+{
+    unsigned int hash;
+    int slot;
+
+    hash = key ^ (key >> 13);
+    hash *= 0x9e3779b1;
+    hash ^= hash >> 16;
+
+    slot = m_buckets[hash & m_bucketMask];
+    while (slot >= 0)
+    {
+        if (m_slots[slot].key == key)
+            return slot;
+
+        slot = m_slots[slot].chain;
+    }
+
+    return -1;
+}
+
+// A free slot until they run out, then the least recently used page if it wasn't used this frame
+int VirtualTextureClass::AllocateSlot()
+{
+    unsigned int hash;
+    int slot, *link;
+
+    if (m_slotsUsed < m_slotCount)
+    {
+        slot = m_slotsUsed++;
+        m_slots[slot].key = VT_FEEDBACK_NONE;
+        m_slots[slot].chain = -1;
+        m_slots[slot].pinned = false;
+        return slot;
+    }
+
+    slot = m_tail;
+    if ((slot < 0) || (m_slots[slot].lastUsedFrame == m_frame))
+        return -1;
+
+    Unlink(slot);
+    UnmapPage(m_slots[slot].key);
+
+    // Take it out of its bucket's chain
+    hash = m_slots[slot].key ^ (m_slots[slot].key >> 13);
+    hash *= 0x9e3779b1;
+    hash ^= hash >> 16;
+
+    link = &m_buckets[hash & m_bucketMask];
+    while (*link != slot)
+        link = &m_slots[*link].chain;
+    *link = m_slots[slot].chain;
+
+    m_slots[slot].key = VT_FEEDBACK_NONE;
+    m_slots[slot].chain = -1;
+
+    m_stats.evictions++;
+
+    return slot;
+}
+
+void VirtualTextureClass::PlacePage(int slot, unsigned int key, const unsigned char* texels)
+{
+    unsigned int hash;
+
+    m_slots[slot].key = key;
+    m_slots[slot].lastUsedFrame = m_frame;
+    m_slots[slot].pinned = false;
+
+    hash = key ^ (key >> 13);
+    hash *= 0x9e3779b1;
+    hash ^= hash >> 16;
+
+    m_slots[slot].chain = m_buckets[hash & m_bucketMask];
+    m_buckets[hash & m_bucketMask] = slot;
+
+    PushFront(slot);
+
+    // The physical texture is a grid of pages, slot x across and slot y down
+    m_uploads[m_uploadCount].slotX = slot % m_cacheWidth;
+    m_uploads[m_uploadCount].slotY = slot / m_cacheWidth;
+    m_uploads[m_uploadCount].texels = texels;
+    m_uploads[m_uploadCount].pitch = VT_PAGE_TEXELS * 4;
+    m_uploadCount++;
+
+    MapPage(slot, key);
+
+    return;
+}
+
+// Every entry under the page that showed a coarser level now shows this one
+void VirtualTextureClass::MapPage(int slot, unsigned int key)
+{
+    unsigned int entry;
+
+    entry = (slot % m_cacheWidth) | ((slot / m_cacheWidth) << 8) | (GetKeyMip(key) << 16) | 0xff000000;
+
+    SetEntries(GetKeyMip(key), GetKeyX(key), GetKeyY(key), GetKeyMip(key), entry, false);
+
+    return;
+}
+
+// Entries that showed the page go back to whatever its parent shows
+void VirtualTextureClass::UnmapPage(unsigned int key)
+{
+    unsigned int parent;
+    int mip;
+
+    mip = GetKeyMip(key);
+    parent = m_pageTables[mip + 1][(GetKeyY(key) >> 1) * GetWidthInPages(mip + 1) + (GetKeyX(key) >> 1)];
+
+    SetEntries(mip, GetKeyX(key), GetKeyY(key), mip, parent, true);
+
+    return;
+}
+
+// Walks down the quadtree under a page. Mapping replaces entries showing a coarser level and unmapping the
+// ones showing the page itself, and an entry showing a finer page has only finer ones under it, so it stops there
+void VirtualTextureClass::SetEntries(int level, int x, int y, int mip, unsigned int entry, bool unmap)
+{
+    unsigned int* current;
+    int childX, childY;
+
+    current = &m_pageTables[level][y * GetWidthInPages(level) + x];
+    if ((int)((*current >> 16) & 0xff) < mip)
+        return;
+    if (unmap && ((int)((*current >> 16) & 0xff) != mip))
+        return;
+
+    *current = entry;
+
+    if (level == 0)
+        return;
+
+    for (childY = y * 2; (childY <= y * 2 + 1) && (childY < GetHeightInPages(level - 1)); childY++)
+    {
+        for (childX = x * 2; (childX <= x * 2 + 1) && (childX < GetWidthInPages(level - 1)); childX++)
+            SetEntries(level - 1, childX, childY, mip, entry, unmap);
+    }
+
+    return;
+}
+
+void VirtualTextureClass::Touch(int slot)
+{
+    m_slots[slot].lastUsedFrame = m_frame;
+
+    // Most recently used goes to the front, pinned pages aren't on the list
+    if (!m_slots[slot].pinned)
+    {
+        Unlink(slot);
+        PushFront(slot);
+    }
+
+    return;
+}
+
+void VirtualTextureClass::Unlink(int slot)
+{
+    SlotType* entry;
+
+    entry = &m_slots[slot];
+
+    if (entry->previous >= 0)
+        m_slots[entry->previous].next = entry->next;
+    else
+        m_head = entry->next;
+
+    if (entry->next >= 0)
+        m_slots[entry->next].previous = entry->previous;
+    else
+        m_tail = entry->previous;
+
+    entry->previous = -1;
+    entry->next = -1;
+
+    return;
+}
+
+void VirtualTextureClass::PushFront(int slot)
+{
+    m_slots[slot].previous = -1;
+    m_slots[slot].next = m_head;
+
+    if (m_head >= 0)
+        m_slots[m_head].previous = slot;
+    else
+        m_tail = slot;
+
+    m_head = slot;
+
+    return;
+}
+
+void VirtualTextureClass::WorkerThread()
+{
+    unsigned int key;
+    bool result;
+    int load, i;
+
+    while (true)
+    {
+        // Sleep until a page is queued and there is a buffer to load it into, or we are shutting down
+        {
+            unique_lock<mutex> lock(m_mutex);
+            load = -1;
+            m_queueCondition.wait(lock, [this, &load]
+            {
+                int index;
+
+                if (m_quit)
+                    return true;
+
+                load = -1;
+                for (index = 0; (index < VT_MAX_LOADS) && (load < 0); index++)
+                {
+                    if (m_loads[index].state == LOAD_FREE)
+                        load = index;
+                }
+
+                return (m_queueCount > 0) && (load >= 0);
+            });
+            if (m_quit)
+                return;
+
+            key = m_queue[0];
+            m_queueCount--;
+            for (i = 0; i < m_queueCount; i++)
+                m_queue[i] = m_queue[i + 1];
+
+            m_loads[load].key = key;
+            m_loads[load].state = LOAD_BUSY;
+        }
+
+        result = m_loadPage(GetKeyMip(key), GetKeyX(key), GetKeyY(key), m_loads[load].texels, VT_PAGE_TEXELS * 4, m_userData);
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_loads[load].state = result ? LOAD_READY : LOAD_FREE;
+        }
+        m_loadCondition.notify_all();
+    }
+}
+
+// Open addressing with room for twice the entries it can hold, so probes stay short
+bool VirtualTextureClass::InitializeSet(PageSetType& set, int capacity)
+{
+    int size, i;
+
+    set.bits = 1;
+    while ((1 << set.bits) < capacity * 2)
+        set.bits++;
+    size = 1 << set.bits;
+
+    set.keys = new unsigned int[size];
+    if (!set.keys)
+        return false;
+
+    set.values = new unsigned int[size];
+    if (!set.values)
+        return false;
+
+    set.used = new int[size / 2];
+    if (!set.used)
+        return false;
+
+    for (i = 0; i < size; i++)
+        set.keys[i] = VT_FEEDBACK_NONE;
+
+    set.usedCount = 0;
+
+    return true;
+}
+
+void VirtualTextureClass::ReleaseSet(PageSetType& set)
+{
+    if (set.used)
+    {
+        delete[] set.used;
+        set.used = 0;
+    }
+
+    if (set.values)
+    {
+        delete[] set.values;
+        set.values = 0;
+    }
+
+    if (set.keys)
+    {
+        delete[] set.keys;
+        set.keys = 0;
+    }
+
+    set.usedCount = 0;
+
+    return;
+}
+
+// Only the entries that were filled are cleared
+void VirtualTextureClass::ClearSet(PageSetType& set)
+{
+    int i;
+
+    for (i = 0; i < set.usedCount; i++)
+        set.keys[set.used[i]] = VT_FEEDBACK_NONE;
+
+    set.usedCount = 0;
+
+    return;
+}
+
+// Adds the value to the key's total, a full set drops new keys
+void VirtualTextureClass::AddToSet(PageSetType& set, unsigned int key, unsigned int value)
+{
+    unsigned int index, mask;
+
+    mask = (1u << set.bits) - 1;
+    index = (key * 0x9e3779b1) >> (32 - set.bits);
+
+    while (set.keys[index] != VT_FEEDBACK_NONE)
+    {
+        if (set.keys[index] == key)
+        {
+            set.values[index] += value;
+            return;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    if (set.usedCount == (1 << (set.bits - 1)))
+        return;
+
+    set.keys[index] = key;
+    set.values[index] = value;
+    set.used[set.usedCount++] = index;
+
+    return;
+}
+
+// Runs a camera over a ground plane textured with a procedural virtual texture far too big to hold, feeding
+// Update synthetic feedback each frame and writing what the cache did to the file. Needs no device at all
+bool VirtualTextureClass::RunSimulation(char* filename)
+{
+    const int widthInPages = 1024, heightInPages = 1024;
+    const int cacheWidth = 32, cacheHeight = 32, loadsPerFrame = 16;
+    const int feedbackWidth = 160, feedbackHeight = 90;
+    const int frameCount = 600;
+    VirtualTextureClass* virtualTexture;
+    VirtualTextureStatsType stats;
+    unsigned int* feedback;
+    ofstream fout;
+    long long reduceTotal, updateTotal, uploadBytes;
+    float cameraU, cameraV, fallbackTotal;
+    int frame, loadTotal, dropTotal, evictionTotal, missingFrames, errors, uploadCount;
+    bool result;
+
+    feedback = new unsigned int[feedbackWidth * feedbackHeight];
+    if (!feedback)
+        return false;
+
+    virtualTexture = new VirtualTextureClass;
+    if (!virtualTexture)
+    {
+        delete[] feedback;
+        return false;
+    }
+
+    result = virtualTexture->Initialize(widthInPages, heightInPages, cacheWidth, cacheHeight, loadsPerFrame, feedbackWidth * feedbackHeight,
+        SimulationPage, 0);
+    if (result)
+    {
+        fout.open(filename);
+        result = !fout.fail();
+    }
+
+    if (result)
+    {
+        fout << "Virtual texture " << widthInPages * VT_PAGE_SIZE << "x" << heightInPages * VT_PAGE_SIZE << " texels, " << virtualTexture->GetMipCount()
+            << " mips, " << VT_PAGE_SIZE << " texel pages with a " << VT_PAGE_BORDER << " texel border" << endl;
+        fout << "Physical cache " << cacheWidth << "x" << cacheHeight << " pages, " << loadsPerFrame << " loads a frame, feedback "
+            << feedbackWidth << "x" << feedbackHeight << endl << endl;
+        fout << "frame unique missing queued loaded dropped evicted resident fallback reduce(us) update(us)" << endl;
+
+        virtualTexture->GetUploads(uploadCount);
+        uploadBytes = (long long)uploadCount * VT_PAGE_TEXELS * VT_PAGE_TEXELS * 4;
+
+        reduceTotal = 0;
+        updateTotal = 0;
+        fallbackTotal = 0.0f;
+        loadTotal = 0;
+        dropTotal = 0;
+        evictionTotal = 0;
+        missingFrames = 0;
+        errors = 0;
+
+        for (frame = 0; frame < frameCount; frame++)
+        {
+            // Forward at a steady speed with a slow weave from side to side
+            cameraV = frame * 100.0f;
+            cameraU = 40000.0f + 20000.0f * sinf(frame * 0.01f);
+
+            BuildSimulationFeedback(feedback, feedbackWidth, feedbackHeight, cameraU, cameraV, widthInPages, virtualTexture->GetMipCount());
+
+            virtualTexture->Update(feedback, feedbackWidth * feedbackHeight);
+            stats = virtualTexture->GetStats();
+
+            // A renderer would copy these into the physical texture now
+            virtualTexture->GetUploads(uploadCount);
+            uploadBytes += (long long)uploadCount * VT_PAGE_TEXELS * VT_PAGE_TEXELS * 4;
+
+            reduceTotal += stats.reduceNanoseconds;
+            updateTotal += stats.updateNanoseconds;
+            fallbackTotal += stats.fallbackMips;
+            loadTotal += stats.loadsCompleted;
+            dropTotal += stats.loadsDropped;
+            evictionTotal += stats.evictions;
+            if (stats.missingPages > 0)
+                missingFrames++;
+
+            // Let the loader finish what it can start before the next frame, so the run doesn't depend on timing
+            virtualTexture->WaitForLoads();
+
+            if (frame % 30 == 0)
+            {
+                errors += virtualTexture->CheckPageTable();
+
+                fout << frame << " " << stats.uniquePages << " " << stats.missingPages << " " << stats.queuedPages << " " << stats.loadsCompleted << " "
+                    << stats.loadsDropped << " " << stats.evictions << " " << stats.residentPages << " " << stats.fallbackMips << " "
+                    << stats.reduceNanoseconds / 1000.0 << " " << stats.updateNanoseconds / 1000.0 << endl;
+            }
+        }
+
+        errors += virtualTexture->CheckPageTable();
+
+        fout << endl;
+        fout << "Pages loaded " << loadTotal << ", dropped " << dropTotal << ", evicted " << evictionTotal << endl;
+        fout << "Uploaded " << uploadBytes / (1024 * 1024) << " MB" << endl;
+        fout << "Frames still missing pages " << missingFrames << " of " << frameCount << endl;
+        fout << "Average fallback " << fallbackTotal / frameCount << " mips a page" << endl;
+        fout << "Average reduce " << reduceTotal / frameCount / 1000.0 << " us, update " << updateTotal / frameCount / 1000.0 << " us" << endl;
+        fout << "Page table errors " << errors << endl;
+
+        fout.close();
+
+        printf("%d frames, %d pages loaded, %.2f mips average fallback, %d page table errors\n", frameCount, loadTotal, fallbackTotal / frameCount, errors);
+
+        // A loader that never delivers would leave a table with nothing wrong in it
+        result = (errors == 0) && (loadTotal > 0);
+    }
+
+    virtualTexture->Shutdown();
+    delete virtualTexture;
+    virtualTexture = 0;
+
+    delete[] feedback;
+    feedback = 0;
+
+    return result;
+}
+
+// A checker of sixteen texel squares tinted by mip, so the page a texel came from can be seen
+bool VirtualTextureClass::SimulationPage(int mip, int pageX, int pageY, unsigned char* texels, int pitch, void* userData)
+{
+    static const unsigned char tints[][3] =
+    {
+        { 255, 64, 64 }, { 64, 255, 64 }, { 64, 64, 255 }, { 255, 255, 64 }, { 255, 64, 255 }, { 64, 255, 255 }, { 255, 160, 64 }
+    };
+    const unsigned char* tint;
+    unsigned char* texel;
+    int x, y, texelX, texelY, shade;
+
+    tint = tints[mip % 7];
+
+    for (y = 0; y < VT_PAGE_TEXELS; y++)
+    {
+        for (x = 0; x < VT_PAGE_TEXELS; x++)
+        {
+            // The border repeats the neighbouring pages' texels, as a baked page would
+            texelX = pageX * VT_PAGE_SIZE + x - VT_PAGE_BORDER;
+            texelY = pageY * VT_PAGE_SIZE + y - VT_PAGE_BORDER;
+            shade = (((texelX >> 4) ^ (texelY >> 4)) & 1) ? 255 : 128;
+
+            texel = texels + y * pitch + x * 4;
+            texel[0] = (unsigned char)(tint[0] * shade / 255);
+            texel[1] = (unsigned char)(tint[1] * shade / 255);
+            texel[2] = (unsigned char)(tint[2] * shade / 255);
+            texel[3] = 255;
+        }
+    }
+
+    return true;
+}
+
+// What a 1280x720 view of a ground plane would write to an eighth size feedback buffer. Rows further up are
+// further away, so they cover more texels a pixel and want coarser mips, and the top of the view is sky
+void VirtualTextureClass::BuildSimulationFeedback(unsigned int* feedback, int width, int height, float cameraU, float cameraV, int widthInPages,
+    int mipCount)
+{
+    unsigned int textureMask;
+    float along, distance, texelsPerPixel;
+    int x, y, mip, texelX, texelY;
+
+    textureMask = widthInPages * VT_PAGE_SIZE - 1;
+
+    for (y = 0; y < height; y++)
+    {
+        along = (float)(height - y) / (float)height;
+        if (along > 0.8f)
+        {
+            for (x = 0; x < width; x++)
+                feedback[y * width + x] = VT_FEEDBACK_NONE;
+            continue;
+        }
+
+        distance = 1.0f / (1.0f - along);
+        texelsPerPixel = 0.5f * distance * distance;
+
+        mip = 0;
+        while ((mip + 1 < mipCount) && ((float)(2 << mip) <= texelsPerPixel))
+            mip++;
+
+        for (x = 0; x < width; x++)
+        {
+            texelX = (int)(cameraU + (x - width / 2) * 8 * texelsPerPixel) & textureMask;
+            texelY = (int)(cameraV + distance * 2000.0f) & textureMask;
+
+            feedback[y * width + x] = PackFeedback(mip, (texelX >> mip) / VT_PAGE_SIZE, (texelY >> mip) / VT_PAGE_SIZE);
+        }
+    }
+
+    return;
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+using namespace std;
+
+const int VT_PAGE_SIZE = 128;
+const int VT_PAGE_BORDER = 4;
+const int VT_PAGE_TEXELS = VT_PAGE_SIZE + 2 * VT_PAGE_BORDER;
+const int VT_MAX_MIPS = 13;
+const int VT_MAX_LOADS = 32;
+const int VT_QUEUE_CAPACITY = 256;
+const unsigned int VT_FEEDBACK_NONE = 0xffffffff;
+
+// Fills one page, border included, as RGBA8 rows of the given pitch. Called on the loader thread
+typedef bool (*VirtualPageLoadFunction)(int, int, int, unsigned char*, int, void*);
+
+// A page the last Update put in the cache, to be copied into the physical
+// texture at slot x, slot y. The texels stay valid until the next Update
+struct VirtualPageUploadType
+{
+    int slotX, slotY;
+    const unsigned char* texels;
+    int pitch;
+};
+
+// What the last Update did
+struct VirtualTextureStatsType
+{
+    int feedbackCount, uniquePages;
+    int missingPages, queuedPages;
+    int loadsCompleted, loadsDropped;
+    int evictions;
+    int residentPages;
+    float fallbackMips;
+    long long reduceNanoseconds, updateNanoseconds;
+};
+
+// Pages of a texture far bigger than memory are kept in a fixed physical cache
+// of page slots, and a page table per mip tells the shader which slot to read
+// for every page, falling back to the finest ancestor that is resident. Each
+// frame the renderer writes the (mip, page) it wanted for every feedback pixel,
+// packed by PackFeedback. Update folds that into the unique pages, touches the
+// ones that are resident, and asks the loader thread for the missing ones one
+// level finer than what is shown now, the pages covering the most pixels and
+// furthest from their mip first. At most loadsPerFrame loaded pages are put in
+// the cache each frame, over the least recently used ones, so the cost of a
+// frame is bounded however much the view changes. The physical texture itself
+// lives on the GPU, the class only says which slots to upload. The coarsest mip
+// is loaded up front and never evicted, so every lookup resolves. Page table
+// entries are RGBA8: slot x, slot y, resident mip, 255.
+class VirtualTextureClass
+{
+private:
+    enum LoadStateType
+    {
+        LOAD_FREE,
+        LOAD_BUSY,
+        LOAD_READY,
+        LOAD_UPLOADING
+    };
+
+    struct SlotType
+    {
+        unsigned int key;
+        unsigned int lastUsedFrame;
+        int previous, next;
+        int chain;
+        bool pinned;
+    };
+
+    struct LoadType
+    {
+        unsigned int key;
+        LoadStateType state;
+        unsigned char* texels;
+    };
+
+    struct PageSetType
+    {
+        unsigned int* keys;
+        unsigned int* values;
+        int* used;
+        int usedCount;
+        int bits;
+    };
+
+    struct CandidateType
+    {
+        unsigned int key;
+        unsigned int priority;
+    };
+
+public:
+    VirtualTextureClass();
+    VirtualTextureClass(const VirtualTextureClass&);
+    ~VirtualTextureClass();
+
+    bool Initialize(int, int, int, int, int, int, VirtualPageLoadFunction, void*);
+    void Shutdown();
+
+    bool Update(const unsigned int*, int);
+    void WaitForLoads();
+
+    int GetMipCount();
+    int GetWidthInPages(int);
+    int GetHeightInPages(int);
+    const unsigned int* GetPageTable(int);
+    int GetCacheWidth();
+    int GetCacheHeight();
+    const VirtualPageUploadType* GetUploads(int&);
+    VirtualTextureStatsType GetStats();
+    int CheckPageTable();
+
+    static unsigned int PackFeedback(int, int, int);
+    static bool RunSimulation(char*);
+
+private:
+    bool LoadPinnedPages();
+    void FinishLoads();
+    void ReduceFeedback(const unsigned int*, int);
+    void FindMissingPages();
+    void QueueLoads();
+    int FindSlot(unsigned int);
+    int AllocateSlot();
+    void PlacePage(int, unsigned int, const unsigned char*);
+    void MapPage(int, unsigned int);
+    void UnmapPage(unsigned int);
+    void SetEntries(int, int, int, int, unsigned int, bool);
+    void Touch(int);
+    void Unlink(int);
+    void PushFront(int);
+    void WorkerThread();
+
+    static bool InitializeSet(PageSetType&, int);
+    static void ReleaseSet(PageSetType&);
+    static void ClearSet(PageSetType&);
+    static void AddToSet(PageSetType&, unsigned int, unsigned int);
+    static bool SimulationPage(int, int, int, unsigned char*, int, void*);
+    static void BuildSimulationFeedback(unsigned int*, int, int, float, float, int, int);
+
+private:
+    int m_widthInPages, m_heightInPages;
+    int m_mipCount;
+    unsigned int* m_pageTables[VT_MAX_MIPS];
+
+    int m_cacheWidth, m_cacheHeight;
+    SlotType* m_slots;
+    int m_slotCount, m_slotsUsed;
+    int m_head, m_tail;
+    int* m_buckets;
+    unsigned int m_bucketMask;
+    VirtualPageUploadType m_uploads[VT_MAX_LOADS];
+    int m_uploadCount;
+
+    PageSetType m_feedbackPages, m_missingPages;
+    CandidateType* m_candidates;
+    int m_candidateCount;
+
+    int m_loadsPerFrame;
+    VirtualPageLoadFunction m_loadPage;
+    void* m_userData;
+    unsigned int m_frame;
+    VirtualTextureStatsType m_stats;
+
+    thread m_thread;
+    mutex m_mutex;
+    condition_variable m_queueCondition;
+    condition_variable m_loadCondition;
+    LoadType m_loads[VT_MAX_LOADS];
+    unsigned int m_queue[VT_QUEUE_CAPACITY];
+    int m_queueCount;
+    bool m_quit;
+};
\ No newline at end of file
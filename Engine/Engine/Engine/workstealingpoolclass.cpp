@@ -0,0 +1,250 @@
+#include "workstealingpoolclass.h"
+
+WorkStealingPoolClass::WorkStealingPoolClass()
+{
+    m_workerCount = 0;
+    m_threads = 0;
+    m_queues = 0;
+
+    m_function = 0;
+    m_userData = 0;
+    m_generation = 0;
+    m_pending = 0;
+    m_quit = false;
+
+    m_stealCount = 0;
+}
+
+WorkStealingPoolClass::WorkStealingPoolClass(const WorkStealingPoolClass& other)
+{
+
+}
+
+WorkStealingPoolClass::~WorkStealingPoolClass()
+{
+
+}
+
+bool WorkStealingPoolClass::Initialize(int workerCount)
+{
+    int i;
+
+    if (workerCount < 1)
+        return false;
+
+    m_workerCount = workerCount;
+    m_quit = false;
+
+    m_queues = new QueueType[m_workerCount];
+    if (!m_queues)
+        return false;
+
+    for (i = 0; i < m_workerCount; i++)
+    {
+        m_queues[i].tasks = 0;
+        m_queues[i].head = 0;
+        m_queues[i].tail = 0;
+        m_queues[i].capacity = 0;
+    }
+
+    // The calling thread works as worker 0
+    if (m_workerCount > 1)
+    {
+        m_threads = new std::thread[m_workerCount - 1];
+        if (!m_threads)
+            return false;
+
+        for (i = 1; i < m_workerCount; i++)
+            m_threads[i - 1] = std::thread(&WorkStealingPoolClass::WorkerThread, this, i);
+    }
+
+    return true;
+}
+
+void WorkStealingPoolClass::Shutdown()
+{
+    int i;
+
+    if (m_threads)
+    {
+        // Wake the workers up and let them leave their loop
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_startCondition.notify_all();
+
+        for (i = 0; i < m_workerCount - 1; i++)
+        {
+            if (m_threads[i].joinable())
+                m_threads[i].join();
+        }
+
+        delete[] m_threads;
+        m_threads = 0;
+    }
+
+    if (m_queues)
+    {
+        for (i = 0; i < m_workerCount; i++)
+        {
+            if (m_queues[i].tasks)
+                delete[] m_queues[i].tasks;
+        }
+
+        delete[] m_queues;
+        m_queues = 0;
+    }
+
+    m_workerCount = 0;
+
+    return;
+}
+
+bool WorkStealingPoolClass::Run(int taskCount, PoolTaskFunction function, void* userData)
+{
+    int i, capacity;
+
+    if (taskCount <= 0)
+        return true;
+
+    // Deal the tasks out while the workers are asleep
+    capacity = (taskCount + m_workerCount - 1) / m_workerCount;
+    for (i = 0; i < m_workerCount; i++)
+    {
+        if (m_queues[i].capacity < capacity)
+        {
+            if (m_queues[i].tasks)
+                delete[] m_queues[i].tasks;
+
+            m_queues[i].tasks = new int[capacity];
+            if (!m_queues[i].tasks)
+            {
+                m_queues[i].capacity = 0;
+                return false;
+            }
+
+            m_queues[i].capacity = capacity;
+        }
+
+        m_queues[i].head = 0;
+        m_queues[i].tail = 0;
+    }
+
+    for (i = 0; i < taskCount; i++)
+    {
+        m_queues[i % m_workerCount].tasks[m_queues[i % m_workerCount].tail] = i;
+        m_queues[i % m_workerCount].tail++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_function = function;
+        m_userData = userData;
+        m_pending = m_workerCount - 1;
+        m_generation++;
+    }
+    m_startCondition.notify_all();
+
+    RunWorker(0);
+
+    // Wait until every worker has found all queues empty
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_pending == 0; });
+        m_function = 0;
+        m_userData = 0;
+    }
+
+    return true;
+}
+
+int WorkStealingPoolClass::GetWorkerCount()
+{
+    return m_workerCount;
+}
+
+unsigned int WorkStealingPoolClass::GetStealCount()
+{
+    return m_stealCount;
+}
+
+void WorkStealingPoolClass::WorkerThread(int worker)
+{
+    unsigned int generation;
+
+    generation = 0;
+
+    PROFILE_THREAD("Pool worker");
+
+    while (true)
+    {
+        // Sleep until there is a new batch or we are shutting down
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, generation] { return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+            generation = m_generation;
+        }
+
+        RunWorker(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+void WorkStealingPoolClass::RunWorker(int worker)
+{
+    int task;
+
+    PROFILE_ZONE("Pool tasks");
+
+    // Own queue first, then help the others
+    while (PopTask(worker, task) || StealTask(worker, task))
+        m_function(task, worker, m_userData);
+
+    return;
+}
+
+bool WorkStealingPoolClass::PopTask(int worker, int& task)
+{
+    QueueType& queue = m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.head == queue.tail)
+        return false;
+
+    task = queue.tasks[queue.head];
+    queue.head++;
+
+    return true;
+}
+
+bool WorkStealingPoolClass::StealTask(int worker, int& task)
+{
+    int i, victim;
+
+    for (i = 1; i < m_workerCount; i++)
+    {
+        victim = (worker + i) % m_workerCount;
+
+        QueueType& queue = m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        // Take from the far end, the owner keeps working from the front
+        if (queue.head != queue.tail)
+        {
+            queue.tail--;
+            task = queue.tasks[queue.tail];
+            m_stealCount++;
+            return true;
+        }
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "profilerclass.h"
+
+typedef void (*PoolTaskFunction)(int, int, void*);
+
+// Runs a batch of independent tasks on a fixed set of threads. Tasks are dealt
+// out round robin, a worker that runs out takes from the back of another
+// worker's queue so uneven tasks still finish together.
+class WorkStealingPoolClass
+{
+private:
+    struct QueueType
+    {
+        std::mutex mutex;
+        int* tasks;
+        int head, tail, capacity;
+    };
+
+public:
+    WorkStealingPoolClass();
+    WorkStealingPoolClass(const WorkStealingPoolClass&);
+    ~WorkStealingPoolClass();
+
+    bool Initialize(int);
+    void Shutdown();
+
+    bool Run(int, PoolTaskFunction, void*);
+
+    int GetWorkerCount();
+    unsigned int GetStealCount();
+
+private:
+    void WorkerThread(int);
+    void RunWorker(int);
+    bool PopTask(int, int&);
+    bool StealTask(int, int&);
+
+private:
+    int m_workerCount;
+    std::thread* m_threads;
+    QueueType* m_queues;
+
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+
+    PoolTaskFunction m_function;
+    void* m_userData;
+    unsigned int m_generation;
+    int m_pending;
+    bool m_quit;
+
+    std::atomic<unsigned int> m_stealCount;
+};
\ No newline at end of file
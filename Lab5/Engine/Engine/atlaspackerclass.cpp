@@ -0,0 +1,651 @@
+#include "atlaspackerclass.h"
+
+// Offsets into the DDS header, after the four byte magic number
+const int DDS_HEADER_SIZE = 124;
+const int DDS_HEIGHT_OFFSET = 8;
+const int DDS_WIDTH_OFFSET = 12;
+const int DDS_PIXEL_FLAGS_OFFSET = 76;
+const int DDS_BIT_COUNT_OFFSET = 84;
+const int DDS_MASK_OFFSET = 88;
+const unsigned int DDS_HEADER_FLAGS = 0x100f;
+const unsigned int DDS_PIXEL_FOURCC = 0x4;
+const unsigned int DDS_PIXEL_RGB = 0x40;
+const unsigned int DDS_PIXEL_ALPHA = 0x1;
+const unsigned int DDS_CAPS_TEXTURE = 0x1000;
+
+AtlasPackerClass::AtlasPackerClass()
+{
+    m_output[0] = 0;
+    m_pageSize = ATLAS_DEFAULT_PAGE_SIZE;
+    m_padding = ATLAS_DEFAULT_PADDING;
+    m_sprites = 0;
+    m_spriteCount = 0;
+    m_spriteCapacity = 0;
+    m_pageCount = 0;
+}
+
+AtlasPackerClass::AtlasPackerClass(const AtlasPackerClass& other)
+{
+
+}
+
+AtlasPackerClass::~AtlasPackerClass()
+{
+
+}
+
+bool AtlasPackerClass::Initialize(char* manifestFilename)
+{
+    bool result;
+
+    m_sprites = new SpriteType[ATLAS_SPRITE_CAPACITY];
+    if (!m_sprites)
+        return false;
+
+    m_spriteCount = 0;
+    m_spriteCapacity = ATLAS_SPRITE_CAPACITY;
+    m_pageCount = 0;
+
+    // Reads every sprite image as well
+    result = ReadManifest(manifestFilename);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+void AtlasPackerClass::Shutdown()
+{
+    int i;
+
+    for (i = 0; i < m_pageCount; i++)
+    {
+        if (m_pages[i].freeRects)
+            delete[] m_pages[i].freeRects;
+        m_pages[i].freeRects = 0;
+    }
+    m_pageCount = 0;
+
+    if (m_sprites)
+    {
+        for (i = 0; i < m_spriteCount; i++)
+        {
+            if (m_sprites[i].pixels)
+                delete[] m_sprites[i].pixels;
+        }
+
+        delete[] m_sprites;
+        m_sprites = 0;
+    }
+    m_spriteCount = 0;
+    m_spriteCapacity = 0;
+
+    return;
+}
+
+bool AtlasPackerClass::Pack()
+{
+    char filename[ATLAS_MAX_PATH + 16];
+    int* order;
+    SpriteType* sprite;
+    RectType rect, bestRect;
+    int i, page, bestPage, shortSide, longSide, bestShort, bestLong;
+    bool result;
+
+    if (m_spriteCount == 0)
+        return false;
+
+    order = new int[m_spriteCount];
+    if (!order)
+        return false;
+
+    // Biggest first leaves the small ones to fill the gaps
+    for (i = 0; i < m_spriteCount; i++)
+        order[i] = i;
+
+    sort(order, order + m_spriteCount, [this](int a, int b)
+    {
+        int sideA, sideB;
+
+        sideA = max(m_sprites[a].width, m_sprites[a].height);
+        sideB = max(m_sprites[b].width, m_sprites[b].height);
+        if (sideA != sideB)
+            return sideA > sideB;
+
+        return m_sprites[a].width * m_sprites[a].height > m_sprites[b].width * m_sprites[b].height;
+    });
+
+    result = true;
+    for (i = 0; (i < m_spriteCount) && result; i++)
+    {
+        sprite = &m_sprites[order[i]];
+
+        // The best fit over every open page
+        bestPage = -1;
+        bestShort = m_pageSize + 1;
+        bestLong = m_pageSize + 1;
+        for (page = 0; page < m_pageCount; page++)
+        {
+            if (FindPosition(m_pages[page], sprite->width + 2 * m_padding, sprite->height + 2 * m_padding, rect, shortSide, longSide) &&
+                ((shortSide < bestShort) || ((shortSide == bestShort) && (longSide < bestLong))))
+            {
+                bestPage = page;
+                bestRect = rect;
+                bestShort = shortSide;
+                bestLong = longSide;
+            }
+        }
+
+        // Nothing fits, so it goes on a new page or doesn't go at all
+        if (bestPage < 0)
+        {
+            result = AddPage();
+            if (!result)
+                break;
+
+            bestPage = m_pageCount - 1;
+            result = FindPosition(m_pages[bestPage], sprite->width + 2 * m_padding, sprite->height + 2 * m_padding, bestRect, shortSide, longSide);
+            if (!result)
+                break;
+        }
+
+        result = PlaceRect(m_pages[bestPage], bestRect);
+
+        sprite->page = bestPage;
+        sprite->x = bestRect.x + m_padding;
+        sprite->y = bestRect.y + m_padding;
+    }
+
+    delete[] order;
+
+    if (!result)
+        return false;
+
+    for (i = 0; i < m_pageCount; i++)
+    {
+        sprintf(filename, "%s%d.dds", m_output, i);
+        result = WritePage(i, filename);
+        if (!result)
+            return false;
+    }
+
+    sprintf(filename, "%s.atlas", m_output);
+    result = WriteAtlasFile(filename);
+    if (!result)
+        return false;
+
+    return true;
+}
+
+int AtlasPackerClass::GetPageCount()
+{
+    return m_pageCount;
+}
+
+// The command line entry point
+bool AtlasPackerClass::PackAtlas(char* manifestFilename)
+{
+    AtlasPackerClass packer;
+    bool result;
+
+    result = packer.Initialize(manifestFilename);
+    if (result)
+        result = packer.Pack();
+
+    packer.Shutdown();
+
+    return result;
+}
+
+bool AtlasPackerClass::ReadManifest(char* filename)
+{
+    ifstream fin;
+    char line[ATLAS_MAX_PATH + ATLAS_MAX_NAME + 16], name[ATLAS_MAX_NAME], path[ATLAS_MAX_PATH];
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    while (fin.getline(line, sizeof(line)))
+    {
+        if ((line[0] == '#') || (line[0] == 0) || (line[0] == '\r'))
+            continue;
+
+        if (sscanf(line, "output %259[^\r\n]", m_output) == 1)
+            continue;
+
+        if ((sscanf(line, "page %d", &m_pageSize) == 1) || (sscanf(line, "padding %d", &m_padding) == 1))
+            continue;
+
+        if (sscanf(line, "sprite %63s %259[^\r\n]", name, path) == 2)
+        {
+            if (!AddSprite(name, path))
+                return false;
+            continue;
+        }
+
+        return false;
+    }
+
+    fin.close();
+
+    if ((m_output[0] == 0) || (m_pageSize < 16) || (m_padding < 0))
+        return false;
+
+    return true;
+}
+
+bool AtlasPackerClass::AddSprite(char* name, char* filename)
+{
+    SpriteType* sprites;
+    SpriteType* sprite;
+
+    if (m_spriteCount == m_spriteCapacity)
+    {
+        sprites = new SpriteType[m_spriteCapacity * 2];
+        if (!sprites)
+            return false;
+
+        memcpy(sprites, m_sprites, sizeof(SpriteType) * m_spriteCount);
+        delete[] m_sprites;
+        m_sprites = sprites;
+        m_spriteCapacity *= 2;
+    }
+
+    sprite = &m_sprites[m_spriteCount];
+    strcpy(sprite->name, name);
+    strcpy(sprite->filename, filename);
+    sprite->page = -1;
+    sprite->x = 0;
+    sprite->y = 0;
+
+    sprite->pixels = ReadImage(filename, sprite->width, sprite->height);
+    if (!sprite->pixels)
+        return false;
+
+    m_spriteCount++;
+
+    return true;
+}
+
+// A new page starts as one free rectangle
+bool AtlasPackerClass::AddPage()
+{
+    PageType* page;
+    RectType rect;
+
+    if (m_pageCount == ATLAS_MAX_PAGES)
+        return false;
+
+    page = &m_pages[m_pageCount];
+    page->freeRects = new RectType[ATLAS_RECT_CAPACITY];
+    if (!page->freeRects)
+        return false;
+
+    page->freeCount = 0;
+    page->freeCapacity = ATLAS_RECT_CAPACITY;
+    page->usedWidth = 0;
+    page->usedHeight = 0;
+    m_pageCount++;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = m_pageSize;
+    rect.height = m_pageSize;
+
+    return AddFreeRect(*page, rect);
+}
+
+// Best short side fit, the free rectangle that leaves the least over on its tighter side
+bool AtlasPackerClass::FindPosition(PageType& page, int width, int height, RectType& rect, int& bestShort, int& bestLong)
+{
+    RectType* freeRect;
+    int i, shortSide, longSide;
+    bool found;
+
+    found = false;
+    bestShort = m_pageSize + 1;
+    bestLong = m_pageSize + 1;
+
+    for (i = 0; i < page.freeCount; i++)
+    {
+        freeRect = &page.freeRects[i];
+        if ((freeRect->width < width) || (freeRect->height < height))
+            continue;
+
+        shortSide = min(freeRect->width - width, freeRect->height - height);
+        longSide = max(freeRect->width - width, freeRect->height - height);
+        if ((shortSide < bestShort) || ((shortSide == bestShort) && (longSide < bestLong)))
+        {
+            rect.x = freeRect->x;
+            rect.y = freeRect->y;
+            rect.width = width;
+            rect.height = height;
+            bestShort = shortSide;
+            bestLong = longSide;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// Every free rectangle the new one overlaps is split into the parts around it
+bool AtlasPackerClass::PlaceRect(PageType& page, const RectType& used)
+{
+    RectType freeRect, part;
+    int i;
+
+    i = 0;
+    while (i < page.freeCount)
+    {
+        freeRect = page.freeRects[i];
+        if ((used.x >= freeRect.x + freeRect.width) || (used.x + used.width <= freeRect.x) ||
+            (used.y >= freeRect.y + freeRect.height) || (used.y + used.height <= freeRect.y))
+        {
+            i++;
+            continue;
+        }
+
+        // Parts never overlap the used rectangle, so they're skipped when the loop reaches them
+        page.freeRects[i] = page.freeRects[page.freeCount - 1];
+        page.freeCount--;
+
+        if (used.x > freeRect.x)
+        {
+            part = freeRect;
+            part.width = used.x - freeRect.x;
+            if (!AddFreeRect(page, part))
+                return false;
+        }
+
+        if (used.x + used.width < freeRect.x + freeRect.width)
+        {
+            part = freeRect;
+            part.x = used.x + used.width;
+            part.width = freeRect.x + freeRect.width - part.x;
+            if (!AddFreeRect(page, part))
+                return false;
+        }
+
+        if (used.y > freeRect.y)
+        {
+            part = freeRect;
+            part.height = used.y - freeRect.y;
+            if (!AddFreeRect(page, part))
+                return false;
+        }
+
+        if (used.y + used.height < freeRect.y + freeRect.height)
+        {
+            part = freeRect;
+            part.y = used.y + used.height;
+            part.height = freeRect.y + freeRect.height - part.y;
+            if (!AddFreeRect(page, part))
+                return false;
+        }
+    }
+
+    PruneFreeRects(page);
+
+    page.usedWidth = max(page.usedWidth, used.x + used.width);
+    page.usedHeight = max(page.usedHeight, used.y + used.height);
+
+    return true;
+}
+
+bool AtlasPackerClass::AddFreeRect(PageType& page, const RectType& rect)
+{
+    RectType* rects;
+
+    if (page.freeCount == page.freeCapacity)
+    {
+        rects = new RectType[page.freeCapacity * 2];
+        if (!rects)
+            return false;
+
+        memcpy(rects, page.freeRects, sizeof(RectType) * page.freeCount);
+        delete[] page.freeRects;
+        page.freeRects = rects;
+        page.freeCapacity *= 2;
+    }
+
+    page.freeRects[page.freeCount] = rect;
+    page.freeCount++;
+
+    return true;
+}
+
+// Drops free rectangles that lie inside another one
+void AtlasPackerClass::PruneFreeRects(PageType& page)
+{
+    RectType *a, *b;
+    int i, j;
+
+    for (i = 0; i < page.freeCount; i++)
+    {
+        for (j = 0; j < page.freeCount; j++)
+        {
+            if (i == j)
+                continue;
+
+            a = &page.freeRects[i];
+            b = &page.freeRects[j];
+            if ((a->x >= b->x) && (a->y >= b->y) && (a->x + a->width <= b->x + b->width) && (a->y + a->height <= b->y + b->height))
+            {
+                page.freeRects[i] = page.freeRects[page.freeCount - 1];
+                page.freeCount--;
+                i--;
+                break;
+            }
+        }
+    }
+
+    return;
+}
+
+// Crops the page to what it uses, rounded up to four pixels
+bool AtlasPackerClass::WritePage(int index, char* filename)
+{
+    ofstream fout;
+    unsigned int header[DDS_HEADER_SIZE / 4];
+    unsigned int* pixels;
+    SpriteType* sprite;
+    int width, height, i, x, y, sourceX, sourceY;
+
+    width = (m_pages[index].usedWidth + 3) & ~3;
+    height = (m_pages[index].usedHeight + 3) & ~3;
+
+    pixels = new unsigned int[width * height];
+    if (!pixels)
+        return false;
+
+    memset(pixels, 0, sizeof(unsigned int) * width * height);
+
+    // Copies each sprite with its edge pixels repeated out into the padding
+    for (i = 0; i < m_spriteCount; i++)
+    {
+        sprite = &m_sprites[i];
+        if (sprite->page != index)
+            continue;
+
+        for (y = -m_padding; y < sprite->height + m_padding; y++)
+        {
+            sourceY = min(max(y, 0), sprite->height - 1);
+            for (x = -m_padding; x < sprite->width + m_padding; x++)
+            {
+                sourceX = min(max(x, 0), sprite->width - 1);
+                pixels[(sprite->y + y) * width + sprite->x + x] = sprite->pixels[sourceY * sprite->width + sourceX];
+            }
+        }
+    }
+
+    // A8R8G8B8, the same layout as the textures the labs already load
+    memset(header, 0, sizeof(header));
+    header[0] = DDS_HEADER_SIZE;
+    header[1] = DDS_HEADER_FLAGS;
+    header[2] = height;
+    header[3] = width;
+    header[4] = width * 4;
+    header[18] = 32;
+    header[19] = DDS_PIXEL_RGB | DDS_PIXEL_ALPHA;
+    header[21] = 32;
+    header[22] = 0x00ff0000;
+    header[23] = 0x0000ff00;
+    header[24] = 0x000000ff;
+    header[25] = 0xff000000;
+    header[26] = DDS_CAPS_TEXTURE;
+
+    fout.open(filename, ios::out | ios::binary);
+    if (fout.fail())
+    {
+        delete[] pixels;
+        return false;
+    }
+
+    fout.write("DDS ", 4);
+    fout.write((const char*)header, sizeof(header));
+    fout.write((const char*)pixels, sizeof(unsigned int) * width * height);
+
+    delete[] pixels;
+
+    if (fout.fail())
+        return false;
+
+    fout.close();
+
+    // The atlas file needs the cropped size for the texture coordinates
+    m_pages[index].usedWidth = width;
+    m_pages[index].usedHeight = height;
+
+    return true;
+}
+
+// The format SpriteBatchClass reads:
+//   pages <count>
+//   <page texture filename>
+//   sprites <count>
+//   <name> <page> <left> <top> <right> <bottom> <width> <height>
+bool AtlasPackerClass::WriteAtlasFile(char* filename)
+{
+    ofstream fout;
+    SpriteType* sprite;
+    PageType* page;
+    int i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    fout.precision(8);
+
+    fout << "pages " << m_pageCount << endl;
+    for (i = 0; i < m_pageCount; i++)
+        fout << m_output << i << ".dds" << endl;
+
+    fout << "sprites " << m_spriteCount << endl;
+    for (i = 0; i < m_spriteCount; i++)
+    {
+        sprite = &m_sprites[i];
+        page = &m_pages[sprite->page];
+        fout << sprite->name << " " << sprite->page << " " << (float)sprite->x / page->usedWidth << " " << (float)sprite->y / page->usedHeight << " " <<
+            (float)(sprite->x + sprite->width) / page->usedWidth << " " << (float)(sprite->y + sprite->height) / page->usedHeight << " " <<
+            sprite->width << " " << sprite->height << endl;
+    }
+
+    if (fout.fail())
+        return false;
+
+    fout.close();
+
+    return true;
+}
+
+// Reads an uncompressed DDS file into A8R8G8B8 pixels
+unsigned int* AtlasPackerClass::ReadImage(char* filename, int& width, int& height)
+{
+    ifstream fin;
+    char magic[4];
+    unsigned char header[DDS_HEADER_SIZE];
+    unsigned char* row;
+    unsigned int* pixels;
+    unsigned int pixelFlags, bitCount, bytesPerPixel, masks[4], pixel, x, y, i;
+
+    fin.open(filename, ios::in | ios::binary);
+    if (fin.fail())
+        return 0;
+
+    fin.read(magic, 4);
+    fin.read((char*)header, DDS_HEADER_SIZE);
+    if (fin.fail() || (memcmp(magic, "DDS ", 4) != 0))
+        return 0;
+
+    memcpy(&height, &header[DDS_HEIGHT_OFFSET], 4);
+    memcpy(&width, &header[DDS_WIDTH_OFFSET], 4);
+    memcpy(&pixelFlags, &header[DDS_PIXEL_FLAGS_OFFSET], 4);
+    memcpy(&bitCount, &header[DDS_BIT_COUNT_OFFSET], 4);
+    memcpy(masks, &header[DDS_MASK_OFFSET], 16);
+
+    // Block compressed sprites would have to be decoded first
+    if ((pixelFlags & DDS_PIXEL_FOURCC) || !(pixelFlags & DDS_PIXEL_RGB))
+        return 0;
+
+    if (((bitCount != 16) && (bitCount != 24) && (bitCount != 32)) || (width <= 0) || (height <= 0))
+        return 0;
+
+    // Without the alpha flag the mask means nothing
+    if (!(pixelFlags & DDS_PIXEL_ALPHA))
+        masks[3] = 0;
+
+    bytesPerPixel = bitCount / 8;
+
+    pixels = new unsigned int[width * height];
+    row = new unsigned char[width * bytesPerPixel];
+    if (!pixels || !row)
+        return 0;
+
+    for (y = 0; y < (unsigned int)height; y++)
+    {
+        fin.read((char*)row, width * bytesPerPixel);
+        if (fin.fail())
+        {
+            delete[] row;
+            delete[] pixels;
+            return 0;
+        }
+
+        for (x = 0; x < (unsigned int)width; x++)
+        {
+            pixel = 0;
+            for (i = 0; i < bytesPerPixel; i++)
+                pixel |= (unsigned int)row[x * bytesPerPixel + i] << (i * 8);
+
+            pixels[y * width + x] = (ConvertChannel(pixel, masks[0]) << 16) | (ConvertChannel(pixel, masks[1]) << 8) |
+                ConvertChannel(pixel, masks[2]) | ((masks[3] ? ConvertChannel(pixel, masks[3]) : 0xff) << 24);
+        }
+    }
+
+    delete[] row;
+    fin.close();
+
+    return pixels;
+}
+
+// Scales a channel under any mask to eight bits
+unsigned int AtlasPackerClass::ConvertChannel(unsigned int pixel, unsigned int mask)
+{
+    unsigned int value, maximum;
+
+    if (mask == 0)
+        return 0;
+
+    value = pixel & mask;
+    maximum = mask;
+    while (!(maximum & 1))
+    {
+        value >>= 1;
+        maximum >>= 1;
+    }
+
+    return (value * 255 + maximum / 2) / maximum;
+}
\ No newline at end of file
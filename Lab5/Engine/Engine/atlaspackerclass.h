@@ -0,0 +1,88 @@
+#pragma once
+
+#include <fstream>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+using namespace std;
+
+const int ATLAS_MAX_PATH = 260;
+const int ATLAS_MAX_NAME = 64;
+const int ATLAS_DEFAULT_PAGE_SIZE = 1024;
+const int ATLAS_DEFAULT_PADDING = 1;
+const int ATLAS_MAX_PAGES = 16;
+const int ATLAS_SPRITE_CAPACITY = 64;
+const int ATLAS_RECT_CAPACITY = 64;
+
+// Packs sprite images into as few atlas pages as it can, for SpriteBatchClass.
+// The manifest lists the sprites and where the atlas goes:
+//   page 1024
+//   padding 1
+//   sprite seafloor ../Engine/data/seafloor.dds
+//   output ../Engine/data/sprites
+// Placement is MaxRects with the best short side fit, biggest sprites first,
+// and a new page is started when a sprite fits on none of the open ones. Each
+// sprite's edge pixels are repeated into its padding so filtering never pulls
+// in a neighbour. Pages are cropped to what they use and written as 32 bit DDS
+// files next to a .atlas file of sprite rectangles.
+class AtlasPackerClass
+{
+private:
+    struct RectType
+    {
+        int x, y, width, height;
+    };
+
+    struct SpriteType
+    {
+        char name[ATLAS_MAX_NAME];
+        char filename[ATLAS_MAX_PATH];
+        unsigned int* pixels;
+        int width, height;
+        int page, x, y;
+    };
+
+    struct PageType
+    {
+        RectType* freeRects;
+        int freeCount, freeCapacity;
+        int usedWidth, usedHeight;
+    };
+
+public:
+    AtlasPackerClass();
+    AtlasPackerClass(const AtlasPackerClass&);
+    ~AtlasPackerClass();
+
+    bool Initialize(char*);
+    void Shutdown();
+    bool Pack();
+
+    int GetPageCount();
+
+    static bool PackAtlas(char*);
+
+private:
+    bool ReadManifest(char*);
+    bool AddSprite(char*, char*);
+    bool AddPage();
+    bool FindPosition(PageType&, int, int, RectType&, int&, int&);
+    bool PlaceRect(PageType&, const RectType&);
+    bool AddFreeRect(PageType&, const RectType&);
+    void PruneFreeRects(PageType&);
+    bool WritePage(int, char*);
+    bool WriteAtlasFile(char*);
+
+    static unsigned int* ReadImage(char*, int&, int&);
+    static unsigned int ConvertChannel(unsigned int, unsigned int);
+
+private:
+    char m_output[ATLAS_MAX_PATH];
+    int m_pageSize, m_padding;
+
+    SpriteType* m_sprites;
+    int m_spriteCount, m_spriteCapacity;
+
+    PageType m_pages[ATLAS_MAX_PAGES];
+    int m_pageCount;
+};
\ No newline at end of file
@@ -10,7 +10,8 @@ GraphicsClass::GraphicsClass()
 	m_LightShader = 0;
 	m_Light = 0;
     m_TextureShader = 0;
-    m_Bitmap = 0;
+    m_SpriteBatch = 0;
+    m_seafloorSprite = -1;
     m_Text = 0;
 }
 
@@ -117,17 +118,20 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
     m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
     m_Light->SetSpecularPower(32.0f);       // Lower power the greater the effect
 
-    m_Bitmap = new BitmapClass;
-    if (!m_Bitmap)
+    // Create the sprite batch, its atlas is made with -packatlas
+    m_SpriteBatch = new SpriteBatchClass;
+    if (!m_SpriteBatch)
         return false;
 
-    result = m_Bitmap->Initialize(m_D3D->GetDevice(), screenWidth, screenHeight, L"../Engine/data/seafloor.dds", 256, 256);
+    result = m_SpriteBatch->Initialize(m_D3D->GetDevice(), screenWidth, screenHeight, "../Engine/data/sprites.atlas");
     if (!result)
     {
-        MessageBox(hwnd, L"Could not initialize the bitmap object.", L"Error", MB_OK);
+        MessageBox(hwnd, L"Could not initialize the sprite batch object.", L"Error", MB_OK);
         return false;
     }
 
+    m_seafloorSprite = m_SpriteBatch->FindSprite("seafloor");
+
 	return true;
 }
 
@@ -140,11 +144,11 @@ void GraphicsClass::Shutdown()
         m_Text = 0;
     }
 
-    if (m_Bitmap)
+    if (m_SpriteBatch)
     {
-        m_Bitmap->Shutdown();
-        delete m_Bitmap;
-        m_Bitmap = 0;
+        m_SpriteBatch->Shutdown();
+        delete m_SpriteBatch;
+        m_SpriteBatch = 0;
     }
 
     if (m_TextureShader)
@@ -223,12 +227,11 @@ bool GraphicsClass::Render(float rotation)
     // Turn off the Z buffer to begin all 2D rendering
     m_D3D->TurnZBufferOff();
 
-    // Put bitmap vertex and index buffers on the graphics pipeline to prepare for drawing
-    result = m_Bitmap->Render(m_D3D->GetDeviceContext(), 100, 100);
-    if (!result)
-        return false;
+    // Queue the sprites, End draws them with one draw call per atlas page
+    m_SpriteBatch->Begin();
+    m_SpriteBatch->Draw(m_seafloorSprite, 100, 100);
 
-    result = m_TextureShader->Render(m_D3D->GetDeviceContext(), m_Bitmap->GetIndexCount(), worldMatrix, viewMatrix, orthoMatrix, m_Bitmap->GetTexture());
+    result = m_SpriteBatch->End(m_D3D->GetDeviceContext(), m_TextureShader, worldMatrix, viewMatrix, orthoMatrix);
     if (!result)
         return false;
 
@@ -5,7 +5,7 @@
 #include "lightshaderclass.h"
 #include "lightclass.h"
 #include "textureshaderclass.h"
-#include "bitmapclass.h"
+#include "spritebatchclass.h"
 #include "textclass.h"
 
 const bool FULL_SCREEN = false;
@@ -34,6 +34,7 @@ private:
 	LightShaderClass* m_LightShader;
 	LightClass* m_Light;
     TextureShaderClass* m_TextureShader;
-    BitmapClass* m_Bitmap;
+    SpriteBatchClass* m_SpriteBatch;
+    int m_seafloorSprite;
     TextClass* m_Text;
 };
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "systemclass.h"
+#include "atlaspackerclass.h"
+#include "shadercacheclass.h"
 
 int WINAPI WinMain
 	(HINSTANCE hInstance, HINSTANCE hPrevInstance,
@@ -7,6 +9,14 @@ int WINAPI WinMain
 	SystemClass* System;
 	bool result;
 
+	// Pack the sprite atlas from its manifest and exit
+	if (strstr(pScmdline, "-packatlas"))
+		return AtlasPackerClass::PackAtlas("sprites.txt") ? 0 : 1;
+
+	// Run the shader cache with a stand in compiler through hits, misses, edits and damaged files, then exit
+	if (strstr(pScmdline, "-shadercachetest"))
+		return ShaderCacheClass::RunTests("shader-cache-test.txt") ? 0 : 1;
+
 	System = new SystemClass;
 	if (!System)
 		return 0;
@@ -0,0 +1,402 @@
+#include "spritebatchclass.h"
+
+SpriteBatchClass::SpriteBatchClass()
+{
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_vertexCursor = 0;
+    m_pageCount = 0;
+    m_sprites = 0;
+    m_spriteCount = 0;
+    m_quads = 0;
+    m_order = 0;
+    m_quadCount = 0;
+    m_drawCount = 0;
+    m_drawnQuadCount = 0;
+}
+
+SpriteBatchClass::SpriteBatchClass(const SpriteBatchClass& other)
+{
+
+}
+
+SpriteBatchClass::~SpriteBatchClass()
+{
+
+}
+
+bool SpriteBatchClass::Initialize(ID3D11Device* device, int screenWidth, int screenHeight, char* atlasFilename)
+{
+    bool result;
+
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+
+    // Load the atlas pages and the sprite rectangles
+    result = LoadAtlas(device, atlasFilename);
+    if (!result)
+        return false;
+
+    // Queue of quads drawn since Begin and the order they are written in
+    m_quads = new QuadType[SPRITE_BATCH_CAPACITY];
+    if (!m_quads)
+        return false;
+
+    m_order = new int[SPRITE_BATCH_CAPACITY];
+    if (!m_order)
+        return false;
+
+    result = InitializeBuffers(device);
+    if (!result)
+        return false;
+
+    // So the first batch discards the buffer
+    m_vertexCursor = SPRITE_BATCH_CAPACITY;
+
+    return true;
+}
+
+void SpriteBatchClass::Shutdown()
+{
+    ShutdownBuffers();
+
+    if (m_order)
+    {
+        delete[] m_order;
+        m_order = 0;
+    }
+
+    if (m_quads)
+    {
+        delete[] m_quads;
+        m_quads = 0;
+    }
+
+    ReleaseAtlas();
+
+    return;
+}
+
+int SpriteBatchClass::FindSprite(char* name)
+{
+    int i;
+
+    for (i = 0; i < m_spriteCount; i++)
+    {
+        if (strcmp(m_sprites[i].name, name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+void SpriteBatchClass::Begin()
+{
+    m_quadCount = 0;
+
+    return;
+}
+
+// Draws the sprite at its own size with its top left corner at the position
+bool SpriteBatchClass::Draw(int sprite, int positionX, int positionY)
+{
+    if ((sprite < 0) || (sprite >= m_spriteCount))
+        return false;
+
+    return Draw(sprite, positionX, positionY, m_sprites[sprite].width, m_sprites[sprite].height);
+}
+
+// Returns false when the sprite is unknown or the batch is full
+bool SpriteBatchClass::Draw(int sprite, int positionX, int positionY, int width, int height)
+{
+    QuadType* quad;
+
+    if ((sprite < 0) || (sprite >= m_spriteCount) || (m_quadCount >= SPRITE_BATCH_CAPACITY))
+        return false;
+
+    // Screen coordinates with the origin in the middle, as BitmapClass does it
+    quad = &m_quads[m_quadCount++];
+    quad->sprite = sprite;
+    quad->left = (float)((m_screenWidth / 2) * -1) + (float)positionX;
+    quad->right = quad->left + (float)width;
+    quad->top = (float)(m_screenHeight / 2) - (float)positionY;
+    quad->bottom = quad->top - (float)height;
+
+    return true;
+}
+
+bool SpriteBatchClass::End(ID3D11DeviceContext* deviceContext, TextureShaderClass* textureShader, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX orthoMatrix)
+{
+    int pageStart[SPRITE_MAX_PAGES], pageCount[SPRITE_MAX_PAGES];
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    D3D11_MAP mapType;
+    VertexType* vertexPtr;
+    QuadType* quad;
+    SpriteType* sprite;
+    unsigned int stride, offset;
+    HRESULT result;
+    int i, page, firstQuad;
+
+    m_drawCount = 0;
+    m_drawnQuadCount = m_quadCount;
+
+    if (m_quadCount == 0)
+        return true;
+
+    // Counting sort by page so each page's quads sit together, in the order they were drawn
+    for (i = 0; i < m_pageCount; i++)
+        pageCount[i] = 0;
+
+    for (i = 0; i < m_quadCount; i++)
+        pageCount[m_sprites[m_quads[i].sprite].page]++;
+
+    pageStart[0] = 0;
+    for (i = 1; i < m_pageCount; i++)
+        pageStart[i] = pageStart[i - 1] + pageCount[i - 1];
+
+    for (i = 0; i < m_quadCount; i++)
+        m_order[pageStart[m_sprites[m_quads[i].sprite].page]++] = i;
+
+    // Carry on after the last batch while it fits, the GPU may still be reading what came before
+    if (m_vertexCursor + m_quadCount > SPRITE_BATCH_CAPACITY)
+    {
+        mapType = D3D11_MAP_WRITE_DISCARD;
+        m_vertexCursor = 0;
+    }
+    else
+    {
+        mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+    }
+
+    result = deviceContext->Map(m_vertexBuffer, 0, mapType, 0, &mappedResource);
+    if (FAILED(result))
+        return false;
+
+    // Written front to back, the mapped memory may be write combined
+    vertexPtr = (VertexType*)mappedResource.pData + m_vertexCursor * 4;
+    for (i = 0; i < m_quadCount; i++)
+    {
+        quad = &m_quads[m_order[i]];
+        sprite = &m_sprites[quad->sprite];
+
+        vertexPtr[0].position = D3DXVECTOR3(quad->left, quad->top, 0.0f);    // Top left
+        vertexPtr[0].texture = D3DXVECTOR2(sprite->left, sprite->top);
+
+        vertexPtr[1].position = D3DXVECTOR3(quad->right, quad->top, 0.0f);   // Top right
+        vertexPtr[1].texture = D3DXVECTOR2(sprite->right, sprite->top);
+
+        vertexPtr[2].position = D3DXVECTOR3(quad->left, quad->bottom, 0.0f); // Bottom left
+        vertexPtr[2].texture = D3DXVECTOR2(sprite->left, sprite->bottom);
+
+        vertexPtr[3].position = D3DXVECTOR3(quad->right, quad->bottom, 0.0f);    // Bottom right
+        vertexPtr[3].texture = D3DXVECTOR2(sprite->right, sprite->bottom);
+
+        vertexPtr += 4;
+    }
+
+    deviceContext->Unmap(m_vertexBuffer, 0);
+
+    stride = sizeof(VertexType);
+    offset = 0;
+
+    deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+    deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // One draw per page that has anything on it
+    firstQuad = 0;
+    for (page = 0; page < m_pageCount; page++)
+    {
+        if (pageCount[page] == 0)
+            continue;
+
+        result = textureShader->Render(deviceContext, pageCount[page] * 6, firstQuad * 6, m_vertexCursor * 4, worldMatrix, viewMatrix, orthoMatrix,
+            m_pages[page]->GetTexture());
+        if (!result)
+            return false;
+
+        firstQuad += pageCount[page];
+        m_drawCount++;
+    }
+
+    m_vertexCursor += m_quadCount;
+    m_quadCount = 0;
+
+    return true;
+}
+
+int SpriteBatchClass::GetDrawCount()
+{
+    return m_drawCount;
+}
+
+int SpriteBatchClass::GetQuadCount()
+{
+    return m_drawnQuadCount;
+}
+
+// Reads the .atlas file written by AtlasPackerClass and loads its pages
+bool SpriteBatchClass::LoadAtlas(ID3D11Device* device, char* filename)
+{
+    ifstream fin;
+    char path[SPRITE_MAX_PATH];
+    WCHAR widePath[SPRITE_MAX_PATH];
+    SpriteType* sprite;
+    bool result;
+    int i;
+
+    fin.open(filename);
+    if (fin.fail())
+        return false;
+
+    fin >> path >> m_pageCount;
+    if (fin.fail() || (strcmp(path, "pages") != 0) || (m_pageCount < 1) || (m_pageCount > SPRITE_MAX_PAGES))
+        return false;
+
+    for (i = 0; i < m_pageCount; i++)
+        m_pages[i] = 0;
+
+    for (i = 0; i < m_pageCount; i++)
+    {
+        fin >> path;
+        if (fin.fail())
+            return false;
+
+        mbstowcs(widePath, path, SPRITE_MAX_PATH);
+
+        m_pages[i] = new TextureClass;
+        if (!m_pages[i])
+            return false;
+
+        result = m_pages[i]->Initialize(device, widePath);
+        if (!result)
+            return false;
+    }
+
+    fin >> path >> m_spriteCount;
+    if (fin.fail() || (strcmp(path, "sprites") != 0) || (m_spriteCount < 0))
+        return false;
+
+    m_sprites = new SpriteType[m_spriteCount];
+    if (!m_sprites)
+        return false;
+
+    for (i = 0; i < m_spriteCount; i++)
+    {
+        sprite = &m_sprites[i];
+
+        fin >> path >> sprite->page >> sprite->left >> sprite->top >> sprite->right >> sprite->bottom >> sprite->width >> sprite->height;
+        if (fin.fail() || (sprite->page < 0) || (sprite->page >= m_pageCount))
+            return false;
+
+        strncpy(sprite->name, path, SPRITE_MAX_NAME - 1);
+        sprite->name[SPRITE_MAX_NAME - 1] = 0;
+    }
+
+    fin.close();
+
+    return true;
+}
+
+void SpriteBatchClass::ReleaseAtlas()
+{
+    int i;
+
+    if (m_sprites)
+    {
+        delete[] m_sprites;
+        m_sprites = 0;
+    }
+
+    for (i = 0; i < m_pageCount; i++)
+    {
+        if (m_pages[i])
+        {
+            m_pages[i]->Shutdown();
+            delete m_pages[i];
+            m_pages[i] = 0;
+        }
+    }
+
+    m_pageCount = 0;
+    m_spriteCount = 0;
+
+    return;
+}
+
+// Four vertices a quad in a dynamic buffer, the indices never change
+bool SpriteBatchClass::InitializeBuffers(ID3D11Device* device)
+{
+    unsigned long* indices;
+    D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+    D3D11_SUBRESOURCE_DATA indexData;
+    HRESULT result;
+    int i;
+
+    indices = new unsigned long[SPRITE_BATCH_CAPACITY * 6];
+    if (!indices)
+        return false;
+
+    // Top left, bottom right, bottom left then top left, top right, bottom right
+    for (i = 0; i < SPRITE_BATCH_CAPACITY; i++)
+    {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 3;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 1;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+
+    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    vertexBufferDesc.ByteWidth = sizeof(VertexType) * SPRITE_BATCH_CAPACITY * 4;
+    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    vertexBufferDesc.MiscFlags = 0;
+    vertexBufferDesc.StructureByteStride = 0;
+
+    result = device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
+    if (FAILED(result))
+    {
+        delete[] indices;
+        return false;
+    }
+
+    indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    indexBufferDesc.ByteWidth = sizeof(unsigned long) * SPRITE_BATCH_CAPACITY * 6;
+    indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    indexBufferDesc.CPUAccessFlags = 0;
+    indexBufferDesc.MiscFlags = 0;
+    indexBufferDesc.StructureByteStride = 0;
+
+    indexData.pSysMem = indices;
+    indexData.SysMemPitch = 0;
+    indexData.SysMemSlicePitch = 0;
+
+    result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+
+    delete[] indices;
+    indices = 0;
+
+    if (FAILED(result))
+        return false;
+
+    return true;
+}
+
+void SpriteBatchClass::ShutdownBuffers()
+{
+    if (m_indexBuffer)
+    {
+        m_indexBuffer->Release();
+        m_indexBuffer = 0;
+    }
+
+    if (m_vertexBuffer)
+    {
+        m_vertexBuffer->Release();
+        m_vertexBuffer = 0;
+    }
+
+    return;
+}
\ No newline at end of file
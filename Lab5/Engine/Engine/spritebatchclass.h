@@ -0,0 +1,86 @@
+#pragma once
+
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+#include "textureclass.h"
+#include "textureshaderclass.h"
+using namespace std;
+
+const int SPRITE_BATCH_CAPACITY = 4096;
+const int SPRITE_MAX_PAGES = 16;
+const int SPRITE_MAX_NAME = 64;
+const int SPRITE_MAX_PATH = 260;
+
+// Collects sprite quads between Begin and End and draws them out of one
+// dynamic vertex buffer with one draw per atlas page, however many sprites
+// there are. The sprites come from an atlas built by AtlasPackerClass. Sprites
+// on the same page keep the order they were drawn in, lower pages are drawn
+// first. Batches are written after each other with no-overwrite maps and the
+// buffer is only discarded once it is full.
+class SpriteBatchClass
+{
+private:
+    struct VertexType
+    {
+        D3DXVECTOR3 position;
+        D3DXVECTOR2 texture;
+    };
+
+    struct SpriteType
+    {
+        char name[SPRITE_MAX_NAME];
+        int page;
+        float left, top, right, bottom;
+        int width, height;
+    };
+
+    struct QuadType
+    {
+        int sprite;
+        float left, top, right, bottom;
+    };
+
+public:
+    SpriteBatchClass();
+    SpriteBatchClass(const SpriteBatchClass&);
+    ~SpriteBatchClass();
+
+    bool Initialize(ID3D11Device*, int, int, char*);
+    void Shutdown();
+
+    int FindSprite(char*);
+
+    void Begin();
+    bool Draw(int, int, int);
+    bool Draw(int, int, int, int, int);
+    bool End(ID3D11DeviceContext*, TextureShaderClass*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX);
+
+    int GetDrawCount();
+    int GetQuadCount();
+
+private:
+    bool LoadAtlas(ID3D11Device*, char*);
+    void ReleaseAtlas();
+    bool InitializeBuffers(ID3D11Device*);
+    void ShutdownBuffers();
+
+private:
+    ID3D11Buffer* m_vertexBuffer;
+    ID3D11Buffer* m_indexBuffer;
+    int m_vertexCursor;
+
+    TextureClass* m_pages[SPRITE_MAX_PAGES];
+    int m_pageCount;
+    SpriteType* m_sprites;
+    int m_spriteCount;
+
+    QuadType* m_quads;
+    int* m_order;
+    int m_quadCount;
+
+    int m_screenWidth, m_screenHeight;
+    int m_drawCount, m_drawnQuadCount;
+};
\ No newline at end of file
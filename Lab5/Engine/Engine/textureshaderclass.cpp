@@ -39,6 +39,12 @@ void TextureShaderClass::Shutdown()
 }
 
 bool TextureShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture)
+{
+    return Render(deviceContext, indexCount, 0, 0, worldMatrix, viewMatrix, projectionMatrix, texture);
+}
+
+// Draws a range of the bound index buffer, for batches that share one buffer between several draws
+bool TextureShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, int baseVertex, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture)
 {
     bool result;
 
@@ -48,7 +54,7 @@ bool TextureShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCou
         return false;
 
     // Render the buffers with the shader
-    RenderShader(deviceContext, indexCount);
+    RenderShader(deviceContext, indexCount, startIndex, baseVertex);
 
     return true;
 }
@@ -56,58 +62,39 @@ bool TextureShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCou
 bool TextureShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename)
 {
     HRESULT result;
-    ID3D10Blob* errorMessage;
-    ID3D10Blob* vertexShaderBuffer;
-    ID3D10Blob* pixelShaderBuffer;
+    ShaderCacheClass shaderCache;
+    ShaderBytecodeType vertexShaderBuffer;
+    ShaderBytecodeType pixelShaderBuffer;
     D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
     unsigned int numElements;
     D3D11_BUFFER_DESC matrixBufferDesc;
 
     D3D11_SAMPLER_DESC samplerDesc;
 
-    errorMessage = 0;
-    vertexShaderBuffer = 0;
-    pixelShaderBuffer = 0;
+    // Bytecode from an earlier run is reused, only changed shaders get compiled
+    if (!shaderCache.Initialize("shaders.cache", "shader-cache.txt", CompileShaderFile, hwnd))
+        return false;
 
     // Compile vertex shader
-    result = D3DX11CompileFromFile(vsFilename, NULL, NULL, "TextureVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &vertexShaderBuffer, &errorMessage, NULL);
-    if (FAILED(result))
+    if (!shaderCache.GetShader(vsFilename, "TextureVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, vertexShaderBuffer))
     {
-        if (errorMessage)
-        {
-            OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
-        }
-        else
-        {
-            MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
-        }
+        shaderCache.Shutdown();
         return false;
     }
 
     // Compile pixel shader
-    result = D3DX11CompileFromFile(psFilename, NULL, NULL, "TexturePixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &pixelShaderBuffer, &errorMessage, NULL);
-    if (FAILED(result))
+    if (!shaderCache.GetShader(psFilename, "TexturePixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, pixelShaderBuffer))
     {
-        if (errorMessage)
-        {
-            OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
-        }
-        else
-        {
-            MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
-        }
+        shaderCache.Shutdown();
         return false;
     }
 
     // Create vertex shader from buffer
-    result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_vertexShader);
-    if (FAILED(result))
-        return false;
+    result = device->CreateVertexShader(vertexShaderBuffer.data, vertexShaderBuffer.size, NULL, &m_vertexShader);
 
     // Create pixel shader from buffer
-    result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
-    if (FAILED(result))
-        return false;
+    if (SUCCEEDED(result))
+        result = device->CreatePixelShader(pixelShaderBuffer.data, pixelShaderBuffer.size, NULL, &m_pixelShader);
 
     // Create vertex input layout description
     polygonLayout[0].SemanticName = "POSITION";
@@ -129,15 +116,14 @@ bool TextureShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR
     numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
 
     // Create vertex input layout
-    result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_layout);
-    if (FAILED(result))
-        return false;
+    if (SUCCEEDED(result))
+        result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer.data, vertexShaderBuffer.size, &m_layout);
 
-    vertexShaderBuffer->Release();
-    vertexShaderBuffer = 0;
+    // The bytecode belongs to the cache, so it goes once the layout is made
+    shaderCache.Shutdown();
 
-    pixelShaderBuffer->Release();
-    pixelShaderBuffer = 0;
+    if (FAILED(result))
+        return false;
 
     // Setup dynamic matrix constant buffer description in vertex shader
     matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
@@ -205,6 +191,46 @@ void TextureShaderClass::ShutdownShader()
     return;
 }
 
+// Called by the shader cache on a miss, the blob is copied into memory the cache owns
+bool TextureShaderClass::CompileShaderFile(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+    HRESULT result;
+    ID3D10Blob* errorMessage;
+    ID3D10Blob* shaderBuffer;
+
+    errorMessage = 0;
+    shaderBuffer = 0;
+
+    result = D3DX11CompileFromFile(filename, (D3D10_SHADER_MACRO*)defines, NULL, entry, profile, flags, 0, NULL, &shaderBuffer, &errorMessage, NULL);
+    if (FAILED(result))
+    {
+        if (errorMessage)
+        {
+            OutputShaderErrorMessage(errorMessage, (HWND)userData, filename);
+        }
+        else
+        {
+            MessageBox((HWND)userData, filename, L"Missing Shader File", MB_OK);
+        }
+        return false;
+    }
+
+    bytecode.size = (unsigned int)shaderBuffer->GetBufferSize();
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+    {
+        shaderBuffer->Release();
+        return false;
+    }
+
+    memcpy(bytecode.data, shaderBuffer->GetBufferPointer(), bytecode.size);
+
+    shaderBuffer->Release();
+    shaderBuffer = 0;
+
+    return true;
+}
+
 void TextureShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
 {
     char* compileErrors;
@@ -267,7 +293,7 @@ bool TextureShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext,
     return true;
 }
 
-void TextureShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void TextureShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, int baseVertex)
 {
     // Set vertex input layout
     deviceContext->IASetInputLayout(m_layout);
@@ -280,7 +306,7 @@ void TextureShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int in
     deviceContext->PSSetSamplers(0, 1, &m_sampleState);
 
     // Render
-    deviceContext->DrawIndexed(indexCount, 0, 0);
+    deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
 
     return;
 }
\ No newline at end of file
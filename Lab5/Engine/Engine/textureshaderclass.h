@@ -4,6 +4,7 @@
 #include <d3dx10math.h>
 #include <d3dx11async.h>
 #include <fstream>>
+#include "shadercacheclass.h"
 using namespace std;
 
 class TextureShaderClass
@@ -24,14 +25,16 @@ public:
     bool Initialize(ID3D11Device*, HWND);
     void Shutdown();
     bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*);
+    bool Render(ID3D11DeviceContext*, int, int, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*);
 
 private:
     bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
     void ShutdownShader();
-    void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
+    static bool CompileShaderFile(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+    static void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
 
     bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*);
-    void RenderShader(ID3D11DeviceContext*, int);
+    void RenderShader(ID3D11DeviceContext*, int, int, int);
 
 private:
     ID3D11VertexShader* m_vertexShader;
@@ -53,84 +53,41 @@ bool ColorShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount
 bool ColorShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* hsFilename, WCHAR* dsFilename, WCHAR* psFilename)
 {
     HRESULT result;
-    ID3D10Blob* errorMessage;
-    ID3D10Blob* vertexShaderBuffer;
-	ID3D10Blob* hullShaderBuffer;
-	ID3D10Blob* domainShaderBuffer;
-    ID3D10Blob* pixelShaderBuffer;
+    ShaderCacheClass shaderCache;
+    ShaderBytecodeType vertexShaderBuffer;
+	ShaderBytecodeType hullShaderBuffer;
+	ShaderBytecodeType domainShaderBuffer;
+    ShaderBytecodeType pixelShaderBuffer;
     D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
     unsigned int numElements;
     D3D11_BUFFER_DESC matrixBufferDesc;
 	D3D11_BUFFER_DESC tessellationBufferDesc;
 
-    errorMessage = 0;
-    vertexShaderBuffer = 0;
-	hullShaderBuffer = 0;
-	domainShaderBuffer = 0;
-    pixelShaderBuffer = 0;
-
-    // Compile vertex shader
-    result = D3DX11CompileFromFile(vsFilename, NULL, NULL, "ColorVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &vertexShaderBuffer, &errorMessage, NULL);
-    if (FAILED(result))
-    {
-        if (errorMessage)
-            OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
-        else
-            MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
+    // Bytecode from an earlier run is reused, only changed stages get compiled
+    if (!shaderCache.Initialize("shaders.cache", "shader-cache.txt", CompileShaderFile, hwnd))
         return false;
-    }
 
-    // Compile hull shader
-	result = D3DX11CompileFromFile(hsFilename, NULL, NULL, "ColorHullShader", "hs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &hullShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result)) {
-		if (errorMessage) {
-			OutputShaderErrorMessage(errorMessage, hwnd, hsFilename);
-		}
-		else {
-			MessageBox(hwnd, hsFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
-
-    // Compile domain shader
-	result = D3DX11CompileFromFile(dsFilename, NULL, NULL, "ColorDomainShader", "ds_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &domainShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result)) {
-		if (errorMessage) {
-			OutputShaderErrorMessage(errorMessage, hwnd, dsFilename);
-		}
-		else {
-			MessageBox(hwnd, dsFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
-
-    // Compile pixel shader
-    result = D3DX11CompileFromFile(psFilename, NULL, NULL, "ColorPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &pixelShaderBuffer, &errorMessage, NULL);
-    if (FAILED(result))
+    // Compile all four stages
+    if (!shaderCache.GetShader(vsFilename, "ColorVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, vertexShaderBuffer) ||
+        !shaderCache.GetShader(hsFilename, "ColorHullShader", "hs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, hullShaderBuffer) ||
+        !shaderCache.GetShader(dsFilename, "ColorDomainShader", "ds_5_0", D3D10_SHADER_ENABLE_STRICTNESS, domainShaderBuffer) ||
+        !shaderCache.GetShader(psFilename, "ColorPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, pixelShaderBuffer))
     {
-        if (errorMessage)
-            OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
-        else
-            MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
+        shaderCache.Shutdown();
         return false;
     }
 
     // Creating all shaders from the buffer
-    result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_vertexShader);
-    if (FAILED(result))
-        return false;
+    result = device->CreateVertexShader(vertexShaderBuffer.data, vertexShaderBuffer.size, NULL, &m_vertexShader);
 
-	result = device->CreateHullShader(hullShaderBuffer->GetBufferPointer(), hullShaderBuffer->GetBufferSize(), NULL, &m_hullShader);
-	if (FAILED(result))
-		return false;
+	if (SUCCEEDED(result))
+		result = device->CreateHullShader(hullShaderBuffer.data, hullShaderBuffer.size, NULL, &m_hullShader);
 
-	result = device->CreateDomainShader(domainShaderBuffer->GetBufferPointer(), domainShaderBuffer->GetBufferSize(), NULL, &m_domainShader);
-	if (FAILED(result))
-		return false;
+	if (SUCCEEDED(result))
+		result = device->CreateDomainShader(domainShaderBuffer.data, domainShaderBuffer.size, NULL, &m_domainShader);
 
-    result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
-    if (FAILED(result))
-        return false;
+    if (SUCCEEDED(result))
+        result = device->CreatePixelShader(pixelShaderBuffer.data, pixelShaderBuffer.size, NULL, &m_pixelShader);
 
     // Vertex input layout description
     polygonLayout[0].SemanticName = "POSITION";
@@ -151,21 +108,14 @@ bool ColorShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 
     numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
 
-    result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_layout);
-    if (FAILED(result))
-        return false;
+    if (SUCCEEDED(result))
+        result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer.data, vertexShaderBuffer.size, &m_layout);
 
-    vertexShaderBuffer->Release();
-    vertexShaderBuffer = 0;
+    // The bytecode belongs to the cache, so it goes once the layout is made
+    shaderCache.Shutdown();
 
-    hullShaderBuffer->Release();
-    hullShaderBuffer = 0;
-
-    domainShaderBuffer->Release();
-    domainShaderBuffer = 0;
-
-    pixelShaderBuffer->Release();
-    pixelShaderBuffer = 0;
+    if (FAILED(result))
+        return false;
 
     // Dynamic matrix constant buffer description in domain shader
     matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
@@ -237,6 +187,42 @@ void ColorShaderClass::ShutdownShader()
     return;
 }
 
+// Called by the shader cache on a miss, the blob is copied into memory the cache owns
+bool ColorShaderClass::CompileShaderFile(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+    HRESULT result;
+    ID3D10Blob* errorMessage;
+    ID3D10Blob* shaderBuffer;
+
+    errorMessage = 0;
+    shaderBuffer = 0;
+
+    result = D3DX11CompileFromFile(filename, (D3D10_SHADER_MACRO*)defines, NULL, entry, profile, flags, 0, NULL, &shaderBuffer, &errorMessage, NULL);
+    if (FAILED(result))
+    {
+        if (errorMessage)
+            OutputShaderErrorMessage(errorMessage, (HWND)userData, filename);
+        else
+            MessageBox((HWND)userData, filename, L"Missing Shader File", MB_OK);
+        return false;
+    }
+
+    bytecode.size = (unsigned int)shaderBuffer->GetBufferSize();
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+    {
+        shaderBuffer->Release();
+        return false;
+    }
+
+    memcpy(bytecode.data, shaderBuffer->GetBufferPointer(), bytecode.size);
+
+    shaderBuffer->Release();
+    shaderBuffer = 0;
+
+    return true;
+}
+
 void ColorShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
 {
     char* compileErrors;
@@ -4,6 +4,7 @@
 #include <d3dx10math.h>
 #include <d3dx11async.h>
 #include <fstream>
+#include "shadercacheclass.h"
 using namespace std;
 
 class ColorShaderClass
@@ -34,7 +35,8 @@ public:
 private:
     bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*, WCHAR*, WCHAR*);
     void ShutdownShader();
-    void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
+    static bool CompileShaderFile(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+    static void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
     bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, float);
     void RenderShader(ID3D11DeviceContext*, int);
 
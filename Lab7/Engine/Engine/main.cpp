@@ -1,10 +1,15 @@
 #include "systemclass.h"
+#include "shadercacheclass.h"
 
 int WINAPI WinMain (HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline, int iCmdshow)
 {
 	SystemClass* System;
 	bool result;
 
+	// Run the shader cache with a stand in compiler through hits, misses, edits and damaged files, then exit
+	if (strstr(pScmdline, "-shadercachetest"))
+		return ShaderCacheClass::RunTests("shader-cache-test.txt") ? 0 : 1;
+
 	System = new SystemClass;
 	if (!System)
 		return 0;
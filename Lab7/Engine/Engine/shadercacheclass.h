@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <chrono>
+using namespace std;
+
+const int SHADER_CACHE_MAX_PATH = 260;
+const int SHADER_CACHE_MAX_INCLUDE_DEPTH = 8;
+
+// Bytecode handed back by a compiler, allocated with new[]. The cache takes
+// ownership and keeps it until Shutdown.
+struct ShaderBytecodeType
+{
+    unsigned char* data;
+    unsigned int size;
+};
+
+// Preprocessor define for a shader variant, laid out like D3D10_SHADER_MACRO.
+// Lists end with an entry whose name is null.
+struct ShaderDefineType
+{
+    const char* name;
+    const char* definition;
+};
+
+typedef bool (*ShaderCompileFunction)(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+
+// Compiled shaders saved to one file between runs. Entries are keyed by a hash
+// of the source, every file it includes, the entry point, the profile, the
+// defines and the compile flags, so editing any of them misses and recompiles. The compiler is
+// passed in, which keeps this class free of D3D.
+class ShaderCacheClass
+{
+private:
+    struct EntryType
+    {
+        unsigned long long key;
+        float compileMilliseconds;
+        ShaderBytecodeType bytecode;
+    };
+
+public:
+    ShaderCacheClass();
+    ShaderCacheClass(const ShaderCacheClass&);
+    ~ShaderCacheClass();
+
+    bool Initialize(char*, char*, ShaderCompileFunction, void*);
+    void Shutdown();
+
+    bool GetShader(wchar_t*, char*, char*, unsigned int, ShaderBytecodeType&);
+    bool GetShader(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&);
+    bool Precompile(char*, unsigned int);
+    bool Save();
+
+    int GetHitCount();
+    int GetMissCount();
+    float GetMillisecondsSaved();
+
+    static bool RunTests(char*);
+
+private:
+    bool Load();
+    bool HashSource(const char*, unsigned long long&, int);
+    static void HashBytes(const void*, unsigned int, unsigned long long&);
+    int FindEntry(unsigned long long);
+    bool AddEntry(unsigned long long, float, const ShaderBytecodeType&);
+    void ClearEntries();
+
+private:
+    char m_filename[SHADER_CACHE_MAX_PATH];
+    ofstream m_log;
+    ShaderCompileFunction m_compileFunction;
+    void* m_userData;
+
+    EntryType* m_entries;
+    int m_entryCount, m_entryCapacity;
+    bool m_dirty;
+
+    int m_hitCount, m_missCount;
+    float m_compileMilliseconds, m_savedMilliseconds;
+};
\ No newline at end of file
@@ -72,6 +72,16 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 		return false;
 	}
 
+    if (LIGHT_VARIANTS_UP_FRONT)
+    {
+        result = m_LightShader->CompileAllVariants();
+        if (!result)
+        {
+            MessageBox(hwnd, L"Could not compile the light shader variants.", L"Error", MB_OK);
+            return false;
+        }
+    }
+
     // Create light object
 	m_Light = new LightClass;
 	if (!m_Light)
@@ -141,6 +151,7 @@ bool GraphicsClass::Frame()
 bool GraphicsClass::Render(float rotation)
 {
     D3DXMATRIX viewMatrix, projectionMatrix, worldMatrix;
+    unsigned int features;
     bool result;
 
     // Clear buffers
@@ -159,8 +170,15 @@ bool GraphicsClass::Render(float rotation)
     // Put the model vertex and index buffers on the graphics pipeline
     m_Model->Render(m_D3D->GetDeviceContext());
 
+    // Only pay for the shading this material uses
+    features = 0;
+    if (m_Model->GetTexture())
+        features |= LIGHT_FEATURE_TEXTURE;
+    if (m_Light->GetSpecularPower() > 0.0f)
+        features |= LIGHT_FEATURE_SPECULAR;
+
     // Render model using the light shader
-	result = m_LightShader->Render(m_D3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, m_Model->GetTexture(), m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower());
+	result = m_LightShader->Render(m_D3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, m_Model->GetTexture(), m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower(), features, 1);
 	if (!result)
 		return false;
 
@@ -9,6 +9,7 @@ const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.1f;
+const bool LIGHT_VARIANTS_UP_FRONT = false;     // Compile every light shader variant at startup instead of on first use
 
 class GraphicsClass
 {
@@ -1,3 +1,5 @@
+// Compiled with INSTANCED defined, the world matrix comes from the instance stream
+
 // GLOBALS
 cbuffer MatrixBuffer
 {
@@ -18,6 +20,12 @@ struct VertexInputType
     float4 position : POSITION;
     float2 tex : TEXCOORD0;
     float3 normal : NORMAL;
+#ifdef INSTANCED
+    float4 world0 : WORLD0;
+    float4 world1 : WORLD1;
+    float4 world2 : WORLD2;
+    float4 world3 : WORLD3;
+#endif
 };
 
 struct PixelInputType
@@ -33,23 +41,31 @@ PixelInputType LightVertexShader(VertexInputType input)
 {
     PixelInputType output;
     float4 worldPosition;
+    float4x4 world;
+
+#ifdef INSTANCED
+    // Rows of this instance's world matrix
+    world = float4x4(input.world0, input.world1, input.world2, input.world3);
+#else
+    world = worldMatrix;
+#endif
 
     // Change vector to be 4 units for proper matrix calculations
 	input.position.w = 1.0f;
 
     // Calculate position of vertex
-    output.position = mul(input.position, worldMatrix);
+    output.position = mul(input.position, world);
     output.position = mul(output.position, viewMatrix);
     output.position = mul(output.position, projectionMatrix);
 
     // Store texture coord for pixel shader
 	output.tex = input.tex;
 
-	output.normal = mul(input.normal, (float3x3)worldMatrix);
+	output.normal = mul(input.normal, (float3x3)world);
 
 	output.normal = normalize(output.normal);
 
-    worldPosition = mul(input.position, worldMatrix);
+    worldPosition = mul(input.position, world);
 
     // Determine the viewing direction based on the position of the camera and the position of the vertex in the world
     output.viewDirection = cameraPosition.xyz - worldPosition.xyz;
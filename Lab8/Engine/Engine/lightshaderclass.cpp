@@ -2,9 +2,21 @@
 
 LightShaderClass::LightShaderClass()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
+    int i;
+
+    m_device = 0;
+    m_vsFilename = 0;
+    m_psFilename = 0;
+    m_shaderCache = 0;
+
+    for (i = 0; i < LIGHT_VARIANT_COUNT; i++)
+    {
+        m_variants[i].vertexShader = 0;
+        m_variants[i].pixelShader = 0;
+        m_variants[i].layout = 0;
+        m_variants[i].compileMilliseconds = 0.0f;
+    }
+
 	m_sampleState = 0;
 	m_matrixBuffer = 0;
 	
@@ -36,121 +48,103 @@ bool LightShaderClass::Initialize(ID3D11Device* device, HWND hwnd)
 
 void LightShaderClass::Shutdown()
 {
+    WriteVariantReport("shader-variants.txt");
 	ShutdownShader();
 	return;
 }
 
-bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower)
+bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower, unsigned int features, int instanceCount)
 {
 	bool result;
 
+    if (features >= LIGHT_VARIANT_COUNT)
+        return false;
+
+    // Variants are compiled the first time a material asks for them
+    if (!m_variants[features].layout)
+    {
+        result = CompileVariant(features);
+        if (!result)
+            return false;
+    }
+
     // Set shader params that it will use for rendering
 	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambientColor, diffuseColor, cameraPosition, specularColor, specularPower);
 	if (!result)
 		return false;
 
     // Render said shader
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, features, instanceCount);
 
 	return true;
 }
 
-bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename)
+// Compiles every variant, for when nothing should be compiled mid frame
+bool LightShaderClass::CompileAllVariants()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	ID3D10Blob* vertexShaderBuffer;
-	ID3D10Blob* pixelShaderBuffer;
+    unsigned int features;
+    bool result;
 
-	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
-	unsigned int numElements;
-	D3D11_SAMPLER_DESC samplerDesc;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-
-    D3D11_BUFFER_DESC cameraBufferDesc;
-	D3D11_BUFFER_DESC lightBufferDesc;
+    for (features = 0; features < LIGHT_VARIANT_COUNT; features++)
+    {
+        if (!m_variants[features].layout)
+        {
+            result = CompileVariant(features);
+            if (!result)
+                return false;
+        }
+    }
 
-	errorMessage = 0;
-	vertexShaderBuffer = 0;
-	pixelShaderBuffer = 0;
+    return true;
+}
 
-    // Compile vertex shader
-	result = D3DX11CompileFromFile(vsFilename, NULL, NULL, "LightVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &vertexShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result))
-	{
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
-		}
-		else
-		{
-			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
+int LightShaderClass::GetVariantCount()
+{
+    int i, count;
 
-    // Compile pixel shader
-	result = D3DX11CompileFromFile(psFilename, NULL, NULL, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &pixelShaderBuffer, &errorMessage, NULL);
-	if (FAILED(result))
-	{
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
-		}
-		else
-		{
-			MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
-		}
-		return false;
-	}
+    count = 0;
+    for (i = 0; i < LIGHT_VARIANT_COUNT; i++)
+    {
+        if (m_variants[i].layout)
+            count++;
+    }
 
-    // Create vertex shader from the buffer
-	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_vertexShader);
-	if (FAILED(result))
-		return false;
+    return count;
+}
 
-    // Create pixel shader from the buffer
-	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
-	if (FAILED(result))
-		return false;
+float LightShaderClass::GetCompileMilliseconds()
+{
+    float milliseconds;
+    int i;
 
-    // Vertex input layout description
-	polygonLayout[0].SemanticName = "POSITION";
-	polygonLayout[0].SemanticIndex = 0;
-	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[0].InputSlot = 0;
-	polygonLayout[0].AlignedByteOffset = 0;
-	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[0].InstanceDataStepRate = 0;
+    milliseconds = 0.0f;
+    for (i = 0; i < LIGHT_VARIANT_COUNT; i++)
+        milliseconds += m_variants[i].compileMilliseconds;
 
-	polygonLayout[1].SemanticName = "TEXCOORD";
-	polygonLayout[1].SemanticIndex = 0;
-	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	polygonLayout[1].InputSlot = 0;
-	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[1].InstanceDataStepRate = 0;
+    return milliseconds;
+}
 
-	polygonLayout[2].SemanticName = "NORMAL";
-	polygonLayout[2].SemanticIndex = 0;
-	polygonLayout[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[2].InputSlot = 0;
-	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[2].InstanceDataStepRate = 0;
+// Sets up everything the variants share, the shaders themselves are compiled on demand
+bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename)
+{
+	HRESULT result;
+	D3D11_SAMPLER_DESC samplerDesc;
+	D3D11_BUFFER_DESC matrixBufferDesc;
 
-	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+    D3D11_BUFFER_DESC cameraBufferDesc;
+	D3D11_BUFFER_DESC lightBufferDesc;
 
-    // Create vertex input layout
-	result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_layout);
-	if (FAILED(result))
-		return false;
+    m_device = device;
+    m_vsFilename = vsFilename;
+    m_psFilename = psFilename;
 
-	vertexShaderBuffer->Release();
-	vertexShaderBuffer = 0;
+    // Variants compiled on an earlier run come out of the cache
+    m_shaderCache = new ShaderCacheClass;
+    if (!m_shaderCache)
+        return false;
 
-	pixelShaderBuffer->Release();
-	pixelShaderBuffer = 0;
+    if (!m_shaderCache->Initialize("shaders.cache", "shader-cache.txt", CompileShaderFile, hwnd))
+        return false;
 
     // Create texture sampler state description
 	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -214,8 +208,152 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
     return true;
 }
 
+bool LightShaderClass::CompileVariant(unsigned int features)
+{
+    std::chrono::high_resolution_clock::time_point startTime;
+	HRESULT result;
+    ShaderDefineType vertexDefines[2];
+    ShaderDefineType pixelDefines[3];
+    ShaderBytecodeType vertexShaderBuffer;
+    ShaderBytecodeType pixelShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[7];
+	unsigned int numElements;
+    int defineCount, i;
+    VariantType* variant;
+
+    variant = &m_variants[features];
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    // Only instancing changes the vertex shader, so the other bits don't make extra copies of it
+    defineCount = 0;
+    if (features & LIGHT_FEATURE_INSTANCED)
+    {
+        vertexDefines[defineCount].name = "INSTANCED";
+        vertexDefines[defineCount].definition = "1";
+        defineCount++;
+    }
+    vertexDefines[defineCount].name = 0;
+    vertexDefines[defineCount].definition = 0;
+
+    defineCount = 0;
+    if (features & LIGHT_FEATURE_SPECULAR)
+    {
+        pixelDefines[defineCount].name = "SPECULAR";
+        pixelDefines[defineCount].definition = "1";
+        defineCount++;
+    }
+    if (features & LIGHT_FEATURE_TEXTURE)
+    {
+        pixelDefines[defineCount].name = "TEXTURE";
+        pixelDefines[defineCount].definition = "1";
+        defineCount++;
+    }
+    pixelDefines[defineCount].name = 0;
+    pixelDefines[defineCount].definition = 0;
+
+    // Compile vertex shader
+    if (!m_shaderCache->GetShader(m_vsFilename, "LightVertexShader", "vs_5_0", vertexDefines, D3D10_SHADER_ENABLE_STRICTNESS, vertexShaderBuffer))
+        return false;
+
+    // Compile pixel shader
+    if (!m_shaderCache->GetShader(m_psFilename, "LightPixelShader", "ps_5_0", pixelDefines, D3D10_SHADER_ENABLE_STRICTNESS, pixelShaderBuffer))
+        return false;
+
+    // Create vertex shader from the buffer
+	result = m_device->CreateVertexShader(vertexShaderBuffer.data, vertexShaderBuffer.size, NULL, &variant->vertexShader);
+	if (FAILED(result))
+		return false;
+
+    // Create pixel shader from the buffer
+	result = m_device->CreatePixelShader(pixelShaderBuffer.data, pixelShaderBuffer.size, NULL, &variant->pixelShader);
+	if (FAILED(result))
+		return false;
+
+    // Vertex input layout description
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	polygonLayout[1].SemanticName = "TEXCOORD";
+	polygonLayout[1].SemanticIndex = 0;
+	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[1].InputSlot = 0;
+	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[1].InstanceDataStepRate = 0;
+
+	polygonLayout[2].SemanticName = "NORMAL";
+	polygonLayout[2].SemanticIndex = 0;
+	polygonLayout[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[2].InputSlot = 0;
+	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[2].InstanceDataStepRate = 0;
+
+	numElements = 3;
+
+    // Instanced variants read a world matrix per instance from the second vertex buffer
+    if (features & LIGHT_FEATURE_INSTANCED)
+    {
+        for (i = 0; i < 4; i++)
+        {
+            polygonLayout[numElements].SemanticName = "WORLD";
+            polygonLayout[numElements].SemanticIndex = i;
+            polygonLayout[numElements].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+            polygonLayout[numElements].InputSlot = 1;
+            polygonLayout[numElements].AlignedByteOffset = (i == 0) ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+            polygonLayout[numElements].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+            polygonLayout[numElements].InstanceDataStepRate = 1;
+            numElements++;
+        }
+    }
+
+    // Create vertex input layout
+	result = m_device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer.data, vertexShaderBuffer.size, &variant->layout);
+	if (FAILED(result))
+		return false;
+
+    variant->compileMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    return true;
+}
+
+void LightShaderClass::WriteVariantReport(char* filename)
+{
+    ofstream fout;
+    int i;
+
+    fout.open(filename);
+    if (fout.fail())
+        return;
+
+    fout << "Light shader variants compiled: " << GetVariantCount() << " of " << LIGHT_VARIANT_COUNT << endl;
+
+    for (i = 0; i < LIGHT_VARIANT_COUNT; i++)
+    {
+        if (!m_variants[i].layout)
+            continue;
+
+        fout << ((i & LIGHT_FEATURE_SPECULAR) ? "SPECULAR " : "") << ((i & LIGHT_FEATURE_TEXTURE) ? "TEXTURE " : "") << ((i & LIGHT_FEATURE_INSTANCED) ? "INSTANCED " : "");
+        fout << (i ? "" : "(base) ") << m_variants[i].compileMilliseconds << " ms" << endl;
+    }
+
+    fout << "Total compile ms: " << GetCompileMilliseconds() << endl;
+
+    fout.close();
+
+    return;
+}
+
 void LightShaderClass::ShutdownShader()
 {
+    int i;
+
 	if (m_lightBuffer)
 	{
 		m_lightBuffer->Release();
@@ -240,25 +378,75 @@ void LightShaderClass::ShutdownShader()
 		m_sampleState = 0;
 	}
 
-	if (m_layout)
-	{
-		m_layout->Release();
-		m_layout = 0;
-	}
+    for (i = 0; i < LIGHT_VARIANT_COUNT; i++)
+    {
+        if (m_variants[i].layout)
+        {
+            m_variants[i].layout->Release();
+            m_variants[i].layout = 0;
+        }
+
+        if (m_variants[i].pixelShader)
+        {
+            m_variants[i].pixelShader->Release();
+            m_variants[i].pixelShader = 0;
+        }
+
+        if (m_variants[i].vertexShader)
+        {
+            m_variants[i].vertexShader->Release();
+            m_variants[i].vertexShader = 0;
+        }
+    }
 
-	if (m_pixelShader)
-	{
-		m_pixelShader->Release();
-		m_pixelShader = 0;
-	}
-	
-	if (m_vertexShader)
+    if (m_shaderCache)
+    {
+        m_shaderCache->Shutdown();
+        delete m_shaderCache;
+        m_shaderCache = 0;
+    }
+
+	return;
+}
+
+// Called by the shader cache on a miss, the blob is copied into memory the cache owns
+bool LightShaderClass::CompileShaderFile(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* shaderBuffer;
+
+	errorMessage = 0;
+	shaderBuffer = 0;
+
+	result = D3DX11CompileFromFile(filename, (D3D10_SHADER_MACRO*)defines, NULL, entry, profile, flags, 0, NULL, &shaderBuffer, &errorMessage, NULL);
+	if (FAILED(result))
 	{
-		m_vertexShader->Release();
-		m_vertexShader = 0;
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, (HWND)userData, filename);
+		}
+		else
+		{
+			MessageBox((HWND)userData, filename, L"Missing Shader File", MB_OK);
+		}
+		return false;
 	}
 
-	return;
+    bytecode.size = (unsigned int)shaderBuffer->GetBufferSize();
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+    {
+        shaderBuffer->Release();
+        return false;
+    }
+
+    memcpy(bytecode.data, shaderBuffer->GetBufferPointer(), bytecode.size);
+
+	shaderBuffer->Release();
+	shaderBuffer = 0;
+
+	return true;
 }
 
 void LightShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -370,20 +558,23 @@ bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D
 	return true;
 }
 
-void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount, unsigned int features, int instanceCount)
 {
     // Set vertex input layout
-	deviceContext->IASetInputLayout(m_layout);
+	deviceContext->IASetInputLayout(m_variants[features].layout);
 
     // Set vertex and pixel shaders
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
+	deviceContext->VSSetShader(m_variants[features].vertexShader, NULL, 0);
+	deviceContext->PSSetShader(m_variants[features].pixelShader, NULL, 0);
 
     // Set sampler state in the pixel sahder
 	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
 
-    // Render the triangle
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+    // Render the triangle, instance buffer is expected in slot 1 for instanced variants
+    if (features & LIGHT_FEATURE_INSTANCED)
+        deviceContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
+    else
+	    deviceContext->DrawIndexed(indexCount, 0, 0);
 
 	return;
 }
\ No newline at end of file
@@ -4,8 +4,16 @@
 #include <d3dx10math.h>
 #include <d3dx11async.h>
 #include <fstream>
+#include <chrono>
+#include "shadercacheclass.h"
 using namespace std;
 
+// Feature bits, any combination picks one compiled variant of the light shader
+const unsigned int LIGHT_FEATURE_SPECULAR = 0x1;
+const unsigned int LIGHT_FEATURE_TEXTURE = 0x2;
+const unsigned int LIGHT_FEATURE_INSTANCED = 0x4;
+const int LIGHT_VARIANT_COUNT = 8;
+
 class LightShaderClass
 {
 private:
@@ -31,6 +39,14 @@ private:
         D3DXVECTOR4 specularColor;
 	};
 
+    struct VariantType
+    {
+        ID3D11VertexShader* vertexShader;
+        ID3D11PixelShader* pixelShader;
+        ID3D11InputLayout* layout;
+        float compileMilliseconds;
+    };
+
 public:
 	LightShaderClass();
 	LightShaderClass(const LightShaderClass&);
@@ -38,20 +54,30 @@ public:
 
 	bool Initialize(ID3D11Device*, HWND);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float);
+	bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float, unsigned int, int);
+
+    bool CompileAllVariants();
+    int GetVariantCount();
+    float GetCompileMilliseconds();
 
 private:
 	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
 	void ShutdownShader();
-	void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
+    bool CompileVariant(unsigned int);
+    void WriteVariantReport(char*);
+    static bool CompileShaderFile(wchar_t*, char*, char*, const ShaderDefineType*, unsigned int, ShaderBytecodeType&, void*);
+	static void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
 
 	bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float);
-	void RenderShader(ID3D11DeviceContext*, int);
+	void RenderShader(ID3D11DeviceContext*, int, unsigned int, int);
 
 private:
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
+    ID3D11Device* m_device;
+    WCHAR* m_vsFilename;
+    WCHAR* m_psFilename;
+    ShaderCacheClass* m_shaderCache;
+    VariantType m_variants[LIGHT_VARIANT_COUNT];
+
 	ID3D11SamplerState* m_sampleState;
 	ID3D11Buffer* m_matrixBuffer;
 
@@ -0,0 +1,762 @@
+#include "shadercacheclass.h"
+
+// Cache file layout: magic, entry count, then key, compile time, size and bytecode per entry
+const char SHADER_CACHE_MAGIC[4] = { 'S', 'H', 'C', '1' };
+const int SHADER_CACHE_ENTRY_HEADER = sizeof(unsigned long long) + sizeof(float) + sizeof(unsigned int);
+const int SHADER_CACHE_INITIAL_ENTRIES = 32;
+
+// 64 bit FNV-1a
+const unsigned long long SHADER_HASH_OFFSET = 14695981039346656037ULL;
+const unsigned long long SHADER_HASH_PRIME = 1099511628211ULL;
+
+// Stand in compiler for RunTests, the "bytecode" is the source text and every
+// call is counted so the test can tell a hit from a miss
+struct ShaderCacheTestCompilerType
+{
+    int compileCount;
+    bool fail;
+};
+
+static bool CompileTestShader(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode, void* userData)
+{
+    ShaderCacheTestCompilerType* compiler;
+    ifstream fin;
+    char path[SHADER_CACHE_MAX_PATH];
+
+    compiler = (ShaderCacheTestCompilerType*)userData;
+    compiler->compileCount++;
+    if (compiler->fail)
+        return false;
+
+    if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+        return false;
+
+    fin.open(path, ios::in | ios::binary);
+    if (fin.fail())
+        return false;
+
+    fin.seekg(0, ios::end);
+    bytecode.size = (unsigned int)fin.tellg();
+    fin.seekg(0, ios::beg);
+
+    bytecode.data = new unsigned char[bytecode.size];
+    if (!bytecode.data)
+        return false;
+
+    fin.read((char*)bytecode.data, bytecode.size);
+    fin.close();
+
+    if (fin.fail())
+    {
+        delete[] bytecode.data;
+        return false;
+    }
+
+    return true;
+}
+
+static bool WriteTestFile(const char* filename, const char* data, unsigned int size)
+{
+    ofstream fout;
+
+    fout.open(filename, ios::out | ios::binary);
+    if (fout.fail())
+        return false;
+
+    fout.write(data, size);
+    fout.close();
+
+    return !fout.fail();
+}
+
+static void Check(ofstream& fout, const char* name, bool passed, int& failures)
+{
+    fout << (passed ? "pass " : "FAIL ") << name << endl;
+    if (!passed)
+        failures++;
+
+    return;
+}
+
+ShaderCacheClass::ShaderCacheClass()
+{
+    m_filename[0] = 0;
+    m_compileFunction = 0;
+    m_userData = 0;
+
+    m_entries = 0;
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+    m_dirty = false;
+
+    m_hitCount = 0;
+    m_missCount = 0;
+    m_compileMilliseconds = 0.0f;
+    m_savedMilliseconds = 0.0f;
+}
+
+ShaderCacheClass::ShaderCacheClass(const ShaderCacheClass& other)
+{
+
+}
+
+ShaderCacheClass::~ShaderCacheClass()
+{
+
+}
+
+bool ShaderCacheClass::Initialize(char* cacheFilename, char* logFilename, ShaderCompileFunction compileFunction, void* userData)
+{
+    if (strlen(cacheFilename) >= SHADER_CACHE_MAX_PATH)
+        return false;
+
+    strcpy(m_filename, cacheFilename);
+    m_compileFunction = compileFunction;
+    m_userData = userData;
+
+    m_log.open(logFilename);
+    if (m_log.fail())
+        return false;
+
+    // A missing or damaged cache file just means everything misses once
+    if (!Load())
+        m_log << "Starting with an empty cache, " << m_filename << " could not be read" << endl;
+    else
+        m_log << "Loaded " << m_entryCount << " shaders from " << m_filename << endl;
+
+    return true;
+}
+
+void ShaderCacheClass::Shutdown()
+{
+    if (m_dirty)
+        Save();
+
+    if (m_log.is_open())
+    {
+        m_log << "Hits: " << m_hitCount << ", misses: " << m_missCount << endl;
+        m_log << "Compile ms: " << m_compileMilliseconds << ", saved ms: " << m_savedMilliseconds << endl;
+        m_log.close();
+    }
+
+    ClearEntries();
+
+    return;
+}
+
+bool ShaderCacheClass::GetShader(wchar_t* filename, char* entry, char* profile, unsigned int flags, ShaderBytecodeType& bytecode)
+{
+    return GetShader(filename, entry, profile, 0, flags, bytecode);
+}
+
+// The returned bytecode belongs to the cache and stays valid until Shutdown
+bool ShaderCacheClass::GetShader(wchar_t* filename, char* entry, char* profile, const ShaderDefineType* defines, unsigned int flags, ShaderBytecodeType& bytecode)
+{
+    std::chrono::high_resolution_clock::time_point startTime;
+    char path[SHADER_CACHE_MAX_PATH];
+    unsigned long long key;
+    ShaderBytecodeType compiled;
+    float milliseconds;
+    int index, i;
+    bool result;
+
+    if (wcstombs(path, filename, sizeof(path)) >= sizeof(path))
+        return false;
+
+    key = SHADER_HASH_OFFSET;
+    result = HashSource(path, key, 0);
+    if (!result)
+    {
+        m_log << "missing " << path << endl;
+        return false;
+    }
+
+    HashBytes(entry, (unsigned int)strlen(entry) + 1, key);
+    HashBytes(profile, (unsigned int)strlen(profile) + 1, key);
+    HashBytes(&flags, sizeof(flags), key);
+
+    // No defines hashes nothing, so plain shaders keep the keys they had
+    for (i = 0; defines && defines[i].name; i++)
+    {
+        HashBytes(defines[i].name, (unsigned int)strlen(defines[i].name) + 1, key);
+        if (defines[i].definition)
+            HashBytes(defines[i].definition, (unsigned int)strlen(defines[i].definition) + 1, key);
+        else
+            HashBytes("", 1, key);
+    }
+
+    index = FindEntry(key);
+    if (index >= 0)
+    {
+        m_hitCount++;
+        m_savedMilliseconds += m_entries[index].compileMilliseconds;
+        m_log << "hit     " << path << " " << entry << " " << profile << ", saved " << m_entries[index].compileMilliseconds << " ms" << endl;
+
+        bytecode = m_entries[index].bytecode;
+        return true;
+    }
+
+    startTime = std::chrono::high_resolution_clock::now();
+
+    compiled.data = 0;
+    compiled.size = 0;
+    result = m_compileFunction(filename, entry, profile, defines, flags, compiled, m_userData);
+    if (!result)
+    {
+        m_log << "failed  " << path << " " << entry << " " << profile << endl;
+        return false;
+    }
+
+    milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    m_missCount++;
+    m_compileMilliseconds += milliseconds;
+    m_log << "miss    " << path << " " << entry << " " << profile << ", compiled in " << milliseconds << " ms" << endl;
+
+    result = AddEntry(key, milliseconds, compiled);
+    if (!result)
+    {
+        delete[] compiled.data;
+        return false;
+    }
+
+    bytecode = compiled;
+
+    return true;
+}
+
+// Compiles every "file entry profile" line of a manifest into the cache and saves it
+bool ShaderCacheClass::Precompile(char* manifestFilename, unsigned int flags)
+{
+    ifstream fin;
+    char path[SHADER_CACHE_MAX_PATH], entry[128], profile[32];
+    wchar_t widePath[SHADER_CACHE_MAX_PATH];
+    ShaderBytecodeType bytecode;
+    bool result, succeeded;
+
+    fin.open(manifestFilename);
+    if (fin.fail())
+        return false;
+
+    succeeded = true;
+
+    fin.width(sizeof(path));
+    while (fin >> path)
+    {
+        fin.width(sizeof(entry));
+        fin >> entry;
+        fin.width(sizeof(profile));
+        fin >> profile;
+        if (fin.fail())
+            break;
+
+        if (mbstowcs(widePath, path, SHADER_CACHE_MAX_PATH) >= SHADER_CACHE_MAX_PATH)
+        {
+            succeeded = false;
+            continue;
+        }
+
+        result = GetShader(widePath, entry, profile, flags, bytecode);
+        if (!result)
+            succeeded = false;
+
+        fin.width(sizeof(path));
+    }
+
+    fin.close();
+
+    if (!Save())
+        return false;
+
+    return succeeded;
+}
+
+bool ShaderCacheClass::Save()
+{
+    ofstream fout;
+    int i;
+
+    fout.open(m_filename, ios::out | ios::binary);
+    if (fout.fail())
+        return false;
+
+    fout.write(SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC));
+    fout.write((char*)&m_entryCount, sizeof(m_entryCount));
+
+    for (i = 0; i < m_entryCount; i++)
+    {
+        fout.write((char*)&m_entries[i].key, sizeof(m_entries[i].key));
+        fout.write((char*)&m_entries[i].compileMilliseconds, sizeof(m_entries[i].compileMilliseconds));
+        fout.write((char*)&m_entries[i].bytecode.size, sizeof(m_entries[i].bytecode.size));
+        fout.write((char*)m_entries[i].bytecode.data, m_entries[i].bytecode.size);
+    }
+
+    fout.close();
+
+    if (fout.fail())
+        return false;
+
+    m_dirty = false;
+
+    return true;
+}
+
+int ShaderCacheClass::GetHitCount()
+{
+    return m_hitCount;
+}
+
+int ShaderCacheClass::GetMissCount()
+{
+    return m_missCount;
+}
+
+float ShaderCacheClass::GetMillisecondsSaved()
+{
+    return m_savedMilliseconds;
+}
+
+// Drives the cache with the stand in compiler through hits, misses, edited
+// sources and includes, and damaged cache files, and checks each one
+bool ShaderCacheClass::RunTests(char* filename)
+{
+    struct DamageType
+    {
+        const char* name;
+        unsigned int size;
+        int offset;
+        unsigned int value;
+    };
+
+    const char source[] = "#include \"shader-cache-test.hlsli\"\nfloat4 main() : SV_TARGET { return tint; }\n";
+    const char editedSource[] = "#include \"shader-cache-test.hlsli\"\nfloat4 main() : SV_TARGET { return tint * 0.5f; }\n";
+    const char include[] = "static const float4 tint = float4(1.0f, 0.5f, 0.25f, 1.0f);\n";
+    const char editedInclude[] = "static const float4 tint = float4(0.25f, 0.5f, 1.0f, 1.0f);\n";
+    const ShaderDefineType defines[] = { { "TINT", "1" }, { 0, 0 } };
+    const ShaderDefineType otherDefines[] = { { "TINT", "2" }, { 0, 0 } };
+    const int headerSize = sizeof(SHADER_CACHE_MAGIC) + sizeof(int);
+    wchar_t shaderName[] = L"shader-cache-test.ps";
+    wchar_t missingName[] = L"shader-cache-test-missing.ps";
+    char cacheName[] = "shader-cache-test.cache";
+    char logName[] = "shader-cache-test-log.txt";
+    char entry[] = "main", otherEntry[] = "other";
+    char profile[] = "ps_5_0", otherProfile[] = "ps_4_0";
+    ShaderCacheTestCompilerType compiler;
+    ShaderCacheClass cache, reloaded, rewritten;
+    ShaderBytecodeType bytecode, first;
+    ofstream fout;
+    ifstream fin;
+    char* cacheData;
+    char* damagedData;
+    unsigned int cacheSize;
+    int failures, compiles, damageCount, i;
+    bool result, passed;
+
+    fout.open(filename);
+    if (fout.fail())
+        return false;
+
+    failures = 0;
+
+    remove(cacheName);
+    result = WriteTestFile("shader-cache-test.ps", source, sizeof(source) - 1);
+    result = result && WriteTestFile("shader-cache-test.hlsli", include, sizeof(include) - 1);
+    Check(fout, "test shader written", result, failures);
+
+    compiler.compileCount = 0;
+    compiler.fail = false;
+
+    // With no file behind it the cache compiles once and hits after that
+    result = cache.Initialize(cacheName, logName, CompileTestShader, &compiler);
+    Check(fout, "starts without a cache file", result, failures);
+
+    result = result && cache.GetShader(shaderName, entry, profile, 0, first);
+    Check(fout, "first request compiles", result && (compiler.compileCount == 1) && (cache.GetMissCount() == 1), failures);
+    Check(fout, "bytecode is what the compiler returned", result && (first.size == sizeof(source) - 1) && (memcmp(first.data, source, first.size) == 0), failures);
+
+    result = cache.GetShader(shaderName, entry, profile, 0, bytecode);
+    Check(fout, "second request hits", result && (compiler.compileCount == 1) && (cache.GetHitCount() == 1) && (bytecode.data == first.data), failures);
+
+    compiles = compiler.compileCount;
+    cache.GetShader(shaderName, otherEntry, profile, 0, bytecode);
+    cache.GetShader(shaderName, entry, otherProfile, 0, bytecode);
+    cache.GetShader(shaderName, entry, profile, 1, bytecode);
+    cache.GetShader(shaderName, entry, profile, defines, 0, bytecode);
+    cache.GetShader(shaderName, entry, profile, otherDefines, 0, bytecode);
+    Check(fout, "entry, profile, flags and defines each miss", compiler.compileCount == compiles + 5, failures);
+
+    result = cache.GetShader(shaderName, entry, profile, defines, 0, bytecode);
+    Check(fout, "same defines hit", result && (compiler.compileCount == compiles + 5), failures);
+
+    // A failed compile leaves nothing behind, asking again compiles again
+    compiler.fail = true;
+    result = cache.GetShader(shaderName, entry, profile, 2, bytecode);
+    compiler.fail = false;
+    Check(fout, "failed compile reported", !result, failures);
+
+    compiles = compiler.compileCount;
+    result = cache.GetShader(shaderName, entry, profile, 2, bytecode);
+    Check(fout, "failed compile not cached", result && (compiler.compileCount == compiles + 1), failures);
+
+    compiles = compiler.compileCount;
+    result = cache.GetShader(missingName, entry, profile, 0, bytecode);
+    Check(fout, "missing source refused without compiling", !result && (compiler.compileCount == compiles), failures);
+
+    cache.Shutdown();
+
+    // The saved file serves the next run, and editing the source or an include misses
+    compiler.compileCount = 0;
+    result = reloaded.Initialize(cacheName, logName, CompileTestShader, &compiler);
+    result = result && reloaded.GetShader(shaderName, entry, profile, 0, bytecode);
+    Check(fout, "saved cache hits", result && (compiler.compileCount == 0) && (bytecode.size == sizeof(source) - 1) && (memcmp(bytecode.data, source, bytecode.size) == 0), failures);
+
+    result = reloaded.GetShader(shaderName, entry, profile, defines, 0, bytecode);
+    Check(fout, "saved variant hits", result && (compiler.compileCount == 0), failures);
+
+    WriteTestFile("shader-cache-test.hlsli", editedInclude, sizeof(editedInclude) - 1);
+    result = reloaded.GetShader(shaderName, entry, profile, 0, bytecode);
+    Check(fout, "edited include misses", result && (compiler.compileCount == 1), failures);
+
+    WriteTestFile("shader-cache-test.hlsli", include, sizeof(include) - 1);
+    WriteTestFile("shader-cache-test.ps", editedSource, sizeof(editedSource) - 1);
+    result = reloaded.GetShader(shaderName, entry, profile, 0, bytecode);
+    Check(fout, "edited source misses", result && (compiler.compileCount == 2) && (bytecode.size == sizeof(editedSource) - 1), failures);
+
+    WriteTestFile("shader-cache-test.ps", source, sizeof(source) - 1);
+    result = reloaded.GetShader(shaderName, entry, profile, 0, bytecode);
+    Check(fout, "restored source hits its old entry", result && (compiler.compileCount == 2), failures);
+
+    reloaded.Shutdown();
+
+    cacheData = 0;
+    cacheSize = 0;
+    fin.open(cacheName, ios::in | ios::binary);
+    if (!fin.fail())
+    {
+        fin.seekg(0, ios::end);
+        cacheSize = (unsigned int)fin.tellg();
+        fin.seekg(0, ios::beg);
+
+        cacheData = new char[cacheSize];
+        if (cacheData)
+            fin.read(cacheData, cacheSize);
+        fin.close();
+    }
+
+    result = cacheData && (cacheSize > headerSize + SHADER_CACHE_ENTRY_HEADER);
+    Check(fout, "cache file read back", result, failures);
+
+    // A damaged file has to be dropped whole, so even the intact entries ahead
+    // of the damage miss, and the run carries on by compiling
+    if (result)
+    {
+        DamageType damage[] =
+        {
+            { "empty file dropped", 0, -1, 0 },
+            { "file truncated in the header dropped", headerSize - 2, -1, 0 },
+            { "file truncated in the first entry dropped", headerSize + SHADER_CACHE_ENTRY_HEADER - 2, -1, 0 },
+            { "file truncated in the last bytecode dropped", cacheSize - 1, -1, 0 },
+            { "wrong magic dropped", cacheSize, 0, 0x58585858 },
+            { "negative entry count dropped", cacheSize, sizeof(SHADER_CACHE_MAGIC), 0xffffffff },
+            { "entry count past the end dropped", cacheSize, sizeof(SHADER_CACHE_MAGIC), 0x7fffffff },
+            { "bytecode size past the end dropped", cacheSize, headerSize + SHADER_CACHE_ENTRY_HEADER - sizeof(unsigned int), 0xfffffff0 }
+        };
+
+        damageCount = sizeof(damage) / sizeof(damage[0]);
+
+        damagedData = new char[cacheSize];
+        if (!damagedData)
+        {
+            delete[] cacheData;
+            return false;
+        }
+
+        for (i = 0; i < damageCount; i++)
+        {
+            ShaderCacheClass damaged;
+
+            memcpy(damagedData, cacheData, cacheSize);
+            if (damage[i].offset >= 0)
+                memcpy(&damagedData[damage[i].offset], &damage[i].value, sizeof(damage[i].value));
+            WriteTestFile(cacheName, damagedData, damage[i].size);
+
+            compiler.compileCount = 0;
+            result = damaged.Initialize(cacheName, logName, CompileTestShader, &compiler);
+            result = result && damaged.GetShader(shaderName, entry, profile, 0, bytecode);
+            passed = result && (compiler.compileCount == 1) && (damaged.GetHitCount() == 0) && (bytecode.size == sizeof(source) - 1);
+            damaged.Shutdown();
+
+            Check(fout, damage[i].name, passed, failures);
+        }
+
+        delete[] damagedData;
+        damagedData = 0;
+
+        // The last run saved over the damaged file with one that loads
+        compiler.compileCount = 0;
+        result = rewritten.Initialize(cacheName, logName, CompileTestShader, &compiler);
+        result = result && rewritten.GetShader(shaderName, entry, profile, 0, bytecode);
+        Check(fout, "damaged file replaced on save", result && (compiler.compileCount == 0), failures);
+        rewritten.Shutdown();
+    }
+
+    if (cacheData)
+    {
+        delete[] cacheData;
+        cacheData = 0;
+    }
+
+    remove("shader-cache-test.ps");
+    remove("shader-cache-test.hlsli");
+    remove(cacheName);
+    remove(logName);
+
+    fout << endl << failures << " failures" << endl;
+    fout.close();
+
+    printf("%d shader cache test failures, results in %s\n", failures, filename);
+
+    return (failures == 0);
+}
+
+bool ShaderCacheClass::Load()
+{
+    ifstream fin;
+    char magic[4];
+    int i, count;
+    unsigned long long key, remaining;
+    float milliseconds;
+    ShaderBytecodeType bytecode;
+    bool result;
+
+    fin.open(m_filename, ios::in | ios::binary);
+    if (fin.fail())
+        return false;
+
+    // Sizes read from the file are only trusted once they fit in what is left of it
+    fin.seekg(0, ios::end);
+    remaining = (unsigned long long)fin.tellg();
+    fin.seekg(0, ios::beg);
+
+    fin.read(magic, sizeof(magic));
+    fin.read((char*)&count, sizeof(count));
+    if (fin.fail() || (memcmp(magic, SHADER_CACHE_MAGIC, sizeof(magic)) != 0) || (count < 0))
+        return false;
+
+    remaining -= sizeof(magic) + sizeof(count);
+    if ((unsigned long long)count > remaining / SHADER_CACHE_ENTRY_HEADER)
+        return false;
+
+    result = true;
+    for (i = 0; i < count; i++)
+    {
+        fin.read((char*)&key, sizeof(key));
+        fin.read((char*)&milliseconds, sizeof(milliseconds));
+        fin.read((char*)&bytecode.size, sizeof(bytecode.size));
+        if (fin.fail())
+        {
+            result = false;
+            break;
+        }
+
+        remaining -= SHADER_CACHE_ENTRY_HEADER;
+        if (bytecode.size > remaining)
+        {
+            result = false;
+            break;
+        }
+
+        bytecode.data = new unsigned char[bytecode.size];
+        if (!bytecode.data)
+        {
+            result = false;
+            break;
+        }
+
+        fin.read((char*)bytecode.data, bytecode.size);
+        remaining -= bytecode.size;
+
+        if (fin.fail() || !AddEntry(key, milliseconds, bytecode))
+        {
+            delete[] bytecode.data;
+            result = false;
+            break;
+        }
+    }
+
+    fin.close();
+
+    // A damaged file is dropped whole, keeping the entries before the damage
+    // would only write them back out next to the missing ones
+    if (!result)
+    {
+        ClearEntries();
+        return false;
+    }
+
+    // Nothing new to write back yet
+    m_dirty = false;
+
+    return true;
+}
+
+// Hashes a file and, depth first, every file it pulls in with #include "..."
+bool ShaderCacheClass::HashSource(const char* path, unsigned long long& hash, int depth)
+{
+    ifstream fin;
+    char* source;
+    char includePath[SHADER_CACHE_MAX_PATH];
+    const char* line;
+    const char* nameStart;
+    const char* nameEnd;
+    const char* slash;
+    unsigned int size, directoryLength;
+    bool result;
+
+    if (depth > SHADER_CACHE_MAX_INCLUDE_DEPTH)
+        return false;
+
+    fin.open(path, ios::in | ios::binary);
+    if (fin.fail())
+        return false;
+
+    fin.seekg(0, ios::end);
+    size = (unsigned int)fin.tellg();
+    fin.seekg(0, ios::beg);
+
+    source = new char[size + 1];
+    if (!source)
+        return false;
+
+    fin.read(source, size);
+    fin.close();
+    source[size] = 0;
+
+    HashBytes(source, size, hash);
+
+    // Includes are looked up next to the including file, like the default handler does
+    slash = strrchr(path, '/');
+    if (!slash || (strrchr(path, '\\') > slash))
+        slash = strrchr(path, '\\');
+    directoryLength = slash ? (unsigned int)(slash - path + 1) : 0;
+
+    result = true;
+    line = source;
+    while (line && result)
+    {
+        while ((*line == ' ') || (*line == '\t'))
+            line++;
+
+        if (strncmp(line, "#include", 8) == 0)
+        {
+            nameStart = strchr(line, '"');
+            nameEnd = nameStart ? strchr(nameStart + 1, '"') : 0;
+
+            // Angle bracket includes are system headers, there are none to hash
+            if (nameStart && nameEnd && (nameStart < strchr(line, '\n') || !strchr(line, '\n')))
+            {
+                if (directoryLength + (nameEnd - nameStart - 1) >= SHADER_CACHE_MAX_PATH)
+                {
+                    result = false;
+                    break;
+                }
+
+                memcpy(includePath, path, directoryLength);
+                memcpy(&includePath[directoryLength], nameStart + 1, nameEnd - nameStart - 1);
+                includePath[directoryLength + (nameEnd - nameStart - 1)] = 0;
+
+                HashBytes(includePath + directoryLength, (unsigned int)(nameEnd - nameStart - 1), hash);
+                result = HashSource(includePath, hash, depth + 1);
+            }
+        }
+
+        line = strchr(line, '\n');
+        if (line)
+            line++;
+    }
+
+    delete[] source;
+
+    return result;
+}
+
+void ShaderCacheClass::HashBytes(const void* data, unsigned int size, unsigned long long& hash)
+{
+    const unsigned char* bytes;
+    unsigned int i;
+
+    bytes = (const unsigned char*)data;
+    for (i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= SHADER_HASH_PRIME;
+    }
+
+    return;
+}
+
+int ShaderCacheClass::FindEntry(unsigned long long key)
+{
+    int i;
+
+    for (i = 0; i < m_entryCount; i++)
+    {
+        if (m_entries[i].key == key)
+            return i;
+    }
+
+    return -1;
+}
+
+void ShaderCacheClass::ClearEntries()
+{
+    int i;
+
+    if (m_entries)
+    {
+        for (i = 0; i < m_entryCount; i++)
+            delete[] m_entries[i].bytecode.data;
+
+        delete[] m_entries;
+        m_entries = 0;
+    }
+
+    m_entryCount = 0;
+    m_entryCapacity = 0;
+    m_dirty = false;
+
+    return;
+}
+
+bool ShaderCacheClass::AddEntry(unsigned long long key, float compileMilliseconds, const ShaderBytecodeType& bytecode)
+{
+    EntryType* entries;
+    int capacity;
+
+    if (m_entryCount == m_entryCapacity)
+    {
+        capacity = m_entryCapacity ? m_entryCapacity * 2 : SHADER_CACHE_INITIAL_ENTRIES;
+
+        entries = new EntryType[capacity];
+        if (!entries)
+            return false;
+
+        if (m_entries)
+        {
+            memcpy(entries, m_entries, sizeof(EntryType) * m_entryCount);
+            delete[] m_entries;
+        }
+
+        m_entries = entries;
+        m_entryCapacity = capacity;
+    }
+
+    m_entries[m_entryCount].key = key;
+    m_entries[m_entryCount].compileMilliseconds = compileMilliseconds;
+    m_entries[m_entryCount].bytecode = bytecode;
+    m_entryCount++;
+
+    m_dirty = true;
+
+    return true;
+}
\ No newline at end of file